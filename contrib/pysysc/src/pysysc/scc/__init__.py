@@ -78,3 +78,73 @@ def configure(name="", enable_trace=False):
             trace = cpp.scc.tracer('vcd_trace', 1, True)
             traces.append(trace)
 
+
+def run_for(duration, n_steps=1, callback_every=0, callback=None):
+    """
+    Run the simulation for n_steps steps of the given duration with a single call into C++.
+    :param duration: the duration of a step as sc_time
+    :param n_steps: the number of steps
+    :param callback_every: the number of steps between two calls of callback, 0 disables the callback
+    :param callback: a callable getting the number of executed steps, the simulation stops if it returns False
+    :return: the number of executed steps
+    """
+    if callback is None or callback_every == 0:
+        return cpp.scc.pysysc.run_for(duration, n_steps)
+    return cpp.scc.pysysc.run_for(duration, n_steps, callback_every, lambda step: bool(callback(step)))
+
+def read_memory(socket_name, addr, length, buf=None):
+    """
+    Read memory using debug accesses of a TLM target socket.
+    :param socket_name: the hierarchical name of the target socket
+    :param addr: the address
+    :param length: the number of bytes to read
+    :param buf: an optional writable buffer (e.g. a bytearray or numpy array) receiving the data
+    :return: the buffer holding the data read
+    """
+    if buf is None:
+        buf = bytearray(length)
+    read = cpp.scc.pysysc.read_memory(socket_name, addr, buf, length)
+    if read < length:
+        logger.warning("read only %d of %d bytes from %s", read, length, socket_name)
+    return buf
+
+def write_memory(socket_name, addr, data):
+    """
+    Write memory using debug accesses of a TLM target socket.
+    :param socket_name: the hierarchical name of the target socket
+    :param addr: the address
+    :param data: a buffer (e.g. bytes or a numpy array) holding the data
+    :return: the number of bytes written
+    """
+    view = memoryview(data).cast('B')
+    return cpp.scc.pysysc.write_memory(socket_name, addr, view, view.nbytes)
+
+def memory_view(socket_name, addr, writable=False):
+    """
+    Get direct access to the memory behind a TLM target socket using DMI, e.g. a page of a scc::memory.
+    The view is only valid until the simulation continues.
+    :param socket_name: the hierarchical name of the target socket
+    :param addr: the address
+    :param writable: request a view allowing write accesses
+    :return: a buffer (usable e.g. with numpy.frombuffer) or None if direct access is not granted
+    """
+    view = cpp.scc.pysysc.get_memory_view(socket_name, addr, writable)
+    if not view.data or view.size == 0:
+        return None
+    data = view.data
+    data.reshape((view.size,))
+    return data
+
+def snapshot(registry, names=None):
+    """
+    Read the snapshot of a scc::value_registry published last as numpy array.
+    :param registry: the value registry
+    :param names: the result of registry.get_snapshot_names() to avoid retrieving it each call
+    :return: a tuple of the simulation time in seconds and the values in the order of the snapshot names, the time is
+             negative if no snapshot has been published yet
+    """
+    import numpy as np
+    count = len(names) if names is not None else registry.get_snapshot_names().size()
+    values = np.zeros(count, dtype=np.float64)
+    time = cpp.scc.pysysc.read_snapshot(registry, values, count)
+    return time, values
@@ -0,0 +1,272 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+/*
+ * sc_main.cpp
+ *
+ * Micro benchmarks of the SCC core primitives: address lookup in util::range_lut, access to util::sparse_array, the
+ * pool allocator (also as allocator of a std::map), tlm_mm payload allocation, scc::peq and the blocking path through
+ * scc::router into scc::memory. Each benchmark reports the time per operation. The results can be written to a file
+ * using --output and compared against such a file using --baseline, benchmarks being slower than the baseline by more
+ * than --tolerance percent are reported as regression and make the run fail.
+ */
+
+#include <algorithm>
+#include <array>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <scc/memory.h>
+#include <scc/peq.h>
+#include <scc/report.h>
+#include <scc/router.h>
+#include <string>
+#include <systemc>
+#include <tlm/scc/initiator_mixin.h>
+#include <tlm/scc/tlm_mm.h>
+#include <util/pool_allocator.h>
+#include <util/range_lut.h>
+#include <util/sparse_array.h>
+#include <vector>
+
+namespace po = boost::program_options;
+
+namespace {
+const size_t ERROR_IN_COMMAND_LINE = 1;
+const size_t SUCCESS = 0;
+const size_t ERROR_UNHANDLED_EXCEPTION = 2;
+const size_t REGRESSION = 3;
+
+struct bench_result {
+    std::string name;
+    double ns_per_op;
+};
+//! keeps the compiler from optimizing away the benchmarked operations
+volatile uint64_t sink;
+//! a linear congruential generator giving reproducible pseudo random addresses
+struct lcg {
+    uint64_t state{42};
+    uint64_t operator()() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 16;
+    }
+};
+
+constexpr unsigned targets = 8;
+constexpr uint64_t target_size = 1ULL << 20;
+using bench_memory = scc::memory<target_size, scc::LT>;
+
+struct bench_top : public sc_core::sc_module {
+    tlm::scc::initiator_mixin<tlm::tlm_initiator_socket<scc::LT>> isck{"isck"};
+    scc::router<> rtr{"router", targets};
+    sc_core::sc_vector<bench_memory> mems{"mems", targets};
+    scc::peq<uint64_t> que{"que"};
+
+    bench_top(sc_core::sc_module_name const& nm, uint64_t iterations, std::vector<bench_result>& results)
+    : sc_core::sc_module(nm)
+    , iterations(iterations)
+    , results(results) {
+        SC_HAS_PROCESS(bench_top);
+        SC_THREAD(run);
+        isck(rtr.target[0]);
+        for(unsigned i = 0; i < targets; ++i)
+            rtr.bind_target(mems[i].target, i, i * target_size, target_size);
+    }
+    //! time the given number of calls of op
+    void measure(std::string const& name, uint64_t count, std::function<void(uint64_t)> const& op) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for(uint64_t i = 0; i < count; ++i)
+            op(i);
+        auto end = std::chrono::high_resolution_clock::now();
+        results.push_back(
+            bench_result{name, std::chrono::duration<double, std::nano>(end - start).count() / std::max<uint64_t>(1, count)});
+    }
+
+    //! time the insertion and removal of random keys in a map holding about 128 elements
+    template <typename MAP> void bench_map(std::string const& name, lcg& rnd) {
+        MAP m;
+        for(unsigned i = 0; i < 128; ++i)
+            m[rnd() % 256] = i;
+        measure(name, iterations, [&](uint64_t i) {
+            m[rnd() % 256] = i;
+            m.erase(rnd() % 256);
+        });
+        sink = m.size();
+    }
+
+    void run() {
+        lcg rnd;
+        // util::range_lut lookups of random addresses in a map with 256 ranges (and holes between them)
+        util::range_lut<unsigned> lut(std::numeric_limits<unsigned>::max());
+        for(unsigned i = 0; i < 256; ++i)
+            lut.addEntry(i, i * 0x10000ULL, 0x8000ULL);
+        lut.freeze();
+        measure("range_lut::getEntry", iterations, [&](uint64_t) { sink = lut.getEntry(rnd() % (256 * 0x10000ULL)); });
+        // util::sparse_array accesses spread over 16 pages
+        util::sparse_array<uint8_t, 1ULL << 32, 16> sparse;
+        measure("sparse_array::operator[]", iterations, [&](uint64_t i) {
+            auto addr = rnd() % (16ULL << 16);
+            sparse[addr] = static_cast<uint8_t>(i);
+            sink = sparse[addr ^ 0x1f];
+        });
+        // pool allocator, allocating and freeing in LIFO order with a few elements in flight
+        auto& pool = util::pool_allocator<64>::get();
+        std::vector<void*> in_flight(16);
+        measure("pool_allocator::allocate+free", iterations, [&](uint64_t i) {
+            auto& slot = in_flight[i % in_flight.size()];
+            if(slot)
+                pool.free(slot);
+            slot = pool.allocate();
+        });
+        for(auto* p : in_flight)
+            if(p)
+                pool.free(p);
+        // the nodes of a small std::map being inserted and erased, using the default and the pool based allocator
+        using pool_map = std::map<uint64_t, uint64_t, std::less<uint64_t>,
+                                  util::stl_pool_allocator<std::pair<const uint64_t, uint64_t>>>;
+        bench_map<std::map<uint64_t, uint64_t>>("std::map<std::allocator>::insert+erase", rnd);
+        bench_map<pool_map>("std::map<stl_pool_allocator>::insert+erase", rnd);
+        // tlm_mm payloads with a data buffer
+        auto& mm = tlm::scc::tlm_mm<>::get();
+        measure("tlm_mm::allocate+release", iterations, [&](uint64_t) {
+            auto* gp = mm.allocate(8);
+            gp->acquire();
+            sink = reinterpret_cast<uintptr_t>(gp->get_data_ptr());
+            gp->release();
+        });
+        // peq notification and retrieval, each entry is waited for
+        measure("peq::notify+get", iterations, [&](uint64_t i) {
+            que.notify(i, sc_core::sc_time(1, sc_core::SC_NS));
+            sink = que.get();
+        });
+        // blocking accesses to random targets through the router
+        std::array<uint8_t, 8> data{};
+        tlm::tlm_generic_payload trans;
+        trans.set_data_ptr(data.data());
+        trans.set_data_length(data.size());
+        trans.set_streaming_width(data.size());
+        measure("router::b_transport", iterations, [&](uint64_t i) {
+            trans.set_command(i & 1 ? tlm::TLM_WRITE_COMMAND : tlm::TLM_READ_COMMAND);
+            trans.set_address((rnd() % (targets * target_size)) & ~7ULL);
+            trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+            trans.set_dmi_allowed(false);
+            sc_core::sc_time delay;
+            isck->b_transport(trans, delay);
+        });
+        // the memory access itself
+        measure("memory::handle_operation", iterations, [&](uint64_t i) {
+            trans.set_command(i & 1 ? tlm::TLM_WRITE_COMMAND : tlm::TLM_READ_COMMAND);
+            trans.set_address((rnd() % target_size) & ~7ULL);
+            trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+            sc_core::sc_time delay;
+            sink = mems[0].handle_operation(trans, delay);
+        });
+        sc_core::sc_stop();
+    }
+
+    uint64_t iterations;
+    std::vector<bench_result>& results;
+};
+//! read a result file, each line holds the name of a benchmark and the time per operation in ns separated by a tab
+std::map<std::string, double> read_results(std::string const& name) {
+    std::map<std::string, double> res;
+    std::ifstream is(name);
+    std::string line;
+    while(std::getline(is, line)) {
+        auto pos = line.rfind('\t');
+        if(pos != std::string::npos)
+            res[line.substr(0, pos)] = std::stod(line.substr(pos + 1));
+    }
+    return res;
+}
+} // namespace
+
+int sc_main(int argc, char* argv[]) {
+    sc_core::sc_report_handler::set_actions("/IEEE_Std_1666/deprecated", sc_core::SC_DO_NOTHING);
+    ///////////////////////////////////////////////////////////////////////////
+    // CLI argument parsing
+    ///////////////////////////////////////////////////////////////////////////
+    uint64_t iterations;
+    double tolerance;
+    po::options_description desc("Options");
+    // clang-format off
+    desc.add_options()
+            ("help,h",  "Print help message")
+            ("iterations", po::value<uint64_t>(&iterations)->default_value(1000000), "number of operations per benchmark")
+            ("output", po::value<std::string>(), "file the results are written to")
+            ("baseline", po::value<std::string>(), "file with results of a previous run to compare against")
+            ("tolerance", po::value<double>(&tolerance)->default_value(10.), "slow down in percent reported as regression");
+    // clang-format on
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm); // can throw
+        if(vm.count("help")) {
+            std::cout << "SCC core primitives benchmark" << std::endl << desc << std::endl;
+            return SUCCESS;
+        }
+        po::notify(vm);
+    } catch(po::error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    scc::init_logging(scc::log::WARNING);
+    std::vector<bench_result> results;
+    try {
+        bench_top top("top", iterations, results);
+        sc_core::sc_start();
+    } catch(std::exception& e) {
+        std::cerr << "Unhandled Exception reached the top of main: " << e.what() << ", application will now exit"
+                  << std::endl;
+        return ERROR_UNHANDLED_EXCEPTION;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    // report and compare the results
+    ///////////////////////////////////////////////////////////////////////////
+    std::map<std::string, double> baseline;
+    if(vm.count("baseline"))
+        baseline = read_results(vm["baseline"].as<std::string>());
+    auto regressions = 0U;
+    std::cout << std::left << std::setw(32) << "benchmark" << std::right << std::setw(14) << "[ns/op]";
+    if(baseline.size())
+        std::cout << std::setw(14) << "baseline" << std::setw(10) << "ratio";
+    std::cout << std::endl;
+    for(auto& r : results) {
+        std::cout << std::left << std::setw(32) << r.name << std::right << std::setw(14) << std::fixed
+                  << std::setprecision(2) << r.ns_per_op;
+        auto it = baseline.find(r.name);
+        if(it != baseline.end() && it->second > 0) {
+            auto ratio = r.ns_per_op / it->second;
+            std::cout << std::setw(14) << it->second << std::setw(10) << ratio;
+            if(ratio > 1. + tolerance / 100.) {
+                std::cout << "  REGRESSION";
+                ++regressions;
+            }
+        }
+        std::cout << std::endl;
+    }
+    if(vm.count("output")) {
+        std::ofstream os(vm["output"].as<std::string>());
+        for(auto& r : results)
+            os << r.name << "\t" << r.ns_per_op << "\n";
+    }
+    return regressions ? REGRESSION : SUCCESS;
+}
@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+/*
+ * glob_matcher_check.cpp
+ *
+ * Compares util::glob_matcher against the regular expressions created by util::glob_to_regex() for a set of patterns
+ * and names, both for each pattern on its own and for all patterns in one matcher. The run fails if any result
+ * differs.
+ */
+
+#include <cstddef>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <util/glob_matcher.h>
+#include <util/ities.h>
+#include <vector>
+
+namespace {
+// several ? in a row and after other tokens as these grow the trie while a node is referenced
+const std::vector<std::string> patterns{"a?",         "??",       "?.?",  "a??b", "top.?.x?", "*?",   "??*b",
+                                        "a.**?",      "[ab]?[cd]?", "x\\??", "top.*",    "**.y?", "[!a]??", "?*?.?"};
+const std::vector<std::string> names{"",       "a",     "ab",       "abc",       "aa",   "a.b",  "a..b",
+                                     "axyb",   "top.a.xy", "top.ab.xy", "acbd", "x?z",  "aXb",  ".a",
+                                     "a.bc.d", "top",   "top.x",    "b.c.yz",    "bcd",  "ab.c", "abc.d"};
+} // namespace
+
+int main() {
+    unsigned mismatches = 0;
+    auto check = [&mismatches](std::string const& pattern, std::string const& name, bool expected, bool matched) {
+        if(expected != matched) {
+            std::cerr << "'" << pattern << "' " << (expected ? "does not match" : "matches") << " '" << name << "'"
+                      << std::endl;
+            ++mismatches;
+        }
+    };
+    std::vector<std::regex> regexes;
+    util::glob_matcher all;
+    for(auto& p : patterns) {
+        regexes.emplace_back(util::glob_to_regex(p));
+        all.add(p);
+        util::glob_matcher single;
+        single.add(p);
+        for(auto& n : names)
+            check(p, n, std::regex_match(n, regexes.back()), single.match(n) != util::glob_matcher::npos);
+    }
+    // the combined matcher reports the first pattern matching
+    for(auto& n : names) {
+        auto first = util::glob_matcher::npos;
+        for(size_t i = 0; i < regexes.size() && first == util::glob_matcher::npos; ++i)
+            if(std::regex_match(n, regexes[i]))
+                first = i;
+        auto id = all.match(n);
+        if(id != first) {
+            std::cerr << "'" << n << "' matches pattern " << id << " instead of " << first << std::endl;
+            ++mismatches;
+        }
+    }
+    if(mismatches) {
+        std::cerr << mismatches << " mismatches" << std::endl;
+        return 1;
+    }
+    std::cout << "all " << patterns.size() * names.size() << " matches are consistent" << std::endl;
+    return 0;
+}
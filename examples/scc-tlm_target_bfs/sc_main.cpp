@@ -47,13 +47,35 @@ public:
     : scc::tlm_target_bfs_register_base<tlm_target_bfs_register_example>{name} {};
 };
 
+/*
+ * @Brief: The same register layout described by constant tables as a generator would emit it
+ */
+namespace tlm_target_bfs_layout_example {
+constexpr scc::bfs_register_desc registers[] = {{"R0", 0x00}, {"R1", 0x04}, {"R2", 0x08}};
+constexpr scc::bfs_bitfield_desc bitfields[] = {
+    {1, "BITFIELD_0", 0, 1, "regs.R1.BF0"},
+    {1, "BITFIELD_1", 3, 3, "regs.R1.BF1"},
+    {2, "BITFIELD_0", 0, 16, "regs.R2.BF0"},
+    {2, "BITFIELD_1", 16, 16, "regs.R2.BF1"}};
+static_assert(scc::bfs_layout_valid(registers, bitfields), "invalid register layout");
+} // namespace tlm_target_bfs_layout_example
+
+class tlm_target_bfs_register_table_example
+: public scc::tlm_target_bfs_register_table<tlm_target_bfs_register_table_example> {
+public:
+    tlm_target_bfs_register_table_example(sc_core::sc_module_name name)
+    : scc::tlm_target_bfs_register_table<tlm_target_bfs_register_table_example>{
+          name, tlm_target_bfs_layout_example::registers, tlm_target_bfs_layout_example::bitfields} {}
+};
+
 /*
  * @Brief: This class defines the tlm_target_bfs_example.
  */
-class tlm_target_bfs_example : public scc::tlm_target_bfs<tlm_target_bfs_register_example, testbench> {
+template <typename regs_t> class tlm_target_bfs_example : public scc::tlm_target_bfs<regs_t, testbench> {
     SC_HAS_PROCESS(tlm_target_bfs_example);
 
 private:
+    using scc::tlm_target_bfs<regs_t, testbench>::regs;
     scc::bitfield_register<uint32_t>& r_io_{regs->getRegister("R0")};
     scc::bitfield<uint32_t>& r_inputconfig_{regs->getBitfield("R1", "BITFIELD_0", "regs.R1.BF0")};
     scc::bitfield<uint32_t>& r_outputconfig_{regs->getBitfield("R1", "BITFIELD_1", "regs.R1.BF1")};
@@ -73,7 +95,7 @@ private:
 public:
     tlm_target_bfs_example(sc_core::sc_module_name name, scc::tlm_target_bfs_params&& params,
                            testbench* owner = nullptr)
-    : tlm_target_bfs(name, std::move(params), owner) {
+    : scc::tlm_target_bfs<regs_t, testbench>(name, std::move(params), owner) {
         reset();
         /*
          * Define bitfield specific Read/Write callbacks.
@@ -119,21 +141,27 @@ public:
     sc_core::sc_clock clk{"clk", clk_period, 0.5, sc_core::SC_ZERO_TIME, true};
     sc_core::sc_signal<bool> rst{"rst"};
 
-    std::unique_ptr<tlm_utils::simple_initiator_socket_tagged<testbench,scc::LT>> intor_;
-    std::map<std::string, std::unique_ptr<scc::tlm_target_bfs_base<testbench>>> duts_{};
+    static constexpr size_t max_peripherals = 2;
+    // sockets can only be created during construction, so there is one socket per possible peripheral
+    std::array<std::unique_ptr<tlm_utils::simple_initiator_socket_tagged<testbench,scc::LT>>, max_peripherals> intors_;
+    std::map<std::string, std::pair<std::unique_ptr<scc::tlm_target_bfs_base<testbench>>, size_t>> duts_{};
 
     testbench(sc_core::sc_module_name nm)
     : sc_core::sc_module(nm) {
         SC_THREAD(run);
-        intor_ =
-            util::make_unique<tlm_utils::simple_initiator_socket_tagged<testbench, scc::LT>>(std::string{"initiator"}.c_str());
+        for(size_t i = 0; i < max_peripherals; ++i)
+            intors_[i] = util::make_unique<tlm_utils::simple_initiator_socket_tagged<testbench, scc::LT>>(
+                ("initiator" + std::to_string(i)).c_str());
     }
 
     template <class PERIPHERAL_T> void addPeripheral(std::string name, scc::tlm_target_bfs_params&& per_params) {
+        auto idx = duts_.size();
+        if(idx == max_peripherals)
+            SCCFATAL() << "too many peripherals";
         auto per = util::make_unique<PERIPHERAL_T>(name.c_str(), std::move(per_params), this);
         per->rst_in_(this->rst);
-        intor_->bind(*(per->sock_t_.get()));
-        duts_.insert(std::make_pair(name, std::move(per)));
+        intors_[idx]->bind(*(per->sock_t_.get()));
+        duts_.insert(std::make_pair(name, std::make_pair(std::move(per), idx)));
     }
 
     tlm::tlm_generic_payload* prepare_trans(size_t len) {
@@ -158,6 +186,7 @@ public:
 
         for(auto& e : duts_) {
             std::cout << "test " << e.first << std::endl;
+            auto& intor_ = intors_[e.second.second];
 
             /* WRITE test callback-able complete register (R0) */
             auto trans = prepare_trans(4);
@@ -246,7 +275,12 @@ int sc_main(int argc, char* argv[]) {
                                             /* .size  = */ 4 * sizeof(uint32_t),
                                             /* .num_irqs = */ 0,
                                             /* .num_regs = */ 3};
-    test.addPeripheral<tlm_target_bfs_example>("per1", std::move(per1params));
+    test.addPeripheral<tlm_target_bfs_example<tlm_target_bfs_register_example>>("per1", std::move(per1params));
+    scc::tlm_target_bfs_params_t per2params{/* .base_addr = */ 0x2000,
+                                            /* .size  = */ 4 * sizeof(uint32_t),
+                                            /* .num_irqs = */ 0,
+                                            /* .num_regs = */ 3};
+    test.addPeripheral<tlm_target_bfs_example<tlm_target_bfs_register_table_example>>("per2", std::move(per2params));
 
     sc_core::sc_start(1_ms);
     SCCINFO() << "Finished";
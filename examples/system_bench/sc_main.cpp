@@ -0,0 +1,278 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+/*
+ * sc_main.cpp
+ *
+ * End-to-end throughput benchmark derived from the simple_system example. A configurable number of initiators access
+ * a configurable number of memories and the uart and spi peripherals of simple_system through a scc::router. The mix
+ * of reads and writes and of memory and peripheral accesses, the access length and the quantum of the initiators can
+ * be set as well as signal tracing and transaction recording. The benchmark reports the transactions per second of
+ * host time, a MIPS equivalent assuming a fixed number of instructions per bus access, the ratio of simulated to host
+ * time and the peak memory use so that SCC releases and configurations can be compared using the same workload.
+ */
+
+#include "spi.h"
+#include "uart.h"
+#include <algorithm>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <scc/memory.h>
+#include <scc/report.h>
+#include <scc/router.h>
+#include <scc/tracer.h>
+#include <scc/utilities.h>
+#include <string>
+#include <systemc>
+#include <tlm/scc/initiator_mixin.h>
+#include <tlm_utils/tlm_quantumkeeper.h>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace po = boost::program_options;
+
+namespace {
+const size_t ERROR_IN_COMMAND_LINE = 1;
+const size_t SUCCESS = 0;
+const size_t ERROR_UNHANDLED_EXCEPTION = 2;
+
+struct backend {
+    char const* name;
+    scc::tracer::file_type type;
+};
+backend const backends[] = {{"none", scc::tracer::NONE},  {"text", scc::tracer::TEXT},
+                            {"lz4", scc::tracer::COMPRESSED}, {"sqlite", scc::tracer::SQLITE},
+                            {"ftr", scc::tracer::FTR},    {"cftr", scc::tracer::CFTR}};
+
+struct bench_config {
+    unsigned initiators;
+    unsigned memories;
+    uint64_t transactions;
+    unsigned read_percent;
+    unsigned periph_percent;
+    unsigned length;
+    unsigned quantum_ns;
+};
+
+constexpr uint64_t mem_base = 0x80000000ULL;
+constexpr uint64_t mem_size = 16ULL << 20;
+constexpr uint64_t uart_base = 0x10013000ULL;
+constexpr uint64_t spi_base = 0x10014000ULL;
+constexpr uint64_t periph_size = 0x1000ULL;
+//! a linear congruential generator giving reproducible pseudo random traffic
+struct lcg {
+    uint64_t state;
+    uint64_t operator()() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 16;
+    }
+};
+/**
+ * an initiator issuing blocking transactions back to back, it spends 10ns per transaction and synchronizes using a
+ * quantum keeper
+ */
+struct bench_initiator : public sc_core::sc_module {
+    tlm::scc::initiator_mixin<tlm::tlm_initiator_socket<scc::LT>> isck{"isck"};
+
+    bench_initiator(sc_core::sc_module_name const& nm, unsigned idx, bench_config const& cfg,
+                    std::function<void()> const& done)
+    : sc_core::sc_module(nm)
+    , cfg(cfg)
+    , done(done)
+    , rnd{idx + 1ULL}
+    , data(cfg.length) {
+        SC_HAS_PROCESS(bench_initiator);
+        SC_THREAD(run);
+    }
+
+    void run() {
+        tlm_utils::tlm_quantumkeeper qk;
+        qk.reset();
+        tlm::tlm_generic_payload trans;
+        trans.set_data_ptr(data.data());
+        sc_core::sc_time const cycle(10, sc_core::SC_NS);
+        for(uint64_t i = 0; i < cfg.transactions; ++i) {
+            auto r = rnd();
+            trans.set_command(r % 100 < cfg.read_percent ? tlm::TLM_READ_COMMAND : tlm::TLM_WRITE_COMMAND);
+            r = rnd();
+            if(r % 100 < cfg.periph_percent) {
+                // the uart divider and the spi sckdiv register are plain registers without side effects
+                trans.set_address((r >> 8) & 1 ? spi_base : uart_base + 0x18);
+                trans.set_data_length(4);
+                trans.set_streaming_width(4);
+            } else {
+                auto offs = ((r >> 8) % (mem_size / cfg.length)) * cfg.length;
+                trans.set_address(mem_base + ((r >> 40) % cfg.memories) * mem_size + offs);
+                trans.set_data_length(cfg.length);
+                trans.set_streaming_width(cfg.length);
+            }
+            trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+            sc_core::sc_time delay = qk.get_local_time();
+            isck->b_transport(trans, delay);
+            if(trans.is_response_error())
+                SCCERR(SCMOD) << "access to 0x" << std::hex << trans.get_address() << " failed";
+            qk.set(delay + cycle);
+            if(qk.need_sync())
+                qk.sync();
+        }
+        qk.sync();
+        done();
+    }
+
+    bench_config const& cfg;
+    std::function<void()> done;
+    lcg rnd;
+    std::vector<unsigned char> data;
+};
+//! the platform: initiators, the router, the memories and the simple_system peripherals with clock and reset
+struct bench_system : public sc_core::sc_module {
+    sc_core::sc_vector<bench_initiator> initiators;
+    scc::router<> router;
+    sc_core::sc_vector<scc::memory<mem_size>> memories;
+    sysc::uart uart{"uart"};
+    sysc::spi spi{"spi"};
+    sc_core::sc_signal<sc_core::sc_time> s_clk{"s_clk"};
+    sc_core::sc_signal<bool> s_rst{"s_rst"};
+
+    bench_system(sc_core::sc_module_name const& nm, bench_config const& cfg)
+    : sc_core::sc_module(nm)
+    , initiators("initiators")
+    , router("router", cfg.memories + 2, cfg.initiators)
+    , memories("memories", cfg.memories)
+    , running(cfg.initiators) {
+        SC_HAS_PROCESS(bench_system);
+        initiators.init(cfg.initiators, [this, &cfg](char const* name, size_t idx) {
+            return new bench_initiator(name, idx, cfg, [this]() {
+                if(!--running)
+                    sc_core::sc_stop();
+            });
+        });
+        for(unsigned i = 0; i < cfg.initiators; ++i)
+            initiators[i].isck(router.target[i]);
+        for(unsigned i = 0; i < cfg.memories; ++i)
+            router.bind_target(memories[i].target, i, mem_base + i * mem_size, mem_size);
+        router.bind_target(uart.socket, cfg.memories, uart_base, periph_size);
+        router.bind_target(spi.socket, cfg.memories + 1, spi_base, periph_size);
+        uart.clk_i(s_clk);
+        spi.clk_i(s_clk);
+        uart.rst_i(s_rst);
+        spi.rst_i(s_rst);
+        s_clk.write(sc_core::sc_time(10, sc_core::SC_NS));
+    }
+
+    unsigned running;
+};
+//! the peak resident set size of the process in KiB
+long peak_rss() {
+#ifndef _WIN32
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#endif
+    return 0;
+}
+} // namespace
+
+int sc_main(int argc, char* argv[]) {
+    sc_core::sc_report_handler::set_actions("/IEEE_Std_1666/deprecated", sc_core::SC_DO_NOTHING);
+    ///////////////////////////////////////////////////////////////////////////
+    // CLI argument parsing
+    ///////////////////////////////////////////////////////////////////////////
+    bench_config cfg;
+    double instr_per_access;
+    po::options_description desc("Options");
+    // clang-format off
+    desc.add_options()
+            ("help,h",  "Print help message")
+            ("initiators", po::value<unsigned>(&cfg.initiators)->default_value(2), "number of initiators")
+            ("memories", po::value<unsigned>(&cfg.memories)->default_value(2), "number of memory targets")
+            ("transactions", po::value<uint64_t>(&cfg.transactions)->default_value(1000000), "number of transactions per initiator")
+            ("read-percent", po::value<unsigned>(&cfg.read_percent)->default_value(70), "share of reads in percent")
+            ("periph-percent", po::value<unsigned>(&cfg.periph_percent)->default_value(10), "share of peripheral accesses in percent")
+            ("length", po::value<unsigned>(&cfg.length)->default_value(8), "data length of the memory accesses in bytes")
+            ("quantum", po::value<unsigned>(&cfg.quantum_ns)->default_value(100), "global quantum in ns")
+            ("instr-per-access", po::value<double>(&instr_per_access)->default_value(3.), "instructions per bus access used for the MIPS equivalent")
+            ("trace,t", "trace SystemC signals")
+            ("recording", po::value<std::string>()->default_value("none"), "transaction recording backend (none, text, lz4, sqlite, ftr, cftr)");
+    // clang-format on
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm); // can throw
+        if(vm.count("help")) {
+            std::cout << "simple system throughput benchmark" << std::endl << desc << std::endl;
+            return SUCCESS;
+        }
+        po::notify(vm);
+    } catch(po::error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    if(!cfg.initiators || !cfg.memories || !cfg.length || (cfg.length & (cfg.length - 1)) || cfg.length > mem_size) {
+        std::cerr << "ERROR: initiators and memories need to be non-zero, length a power of 2" << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    auto be = std::find_if(std::begin(backends), std::end(backends),
+                           [&vm](backend const& b) { return vm["recording"].as<std::string>() == b.name; });
+    if(be == std::end(backends)) {
+        std::cerr << "ERROR: unknown recording backend " << vm["recording"].as<std::string>() << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    scc::init_logging(scc::log::WARNING);
+    ///////////////////////////////////////////////////////////////////////////
+    // set up tracing & transaction recording, instantiate and run
+    ///////////////////////////////////////////////////////////////////////////
+    double secs = 0;
+    sc_core::sc_time sim_time;
+    try {
+        auto start = std::chrono::high_resolution_clock::now();
+        // the recorders pick up the database upon construction so the tracer needs to be created first
+        auto trace = std::unique_ptr<scc::tracer>(new scc::tracer("system_bench", be->type, vm.count("trace") > 0));
+        tlm::tlm_global_quantum::instance().set(sc_core::sc_time(cfg.quantum_ns, sc_core::SC_NS));
+        bench_system top("top", cfg);
+        sc_core::sc_start();
+        sim_time = sc_core::sc_time_stamp();
+        // closing the databases includes writing the outstanding data
+        trace.reset();
+        secs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    } catch(std::exception& e) {
+        std::cerr << "Unhandled Exception reached the top of main: " << e.what() << ", application will now exit"
+                  << std::endl;
+        return ERROR_UNHANDLED_EXCEPTION;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    // report
+    ///////////////////////////////////////////////////////////////////////////
+    auto total = static_cast<double>(cfg.transactions) * cfg.initiators;
+    auto tps = secs > 0 ? total / secs : 0.;
+    std::cout << std::fixed << std::setprecision(3) << "initiators/memories: " << cfg.initiators << "/"
+              << cfg.memories << ", recording: " << be->name << ", tracing: " << (vm.count("trace") ? "on" : "off")
+              << std::endl
+              << "transactions:        " << static_cast<uint64_t>(total) << std::endl
+              << "host time [s]:       " << secs << std::endl
+              << "simulated time:      " << sim_time << std::endl
+              << "transactions/s:      " << tps << std::endl
+              << "MIPS equivalent:     " << tps * instr_per_access / 1e6 << std::endl
+              << "sim/host time ratio: " << (secs > 0 ? sim_time.to_seconds() / secs : 0.) << std::endl
+              << "peak RSS [MB]:       " << peak_rss() / 1024.0 << std::endl;
+    return SUCCESS;
+}
@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+/*
+ * sc_main.cpp
+ *
+ * Measures the overhead of the signal trace file backends of scc::tracer. A synthetic hierarchy of modules holding
+ * signals of a configurable width is simulated, in each clock cycle a configurable fraction of the signals changes.
+ * Without --type all backends are measured, each one in a process of its own as SystemC can only elaborate once.
+ */
+
+#include <algorithm>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <scc/report.h>
+#include <scc/tracer.h>
+#include <sstream>
+#include <string>
+#include <systemc>
+#include <vector>
+
+namespace po = boost::program_options;
+
+namespace {
+const size_t ERROR_IN_COMMAND_LINE = 1;
+const size_t SUCCESS = 0;
+const size_t ERROR_UNHANDLED_EXCEPTION = 2;
+
+struct backend {
+    char const* name;
+    scc::tracer::file_type type;
+};
+// NONE has to come first as it is the baseline of the overhead
+backend const backends[] = {{"none", scc::tracer::NONE},
+                            {"sc_vcd", scc::tracer::SC_VCD},
+                            {"pull_vcd", scc::tracer::PULL_VCD},
+                            {"push_vcd", scc::tracer::PUSH_VCD},
+                            {"fst", scc::tracer::FST},
+                            {"mt_vcd", scc::tracer::MT_VCD},
+                            {"mt_vcd_lz4", scc::tracer::MT_VCD_LZ4},
+                            {"mt_vcd_zstd", scc::tracer::MT_VCD_ZSTD}};
+
+struct bench_config {
+    unsigned signals;
+    unsigned modules;
+    unsigned width;
+    double toggle_rate;
+    uint64_t cycles;
+};
+
+template <typename T> T next_value(T const& v) { return v + 1; }
+template <> bool next_value<bool>(bool const& v) { return !v; }
+/**
+ * a module holding some signals, with each rising clock edge each signal changes with the probability of the
+ * toggle rate
+ */
+template <typename T> struct bench_unit : public sc_core::sc_module {
+    sc_core::sc_in<bool> clk{"clk"};
+    sc_core::sc_vector<sc_core::sc_signal<T>> sigs;
+
+    bench_unit(sc_core::sc_module_name const& nm, unsigned count, double toggle_rate, unsigned seed)
+    : sc_core::sc_module(nm)
+    , sigs("sig", count)
+    , threshold(static_cast<uint32_t>(toggle_rate * 0xffffffffu))
+    , rnd(seed * 2654435761u + 1) {
+        SC_HAS_PROCESS(bench_unit);
+        SC_METHOD(toggle);
+        sensitive << clk.pos();
+        dont_initialize();
+    }
+
+    void toggle() {
+        for(auto& s : sigs) {
+            // a xorshift generator to decide which signals change
+            rnd ^= rnd << 13;
+            rnd ^= rnd >> 17;
+            rnd ^= rnd << 5;
+            if(rnd <= threshold)
+                s.write(next_value(s.read()));
+        }
+    }
+
+    uint32_t const threshold;
+    uint32_t rnd;
+};
+
+struct bench_top : public sc_core::sc_module {
+    sc_core::sc_clock clk{"clk", 10, sc_core::SC_NS};
+
+    bench_top(sc_core::sc_module_name const& nm, bench_config const& cfg)
+    : sc_core::sc_module(nm) {
+        switch(cfg.width) {
+        case 1:
+            create<bool>(cfg);
+            break;
+        case 8:
+            create<sc_dt::sc_uint<8>>(cfg);
+            break;
+        case 16:
+            create<sc_dt::sc_uint<16>>(cfg);
+            break;
+        case 32:
+            create<sc_dt::sc_uint<32>>(cfg);
+            break;
+        case 128:
+            create<sc_dt::sc_biguint<128>>(cfg);
+            break;
+        case 512:
+            create<sc_dt::sc_biguint<512>>(cfg);
+            break;
+        default: // 64, the width is checked when parsing the command line
+            create<sc_dt::sc_uint<64>>(cfg);
+        }
+    }
+
+    template <typename T> void create(bench_config const& cfg) {
+        auto modules = std::max(1u, cfg.modules);
+        for(auto i = 0u; i < modules; ++i) {
+            // distribute the remainder over the first modules
+            auto count = cfg.signals / modules + (i < cfg.signals % modules ? 1 : 0);
+            auto* unit = new bench_unit<T>(sc_core::sc_gen_unique_name("unit"), count, cfg.toggle_rate, i);
+            unit->clk(clk);
+            units.emplace_back(unit);
+        }
+    }
+
+    std::vector<std::unique_ptr<sc_core::sc_module>> units;
+};
+
+uint64_t file_size(std::string const& name) {
+    uint64_t size = 0;
+    for(auto ext : {".vcd", ".fst", ".vcd.gz", ".vcd.lz4", ".vcd.zst"}) {
+        std::ifstream is(name + ext, std::ios::binary | std::ios::ate);
+        if(is)
+            size += static_cast<uint64_t>(is.tellg());
+    }
+    return size;
+}
+/**
+ * run the benchmark of one backend and print the wall clock time and the size of the trace file(s)
+ */
+int run_backend(backend const& be, bench_config const& cfg) {
+    auto name = std::string("trace_bench_") + be.name;
+    auto top = std::unique_ptr<bench_top>(new bench_top("top", cfg));
+    auto trace = std::unique_ptr<scc::tracer>(new scc::tracer(name, scc::tracer::NONE, be.type));
+    auto start = std::chrono::high_resolution_clock::now();
+    sc_core::sc_start(sc_core::sc_time(10, sc_core::SC_NS) * static_cast<double>(cfg.cycles));
+    // closing the trace file includes writing the outstanding data
+    trace.reset();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto secs = std::chrono::duration<double>(end - start).count();
+    std::cout << "RESULT " << be.name << " " << secs << " " << file_size(name) << std::endl;
+    return SUCCESS;
+}
+} // namespace
+
+int sc_main(int argc, char* argv[]) {
+    sc_core::sc_report_handler::set_actions("/IEEE_Std_1666/deprecated", sc_core::SC_DO_NOTHING);
+    ///////////////////////////////////////////////////////////////////////////
+    // CLI argument parsing
+    ///////////////////////////////////////////////////////////////////////////
+    bench_config cfg;
+    po::options_description desc("Options");
+    // clang-format off
+    desc.add_options()
+            ("help,h",  "Print help message")
+            ("type", po::value<std::string>(), "the backend to measure, all backends are measured if not given")
+            ("signals", po::value<unsigned>(&cfg.signals)->default_value(10000), "number of traced signals")
+            ("modules", po::value<unsigned>(&cfg.modules)->default_value(100), "number of modules holding the signals")
+            ("width", po::value<unsigned>(&cfg.width)->default_value(32), "signal width (1, 8, 16, 32, 64, 128 or 512)")
+            ("toggle-rate", po::value<double>(&cfg.toggle_rate)->default_value(0.1), "fraction of signals changing per cycle")
+            ("cycles", po::value<uint64_t>(&cfg.cycles)->default_value(10000), "number of clock cycles to simulate");
+    // clang-format on
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm); // can throw
+        if(vm.count("help")) {
+            std::cout << "trace backend benchmark" << std::endl << desc << std::endl;
+            return SUCCESS;
+        }
+        po::notify(vm);
+        static const unsigned widths[] = {1, 8, 16, 32, 64, 128, 512};
+        if(std::find(std::begin(widths), std::end(widths), cfg.width) == std::end(widths))
+            throw po::error("unsupported signal width " + std::to_string(cfg.width));
+        if(!(cfg.toggle_rate >= 0.0 && cfg.toggle_rate <= 1.0))
+            throw po::error("the toggle rate needs to be in the range of 0 to 1");
+    } catch(po::error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    scc::init_logging(scc::log::WARNING);
+    if(vm.count("type")) {
+        for(auto& be : backends)
+            if(vm["type"].as<std::string>() == be.name)
+                return run_backend(be, cfg);
+        std::cerr << "ERROR: unknown backend " << vm["type"].as<std::string>() << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    // run each backend in a child process and collect the results
+    ///////////////////////////////////////////////////////////////////////////
+    std::cout << std::left << std::setw(12) << "backend" << std::right << std::setw(12) << "time [s]" << std::setw(16)
+              << "overhead [us]" << std::setw(14) << "size [MB]" << std::setw(12) << "MB/s" << std::endl;
+    double baseline = 0;
+    for(auto& be : backends) {
+        std::stringstream cmd;
+        cmd << argv[0] << " --type " << be.name << " --signals " << cfg.signals << " --modules " << cfg.modules
+            << " --width " << cfg.width << " --toggle-rate " << cfg.toggle_rate << " --cycles " << cfg.cycles;
+        auto out_name = std::string("trace_bench_") + be.name + ".result";
+        cmd << " > " << out_name;
+        if(std::system(cmd.str().c_str()) != 0) {
+            std::cerr << "ERROR: running backend " << be.name << " failed" << std::endl;
+            return ERROR_UNHANDLED_EXCEPTION;
+        }
+        std::ifstream is(out_name);
+        std::string line, tag, nm;
+        double secs = 0;
+        uint64_t size = 0;
+        while(std::getline(is, line))
+            if(line.compare(0, 7, "RESULT ") == 0)
+                std::istringstream(line) >> tag >> nm >> secs >> size;
+        if(be.type == scc::tracer::NONE)
+            baseline = secs;
+        auto mbytes = size / (1024.0 * 1024.0);
+        std::cout << std::left << std::setw(12) << be.name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(12) << secs << std::setw(16) << (secs - baseline) * 1e6 / cfg.cycles << std::setw(14)
+                  << mbytes << std::setw(12) << (secs > 0 ? mbytes / secs : 0.0) << std::endl;
+    }
+    return SUCCESS;
+}
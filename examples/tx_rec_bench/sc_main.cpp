@@ -0,0 +1,269 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+/*
+ * sc_main.cpp
+ *
+ * Measures the overhead of the transaction recording backends. An initiator drives a configurable number of blocking
+ * and non-blocking transactions through a recorder (tlm_recorder for the SCV based backends, tlm2_lwtr for the LWTR
+ * based ones) into a target answering immediately. Without --type all backends are measured, each one in a process
+ * of its own as SystemC can only elaborate once.
+ */
+
+#include <algorithm>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <scc/report.h>
+#include <scc/tracer.h>
+#include <sstream>
+#include <string>
+#include <systemc>
+#include <tlm/scc/initiator_mixin.h>
+#include <tlm/scc/lwtr/tlm2_lwtr.h>
+#include <tlm/scc/scv/tlm_recorder_module.h>
+#include <tlm/scc/target_mixin.h>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace po = boost::program_options;
+
+namespace {
+const size_t ERROR_IN_COMMAND_LINE = 1;
+const size_t SUCCESS = 0;
+const size_t ERROR_UNHANDLED_EXCEPTION = 2;
+
+struct backend {
+    char const* name;
+    scc::tracer::file_type type;
+};
+// NONE has to come first as it is the baseline of the overhead, without SQLite support the sqlite entry falls back
+// to the text format
+backend const backends[] = {{"none", scc::tracer::NONE},
+                            {"text", scc::tracer::TEXT},
+                            {"lz4", scc::tracer::COMPRESSED},
+                            {"sqlite", scc::tracer::SQLITE},
+                            {"ftr", scc::tracer::FTR},
+                            {"cftr", scc::tracer::CFTR},
+                            {"lwftr", scc::tracer::LWFTR},
+                            {"lwcftr", scc::tracer::LWCFTR}};
+
+struct bench_config {
+    uint64_t transactions;
+    unsigned length;
+};
+
+struct bench_result {
+    double b_secs;
+    double nb_secs;
+    double total_secs;
+};
+//! a target answering all accesses immediately, non-blocking accesses are completed using the return path
+struct bench_target : public sc_core::sc_module {
+    tlm::scc::target_mixin<tlm::tlm_target_socket<scc::LT>> socket{"socket"};
+
+    explicit bench_target(sc_core::sc_module_name const& nm)
+    : sc_core::sc_module(nm) {
+        socket.register_b_transport([](tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+            trans.set_response_status(tlm::TLM_OK_RESPONSE);
+            delay += sc_core::sc_time(1, sc_core::SC_NS);
+        });
+        socket.register_nb_transport_fw(
+            [](tlm::tlm_generic_payload& trans, tlm::tlm_phase& phase, sc_core::sc_time& delay) -> tlm::tlm_sync_enum {
+                if(phase == tlm::BEGIN_REQ) {
+                    trans.set_response_status(tlm::TLM_OK_RESPONSE);
+                    phase = tlm::BEGIN_RESP;
+                    delay += sc_core::sc_time(1, sc_core::SC_NS);
+                    return tlm::TLM_UPDATED;
+                }
+                return tlm::TLM_COMPLETED;
+            });
+    }
+};
+//! the initiator issuing the transactions back to back, each one 10ns after the previous one
+template <typename RECORDER> struct bench_top : public sc_core::sc_module {
+    tlm::scc::initiator_mixin<tlm::tlm_initiator_socket<scc::LT>> isck{"isck"};
+    RECORDER recorder{"recorder"};
+    bench_target target{"target"};
+
+    bench_top(sc_core::sc_module_name const& nm, bench_config const& cfg, bench_result& res)
+    : sc_core::sc_module(nm)
+    , cfg(cfg)
+    , res(res)
+    , data(cfg.length) {
+        SC_HAS_PROCESS(bench_top);
+        SC_THREAD(run);
+        isck(recorder.ts);
+        recorder.is(target.socket);
+    }
+
+    void run() {
+        tlm::tlm_generic_payload trans;
+        trans.set_data_ptr(data.data());
+        trans.set_data_length(cfg.length);
+        trans.set_streaming_width(cfg.length);
+        sc_core::sc_time const period(10, sc_core::SC_NS);
+        auto start = std::chrono::high_resolution_clock::now();
+        for(uint64_t i = 0; i < cfg.transactions; ++i) {
+            prepare(trans, i);
+            sc_core::sc_time delay;
+            isck->b_transport(trans, delay);
+            sc_core::wait(period);
+        }
+        auto mid = std::chrono::high_resolution_clock::now();
+        for(uint64_t i = 0; i < cfg.transactions; ++i) {
+            prepare(trans, i);
+            tlm::tlm_phase phase{tlm::BEGIN_REQ};
+            sc_core::sc_time delay;
+            if(isck->nb_transport_fw(trans, phase, delay) == tlm::TLM_UPDATED && phase == tlm::BEGIN_RESP) {
+                phase = tlm::END_RESP;
+                delay = sc_core::SC_ZERO_TIME;
+                isck->nb_transport_fw(trans, phase, delay);
+            }
+            sc_core::wait(period);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        res.b_secs = std::chrono::duration<double>(mid - start).count();
+        res.nb_secs = std::chrono::duration<double>(end - mid).count();
+        sc_core::sc_stop();
+    }
+
+    void prepare(tlm::tlm_generic_payload& trans, uint64_t i) {
+        trans.set_command(i & 1 ? tlm::TLM_WRITE_COMMAND : tlm::TLM_READ_COMMAND);
+        trans.set_address((i * cfg.length) % (1 << 20));
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+    }
+
+    bench_config const& cfg;
+    bench_result& res;
+    std::vector<unsigned char> data;
+};
+
+uint64_t file_size(std::string const& name) {
+    uint64_t size = 0;
+    for(auto ext : {".txlog", ".txdb", ".ftr", ".cftr"}) {
+        std::ifstream is(name + ext, std::ios::binary | std::ios::ate);
+        if(is)
+            size += static_cast<uint64_t>(is.tellg());
+    }
+    return size;
+}
+//! the peak resident set size of the process in KiB
+long peak_rss() {
+#ifndef _WIN32
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) == 0)
+        return usage.ru_maxrss;
+#endif
+    return 0;
+}
+/**
+ * run the benchmark of one backend and print the wall clock times, the size of the database and the peak RSS
+ */
+int run_backend(backend const& be, bench_config const& cfg) {
+    auto name = std::string("tx_rec_bench_") + be.name;
+    bench_result res{0, 0, 0};
+    auto start = std::chrono::high_resolution_clock::now();
+    // the recorders pick up the database upon construction so the tracer needs to be created first
+    auto trace = std::unique_ptr<scc::tracer>(new scc::tracer(name, be.type, scc::tracer::NONE));
+    std::unique_ptr<sc_core::sc_module> top;
+    if(be.type == scc::tracer::LWFTR || be.type == scc::tracer::LWCFTR)
+        top.reset(new bench_top<tlm::scc::lwtr::tlm2_lwtr_recorder<scc::LT>>("top", cfg, res));
+    else
+        top.reset(new bench_top<tlm::scc::scv::tlm_recorder_module<scc::LT>>("top", cfg, res));
+    sc_core::sc_start();
+    // closing the database includes writing the outstanding data
+    trace.reset();
+    auto end = std::chrono::high_resolution_clock::now();
+    res.total_secs = std::chrono::duration<double>(end - start).count();
+    std::cout << "RESULT " << be.name << " " << res.b_secs << " " << res.nb_secs << " " << res.total_secs << " "
+              << file_size(name) << " " << peak_rss() << std::endl;
+    return SUCCESS;
+}
+} // namespace
+
+int sc_main(int argc, char* argv[]) {
+    sc_core::sc_report_handler::set_actions("/IEEE_Std_1666/deprecated", sc_core::SC_DO_NOTHING);
+    ///////////////////////////////////////////////////////////////////////////
+    // CLI argument parsing
+    ///////////////////////////////////////////////////////////////////////////
+    bench_config cfg;
+    po::options_description desc("Options");
+    // clang-format off
+    desc.add_options()
+            ("help,h",  "Print help message")
+            ("type", po::value<std::string>(), "the backend to measure, all backends are measured if not given")
+            ("transactions", po::value<uint64_t>(&cfg.transactions)->default_value(1000000), "number of blocking and of non-blocking transactions each")
+            ("length", po::value<unsigned>(&cfg.length)->default_value(8), "data length of the transactions in bytes");
+    // clang-format on
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm); // can throw
+        if(vm.count("help")) {
+            std::cout << "transaction recording benchmark" << std::endl << desc << std::endl;
+            return SUCCESS;
+        }
+        po::notify(vm);
+    } catch(po::error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    scc::init_logging(scc::log::WARNING);
+    if(vm.count("type")) {
+        for(auto& be : backends)
+            if(vm["type"].as<std::string>() == be.name)
+                return run_backend(be, cfg);
+        std::cerr << "ERROR: unknown backend " << vm["type"].as<std::string>() << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    // run each backend in a child process and collect the results
+    ///////////////////////////////////////////////////////////////////////////
+    std::cout << std::left << std::setw(10) << "backend" << std::right << std::setw(14) << "b [ns/tx]" << std::setw(14)
+              << "nb [ns/tx]" << std::setw(12) << "total [s]" << std::setw(14) << "bytes/tx" << std::setw(16)
+              << "peak RSS [MB]" << std::endl;
+    for(auto& be : backends) {
+        std::stringstream cmd;
+        cmd << argv[0] << " --type " << be.name << " --transactions " << cfg.transactions << " --length "
+            << cfg.length;
+        auto out_name = std::string("tx_rec_bench_") + be.name + ".result";
+        cmd << " > " << out_name;
+        if(std::system(cmd.str().c_str()) != 0) {
+            std::cerr << "ERROR: running backend " << be.name << " failed" << std::endl;
+            return ERROR_UNHANDLED_EXCEPTION;
+        }
+        std::ifstream is(out_name);
+        std::string line, tag, nm;
+        bench_result res{0, 0, 0};
+        uint64_t size = 0;
+        long rss = 0;
+        while(std::getline(is, line))
+            if(line.compare(0, 7, "RESULT ") == 0)
+                std::istringstream(line) >> tag >> nm >> res.b_secs >> res.nb_secs >> res.total_secs >> size >> rss;
+        auto count = static_cast<double>(std::max<uint64_t>(cfg.transactions, 1));
+        std::cout << std::left << std::setw(10) << be.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(14) << res.b_secs * 1e9 / count << std::setw(14) << res.nb_secs * 1e9 / count
+                  << std::setprecision(3) << std::setw(12) << res.total_secs << std::setprecision(1) << std::setw(14)
+                  << size / (2 * count) << std::setw(16) << rss / 1024.0 << std::endl;
+    }
+    return SUCCESS;
+}
@@ -84,7 +84,7 @@ void ahb_initiator_b::transport(payload_type& trans, bool blocking) {
         auto& txs = it->second;
         auto timing_e = trans.set_extension<atp::timing_params>(nullptr);
 
-        txs->active_tx = &trans;
+        txs->active_tx = tlm::scc::tlm_gp_unique_ptr(&trans);
         SCCTRACE(SCMOD) << "start transport req for id=" << &trans;
 
         auto* ext = trans.get_extension<ahb::ahb_extension>();
@@ -93,8 +93,7 @@ void ahb_initiator_b::transport(payload_type& trans, bool blocking) {
             trans.is_read() ? (timing_e ? timing_e->artv : artv.value) : (timing_e ? timing_e->awtv : awtv.value);
         if(delay_in_cycles)
             delay_in_cycles--; // one cycle implicitly executed
-        for(unsigned i = 0; i < delay_in_cycles; ++i)
-            wait(clk_i.posedge_event());
+        clk_edges.wait(delay_in_cycles);
         auto burst_length = 0U;
         switch(ext->get_burst()) {
         case ahb::burst_e::SINGLE:
@@ -124,7 +123,7 @@ void ahb_initiator_b::transport(payload_type& trans, bool blocking) {
             next_phase = res;
         else if(res != tlm::END_REQ)
             SCCERR(SCMOD) << "target did not repsond with END_REQ to a BEGIN_REQ";
-        wait(clk_i.posedge_event());
+        clk_edges.wait();
         auto finished = false;
         const auto exp_burst_length = burst_length;
         data_chnl.wait();
@@ -137,8 +136,7 @@ void ahb_initiator_b::transport(payload_type& trans, bool blocking) {
             if(std::get<0>(entry) == &trans && std::get<1>(entry) == tlm::BEGIN_RESP) {
                 SCCTRACE(SCMOD) << "received last beat of tx with id=" << &trans;
                 auto delay_in_cycles = timing_e ? (trans.is_read() ? timing_e->rbr : timing_e->br) : br.value;
-                for(unsigned i = 0; i < delay_in_cycles; ++i)
-                    wait(clk_i.posedge_event());
+                clk_edges.wait(delay_in_cycles);
                 trans.set_response_status(tlm::TLM_OK_RESPONSE);
                 burst_length--;
                 tlm::tlm_phase phase = tlm::END_RESP;
@@ -147,14 +145,13 @@ void ahb_initiator_b::transport(payload_type& trans, bool blocking) {
                 if(burst_length)
                     SCCWARN(SCMOD) << "got wrong number of burst beats, expected " << exp_burst_length << ", got "
                                    << exp_burst_length - burst_length;
-                wait(clk_i.posedge_event());
+                clk_edges.wait();
                 finished = true;
             } else if(std::get<0>(entry) == &trans &&
                       std::get<1>(entry) == ahb::BEGIN_PARTIAL_RESP) { // RDAT without CRESP case
                 SCCTRACE(SCMOD) << "received beat of tx with id=" << &trans;
                 auto delay_in_cycles = timing_e ? timing_e->rbr : rbr.value;
-                for(unsigned i = 0; i < delay_in_cycles; ++i)
-                    wait(clk_i.posedge_event());
+                clk_edges.wait(delay_in_cycles);
                 burst_length--;
                 tlm::tlm_phase phase = ahb::END_PARTIAL_RESP;
                 sc_time delay = clk_if ? clk_if->period() - 1_ps : SC_ZERO_TIME;
@@ -167,7 +164,7 @@ void ahb_initiator_b::transport(payload_type& trans, bool blocking) {
         } while(!finished);
         data_chnl.post();
         SCCTRACE(SCMOD) << "finished non-blocking protocol";
-        txs->active_tx = nullptr;
+        txs->active_tx.reset();
         any_tx_finished.notify(SC_ZERO_TIME);
     }
     SCCTRACE(SCMOD) << "finished transport req for id=" << &trans;
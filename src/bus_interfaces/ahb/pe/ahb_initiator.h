@@ -18,9 +18,11 @@
 #define _BUS_AHB_PE_INITIATOR_H_
 
 #include <ahb/ahb_tlm.h>
+#include <scc/clock_edges.h>
 #include <scc/ordered_semaphore.h>
 #include <scc/peq.h>
 #include <systemc>
+#include <tlm/scc/tlm_gp_shared.h>
 #include <tlm_utils/peq_with_get.h>
 #include <tuple>
 #include <unordered_map>
@@ -99,7 +101,7 @@ protected:
     std::function<unsigned(payload_type& trans)>* snoop_cb{nullptr};
 
     struct tx_state {
-        payload_type* active_tx{nullptr};
+        tlm::scc::tlm_gp_unique_ptr active_tx;
         scc::peq<std::tuple<payload_type*, tlm::tlm_phase>> peq;
         // scc::ordered_semaphore mtx{1};
     };
@@ -115,7 +117,11 @@ protected:
 
 private:
     sc_core::sc_clock* clk_if{nullptr};
-    void end_of_elaboration() override { clk_if = dynamic_cast<sc_core::sc_clock*>(clk_i.get_interface()); }
+    scc::clock_edges clk_edges;
+    void end_of_elaboration() override {
+        clk_if = dynamic_cast<sc_core::sc_clock*>(clk_i.get_interface());
+        clk_edges.resolve(clk_i);
+    }
 
     tlm::tlm_phase send(payload_type& trans, ahb_initiator_b::tx_state* txs, tlm::tlm_phase phase);
 
@@ -0,0 +1,161 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#include "ahb_pipelined_initiator.h"
+#include <atp/timing_params.h>
+#include <scc/report.h>
+
+using namespace sc_core;
+using namespace ahb;
+using namespace ahb::pe;
+
+namespace {
+unsigned get_burst_length(ahb::burst_e burst) {
+    switch(burst) {
+    case ahb::burst_e::WRAP4:
+    case ahb::burst_e::INCR4:
+        return 4;
+    case ahb::burst_e::WRAP8:
+    case ahb::burst_e::INCR8:
+        return 8;
+    case ahb::burst_e::WRAP16:
+    case ahb::burst_e::INCR16:
+        return 16;
+    default:
+        return 1;
+    }
+}
+} // anonymous namespace
+
+ahb_pipelined_initiator_b::ahb_pipelined_initiator_b(
+    sc_core::sc_module_name nm, sc_core::sc_port_b<tlm::tlm_fw_transport_if<tlm::tlm_base_protocol_types>>& port,
+    size_t transfer_width)
+: sc_module(nm)
+, transfer_width_in_bytes(transfer_width / 8)
+, socket_fw(port) {
+    add_attribute(artv);
+    add_attribute(awtv);
+    add_attribute(rbr);
+    add_attribute(br);
+}
+
+tlm::tlm_sync_enum ahb_pipelined_initiator_b::nb_transport_bw(payload_type& trans, phase_type& phase,
+                                                              sc_core::sc_time& t) {
+    auto* slot = find_slot(trans);
+    sc_assert(slot && slot->count < inbox_size);
+    slot->inbox[(slot->head + slot->count) % inbox_size] = std::make_pair(phase, sc_time_stamp() + t);
+    slot->count++;
+    slot->evt.notify(t);
+    return tlm::TLM_ACCEPTED;
+}
+
+ahb_pipelined_initiator_b::tx_slot* ahb_pipelined_initiator_b::find_slot(payload_type const& trans) {
+    for(auto& slot : slots)
+        if(slot.trans == &trans)
+            return &slot;
+    return nullptr;
+}
+
+tlm::tlm_phase ahb_pipelined_initiator_b::get_phase(tx_slot& slot) {
+    while(!slot.count)
+        wait(slot.evt);
+    auto& entry = slot.inbox[slot.head];
+    if(entry.second > sc_time_stamp())
+        wait(entry.second - sc_time_stamp());
+    slot.head = (slot.head + 1) % inbox_size;
+    slot.count--;
+    return entry.first;
+}
+
+tlm::tlm_phase ahb_pipelined_initiator_b::send(tx_slot& slot, tlm::tlm_phase phase) {
+    sc_core::sc_time delay;
+    SCCTRACE(SCMOD) << "Send REQ";
+    tlm::tlm_sync_enum ret = socket_fw->nb_transport_fw(*slot.trans, phase, delay);
+    if(ret == tlm::TLM_UPDATED) {
+        wait(delay);
+        return phase;
+    }
+    return get_phase(slot);
+}
+
+void ahb_pipelined_initiator_b::transport(payload_type& trans, bool blocking) {
+    SCCTRACE(SCMOD) << "got transport req for id=" << &trans;
+    if(blocking) {
+        sc_time t;
+        socket_fw->b_transport(trans, t);
+        SCCTRACE(SCMOD) << "finished transport req for id=" << &trans;
+        return;
+    }
+    auto timing_e = trans.set_extension<atp::timing_params>(nullptr);
+    auto* ext = trans.get_extension<ahb::ahb_extension>();
+    auto delay_in_cycles =
+        trans.is_read() ? (timing_e ? timing_e->artv : artv.value) : (timing_e ? timing_e->awtv : awtv.value);
+    if(delay_in_cycles)
+        delay_in_cycles--; // one cycle implicitly executed
+    clk_edges.wait(delay_in_cycles);
+    auto burst_length = get_burst_length(ext->get_burst());
+    const auto exp_burst_length = burst_length;
+    tlm::tlm_phase next_phase{tlm::UNINITIALIZED_PHASE};
+    addr_chnl.wait();
+    // the address phases are sequential so the slot taken here is free again, its predecessor in the ring has
+    // finished its data phase or holds the data channel
+    auto& slot = slots[slot_tail];
+    sc_assert(slot.trans == nullptr);
+    slot_tail = (slot_tail + 1) % pipeline_depth;
+    slot.trans = &trans;
+    SCCTRACE(SCMOD) << "starting address phase of tx with id=" << &trans;
+    auto res = send(slot, tlm::BEGIN_REQ);
+    if(res == ahb::BEGIN_PARTIAL_RESP || res == tlm::BEGIN_RESP)
+        next_phase = res;
+    else if(res != tlm::END_REQ)
+        SCCERR(SCMOD) << "target did not repsond with END_REQ to a BEGIN_REQ";
+    clk_edges.wait(1);
+    data_chnl.wait();
+    addr_chnl.post();
+    auto finished = false;
+    do {
+        auto phase = next_phase == tlm::UNINITIALIZED_PHASE ? get_phase(slot) : next_phase;
+        next_phase = tlm::UNINITIALIZED_PHASE;
+        if(phase == tlm::BEGIN_RESP) {
+            SCCTRACE(SCMOD) << "received last beat of tx with id=" << &trans;
+            clk_edges.wait(timing_e ? (trans.is_read() ? timing_e->rbr : timing_e->br) : br.value);
+            trans.set_response_status(tlm::TLM_OK_RESPONSE);
+            burst_length--;
+            tlm::tlm_phase end_phase = tlm::END_RESP;
+            sc_time delay = clk_if ? clk_if->period() - 1_ps : SC_ZERO_TIME;
+            socket_fw->nb_transport_fw(trans, end_phase, delay);
+            if(burst_length)
+                SCCWARN(SCMOD) << "got wrong number of burst beats, expected " << exp_burst_length << ", got "
+                               << exp_burst_length - burst_length;
+            clk_edges.wait(1);
+            finished = true;
+        } else if(phase == ahb::BEGIN_PARTIAL_RESP) {
+            SCCTRACE(SCMOD) << "received beat of tx with id=" << &trans;
+            clk_edges.wait(timing_e ? timing_e->rbr : rbr.value);
+            burst_length--;
+            tlm::tlm_phase end_phase = ahb::END_PARTIAL_RESP;
+            sc_time delay = clk_if ? clk_if->period() - 1_ps : SC_ZERO_TIME;
+            if(socket_fw->nb_transport_fw(trans, end_phase, delay) == tlm::TLM_UPDATED) {
+                next_phase = end_phase;
+                wait(delay);
+            }
+        }
+    } while(!finished);
+    slot.trans = nullptr;
+    slot.head = slot.count = 0;
+    data_chnl.post();
+    SCCTRACE(SCMOD) << "finished transport req for id=" << &trans;
+}
@@ -0,0 +1,174 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _BUS_AHB_PE_PIPELINED_INITIATOR_H_
+#define _BUS_AHB_PE_PIPELINED_INITIATOR_H_
+
+#include <ahb/ahb_tlm.h>
+#include <array>
+#include <scc/clock_edges.h>
+#include <scc/ordered_semaphore.h>
+#include <systemc>
+
+//! TLM2.0 components modeling AHB
+namespace ahb {
+//! protocol engine implementations
+namespace pe {
+/**
+ * @brief a pipelined AHB initiator protocol engine meant for loosely timed models needing AT timing, e.g. bandwidth
+ * simulations
+ *
+ * The engine behaves like ahb_initiator_b towards the target but is built for throughput: the address phase of a
+ * transaction overlaps the data phase of its predecessor and the state of the transactions in flight is held in a
+ * fixed ring of slots (one per pipeline stage) so no heap allocation happens per transaction. The idle cycles are
+ * waited for using scc::clock_edges instead of counting single clock edges.
+ */
+class ahb_pipelined_initiator_b : public sc_core::sc_module,
+                                  public tlm::tlm_bw_transport_if<tlm::tlm_base_protocol_types> {
+public:
+    SC_HAS_PROCESS(ahb_pipelined_initiator_b);
+
+    using payload_type = tlm::tlm_generic_payload;
+    using phase_type = tlm::tlm_phase;
+
+    sc_core::sc_in<bool> clk_i{"clk_i"};
+
+    tlm::tlm_sync_enum nb_transport_bw(payload_type& trans, phase_type& phase, sc_core::sc_time& t) override;
+
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range) override {}
+
+    size_t get_transferwith_in_bytes() const { return transfer_width_in_bytes; }
+    /**
+     * @brief The forward transport function. It behaves blocking and is re-entrant.
+     *
+     * This function initiates the forward transport either using b_transport() if blocking=true
+     *  or the nb_transport_* interface.
+     *
+     * @param trans the transaction to send
+     * @param blocking execute in using the blocking interface
+     */
+    void transport(payload_type& trans, bool blocking);
+
+    ahb_pipelined_initiator_b(sc_core::sc_module_name nm,
+                              sc_core::sc_port_b<tlm::tlm_fw_transport_if<tlm::tlm_base_protocol_types>>& port,
+                              size_t transfer_width);
+
+    ahb_pipelined_initiator_b() = delete;
+
+    ahb_pipelined_initiator_b(ahb_pipelined_initiator_b const&) = delete;
+
+    ahb_pipelined_initiator_b(ahb_pipelined_initiator_b&&) = delete;
+
+    ahb_pipelined_initiator_b& operator=(ahb_pipelined_initiator_b const&) = delete;
+
+    ahb_pipelined_initiator_b& operator=(ahb_pipelined_initiator_b&&) = delete;
+
+    //! Read address valid to next read address valid
+    sc_core::sc_attribute<unsigned> artv{"artv", 0};
+    //! Write address valid to next write address valid
+    sc_core::sc_attribute<unsigned> awtv{"awtv", 0};
+    //! Read data valid to same beat ready
+    sc_core::sc_attribute<unsigned> rbr{"rbr", 0};
+    //! Write response valid to ready
+    sc_core::sc_attribute<unsigned> br{"br", 0};
+
+protected:
+    //! the number of transactions in flight, one in the address and one in the data phase
+    static constexpr unsigned pipeline_depth = 2;
+    //! the maximum number of backward path calls of a transaction not yet consumed by the engine
+    static constexpr unsigned inbox_size = 4;
+    /**
+     * @brief the state of a transaction in flight
+     */
+    struct tx_slot {
+        payload_type* trans{nullptr};
+        //! the phases received on the backward path together with the time they become effective
+        std::array<std::pair<tlm::tlm_phase, sc_core::sc_time>, inbox_size> inbox;
+        unsigned head{0}, count{0};
+        sc_core::sc_event evt;
+    };
+
+    const size_t transfer_width_in_bytes;
+
+    sc_core::sc_port_b<tlm::tlm_fw_transport_if<tlm::tlm_base_protocol_types>>& socket_fw;
+
+    std::array<tx_slot, pipeline_depth> slots;
+    //! the slots are taken in the order of the address phases and released in the same order by the data phases
+    unsigned slot_tail{0};
+
+    scc::ordered_semaphore_t<1> addr_chnl;
+
+    scc::ordered_semaphore_t<1> data_chnl;
+
+private:
+    sc_core::sc_clock* clk_if{nullptr};
+
+    scc::clock_edges clk_edges;
+
+    void end_of_elaboration() override {
+        clk_if = dynamic_cast<sc_core::sc_clock*>(clk_i.get_interface());
+        clk_edges.resolve(clk_i);
+    }
+
+    tx_slot* find_slot(payload_type const& trans);
+
+    tlm::tlm_phase get_phase(tx_slot& slot);
+
+    tlm::tlm_phase send(tx_slot& slot, tlm::tlm_phase phase);
+};
+
+/**
+ * the pipelined ahb initiator socket protocol engine adapted to a particular initiator socket configuration
+ */
+template <unsigned int BUSWIDTH = 32, typename TYPES = tlm::tlm_base_protocol_types, int N = 1,
+          sc_core::sc_port_policy POL = sc_core::SC_ONE_OR_MORE_BOUND>
+class ahb3_pipelined_initiator : public ahb_pipelined_initiator_b {
+public:
+    using base = ahb_pipelined_initiator_b;
+
+    using payload_type = base::payload_type;
+    using phase_type = base::phase_type;
+    /**
+     * @brief the constructor
+     *
+     * @param nm the module name
+     * @param socket reference to the initiator socket used to send and receive transactions
+     */
+    ahb3_pipelined_initiator(const sc_core::sc_module_name& nm,
+                             tlm::tlm_initiator_socket<BUSWIDTH, TYPES, N, POL>& socket)
+    : ahb_pipelined_initiator_b(nm, socket.get_base_port(), BUSWIDTH)
+    , socket(socket) {
+        socket(*this);
+    }
+
+    ahb3_pipelined_initiator() = delete;
+
+    ahb3_pipelined_initiator(ahb3_pipelined_initiator const&) = delete;
+
+    ahb3_pipelined_initiator(ahb3_pipelined_initiator&&) = delete;
+
+    ahb3_pipelined_initiator& operator=(ahb3_pipelined_initiator const&) = delete;
+
+    ahb3_pipelined_initiator& operator=(ahb3_pipelined_initiator&&) = delete;
+
+private:
+    tlm::tlm_initiator_socket<BUSWIDTH, TYPES, N, POL>& socket;
+};
+
+} /* namespace pe */
+} /* namespace ahb */
+
+#endif /* _BUS_AHB_PE_PIPELINED_INITIATOR_H_ */
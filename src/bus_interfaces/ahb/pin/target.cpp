@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2019-2022 MINRES Technologies GmbH
+ * Copyright 2019-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -27,70 +27,93 @@ using namespace ahb::pin;
 using namespace sc_core;
 
 template <unsigned DWIDTH, unsigned AWIDTH>
-target<DWIDTH, AWIDTH>::target(const sc_module_name& nm)
+target<DWIDTH, AWIDTH>::target(const sc_module_name& nm, bool method_based)
 : sc_module(nm) {
     SC_HAS_PROCESS(target);
-    SC_THREAD(bfm_thread);
-    sensitive << HCLK_i.pos();
+    if(method_based) {
+        SC_METHOD(bfm_method);
+        sensitive << HCLK_i.pos();
+        dont_initialize();
+    } else {
+        SC_THREAD(bfm_thread);
+        sensitive << HCLK_i.pos();
+    }
 }
 
 template <unsigned DWIDTH, unsigned AWIDTH> target<DWIDTH, AWIDTH>::~target() = default;
 
 template <unsigned DWIDTH, unsigned AWIDTH> void target<DWIDTH, AWIDTH>::bfm_thread() {
-    tlm::scc::tlm_mm<>& mm = tlm::scc::tlm_mm<>::get();
-    auto const log_width = scc::ilog2(DWIDTH / 8);
-    auto beat_cnt = 0U;
     wait(SC_ZERO_TIME);
     while(true) {
         wait();
-        if(!HRESETn_i.read()) {
-            HREADY_o.write(true);
-            data_payload = nullptr;
-            addr_payload = nullptr;
-        } else {
-            if(HSEL_i.read()) {
-                tlm::tlm_generic_payload* gp{nullptr};
-                if(HTRANS_i.read() > 0x1) { // HTRANS/BUSY or IDLE check
-                    gp = mm.allocate();
-                    gp->acquire();
-                    gp->set_address(HADDR_i.read());
-                    if(HWRITE_i.read())
-                        gp->set_write();
-                    else
-                        gp->set_read();
-                    // gp->set_command(HWRITE_i.read()?tlm::TLM_WRITE_COMMAND:tlm::TLM_READ_COMMAND);
-                    auto* ext = new ahb_extension();
-                    gp->set_extension(ext);
-                    ext->set_locked(HMASTLOCK_i.read());
-                    ext->set_protection(HPROT_i.read());
-                    ext->set_burst(static_cast<ahb::burst_e>(HBURST_i.read().to_uint()));
-                    size_t size = HSIZE_i.read();
-                    if(size > log_width)
-                        SCCERR(SCMOD) << "Access size (" << size << ") is larger than bus wDWIDTH(" << log_width << ")!";
-                    unsigned length = (1 << size) * (1 << static_cast<unsigned>(ext->get_burst()));
-                    gp->set_data_length(length);
-                    gp->set_streaming_width(length);
-                    gp->set_data_ptr(new uint8_t[length]);
-                    if(addr_payload)
-                        HREADY_o.write(false);
-                    else {
-                        HREADY_o.write(true);
-                        addr_payload = gp;
-                    }
-                }
-                if(data_payload && data_payload->is_write())
-                    handle_data_phase(beat_cnt);
-                if(gp && gp->is_read()) {
-                    sc_time delay;
-                    isckt->b_transport(*gp, delay);
-                }
-                if(!data_payload) {
-                    data_payload = addr_payload;
-                    addr_payload = nullptr;
+        clock_cycle();
+    }
+}
+
+template <unsigned DWIDTH, unsigned AWIDTH> void target<DWIDTH, AWIDTH>::bfm_method() {
+    if(waiting_for_activity) { // a control signal changed, sample the bus with the next clock edge
+        waiting_for_activity = false;
+        next_trigger(HCLK_i.posedge_event());
+        return;
+    }
+    clock_cycle();
+    // nothing in flight and nothing requested: skip the clock cycles until the master or the reset changes something
+    if(!addr_payload && !data_payload && (!HRESETn_i.read() || !HSEL_i.read() || HTRANS_i.read() < 0x2)) {
+        waiting_for_activity = true;
+        next_trigger(HTRANS_i.value_changed_event() | HSEL_i.value_changed_event() |
+                     HRESETn_i.value_changed_event());
+    }
+}
+
+template <unsigned DWIDTH, unsigned AWIDTH> void target<DWIDTH, AWIDTH>::clock_cycle() {
+    auto const log_width = scc::ilog2(DWIDTH / 8);
+    if(!HRESETn_i.read()) {
+        HREADY_o.write(true);
+        data_payload = nullptr;
+        addr_payload = nullptr;
+    } else {
+        if(HSEL_i.read()) {
+            tlm::tlm_generic_payload* gp{nullptr};
+            if(HTRANS_i.read() > 0x1) { // HTRANS/BUSY or IDLE check
+                gp = tlm::scc::tlm_mm<>::get().allocate();
+                gp->acquire();
+                gp->set_address(HADDR_i.read());
+                if(HWRITE_i.read())
+                    gp->set_write();
+                else
+                    gp->set_read();
+                // gp->set_command(HWRITE_i.read()?tlm::TLM_WRITE_COMMAND:tlm::TLM_READ_COMMAND);
+                auto* ext = new ahb_extension();
+                gp->set_extension(ext);
+                ext->set_locked(HMASTLOCK_i.read());
+                ext->set_protection(HPROT_i.read());
+                ext->set_burst(static_cast<ahb::burst_e>(HBURST_i.read().to_uint()));
+                size_t size = HSIZE_i.read();
+                if(size > log_width)
+                    SCCERR(SCMOD) << "Access size (" << size << ") is larger than bus wDWIDTH(" << log_width << ")!";
+                unsigned length = (1 << size) * (1 << static_cast<unsigned>(ext->get_burst()));
+                gp->set_data_length(length);
+                gp->set_streaming_width(length);
+                gp->set_data_ptr(new uint8_t[length]);
+                if(addr_payload)
+                    HREADY_o.write(false);
+                else {
+                    HREADY_o.write(true);
+                    addr_payload = gp;
                 }
-                if(data_payload && data_payload->is_read())
-                    handle_data_phase(beat_cnt);
             }
+            if(data_payload && data_payload->is_write())
+                handle_data_phase(beat_cnt);
+            if(gp && gp->is_read()) {
+                sc_time delay;
+                isckt->b_transport(*gp, delay);
+            }
+            if(!data_payload) {
+                data_payload = addr_payload;
+                addr_payload = nullptr;
+            }
+            if(data_payload && data_payload->is_read())
+                handle_data_phase(beat_cnt);
         }
     }
 }
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2019-2022 MINRES Technologies GmbH
+ * Copyright 2019-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -48,12 +48,25 @@ public:
 
     tlm::scc::initiator_mixin<tlm::tlm_initiator_socket<0>> isckt{"isckt"};
 
-    target(const sc_core::sc_module_name& nm);
+    /**
+     * @brief the constructor
+     *
+     * @param nm the module name
+     * @param method_based if set the bus is sampled by an SC_METHOD which is not triggered by the clock while the
+     * target is not selected or HTRANS signals IDLE or BUSY (no context switch per clock cycle). In this case the
+     * b_transport of the target bound to isckt must not call wait().
+     */
+    target(const sc_core::sc_module_name& nm, bool method_based = false);
     virtual ~target();
 
 private:
     void bfm_thread();
+    void bfm_method();
+    void clock_cycle();
     void handle_data_phase(unsigned& beat_cnt);
+    unsigned beat_cnt{0};
+    //! set while bfm_method waits for a change of the control signals instead of the clock
+    bool waiting_for_activity{false};
     tlm::tlm_generic_payload* addr_payload{nullptr};
     tlm::tlm_generic_payload* data_payload{nullptr};
     sc_core::sc_fifo<tlm::tlm_generic_payload*> active{"active_tx", 1};
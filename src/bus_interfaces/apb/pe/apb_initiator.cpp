@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2020-2022 MINRES Technologies GmbH
+ * Copyright 2020-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -57,7 +57,9 @@ void apb_initiator_b::transport(payload_type& trans, bool blocking) {
         auto res = socket_fw->nb_transport_fw(trans, phase, t);
         if(res == tlm::TLM_COMPLETED || (res == tlm::TLM_UPDATED && phase != tlm::END_REQ && phase != tlm::BEGIN_RESP))
             SCCFATAL(SCMOD) << "target did not respsond with END_REQ or BEGIN_RESP to a BEGIN_REQ";
-        if(res != tlm::TLM_UPDATED || phase != tlm::BEGIN_RESP) {
+        if(res == tlm::TLM_UPDATED && phase == tlm::BEGIN_RESP)
+            wait(t); // the target completed setup and access phase within the call
+        else {
             payload_type* gp{nullptr};
             while(phase != tlm::BEGIN_RESP) {
                 std::tie(gp, phase) = peq.get();
@@ -66,7 +68,7 @@ void apb_initiator_b::transport(payload_type& trans, bool blocking) {
                 if(phase != tlm::END_REQ && phase != tlm::BEGIN_RESP)
                     SCCFATAL(SCMOD) << "target did not respsond with END_REQ or BEGIN_RESP to a BEGIN_REQ";
                 if(phase == tlm::END_REQ)
-                    wait(clk_i.posedge_event());
+                    clk_edges.wait();
             }
         }
         phase = tlm::END_RESP;
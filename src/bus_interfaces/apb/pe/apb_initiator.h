@@ -17,6 +17,7 @@
 #ifndef _BUS_APB_PE_APB_INITIATOR_H_
 #define _BUS_APB_PE_APB_INITIATOR_H_
 
+#include <scc/clock_edges.h>
 #include <scc/ordered_semaphore.h>
 #include <scc/peq.h>
 #include <tlm>
@@ -82,7 +83,11 @@ protected:
 
 private:
     sc_core::sc_clock* clk_if{nullptr};
-    void end_of_elaboration() override { clk_if = dynamic_cast<sc_core::sc_clock*>(clk_i.get_interface()); }
+    scc::clock_edges clk_edges;
+    void end_of_elaboration() override {
+        clk_if = dynamic_cast<sc_core::sc_clock*>(clk_i.get_interface());
+        clk_edges.resolve(clk_i);
+    }
 
     unsigned m_clock_counter{0};
     unsigned m_prev_clk_cnt{0};
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2019-2022 MINRES Technologies GmbH
+ * Copyright 2019-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -15,6 +15,7 @@
  *******************************************************************************/
 
 #include "apb_target.h"
+#include <scc/process_profiler.h>
 #include <scc/report.h>
 #include <systemc>
 #include <tuple>
@@ -32,6 +33,7 @@ apb_target_b::apb_target_b(const sc_core::sc_module_name& nm,
                            size_t transfer_width)
 : sc_module(nm)
 , socket_bw(port) {
+    add_attribute(zero_wait_states);
     SC_METHOD(response);
     dont_initialize();
     sensitive << clk_i.pos();
@@ -53,11 +55,16 @@ void apb_target_b::b_transport(payload_type& trans, sc_time& t) {
 tlm_sync_enum apb_target_b::nb_transport_fw(payload_type& trans, phase_type& phase, sc_time& t) {
     if(phase == tlm::BEGIN_REQ) {
         sc_assert(active_tx == nullptr);
-        if(operation_cb)
-            operation_cb(trans);
+        auto latency = operation_cb ? operation_cb(trans) : 0U;
         active_tx = &trans;
         if(trans.has_mm())
             trans.acquire();
+        if(zero_wait_states.value && latency == 0) { // setup and access phase are resolved in this call
+            trans.set_response_status(tlm::TLM_OK_RESPONSE);
+            phase = tlm::BEGIN_RESP;
+            t += sc_time(clk_if ? clk_if->period() - 1_ps : SC_ZERO_TIME);
+            return tlm::TLM_UPDATED;
+        }
         if(mhndl.valid())
             mhndl.enable();
         phase = tlm::END_REQ;
@@ -69,6 +76,11 @@ tlm_sync_enum apb_target_b::nb_transport_fw(payload_type& trans, phase_type& pha
             active_tx->release();
         active_tx = nullptr;
         return tlm::TLM_COMPLETED;
+    } else if(phase == tlm::END_RESP && active_tx == &trans) {
+        if(active_tx->has_mm())
+            active_tx->release();
+        active_tx = nullptr;
+        return tlm::TLM_COMPLETED;
     }
     return tlm::TLM_ACCEPTED;
 }
@@ -81,6 +93,7 @@ bool apb_target_b::get_direct_mem_ptr(payload_type& trans, tlm_dmi& dmi_data) {
 unsigned int apb_target_b::transport_dbg(payload_type& trans) { return 0; }
 
 void apb_target_b::response() {
+    SCC_PROFILE_ACTIVATION();
     if(!mhndl.valid())
         mhndl = sc_get_current_process_handle();
     if(active_tx) {
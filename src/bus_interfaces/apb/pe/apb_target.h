@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2019-2022 MINRES Technologies GmbH
+ * Copyright 2019-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -55,6 +55,11 @@ public:
      */
 
     void set_operation_cb(std::function<unsigned(payload_type& trans)> cb) { operation_cb = cb; }
+    /**
+     * if set, transactions whose operation callback returns a latency of 0 are completed within the BEGIN_REQ call
+     * (BEGIN_RESP is returned with the access phase annotated) instead of responding from the clocked response method
+     */
+    sc_core::sc_attribute<bool> zero_wait_states{"zero_wait_states", false};
 
 protected:
     /**
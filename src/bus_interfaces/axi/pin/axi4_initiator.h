@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021-2022 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -20,9 +20,15 @@
 #include <axi/axi_tlm.h>
 #include <axi/fsm/base.h>
 #include <axi/fsm/protocol_fsm.h>
+#include <axi/pin/fast_forward.h>
 #include <axi/signal_if.h>
+#include <scc/cached_cci_param.h>
+#include <array>
+#include <deque>
 #include <systemc>
+#include <tlm/scc/tlm_extensions.h>
 #include <tlm_utils/peq_with_cb_and_phase.h>
+#include <vector>
 
 //! TLM2.0 components modeling AHB
 namespace axi {
@@ -30,13 +36,120 @@ namespace axi {
 namespace pin {
 
 using namespace axi::fsm;
+/**
+ * @brief FIFO queues of pointers per AXI ID
+ *
+ * The queues are singly linked lists of nodes taken from a pool so pushing and popping does not allocate once the
+ * pool has grown to the maximum number of queued entries. For IDs of up to DIRECT_BITS bits the queues are held in an
+ * array indexed by the ID, for wider IDs in a small map which holds the non-empty queues only.
+ *
+ * @tparam T the type of the queued objects
+ * @tparam IDWIDTH the width of the ID in bits
+ */
+template <typename T, unsigned IDWIDTH, unsigned DIRECT_BITS = 8> class id_fifos {
+public:
+    //! append e to the queue of id
+    void push(unsigned id, T* e) {
+        auto* n = alloc_node(e);
+        auto& q = get_queue(id);
+        if(q.tail)
+            q.tail->next = n;
+        else
+            q.head = n;
+        q.tail = n;
+    }
+    //! the oldest entry of the queue of id or nullptr if it is empty
+    T* front(unsigned id) const {
+        auto* q = find_queue(id);
+        return q && q->head ? q->head->value : nullptr;
+    }
+    //! remove the oldest entry of the queue of id
+    void pop(unsigned id) {
+        auto* q = find_queue(id);
+        if(!q || !q->head)
+            return;
+        auto* n = q->head;
+        q->head = n->next;
+        if(!q->head) {
+            q->tail = nullptr;
+            release_queue(id);
+        }
+        n->next = free_nodes;
+        free_nodes = n;
+    }
+
+private:
+    static constexpr bool direct = IDWIDTH <= DIRECT_BITS;
+    struct node {
+        T* value;
+        node* next;
+    };
+    struct queue {
+        node* head{nullptr};
+        node* tail{nullptr};
+    };
+
+    node* alloc_node(T* e) {
+        node* n = free_nodes;
+        if(n)
+            free_nodes = n->next;
+        else {
+            node_pool.emplace_back();
+            n = &node_pool.back();
+        }
+        n->value = e;
+        n->next = nullptr;
+        return n;
+    }
+
+    queue& get_queue(unsigned id) {
+        if(direct)
+            return queues[id & direct_mask];
+        for(auto& e : wide_queues)
+            if(e.first == id)
+                return e.second;
+        wide_queues.emplace_back(id, queue());
+        return wide_queues.back().second;
+    }
+
+    queue* find_queue(unsigned id) {
+        if(direct)
+            return &queues[id & direct_mask];
+        for(auto& e : wide_queues)
+            if(e.first == id)
+                return &e.second;
+        return nullptr;
+    }
+
+    const queue* find_queue(unsigned id) const { return const_cast<id_fifos*>(this)->find_queue(id); }
+
+    void release_queue(unsigned id) {
+        if(direct)
+            return;
+        for(auto it = wide_queues.begin(); it != wide_queues.end(); ++it)
+            if(it->first == id) {
+                *it = wide_queues.back();
+                wide_queues.pop_back();
+                return;
+            }
+    }
+
+    static constexpr unsigned direct_bits = direct ? IDWIDTH : 0;
+    static constexpr unsigned direct_mask = (1u << direct_bits) - 1;
+    std::array<queue, 1u << direct_bits> queues;
+    //! the non-empty queues of wide IDs
+    std::vector<std::pair<unsigned, queue>> wide_queues;
+    // a deque keeps the nodes in place when growing
+    std::deque<node> node_pool;
+    node* free_nodes{nullptr};
+};
 
 template <typename CFG>
 struct axi4_initiator : public sc_core::sc_module,
-                        public aw_ch<CFG, typename CFG::master_types>,
+                        public aw_ch_t<CFG, typename CFG::master_types>,
                         public wdata_ch<CFG, typename CFG::master_types>,
                         public b_ch<CFG, typename CFG::master_types>,
-                        public ar_ch<CFG, typename CFG::master_types>,
+                        public ar_ch_t<CFG, typename CFG::master_types>,
                         public rresp_ch<CFG, typename CFG::master_types>,
                         protected axi::fsm::base,
                         public axi::axi_fw_transport_if<axi::axi_protocol_types> {
@@ -48,6 +161,16 @@ struct axi4_initiator : public sc_core::sc_module,
     sc_core::sc_in<bool> clk_i{"clk_i"};
 
     axi::axi_target_socket<CFG::BUSWIDTH> tsckt{"tsckt"};
+    /**
+     * if set the adapter stops following the clock while no transaction is outstanding and neither RVALID nor BVALID
+     * is asserted, it resumes with the next clock edge after a transaction arrives or a valid gets asserted
+     */
+    scc::cached_cci_param<bool> idle_clock_gating{"idle_clock_gating", false};
+    /**
+     * if set and the signals lead to an axi4_target adapter having fast forwarding enabled as well the transactions
+     * bypass the pins and are annotated with the clock cycles of the handshakes, otherwise the pins are driven
+     */
+    cci::cci_param<bool> fast_forward{"fast_forward", false};
 
     axi4_initiator(sc_core::sc_module_name const& nm)
     : sc_core::sc_module(nm)
@@ -65,11 +188,21 @@ struct axi4_initiator : public sc_core::sc_module,
 
 private:
     void b_transport(payload_type& trans, sc_core::sc_time& t) override {
+        if(ff_downstream) {
+            t += fast_forward_registry::get_delay(tlm::BEGIN_REQ, clk_if) +
+                 fast_forward_registry::get_delay(tlm::BEGIN_RESP, clk_if);
+            ff_downstream->b_transport(trans, t);
+            return;
+        }
         trans.set_dmi_allowed(false);
         trans.set_response_status(tlm::TLM_OK_RESPONSE);
     }
 
     tlm::tlm_sync_enum nb_transport_fw(payload_type& trans, phase_type& phase, sc_core::sc_time& t) override {
+        if(ff_downstream) {
+            t += fast_forward_registry::get_delay(phase, clk_if);
+            return ff_downstream->nb_transport_fw(trans, phase, t);
+        }
         sc_core::sc_time delay; // FIXME: calculate delay correctly
         fw_peq.notify(trans, phase, delay);
         return tlm::TLM_ACCEPTED;
@@ -80,20 +213,40 @@ private:
         return false;
     }
 
-    unsigned int transport_dbg(payload_type& trans) override { return 0; }
+    unsigned int transport_dbg(payload_type& trans) override {
+        return ff_downstream ? ff_downstream->transport_dbg(trans) : 0;
+    }
 
-    void end_of_elaboration() override { clk_if = dynamic_cast<sc_core::sc_clock*>(clk_i.get_interface()); }
+    void end_of_elaboration() override {
+        clk_if = dynamic_cast<sc_core::sc_clock*>(clk_i.get_interface());
+        if(fast_forward.get_value())
+            fast_forward_registry::get().add_initiator(this->aw_valid, this->ar_valid, tsckt.operator->(),
+                                                       ff_downstream);
+    }
 
     fsm_handle* create_fsm_handle() { return new fsm_handle(); }
 
     void setup_callbacks(fsm_handle* fsm_hndl);
 
     void clk_delay() {
+        if(ff_downstream) { // the pins are bypassed so there is nothing to follow the clock for
+            next_trigger(ff_parked);
+            return;
+        }
+        if(clk_gated) { // woken up, follow the clock again starting with the next edge
+            clk_gated = false;
+            return;
+        }
         if(sc_core::sc_delta_count_at_current_time()<5) {
             clk_self.notify(sc_core::SC_ZERO_TIME);
             next_trigger(clk_self);
-        } else
+        } else {
             clk_delayed.notify(sc_core::SC_ZERO_TIME/*clk_if ? clk_if->period() - 1_ps : 1_ps*/);
+            if(idle_clock_gating && !pending_trans && !this->r_valid.read() && !this->b_valid.read()) {
+                clk_gated = true;
+                next_trigger(clk_wakeup | this->r_valid.posedge_event() | this->b_valid.posedge_event());
+            }
+        }
     }
 
     void ar_t();
@@ -105,23 +258,40 @@ private:
     std::array<fsm_handle*, 3> active_req;
     std::array<fsm_handle*, 3> active_resp;
     sc_core::sc_clock* clk_if;
-    sc_core::sc_event clk_delayed, clk_self, r_end_req_evt, aw_evt, ar_evt;
+    sc_core::sc_event clk_delayed, clk_self, clk_wakeup, r_end_req_evt, aw_evt, ar_evt;
+    //! the number of transactions between the begin of their request and the end of their response
+    unsigned pending_trans{0};
+    bool clk_gated{false};
+    //! the socket of the paired target adapter if the pins are bypassed
+    fast_forward_registry::fw_if* ff_downstream{nullptr};
+    //! never notified, parks clk_delay while the pins are bypassed
+    sc_core::sc_event ff_parked;
     void nb_fw(payload_type& trans, const phase_type& phase) {
         auto delay = sc_core::SC_ZERO_TIME;
         base::nb_fw(trans, phase, delay);
     }
     tlm_utils::peq_with_cb_and_phase<axi4_initiator> fw_peq{this, &axi4_initiator::nb_fw};
-    std::unordered_map<unsigned, std::deque<fsm_handle*>> rd_resp_by_id, wr_resp_by_id;
+    //! the transactions waiting for their response per ID in issue order
+    id_fifos<fsm_handle, CFG::IDWIDTH> rd_resp_by_id, wr_resp_by_id;
     sc_core::sc_buffer<uint8_t> wdata_vl;
-    void write_ar(tlm::tlm_generic_payload& trans);
-    void write_aw(tlm::tlm_generic_payload& trans);
+    //! the extension of the payload being written resp. the read being responded, resolved with its first beat
+    tlm::scc::tlm_ext_cache<axi::axi4_extension> wr_ext_cache, rd_ext_cache;
+    void write_ar(tlm::tlm_generic_payload& trans) { write_ar(trans, has_packed_addr<CFG>()); }
+    void write_aw(tlm::tlm_generic_payload& trans) { write_aw(trans, has_packed_addr<CFG>()); }
+    void write_ar(tlm::tlm_generic_payload& trans, std::false_type);
+    void write_aw(tlm::tlm_generic_payload& trans, std::false_type);
+    //! drive the packed address channels with a single write each
+    void write_ar(tlm::tlm_generic_payload& trans, std::true_type) { this->ar_pl.write(get_addr_payload(trans)); }
+    void write_aw(tlm::tlm_generic_payload& trans, std::true_type) { this->aw_pl.write(get_addr_payload(trans)); }
+    static addr_payload<CFG> get_addr_payload(tlm::tlm_generic_payload& trans);
     void write_wdata(tlm::tlm_generic_payload& trans, unsigned beat, bool last = false);
 };
 
 } // namespace pin
 } // namespace axi
 
-template <typename CFG> inline void axi::pin::axi4_initiator<CFG>::write_ar(tlm::tlm_generic_payload& trans) {
+template <typename CFG>
+inline void axi::pin::axi4_initiator<CFG>::write_ar(tlm::tlm_generic_payload& trans, std::false_type) {
     sc_dt::sc_uint<CFG::ADDRWIDTH> addr = trans.get_address();
     this->ar_addr.write(addr);
     if(auto ext = trans.get_extension<axi::axi4_extension>()) {
@@ -139,7 +309,8 @@ template <typename CFG> inline void axi::pin::axi4_initiator<CFG>::write_ar(tlm:
     }
 }
 
-template <typename CFG> inline void axi::pin::axi4_initiator<CFG>::write_aw(tlm::tlm_generic_payload& trans) {
+template <typename CFG>
+inline void axi::pin::axi4_initiator<CFG>::write_aw(tlm::tlm_generic_payload& trans, std::false_type) {
     sc_dt::sc_uint<CFG::ADDRWIDTH> addr = trans.get_address();
     this->aw_addr.write(addr);
     if(auto ext = trans.get_extension<axi::axi4_extension>()) {
@@ -158,54 +329,38 @@ template <typename CFG> inline void axi::pin::axi4_initiator<CFG>::write_aw(tlm:
     }
 }
 
+template <typename CFG>
+inline axi::addr_payload<CFG> axi::pin::axi4_initiator<CFG>::get_addr_payload(tlm::tlm_generic_payload& trans) {
+    addr_payload<CFG> pl{};
+    pl.addr = trans.get_address();
+    if(auto ext = trans.get_extension<axi::axi4_extension>()) {
+        pl.prot = ext->get_prot();
+        pl.id = ext->get_id();
+        pl.len = ext->get_length();
+        pl.size = ext->get_size();
+        pl.burst = axi::to_int(ext->get_burst());
+        pl.cache = ext->get_cache();
+        pl.qos = ext->get_qos();
+        pl.user = ext->get_user(axi::common::id_type::CTRL);
+    }
+    return pl;
+}
+
 // FIXME: strb not yet correct
 template <typename CFG>
 inline void axi::pin::axi4_initiator<CFG>::write_wdata(tlm::tlm_generic_payload& trans, unsigned beat, bool last) {
-    typename CFG::data_t data{0};
-    sc_dt::sc_uint<CFG::BUSWIDTH / 8> strb{0};
-    auto ext = trans.get_extension<axi::axi4_extension>();
-    auto size = 1u << ext->get_size();
-    auto byte_offset = beat * size;
-    auto offset = (trans.get_address()+byte_offset) & (CFG::BUSWIDTH / 8 - 1);
-    auto beptr = trans.get_byte_enable_length() ? trans.get_byte_enable_ptr() + byte_offset : nullptr;
-    if(offset && (size + offset) > (CFG::BUSWIDTH / 8)) { // un-aligned multi-beat access
-        if(beat == 0) {
-            auto bptr = trans.get_data_ptr();
-            for(size_t i = offset; i < size; ++i, ++bptr) {
-                auto bit_offs = i * 8;
-                data(bit_offs + 7, bit_offs) = *bptr;
-                if(beptr) {
-                    strb[i] = *beptr == 0xff;
-                    ++beptr;
-                } else
-                    strb[i] = true;
-            }
-        } else {
-            auto beat_start_idx = byte_offset - offset;
-            auto data_len = trans.get_data_length();
-            auto bptr = trans.get_data_ptr() + beat_start_idx;
-            for(size_t i = offset; i < size && (beat_start_idx + i) < data_len; ++i, ++bptr) {
-                auto bit_offs = i * 8;
-                data(bit_offs + 7, bit_offs) = *bptr;
-                if(beptr) {
-                    strb[i] = *beptr == 0xff;
-                    ++beptr;
-                } else
-                    strb[i] = true;
-            }
-        }
-    } else { // aligned or single beat access
-        auto bptr = trans.get_data_ptr() + byte_offset;
-        for(size_t i = 0; i < size; ++i, ++bptr) {
-            auto bit_offs = (offset+i) * 8;
-            data(bit_offs + 7, bit_offs) = *bptr;
-            if(beptr) {
-                strb[offset+i] = *beptr == 0xff;
-                ++beptr;
-            } else
-                strb[offset+i] = true;
-        }
-    }
+    typename CFG::data_t data{};
+    typename strb_type<CFG>::type strb{};
+    auto ext = wr_ext_cache.update(trans, beat == 0).get<axi::axi4_extension>();
+    auto lanes = get_beat_lanes(trans.get_address(), trans.get_data_length(), beat, 1u << ext->get_size(),
+                                CFG::BUSWIDTH / 8);
+    put_lanes(data, lanes.lane, trans.get_data_ptr() + lanes.trans_offset, lanes.count);
+    if(trans.get_byte_enable_length()) {
+        auto beptr = trans.get_byte_enable_ptr() + lanes.trans_offset;
+        for(unsigned i = 0; i < lanes.count; ++i)
+            set_strobe(strb, lanes.lane + i, beptr[i] == 0xff);
+    } else
+        set_strobes(strb, lanes.lane, lanes.count);
     this->w_data.write(data);
     this->w_strb.write(strb);
     if(!CFG::IS_LITE) {
@@ -219,6 +374,8 @@ template <typename CFG> inline void axi::pin::axi4_initiator<CFG>::setup_callbac
     fsm_hndl->fsm->cb[RequestPhaseBeg] = [this, fsm_hndl]() -> void {
         fsm_hndl->beat_count = 0;
         outstanding_cnt[fsm_hndl->trans->get_command()]++;
+        if(!pending_trans++ && clk_gated)
+            clk_wakeup.notify(sc_core::SC_ZERO_TIME);
         if(CFG::IS_LITE) {
             auto offset = fsm_hndl->trans->get_address() % (CFG::BUSWIDTH / 8);
             if(offset + fsm_hndl->trans->get_data_length() > CFG::BUSWIDTH / 8) {
@@ -263,11 +420,11 @@ template <typename CFG> inline void axi::pin::axi4_initiator<CFG>::setup_callbac
     fsm_hndl->fsm->cb[EndReqE] = [this, fsm_hndl]() -> void {
         switch(fsm_hndl->trans->get_command()) {
         case tlm::TLM_READ_COMMAND:
-            rd_resp_by_id[axi::get_axi_id(*fsm_hndl->trans)].push_back(fsm_hndl);
+            rd_resp_by_id.push(axi::get_axi_id(*fsm_hndl->trans), fsm_hndl);
             active_req[tlm::TLM_READ_COMMAND] = nullptr;
             break;
         case tlm::TLM_WRITE_COMMAND:
-            wr_resp_by_id[axi::get_axi_id(*fsm_hndl->trans)].push_back(fsm_hndl);
+            wr_resp_by_id.push(axi::get_axi_id(*fsm_hndl->trans), fsm_hndl);
             active_req[tlm::TLM_WRITE_COMMAND] = nullptr;
             fsm_hndl->beat_count++;
         }
@@ -302,11 +459,12 @@ template <typename CFG> inline void axi::pin::axi4_initiator<CFG>::setup_callbac
         auto ret = tsckt->nb_transport_bw(*fsm_hndl->trans, phase, t);
     };
     fsm_hndl->fsm->cb[EndRespE] = [this, fsm_hndl]() -> void {
+        pending_trans--;
         r_end_req_evt.notify();
         if(fsm_hndl->trans->is_read())
-            rd_resp_by_id[axi::get_axi_id(*fsm_hndl->trans)].pop_front();
+            rd_resp_by_id.pop(axi::get_axi_id(*fsm_hndl->trans));
         if(fsm_hndl->trans->is_write())
-            wr_resp_by_id[axi::get_axi_id(*fsm_hndl->trans)].pop_front();
+            wr_resp_by_id.pop(axi::get_axi_id(*fsm_hndl->trans));
     };
 }
 
@@ -336,38 +494,14 @@ template <typename CFG> inline void axi::pin::axi4_initiator<CFG>::r_t() {
             auto id = CFG::IS_LITE ? 0U : this->r_id->read().to_uint();
             auto data = this->r_data.read();
             auto resp = this->r_resp.read();
-            auto& q = rd_resp_by_id[id];
-            sc_assert(q.size());
-            auto* fsm_hndl = q.front();
-            auto beat_count = fsm_hndl->beat_count;
-            auto size = axi::get_burst_size(*fsm_hndl->trans);
-            auto byte_offset = beat_count * size;
-            auto offset = (fsm_hndl->trans->get_address()+byte_offset) & (CFG::BUSWIDTH / 8 - 1);
-            if(offset && (size + offset) > (CFG::BUSWIDTH / 8)) { // un-aligned multi-beat access
-                if(beat_count == 0) {
-                    auto bptr = fsm_hndl->trans->get_data_ptr();
-                    for(size_t i = offset; i < size; ++i, ++bptr) {
-                        auto bit_offs = i * 8;
-                        *bptr = data(bit_offs + 7, bit_offs).to_uint();
-                    }
-                } else {
-                    auto beat_start_idx = beat_count * size - offset;
-                    auto data_len = fsm_hndl->trans->get_data_length();
-                    auto bptr = fsm_hndl->trans->get_data_ptr() + beat_start_idx;
-                    for(size_t i = offset; i < size && (beat_start_idx + i) < data_len; ++i, ++bptr) {
-                        auto bit_offs = i * 8;
-                        *bptr = data(bit_offs + 7, bit_offs).to_uint();
-                    }
-                }
-            } else { // aligned or single beat access
-                auto bptr = fsm_hndl->trans->get_data_ptr() + beat_count * size;
-                for(size_t i = 0; i < size; ++i, ++bptr) {
-                    auto bit_offs = (offset+i) * 8;
-                    *bptr = data(bit_offs + 7, bit_offs).to_uint();
-                }
-            }
-            axi::axi4_extension* e;
-            fsm_hndl->trans->get_extension(e);
+            auto* fsm_hndl = rd_resp_by_id.front(id);
+            sc_assert(fsm_hndl);
+            auto lanes = get_beat_lanes(fsm_hndl->trans->get_address(), fsm_hndl->trans->get_data_length(),
+                                        fsm_hndl->beat_count, axi::get_burst_size(*fsm_hndl->trans),
+                                        CFG::BUSWIDTH / 8);
+            get_lanes(data, lanes.lane, fsm_hndl->trans->get_data_ptr() + lanes.trans_offset, lanes.count);
+            auto* e =
+                rd_ext_cache.update(*fsm_hndl->trans, fsm_hndl->beat_count == 0).get<axi::axi4_extension>();
             e->set_resp(axi::into<axi::resp_e>(resp));
             e->add_to_response_array(*e);
             auto tp = CFG::IS_LITE || this->r_last->read() ? axi::fsm::protocol_time_point_e::BegRespE
@@ -427,9 +561,8 @@ template <typename CFG> inline void axi::pin::axi4_initiator<CFG>::b_t() {
         if(this->b_valid.event() || (!active_resp[tlm::TLM_WRITE_COMMAND] && this->b_valid.read())) {
             auto id = !CFG::IS_LITE ? this->b_id->read().to_uint() : 0U;
             auto resp = this->b_resp.read();
-            auto& q = wr_resp_by_id[id];
-            sc_assert(q.size());
-            auto* fsm_hndl = q.front();
+            auto* fsm_hndl = wr_resp_by_id.front(id);
+            sc_assert(fsm_hndl);
             axi::axi4_extension* e;
             fsm_hndl->trans->get_extension(e);
             e->set_resp(axi::into<axi::resp_e>(resp));
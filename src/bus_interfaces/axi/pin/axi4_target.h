@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021-2022 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -20,7 +20,9 @@
 #include <axi/axi_tlm.h>
 #include <axi/fsm/base.h>
 #include <axi/fsm/protocol_fsm.h>
+#include <axi/pin/fast_forward.h>
 #include <axi/signal_if.h>
+#include <scc/cached_cci_param.h>
 #include <systemc>
 #include <tlm/scc/tlm_mm.h>
 #include <util/ities.h>
@@ -34,10 +36,10 @@ using namespace axi::fsm;
 
 template <typename CFG>
 struct axi4_target : public sc_core::sc_module,
-public aw_ch<CFG, typename CFG::slave_types>,
+public aw_ch_t<CFG, typename CFG::slave_types>,
 public wdata_ch<CFG, typename CFG::slave_types>,
 public b_ch<CFG, typename CFG::slave_types>,
-public ar_ch<CFG, typename CFG::slave_types>,
+public ar_ch_t<CFG, typename CFG::slave_types>,
 public rresp_ch<CFG, typename CFG::slave_types>,
 protected axi::fsm::base,
 public axi::axi_bw_transport_if<axi::axi_protocol_types> {
@@ -49,6 +51,16 @@ public axi::axi_bw_transport_if<axi::axi_protocol_types> {
     sc_core::sc_in<bool> clk_i{"clk_i"};
 
     axi::axi_initiator_socket<CFG::BUSWIDTH> isckt{"isckt"};
+    /**
+     * if set the adapter stops following the clock while no transaction is outstanding and none of ARVALID, AWVALID
+     * and WVALID is asserted, it resumes with the next clock edge after a valid gets asserted
+     */
+    scc::cached_cci_param<bool> idle_clock_gating{"idle_clock_gating", false};
+    /**
+     * if set and the signals lead to an axi4_initiator adapter having fast forwarding enabled as well the transactions
+     * bypass the pins and are annotated with the clock cycles of the handshakes, otherwise the pins are driven
+     */
+    cci::cci_param<bool> fast_forward{"fast_forward", false};
 
     axi4_target(sc_core::sc_module_name const& nm)
     : sc_core::sc_module(nm)
@@ -70,22 +82,41 @@ private:
 
     void invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range) override;
 
-    void end_of_elaboration() override { clk_if = dynamic_cast<sc_core::sc_clock*>(clk_i.get_interface()); }
+    void end_of_elaboration() override {
+        clk_if = dynamic_cast<sc_core::sc_clock*>(clk_i.get_interface());
+        if(fast_forward.get_value())
+            fast_forward_registry::get().add_target(this->aw_valid, this->ar_valid, isckt.operator->(), ff_upstream);
+    }
 
     axi::fsm::fsm_handle* create_fsm_handle() override { return new fsm_handle(); }
 
     void setup_callbacks(axi::fsm::fsm_handle*) override;
 
     void clk_delay() {
+        if(ff_upstream) { // the pins are bypassed so there is nothing to follow the clock for
+            next_trigger(ff_parked);
+            return;
+        }
+        if(clk_gated) { // woken up, follow the clock again starting with the next edge
+            clk_gated = false;
+            return;
+        }
     #ifdef DELTA_SYNC
         if(sc_core::sc_delta_count_at_current_time()<5) {
             clk_self.notify(sc_core::SC_ZERO_TIME);
             next_trigger(clk_self);
+            return;
         } else
             clk_delayed.notify(sc_core::SC_ZERO_TIME/*clk_if ? clk_if->period() - 1_ps : 1_ps*/);
 #else
         clk_delayed.notify(1_ps);
 #endif
+        if(idle_clock_gating && !pending_trans && !this->ar_valid.read() && !this->aw_valid.read() &&
+           !this->w_valid.read()) {
+            clk_gated = true;
+            next_trigger(this->ar_valid.posedge_event() | this->aw_valid.posedge_event() |
+                         this->w_valid.posedge_event());
+        }
     }
     void ar_t();
     void rresp_t();
@@ -93,6 +124,13 @@ private:
     void wdata_t();
     void bresp_t();
     static typename CFG::data_t get_read_data_for_beat(fsm::fsm_handle* fsm_hndl);
+    addr_payload<CFG> read_ar() { return read_ar(has_packed_addr<CFG>()); }
+    addr_payload<CFG> read_aw() { return read_aw(has_packed_addr<CFG>()); }
+    addr_payload<CFG> read_ar(std::false_type);
+    addr_payload<CFG> read_aw(std::false_type);
+    //! the packed address channels are read with a single access each
+    addr_payload<CFG> read_ar(std::true_type) { return this->ar_pl.read(); }
+    addr_payload<CFG> read_aw(std::true_type) { return this->aw_pl.read(); }
     struct aw_data {
         unsigned id;
         uint64_t addr;
@@ -107,6 +145,13 @@ private:
     };
     sc_core::sc_clock* clk_if{nullptr};
     sc_core::sc_event clk_delayed, clk_self, ar_end_req_evt, wdata_end_req_evt;
+    //! the number of transactions between the begin of their request and the end of their response
+    unsigned pending_trans{0};
+    bool clk_gated{false};
+    //! the socket of the paired initiator adapter if the pins are bypassed
+    fast_forward_registry::bw_if* ff_upstream{nullptr};
+    //! never notified, parks clk_delay while the pins are bypassed
+    sc_core::sc_event ff_parked;
     std::array<fsm_handle*, 3> active_req_beat;
     std::array<fsm_handle*, 3> active_req;
     std::array<fsm_handle*, 3> active_resp_beat;
@@ -121,6 +166,10 @@ private:
 template <typename CFG>
 inline tlm::tlm_sync_enum axi::pin::axi4_target<CFG>::nb_transport_bw(payload_type& trans, phase_type& phase,
         sc_core::sc_time& t) {
+    if(ff_upstream) {
+        t += fast_forward_registry::get_delay(phase, clk_if);
+        return ff_upstream->nb_transport_bw(trans, phase, t);
+    }
     auto ret = tlm::TLM_ACCEPTED;
     sc_core::sc_time delay=t<clk_if->period()?sc_core::SC_ZERO_TIME:t; // FIXME: calculate correct time
     SCCTRACE(SCMOD) << "nb_transport_bw " << phase << " of trans " << trans;
@@ -134,42 +183,56 @@ inline tlm::tlm_sync_enum axi::pin::axi4_target<CFG>::nb_transport_bw(payload_ty
 }
 
 template <typename CFG>
-inline void axi::pin::axi4_target<CFG>::invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range) {}
+inline void axi::pin::axi4_target<CFG>::invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range) {
+    if(ff_upstream)
+        ff_upstream->invalidate_direct_mem_ptr(start_range, end_range);
+}
 
 template <typename CFG> typename CFG::data_t axi::pin::axi4_target<CFG>::get_read_data_for_beat(fsm_handle* fsm_hndl) {
-    auto beat_count = fsm_hndl->beat_count;
-    auto size = axi::get_burst_size(*fsm_hndl->trans);
-    auto byte_offset = beat_count * size;
-    auto offset = (fsm_hndl->trans->get_address()+byte_offset) & (CFG::BUSWIDTH / 8 - 1);
-    typename CFG::data_t data{0};
-    if(offset && (size + offset) > (CFG::BUSWIDTH / 8)) { // un-aligned multi-beat access
-        if(beat_count == 0) {
-            auto bptr = fsm_hndl->trans->get_data_ptr();
-            for(size_t i = offset; i < size; ++i, ++bptr) {
-                auto bit_offs = i * 8;
-                data(bit_offs + 7, bit_offs) = *bptr;
-            }
-        } else {
-            auto beat_start_idx = byte_offset - offset;
-            auto data_len = fsm_hndl->trans->get_data_length();
-            auto bptr = fsm_hndl->trans->get_data_ptr() + beat_start_idx;
-            for(size_t i = offset; i < size && (beat_start_idx + i) < data_len; ++i, ++bptr) {
-                auto bit_offs = i * 8;
-                data(bit_offs + 7, bit_offs) = *bptr;
-            }
-        }
-    } else { // aligned or single beat access
-        auto bptr = fsm_hndl->trans->get_data_ptr() + byte_offset;
-        for(size_t i = 0; i < size; ++i, ++bptr) {
-            auto bit_offs = (offset + i) * 8;
-            data(bit_offs + 7, bit_offs) = *bptr;
-        }
-    }
+    auto lanes = get_beat_lanes(fsm_hndl->trans->get_address(), fsm_hndl->trans->get_data_length(),
+                                fsm_hndl->beat_count, axi::get_burst_size(*fsm_hndl->trans), CFG::BUSWIDTH / 8);
+    typename CFG::data_t data{};
+    put_lanes(data, lanes.lane, fsm_hndl->trans->get_data_ptr() + lanes.trans_offset, lanes.count);
     return data;
 }
 
+template <typename CFG> inline axi::addr_payload<CFG> axi::pin::axi4_target<CFG>::read_ar(std::false_type) {
+    addr_payload<CFG> pl{};
+    pl.addr = this->ar_addr.read();
+    pl.prot = this->ar_prot.read();
+    if(!CFG::IS_LITE) {
+        pl.id = this->ar_id->read();
+        pl.len = this->ar_len->read();
+        pl.size = this->ar_size->read();
+        pl.burst = this->ar_burst->read();
+        pl.cache = this->ar_cache->read();
+        pl.qos = this->ar_qos->read();
+        pl.region = this->ar_region->read();
+    }
+    return pl;
+}
+
+template <typename CFG> inline axi::addr_payload<CFG> axi::pin::axi4_target<CFG>::read_aw(std::false_type) {
+    addr_payload<CFG> pl{};
+    pl.addr = this->aw_addr.read();
+    pl.prot = this->aw_prot.read();
+    if(!CFG::IS_LITE) {
+        pl.id = this->aw_id->read();
+        pl.len = this->aw_len->read();
+        pl.size = this->aw_size->read();
+        pl.burst = this->aw_burst->read();
+        pl.cache = this->aw_cache->read();
+        pl.qos = this->aw_qos->read();
+        pl.region = this->aw_region->read();
+    }
+    return pl;
+}
+
 template <typename CFG> inline void axi::pin::axi4_target<CFG>::setup_callbacks(fsm_handle* fsm_hndl) {
-    fsm_hndl->fsm->cb[RequestPhaseBeg] = [this, fsm_hndl]() -> void { fsm_hndl->beat_count = 0; };
+    fsm_hndl->fsm->cb[RequestPhaseBeg] = [this, fsm_hndl]() -> void {
+        fsm_hndl->beat_count = 0;
+        pending_trans++;
+    };
     fsm_hndl->fsm->cb[BegPartReqE] = [this, fsm_hndl]() -> void {
         sc_assert(fsm_hndl->trans->get_command() == tlm::TLM_WRITE_COMMAND);
         tlm::tlm_phase phase = axi::BEGIN_PARTIAL_REQ;
@@ -242,6 +305,7 @@ template <typename CFG> inline void axi::pin::axi4_target<CFG>::setup_callbacks(
         sc_core::sc_time t(sc_core::SC_ZERO_TIME);
         auto ret = isckt->nb_transport_fw(*fsm_hndl->trans, phase, t);
         active_resp_beat[fsm_hndl->trans->get_command()] = nullptr;
+        pending_trans--;
     };
 }
 
@@ -255,15 +319,16 @@ template <typename CFG> inline void axi::pin::axi4_target<CFG>::ar_t() {
     while(true) {
         wait(this->ar_valid.posedge_event() | clk_delayed);
         if(this->ar_valid.read()) {
-            SCCTRACE(SCMOD) << "ARVALID detected for 0x" << std::hex << this->ar_addr.read();
+            auto ar = read_ar();
+            SCCTRACE(SCMOD) << "ARVALID detected for 0x" << std::hex << ar.addr;
             if(!CFG::IS_LITE) {
-                arid = this->ar_id->read().to_uint();
-                arlen = this->ar_len->read().to_uint();
-                arsize = this->ar_size->read().to_uint();
+                arid = ar.id.to_uint();
+                arlen = ar.len.to_uint();
+                arsize = ar.size.to_uint();
             }
             data_len = (1 << arsize) * (arlen + 1);
             auto gp = tlm::scc::tlm_mm<>::get().allocate<axi::axi4_extension>(data_len);
-            gp->set_address(this->ar_addr.read());
+            gp->set_address(ar.addr);
             gp->set_command(tlm::TLM_READ_COMMAND);
             gp->set_streaming_width(data_len);
             axi::axi4_extension* ext;
@@ -271,7 +336,7 @@ template <typename CFG> inline void axi::pin::axi4_target<CFG>::ar_t() {
             ext->set_id(arid);
             ext->set_length(arlen);
             ext->set_size(arsize);
-            ext->set_burst(CFG::IS_LITE ? axi::burst_e::INCR : axi::into<axi::burst_e>(this->ar_burst->read()));
+            ext->set_burst(CFG::IS_LITE ? axi::burst_e::INCR : axi::into<axi::burst_e>(ar.burst.to_uint()));
             active_req_beat[tlm::TLM_READ_COMMAND] = find_or_create(gp);
             react(axi::fsm::protocol_time_point_e::BegReqE, active_req_beat[tlm::TLM_READ_COMMAND]);
             wait(ar_end_req_evt);
@@ -321,17 +386,18 @@ template <typename CFG> inline void axi::pin::axi4_target<CFG>::aw_t() {
     while(true) {
         wait(this->aw_valid.posedge_event() | clk_delayed);
         if(this->aw_valid.event() || (!active_req_beat[tlm::TLM_IGNORE_COMMAND] && this->aw_valid.read())) {
-            SCCTRACE(SCMOD) << "AWVALID detected for 0x" << std::hex << this->aw_addr.read();
+            auto aw = read_aw();
+            SCCTRACE(SCMOD) << "AWVALID detected for 0x" << std::hex << aw.addr;
             // clang-format off
-            aw_data awd = {CFG::IS_LITE ? 0U : this->aw_id->read().to_uint(),
-                    this->aw_addr.read().to_uint64(),
-                    this->aw_prot.read().to_uint(),
-                    CFG::IS_LITE ? awsize : this->aw_size->read().to_uint(),
-                    CFG::IS_LITE ? 0U : this->aw_cache->read().to_uint(),
-                    CFG::IS_LITE ? 0U : this->aw_burst->read().to_uint(),
-                    CFG::IS_LITE ? 0U : this->aw_qos->read().to_uint(),
-                    CFG::IS_LITE ? 0U : this->aw_region->read().to_uint(),
-                    CFG::IS_LITE ? 0U : this->aw_len->read().to_uint(),
+            aw_data awd = {CFG::IS_LITE ? 0U : aw.id.to_uint(),
+                    aw.addr.to_uint64(),
+                    aw.prot.to_uint(),
+                    CFG::IS_LITE ? awsize : aw.size.to_uint(),
+                    CFG::IS_LITE ? 0U : aw.cache.to_uint(),
+                    CFG::IS_LITE ? 0U : aw.burst.to_uint(),
+                    CFG::IS_LITE ? 0U : aw.qos.to_uint(),
+                    CFG::IS_LITE ? 0U : aw.region.to_uint(),
+                    CFG::IS_LITE ? 0U : aw.len.to_uint(),
                     0};
             // clang-format on
             aw_que.notify(awd);
@@ -375,47 +441,21 @@ template <typename CFG> inline void axi::pin::axi4_target<CFG>::wdata_t() {
                 active_req[tlm::TLM_WRITE_COMMAND] = active_req_beat[tlm::TLM_WRITE_COMMAND];
             }
             auto* fsm_hndl = active_req[tlm::TLM_WRITE_COMMAND];
-            SCCTRACE(SCMOD) << "WDATA detected for 0x" << std::hex << this->ar_addr.read();
+            SCCTRACE(SCMOD) << "WDATA detected for 0x" << std::hex << fsm_hndl->trans->get_address();
             auto& gp = fsm_hndl->trans;
             auto data = this->w_data.read();
             auto strb = this->w_strb.read();
             auto last = CFG::IS_LITE ? true : this->w_last->read();
             auto beat_count = fsm_hndl->beat_count;
             auto size = axi::get_burst_size(*fsm_hndl->trans);
-            auto byte_offset = beat_count * size;
-            auto offset = (fsm_hndl->trans->get_address()+byte_offset) & (CFG::BUSWIDTH / 8 - 1);
-            if(offset && (size + offset) > (CFG::BUSWIDTH / 8)) { // un-aligned multi-beat access
-                if(beat_count == 0) {
-                    auto bptr = fsm_hndl->trans->get_data_ptr();
-                    auto beptr = fsm_hndl->trans->get_byte_enable_ptr();
-                    for(size_t i = offset; i < size; ++i, ++bptr, ++beptr) {
-                        auto bit_offs = i * 8;
-                        *bptr = data(bit_offs + 7, bit_offs).to_uint();
-                        *beptr = strb[i] ? 0xff : 0;
-                    }
-                } else {
-                    auto beat_start_idx = byte_offset - offset;
-                    auto data_len = fsm_hndl->trans->get_data_length();
-                    auto bptr = fsm_hndl->trans->get_data_ptr() + beat_start_idx;
-                    auto beptr = fsm_hndl->trans->get_byte_enable_ptr() + beat_start_idx;
-                    for(size_t i = offset; i < size && (beat_start_idx + i) < data_len; ++i, ++bptr, ++beptr) {
-                        auto bit_offs = i * 8;
-                        *bptr = data(bit_offs + 7, bit_offs).to_uint();
-                        *beptr = strb[i] ? 0xff : 0;
-                    }
-                }
-            } else { // aligned or single beat access
-                auto bptr = fsm_hndl->trans->get_data_ptr() + byte_offset;
-                auto beptr = fsm_hndl->trans->get_byte_enable_ptr() + byte_offset;
-                for(size_t i = 0; i < size; ++i, ++bptr, ++beptr) {
-                    auto bit_offs = (offset+i) * 8;
-                    *bptr = data(bit_offs + 7, bit_offs).to_uint();
-                    *beptr = strb[offset +i] ? 0xff : 0;
-                }
-            }
+            auto lanes = get_beat_lanes(fsm_hndl->trans->get_address(), fsm_hndl->trans->get_data_length(),
+                                        beat_count, size, CFG::BUSWIDTH / 8);
+            get_lanes(data, lanes.lane, fsm_hndl->trans->get_data_ptr() + lanes.trans_offset, lanes.count);
+            auto beptr = fsm_hndl->trans->get_byte_enable_ptr() + lanes.trans_offset;
+            for(unsigned i = 0; i < lanes.count; ++i)
+                beptr[i] = get_strobe(strb, lanes.lane + i) ? 0xff : 0;
             // TODO: assuming consecutive write (not scattered)
-            auto strobe = strb.to_uint();
-            auto act_data_len = CFG::IS_LITE? util::bit_count(strobe): (beat_count+1) * size;
+            auto act_data_len = CFG::IS_LITE? count_strobes(strb): (beat_count+1) * size;
 //            if(CFG::IS_LITE && act_data_len<CFG::BUSWIDTH/8) {
 //                std::fill(gp->get_byte_enable_ptr(), gp->get_byte_enable_ptr() + act_data_len, 0xff);
 //                std::fill(gp->get_byte_enable_ptr() + act_data_len, gp->get_byte_enable_ptr() + gp->get_byte_enable_length(), 0x0);
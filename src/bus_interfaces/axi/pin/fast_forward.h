@@ -0,0 +1,122 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _BUS_AXI_PIN_FAST_FORWARD_H_
+#define _BUS_AXI_PIN_FAST_FORWARD_H_
+
+#include <axi/axi_tlm.h>
+#include <systemc>
+#include <unordered_map>
+
+//! TLM2.0 components modeling AXI
+namespace axi {
+//! pin level adapters
+namespace pin {
+/**
+ * @brief pairs pin level initiator and target adapters connected by the same signals
+ *
+ * If both adapters of a pair enable fast forwarding the initiator adapter passes the forward path calls directly to the
+ * socket of the target adapter and the target adapter passes the backward path calls directly to the socket of the
+ * initiator adapter, the pins are not driven at all. The pairs are identified by the AWVALID and ARVALID signals the
+ * adapters are bound to, adapters whose signals lead to another model (e.g. an RTL co-simulation) stay unpaired and
+ * keep driving the pins.
+ */
+class fast_forward_registry {
+public:
+    using fw_if = axi::axi_fw_transport_if<axi::axi_protocol_types>;
+    using bw_if = axi::axi_bw_transport_if<axi::axi_protocol_types>;
+    //! the registry getter
+    static fast_forward_registry& get() {
+        static fast_forward_registry inst;
+        return inst;
+    }
+    /**
+     * register an initiator adapter, to be called during end_of_elaboration
+     *
+     * @param aw the AWVALID port of the adapter
+     * @param ar the ARVALID port of the adapter
+     * @param upstream the interface the paired target adapter shall forward the backward path calls to
+     * @param downstream set to the interface to forward the forward path calls to once the pair is complete
+     */
+    void add_initiator(sc_core::sc_port_base const& aw, sc_core::sc_port_base const& ar, bw_if* upstream,
+                       fw_if*& downstream) {
+        auto& e = entries[channel_of(aw)];
+        e.initiator_ar = channel_of(ar);
+        e.upstream = upstream;
+        e.downstream_ref = &downstream;
+        link(e);
+    }
+    /**
+     * register a target adapter, to be called during end_of_elaboration
+     *
+     * @param aw the AWVALID port of the adapter
+     * @param ar the ARVALID port of the adapter
+     * @param downstream the interface the paired initiator adapter shall forward the forward path calls to
+     * @param upstream set to the interface to forward the backward path calls to once the pair is complete
+     */
+    void add_target(sc_core::sc_port_base const& aw, sc_core::sc_port_base const& ar, fw_if* downstream,
+                    bw_if*& upstream) {
+        auto& e = entries[channel_of(aw)];
+        e.target_ar = channel_of(ar);
+        e.downstream = downstream;
+        e.upstream_ref = &upstream;
+        link(e);
+    }
+    /**
+     * the time a phase takes to cross the pins, each handshake started by a BEGIN phase takes a clock cycle
+     *
+     * @param phase the phase
+     * @param clk the clock of the adapter, may be nullptr
+     * @return the delay to be added to the annotated time
+     */
+    static sc_core::sc_time get_delay(tlm::tlm_phase const& phase, sc_core::sc_clock const* clk) {
+        if(!clk)
+            return sc_core::SC_ZERO_TIME;
+        return phase == tlm::BEGIN_REQ || phase == axi::BEGIN_PARTIAL_REQ || phase == tlm::BEGIN_RESP ||
+                       phase == axi::BEGIN_PARTIAL_RESP
+                   ? clk->period()
+                   : sc_core::SC_ZERO_TIME;
+    }
+
+private:
+    struct entry {
+        sc_core::sc_object const* initiator_ar{nullptr};
+        sc_core::sc_object const* target_ar{nullptr};
+        bw_if* upstream{nullptr};
+        fw_if* downstream{nullptr};
+        fw_if** downstream_ref{nullptr};
+        bw_if** upstream_ref{nullptr};
+    };
+
+    fast_forward_registry() = default;
+
+    static sc_core::sc_object const* channel_of(sc_core::sc_port_base const& port) {
+        return dynamic_cast<sc_core::sc_object const*>(port.get_interface());
+    }
+    // the adapters are paired only if they share both address channels
+    static void link(entry& e) {
+        if(e.downstream_ref && e.upstream_ref && e.initiator_ar && e.initiator_ar == e.target_ar) {
+            *e.downstream_ref = e.downstream;
+            *e.upstream_ref = e.upstream;
+        }
+    }
+
+    std::unordered_map<sc_core::sc_object const*, entry> entries;
+};
+} // namespace pin
+} // namespace axi
+
+#endif /* _BUS_AXI_PIN_FAST_FORWARD_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,7 +17,15 @@
 #ifndef _BUS_AXI_SIGNAL_IF_H_
 #define _BUS_AXI_SIGNAL_IF_H_
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
 #include <systemc>
+#include <type_traits>
 
 namespace axi {
 
@@ -85,6 +93,46 @@ struct signal_types {
 
 template <bool Cond, class T, class S> struct select_if { typedef S type; };
 template <class T, class S> struct select_if<true, T, S> { typedef T type; };
+/**
+ * @brief a bit vector of WIDTH bits stored as array of 64bit words, bit i of the vector is bit i%64 of word i/64
+ *
+ * Used as data and strobe type of the channels (see axi4_word_cfg) it allows to move the byte lanes of a beat using
+ * memcpy instead of accessing them one by one through the sc_dt part selects.
+ */
+template <unsigned WIDTH> struct data_words {
+    static_assert(WIDTH > 0 && WIDTH <= 1024, "data_words supports widths up to 1024 bits");
+    std::array<uint64_t, (WIDTH + 63) / 64> w{};
+
+    bool bit(unsigned i) const { return (w[i / 64] >> (i % 64)) & 1; }
+
+    void set_bit(unsigned i, bool v) {
+        if(v)
+            w[i / 64] |= 1ULL << (i % 64);
+        else
+            w[i / 64] &= ~(1ULL << (i % 64));
+    }
+
+    bool operator==(data_words const& o) const { return w == o.w; }
+};
+
+template <unsigned WIDTH> inline std::ostream& operator<<(std::ostream& os, data_words<WIDTH> const& d) {
+    auto flags = os.flags();
+    os << "0x" << std::hex;
+    for(auto i = d.w.size(); i > 0; --i)
+        os << std::setw(i == d.w.size() ? 0 : 16) << std::setfill('0') << d.w[i - 1];
+    os.flags(flags);
+    return os;
+}
+
+template <unsigned WIDTH>
+inline void sc_trace(sc_core::sc_trace_file* tf, data_words<WIDTH> const& d, std::string const& name) {
+    if(d.w.size() == 1)
+        sc_core::sc_trace(tf, d.w[0], name, WIDTH);
+    else
+        for(size_t i = 0; i < d.w.size(); ++i)
+            sc_core::sc_trace(tf, d.w[i], name + "(" + std::to_string(i) + ")",
+                              i + 1 < d.w.size() || !(WIDTH % 64) ? 64 : WIDTH % 64);
+}
 
 template <unsigned int BUSWDTH = 32, unsigned int ADDRWDTH = 32, unsigned int IDWDTH = 32, unsigned int USERWDTH = 1>
 struct axi4_cfg {
@@ -114,6 +162,33 @@ template <unsigned int BUSWDTH = 32, unsigned int ADDRWDTH = 32> struct axi4_lit
     using master_types = ::axi::lite_master_types;
 };
 
+/**
+ * AXI4 configuration whose read and write address channels are packed into a single signal each (see ar_ch_packed
+ * and aw_ch_packed)
+ */
+template <unsigned int BUSWDTH = 32, unsigned int ADDRWDTH = 32, unsigned int IDWDTH = 32, unsigned int USERWDTH = 1>
+struct axi4_packed_cfg : public axi4_cfg<BUSWDTH, ADDRWDTH, IDWDTH, USERWDTH> {
+    constexpr static bool PACKED_ADDR = true;
+};
+/**
+ * AXI4 configuration using data_words as type of the data and strobe signals, this supports bus widths up to 1024
+ * bits and speeds up the packing and unpacking of beats
+ */
+template <unsigned int BUSWDTH = 32, unsigned int ADDRWDTH = 32, unsigned int IDWDTH = 32, unsigned int USERWDTH = 1>
+struct axi4_word_cfg : public axi4_cfg<BUSWDTH, ADDRWDTH, IDWDTH, USERWDTH> {
+    using data_t = data_words<BUSWDTH>;
+    using strb_t = data_words<BUSWDTH / 8>;
+};
+//! the type of the strobe signals of a configuration, CFG::strb_t if defined and sc_uint<BUSWIDTH/8> otherwise
+template <typename CFG, typename = void> struct strb_type { using type = sc_dt::sc_uint<CFG::BUSWIDTH / 8>; };
+template <typename CFG> struct strb_type<CFG, typename std::conditional<true, void, typename CFG::strb_t>::type> {
+    using type = typename CFG::strb_t;
+};
+//! true_type if the configuration CFG uses packed address channels
+template <typename CFG, typename = void> struct has_packed_addr : std::false_type {};
+template <typename CFG>
+struct has_packed_addr<CFG, typename std::enable_if<CFG::PACKED_ADDR>::type> : std::true_type {};
+
 inline std::string concat(const char* prefix, const char* name) { return std::string(prefix) + name; }
 
 //! Write address channel signals
@@ -172,7 +247,7 @@ template <typename CFG, typename TYPES = master_types> struct wdata_ch_lite;
 template <typename CFG, typename TYPES = master_types> struct wdata_ch {
     typename TYPES::template m2s_opt_t<sc_dt::sc_uint<CFG::IDWIDTH>> w_id{"w_id"};
     typename TYPES::template m2s_t<typename CFG::data_t> w_data{"w_data"};
-    typename TYPES::template m2s_t<sc_dt::sc_uint<CFG::BUSWIDTH / 8>> w_strb{"w_strb"};
+    typename TYPES::template m2s_t<typename strb_type<CFG>::type> w_strb{"w_strb"};
     typename TYPES::template m2s_full_t<bool> w_last{"w_last"};
     typename TYPES::template m2s_t<bool> w_valid{"w_valid"};
     typename TYPES::template s2m_t<bool> w_ready{"w_ready"};
@@ -336,7 +411,7 @@ template <typename CFG, typename TYPES> struct aw_ch_lite {
 //! write data channel signals
 template <typename CFG, typename TYPES> struct wdata_ch_lite {
     typename TYPES::template m2s_t<typename CFG::data_t> w_data{"w_data"};
-    typename TYPES::template m2s_t<sc_dt::sc_uint<CFG::BUSWIDTH / 8>> w_strb{"w_strb"};
+    typename TYPES::template m2s_t<typename strb_type<CFG>::type> w_strb{"w_strb"};
     typename TYPES::template m2s_t<bool> w_valid{"w_valid"};
     typename TYPES::template s2m_t<bool> w_ready{"w_ready"};
 
@@ -418,6 +493,98 @@ template <typename CFG, typename TYPES> struct rresp_ch_lite {
     }
 };
 
+/**
+ * @brief the payload signals of a read or write address channel as a single value
+ *
+ * Driving the channel takes a single signal write and update instead of one per field. When being traced each
+ * field shows up as a signal of its own named \<name\>.\<field\>.
+ */
+template <typename CFG> struct addr_payload {
+    sc_dt::sc_uint<CFG::IDWIDTH ? CFG::IDWIDTH : 1> id;
+    sc_dt::sc_uint<CFG::ADDRWIDTH> addr;
+    sc_dt::sc_uint<8> len;
+    sc_dt::sc_uint<3> size;
+    sc_dt::sc_uint<2> burst;
+    sc_dt::sc_uint<2> lock;
+    sc_dt::sc_uint<4> cache;
+    sc_dt::sc_uint<3> prot;
+    sc_dt::sc_uint<4> qos;
+    sc_dt::sc_uint<4> region;
+    sc_dt::sc_uint<CFG::USERWIDTH> user;
+
+    bool operator==(addr_payload const& o) const {
+        return id == o.id && addr == o.addr && len == o.len && size == o.size && burst == o.burst &&
+               lock == o.lock && cache == o.cache && prot == o.prot && qos == o.qos && region == o.region &&
+               user == o.user;
+    }
+};
+
+template <typename CFG> inline std::ostream& operator<<(std::ostream& os, addr_payload<CFG> const& p) {
+    os << "(id=" << p.id << ", addr=0x" << std::hex << p.addr << std::dec << ", len=" << p.len << ", size=" << p.size
+       << ", burst=" << p.burst << ", lock=" << p.lock << ", cache=" << p.cache << ", prot=" << p.prot
+       << ", qos=" << p.qos << ", region=" << p.region << ", user=" << p.user << ")";
+    return os;
+}
+
+template <typename CFG>
+inline void sc_trace(sc_core::sc_trace_file* tf, addr_payload<CFG> const& p, std::string const& name) {
+    sc_core::sc_trace(tf, p.id, name + ".id");
+    sc_core::sc_trace(tf, p.addr, name + ".addr");
+    sc_core::sc_trace(tf, p.len, name + ".len");
+    sc_core::sc_trace(tf, p.size, name + ".size");
+    sc_core::sc_trace(tf, p.burst, name + ".burst");
+    sc_core::sc_trace(tf, p.lock, name + ".lock");
+    sc_core::sc_trace(tf, p.cache, name + ".cache");
+    sc_core::sc_trace(tf, p.prot, name + ".prot");
+    sc_core::sc_trace(tf, p.qos, name + ".qos");
+    sc_core::sc_trace(tf, p.region, name + ".region");
+    sc_core::sc_trace(tf, p.user, name + ".user");
+}
+
+//! Write address channel signals with the payload packed into aw_pl
+template <typename CFG, typename TYPES = master_types> struct aw_ch_packed {
+    typename TYPES::template m2s_t<addr_payload<CFG>> aw_pl{"aw_pl"};
+    typename TYPES::template m2s_t<bool> aw_valid{"aw_valid"};
+    typename TYPES::template s2m_t<bool> aw_ready{"aw_ready"};
+
+    aw_ch_packed() = default;
+    aw_ch_packed(const char* prefix)
+    : aw_pl{concat(prefix, "aw_pl").c_str()}
+    , aw_valid{concat(prefix, "aw_valid").c_str()}
+    , aw_ready{concat(prefix, "aw_ready").c_str()} {}
+
+    template <typename OTYPES> void bind_aw(aw_ch_packed<CFG, OTYPES>& o) {
+        aw_pl.bind(o.aw_pl);
+        aw_valid.bind(o.aw_valid);
+        aw_ready.bind(o.aw_ready);
+    }
+};
+
+//! read address channel signals with the payload packed into ar_pl
+template <typename CFG, typename TYPES = master_types> struct ar_ch_packed {
+    typename TYPES::template m2s_t<addr_payload<CFG>> ar_pl{"ar_pl"};
+    typename TYPES::template m2s_t<bool> ar_valid{"ar_valid"};
+    typename TYPES::template s2m_t<bool> ar_ready{"ar_ready"};
+
+    ar_ch_packed() = default;
+    ar_ch_packed(const char* prefix)
+    : ar_pl{concat(prefix, "ar_pl").c_str()}
+    , ar_valid{concat(prefix, "ar_valid").c_str()}
+    , ar_ready{concat(prefix, "ar_ready").c_str()} {}
+
+    template <typename OTYPES> void bind_ar(ar_ch_packed<CFG, OTYPES>& o) {
+        ar_pl.bind(o.ar_pl);
+        ar_valid.bind(o.ar_valid);
+        ar_ready.bind(o.ar_ready);
+    }
+};
+//! the write address channel signals of a configuration
+template <typename CFG, typename TYPES>
+using aw_ch_t = typename select_if<has_packed_addr<CFG>::value, aw_ch_packed<CFG, TYPES>, aw_ch<CFG, TYPES>>::type;
+//! the read address channel signals of a configuration
+template <typename CFG, typename TYPES>
+using ar_ch_t = typename select_if<has_packed_addr<CFG>::value, ar_ch_packed<CFG, TYPES>, ar_ch<CFG, TYPES>>::type;
+
 template<typename CFG, typename TYPES>
 template<typename OTYPES>
 inline void ar_ch<CFG, TYPES>::bind_ar(ar_ch_lite<CFG, OTYPES> &o) {
@@ -462,5 +629,116 @@ inline void b_ch<CFG, TYPES>::bind_b(b_ch_lite<CFG, OTYPES> &o) {
     b_resp.bind(o.b_resp);
 }
 
+/**
+ * @brief the byte lanes of a beat carrying bytes of a transaction
+ */
+struct beat_lanes {
+    //! the first byte lane
+    unsigned lane;
+    //! the offset of the byte in the data of the transaction carried by the first lane
+    size_t trans_offset;
+    //! the number of lanes
+    unsigned count;
+};
+/**
+ * get the byte lanes of a beat of a burst
+ *
+ * @param addr the start address of the burst
+ * @param data_len the length of the transaction data
+ * @param beat the index of the beat
+ * @param size the number of bytes per beat
+ * @param bus_bytes the width of the bus in bytes
+ * @return the lanes of the beat
+ */
+inline beat_lanes get_beat_lanes(uint64_t addr, size_t data_len, unsigned beat, unsigned size, unsigned bus_bytes) {
+    size_t byte_offset = beat * size;
+    unsigned offset = (addr + byte_offset) & (bus_bytes - 1);
+    if(offset && (size + offset) > bus_bytes) { // un-aligned multi-beat access
+        if(beat == 0)
+            return beat_lanes{offset, 0, size > offset ? size - offset : 0};
+        auto beat_start_idx = byte_offset - offset;
+        auto end = data_len > beat_start_idx ? std::min<size_t>(size, data_len - beat_start_idx) : 0;
+        return beat_lanes{offset, beat_start_idx, end > offset ? static_cast<unsigned>(end - offset) : 0};
+    }
+    return beat_lanes{offset, byte_offset, size}; // aligned or single beat access
+}
+//! copy count byte lanes of a beat starting at lane into dst
+template <typename T> inline void get_lanes(T const& beat, unsigned lane, uint8_t* dst, unsigned count) {
+    for(unsigned i = 0; i < count; ++i) {
+        auto bit_offs = (lane + i) * 8;
+        dst[i] = beat(bit_offs + 7, bit_offs).to_uint();
+    }
+}
+template <unsigned WIDTH>
+inline void get_lanes(data_words<WIDTH> const& beat, unsigned lane, uint8_t* dst, unsigned count) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for(unsigned i = 0; i < count; ++i)
+        dst[i] = beat.w[(lane + i) / 8] >> ((lane + i) % 8 * 8);
+#else
+    std::memcpy(dst, reinterpret_cast<const uint8_t*>(beat.w.data()) + lane, count);
+#endif
+}
+//! copy count bytes from src into the byte lanes of a beat starting at lane
+template <typename T> inline void put_lanes(T& beat, unsigned lane, const uint8_t* src, unsigned count) {
+    for(unsigned i = 0; i < count; ++i) {
+        auto bit_offs = (lane + i) * 8;
+        beat(bit_offs + 7, bit_offs) = src[i];
+    }
+}
+template <unsigned WIDTH>
+inline void put_lanes(data_words<WIDTH>& beat, unsigned lane, const uint8_t* src, unsigned count) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    for(unsigned i = 0; i < count; ++i) {
+        auto& w = beat.w[(lane + i) / 8];
+        auto shift = (lane + i) % 8 * 8;
+        w = (w & ~(0xffULL << shift)) | (static_cast<uint64_t>(src[i]) << shift);
+    }
+#else
+    std::memcpy(reinterpret_cast<uint8_t*>(beat.w.data()) + lane, src, count);
+#endif
+}
+//! get the strobe of a byte lane
+template <typename T> inline bool get_strobe(T const& strb, unsigned lane) { return strb[lane]; }
+template <unsigned WIDTH> inline bool get_strobe(data_words<WIDTH> const& strb, unsigned lane) {
+    return strb.bit(lane);
+}
+//! set the strobe of a byte lane
+template <typename T> inline void set_strobe(T& strb, unsigned lane, bool v) { strb[lane] = v; }
+template <unsigned WIDTH> inline void set_strobe(data_words<WIDTH>& strb, unsigned lane, bool v) {
+    strb.set_bit(lane, v);
+}
+//! the mask of count consecutive bits starting at bit first of a 64bit word, count needs to be at least 1
+inline uint64_t lane_mask(unsigned first, unsigned count) {
+    return (count + first >= 64 ? ~0ULL : (1ULL << (count + first)) - 1) & (~0ULL << first);
+}
+//! set the strobes of count consecutive byte lanes starting at lane
+template <typename T> inline void set_strobes(T& strb, unsigned lane, unsigned count) {
+    if(count)
+        strb = strb.to_uint64() | lane_mask(lane, count);
+}
+template <unsigned WIDTH> inline void set_strobes(data_words<WIDTH>& strb, unsigned lane, unsigned count) {
+    while(count) {
+        auto first = lane % 64;
+        auto n = std::min(count, 64 - first);
+        strb.w[lane / 64] |= lane_mask(first, n);
+        lane += n;
+        count -= n;
+    }
+}
+//! the number of bits set in a word
+inline unsigned count_bits(uint64_t w) {
+    unsigned res = 0;
+    for(; w; w &= w - 1)
+        ++res;
+    return res;
+}
+//! the number of byte lanes being enabled
+template <typename T> inline unsigned count_strobes(T const& strb) { return count_bits(strb.to_uint64()); }
+template <unsigned WIDTH> inline unsigned count_strobes(data_words<WIDTH> const& strb) {
+    unsigned res = 0;
+    for(auto w : strb.w)
+        res += count_bits(w);
+    return res;
+}
 } // namespace axi
 #endif /* _BUS_AXI_SIGNAL_IF_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <obi/obi_tlm.h>
+#include <scc/cached_cci_param.h>
 #include <scc/mt19937_rng.h>
 #include <scc/peq.h>
 #include <scc/report.h>
@@ -76,22 +77,41 @@ public:
 
     tlm::tlm_sync_enum nb_transport_bw(payload_type& trans, phase_type& phase, sc_core::sc_time& t);
 
-    cci::cci_param<sc_core::sc_time> sample_delay{"sample_delay", 0_ns};
-    cci::cci_param<int> req2gnt_delay{"req2gnt_delay", 0};
-    cci::cci_param<int> addr2data_delay{"addr2data_delay", 0};
+    scc::cached_cci_param<sc_core::sc_time> sample_delay{"sample_delay", 0_ns};
+    scc::cached_cci_param<int> req2gnt_delay{"req2gnt_delay", 0};
+    scc::cached_cci_param<int> addr2data_delay{"addr2data_delay", 0};
+    //! the maximum number of requests granted but not yet responded, 0 means unlimited
+    scc::cached_cci_param<unsigned> max_outstanding{"max_outstanding", 0};
+
 private:
     void clk_cb();
     void achannel_req_t();
     void rchannel_rsp_t();
 
+    void end_of_elaboration() override;
+
     void clk_delay() {
-        if(sc_core::sc_delta_count_at_current_time()<5) {
+        if(clk_delay_parked) { // woken by a request, follow the clock again starting with the next edge
+            clk_delay_parked = false;
+            return;
+        }
+        if(!req_i.read()) { // only back-to-back requests are sampled with the delayed clock
+            clk_delay_parked = true;
+            next_trigger(req_i.posedge_event());
+        } else if(sc_core::sc_delta_count_at_current_time()<5) {
             clk_self.notify(sc_core::SC_ZERO_TIME);
             next_trigger(clk_self);
         } else
             clk_delayed.notify(sc_core::SC_ZERO_TIME/*clk_if ? clk_if->period() - 1_ps : 1_ps*/);
     }
-    sc_core::sc_event clk_delayed, clk_self;
+    sc_core::sc_event clk_delayed, clk_self, rsp_pending_evt, tx_finished_evt;
+    bool clk_delay_parked{false};
+    // the interfaces of the optional ports, nullptr if unbound
+    sc_core::sc_signal_in_if<sc_dt::sc_uint<ID_WIDTH>> const* aid_if{nullptr};
+    sc_core::sc_signal_in_if<sc_dt::sc_uint<USER_WIDTH>> const* auser_if{nullptr};
+    sc_core::sc_signal_in_if<sc_dt::sc_uint<USER_WIDTH>> const* wuser_if{nullptr};
+    sc_core::sc_signal_write_if<sc_dt::sc_uint<ID_WIDTH>>* r_id_if{nullptr};
+    sc_core::sc_signal_write_if<sc_dt::sc_uint<USER_WIDTH>>* ruser_if{nullptr};
     scc::peq<tlm::scc::tlm_gp_shared_ptr> achannel_rsp;
     std::deque<std::tuple<tlm::scc::tlm_gp_shared_ptr, unsigned>> rchannel_pending_rsp;
     scc::peq<tlm::scc::tlm_gp_shared_ptr> rchannel_rsp;
@@ -121,9 +141,21 @@ inline target<DATA_WIDTH, ADDR_WIDTH, ID_WIDTH, USER_WIDTH>::target::target(sc_c
     SC_THREAD(rchannel_rsp_t);
 }
 
+template <unsigned int DATA_WIDTH, unsigned int ADDR_WIDTH, unsigned int ID_WIDTH, unsigned int USER_WIDTH>
+inline void target<DATA_WIDTH, ADDR_WIDTH, ID_WIDTH, USER_WIDTH>::target::end_of_elaboration() {
+    aid_if = aid_i.get_interface() ? &*aid_i : nullptr;
+    auser_if = auser_i.get_interface() ? &*auser_i : nullptr;
+    wuser_if = wuser_i.get_interface() ? &*wuser_i : nullptr;
+    r_id_if = r_id_o.get_interface() ? &*r_id_o : nullptr;
+    ruser_if = ruser_o.get_interface() ? &*ruser_o : nullptr;
+}
+
 template <unsigned int DATA_WIDTH, unsigned int ADDR_WIDTH, unsigned int ID_WIDTH, unsigned int USER_WIDTH>
 inline void target<DATA_WIDTH, ADDR_WIDTH, ID_WIDTH, USER_WIDTH>::target::clk_cb() {
-    sc_core::sc_time delay = sc_core::SC_ZERO_TIME;
+    if(rchannel_pending_rsp.empty()) { // nothing to count down, sleep until a response is delayed
+        next_trigger(rsp_pending_evt);
+        return;
+    }
     if(clk_i.event()) {
         if(rchannel_pending_rsp.size()) {
             auto& head = rchannel_pending_rsp.front();
@@ -164,6 +196,7 @@ target<DATA_WIDTH, ADDR_WIDTH, ID_WIDTH, USER_WIDTH>::target::nb_transport_bw(pa
                 rchannel_pending_rsp.push_back({state.pending_tx, resp_delay - 1});
             } else
                 rchannel_pending_rsp.push_back({state.pending_tx, 0});
+            rsp_pending_evt.notify(sc_core::SC_ZERO_TIME);
         }
         state.last_phase = tlm::BEGIN_RESP;
         return tlm::TLM_ACCEPTED;
@@ -179,13 +212,23 @@ inline void target<DATA_WIDTH, ADDR_WIDTH, ID_WIDTH, USER_WIDTH>::achannel_req_t
     wait(SC_ZERO_TIME);
     wait(clk_i.posedge_event());
     while(true) {
-        while(resetn_i.read() == false)
+        if(resetn_i.read() == false) {
+            wait(resetn_i.posedge_event());
             wait(clk_i.posedge_event());
+        }
         while(resetn_i.read() == true) {
+            if(max_outstanding.get_value() && states.size() >= max_outstanding.get_value()) {
+                gnt_o.write(false);
+                while(states.size() >= max_outstanding.get_value())
+                    wait(tx_finished_evt);
+            }
             gnt_o.write(req2gnt_delay == 0);
-            do {
-                wait(this->req_i.posedge_event() | clk_delayed);
-            } while(this->req_i.read() == false);
+            // a request still pending after the last grant is sampled with the delayed clock, otherwise the
+            // thread sleeps until the next request arrives
+            if(this->req_i.read())
+                wait(clk_delayed | this->req_i.negedge_event());
+            while(this->req_i.read() == false)
+                wait(this->req_i.posedge_event());
             auto data_len = DATA_WIDTH / 8;
             tlm::scc::tlm_gp_shared_ptr gp = tlm::scc::tlm_mm<>::get().allocate<obi::obi_extension>(data_len);
             gp->set_streaming_width(data_len);
@@ -208,13 +251,13 @@ inline void target<DATA_WIDTH, ADDR_WIDTH, ID_WIDTH, USER_WIDTH>::achannel_req_t
             } else
                 SCCTRACE(SCMOD) << "Got read request to address 0x" << std::hex << gp->get_address();
             auto ext = gp->get_extension<obi::obi_extension>();
-            if(ID_WIDTH && aid_i.get_interface())
-                ext->set_id(aid_i->read());
+            if(ID_WIDTH && aid_if)
+                ext->set_id(aid_if->read());
             if(USER_WIDTH) {
-                if(auser_i.get_interface())
-                    ext->set_auser(auser_i->read());
-                if(wuser_i.get_interface() && we_i.read())
-                    ext->set_duser(wuser_i->read());
+                if(auser_if)
+                    ext->set_auser(auser_if->read());
+                if(wuser_if && we_i.read())
+                    ext->set_duser(wuser_if->read());
             }
             auto& state = states[gp.get()];
             phase_type phase = tlm::BEGIN_REQ;
@@ -238,6 +281,7 @@ inline void target<DATA_WIDTH, ADDR_WIDTH, ID_WIDTH, USER_WIDTH>::achannel_req_t
                     addr2data_delay < 0 ? scc::MT19937::uniform(0, -addr2data_delay) : addr2data_delay;
                 if(resp_delay) {
                     rchannel_pending_rsp.push_back({gp, resp_delay - 1});
+                    rsp_pending_evt.notify(sc_core::SC_ZERO_TIME);
                 } else
                     rchannel_rsp.notify(gp);
             } else {
@@ -251,10 +295,10 @@ template <unsigned int DATA_WIDTH, unsigned int ADDR_WIDTH, unsigned int ID_WIDT
 inline void target<DATA_WIDTH, ADDR_WIDTH, ID_WIDTH, USER_WIDTH>::rchannel_rsp_t() {
     rdata_o.write(0);
     err_o.write(false);
-    if(ID_WIDTH && r_id_o.get_interface())
-        r_id_o->write(0);
-    if(USER_WIDTH && ruser_o.get_interface())
-        ruser_o->write(0);
+    if(ID_WIDTH && r_id_if)
+        r_id_if->write(0);
+    if(USER_WIDTH && ruser_if)
+        ruser_if->write(0);
     while(true) {
         rvalid_o.write(false);
         tlm::scc::tlm_gp_shared_ptr tx = rchannel_rsp.get();
@@ -271,10 +315,10 @@ inline void target<DATA_WIDTH, ADDR_WIDTH, ID_WIDTH, USER_WIDTH>::rchannel_rsp_t
         err_o.write(tx->get_response_status() != tlm::TLM_OK_RESPONSE);
         if(ID_WIDTH || USER_WIDTH) {
             auto ext = tx->get_extension<obi::obi_extension>();
-            if(ID_WIDTH && r_id_o.get_interface())
-                r_id_o->write(ext->get_id());
-            if(USER_WIDTH && ruser_o.get_interface())
-                ruser_o->write(ext->get_duser());
+            if(ID_WIDTH && r_id_if)
+                r_id_if->write(ext->get_id());
+            if(USER_WIDTH && ruser_if)
+                ruser_if->write(ext->get_duser());
         }
         rvalid_o.write(true);
         wait(sample_delay); // let rready settle
@@ -286,6 +330,7 @@ inline void target<DATA_WIDTH, ADDR_WIDTH, ID_WIDTH, USER_WIDTH>::rchannel_rsp_t
         auto it = states.find(tx.get());
         sc_assert(it != states.end());
         states.erase(it);
+        tx_finished_evt.notify(sc_core::SC_ZERO_TIME);
         wait(clk_i.posedge_event());
     }
 }
@@ -18,6 +18,7 @@
 
 #include "ahb/ahb_tlm.h"
 #include "ahb/pe/ahb_initiator.h"
+#include "ahb/pe/ahb_pipelined_initiator.h"
 #include "ahb/pe/ahb_target.h"
 #include <ahb/pin/initiator.h>
 #include <ahb/pin/target.h>
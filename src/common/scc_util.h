@@ -23,14 +23,25 @@
  */
 /**@{*/
 #include "util/bit_field.h"
+#include "util/bit_layout.h"
+#include "util/bus_trace.h"
+#include "util/cache_tags.h"
+#include "util/checkpoint_image.h"
+#include "util/concurrent_sparse_array.h"
+#include "util/contiguous_array.h"
 #include "util/delegate.h"
+#include "util/image_loader.h"
+#include "util/inplace_function.h"
 #include "util/io-redirector.h"
 #include "util/ities.h"
 #include "util/logging.h"
 #include "util/mt19937_rng.h"
 #include "util/pool_allocator.h"
+#include "util/radix_array.h"
 #include "util/range_lut.h"
+#include "util/snoop_filter.h"
 #include "util/sparse_array.h"
+#include "util/spsc_ring.h"
 #include "util/strprintf.h"
 #include "util/thread_syncronizer.h"
 #include "util/watchdog.h"
@@ -0,0 +1,219 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#include <util/binary_config.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace util;
+
+namespace {
+char const magic[8] = {'S', 'C', 'C', 'B', 'C', 'F', 'G', 0};
+const uint32_t version = 1;
+
+struct header {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+};
+
+struct entry {
+    uint32_t name_offset;
+    uint32_t name_length;
+    uint32_t type;
+    //! the length of a string value whose offset is stored in bits
+    uint32_t length;
+    uint64_t bits;
+};
+
+inline entry const* entries_of(char const* data) { return reinterpret_cast<entry const*>(data + sizeof(header)); }
+} // namespace
+
+binary_config::binary_config(std::string const& name) {
+#ifndef _WIN32
+    auto fd = open(name.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("could not open binary configuration " + name);
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0) {
+        data_size = static_cast<size_t>(st.st_size);
+        auto* ptr = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        data = ptr != MAP_FAILED ? static_cast<char const*>(ptr) : nullptr;
+    }
+    close(fd);
+    if(!data)
+        throw std::runtime_error("could not map binary configuration " + name);
+#else
+    std::ifstream is(name, std::ios::binary);
+    if(!is.is_open())
+        throw std::runtime_error("could not open binary configuration " + name);
+    buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    data_size = buffer.size();
+#endif
+    header hdr;
+    if(data_size < sizeof(hdr)) {
+        unmap();
+        throw std::runtime_error(name + " is not a binary configuration");
+    }
+    std::memcpy(&hdr, data, sizeof(hdr));
+    auto table_end = sizeof(hdr) + static_cast<uint64_t>(hdr.count) * sizeof(entry);
+    if(std::memcmp(hdr.magic, magic, sizeof(magic)) || hdr.version != version || table_end > hdr.strings_offset ||
+       hdr.strings_offset > data_size || hdr.strings_size > data_size - hdr.strings_offset) {
+        unmap();
+        throw std::runtime_error(name + " is not a valid binary configuration");
+    }
+    count = hdr.count;
+    strings = data + hdr.strings_offset;
+    strings_size = hdr.strings_size;
+}
+
+binary_config::~binary_config() { unmap(); }
+
+void binary_config::unmap() {
+#ifndef _WIN32
+    if(data)
+        munmap(const_cast<char*>(data), data_size);
+#endif
+    data = nullptr;
+}
+
+size_t binary_config::find(std::string const& name) const {
+    auto* first = entries_of(data);
+    auto* last = first + count;
+    auto compare = [this](entry const& e, std::string const& n) {
+        if(e.name_offset > strings_size || e.name_length > strings_size - e.name_offset)
+            return false;
+        auto len = std::min<size_t>(e.name_length, n.size());
+        auto res = std::memcmp(strings + e.name_offset, n.data(), len);
+        return res < 0 || (res == 0 && e.name_length < n.size());
+    };
+    auto it = std::lower_bound(first, last, name, compare);
+    if(it == last || it->name_length != name.size() || it->name_offset > strings_size ||
+       it->name_length > strings_size - it->name_offset ||
+       std::memcmp(strings + it->name_offset, name.data(), name.size()))
+        return npos;
+    return static_cast<size_t>(it - first);
+}
+
+std::string binary_config::get_name(size_t idx) const {
+    auto& e = entries_of(data)[idx];
+    if(e.name_offset > strings_size || e.name_length > strings_size - e.name_offset)
+        throw std::runtime_error("corrupt name in binary configuration");
+    return std::string(strings + e.name_offset, e.name_length);
+}
+
+auto binary_config::get_value(size_t idx) const -> value {
+    auto& e = entries_of(data)[idx];
+    value res;
+    res.type = static_cast<value_type>(e.type);
+    res.u = e.bits;
+    switch(e.type) {
+    case BOOL:
+        res.b = e.bits != 0;
+        break;
+    case INT:
+    case UINT:
+        break;
+    case DOUBLE:
+        std::memcpy(&res.d, &e.bits, sizeof(double));
+        break;
+    case STRING:
+        if(e.bits > strings_size || e.length > strings_size - e.bits)
+            throw std::runtime_error("corrupt string in binary configuration");
+        res.str = strings + e.bits;
+        res.len = e.length;
+        break;
+    default:
+        throw std::runtime_error("unknown value type in binary configuration");
+    }
+    return res;
+}
+
+void binary_config_writer::add_bool(std::string const& name, bool v) {
+    items.push_back(item{name, binary_config::BOOL, v ? 1ULL : 0ULL, {}});
+}
+
+void binary_config_writer::add_int(std::string const& name, int64_t v) {
+    items.push_back(item{name, binary_config::INT, static_cast<uint64_t>(v), {}});
+}
+
+void binary_config_writer::add_uint(std::string const& name, uint64_t v) {
+    items.push_back(item{name, binary_config::UINT, v, {}});
+}
+
+void binary_config_writer::add_double(std::string const& name, double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(double));
+    items.push_back(item{name, binary_config::DOUBLE, bits, {}});
+}
+
+void binary_config_writer::add_string(std::string const& name, std::string const& v) {
+    items.push_back(item{name, binary_config::STRING, 0, v});
+}
+
+void binary_config_writer::write(std::string const& name) const {
+    std::vector<item const*> sorted;
+    sorted.reserve(items.size());
+    for(auto& i : items)
+        sorted.push_back(&i);
+    // the last value of a name wins
+    std::stable_sort(sorted.begin(), sorted.end(), [](item const* a, item const* b) { return a->name < b->name; });
+    std::vector<item const*> unique;
+    for(size_t i = 0; i < sorted.size(); ++i)
+        if(i + 1 == sorted.size() || sorted[i]->name != sorted[i + 1]->name)
+            unique.push_back(sorted[i]);
+    std::string pool;
+    std::vector<entry> table;
+    table.reserve(unique.size());
+    for(auto* i : unique) {
+        entry e{static_cast<uint32_t>(pool.size()), static_cast<uint32_t>(i->name.size()), i->type, 0, i->bits};
+        pool += i->name;
+        if(i->type == binary_config::STRING) {
+            e.bits = pool.size();
+            e.length = static_cast<uint32_t>(i->str.size());
+            pool += i->str;
+        }
+        table.push_back(e);
+    }
+    if(pool.size() > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("configuration too large for binary configuration " + name);
+    header hdr;
+    std::memcpy(hdr.magic, magic, sizeof(magic));
+    hdr.version = version;
+    hdr.count = static_cast<uint32_t>(table.size());
+    hdr.strings_offset = sizeof(hdr) + table.size() * sizeof(entry);
+    hdr.strings_size = pool.size();
+    std::ofstream os(name, std::ios::binary | std::ios::trunc);
+    if(!os.is_open())
+        throw std::runtime_error("could not open binary configuration " + name);
+    os.write(reinterpret_cast<char const*>(&hdr), sizeof(hdr));
+    os.write(reinterpret_cast<char const*>(table.data()), table.size() * sizeof(entry));
+    os.write(pool.data(), pool.size());
+    if(!os)
+        throw std::runtime_error("could not write binary configuration " + name);
+}
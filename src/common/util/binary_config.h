@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_BINARY_CONFIG_H_
+#define _UTIL_BINARY_CONFIG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief a configuration stored as a table of typed values sorted by their names
+ *
+ * The file consists of a header, the table of entries and a pool holding the names and string values. It is mapped
+ * into memory when being opened so opening takes constant time, values are looked up using a binary search. The
+ * values are stored in native byte order.
+ */
+class binary_config {
+public:
+    //! the index returned if there is no value of a name
+    static const size_t npos = std::numeric_limits<size_t>::max();
+
+    enum value_type : uint32_t { BOOL = 1, INT = 2, UINT = 3, DOUBLE = 4, STRING = 5 };
+
+    struct value {
+        value_type type;
+        union {
+            bool b;
+            int64_t i;
+            uint64_t u;
+            double d;
+        };
+        //! the characters of a string value, they are not null terminated
+        char const* str{nullptr};
+        size_t len{0};
+    };
+    /**
+     * open a configuration, throws std::runtime_error if it cannot be opened or is not a binary configuration
+     *
+     * @param name the file name
+     */
+    explicit binary_config(std::string const& name);
+
+    ~binary_config();
+
+    binary_config(const binary_config&) = delete;
+
+    binary_config& operator=(const binary_config&) = delete;
+    //! the number of values
+    size_t size() const { return count; }
+    /**
+     * find the value of a name
+     *
+     * @param name the hierarchical name
+     * @return the index of the value or npos
+     */
+    size_t find(std::string const& name) const;
+    //! the name of the value at idx
+    std::string get_name(size_t idx) const;
+    //! the value at idx
+    value get_value(size_t idx) const;
+
+private:
+    void unmap();
+
+    char const* data{nullptr};
+    size_t data_size{0};
+    size_t count{0};
+    char const* strings{nullptr};
+    size_t strings_size{0};
+    std::vector<char> buffer;
+};
+/**
+ * @brief collects values and writes them as binary_config
+ */
+class binary_config_writer {
+public:
+    void add_bool(std::string const& name, bool v);
+
+    void add_int(std::string const& name, int64_t v);
+
+    void add_uint(std::string const& name, uint64_t v);
+
+    void add_double(std::string const& name, double v);
+
+    void add_string(std::string const& name, std::string const& v);
+    /**
+     * write the values collected so far, throws std::runtime_error if the file cannot be written
+     *
+     * @param name the file name
+     */
+    void write(std::string const& name) const;
+
+private:
+    struct item {
+        std::string name;
+        binary_config::value_type type;
+        uint64_t bits;
+        std::string str;
+    };
+    std::vector<item> items;
+};
+} // namespace util
+/**@}*/
+#endif /* _UTIL_BINARY_CONFIG_H_ */
@@ -0,0 +1,163 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#include <util/binary_log.h>
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace util;
+
+namespace {
+char const magic[8] = {'S', 'C', 'C', 'B', 'L', 'O', 'G', 0};
+const uint32_t version = 1;
+//! the kinds of records
+const char string_record = 'S';
+const char message_record = 'M';
+//! the severity being flushed immediately, corresponds to sc_core::SC_WARNING
+const uint8_t flush_severity = 1;
+const size_t buffer_size = 64 * 1024;
+//! the maximum length of a string or message being accepted by the reader
+const uint32_t max_length = 1U << 28;
+//! the upper bound of the address lookup to avoid growing due to temporary strings
+const size_t max_address_slots = 4096;
+
+template <typename T> void append(std::vector<char>& buf, T const& val) {
+    auto pos = buf.size();
+    buf.resize(pos + sizeof(T));
+    std::memcpy(buf.data() + pos, &val, sizeof(T));
+}
+
+void append(std::vector<char>& buf, char const* data, size_t len) { buf.insert(buf.end(), data, data + len); }
+
+template <typename T> bool extract(std::istream& is, T& val) {
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(&val), sizeof(T)));
+}
+
+bool extract(std::istream& is, std::string& str) {
+    uint32_t len;
+    if(!extract(is, len) || len > max_length)
+        return false;
+    str.resize(len);
+    return len == 0 || static_cast<bool>(is.read(&str[0], len));
+}
+} // namespace
+
+binary_log_writer::binary_log_writer(std::string const& name, uint64_t resolution_fs)
+: os(name, std::ios::binary | std::ios::trunc) {
+    if(!os.is_open())
+        throw std::runtime_error("could not open binary log " + name);
+    buffer.reserve(buffer_size + 1024);
+    append(buffer, magic, sizeof(magic));
+    append(buffer, version);
+    append(buffer, uint32_t(0));
+    append(buffer, resolution_fs);
+}
+
+binary_log_writer::~binary_log_writer() { flush(); }
+
+void binary_log_writer::write(uint8_t severity, uint32_t verbosity, char const* type, char const* file, uint32_t line,
+                              uint64_t time, uint64_t delta, char const* msg, size_t len) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto type_id = id_of(type);
+    auto file_id = id_of(file);
+    append(buffer, message_record);
+    append(buffer, severity);
+    append(buffer, uint16_t(0));
+    append(buffer, verbosity);
+    append(buffer, type_id);
+    append(buffer, file_id);
+    append(buffer, line);
+    append(buffer, time);
+    append(buffer, delta);
+    append(buffer, static_cast<uint32_t>(len));
+    append(buffer, msg, len);
+    if(severity >= flush_severity || buffer.size() >= buffer_size)
+        flush_buffer();
+}
+
+void binary_log_writer::flush() {
+    std::lock_guard<std::mutex> lock(mtx);
+    flush_buffer();
+}
+
+uint32_t binary_log_writer::id_of(char const* str) {
+    if(ids_by_address.size() >= max_address_slots)
+        ids_by_address.clear();
+    auto& slot = ids_by_address[reinterpret_cast<uintptr_t>(str)];
+    if(slot.id && slot.str == str)
+        return slot.id;
+    auto it = ids.find(str);
+    if(it == ids.end()) {
+        // the ids start at 1 to distinguish them from empty slots
+        it = ids.emplace(str, static_cast<uint32_t>(ids.size() + 1)).first;
+        append(buffer, string_record);
+        append(buffer, it->second);
+        append(buffer, static_cast<uint32_t>(it->first.size()));
+        append(buffer, it->first.data(), it->first.size());
+    }
+    slot.str = str;
+    slot.id = it->second;
+    return slot.id;
+}
+
+void binary_log_writer::flush_buffer() {
+    if(buffer.empty())
+        return;
+    os.write(buffer.data(), buffer.size());
+    os.flush();
+    buffer.clear();
+}
+
+binary_log_reader::binary_log_reader(std::string const& name)
+: is(name, std::ios::binary) {
+    if(!is.is_open())
+        throw std::runtime_error("could not open binary log " + name);
+    char hdr_magic[sizeof(magic)];
+    uint32_t hdr_version, reserved;
+    if(!is.read(hdr_magic, sizeof(hdr_magic)) || std::memcmp(hdr_magic, magic, sizeof(magic)) ||
+       !extract(is, hdr_version) || !extract(is, reserved) || !extract(is, resolution_fs))
+        throw std::runtime_error(name + " is not a binary log");
+    if(hdr_version != version)
+        throw std::runtime_error(name + " has an unsupported version");
+}
+
+bool binary_log_reader::read(binary_log_record& rec) {
+    char kind;
+    while(extract(is, kind)) {
+        if(kind == string_record) {
+            uint32_t id;
+            std::string str;
+            if(!extract(is, id) || !extract(is, str) || id != strings.size() + 1)
+                throw std::runtime_error("corrupt string record in binary log");
+            strings.emplace_back(std::move(str));
+        } else if(kind == message_record) {
+            uint16_t reserved;
+            uint32_t type_id, file_id;
+            if(!extract(is, rec.severity) || !extract(is, reserved) || !extract(is, rec.verbosity) ||
+               !extract(is, type_id) || !extract(is, file_id) || !extract(is, rec.line) || !extract(is, rec.time) ||
+               !extract(is, rec.delta) || !extract(is, rec.msg))
+                throw std::runtime_error("truncated message record in binary log");
+            if(!type_id || type_id > strings.size() || !file_id || file_id > strings.size())
+                throw std::runtime_error("message record references an unknown string in binary log");
+            rec.type = &strings[type_id - 1];
+            rec.file = &strings[file_id - 1];
+            return true;
+        } else
+            throw std::runtime_error("unknown record in binary log");
+    }
+    return false;
+}
@@ -0,0 +1,144 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_BINARY_LOG_H_
+#define _UTIL_BINARY_LOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <util/open_addressing_map.h>
+#include <vector>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief a log message as stored in a binary log
+ *
+ * The message type and the file name are stored once per log and referenced by an id, the time is kept as raw
+ * value in units of the time resolution of the log.
+ */
+struct binary_log_record {
+    //! the sc_core::sc_severity of the message
+    uint8_t severity{0};
+    //! the verbosity of the message, e.g. sc_core::SC_HIGH
+    uint32_t verbosity{0};
+    uint32_t line{0};
+    uint64_t time{0};
+    uint64_t delta{0};
+    std::string const* type{nullptr};
+    std::string const* file{nullptr};
+    std::string msg;
+};
+/**
+ * @brief writes log messages into a compact binary file
+ *
+ * The formatting of the messages (time stamps, message type fields etc.) is deferred until the log is decoded. The
+ * file starts with a header followed by records in native byte order: string definitions assigning an id to a
+ * message type or file name and messages referencing them. The records are buffered, messages with a severity of
+ * warning or above flush the buffer.
+ */
+class binary_log_writer {
+public:
+    /**
+     * create the log file, throws std::runtime_error if this fails
+     *
+     * @param name the file name
+     * @param resolution_fs the time resolution in femto seconds
+     */
+    binary_log_writer(std::string const& name, uint64_t resolution_fs);
+    //! flushes the outstanding records
+    ~binary_log_writer();
+
+    binary_log_writer(const binary_log_writer&) = delete;
+
+    binary_log_writer& operator=(const binary_log_writer&) = delete;
+    /**
+     * append a message, the strings type and file are expected to be stable and are looked up by their address first
+     *
+     * @param severity the sc_core::sc_severity
+     * @param verbosity the verbosity
+     * @param type the message type
+     * @param file the file name of the log statement
+     * @param line the line of the log statement
+     * @param time the simulation time in units of the resolution
+     * @param delta the delta cycle count
+     * @param msg the message
+     * @param len the length of the message
+     */
+    void write(uint8_t severity, uint32_t verbosity, char const* type, char const* file, uint32_t line, uint64_t time,
+               uint64_t delta, char const* msg, size_t len);
+    //! write the buffered records to the file
+    void flush();
+
+private:
+    struct string_slot {
+        std::string str;
+        uint32_t id{0};
+    };
+    uint32_t id_of(char const* str);
+    void flush_buffer();
+
+    std::ofstream os;
+    std::vector<char> buffer;
+    std::mutex mtx;
+    open_addressing_map<uintptr_t, string_slot> ids_by_address;
+    std::unordered_map<std::string, uint32_t> ids;
+};
+/**
+ * @brief reads the messages of a binary log
+ *
+ * \code
+ * util::binary_log_reader reader("sim.blog");
+ * util::binary_log_record rec;
+ * while(reader.read(rec))
+ *     std::cout << *rec.type << ": " << rec.msg << "\n";
+ * \endcode
+ */
+class binary_log_reader {
+public:
+    /**
+     * open a log, throws std::runtime_error if it cannot be opened or is not a binary log
+     *
+     * @param name the file name
+     */
+    explicit binary_log_reader(std::string const& name);
+    //! the time resolution of the log in femto seconds
+    uint64_t get_resolution_fs() const { return resolution_fs; }
+    /**
+     * read the next message, throws std::runtime_error if the log is corrupt
+     *
+     * @param rec the message read, the strings referenced stay valid as long as the reader exists
+     * @return false at the end of the log
+     */
+    bool read(binary_log_record& rec);
+
+private:
+    std::ifstream is;
+    uint64_t resolution_fs{1};
+    std::deque<std::string> strings;
+};
+} // namespace util
+/**@}*/
+#endif /* _UTIL_BINARY_LOG_H_ */
@@ -0,0 +1,179 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_BIT_LAYOUT_H_
+#define _UTIL_BIT_LAYOUT_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief a bit field of a word described at compile time
+ *
+ * @tparam OFFSET the position of the least significant bit of the field
+ * @tparam BITS the width of the field
+ * @tparam T the type of the word, an unsigned integer
+ */
+template <unsigned OFFSET, unsigned BITS, typename T = uint64_t> struct bit_field_desc {
+    static_assert(std::is_unsigned<T>::value, "the word type needs to be unsigned");
+    static_assert(BITS > 0 && OFFSET + BITS <= sizeof(T) * 8, "the field exceeds the word");
+    using value_type = T;
+    static constexpr unsigned offset = OFFSET;
+    static constexpr unsigned bits = BITS;
+    //! the mask of the field value (not shifted)
+    static constexpr T value_mask = BITS == sizeof(T) * 8 ? ~T(0) : (T(1) << (BITS % (sizeof(T) * 8))) - 1;
+    //! the mask of the field within the word
+    static constexpr T mask = value_mask << OFFSET;
+    //! get the value of the field
+    static constexpr T extract(T word) { return (word >> OFFSET) & value_mask; }
+    //! set the value of the field in word, excess bits of value are dropped
+    static constexpr T insert(T word, T value) { return (word & ~mask) | ((value & value_mask) << OFFSET); }
+};
+
+namespace detail {
+template <typename T, typename... FIELDS> struct bit_field_list {
+    static constexpr T mask = 0;
+    static constexpr unsigned width = 0;
+    static constexpr bool ascending(unsigned) { return true; }
+    static constexpr T insert(T const*) { return 0; }
+    static void extract(T, T*) {}
+    static constexpr T compress(T const*, unsigned) { return 0; }
+    static void expand(T, T*) {}
+};
+
+template <typename T, typename F, typename... FIELDS> struct bit_field_list<T, F, FIELDS...> {
+    using rest = bit_field_list<T, FIELDS...>;
+    static_assert(std::is_same<T, typename F::value_type>::value, "all fields need to have the same word type");
+    static constexpr T mask = F::mask | rest::mask;
+    static constexpr unsigned width = F::bits + rest::width;
+    //! true if the fields are sorted by offset and do not overlap
+    static constexpr bool ascending(unsigned min_offset) {
+        return F::offset >= min_offset && rest::ascending(F::offset + F::bits);
+    }
+    static constexpr T insert(T const* v) { return ((v[0] & F::value_mask) << F::offset) | rest::insert(v + 1); }
+    static void extract(T word, T* v) {
+        v[0] = F::extract(word);
+        rest::extract(word, v + 1);
+    }
+    //! concatenate the values, the first one in the least significant bits
+    static constexpr T compress(T const* v, unsigned pos) {
+        return ((v[0] & F::value_mask) << pos) | rest::compress(v + 1, pos + F::bits);
+    }
+    //! split the concatenated values
+    static void expand(T c, T* v) {
+        v[0] = c & F::value_mask;
+        rest::expand(c >> (F::bits % (sizeof(T) * 8)), v + 1);
+    }
+};
+
+template <typename T> inline T pdep(T src, T mask) {
+#if defined(__BMI2__)
+    return sizeof(T) > 4 ? static_cast<T>(_pdep_u64(src, mask)) : static_cast<T>(_pdep_u32(src, mask));
+#else
+    T res = 0;
+    for(T bb = 1; mask; bb += bb) {
+        if(src & bb)
+            res |= mask & -mask;
+        mask &= mask - 1;
+    }
+    return res;
+#endif
+}
+
+template <typename T> inline T pext(T src, T mask) {
+#if defined(__BMI2__)
+    return sizeof(T) > 4 ? static_cast<T>(_pext_u64(src, mask)) : static_cast<T>(_pext_u32(src, mask));
+#else
+    T res = 0;
+    for(T bb = 1; mask; bb += bb) {
+        if(src & mask & -mask)
+            res |= bb;
+        mask &= mask - 1;
+    }
+    return res;
+#endif
+}
+} // namespace detail
+/**
+ * @brief packs and unpacks several bit fields of a word at once
+ *
+ * The fields need to be given in ascending order of their offset and must not overlap. The values are passed as an
+ * array in the order of the fields. pack() and unpack() use shifts and masks which the compiler resolves at compile
+ * time. With BMI2 (e.g. -mbmi2 or -march=haswell and later) gather() and scatter() convert between the word and the
+ * concatenation of all field values using a single pext/pdep instruction, e.g. to compare or hash the fields of a
+ * header. Without BMI2 they fall back to a loop over the mask bits.
+ *
+ * Example (the AxPROT and AxCACHE fields of a packed AXI request word):
+ * @code
+ * using prot = util::bit_field_desc<0, 3>;
+ * using cache = util::bit_field_desc<3, 4>;
+ * using layout = util::bit_layout<prot, cache>;
+ * auto word = layout::pack({{2, 0xf}});
+ * auto v = layout::unpack(word); // v[0] == 2, v[1] == 0xf
+ * @endcode
+ *
+ * @tparam FIELDS the bit_field_desc types of the fields
+ */
+template <typename F, typename... FIELDS> struct bit_layout {
+    using value_type = typename F::value_type;
+    using list = detail::bit_field_list<value_type, F, FIELDS...>;
+    static_assert(list::ascending(0), "the fields need to be sorted by offset and must not overlap");
+    //! the number of fields
+    static constexpr size_t size = 1 + sizeof...(FIELDS);
+    //! the bits covered by all fields
+    static constexpr value_type mask = list::mask;
+    //! the sum of the widths of all fields
+    static constexpr unsigned width = list::width;
+    using values_type = std::array<value_type, size>;
+    //! build a word from the field values, bits outside of the fields are 0
+    static value_type pack(values_type const& values) { return list::insert(values.data()); }
+    //! set the fields in word leaving the other bits unchanged
+    static value_type insert(value_type word, values_type const& values) {
+        return (word & ~mask) | list::insert(values.data());
+    }
+    //! get all field values of a word
+    static values_type unpack(value_type word) {
+        values_type res;
+        list::extract(word, res.data());
+        return res;
+    }
+    //! get the concatenation of all field values, the first field in the least significant bits
+    static value_type gather(value_type word) { return detail::pext(word, mask); }
+    //! build a word from the concatenation of all field values
+    static value_type scatter(value_type concatenated) { return detail::pdep(concatenated, mask); }
+    //! concatenate field values in the layout of gather()
+    static value_type concatenate(values_type const& values) { return list::compress(values.data(), 0); }
+    //! split a concatenation of field values as returned by gather()
+    static values_type split(value_type concatenated) {
+        values_type res;
+        list::expand(concatenated, res.data());
+        return res;
+    }
+};
+} // namespace util
+/**@}*/
+#endif /* _UTIL_BIT_LAYOUT_H_ */
@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_BUS_TRACE_H_
+#define _UTIL_BUS_TRACE_H_
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <util/image_loader.h>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief a compact binary trace of bus accesses
+ *
+ * The file consists of a file_header followed by fixed size records in the byte order of the host, sorted by their
+ * issue time. Both are multiples of 8 bytes so that the records can be used in place from a memory mapping.
+ */
+namespace bus_trace {
+//! the magic number at the start of the file
+static char const magic[8] = {'S', 'C', 'C', 'B', 'T', 'R', 'C', 0};
+//! the format version
+static const uint32_t version = 1;
+
+struct file_header {
+    char magic[8];
+    uint32_t version;
+    //! the size of a record, allows to extend records in later versions
+    uint32_t record_size;
+};
+//! the commands of a record
+enum command_e : uint8_t { READ = 0, WRITE = 1 };
+//! a bus access
+struct record {
+    //! the time the access is issued in pico seconds
+    uint64_t time_ps;
+    uint64_t address;
+    uint32_t length;
+    //! a command_e
+    uint8_t command;
+    uint8_t reserved;
+    //! an id of the access, e.g. the AXI id or the index of the initiator having issued it
+    uint16_t id;
+};
+static_assert(sizeof(file_header) == 16 && sizeof(record) == 24, "unexpected padding of the bus trace structs");
+/**
+ * @brief writes a bus trace
+ */
+class writer {
+public:
+    /**
+     * create the trace file, throws std::runtime_error if this fails
+     *
+     * @param file_name the name of the file
+     */
+    explicit writer(std::string const& file_name)
+    : os(file_name, std::ios::binary | std::ios::trunc) {
+        if(!os)
+            throw std::runtime_error("could not create bus trace " + file_name);
+        file_header hdr{};
+        std::memcpy(hdr.magic, magic, sizeof(magic));
+        hdr.version = version;
+        hdr.record_size = sizeof(record);
+        os.write(reinterpret_cast<char const*>(&hdr), sizeof(hdr));
+    }
+    //! append a record, the records need to be added in the order of their time
+    void add(record const& rec) { os.write(reinterpret_cast<char const*>(&rec), sizeof(rec)); }
+
+private:
+    std::ofstream os;
+};
+/**
+ * @brief maps a bus trace and gives access to its records
+ */
+class reader {
+public:
+    /**
+     * open a trace, throws std::runtime_error if it cannot be read or is not a bus trace
+     *
+     * @param file_name the name of the file
+     */
+    explicit reader(std::string const& file_name)
+    : file(std::make_shared<mapped_file>(file_name)) {
+        file_header hdr;
+        if(file->size() < sizeof(hdr))
+            throw std::runtime_error(file_name + " is not a bus trace");
+        std::memcpy(&hdr, file->data(), sizeof(hdr));
+        if(std::memcmp(hdr.magic, magic, sizeof(magic)) != 0 || hdr.version != version ||
+           hdr.record_size < sizeof(record))
+            throw std::runtime_error(file_name + " is not a bus trace of a supported version");
+        record_size = hdr.record_size;
+        count = (file->size() - sizeof(hdr)) / record_size;
+    }
+    //! the number of records
+    size_t size() const { return count; }
+    //! get a record
+    record const& operator[](size_t idx) const {
+        return *reinterpret_cast<record const*>(file->data() + sizeof(file_header) + idx * record_size);
+    }
+
+private:
+    std::shared_ptr<mapped_file> file;
+    size_t record_size{sizeof(record)};
+    size_t count{0};
+};
+} // namespace bus_trace
+} // namespace util
+/**@}*/
+#endif /* _UTIL_BUS_TRACE_H_ */
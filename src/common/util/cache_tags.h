@@ -0,0 +1,144 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_CACHE_TAGS_H_
+#define _UTIL_CACHE_TAGS_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief the tag array of a set associative cache
+ *
+ * The tags, the replacement state and the dirty flags are kept in separate arrays (structure of arrays) so that the
+ * lookup only scans the consecutive tags of a set. No data is stored, the array only tells whether an access hits.
+ */
+class cache_tags {
+public:
+    //! the selection of the line being replaced upon a miss
+    enum replacement_policy {
+        LRU,   //!< the least recently used line
+        FIFO,  //!< the line allocated first
+        RANDOM //!< a pseudo random line
+    };
+    //! the outcome of an access
+    struct result {
+        bool hit;
+        //! a dirty line has been evicted, it needs to be written back
+        bool writeback;
+        //! the number of the evicted dirty line
+        uint64_t evicted_line;
+    };
+    /**
+     * @brief constructs an empty (all lines invalid) tag array
+     *
+     * @param sets the number of sets, needs to be a power of 2
+     * @param ways the associativity
+     * @param policy the replacement policy
+     */
+    cache_tags(size_t sets, unsigned ways, replacement_policy policy = LRU)
+    : set_mask(sets - 1)
+    , ways(ways)
+    , policy(policy)
+    , tags(sets * ways, 0)
+    , stamps(sets * ways, 0)
+    , dirty(sets * ways, 0) {
+        assert(sets && (sets & (sets - 1)) == 0 && ways);
+    }
+    /**
+     * @brief access a line, it is allocated upon a miss if allocate is set
+     *
+     * @param line the line number (the address divided by the line size)
+     * @param write if true the line is marked dirty
+     * @param allocate if true a missing line is allocated
+     * @return the outcome of the access
+     */
+    result access(uint64_t line, bool write, bool allocate = true) {
+        auto base = static_cast<size_t>(line & set_mask) * ways;
+        auto key = line + 1;
+        ++clock;
+        for(size_t i = base; i < base + ways; ++i)
+            if(tags[i] == key) {
+                if(policy == LRU)
+                    stamps[i] = clock;
+                dirty[i] |= write;
+                return result{true, false, 0};
+            }
+        if(!allocate)
+            return result{false, false, 0};
+        auto victim = select_victim(base);
+        result res{false, tags[victim] != 0 && dirty[victim], tags[victim] - 1};
+        tags[victim] = key;
+        stamps[victim] = clock;
+        dirty[victim] = write;
+        return res;
+    }
+    //! check if a line is held without changing the replacement state
+    bool contains(uint64_t line) const {
+        auto base = static_cast<size_t>(line & set_mask) * ways;
+        for(size_t i = base; i < base + ways; ++i)
+            if(tags[i] == line + 1)
+                return true;
+        return false;
+    }
+    //! invalidate all lines
+    void clear() {
+        std::fill(tags.begin(), tags.end(), 0);
+        std::fill(dirty.begin(), dirty.end(), 0);
+    }
+
+private:
+    size_t select_victim(size_t base) {
+        for(size_t i = base; i < base + ways; ++i)
+            if(!tags[i])
+                return i;
+        if(policy == RANDOM) {
+            // xorshift64, the sequence only needs to be reproducible
+            rng ^= rng << 13;
+            rng ^= rng >> 7;
+            rng ^= rng << 17;
+            return base + static_cast<size_t>(rng % ways);
+        }
+        auto victim = base;
+        for(size_t i = base + 1; i < base + ways; ++i)
+            if(stamps[i] < stamps[victim])
+                victim = i;
+        return victim;
+    }
+
+    const uint64_t set_mask;
+    const unsigned ways;
+    const replacement_policy policy;
+    //! the line number + 1 of each way, 0 marks an invalid way
+    std::vector<uint64_t> tags;
+    //! the time of the last use (LRU) or of the allocation (FIFO)
+    std::vector<uint64_t> stamps;
+    std::vector<uint8_t> dirty;
+    uint64_t clock{0};
+    uint64_t rng{0x9e3779b97f4a7c15ULL};
+};
+} // namespace util
+/**@}*/
+#endif /* _UTIL_CACHE_TAGS_H_ */
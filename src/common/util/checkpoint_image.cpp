@@ -0,0 +1,139 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#include <util/checkpoint_image.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace util;
+
+namespace {
+char const magic[8] = {'S', 'C', 'C', 'C', 'K', 'P', 'T', 0};
+const uint32_t version = 1;
+//! the file header, the table of contents is located at toc_offset and holds toc_count entries
+struct file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t toc_offset;
+    uint64_t toc_count;
+};
+//! an entry of the table of contents, followed by the name padded to a multiple of 8 bytes
+struct toc_header {
+    uint64_t key;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t name_length;
+    uint32_t reserved;
+};
+
+inline uint64_t padded(uint64_t size) { return (size + 7) & ~uint64_t(7); }
+} // namespace
+
+checkpoint_writer::checkpoint_writer(std::string const& file_name)
+: file_name(file_name)
+, os(file_name, std::ios::binary | std::ios::trunc) {
+    if(!os)
+        throw std::runtime_error("could not create checkpoint image " + file_name);
+    file_header hdr{};
+    os.write(reinterpret_cast<char const*>(&hdr), sizeof(hdr));
+    pos = sizeof(hdr);
+}
+
+checkpoint_writer::~checkpoint_writer() {
+    if(os.is_open())
+        try {
+            finish();
+        } catch(std::exception&) {
+        }
+}
+
+void checkpoint_writer::pad_to(uint64_t new_pos) {
+    static const char zeros[alignment] = {};
+    while(pos < new_pos) {
+        auto chunk = std::min<uint64_t>(new_pos - pos, sizeof(zeros));
+        os.write(zeros, chunk);
+        pos += chunk;
+    }
+}
+
+void checkpoint_writer::add(std::string const& name, uint64_t key, void const* data, uint64_t size, bool aligned) {
+    pad_to(aligned ? (pos + alignment - 1) & ~(alignment - 1) : padded(pos));
+    toc.push_back(toc_entry{name, key, pos, size});
+    os.write(static_cast<char const*>(data), size);
+    pos += size;
+}
+
+void checkpoint_writer::finish() {
+    pad_to(padded(pos));
+    file_header hdr{};
+    std::memcpy(hdr.magic, magic, sizeof(magic));
+    hdr.version = version;
+    hdr.toc_offset = pos;
+    hdr.toc_count = toc.size();
+    for(auto& e : toc) {
+        toc_header th{e.key, e.offset, e.size, static_cast<uint32_t>(e.name.size()), 0};
+        os.write(reinterpret_cast<char const*>(&th), sizeof(th));
+        os.write(e.name.data(), e.name.size());
+        pos += sizeof(th) + e.name.size();
+        pad_to(padded(pos));
+    }
+    // the header is written last so that an incomplete image is not recognized as valid
+    os.seekp(0);
+    os.write(reinterpret_cast<char const*>(&hdr), sizeof(hdr));
+    os.close();
+    if(!os)
+        throw std::runtime_error("could not write checkpoint image " + file_name);
+    toc.clear();
+}
+
+checkpoint_reader::checkpoint_reader(std::string const& file_name)
+: file(std::make_shared<mapped_file>(file_name)) {
+    auto* base = file->data();
+    auto size = file->size();
+    file_header hdr;
+    if(size < sizeof(hdr))
+        throw std::runtime_error(file_name + " is not a checkpoint image");
+    std::memcpy(&hdr, base, sizeof(hdr));
+    if(std::memcmp(hdr.magic, magic, sizeof(magic)) != 0 || hdr.version != version || hdr.toc_offset > size)
+        throw std::runtime_error(file_name + " is not a checkpoint image or is incomplete");
+    auto offs = hdr.toc_offset;
+    for(uint64_t i = 0; i < hdr.toc_count; ++i) {
+        toc_header th;
+        if(offs + sizeof(th) > size)
+            throw std::runtime_error(file_name + " has a truncated table of contents");
+        std::memcpy(&th, base + offs, sizeof(th));
+        offs += sizeof(th);
+        if(offs + th.name_length > size || th.offset + th.size > hdr.toc_offset)
+            throw std::runtime_error(file_name + " has a corrupt table of contents");
+        std::string name(reinterpret_cast<char const*>(base + offs), th.name_length);
+        offs = padded(offs + th.name_length);
+        records[name].push_back(record{th.key, base + th.offset, th.size});
+    }
+}
+
+std::vector<checkpoint_reader::record> const& checkpoint_reader::get(std::string const& name) const {
+    static const std::vector<record> empty;
+    auto it = records.find(name);
+    return it == records.end() ? empty : it->second;
+}
+
+std::string checkpoint_reader::get_string(std::string const& name) const {
+    auto& recs = get(name);
+    return recs.empty() ? std::string() : std::string(reinterpret_cast<char const*>(recs[0].data), recs[0].size);
+}
@@ -0,0 +1,121 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <util/image_loader.h>
+#include <vector>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief writes a checkpoint image
+ *
+ * An image is a sequence of records followed by a table of contents. A record is identified by a name (usually the
+ * hierarchical name of the object it belongs to) and a key (e.g. a page number), several records may have the same
+ * name. Records added as aligned start at a 4 KiB boundary of the file so that they can be used directly from a memory
+ * mapping of the image, e.g. as pages of a util::sparse_array.
+ */
+class checkpoint_writer {
+public:
+    //! the alignment of aligned records in the file
+    static constexpr uint64_t alignment = 4096;
+    /**
+     * create the image file, throws std::runtime_error if this fails
+     *
+     * @param file_name the name of the file
+     */
+    explicit checkpoint_writer(std::string const& file_name);
+    //! finishes the image if not yet done
+    ~checkpoint_writer();
+
+    checkpoint_writer(checkpoint_writer const&) = delete;
+
+    checkpoint_writer& operator=(checkpoint_writer const&) = delete;
+    /**
+     * add a record
+     *
+     * @param name the name of the record
+     * @param key the key of the record
+     * @param data the data
+     * @param size the size of the data
+     * @param aligned if true the data starts at a multiple of alignment in the file
+     */
+    void add(std::string const& name, uint64_t key, void const* data, uint64_t size, bool aligned = false);
+    //! add a string record with key 0
+    void add(std::string const& name, std::string const& value) { add(name, 0, value.data(), value.size()); }
+    //! write the table of contents and close the file, throws std::runtime_error if writing failed
+    void finish();
+
+private:
+    struct toc_entry {
+        std::string name;
+        uint64_t key;
+        uint64_t offset;
+        uint64_t size;
+    };
+    void pad_to(uint64_t pos);
+    std::string file_name;
+    std::ofstream os;
+    uint64_t pos{0};
+    std::vector<toc_entry> toc;
+};
+/**
+ * @brief reads a checkpoint image written by util::checkpoint_writer
+ *
+ * The image is mapped into memory (copy-on-write), the data pointers of the records point into the mapping and stay
+ * valid as long as the reader or a copy of get_file() exists.
+ */
+class checkpoint_reader {
+public:
+    struct record {
+        uint64_t key;
+        uint8_t const* data;
+        uint64_t size;
+    };
+    /**
+     * open an image, throws std::runtime_error if it cannot be read or is not a checkpoint image
+     *
+     * @param file_name the name of the file
+     */
+    explicit checkpoint_reader(std::string const& file_name);
+    /**
+     * get the records of a name
+     *
+     * @param name the name of the records
+     * @return the records in the order they were added, empty if there is none
+     */
+    std::vector<record> const& get(std::string const& name) const;
+    //! get the data of the first record of a name as string, empty if there is none
+    std::string get_string(std::string const& name) const;
+    //! the mapping of the image file
+    std::shared_ptr<mapped_file> const& get_file() const { return file; }
+
+private:
+    std::shared_ptr<mapped_file> file;
+    std::unordered_map<std::string, std::vector<record>> records;
+};
+} // namespace util
+/**@}*/
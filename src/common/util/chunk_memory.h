@@ -0,0 +1,162 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_CHUNK_MEMORY_H_
+#define _UTIL_CHUNK_MEMORY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#ifdef HAVE_GETENV
+#include <cstdlib>
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief the process wide policy how large blocks of memory (pool chunks, sparse array pages) are backed
+ *
+ * The defaults are taken from the environment variables SCC_HUGE_PAGES and SCC_NUMA_LOCAL (if set to a value other
+ * than 0). Changes only affect pools and arrays created afterwards.
+ */
+struct memory_policy {
+    //! back blocks of at least 2MiB with transparent huge pages
+    bool huge_pages;
+    //! bind blocks to the NUMA node of the allocating thread
+    bool numa_local;
+    //! the policy getter
+    static memory_policy& get() {
+        static memory_policy inst{env_flag("SCC_HUGE_PAGES"), env_flag("SCC_NUMA_LOCAL")};
+        return inst;
+    }
+
+private:
+    static bool env_flag(const char* name) {
+#ifdef HAVE_GETENV
+        auto* val = getenv(name);
+        return val && *val && *val != '0';
+#else
+        (void)name;
+        return false;
+#endif
+    }
+};
+/**
+ * @brief allocator of large blocks of memory according to the \ref memory_policy at construction time
+ *
+ * If neither huge pages nor NUMA binding are requested (or the platform is not Linux) the blocks are allocated using
+ * new[], otherwise they are mapped anonymously. Blocks backed by huge pages are aligned to and rounded up to 2MiB, so
+ * huge pages are only used for blocks of at least this size. NUMA binding sets the preferred node of the block so
+ * that it does not depend on the thread touching the memory first.
+ */
+class chunk_memory {
+public:
+    //! the size of a huge page
+    static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+    chunk_memory()
+    : huge_pages(memory_policy::get().huge_pages)
+    , numa_local(memory_policy::get().numa_local) {}
+    /**
+     * @brief allocate a block, the content is not initialized
+     *
+     * @param size the size of the block in bytes
+     * @return the pointer to the block
+     */
+    uint8_t* allocate(size_t size) const {
+#ifdef __linux__
+        if(is_mapped()) {
+            auto len = mapped_size(size);
+            auto align = use_huge_pages(size) ? huge_page_size : 0;
+            auto* p = mmap(nullptr, len + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(p == MAP_FAILED)
+                throw std::bad_alloc();
+            auto* base = static_cast<uint8_t*>(p);
+            if(align) {
+                // cut the mapping to a huge page aligned block
+                auto* aligned =
+                    reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(base) + align - 1) & ~(align - 1));
+                if(aligned > base)
+                    munmap(base, aligned - base);
+                if(base + len + align > aligned + len)
+                    munmap(aligned + len, base + len + align - (aligned + len));
+                base = aligned;
+                madvise(base, len, MADV_HUGEPAGE);
+            }
+            if(numa_local)
+                bind_to_local_node(base, len);
+            return base;
+        }
+#endif
+        return new uint8_t[size];
+    }
+    //! true if the blocks are mapped anonymously and hence are initially zero
+    bool is_mapped() const {
+#ifdef __linux__
+        return huge_pages || numa_local;
+#else
+        return false;
+#endif
+    }
+    /**
+     * @brief release a block allocated by this instance
+     *
+     * @param p the pointer to the block
+     * @param size the size of the block as given to allocate()
+     */
+    void release(uint8_t* p, size_t size) const {
+#ifdef __linux__
+        if(is_mapped()) {
+            munmap(p, mapped_size(size));
+            return;
+        }
+#endif
+        delete[] p;
+    }
+
+private:
+    bool use_huge_pages(size_t size) const { return huge_pages && size >= huge_page_size; }
+
+    size_t mapped_size(size_t size) const {
+        auto page = use_huge_pages(size) ? huge_page_size : 4096;
+        return (size + page - 1) & ~(page - 1);
+    }
+#ifdef __linux__
+    static void bind_to_local_node(void* p, size_t len) {
+        unsigned cpu = 0, node = 0;
+        if(syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 || node >= 8 * sizeof(unsigned long) - 1)
+            return;
+        unsigned long mask = 1UL << node;
+        const int mpol_preferred = 1; // MPOL_PREFERRED of numaif.h
+        // the kernel evaluates maxnode - 1 bits of the mask
+        syscall(SYS_mbind, p, len, mpol_preferred, &mask, 8 * sizeof(mask), 0);
+    }
+#endif
+    bool huge_pages;
+    bool numa_local;
+};
+} // namespace util
+/** @}*/
+#endif /* _UTIL_CHUNK_MEMORY_H_ */
@@ -0,0 +1,137 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _CONCURRENT_SPARSE_ARRAY_H_
+#define _CONCURRENT_SPARSE_ARRAY_H_
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+
+/**
+ *  @brief a sparse array allowing concurrent accesses from multiple threads
+ *
+ *  the array has the same interface as \ref util::sparse_array but the page pointers are atomic. A page is allocated
+ *  lock-free upon first access: the thread creating the page installs it using compare-and-swap, if another thread
+ *  was faster the own page is discarded. Once allocated a page is never moved or released until destruction, so
+ *  references (and DMI pointers) stay valid. Concurrent accesses to the same element need to be synchronized by the
+ *  user.
+ */
+template <typename T, uint64_t SIZE, unsigned PAGE_ADDR_BITS = 24> class concurrent_sparse_array {
+public:
+    static_assert(SIZE > 0, "concurrent_sparse_array size must be greater than 0");
+
+    static constexpr uint64_t page_addr_mask = (1ULL << PAGE_ADDR_BITS) - 1;
+
+    static constexpr uint64_t page_size = (1ULL << PAGE_ADDR_BITS);
+
+    static constexpr uint64_t page_count = (SIZE + page_size - 1) / page_size;
+
+    static constexpr uint64_t page_addr_width = PAGE_ADDR_BITS;
+    //! the pages are allocated individually and are not contiguous in memory
+    static constexpr bool is_contiguous = false;
+
+    using page_type = std::array<T, 1ULL << PAGE_ADDR_BITS>;
+    /**
+     * the default constructor
+     */
+    concurrent_sparse_array() {
+        for(auto& p : arr)
+            p.store(nullptr, std::memory_order_relaxed);
+    }
+
+    concurrent_sparse_array(const concurrent_sparse_array&) = delete;
+
+    concurrent_sparse_array& operator=(const concurrent_sparse_array&) = delete;
+    /**
+     * the destructor
+     */
+    ~concurrent_sparse_array() {
+        for(auto& p : arr)
+            delete p.load(std::memory_order_relaxed);
+    }
+    /**
+     * element access operator
+     *
+     * @param addr address to access
+     * @return the data type reference
+     */
+    T& operator[](uint64_t addr) {
+        assert(addr < SIZE);
+        return (*this)(addr >> PAGE_ADDR_BITS)[addr & page_addr_mask];
+    }
+    /**
+     * page fetch operator, allocates the page if needed
+     *
+     * @param page_nr the page number ot fetch
+     * @return reference to page
+     */
+    page_type& operator()(uint64_t page_nr) {
+        assert(page_nr < page_count);
+        auto& slot = arr[page_nr];
+        auto* p = slot.load(std::memory_order_acquire);
+        if(p)
+            return *p;
+        auto* new_page = new page_type();
+        if(slot.compare_exchange_strong(p, new_page, std::memory_order_acq_rel, std::memory_order_acquire))
+            return *new_page;
+        // another thread installed its page in the meantime
+        delete new_page;
+        return *p;
+    }
+    /**
+     * page fetch operator for read-only accesses, the page needs to be allocated
+     *
+     * @param page_nr the page number ot fetch
+     * @return reference to page
+     */
+    const page_type& operator()(uint64_t page_nr) const {
+        assert(page_nr < page_count);
+        auto* p = arr[page_nr].load(std::memory_order_acquire);
+        assert(p != nullptr);
+        return *p;
+    }
+    /**
+     * check if page for address is allocated
+     *
+     * @param addr the address to check
+     * @return true if the page is allocated
+     */
+    bool is_allocated(uint64_t addr) const {
+        assert(addr < SIZE);
+        return arr[addr >> PAGE_ADDR_BITS].load(std::memory_order_acquire) != nullptr;
+    }
+    /**
+     * get the size of the array
+     *
+     * @return the size
+     */
+    uint64_t size() const { return SIZE; }
+
+protected:
+    std::array<std::atomic<page_type*>, SIZE / (1ULL << PAGE_ADDR_BITS) + 1> arr;
+};
+} // namespace util
+/** @}*/
+#endif /* _CONCURRENT_SPARSE_ARRAY_H_ */
@@ -0,0 +1,297 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _CONTIGUOUS_ARRAY_H_
+#define _CONTIGUOUS_ARRAY_H_
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief allocation policy of \ref util::contiguous_array using calloc
+ *
+ * the memory is allocated upon first access of the array
+ */
+struct calloc_storage {
+    //! the block is allocated upon first access
+    static constexpr bool lazy = true;
+
+    static void* allocate(size_t size) { return std::calloc(size, 1); }
+
+    static void release(void* p, size_t) { std::free(p); }
+};
+/**
+ * @brief allocation policy of \ref util::contiguous_array reserving the virtual address range using mmap
+ *
+ * the whole address range is reserved upon construction without reserving swap space (MAP_NORESERVE), the
+ * OS commits a (zero-filled) physical page only when it is touched. Since the block is always present an access is
+ * plain pointer arithmetic.
+ *
+ * Windows has no equivalent of MAP_NORESERVE: committing pages on demand would need a fault handler as the block is
+ * accessed by plain pointers (e.g. through DMI), so the whole block is reserved and committed upon construction. The
+ * physical pages are still provided upon first touch but the full size is charged against the system commit limit
+ * (RAM plus page file), hence on Windows the size of the array is limited by it.
+ */
+struct mmap_storage {
+    //! the block is allocated upon construction
+    static constexpr bool lazy = false;
+
+    static void* allocate(size_t size) {
+#ifdef _MSC_VER
+        // no sparse backing, see above
+        return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+        auto* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        return p == MAP_FAILED ? nullptr : p;
+#endif
+    }
+
+    static void release(void* p, size_t size) {
+#ifdef _MSC_VER
+        if(p)
+            VirtualFree(p, 0, MEM_RELEASE);
+#else
+        if(p)
+            munmap(p, size);
+#endif
+    }
+};
+/**
+ * @brief allocation policy of \ref util::contiguous_array mapping a file (shared)
+ *
+ * the block is backed by the file given by file_name which is created if it does not exist and extended to the size
+ * of the array (sparse on disk if the filesystem supports it). Changes are written to the page cache and hence become
+ * persistent, the content is available again upon the next mapping without any read-in pass. The file is mapped upon
+ * first access of the array, so the file name needs to be set before. If no file name is set anonymous memory as of
+ * \ref util::mmap_storage is used, if the file cannot be mapped a std::runtime_error is thrown.
+ */
+struct file_storage {
+    //! the block is allocated upon first access
+    static constexpr bool lazy = true;
+    //! the name of the backing file
+    std::string file_name;
+
+    void* allocate(size_t size) {
+        mapped_file = !file_name.empty();
+        if(!mapped_file)
+            return mmap_storage::allocate(size);
+#ifdef _MSC_VER
+        auto fh = CreateFileA(file_name.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(fh == INVALID_HANDLE_VALUE)
+            fail("open");
+        auto mh = CreateFileMappingA(fh, nullptr, PAGE_READWRITE, static_cast<DWORD>(uint64_t(size) >> 32),
+                                     static_cast<DWORD>(size), nullptr);
+        CloseHandle(fh);
+        if(!mh)
+            fail("create a mapping of");
+        auto* p = MapViewOfFile(mh, FILE_MAP_ALL_ACCESS, 0, 0, size);
+        CloseHandle(mh);
+        if(!p)
+            fail("map");
+        return p;
+#else
+        auto fd = ::open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+        if(fd < 0)
+            fail("open");
+        struct stat st;
+        if(::fstat(fd, &st) < 0 || (static_cast<size_t>(st.st_size) < size && ::ftruncate(fd, size) < 0)) {
+            auto err = errno;
+            ::close(fd);
+            errno = err;
+            fail("extend");
+        }
+        auto* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        auto err = errno;
+        ::close(fd);
+        errno = err;
+        if(p == MAP_FAILED)
+            fail("map");
+        return p;
+#endif
+    }
+
+    void release(void* p, size_t size) {
+        if(!mapped_file)
+            return mmap_storage::release(p, size);
+#ifdef _MSC_VER
+        if(p)
+            UnmapViewOfFile(p);
+#else
+        if(p)
+            munmap(p, size);
+#endif
+    }
+
+private:
+    //! set if the block maps file_name, otherwise it is anonymous memory
+    bool mapped_file{false};
+
+    [[noreturn]] void fail(char const* what) const {
+#ifdef _MSC_VER
+        auto reason = "error " + std::to_string(GetLastError());
+#else
+        std::string reason = std::strerror(errno);
+#endif
+        throw std::runtime_error("file_storage: could not " + std::string(what) + " backing file '" + file_name +
+                                 "': " + reason);
+    }
+};
+/**
+ *  @brief a large array being backed by one contiguous block of memory
+ *
+ *  the array provides the same interface as \ref util::sparse_array but allocates the backing store as one
+ *  contiguous block. How and when the block is allocated is defined by the STORAGE policy: \ref util::calloc_storage
+ *  allocates a zero-initialized block upon first access so that the OS (at least on Linux and Windows) commits
+ *  physical pages only when they are touched, \ref util::mmap_storage reserves the virtual address range upon
+ *  construction and \ref util::file_storage maps a file to make the content persistent. The pages are only a view
+ *  into this block, therefore a pointer to any element can be used to access the whole array (e.g. for DMI).
+ */
+template <typename T, uint64_t SIZE, unsigned PAGE_ADDR_BITS = 24, typename STORAGE = calloc_storage>
+class contiguous_array {
+public:
+    static_assert(SIZE > 0, "contiguous_array size must be greater than 0");
+    static_assert(std::is_trivial<T>::value, "contiguous_array can only hold trivial types");
+
+    static constexpr uint64_t page_addr_mask = (1ULL << PAGE_ADDR_BITS) - 1;
+
+    static constexpr uint64_t page_size = (1ULL << PAGE_ADDR_BITS);
+
+    static constexpr uint64_t page_count = (SIZE + page_size - 1) / page_size;
+
+    static constexpr uint64_t page_addr_width = PAGE_ADDR_BITS;
+    //! the storage is one contiguous block of elements
+    static constexpr bool is_contiguous = true;
+    //! the allocation policy
+    using storage_type = STORAGE;
+
+    using page_type = std::array<T, 1ULL << PAGE_ADDR_BITS>;
+    static_assert(sizeof(page_type) == page_size * sizeof(T), "page type must not contain padding");
+    /**
+     * the default constructor
+     */
+    contiguous_array() {
+        if(!STORAGE::lazy)
+            allocate();
+    }
+
+    contiguous_array(const contiguous_array&) = delete;
+
+    contiguous_array& operator=(const contiguous_array&) = delete;
+    /**
+     * the destructor
+     */
+    ~contiguous_array() { storage.release(base, alloc_size); }
+    /**
+     * element access operator
+     *
+     * @param addr address to access
+     * @return the data type reference
+     */
+    T& operator[](uint64_t addr) {
+        assert(addr < SIZE);
+        return data()[addr];
+    }
+    /**
+     * page fetch operator
+     *
+     * @param page_nr the page number ot fetch
+     * @return reference to page
+     */
+    page_type& operator()(uint64_t page_nr) {
+        assert(page_nr < page_count);
+        return *reinterpret_cast<page_type*>(data() + page_nr * page_size);
+    }
+    /**
+     * page fetch operator for read-only accesses, the backing store needs to be allocated
+     *
+     * @param page_nr the page number ot fetch
+     * @return reference to page
+     */
+    const page_type& operator()(uint64_t page_nr) const {
+        assert(page_nr < page_count && base != nullptr);
+        return *reinterpret_cast<const page_type*>(base + page_nr * page_size);
+    }
+    /**
+     * check if page for address is allocated
+     *
+     * @param addr the address to check
+     * @return true if the backing store is allocated
+     */
+    bool is_allocated(uint64_t addr) const {
+        assert(addr < SIZE);
+        return base != nullptr;
+    }
+    /**
+     * get the pointer to the first element of the array, allocates the backing store if needed
+     *
+     * @return pointer to the first element
+     */
+    T* data() {
+        if(STORAGE::lazy && !base)
+            allocate();
+        return base;
+    }
+    /**
+     * get the allocation policy instance, e.g. to configure it before the first access
+     *
+     * @return the allocation policy
+     */
+    STORAGE& get_storage() { return storage; }
+    /**
+     * get the size of the array
+     *
+     * @return the size
+     */
+    uint64_t size() const { return SIZE; }
+
+protected:
+    static constexpr size_t alloc_size = page_count * page_size * sizeof(T);
+
+    void allocate() {
+        base = static_cast<T*>(storage.allocate(alloc_size));
+        if(!base)
+            throw std::bad_alloc();
+    }
+
+    STORAGE storage;
+    T* base{nullptr};
+};
+} // namespace util
+/** @}*/
+#endif /* _CONTIGUOUS_ARRAY_H_ */
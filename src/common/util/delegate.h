@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2018 MINRES Technologies GmbH
+ * Copyright 2018, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -21,6 +21,8 @@
 #define _UTIL_DELEGATE_H_
 
 #include <cassert>
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <new>
 #include <type_traits>
@@ -232,14 +234,14 @@ private:
         return (static_cast<C const*>(object_ptr)->*method_ptr)(::std::forward<A>(args)...);
     }
 
-    template <typename> class is_member_pair : std::false_type {};
+    template <typename> struct is_member_pair : std::false_type {};
 
-    template <class C> class is_member_pair<::std::pair<C* const, R (C::*const)(A...)>> : std::true_type {};
+    template <class C> struct is_member_pair<::std::pair<C* const, R (C::*const)(A...)>> : std::true_type {};
 
-    template <typename> class is_const_member_pair : std::false_type {};
+    template <typename> struct is_const_member_pair : std::false_type {};
 
     template <class C>
-    class is_const_member_pair<::std::pair<C const* const, R (C::*const)(A...) const>> : std::true_type {};
+    struct is_const_member_pair<::std::pair<C const* const, R (C::*const)(A...) const>> : std::true_type {};
 
     template <typename T>
     static typename ::std::enable_if<!(is_member_pair<T>{} || is_const_member_pair<T>{}), R>::type
@@ -253,6 +255,12 @@ private:
         return (static_cast<T*>(object_ptr)->first->*static_cast<T*>(object_ptr)->second)(::std::forward<A>(args)...);
     }
 };
+//! check if a callable does not hold a target, i.e. it is a null function pointer, an empty std::function or delegate
+template <typename F> inline bool is_empty_callable(F const&) { return false; }
+template <typename S> inline bool is_empty_callable(S* const f) { return f == nullptr; }
+template <typename S> inline bool is_empty_callable(::std::function<S> const& f) { return !f; }
+template <typename S> inline bool is_empty_callable(delegate<S> const& f) { return !f; }
+inline bool is_empty_callable(::std::nullptr_t) { return true; }
 } // namespace util
 /**@}*/
 
@@ -0,0 +1,240 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_GLOB_MATCHER_H_
+#define _UTIL_GLOB_MATCHER_H_
+
+#include "ities.h"
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief matches names against a set of globbing patterns at once
+ *
+ * The patterns support the same syntax as glob_to_regex(): ?, *, **, and character classes ([a-z] as well as [!a-z]).
+ * '.' acts as hierarchy delimiter and is only matched with ** (and character classes containing it). The patterns are
+ * stored in a trie of their tokens so that common prefixes are shared, a name is matched by stepping through the trie
+ * character by character. This takes time proportional to the length of the name and the number of patterns being
+ * alive at the same time, not to the number of patterns.
+ */
+class glob_matcher {
+public:
+    //! the id returned if no pattern matches
+    static const size_t npos = std::numeric_limits<size_t>::max();
+
+    glob_matcher() { clear(); }
+    /**
+     * @brief add a pattern, throws std::invalid_argument if the pattern is malformed
+     *
+     * @param glob the globbing pattern
+     * @return the id of the pattern, the number of patterns added before or the id of an identical pattern
+     */
+    size_t add(std::string glob) {
+        util::trim(glob);
+        uint32_t cur = 0;
+        for(size_t idx = 0; idx < glob.size(); ++idx) {
+            auto c = glob[idx];
+            if(c == '\\') {
+                if(++idx == glob.size())
+                    throw std::invalid_argument("trailing escape in '" + glob + "'");
+                cur = literal_child(cur, glob[idx]);
+            } else if(c == '?') {
+                if(!nodes[cur].any) {
+                    // new_node() may reallocate the nodes, so the reference is taken afterwards
+                    auto n = new_node();
+                    nodes[cur].any = n;
+                }
+                cur = nodes[cur].any;
+            } else if(c == '*') {
+                auto double_star = idx + 1 < glob.size() && glob[idx + 1] == '*';
+                if(double_star)
+                    ++idx;
+                auto next = double_star ? nodes[cur].double_star : nodes[cur].star;
+                if(!next) {
+                    next = new_node();
+                    nodes[next].loop = double_star ? 2 : 1;
+                    (double_star ? nodes[cur].double_star : nodes[cur].star) = next;
+                }
+                cur = next;
+            } else if(c == '[') {
+                auto cls = parse_class(glob, idx);
+                uint32_t next = 0;
+                for(auto& e : nodes[cur].classes)
+                    if(classes[e.first] == cls)
+                        next = e.second;
+                if(!next) {
+                    next = new_node();
+                    classes.push_back(cls);
+                    nodes[cur].classes.emplace_back(classes.size() - 1, next);
+                }
+                cur = next;
+            } else
+                cur = literal_child(cur, c);
+        }
+        if(nodes[cur].id == npos)
+            nodes[cur].id = count++;
+        return nodes[cur].id;
+    }
+    /**
+     * @brief match a name
+     *
+     * @param name the name to match
+     * @return the smallest id of the patterns matching name or npos if there is none
+     */
+    size_t match(std::string const& name) const {
+        // the scratch memory is reused so that matching does not depend on the number of nodes
+        thread_local std::vector<uint32_t> cur, next, marks;
+        thread_local uint32_t generation{0};
+        if(marks.size() < nodes.size())
+            marks.resize(nodes.size(), 0);
+        cur.clear();
+        add_state(cur, marks, next_generation(marks, generation), 0);
+        for(auto c : name) {
+            if(cur.empty())
+                return npos;
+            next.clear();
+            auto gen = next_generation(marks, generation);
+            for(auto s : cur) {
+                auto& n = nodes[s];
+                for(auto& e : n.literals)
+                    if(e.first == c)
+                        add_state(next, marks, gen, e.second);
+                if(n.any && c != delimiter)
+                    add_state(next, marks, gen, n.any);
+                for(auto& e : n.classes)
+                    if(classes[e.first][static_cast<unsigned char>(c)])
+                        add_state(next, marks, gen, e.second);
+                if(n.loop == 2 || (n.loop == 1 && c != delimiter))
+                    add_state(next, marks, gen, s);
+            }
+            std::swap(cur, next);
+        }
+        auto res = npos;
+        for(auto s : cur)
+            res = std::min(res, nodes[s].id);
+        return res;
+    }
+    //! the number of distinct patterns
+    size_t size() const { return count; }
+
+    bool empty() const { return count == 0; }
+    //! remove all patterns
+    void clear() {
+        nodes.assign(1, node{});
+        classes.clear();
+        count = 0;
+    }
+
+private:
+#ifdef MTI_SYSTEMC
+    static const char delimiter = '/';
+#else
+    static const char delimiter = '.';
+#endif
+    struct node {
+        std::vector<std::pair<char, uint32_t>> literals;
+        std::vector<std::pair<size_t, uint32_t>> classes;
+        //! the children reached by ?, * and **
+        uint32_t any{0}, star{0}, double_star{0};
+        //! 1 if the node consumes any character but the delimiter (*), 2 if it consumes any character (**)
+        uint8_t loop{0};
+        //! the id of the pattern ending here
+        size_t id{npos};
+    };
+
+    uint32_t new_node() {
+        nodes.emplace_back();
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    uint32_t literal_child(uint32_t cur, char c) {
+        for(auto& e : nodes[cur].literals)
+            if(e.first == c)
+                return e.second;
+        auto n = new_node();
+        nodes[cur].literals.emplace_back(c, n);
+        return n;
+    }
+    // parses a character class starting at glob[idx], leaves idx at the closing bracket
+    static std::bitset<256> parse_class(std::string const& glob, size_t& idx) {
+        std::bitset<256> cls;
+        auto negate = idx + 1 < glob.size() && glob[idx + 1] == '!';
+        if(negate)
+            ++idx;
+        int prev = -1;
+        for(++idx; idx < glob.size(); ++idx) {
+            auto c = static_cast<unsigned char>(glob[idx]);
+            if(c == ']')
+                return negate ? ~cls : cls;
+            if(c == '\\' && idx + 1 < glob.size())
+                c = static_cast<unsigned char>(glob[++idx]);
+            else if(c == '-' && prev >= 0 && idx + 1 < glob.size() && glob[idx + 1] != ']') {
+                auto last = static_cast<unsigned char>(glob[++idx] == '\\' && idx + 1 < glob.size() ? glob[++idx]
+                                                                                                    : glob[idx]);
+                if(last < prev)
+                    throw std::invalid_argument("invalid range in character class of '" + glob + "'");
+                for(auto i = prev; i <= last; ++i)
+                    cls.set(i);
+                prev = -1;
+                continue;
+            }
+            cls.set(c);
+            prev = c;
+        }
+        throw std::invalid_argument("unterminated character class in '" + glob + "'");
+    }
+
+    static uint32_t next_generation(std::vector<uint32_t>& marks, uint32_t& generation) {
+        if(++generation == 0) {
+            std::fill(marks.begin(), marks.end(), 0);
+            generation = 1;
+        }
+        return generation;
+    }
+
+    void add_state(std::vector<uint32_t>& states, std::vector<uint32_t>& marks, uint32_t generation,
+                   uint32_t s) const {
+        if(marks[s] == generation)
+            return;
+        marks[s] = generation;
+        states.push_back(s);
+        // * and ** also match an empty string
+        if(nodes[s].star)
+            add_state(states, marks, generation, nodes[s].star);
+        if(nodes[s].double_star)
+            add_state(states, marks, generation, nodes[s].double_star);
+    }
+
+    std::vector<node> nodes;
+    std::vector<std::bitset<256>> classes;
+    size_t count{0};
+};
+} // namespace util
+/**@}*/
+#endif /* _UTIL_GLOB_MATCHER_H_ */
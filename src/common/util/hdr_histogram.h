@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_HDR_HISTOGRAM_H_
+#define _UTIL_HDR_HISTOGRAM_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief a high dynamic range histogram of 64bit values using a fixed amount of memory
+ *
+ * Values below 2^SUB_BITS are counted exactly, larger values are counted in buckets covering a relative range of
+ * 2^-(SUB_BITS-1), i.e. with the default of 6 bits percentiles are reported with a relative error below 3.2%. The
+ * histogram covers the full range of uint64_t in (65 - SUB_BITS) * 2^(SUB_BITS-1) counters.
+ *
+ * @tparam SUB_BITS the number of significant bits of the bucketed values
+ */
+template <unsigned SUB_BITS = 6> class hdr_histogram {
+    static_assert(SUB_BITS >= 2 && SUB_BITS < 16, "SUB_BITS needs to be in the range of 2..15");
+    static const uint64_t sub_count = 1ULL << SUB_BITS;
+    static const uint64_t half_count = sub_count / 2;
+
+public:
+    //! the number of counters
+    static const size_t size = sub_count + (64 - SUB_BITS) * half_count;
+    /**
+     * @brief add a value
+     *
+     * @param value the value
+     * @param n the number of times the value is counted
+     */
+    void add(uint64_t value, uint64_t n = 1) {
+        if(!n)
+            return;
+        counts[index_of(value)] += n;
+        total += n;
+        sum += static_cast<double>(value) * n;
+        min_val = std::min(min_val, value);
+        max_val = std::max(max_val, value);
+    }
+    //! the number of values added
+    uint64_t count() const { return total; }
+    //! the smallest value added, 0 if the histogram is empty
+    uint64_t min() const { return total ? min_val : 0; }
+    //! the largest value added
+    uint64_t max() const { return max_val; }
+    //! the mean of the values added, 0 if the histogram is empty
+    double mean() const { return total ? sum / total : 0.; }
+    /**
+     * @brief get the value at a percentile
+     *
+     * @param percentile the percentile in the range of 0..100
+     * @return the highest value being equivalent to the bucket holding the percentile, clamped to the range of the
+     * values added
+     */
+    uint64_t value_at_percentile(double percentile) const {
+        if(!total)
+            return 0;
+        auto p = std::min(std::max(percentile, 0.), 100.);
+        auto target = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100. * total + 0.5));
+        uint64_t acc = 0;
+        for(size_t i = 0; i < size; ++i) {
+            acc += counts[i];
+            if(acc >= target)
+                return std::min(std::max(highest_of(i), min_val), max_val);
+        }
+        return max_val;
+    }
+    //! reset the histogram to the empty state
+    void clear() {
+        counts.fill(0);
+        total = 0;
+        sum = 0;
+        min_val = std::numeric_limits<uint64_t>::max();
+        max_val = 0;
+    }
+
+private:
+    static unsigned msb(uint64_t v) {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(v);
+#else
+        unsigned n = 0;
+        while(v >>= 1)
+            ++n;
+        return n;
+#endif
+    }
+    static size_t index_of(uint64_t v) {
+        if(v < sub_count)
+            return static_cast<size_t>(v);
+        // v lies in [2^(SUB_BITS-1+e), 2^(SUB_BITS+e)) so v>>e has SUB_BITS significant bits
+        auto e = msb(v) - SUB_BITS + 1;
+        return static_cast<size_t>(sub_count + (e - 1) * half_count + ((v >> e) - half_count));
+    }
+    static uint64_t highest_of(size_t idx) {
+        if(idx < sub_count)
+            return idx;
+        auto e = (idx - sub_count) / half_count + 1;
+        auto sub = (idx - sub_count) % half_count + half_count;
+        auto low = static_cast<uint64_t>(sub) << e;
+        return low + ((1ULL << e) - 1);
+    }
+
+    std::array<uint64_t, size> counts{};
+    uint64_t total{0};
+    double sum{0};
+    uint64_t min_val{std::numeric_limits<uint64_t>::max()};
+    uint64_t max_val{0};
+};
+} // namespace util
+/**@}*/
+#endif /* _UTIL_HDR_HISTOGRAM_H_ */
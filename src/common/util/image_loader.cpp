@@ -0,0 +1,169 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#include <util/image_loader.h>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace util;
+
+mapped_file::mapped_file(const std::string& name) {
+#ifndef _MSC_VER
+    auto fd = ::open(name.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("could not open " + name);
+    struct stat st;
+    if(::fstat(fd, &st) < 0) {
+        ::close(fd);
+        throw std::runtime_error("could not stat " + name);
+    }
+    length = st.st_size;
+    if(length) {
+        auto* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if(p == MAP_FAILED)
+            throw std::runtime_error("could not map " + name);
+        ptr = static_cast<uint8_t*>(p);
+    } else
+        ::close(fd);
+#else
+    std::ifstream is(name, std::ios::binary);
+    if(!is)
+        throw std::runtime_error("could not open " + name);
+    buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    length = buffer.size();
+    ptr = buffer.data();
+#endif
+}
+
+mapped_file::~mapped_file() {
+#ifndef _MSC_VER
+    if(ptr)
+        ::munmap(ptr, length);
+#endif
+}
+
+namespace {
+uint64_t read_uint(const uint8_t* p, unsigned bytes, bool big_endian) {
+    uint64_t res = 0;
+    for(unsigned i = 0; i < bytes; ++i)
+        res |= static_cast<uint64_t>(p[big_endian ? bytes - 1 - i : i]) << (8 * i);
+    return res;
+}
+
+unsigned hex_byte(const std::string& line, size_t pos) {
+    if(pos + 2 > line.size())
+        throw std::runtime_error("truncated ihex record: " + line);
+    return std::stoul(line.substr(pos, 2), nullptr, 16);
+}
+} // namespace
+
+bool util::is_elf(const uint8_t* data, uint64_t size) {
+    return size > 4 && data[0] == 0x7f && data[1] == 'E' && data[2] == 'L' && data[3] == 'F';
+}
+
+std::vector<image_segment> util::elf_segments(const uint8_t* data, uint64_t size) {
+    if(!is_elf(data, size) || size < 0x34)
+        throw std::runtime_error("not an ELF file");
+    // EI_CLASS and EI_DATA
+    if((data[4] != 1 && data[4] != 2) || (data[5] != 1 && data[5] != 2))
+        throw std::runtime_error("invalid ELF identification");
+    auto is64 = data[4] == 2;
+    auto be = data[5] == 2;
+    if(is64 && size < 0x40)
+        throw std::runtime_error("truncated ELF header");
+    auto phoff = is64 ? read_uint(data + 0x20, 8, be) : read_uint(data + 0x1c, 4, be);
+    auto phentsize = read_uint(data + (is64 ? 0x36 : 0x2a), 2, be);
+    auto phnum = read_uint(data + (is64 ? 0x38 : 0x2c), 2, be);
+    // the size of Elf64_Phdr resp. Elf32_Phdr, the entries are read using this layout
+    if(phnum && phentsize != (is64 ? 56U : 32U))
+        throw std::runtime_error("invalid ELF program header entry size");
+    // checked this way to not overflow with a bogus phoff
+    if(phoff > size || phentsize * phnum > size - phoff)
+        throw std::runtime_error("truncated ELF program header table");
+    std::vector<image_segment> res;
+    for(uint64_t i = 0; i < phnum; ++i) {
+        auto* ph = data + phoff + i * phentsize;
+        if(read_uint(ph, 4, be) != 1) // PT_LOAD
+            continue;
+        image_segment seg;
+        if(is64) {
+            seg.offset = read_uint(ph + 8, 8, be);
+            seg.addr = read_uint(ph + 24, 8, be);
+            seg.file_size = read_uint(ph + 32, 8, be);
+            seg.mem_size = read_uint(ph + 40, 8, be);
+        } else {
+            seg.offset = read_uint(ph + 4, 4, be);
+            seg.addr = read_uint(ph + 12, 4, be);
+            seg.file_size = read_uint(ph + 16, 4, be);
+            seg.mem_size = read_uint(ph + 20, 4, be);
+        }
+        if(seg.offset > size || seg.file_size > size - seg.offset)
+            throw std::runtime_error("ELF segment exceeds file size");
+        if(seg.mem_size || seg.file_size)
+            res.push_back(seg);
+    }
+    return res;
+}
+
+void util::parse_ihex(std::istream& is, std::function<void(uint64_t, const uint8_t*, uint64_t)> write) {
+    uint64_t base = 0;
+    std::vector<uint8_t> rec;
+    std::string line;
+    while(std::getline(is, line)) {
+        while(!line.empty() && (line.back() == '\r' || line.back() == ' '))
+            line.pop_back();
+        if(line.empty())
+            continue;
+        if(line[0] != ':')
+            throw std::runtime_error("invalid ihex record: " + line);
+        auto len = hex_byte(line, 1);
+        rec.resize(len + 5);
+        uint8_t chksum = 0;
+        for(size_t i = 0; i < rec.size(); ++i) {
+            rec[i] = hex_byte(line, 1 + 2 * i);
+            chksum += rec[i];
+        }
+        if(chksum)
+            throw std::runtime_error("ihex checksum mismatch: " + line);
+        if((rec[3] == 2 || rec[3] == 4) && len < 2)
+            throw std::runtime_error("invalid ihex address record: " + line);
+        auto offset = (rec[1] << 8) | rec[2];
+        switch(rec[3]) {
+        case 0: // data
+            write(base + offset, rec.data() + 4, len);
+            break;
+        case 1: // end of file
+            return;
+        case 2: // extended segment address
+            base = ((rec[4] << 8) | rec[5]) << 4;
+            break;
+        case 4: // extended linear address
+            base = static_cast<uint64_t>((rec[4] << 8) | rec[5]) << 16;
+            break;
+        default: // start addresses are ignored
+            break;
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief a private, writable memory mapping of a file
+ *
+ * The file is mapped copy-on-write, modifications of the mapped data are not written back to the file. If the
+ * platform does not support memory mapping the file content is read into a heap buffer.
+ */
+class mapped_file {
+public:
+    /**
+     * map the given file, throws std::runtime_error if the file cannot be opened or mapped
+     *
+     * @param name the file name
+     */
+    explicit mapped_file(const std::string& name);
+
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+
+    mapped_file& operator=(const mapped_file&) = delete;
+    //! get the pointer to the first byte of the file
+    uint8_t* data() const { return ptr; }
+    //! get the size of the file
+    uint64_t size() const { return length; }
+
+private:
+    uint8_t* ptr{nullptr};
+    uint64_t length{0};
+    std::vector<uint8_t> buffer;
+};
+/**
+ * @brief a loadable segment of an image file
+ */
+struct image_segment {
+    //! the (physical) address the segment is loaded to
+    uint64_t addr;
+    //! the offset of the segment data in the file
+    uint64_t offset;
+    //! the number of bytes stored in the file
+    uint64_t file_size;
+    //! the number of bytes occupied in memory, bytes beyond file_size are zero
+    uint64_t mem_size;
+};
+/**
+ * @brief check if the buffer holds an ELF file
+ *
+ * @param data pointer to the file content
+ * @param size the size of the file content
+ * @return true if the ELF magic number is found
+ */
+bool is_elf(const uint8_t* data, uint64_t size);
+/**
+ * @brief get the loadable segments (PT_LOAD) of an ELF32 or ELF64 file using the physical address
+ *
+ * throws std::runtime_error if the file is not a valid ELF file
+ *
+ * @param data pointer to the file content
+ * @param size the size of the file content
+ * @return the list of loadable segments
+ */
+std::vector<image_segment> elf_segments(const uint8_t* data, uint64_t size);
+/**
+ * @brief parse an Intel HEX file and call the write callback for each data record
+ *
+ * throws std::runtime_error if the file is malformed or a record checksum does not match
+ *
+ * @param is the input stream to read from
+ * @param write the callback receiving address, data pointer and length of each data record
+ */
+void parse_ihex(std::istream& is, std::function<void(uint64_t, const uint8_t*, uint64_t)> write);
+} // namespace util
+/** @} */
@@ -0,0 +1,198 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_INPLACE_FUNCTION_H_
+#define _UTIL_INPLACE_FUNCTION_H_
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+namespace detail {
+template <typename F, typename... A> struct is_callable_with {
+    template <typename G>
+    static auto test(int) -> decltype(std::declval<G&>()(std::declval<A>()...), std::true_type());
+    template <typename> static std::false_type test(...);
+    static constexpr bool value = decltype(test<F>(0))::value;
+};
+} // namespace detail
+
+template <typename SIG, size_t CAPACITY = 6 * sizeof(void*)> class inplace_function;
+/**
+ * @brief a type-erased callable stored in a buffer of fixed capacity, it never allocates
+ *
+ * Callables larger than CAPACITY are rejected at compile time, make() wraps them into a std::function instead. Move-only
+ * callables are supported, copying an inplace_function holding one throws std::logic_error. The default capacity holds
+ * a lambda capturing up to 6 pointers or a std::function.
+ *
+ * @tparam R the return type
+ * @tparam A the argument types
+ * @tparam CAPACITY the size of the buffer in bytes
+ */
+template <typename R, typename... A, size_t CAPACITY> class inplace_function<R(A...), CAPACITY> {
+    using storage_type = typename std::aligned_storage<CAPACITY, alignof(std::max_align_t)>::type;
+
+    struct ops_type {
+        R (*invoke)(void*, A&&...);
+        void (*move)(void*, void*);
+        void (*copy)(void*, void const*);
+        void (*destroy)(void*);
+    };
+
+    template <typename F> static void copy_fn(void* dst, void const* src, std::true_type) {
+        new(dst) F(*static_cast<F const*>(src));
+    }
+
+    template <typename F> static void copy_fn(void*, void const*, std::false_type) {
+        throw std::logic_error("copy of an inplace_function holding a move-only callable");
+    }
+
+    template <typename F> static ops_type const* ops_for() {
+        static const ops_type ops{
+            [](void* p, A&&... args) -> R { return (*static_cast<F*>(p))(std::forward<A>(args)...); },
+            [](void* dst, void* src) {
+                new(dst) F(std::move(*static_cast<F*>(src)));
+                static_cast<F*>(src)->~F();
+            },
+            [](void* dst, void const* src) { copy_fn<F>(dst, src, std::is_copy_constructible<F>()); },
+            [](void* p) { static_cast<F*>(p)->~F(); }};
+        return &ops;
+    }
+
+    template <typename F> static inplace_function make_impl(F&& f, std::true_type) {
+        return inplace_function(std::forward<F>(f));
+    }
+
+    template <typename F> static inplace_function make_impl(F&& f, std::false_type) {
+        return inplace_function(std::function<R(A...)>(std::forward<F>(f)));
+    }
+
+public:
+    //! the capacity of the buffer
+    static constexpr size_t capacity = CAPACITY;
+
+    inplace_function() noexcept = default;
+
+    inplace_function(std::nullptr_t) noexcept {}
+
+    template <typename F, typename FT = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<FT, inplace_function>::value &&
+                                                 detail::is_callable_with<FT, A...>::value>::type>
+    inplace_function(F&& f) {
+        static_assert(sizeof(FT) <= CAPACITY, "the callable exceeds the capacity of the inplace_function");
+        static_assert(alignof(FT) <= alignof(storage_type), "the callable needs a larger alignment");
+        new(&storage) FT(std::forward<F>(f));
+        ops = ops_for<FT>();
+    }
+
+    inplace_function(inplace_function const& o) {
+        if(o.ops)
+            o.ops->copy(&storage, &o.storage);
+        ops = o.ops;
+    }
+
+    inplace_function(inplace_function&& o) noexcept
+    : ops(o.ops) {
+        if(ops)
+            ops->move(&storage, &o.storage);
+        o.ops = nullptr;
+    }
+
+    inplace_function& operator=(inplace_function const& o) {
+        if(this != &o) {
+            inplace_function tmp(o);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    inplace_function& operator=(inplace_function&& o) noexcept {
+        if(this != &o) {
+            reset();
+            ops = o.ops;
+            if(ops)
+                ops->move(&storage, &o.storage);
+            o.ops = nullptr;
+        }
+        return *this;
+    }
+
+    inplace_function& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    ~inplace_function() { reset(); }
+    /**
+     * create an inplace_function from any callable, callables exceeding the capacity are wrapped into a std::function
+     * (which allocates) and an empty std::function yields an empty inplace_function
+     *
+     * @param f the callable
+     * @return the inplace_function
+     */
+    template <typename F, typename FT = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<FT, std::function<R(A...)>>::value>::type>
+    static inplace_function make(F&& f) {
+        using fits = std::integral_constant<bool, sizeof(FT) <= CAPACITY && alignof(FT) <= alignof(storage_type)>;
+        return make_impl(std::forward<F>(f), fits());
+    }
+    //! create an empty inplace_function
+    static inplace_function make(std::nullptr_t) { return inplace_function(); }
+    //! create an inplace_function from a std::function, an empty one yields an empty inplace_function
+    static inplace_function make(std::function<R(A...)> const& f) {
+        return f ? inplace_function(f) : inplace_function();
+    }
+    //! true if a callable is stored
+    explicit operator bool() const noexcept { return ops != nullptr; }
+    //! invoke the stored callable, throws std::bad_function_call if empty
+    R operator()(A... args) const {
+        if(!ops)
+            throw std::bad_function_call();
+        return ops->invoke(const_cast<storage_type*>(&storage), std::forward<A>(args)...);
+    }
+
+private:
+    void reset() {
+        if(ops)
+            ops->destroy(&storage);
+        ops = nullptr;
+    }
+
+    storage_type storage;
+    ops_type const* ops{nullptr};
+};
+
+template <typename SIG, size_t CAPACITY>
+inline bool operator==(inplace_function<SIG, CAPACITY> const& f, std::nullptr_t) noexcept {
+    return !f;
+}
+
+template <typename SIG, size_t CAPACITY>
+inline bool operator!=(inplace_function<SIG, CAPACITY> const& f, std::nullptr_t) noexcept {
+    return static_cast<bool>(f);
+}
+} // namespace util
+/**@}*/
+#endif /* _UTIL_INPLACE_FUNCTION_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2019-2022 MINRES Technologies GmbH
+ * Copyright 2019-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -60,6 +60,31 @@ void IoRedirector::start() {
 #endif
 }
 
+void IoRedirector::start(std::function<void(char const*, size_t)> forward) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_capturing)
+        return;
+
+    create_pipes();
+#ifdef F_SETPIPE_SZ
+    // a larger pipe lets the writers continue while the reader thread catches up
+    fcntl(m_pipe[WRITE], F_SETPIPE_SZ, forwardBufSize);
+#endif
+    fflush(stdout);
+    fflush(stderr);
+    m_oldStdOut = copy_fd(fileno(stdout));
+    m_oldStdErr = copy_fd(fileno(stderr));
+    copy_fd_to(m_pipe[WRITE], fileno(stdout));
+    copy_fd_to(m_pipe[WRITE], fileno(stderr));
+    m_capturing = true;
+#ifndef _MSC_VER
+    close_fd(m_pipe[WRITE]);
+#endif
+    m_captured.clear();
+    m_forward = std::move(forward);
+    m_reader = std::thread([this]() { read_and_forward(); });
+}
+
 auto IoRedirector::is_active() -> bool {
     std::lock_guard<std::mutex> lock(m_mutex);
     return m_capturing;
@@ -71,8 +96,23 @@ void IoRedirector::stop() {
         return;
 
     m_captured.clear();
+    fflush(stdout);
+    fflush(stderr);
     copy_fd_to(m_oldStdOut, fileno(stdout));
     copy_fd_to(m_oldStdErr, fileno(stderr));
+    if(m_reader.joinable()) {
+        // restoring stdout and stderr closed the last write end of the pipe so the reader thread sees the end of it
+#ifdef _MSC_VER
+        close_fd(m_pipe[WRITE]);
+#endif
+        m_reader.join();
+        m_forward = nullptr;
+        close_fd(m_oldStdOut);
+        close_fd(m_oldStdErr);
+        close_fd(m_pipe[READ]);
+        m_capturing = false;
+        return;
+    }
 
     std::array<char, bufSize> buf;
     int bytesRead = 0;
@@ -108,7 +148,8 @@ void IoRedirector::stop() {
 
 auto IoRedirector::get_output(bool blocking) -> std::string {
     std::lock_guard<std::mutex> lock(m_mutex);
-    if(m_capturing) {
+    // while forwarding the output the reader thread owns the pipe
+    if(m_capturing && !m_forward) {
         std::string ret;
         std::array<char, bufSize> buf;
         int bytesRead = 0;
@@ -141,6 +182,30 @@ auto IoRedirector::get_output(bool blocking) -> std::string {
     }
 }
 
+void IoRedirector::read_and_forward() {
+    std::string buf(forwardBufSize, '\0');
+    size_t used = 0;
+    for(;;) {
+        auto bytesRead = read(m_pipe[READ], &buf[used], static_cast<unsigned>(buf.size() - used));
+        if(bytesRead < 0 && errno == EINTR)
+            continue;
+        if(bytesRead <= 0)
+            break;
+        used += bytesRead;
+        // pass on the complete lines and keep the incomplete last one
+        auto end = buf.rfind('\n', used - 1);
+        if(end != std::string::npos) {
+            m_forward(buf.data(), end + 1);
+            buf.erase(0, end + 1);
+            buf.resize(buf.size() + end + 1);
+            used -= end + 1;
+        } else if(used == buf.size())
+            buf.resize(buf.size() * 2);
+    }
+    if(used)
+        m_forward(buf.data(), used);
+}
+
 auto IoRedirector::copy_fd(int fd) -> int {
     int ret = -1;
     bool fd_blocked = false;
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2019 MINRES Technologies GmbH
+ * Copyright 2019, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,8 +18,11 @@
 #define _UTIL_IO_REDIRECTOR_H_
 
 #include <fcntl.h>
+#include <functional>
 #include <mutex>
 #include <stdio.h>
+#include <string>
+#include <thread>
 
 /**
  * \ingroup scc-common
@@ -31,15 +34,24 @@ namespace util {
  *
  */
 class IoRedirector {
-    enum { bufSize = 1024 };
+    enum { bufSize = 1024, forwardBufSize = 1024 * 1024 };
 
 public:
     void start();
+    /**
+     * start capturing and pass the output to a callback instead of keeping it. A reader thread reads the output in
+     * large chunks so that writing to stdout does not block on a full pipe, the callback is called from the reader
+     * thread with one or more complete lines (the last line may be incomplete if the capturing stops)
+     *
+     * @param forward the callback receiving the data and its length
+     */
+    void start(std::function<void(char const*, size_t)> forward);
 
     void stop();
 
     bool is_active();
 
+    //! get the captured output, this is empty while forwarding the output
     std::string get_output(bool blocking = false);
 
     static IoRedirector& get() {
@@ -56,6 +68,7 @@ private:
     void create_pipes();
     void copy_fd_to(int src_fd, int destfd);
     void close_fd(int& fd);
+    void read_and_forward();
 
     int m_pipe[2]{};
     int m_oldStdOut;
@@ -63,6 +76,8 @@ private:
     bool m_capturing;
     std::mutex m_mutex;
     std::string m_captured;
+    std::function<void(char const*, size_t)> m_forward;
+    std::thread m_reader;
 };
 } // namespace util
 /** @} */
@@ -1,10 +1,19 @@
 /*******************************************************************************
- * Copyright 2022 MINRES Technologies GmbH
+ * Copyright 2022-2023 MINRES Technologies GmbH
  * SPDX-License-Identifier: Apache-2.0
  ******************************************************************************/
 
 #include "lz4_streambuf.h"
+#include <algorithm>
 #include <stdexcept>
+#include <thread>
+#if defined(__unix__) || defined(__unix) || defined(unix) || (defined(__MACH__) && defined(__APPLE__))
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LZ4D_USE_MMAP
+#endif
 
 namespace util {
 
@@ -68,6 +77,108 @@ void lz4c_steambuf::compress_and_write() {
     }
 }
 
+namespace {
+unsigned compression_threads(unsigned threads) {
+    if(threads)
+        return threads;
+    auto hw = std::thread::hardware_concurrency();
+    return hw ? hw : 1;
+}
+}
+
+lz4c_mt_streambuf::lz4c_mt_streambuf(std::ostream &sink, size_t block_size, unsigned threads)
+: sink(sink)
+, block_size(block_size)
+, own_pool(new thread_pool)
+, pool(*own_pool)
+, max_in_flight(2 * compression_threads(threads))
+, cur(block_size)
+{
+    own_pool->start(compression_threads(threads));
+    prefs = LZ4F_preferences_t();
+    prefs.frameInfo.blockMode = LZ4F_blockIndependent;
+    setp(cur.data(), cur.data() + cur.size() - 1);
+}
+
+lz4c_mt_streambuf::lz4c_mt_streambuf(std::ostream &sink, size_t block_size, thread_pool& pool)
+: sink(sink)
+, block_size(block_size)
+, pool(pool)
+, max_in_flight(2 * std::max<size_t>(pool.size(), 1))
+, cur(block_size)
+{
+    prefs = LZ4F_preferences_t();
+    prefs.frameInfo.blockMode = LZ4F_blockIndependent;
+    setp(cur.data(), cur.data() + cur.size() - 1);
+}
+
+lz4c_mt_streambuf::~lz4c_mt_streambuf() {
+    close();
+}
+
+void lz4c_mt_streambuf::close() {
+    if (closed)
+        return;
+    if (!written || pptr() != pbase())
+        submit(); // an empty stream still gets an (empty) frame
+    while (!in_flight.empty())
+        write_front();
+    sink.flush();
+    closed = true;
+}
+
+std::streambuf::int_type lz4c_mt_streambuf::sync() {
+    if (closed)
+        throw std::runtime_error("Cannot write to closed stream");
+    if (pptr() != pbase())
+        submit();
+    while (!in_flight.empty())
+        write_front();
+    sink.flush();
+    return 0;
+}
+
+std::streambuf::int_type lz4c_mt_streambuf::overflow(int_type ch) {
+    if (closed)
+        throw std::runtime_error("Cannot write to closed stream");
+    submit();
+    *pptr() = static_cast<char_type>(ch);
+    pbump(1);
+    return ch;
+}
+
+void lz4c_mt_streambuf::submit() {
+    block b;
+    if (!free_blocks.empty()) {
+        b = std::move(free_blocks.back());
+        free_blocks.pop_back();
+    }
+    // the filled buffer travels with the task, the put area continues on a recycled one
+    b.src.swap(cur);
+    b.src.resize(pptr() - pbase());
+    cur.resize(block_size);
+    setp(cur.data(), cur.data() + cur.size() - 1);
+    auto const* p = &prefs;
+    auto bp = std::make_shared<block>(std::move(b));
+    in_flight.emplace_back(pool.enqueue([p, bp]() -> block {
+        bp->dest.resize(LZ4F_compressFrameBound(bp->src.size(), p));
+        bp->dest_size = LZ4F_compressFrame(bp->dest.data(), bp->dest.size(), bp->src.data(), bp->src.size(), p);
+        if (LZ4F_isError(bp->dest_size) != 0)
+            throw std::runtime_error(std::string("LZ4 compression failed: ") + LZ4F_getErrorName(bp->dest_size));
+        return std::move(*bp);
+    }));
+    written = true;
+    while (in_flight.size() > max_in_flight)
+        write_front();
+}
+
+void lz4c_mt_streambuf::write_front() {
+    auto b = in_flight.front().get();
+    in_flight.pop_front();
+    sink.write(b.dest.data(), b.dest_size);
+    free_blocks.push_back(std::move(b));
+}
+
 lz4d_streambuf::lz4d_streambuf(std::istream &source, size_t buf_size)
 : src_str(source)
 , src_buf(buf_size)
@@ -105,4 +216,147 @@ std::streambuf::int_type lz4d_streambuf::underflow() {
     return traits_type::to_int_type(*gptr());
 }
 
+lz4d_prefetch_streambuf::lz4d_prefetch_streambuf(std::istream &source, size_t buf_size, size_t ring_size)
+: src_str(&source)
+, src_buf(64 * 1024)
+{
+    start(buf_size, ring_size);
+}
+
+lz4d_prefetch_streambuf::lz4d_prefetch_streambuf(std::string const& file_name, size_t buf_size, size_t ring_size)
+{
+#ifdef LZ4D_USE_MMAP
+    auto fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            auto* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                ::madvise(p, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                mapped = static_cast<char const*>(p);
+                mapped_size = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+    }
+#endif
+    if (!mapped) {
+        own_str.reset(new std::ifstream(file_name, std::ios::binary));
+        if (!own_str->is_open())
+            throw std::runtime_error("could not open " + file_name);
+        src_str = own_str.get();
+        src_buf.resize(64 * 1024);
+    }
+    start(buf_size, ring_size);
+}
+
+lz4d_prefetch_streambuf::~lz4d_prefetch_streambuf() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+    }
+    cv.notify_all();
+    worker.join();
+    LZ4F_freeDecompressionContext(ctx);
+#ifdef LZ4D_USE_MMAP
+    if (mapped)
+        ::munmap(const_cast<char*>(mapped), mapped_size);
+#endif
+}
+
+void lz4d_prefetch_streambuf::start(size_t buf_size, size_t ring_size) {
+    auto ret = LZ4F_createDecompressionContext(&ctx, LZ4F_VERSION);
+    if (LZ4F_isError(ret) != 0)
+        throw std::runtime_error(std::string("Failed to create LZ4 context: ") + LZ4F_getErrorName(ret));
+    ring.resize(std::max<size_t>(ring_size, 2));
+    for (auto& b : ring) {
+        b.data.resize(buf_size);
+        free_bufs.push_back(&b);
+    }
+    setg(nullptr, nullptr, nullptr);
+    worker = std::thread([this]() { decompress(); });
+}
+
+bool lz4d_prefetch_streambuf::next_input(char const*& data, size_t& size) {
+    if (mapped) {
+        if (mapped_done)
+            return false;
+        data = mapped;
+        size = mapped_size;
+        mapped_done = true;
+        return true;
+    }
+    src_str->read(src_buf.data(), src_buf.size());
+    size = static_cast<size_t>(src_str->gcount());
+    data = src_buf.data();
+    return size > 0;
+}
+
+void lz4d_prefetch_streambuf::decompress() {
+    char const* in = nullptr;
+    size_t in_size = 0;
+    try {
+        while (true) {
+            buffer* b;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this]() { return stop || !free_bufs.empty(); });
+                if (stop)
+                    return;
+                b = free_bufs.front();
+                free_bufs.pop_front();
+            }
+            b->size = 0;
+            bool end = false;
+            while (b->size < b->data.size()) {
+                if (!in_size && !next_input(in, in_size)) {
+                    end = true;
+                    break;
+                }
+                auto src_size = in_size;
+                auto dest_size = b->data.size() - b->size;
+                auto ret = LZ4F_decompress(ctx, b->data.data() + b->size, &dest_size, in, &src_size, nullptr);
+                if (LZ4F_isError(ret) != 0)
+                    throw std::runtime_error(std::string("LZ4 decompression failed: ") + LZ4F_getErrorName(ret));
+                in += src_size;
+                in_size -= src_size;
+                b->size += dest_size;
+            }
+            std::lock_guard<std::mutex> lock(mtx);
+            if (b->size)
+                ready.push_back(b);
+            else
+                free_bufs.push_back(b);
+            eof = end;
+            cv.notify_all();
+            if (end)
+                return;
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mtx);
+        error = std::current_exception();
+        eof = true;
+        cv.notify_all();
+    }
+}
+
+std::streambuf::int_type lz4d_prefetch_streambuf::underflow() {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (current) {
+        free_bufs.push_back(current);
+        current = nullptr;
+        cv.notify_all();
+    }
+    cv.wait(lock, [this]() { return !ready.empty() || eof; });
+    if (ready.empty()) {
+        if (error)
+            std::rethrow_exception(error);
+        return traits_type::eof();
+    }
+    current = ready.front();
+    ready.pop_front();
+    setg(current->data.data(), current->data.data(), current->data.data() + current->size);
+    return traits_type::to_int_type(*gptr());
+}
+
 }
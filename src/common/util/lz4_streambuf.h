@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2022 MINRES Technologies GmbH
+ * Copyright 2022-2023 MINRES Technologies GmbH
  * SPDX-License-Identifier: Apache-2.0
  *******************************************************************************
  *
@@ -11,9 +11,19 @@
 #define _UTIL_LZ4_STREAMBUF_H_
 
 #include <lz4frame.h>
+#include "thread_pool.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <future>
 #include <istream>
+#include <memory>
+#include <mutex>
 #include <ostream>
 #include <streambuf>
+#include <string>
+#include <thread>
 #include <vector>
 #include <cassert>
 
@@ -44,6 +54,64 @@ private:
     bool closed{ false };
 };
 
+/**
+ * @brief a compressing stream buffer compressing large blocks in parallel
+ *
+ * Each block is compressed into an LZ4 frame of its own on a util::thread_pool, the frames are written to the sink in
+ * the order of the blocks. A sequence of frames is a valid LZ4 stream, it can be read using lz4d_streambuf or the lz4
+ * command line tool. sync() writes the partially filled block and waits until all frames are written so the number of
+ * syncs should be low compared to the number of blocks.
+ */
+class lz4c_mt_streambuf: public std::streambuf {
+public:
+    /**
+     * @param sink the stream the compressed data is written to
+     * @param block_size the size of the uncompressed blocks
+     * @param threads the number of compression threads, 0 uses the number of hardware threads
+     */
+    lz4c_mt_streambuf(std::ostream &sink, size_t block_size = 4 * 1024 * 1024, unsigned threads = 0);
+    /**
+     * @param sink the stream the compressed data is written to
+     * @param block_size the size of the uncompressed blocks
+     * @param pool the thread pool to compress on, it needs to outlive the stream buffer
+     */
+    lz4c_mt_streambuf(std::ostream &sink, size_t block_size, thread_pool& pool);
+
+    ~lz4c_mt_streambuf();
+
+    void close();
+
+    lz4c_mt_streambuf(const lz4c_mt_streambuf&) = delete;
+    lz4c_mt_streambuf(lz4c_mt_streambuf&&) = delete;
+    lz4c_mt_streambuf& operator=(const lz4c_mt_streambuf&) = delete;
+    lz4c_mt_streambuf& operator=(lz4c_mt_streambuf&&) = delete;
+private:
+    struct block {
+        std::vector<char> src;
+        std::vector<char> dest;
+        size_t dest_size{ 0 };
+    };
+
+    int_type overflow(int_type ch) override;
+
+    int_type sync() override;
+    //! hand the filled part of the current block over to the pool
+    void submit();
+    //! write the oldest compressed block
+    void write_front();
+
+    std::ostream &sink;
+    size_t block_size;
+    std::unique_ptr<thread_pool> own_pool;
+    thread_pool& pool;
+    size_t max_in_flight;
+    LZ4F_preferences_t prefs;
+    std::vector<char> cur;
+    std::deque<std::future<block>> in_flight;
+    std::vector<block> free_blocks;
+    bool written{ false };
+    bool closed{ false };
+};
 
 class lz4d_streambuf: public std::streambuf {
 public:
@@ -65,7 +133,69 @@ private:
     size_t src_buf_size{ 0 };
     LZ4F_decompressionContext_t ctx{ nullptr };
 };
+/**
+ * @brief a decompressing stream buffer reading ahead
+ *
+ * A background thread decompresses the source into a ring of buffers while the reader consumes the data decompressed
+ * before, so reading and decompression overlap. The source is either a stream or a file, files are memory mapped where
+ * supported so that the compressed data does not need to be copied. Errors of the decompression are rethrown in the
+ * reading thread once the data before the error has been consumed.
+ */
+class lz4d_prefetch_streambuf: public std::streambuf {
+public:
+    /**
+     * @param source the stream to read the compressed data from, it must not be used by others while reading
+     * @param buf_size the size of the decompressed buffers
+     * @param ring_size the number of buffers, at least 2
+     */
+    lz4d_prefetch_streambuf(std::istream &source, size_t buf_size = 1024 * 1024, size_t ring_size = 4);
+    /**
+     * @param file_name the file to read the compressed data from
+     * @param buf_size the size of the decompressed buffers
+     * @param ring_size the number of buffers, at least 2
+     */
+    lz4d_prefetch_streambuf(std::string const& file_name, size_t buf_size = 1024 * 1024, size_t ring_size = 4);
+
+    ~lz4d_prefetch_streambuf();
 
+    int_type underflow() override;
+
+    lz4d_prefetch_streambuf(const lz4d_prefetch_streambuf&) = delete;
+    lz4d_prefetch_streambuf(lz4d_prefetch_streambuf&&) = delete;
+    lz4d_prefetch_streambuf& operator=(const lz4d_prefetch_streambuf&) = delete;
+    lz4d_prefetch_streambuf& operator=(lz4d_prefetch_streambuf&&) = delete;
+private:
+    struct buffer {
+        std::vector<char> data;
+        size_t size{ 0 };
+    };
+
+    void start(size_t buf_size, size_t ring_size);
+    //! the background thread
+    void decompress();
+    //! get the next chunk of compressed data, returns false at the end of the source
+    bool next_input(char const*& data, size_t& size);
+
+    std::istream *src_str{ nullptr };
+    std::unique_ptr<std::ifstream> own_str;
+    char const* mapped{ nullptr };
+    size_t mapped_size{ 0 };
+    bool mapped_done{ false };
+    std::vector<char> src_buf;
+    LZ4F_decompressionContext_t ctx{ nullptr };
+    std::vector<buffer> ring;
+    //! the buffers filled by the background thread and not yet consumed
+    std::deque<buffer*> ready;
+    //! the buffers free to be filled
+    std::deque<buffer*> free_bufs;
+    buffer* current{ nullptr };
+    bool eof{ false };
+    bool stop{ false };
+    std::exception_ptr error;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread worker;
+};
 }
 
 #endif /* _UTIL_LZ4_STREAMBUF_H_ */
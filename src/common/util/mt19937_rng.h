@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2020-2022 MINRES Technologies GmbH
+ * Copyright 2020-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,6 +18,8 @@
 #define _UTIL_MT19937_RNG_H_
 
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <random>
 
@@ -79,7 +81,46 @@ public:
         return u(inst());
     }
 
+    /**
+     * fills a buffer with random bytes. The bytes are those of the numbers uniform() would have returned in the order of
+     * the calls (in host byte order), so filling produces the same data as a loop of uniform() calls while the
+     * generator is looked up only once
+     *
+     * @param data the buffer to fill
+     * @param len the number of bytes
+     */
+    static void fill(uint8_t* data, size_t len) { fill_bytes(inst(), data, len); }
+    /**
+     * fills a buffer with random 32bit numbers, each number returned by uniform() provides two of them
+     *
+     * @param data the buffer to fill
+     * @param count the number of elements
+     */
+    static void fill(uint32_t* data, size_t count) { fill_bytes(inst(), data, count * sizeof(uint32_t)); }
+    /**
+     * fills a buffer with random 64bit numbers, the same numbers uniform() would have returned
+     *
+     * @param data the buffer to fill
+     * @param count the number of elements
+     */
+    static void fill(uint64_t* data, size_t count) {
+        auto& eng = inst();
+        for(size_t i = 0; i < count; ++i)
+            data[i] = eng();
+    }
+
 private:
+    static void fill_bytes(std::mt19937_64& eng, void* data, size_t len) {
+        auto* ptr = static_cast<uint8_t*>(data);
+        for(; len >= sizeof(uint64_t); len -= sizeof(uint64_t), ptr += sizeof(uint64_t)) {
+            uint64_t val = eng();
+            std::memcpy(ptr, &val, sizeof(uint64_t));
+        }
+        if(len) {
+            uint64_t val = eng();
+            std::memcpy(ptr, &val, len);
+        }
+    }
     static std::mt19937_64& inst() {
         static thread_local std::mt19937_64 rng;
         return rng;
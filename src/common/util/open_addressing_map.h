@@ -0,0 +1,174 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_OPEN_ADDRESSING_MAP_H_
+#define _UTIL_OPEN_ADDRESSING_MAP_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief a hash map with integral keys using open addressing with linear probing
+ *
+ * It is meant for small maps of in-flight objects keyed by their address (e.g. payload pointers) which see an insert
+ * and an erase for each object. The entries are stored in a single array so that neither insert nor erase allocate
+ * once the map reached its working size. Erasing uses backward shifting so that no tombstones accumulate.
+ *
+ * The key 0 is reserved to mark empty slots and must not be used.
+ *
+ * @tparam KEY the integral key type
+ * @tparam VALUE the value type, needs to be default constructible and movable
+ */
+template <typename KEY, typename VALUE> class open_addressing_map {
+    static_assert(std::is_integral<KEY>::value, "KEY needs to be an integral type");
+
+public:
+    /**
+     * @brief constructs an empty map
+     *
+     * @param capacity the initial number of slots, rounded up to a power of 2
+     */
+    explicit open_addressing_map(size_t capacity = 64) { rehash(capacity); }
+    //! the number of entries
+    size_t size() const { return count; }
+
+    bool empty() const { return count == 0; }
+    /**
+     * @brief find an entry
+     *
+     * @param key the key
+     * @return a pointer to the value or nullptr if there is no entry for key
+     */
+    VALUE* find(KEY key) {
+        assert(key != 0);
+        for(auto idx = slot(key);; idx = (idx + 1) & mask) {
+            if(keys[idx] == key)
+                return &values[idx];
+            if(keys[idx] == 0)
+                return nullptr;
+        }
+    }
+
+    VALUE const* find(KEY key) const { return const_cast<open_addressing_map*>(this)->find(key); }
+    /**
+     * @brief get the value of key, a default constructed value is inserted if there is no entry yet
+     *
+     * @param key the key
+     * @return the reference to the value
+     */
+    VALUE& operator[](KEY key) {
+        assert(key != 0);
+        if((count + 1) * 4 > keys.size() * 3)
+            rehash(keys.size() * 2);
+        auto idx = slot(key);
+        for(; keys[idx] != 0; idx = (idx + 1) & mask)
+            if(keys[idx] == key)
+                return values[idx];
+        keys[idx] = key;
+        ++count;
+        return values[idx];
+    }
+    /**
+     * @brief remove an entry
+     *
+     * @param key the key
+     * @return true if there was an entry for key
+     */
+    bool erase(KEY key) {
+        VALUE dummy;
+        return take(key, dummy);
+    }
+    /**
+     * @brief remove an entry and move its value out of the map
+     *
+     * @param key the key
+     * @param value receives the value of the entry
+     * @return true if there was an entry for key, otherwise value is not changed
+     */
+    bool take(KEY key, VALUE& value) {
+        auto* v = find(key);
+        if(!v)
+            return false;
+        value = std::move(*v);
+        auto idx = static_cast<size_t>(v - values.data());
+        // shift the following entries of the cluster back unless they are at their home slot already
+        for(auto next = (idx + 1) & mask; keys[next] != 0; next = (next + 1) & mask) {
+            auto home = slot(keys[next]);
+            if(((next - home) & mask) >= ((next - idx) & mask)) {
+                keys[idx] = keys[next];
+                values[idx] = std::move(values[next]);
+                idx = next;
+            }
+        }
+        keys[idx] = 0;
+        values[idx] = VALUE();
+        --count;
+        return true;
+    }
+    //! remove all entries, the capacity is kept
+    void clear() {
+        for(size_t i = 0; i < keys.size(); ++i)
+            if(keys[i]) {
+                keys[i] = 0;
+                values[i] = VALUE();
+            }
+        count = 0;
+    }
+
+private:
+    size_t slot(KEY key) const {
+        // fibonacci hashing, the low bits of addresses are usually 0 due to the alignment
+        return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9e3779b97f4a7c15ULL) >> shift);
+    }
+
+    void rehash(size_t capacity) {
+        size_t cap = 8;
+        unsigned bits = 3;
+        while(cap < capacity) {
+            cap <<= 1;
+            ++bits;
+        }
+        std::vector<KEY> old_keys(cap, 0);
+        std::vector<VALUE> old_values(cap);
+        old_keys.swap(keys);
+        old_values.swap(values);
+        mask = cap - 1;
+        shift = 64 - bits;
+        count = 0;
+        for(size_t i = 0; i < old_keys.size(); ++i)
+            if(old_keys[i])
+                (*this)[old_keys[i]] = std::move(old_values[i]);
+    }
+
+    std::vector<KEY> keys;
+    std::vector<VALUE> values;
+    size_t mask{0};
+    unsigned shift{64};
+    size_t count{0};
+};
+} // namespace util
+/**@}*/
+#endif /* _UTIL_OPEN_ADDRESSING_MAP_H_ */
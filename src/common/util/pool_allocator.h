@@ -17,11 +17,18 @@
 #ifndef _UTIL_POOL_ALLOCATOR_H_
 #define _UTIL_POOL_ALLOCATOR_H_
 
+#include "chunk_memory.h"
 #include <algorithm>
 #include <array>
-#include <deque>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <thread>
 #include <vector>
 #ifdef HAVE_GETENV
 #include <cstdlib>
@@ -33,16 +40,170 @@
 /**@{*/
 //! @brief SCC common utilities
 namespace util {
-//! a generic pool allocator singleton not being MT-safe
-template <size_t ELEM_SIZE, unsigned CHUNK_SIZE = 4096> class pool_allocator {
+//! the statistics of a memory pool
+struct pool_statistics {
+    //! the size of the elements
+    size_t elem_size;
+    //! the number of chunks allocated
+    size_t chunks;
+    //! the number of elements in all chunks
+    size_t capacity;
+    //! the number of elements currently in use
+    size_t used;
+    //! the maximum number of elements in use at the same time
+    size_t high_water;
+    //! the number of allocations so far
+    uint64_t allocations;
+};
+//! the interface of pools providing statistics and allowing to release unused memory
+struct pool_if {
+    virtual pool_statistics get_statistics() const = 0;
+    /**
+     * @brief release fully free chunks, must only be called by the thread owning the pool
+     *
+     * @param keep_free the number of fully free chunks being kept to avoid allocating them again
+     * @return the number of released chunks
+     */
+    virtual size_t trim(size_t keep_free = 0) = 0;
+
+protected:
+    virtual ~pool_if() = default;
+};
+/**
+ * @brief the registry of all pool allocator instances
+ *
+ * Pools register upon construction and deregister upon destruction, so the registry can be used to report the
+ * statistics of all pools. The counters of a pool are only updated by its owning thread and are read without
+ * synchronization, so the reported values of pools of other threads are approximate.
+ */
+class pool_registry {
 public:
+    //! the registry getter
+    static pool_registry& get() {
+        static pool_registry inst;
+        return inst;
+    }
+    //! register a pool being owned by the calling thread
+    void add(pool_if* pool) {
+        std::lock_guard<std::mutex> lock(mtx);
+        pools.push_back(entry{pool, std::this_thread::get_id()});
+    }
+
+    void remove(pool_if* pool) {
+        std::lock_guard<std::mutex> lock(mtx);
+        pools.erase(std::remove_if(pools.begin(), pools.end(), [pool](entry const& e) { return e.pool == pool; }),
+                    pools.end());
+    }
+    //! get the statistics of all pools sorted by element size
+    std::vector<pool_statistics> get_statistics() {
+        std::vector<pool_statistics> res;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for(auto& e : pools)
+                res.push_back(e.pool->get_statistics());
+        }
+        std::sort(res.begin(), res.end(),
+                  [](pool_statistics const& a, pool_statistics const& b) { return a.elem_size < b.elem_size; });
+        return res;
+    }
     /**
-     * @fn void allocate*(uint64_t=0)
+     * @brief release the fully free chunks of all pools owned by the calling thread
+     *
+     * @param keep_free the number of fully free chunks being kept per pool
+     * @return the number of released chunks
+     */
+    size_t trim(size_t keep_free = 0) {
+        std::lock_guard<std::mutex> lock(mtx);
+        size_t res = 0;
+        auto id = std::this_thread::get_id();
+        for(auto& e : pools)
+            if(e.owner == id)
+                res += e.pool->trim(keep_free);
+        return res;
+    }
+
+private:
+    pool_registry() = default;
+    struct entry {
+        pool_if* pool;
+        std::thread::id owner;
+    };
+    std::mutex mtx;
+    std::vector<entry> pools;
+};
+//! @cond internal
+namespace detail {
+/**
+ * release the chunks whose elements are all in the free list and rebuild the free list from the remaining elements
+ *
+ * @return the number of released chunks
+ */
+template <typename NODE>
+inline size_t release_free_chunks(std::vector<uint8_t*>& chunks, NODE*& free_list, size_t chunk_elems,
+                                  size_t keep_free, chunk_memory const& mem, size_t chunk_bytes) {
+    std::sort(chunks.begin(), chunks.end());
+    auto chunk_of = [&chunks](NODE* n) -> size_t {
+        return std::upper_bound(chunks.begin(), chunks.end(), reinterpret_cast<uint8_t*>(n)) - chunks.begin() - 1;
+    };
+    std::vector<size_t> free_elems(chunks.size());
+    for(auto* n = free_list; n; n = n->next)
+        ++free_elems[chunk_of(n)];
+    std::vector<bool> release(chunks.size());
+    size_t released = 0, kept = 0;
+    for(size_t i = 0; i < chunks.size(); ++i)
+        if(free_elems[i] == chunk_elems && kept++ >= keep_free) {
+            release[i] = true;
+            ++released;
+        }
+    if(!released)
+        return 0;
+    NODE** tail = &free_list;
+    for(auto* n = free_list; n; n = n->next)
+        if(!release[chunk_of(n)]) {
+            *tail = n;
+            tail = &n->next;
+        }
+    *tail = nullptr;
+    size_t j = 0;
+    for(size_t i = 0; i < chunks.size(); ++i)
+        if(release[i])
+            mem.release(chunks[i], chunk_bytes);
+        else
+            chunks[j++] = chunks[i];
+    chunks.resize(j);
+    return released;
+}
+} // namespace detail
+//! @endcond
+/**
+ * @brief a generic pool allocator singleton not being MT-safe
+ *
+ * Free elements are kept in an intrusive singly linked list stored inside the free elements themselves. Optionally
+ * a small LIFO array of recently freed elements (the front cache) is put in front of the list so that the most
+ * frequent allocate/free pairs neither touch the list nor the (potentially cold) memory of the element.
+ *
+ * If the environment variable TLM_MM_CHECK is set each element is preceded by a header holding the allocation id and
+ * the state of the element. This allows to detect double frees and to report leaked elements upon destruction, if
+ * TLM_MM_CHECK is set to DEBUG the leaked elements with the smallest ids are listed.
+ *
+ * The chunks are allocated according to the \ref util::memory_policy, i.e. they may be backed by huge pages and bound
+ * to the NUMA node of the owning thread.
+ *
+ * @tparam ELEM_SIZE the size of an element
+ * @tparam CHUNK_SIZE the number of elements allocated at once
+ * @tparam FRONT_SIZE the number of entries of the front cache, 0 disables it
+ */
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE = 4096, unsigned FRONT_SIZE = 0>
+class pool_allocator : public pool_if {
+public:
+    /**
+     * @fn void allocate*(uint64_t=0, bool=true)
      * @brief allocate a piece of memory of the given size
      *
-     * @param id
+     * @param id the id of the allocation used for leak reports
+     * @param clear if true the memory is set to zero, can be omitted if the user initializes the memory anyway
      */
-    void* allocate(uint64_t id = 0);
+    void* allocate(uint64_t id = 0, bool clear = true);
     /**
      * @fn void free(void*)
      * @brief pit the memory back into the pool
@@ -72,22 +233,195 @@ public:
     size_t get_capacity();
     //! get the number of free elements
     size_t get_free_entries_count();
+    /**
+     * @fn size_t trim(size_t=0)
+     * @brief release chunks whose elements are all free, the front cache is emptied
+     *
+     * @param keep_free the number of fully free chunks being kept
+     * @return the number of released chunks
+     */
+    size_t trim(size_t keep_free = 0) override;
+    //! get the statistics of the pool
+    pool_statistics get_statistics() const override {
+        return pool_statistics{ELEM_SIZE,    chunks.size(), chunks.size() * CHUNK_SIZE, used_count(), high_water,
+                               allocations};
+    }
 
 private:
-    pool_allocator() = default;
-    using chunk_type = uint8_t[ELEM_SIZE];
-    std::vector<std::array<chunk_type, CHUNK_SIZE>*> chunks{};
-    std::deque<void*> free_list{};
-    std::unordered_map<void*, uint64_t> used_blocks{};
+    pool_allocator() { pool_registry::get().add(this); }
+    //! the node of the free list stored in a free element
+    struct free_node {
+        free_node* next;
+    };
+    //! the header of an element if memory debugging is enabled
+    struct block_header {
+        uint64_t id;
+        uint64_t in_use;
+    };
+    //! the element size rounded up so that each element can hold a properly aligned free_node
+    static constexpr size_t elem_stride =
+        ((ELEM_SIZE > sizeof(free_node) ? ELEM_SIZE : sizeof(free_node)) + alignof(free_node) - 1) &
+        ~(alignof(free_node) - 1);
+
+    static block_header* header_of(void* p) {
+        return reinterpret_cast<block_header*>(static_cast<uint8_t*>(p) - sizeof(block_header));
+    }
+
+    size_t used_count() const { return chunks.size() * CHUNK_SIZE - free_count - front_count; }
 #ifdef HAVE_GETENV
     const bool debug_memory{getenv("TLM_MM_CHECK") != nullptr};
 #else
     const bool debug_memory{false};
 #endif
+    //! the distance of two elements in a chunk
+    const size_t stride{elem_stride + (debug_memory ? sizeof(block_header) : 0)};
+    //! the allocator of the chunks according to the memory policy
+    const chunk_memory chunk_mem{};
+    std::vector<uint8_t*> chunks{};
+    free_node* free_list{nullptr};
+    size_t free_count{0};
+    std::array<void*, FRONT_SIZE> front{};
+    unsigned front_count{0};
+    size_t high_water{0};
+    uint64_t allocations{0};
 };
 
-template<typename T>
-class stl_pool_allocator {
+/**
+ * @brief a pool allocator singleton allowing to free elements from any thread
+ *
+ * Each thread has its own pool (like \ref util::pool_allocator), each element carries a hidden header pointing to the
+ * owning pool. Elements freed by the owning thread are put back into its free list, elements freed by other threads
+ * are pushed onto a lock-free return list of the owning pool which is collected by the owner once its free list is
+ * exhausted. If a thread terminates while some of its elements are still in use the pool is abandoned and destroyed
+ * once the last of these elements has been returned.
+ *
+ * @tparam ELEM_SIZE the size of an element
+ * @tparam CHUNK_SIZE the number of elements allocated at once
+ */
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE = 4096> class mt_pool_allocator : public pool_if {
+public:
+    /**
+     * @fn void allocate*(uint64_t=0, bool=true)
+     * @brief allocate a piece of memory of the given size from the pool of the calling thread
+     *
+     * @param id unused, for compatibility with \ref util::pool_allocator
+     * @param clear if true the memory is set to zero
+     */
+    void* allocate(uint64_t id = 0, bool clear = true);
+    /**
+     * @fn void free(void*)
+     * @brief put the memory back into its owning pool, the calling thread may be any thread
+     *
+     * @param p
+     */
+    void free(void* p);
+    //! deleted constructor
+    mt_pool_allocator(const mt_pool_allocator&) = delete;
+    //! deleted constructor
+    mt_pool_allocator(mt_pool_allocator&&) = delete;
+    //! deleted assignment operator
+    mt_pool_allocator& operator=(const mt_pool_allocator&) = delete;
+    //! deleted assignment operator
+    mt_pool_allocator& operator=(mt_pool_allocator&&) = delete;
+    //! pool allocator getter returning the pool of the calling thread
+    static mt_pool_allocator& get();
+    //! get the number of elements of the pool
+    size_t get_capacity();
+    //! get the number of free elements including the ones returned by other threads
+    size_t get_free_entries_count();
+    /**
+     * @fn size_t trim(size_t=0)
+     * @brief release chunks whose elements are all free (including elements returned by other threads), must be
+     * called by the owning thread
+     *
+     * @param keep_free the number of fully free chunks being kept
+     * @return the number of released chunks
+     */
+    size_t trim(size_t keep_free = 0) override;
+    //! get the statistics of the pool, may be called from any thread
+    pool_statistics get_statistics() const override {
+        auto capacity = chunk_count.load(std::memory_order_relaxed) * CHUNK_SIZE;
+        auto free = free_count.load(std::memory_order_relaxed) + remote_returned();
+        return pool_statistics{ELEM_SIZE,
+                               chunk_count.load(std::memory_order_relaxed),
+                               capacity,
+                               capacity > free ? capacity - free : 0,
+                               high_water.load(std::memory_order_relaxed),
+                               allocations.load(std::memory_order_relaxed)};
+    }
+
+private:
+    mt_pool_allocator() { pool_registry::get().add(this); }
+
+    ~mt_pool_allocator() {
+        pool_registry::get().remove(this);
+        for(auto p : chunks)
+            chunk_mem.release(p, elem_stride * CHUNK_SIZE);
+    }
+    //! the owner of a pool instance living in thread local storage
+    struct owner {
+        mt_pool_allocator* pool{new mt_pool_allocator()};
+        ~owner() { pool->abandon(); }
+    };
+    //! the node of the free lists stored in a free element
+    struct free_node {
+        free_node* next;
+    };
+    //! the size of the hidden header keeping the element maximally aligned
+    static constexpr size_t header_size = alignof(std::max_align_t) > sizeof(void*) ? alignof(std::max_align_t)
+                                                                                   : sizeof(void*);
+    //! the distance of two elements in a chunk
+    static constexpr size_t elem_stride =
+        header_size + (((ELEM_SIZE > sizeof(free_node) ? ELEM_SIZE : sizeof(free_node)) + header_size - 1) &
+                       ~(header_size - 1));
+
+    static mt_pool_allocator*& owner_of(void* p) {
+        return *reinterpret_cast<mt_pool_allocator**>(static_cast<uint8_t*>(p) - header_size);
+    }
+    /**
+     * called upon termination of the owning thread. Removing the bias and the number of elements not being in the
+     * local free list lets remote_count drop to 0 once the last element is returned. The thread whose atomic update
+     * results in 0 destroys the pool, so no other thread accesses it afterwards.
+     */
+    void abandon() {
+        auto pending = static_cast<ptrdiff_t>(chunks.size() * CHUNK_SIZE - free_count.load(std::memory_order_relaxed));
+        if(remote_count.fetch_sub(remote_bias + pending, std::memory_order_acq_rel) == remote_bias + pending)
+            delete this;
+    }
+    //! the number of elements in the return list
+    size_t remote_returned() const {
+        auto cnt = remote_count.load(std::memory_order_relaxed);
+        return cnt > remote_bias ? static_cast<size_t>(cnt - remote_bias) : 0;
+    }
+    void resize();
+    //! the owner only writes the counters below, they are atomic to allow reading the statistics from other threads
+    void set_free_count(size_t cnt) { free_count.store(cnt, std::memory_order_relaxed); }
+    //! the allocator of the chunks according to the memory policy
+    const chunk_memory chunk_mem{};
+    std::vector<uint8_t*> chunks{};
+    free_node* free_list{nullptr};
+    std::atomic<size_t> free_count{0};
+    std::atomic<size_t> chunk_count{0};
+    std::atomic<size_t> high_water{0};
+    std::atomic<uint64_t> allocations{0};
+    //! the elements returned by other threads
+    std::atomic<free_node*> remote_list{nullptr};
+    //! the bias of remote_count while the owning thread is alive, it keeps the counter away from 0
+    static constexpr ptrdiff_t remote_bias = ptrdiff_t(1) << 40;
+    //! the number of elements returned by other threads plus the bias, may be transiently below the bias
+    std::atomic<ptrdiff_t> remote_count{remote_bias};
+};
+
+/**
+ * @brief a STL compatible allocator using pool allocators
+ *
+ * Single elements (e.g. the nodes of std::map or std::list) are taken from a pool of exactly this size, arrays are
+ * rounded up to the next size class (16, 64, 256, 1024, 4096 or 16384 elements). Larger arrays are allocated using
+ * ::operator new.
+ *
+ * @tparam T the value type
+ */
+template <typename T> class stl_pool_allocator {
 public:
     typedef T value_type;
     typedef value_type* pointer;
@@ -97,84 +431,96 @@ public:
     typedef std::size_t size_type;
     typedef std::ptrdiff_t difference_type;
     //    convert an allocator<T> to allocator<U> e.g. for std::map from A to _Node<A>
-    template<typename U>
-    struct rebind {
-        typedef stl_pool_allocator<U> other;
-    };
+    template <typename U> struct rebind { typedef stl_pool_allocator<U> other; };
+
+    stl_pool_allocator() noexcept {}
 
-    stl_pool_allocator(const stl_pool_allocator&) noexcept { }
+    stl_pool_allocator(const stl_pool_allocator&) noexcept {}
 
-    template<typename T2>
-    stl_pool_allocator(const stl_pool_allocator<T2>&) noexcept { }
+    template <typename T2> stl_pool_allocator(const stl_pool_allocator<T2>&) noexcept {}
 
-    ~stl_pool_allocator() _GLIBCXX_USE_NOEXCEPT { }
+    ~stl_pool_allocator() noexcept {}
 
     //    address
-    pointer address(reference r) { return std::addressof(r);}
+    pointer address(reference r) { return std::addressof(r); }
     const_pointer address(const_reference r) { return std::addressof(r); }
 
     pointer allocate(size_type n, const void* = 0) {
-    	size_type value = 16;
-    	while(value<n) value <<=2;
-    	switch(n) {
-    	case 16:
-    		return static_cast<T*>(util::pool_allocator<16*sizeof(T), 65536>::get().allocate());
-    	case 64:
-    		return static_cast<T*>(util::pool_allocator<64*sizeof(T), 16384>::get().allocate());
-    	case 256:
-    		return static_cast<T*>(util::pool_allocator<256*sizeof(T), 4096>::get().allocate());
-    	case 1024:
-    		return static_cast<T*>(util::pool_allocator<1024*sizeof(T), 1024>::get().allocate());
-		case 4096:
-    		return static_cast<T*>(util::pool_allocator<4096*sizeof(T), 256>::get().allocate());
-    	case 16384:
-    		return static_cast<T*>(util::pool_allocator<16384*sizeof(T), 64>::get().allocate());
-    	default:
-    		return static_cast<T*>(::operator new(n * sizeof(T)));
-    	}
+        switch(size_class(n)) {
+        case 1:
+            return static_cast<T*>(util::pool_allocator<sizeof(T), 4096>::get().allocate(0, false));
+        case 16:
+            return static_cast<T*>(util::pool_allocator<16 * sizeof(T), 4096>::get().allocate(0, false));
+        case 64:
+            return static_cast<T*>(util::pool_allocator<64 * sizeof(T), 1024>::get().allocate(0, false));
+        case 256:
+            return static_cast<T*>(util::pool_allocator<256 * sizeof(T), 256>::get().allocate(0, false));
+        case 1024:
+            return static_cast<T*>(util::pool_allocator<1024 * sizeof(T), 64>::get().allocate(0, false));
+        case 4096:
+            return static_cast<T*>(util::pool_allocator<4096 * sizeof(T), 16>::get().allocate(0, false));
+        case 16384:
+            return static_cast<T*>(util::pool_allocator<16384 * sizeof(T), 4>::get().allocate(0, false));
+        default:
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
     }
 
     void deallocate(T* p, size_type n) noexcept {
-    	size_type value = 16;
-    	while(value<n) value <<= 2;
-    	switch(n) {
-    	case 16:
-    		util::pool_allocator<16*sizeof(T), 65536>::get().free(p);
-    		break;
-    	case 64:
-    		util::pool_allocator<64*sizeof(T), 16384>::get().free(p);
-    		break;
-    	case 256:
-    		util::pool_allocator<256*sizeof(T), 4096>::get().free(p);
-    		break;
-    	case 1024:
-    		util::pool_allocator<1024*sizeof(T), 1024>::get().free(p);
-    		break;
-		case 4096:
-    		util::pool_allocator<4096*sizeof(T), 256>::get().free(p);
-    		break;
-    	case 16384:
-    		util::pool_allocator<16384*sizeof(T), 64>::get().free(p);
-    		break;
-    	default:
-    		::operator delete(p);
-    	}
-    }
-    size_type max_size() const noexcept {
-        return std::numeric_limits<size_type>::max() / sizeof(T);    }
-
-    bool operator==(stl_pool_allocator const&) { return true; }
-    bool operator!=(stl_pool_allocator const& oAllocator) { return !operator==(oAllocator); }
+        switch(size_class(n)) {
+        case 1:
+            util::pool_allocator<sizeof(T), 4096>::get().free(p);
+            break;
+        case 16:
+            util::pool_allocator<16 * sizeof(T), 4096>::get().free(p);
+            break;
+        case 64:
+            util::pool_allocator<64 * sizeof(T), 1024>::get().free(p);
+            break;
+        case 256:
+            util::pool_allocator<256 * sizeof(T), 256>::get().free(p);
+            break;
+        case 1024:
+            util::pool_allocator<1024 * sizeof(T), 64>::get().free(p);
+            break;
+        case 4096:
+            util::pool_allocator<4096 * sizeof(T), 16>::get().free(p);
+            break;
+        case 16384:
+            util::pool_allocator<16384 * sizeof(T), 4>::get().free(p);
+            break;
+        default:
+            ::operator delete(p);
+        }
+    }
+
+    size_type max_size() const noexcept { return std::numeric_limits<size_type>::max() / sizeof(T); }
 
+    bool operator==(stl_pool_allocator const&) const { return true; }
+    bool operator!=(stl_pool_allocator const& oAllocator) const { return !operator==(oAllocator); }
+
+private:
+    //! get the number of elements of the size class of n elements, 0 if n exceeds the largest size class
+    static size_type size_class(size_type n) {
+        if(n <= 1)
+            return 1;
+        size_type value = 16;
+        while(value < n && value <= 16384)
+            value <<= 2;
+        return value <= 16384 ? value : 0;
+    }
 };
 
 
-template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> pool_allocator<ELEM_SIZE, CHUNK_SIZE>& pool_allocator<ELEM_SIZE, CHUNK_SIZE>::get() {
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE, unsigned FRONT_SIZE>
+pool_allocator<ELEM_SIZE, CHUNK_SIZE, FRONT_SIZE>& pool_allocator<ELEM_SIZE, CHUNK_SIZE, FRONT_SIZE>::get() {
     thread_local pool_allocator inst;
     return inst;
 }
 
-template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> pool_allocator<ELEM_SIZE, CHUNK_SIZE>::~pool_allocator() {
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE, unsigned FRONT_SIZE>
+pool_allocator<ELEM_SIZE, CHUNK_SIZE, FRONT_SIZE>::~pool_allocator() {
+    pool_registry::get().remove(this);
 #ifdef HAVE_GETENV
     if(debug_memory) {
         auto* check = getenv("TLM_MM_CHECK");
@@ -187,7 +533,13 @@ template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> pool_allocator<ELEM_SIZE, CHUNK
 #else
             if(check && strcasecmp(check, "DEBUG") == 0) {
 #endif
-                std::vector<std::pair<void*, uint64_t>> elems(used_blocks.begin(), used_blocks.end());
+                std::vector<std::pair<void*, uint64_t>> elems;
+                for(auto c : chunks)
+                    for(size_t i = 0; i < CHUNK_SIZE; ++i) {
+                        auto* p = c + i * stride + sizeof(block_header);
+                        if(header_of(p)->in_use)
+                            elems.emplace_back(p, header_of(p)->id);
+                    }
                 std::sort(elems.begin(), elems.end(),
                           [](std::pair<void*, uint64_t> const& a, std::pair<void*, uint64_t> const& b) -> bool {
                               return a.second == b.second ? a.first < b.first : a.second < b.second;
@@ -200,41 +552,195 @@ template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> pool_allocator<ELEM_SIZE, CHUNK
         }
     }
 #endif
-    for(auto p:chunks) delete p;
+    for(auto p : chunks)
+        chunk_mem.release(p, stride * CHUNK_SIZE);
 }
 
-template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> inline void* pool_allocator<ELEM_SIZE, CHUNK_SIZE>::allocate(uint64_t id) {
-    if(!free_list.size())
-        resize();
-    auto ret = free_list.back();
-    free_list.pop_back();
-    memset(ret, 0, ELEM_SIZE);
-    if(debug_memory)
-        used_blocks.insert({ret, id});
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE, unsigned FRONT_SIZE>
+inline void* pool_allocator<ELEM_SIZE, CHUNK_SIZE, FRONT_SIZE>::allocate(uint64_t id, bool clear) {
+    void* ret;
+    if(FRONT_SIZE && front_count) {
+        ret = front[--front_count];
+    } else {
+        if(!free_list)
+            resize();
+        ret = free_list;
+        free_list = free_list->next;
+        --free_count;
+    }
+    if(clear)
+        memset(ret, 0, ELEM_SIZE);
+    if(debug_memory) {
+        header_of(ret)->id = id;
+        header_of(ret)->in_use = 1;
+    }
+    ++allocations;
+    high_water = std::max(high_water, used_count());
     return ret;
 }
 
-template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> inline void pool_allocator<ELEM_SIZE, CHUNK_SIZE>::free(void* p) {
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE, unsigned FRONT_SIZE>
+inline void pool_allocator<ELEM_SIZE, CHUNK_SIZE, FRONT_SIZE>::free(void* p) {
     if(p) {
-        free_list.push_back(p);
+        if(debug_memory) {
+            if(!header_of(p)->in_use) {
+                std::cerr << __FUNCTION__ << ": detected double free of " << p << std::endl;
+                return;
+            }
+            header_of(p)->in_use = 0;
+        }
+        if(FRONT_SIZE && front_count < FRONT_SIZE) {
+            front[front_count++] = p;
+        } else {
+            auto* node = static_cast<free_node*>(p);
+            node->next = free_list;
+            free_list = node;
+            ++free_count;
+        }
+    }
+}
+
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE, unsigned FRONT_SIZE>
+inline void pool_allocator<ELEM_SIZE, CHUNK_SIZE, FRONT_SIZE>::resize() {
+    auto* chunk = chunk_mem.allocate(stride * CHUNK_SIZE);
+    chunks.push_back(chunk);
+    auto offset = debug_memory ? sizeof(block_header) : 0;
+    // link the elements in address order
+    for(size_t i = CHUNK_SIZE; i > 0; --i) {
+        auto* p = chunk + (i - 1) * stride + offset;
         if(debug_memory)
-            used_blocks.erase(p);
+            header_of(p)->in_use = 0;
+        auto* node = reinterpret_cast<free_node*>(p);
+        node->next = free_list;
+        free_list = node;
+    }
+    free_count += CHUNK_SIZE;
+}
+
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE, unsigned FRONT_SIZE>
+inline size_t pool_allocator<ELEM_SIZE, CHUNK_SIZE, FRONT_SIZE>::trim(size_t keep_free) {
+    while(front_count) {
+        auto* node = static_cast<free_node*>(front[--front_count]);
+        node->next = free_list;
+        free_list = node;
+        ++free_count;
+    }
+    if(free_count < CHUNK_SIZE)
+        return 0;
+    auto released =
+        detail::release_free_chunks(chunks, free_list, CHUNK_SIZE, keep_free, chunk_mem, stride * CHUNK_SIZE);
+    free_count -= released * CHUNK_SIZE;
+    return released;
+}
+
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE, unsigned FRONT_SIZE>
+inline size_t pool_allocator<ELEM_SIZE, CHUNK_SIZE, FRONT_SIZE>::get_capacity() {
+    return chunks.size() * CHUNK_SIZE;
+}
+
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE, unsigned FRONT_SIZE>
+inline size_t pool_allocator<ELEM_SIZE, CHUNK_SIZE, FRONT_SIZE>::get_free_entries_count() {
+    return free_count + front_count;
+}
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE>
+mt_pool_allocator<ELEM_SIZE, CHUNK_SIZE>& mt_pool_allocator<ELEM_SIZE, CHUNK_SIZE>::get() {
+    thread_local owner inst;
+    return *inst.pool;
+}
+
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE>
+inline void* mt_pool_allocator<ELEM_SIZE, CHUNK_SIZE>::allocate(uint64_t, bool clear) {
+    if(!free_list) {
+        // collect the elements returned by other threads
+        free_list = remote_list.exchange(nullptr, std::memory_order_acquire);
+        if(free_list) {
+            size_t cnt = 0;
+            for(auto* n = free_list; n; n = n->next)
+                ++cnt;
+            remote_count.fetch_sub(static_cast<ptrdiff_t>(cnt), std::memory_order_relaxed);
+            set_free_count(free_count.load(std::memory_order_relaxed) + cnt);
+        } else
+            resize();
+    }
+    void* ret = free_list;
+    free_list = free_list->next;
+    auto free = free_count.load(std::memory_order_relaxed) - 1;
+    set_free_count(free);
+    if(clear)
+        memset(ret, 0, ELEM_SIZE);
+    allocations.store(allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    auto used = chunks.size() * CHUNK_SIZE - free;
+    if(used > high_water.load(std::memory_order_relaxed))
+        high_water.store(used, std::memory_order_relaxed);
+    return ret;
+}
+
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> inline void mt_pool_allocator<ELEM_SIZE, CHUNK_SIZE>::free(void* p) {
+    if(!p)
+        return;
+    auto* pool = owner_of(p);
+    auto* node = static_cast<free_node*>(p);
+    if(pool == this) {
+        node->next = free_list;
+        free_list = node;
+        set_free_count(free_count.load(std::memory_order_relaxed) + 1);
+    } else {
+        node->next = pool->remote_list.load(std::memory_order_relaxed);
+        while(!pool->remote_list.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                       std::memory_order_relaxed))
+            ;
+        // the last element returned to an abandoned pool destroys it
+        if(pool->remote_count.fetch_add(1, std::memory_order_acq_rel) == -1)
+            delete pool;
     }
 }
 
-template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> inline void pool_allocator<ELEM_SIZE, CHUNK_SIZE>::resize() {
-    auto* chunk = new std::array<chunk_type, CHUNK_SIZE>();
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> inline void mt_pool_allocator<ELEM_SIZE, CHUNK_SIZE>::resize() {
+    auto* chunk = chunk_mem.allocate(elem_stride * CHUNK_SIZE);
     chunks.push_back(chunk);
-    for(auto& p : *chunk)
-        free_list.push_back(&p[0]);
+    for(size_t i = CHUNK_SIZE; i > 0; --i) {
+        auto* p = chunk + (i - 1) * elem_stride + header_size;
+        owner_of(p) = this;
+        auto* node = reinterpret_cast<free_node*>(p);
+        node->next = free_list;
+        free_list = node;
+    }
+    set_free_count(free_count.load(std::memory_order_relaxed) + CHUNK_SIZE);
+    chunk_count.store(chunks.size(), std::memory_order_relaxed);
+}
+
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE>
+inline size_t mt_pool_allocator<ELEM_SIZE, CHUNK_SIZE>::trim(size_t keep_free) {
+    // collect the elements returned by other threads
+    auto* remote = remote_list.exchange(nullptr, std::memory_order_acquire);
+    size_t cnt = 0;
+    while(remote) {
+        auto* n = remote;
+        remote = remote->next;
+        n->next = free_list;
+        free_list = n;
+        ++cnt;
+    }
+    remote_count.fetch_sub(static_cast<ptrdiff_t>(cnt), std::memory_order_relaxed);
+    auto free = free_count.load(std::memory_order_relaxed) + cnt;
+    size_t released = 0;
+    if(free >= CHUNK_SIZE) {
+        released =
+            detail::release_free_chunks(chunks, free_list, CHUNK_SIZE, keep_free, chunk_mem, elem_stride * CHUNK_SIZE);
+        free -= released * CHUNK_SIZE;
+        chunk_count.store(chunks.size(), std::memory_order_relaxed);
+    }
+    set_free_count(free);
+    return released;
 }
 
-template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> inline size_t pool_allocator<ELEM_SIZE, CHUNK_SIZE>::get_capacity() {
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> inline size_t mt_pool_allocator<ELEM_SIZE, CHUNK_SIZE>::get_capacity() {
     return chunks.size() * CHUNK_SIZE;
 }
 
-template <size_t ELEM_SIZE, unsigned CHUNK_SIZE> inline size_t pool_allocator<ELEM_SIZE, CHUNK_SIZE>::get_free_entries_count() {
-    return free_list.size();
+template <size_t ELEM_SIZE, unsigned CHUNK_SIZE>
+inline size_t mt_pool_allocator<ELEM_SIZE, CHUNK_SIZE>::get_free_entries_count() {
+    return free_count.load(std::memory_order_relaxed) + remote_returned();
 }
 } // namespace util
 /** @} */
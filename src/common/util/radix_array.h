@@ -0,0 +1,189 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _RADIX_ARRAY_H_
+#define _RADIX_ARRAY_H_
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+namespace detail {
+//! number of bits needed to represent values in the range [0, val)
+constexpr unsigned addr_bits(uint64_t val, unsigned bits = 0) {
+    return (bits < 64 && (1ULL << bits) < val) ? addr_bits(val, bits + 1) : bits;
+}
+} // namespace detail
+/**
+ *  @brief a sparse array using a multi-level page table
+ *
+ *  the array has the same interface as \ref util::sparse_array but resolves the page using a radix tree of up to
+ *  3 levels. This allows small pages (4kB-64kB) without the need of a huge page pointer table. Tables and pages are
+ *  allocated on demand. The last accessed page is cached so that consecutive accesses to the same page bypass the
+ *  table walk.
+ *
+ *  @tparam T the element type
+ *  @tparam SIZE the number of elements
+ *  @tparam PAGE_ADDR_BITS the number of address bits covered by a (leaf) page
+ */
+template <typename T, uint64_t SIZE, unsigned PAGE_ADDR_BITS = 16> class radix_array {
+public:
+    static_assert(SIZE > 0, "radix_array size must be greater than 0");
+
+    static constexpr uint64_t page_addr_mask = (1ULL << PAGE_ADDR_BITS) - 1;
+
+    static constexpr uint64_t page_size = (1ULL << PAGE_ADDR_BITS);
+
+    static constexpr uint64_t page_count = SIZE / page_size + (SIZE % page_size ? 1 : 0);
+
+    static constexpr uint64_t page_addr_width = PAGE_ADDR_BITS;
+    //! the pages are allocated individually and are not contiguous in memory
+    static constexpr bool is_contiguous = false;
+    //! the number of bits of the page number
+    static constexpr unsigned index_bits = detail::addr_bits(page_count) ? detail::addr_bits(page_count) : 1;
+    //! the number of table levels
+    static constexpr unsigned levels = index_bits <= 12 ? 1 : index_bits <= 24 ? 2 : 3;
+    //! the number of page number bits resolved by each of the lower levels
+    static constexpr unsigned level_bits = (index_bits + levels - 1) / levels;
+    //! the number of page number bits resolved by the root level
+    static constexpr unsigned root_bits = index_bits - (levels - 1) * level_bits;
+
+    using page_type = std::array<T, 1ULL << PAGE_ADDR_BITS>;
+    /**
+     * the default constructor
+     */
+    radix_array() = default;
+
+    radix_array(const radix_array&) = delete;
+
+    radix_array& operator=(const radix_array&) = delete;
+    /**
+     * the destructor
+     */
+    ~radix_array() { release(root.data(), root.size(), levels - 1); }
+    /**
+     * element access operator
+     *
+     * @param addr address to access
+     * @return the data type reference
+     */
+    T& operator[](uint64_t addr) {
+        assert(addr < SIZE);
+        return (*get_page(addr >> PAGE_ADDR_BITS))[addr & page_addr_mask];
+    }
+    /**
+     * page fetch operator
+     *
+     * @param page_nr the page number ot fetch
+     * @return reference to page
+     */
+    page_type& operator()(uint64_t page_nr) {
+        assert(page_nr < page_count);
+        return *get_page(page_nr);
+    }
+    /**
+     * page fetch operator for read-only accesses, the page needs to be allocated
+     *
+     * @param page_nr the page number ot fetch
+     * @return reference to page
+     */
+    const page_type& operator()(uint64_t page_nr) const {
+        assert(page_nr < page_count);
+        auto* p = find_page(page_nr);
+        assert(p != nullptr);
+        return *p;
+    }
+    /**
+     * check if page for address is allocated
+     *
+     * @param addr the address to check
+     * @return true if the page is allocated
+     */
+    bool is_allocated(uint64_t addr) const {
+        assert(addr < SIZE);
+        return find_page(addr >> PAGE_ADDR_BITS) != nullptr;
+    }
+    /**
+     * get the size of the array
+     *
+     * @return the size
+     */
+    uint64_t size() const { return SIZE; }
+
+protected:
+    //! walk the table and allocate missing tables and the page itself
+    page_type* get_page(uint64_t page_nr) {
+        if(page_nr == last_page_nr)
+            return last_page;
+        void** tbl = root.data();
+        auto idx = page_nr >> ((levels - 1) * level_bits);
+        for(unsigned l = levels - 1; l > 0; --l) {
+            if(!tbl[idx])
+                tbl[idx] = new void* [1ULL << level_bits]();
+            tbl = static_cast<void**>(tbl[idx]);
+            idx = (page_nr >> ((l - 1) * level_bits)) & ((1ULL << level_bits) - 1);
+        }
+        if(!tbl[idx])
+            tbl[idx] = new page_type();
+        last_page_nr = page_nr;
+        last_page = static_cast<page_type*>(tbl[idx]);
+        return last_page;
+    }
+    //! walk the table without allocation, returns nullptr if the page does not exist
+    page_type* find_page(uint64_t page_nr) const {
+        if(page_nr == last_page_nr)
+            return last_page;
+        void* const* tbl = root.data();
+        auto idx = page_nr >> ((levels - 1) * level_bits);
+        for(unsigned l = levels - 1; l > 0; --l) {
+            if(!tbl[idx])
+                return nullptr;
+            tbl = static_cast<void* const*>(tbl[idx]);
+            idx = (page_nr >> ((l - 1) * level_bits)) & ((1ULL << level_bits) - 1);
+        }
+        if(!tbl[idx])
+            return nullptr;
+        last_page_nr = page_nr;
+        last_page = static_cast<page_type*>(tbl[idx]);
+        return last_page;
+    }
+
+    static void release(void** tbl, uint64_t entries, unsigned level) {
+        for(uint64_t i = 0; i < entries; ++i) {
+            if(!tbl[i])
+                continue;
+            if(level) {
+                release(static_cast<void**>(tbl[i]), 1ULL << level_bits, level - 1);
+                delete[] static_cast<void**>(tbl[i]);
+            } else
+                delete static_cast<page_type*>(tbl[i]);
+        }
+    }
+
+    std::array<void*, 1ULL << root_bits> root{};
+    mutable uint64_t last_page_nr{std::numeric_limits<uint64_t>::max()};
+    mutable page_type* last_page{nullptr};
+};
+} // namespace util
+/** @}*/
+#endif /* _RADIX_ARRAY_H_ */
@@ -17,13 +17,17 @@
 #ifndef _RANGE_LUT_H_
 #define _RANGE_LUT_H_
 
+#include <atomic>
 #include <exception>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <map>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 /**
  * \ingroup scc-common
@@ -33,6 +37,11 @@
 namespace util {
 /**
  * @brief range based lookup table
+ *
+ * The entries are kept in a std::map. For the lookup a flat representation (sorted arrays of range start and end
+ * addresses) is used which is searched using a branchless binary search. Modifications only mark this representation
+ * as outdated, it is rebuilt once by the next lookup (or by freeze()) so that filling a table stays O(n log n).
+ * Concurrent lookups are safe, the rebuild is guarded by a mutex. Overlapping ranges are rejected upon insertion.
  */
 template <typename T> class range_lut {
 public:
@@ -53,7 +62,8 @@ public:
     : null_entry(null_entry) {}
     /**
      * add an T to the lut covering the range starting at base_addr until
-     * base_addr+size-1
+     * base_addr+size-1. If the range overlaps a mapped range a std::runtime_error is thrown and the lookup table stays
+     * unchanged.
      *
      * @param i the entry
      * @param base_addr the base address
@@ -61,12 +71,24 @@ public:
      */
     void addEntry(T i, uint64_t base_addr, uint64_t size);
     /**
-     * remove an entry with value i of type T
+     * remove an entry with value i of type T. If the entry covers several ranges the one with the lowest base
+     * address is removed.
      *
      * @param i the entry to be found
      * @return true if the entry is found and removed, false otherwise
      */
     bool removeEntry(T i);
+    /**
+     * replace the range of an entry with value i of type T by the range starting at new_base until
+     * new_base+new_size-1. If the new range overlaps another entry a std::runtime_error is thrown and the lookup
+     * table stays unchanged.
+     *
+     * @param i the entry to be found
+     * @param new_base the new base address
+     * @param new_size the new size of the occupied range
+     * @return true if the entry is found and remapped, false otherwise
+     */
+    bool remap(T i, uint64_t new_base, uint64_t new_size);
     /**
      * get number of entries in the lookup table
      *
@@ -78,7 +100,20 @@ public:
      */
     void clear() {
         m_lut.clear();
+        m_index.clear();
         m_size = 0;
+        m_dirty = true;
+    }
+    /**
+     * build the flat lookup representation if the table has been modified since the last lookup. Calling it is
+     * optional, it moves the cost of the rebuild out of the first lookup.
+     */
+    void freeze() const {
+        std::lock_guard<std::mutex> lock(m_index_mtx);
+        if(m_dirty.load(std::memory_order_relaxed)) {
+            build_index();
+            m_dirty.store(false, std::memory_order_release);
+        }
     }
     /**
      * get the entry T associated with a given address
@@ -87,9 +122,20 @@ public:
      * @return the entry belonging to the address
      */
     inline T getEntry(uint64_t addr) const {
-        auto iter = m_lut.lower_bound(addr);
-        return (iter != m_lut.end() && (iter->second.type == END_RANGE || iter->first == addr)) ? iter->second.index
-                                                                                                : null_entry;
+        if(m_dirty.load(std::memory_order_acquire))
+            freeze();
+        auto n = m_starts.size();
+        if(!n)
+            return null_entry;
+        // branchless search for the last range starting at or below addr
+        const uint64_t* base = m_starts.data();
+        while(n > 1) {
+            auto half = n / 2;
+            base = (base[half] <= addr) ? base + half : base;
+            n -= half;
+        }
+        auto pos = base - m_starts.data();
+        return (*base <= addr && addr <= m_ends[pos]) ? m_entries[pos] : null_entry;
     }
     /**
      * validate the lookup table wrt. overlaps
@@ -112,9 +158,25 @@ public:
     const_iterator end() const { return m_lut.end(); }
 
 protected:
-    // Loki::AssocVector<uint64_t, lut_entry> m_lut;
+    //! build the flat lookup representation
+    void build_index() const;
+    //! find the entry of value i with the lowest base address in the reverse index
+    typename std::multimap<T, uint64_t>::iterator find_entry(T i);
+    //! erase the range starting at base_addr
+    void erase_range(uint64_t base_addr);
+    //! check if the range from base_addr to end_addr overlaps any entry
+    bool overlaps(uint64_t base_addr, uint64_t end_addr) const;
     std::map<uint64_t, lut_entry> m_lut{};
+    //! the base addresses of the ranges of each entry
+    std::multimap<T, uint64_t> m_index{};
     size_t m_size{0};
+    // the flat lookup representation, m_starts, m_ends and m_entries always have the same size
+    mutable std::vector<uint64_t> m_starts{};
+    mutable std::vector<uint64_t> m_ends{};
+    mutable std::vector<T> m_entries{};
+    //! set if the flat lookup representation is outdated
+    mutable std::atomic<bool> m_dirty{false};
+    mutable std::mutex m_index_mtx{};
 };
 
 /**
@@ -130,37 +192,110 @@ template <typename T> std::ostream& operator<<(std::ostream& os, range_lut<T>& l
 }
 
 template <typename T> inline void range_lut<T>::addEntry(T i, uint64_t base_addr, uint64_t size) {
-    auto iter = m_lut.find(base_addr);
-    if(iter != m_lut.end() && iter->second.index != null_entry)
-        throw std::runtime_error("range already mapped");
-
     auto eaddr = base_addr + size - 1;
     if(eaddr < base_addr)
         throw std::runtime_error("address wrap-around occurred");
+    if(overlaps(base_addr, eaddr))
+        throw std::runtime_error("range overlap: added range overlaps a mapped range");
 
     m_lut[base_addr] = lut_entry{i, size > 1 ? BEGIN_RANGE : SINGLE_BYTE_RANGE};
     if(size > 1)
         m_lut[eaddr] = lut_entry{i, END_RANGE};
+    m_index.insert(std::make_pair(i, base_addr));
     ++m_size;
+    m_dirty = true;
+}
+
+template <typename T> inline typename std::multimap<T, uint64_t>::iterator range_lut<T>::find_entry(T i) {
+    auto range = m_index.equal_range(i);
+    auto res = range.first;
+    for(auto it = range.first; it != range.second; ++it)
+        if(it->second < res->second)
+            res = it;
+    return res == range.second ? m_index.end() : res;
+}
+
+template <typename T> inline void range_lut<T>::erase_range(uint64_t base_addr) {
+    auto start = m_lut.find(base_addr);
+    if(start->second.type == SINGLE_BYTE_RANGE) {
+        m_lut.erase(start);
+    } else {
+        auto end = start;
+        end++;
+        end++;
+        m_lut.erase(start, end);
+    }
+}
+
+template <typename T> inline bool range_lut<T>::overlaps(uint64_t base_addr, uint64_t end_addr) const {
+    auto iter = m_lut.lower_bound(base_addr);
+    if(iter != m_lut.end() && iter->first <= end_addr && iter->second.index != null_entry)
+        return true;
+    // no boundary within the range, check if it lies inside a mapped range
+    return iter != m_lut.begin() && (--iter)->second.type == BEGIN_RANGE && iter->second.index != null_entry;
 }
 
 template <typename T> inline bool range_lut<T>::removeEntry(T i) {
-    auto start = m_lut.begin();
-    while(start->second.index != i && start != m_lut.end())
-        start++;
-    if(start != m_lut.end()) {
-        if(start->second.type == SINGLE_BYTE_RANGE) {
-            m_lut.erase(start);
-        } else {
-            auto end = start;
-            end++;
-            end++;
-            m_lut.erase(start, end);
+    auto it = find_entry(i);
+    if(it == m_index.end())
+        return false;
+    erase_range(it->second);
+    m_index.erase(it);
+    --m_size;
+    m_dirty = true;
+    return true;
+}
+
+template <typename T> inline bool range_lut<T>::remap(T i, uint64_t new_base, uint64_t new_size) {
+    auto it = find_entry(i);
+    if(it == m_index.end())
+        return false;
+    auto eaddr = new_base + new_size - 1;
+    if(eaddr < new_base)
+        throw std::runtime_error("address wrap-around occurred");
+    auto old_base = it->second;
+    auto old_type = m_lut[old_base].type;
+    uint64_t old_end = old_base;
+    if(old_type == BEGIN_RANGE)
+        old_end = std::next(m_lut.find(old_base))->first;
+    erase_range(old_base);
+    if(overlaps(new_base, eaddr)) {
+        // restore the previous mapping
+        m_lut[old_base] = lut_entry{i, old_type};
+        if(old_type == BEGIN_RANGE)
+            m_lut[old_end] = lut_entry{i, END_RANGE};
+        throw std::runtime_error("range overlap: remapped range overlaps a mapped range");
+    }
+    m_lut[new_base] = lut_entry{i, new_size > 1 ? BEGIN_RANGE : SINGLE_BYTE_RANGE};
+    if(new_size > 1)
+        m_lut[eaddr] = lut_entry{i, END_RANGE};
+    it->second = new_base;
+    m_dirty = true;
+    return true;
+}
+
+template <typename T> inline void range_lut<T>::build_index() const {
+    m_starts.clear();
+    m_ends.clear();
+    m_entries.clear();
+    for(auto iter = m_lut.begin(); iter != m_lut.end(); ++iter) {
+        if(iter->second.index == null_entry)
+            continue;
+        switch(iter->second.type) {
+        case SINGLE_BYTE_RANGE:
+            m_starts.push_back(iter->first);
+            m_ends.push_back(iter->first);
+            m_entries.push_back(iter->second.index);
+            break;
+        case BEGIN_RANGE:
+            m_starts.push_back(iter->first);
+            m_entries.push_back(iter->second.index);
+            break;
+        case END_RANGE:
+            m_ends.push_back(iter->first);
+            break;
         }
-        --m_size;
-        return true;
     }
-    return false;
 }
 
 template <typename T> inline void range_lut<T>::validate() const {
@@ -202,7 +337,14 @@ template <typename T> inline std::string range_lut<T>::toString() const {
             break;
         case END_RANGE:
             buf << " to 0x" << std::setw(sizeof(uint64_t) * 2) << std::setfill('0') << std::uppercase << std::hex
-                << iter->first << std::dec << " as " << iter->second->index << std::endl;
+                << iter->first << std::dec << " as " << iter->second.index << std::endl;
+            break;
+        case SINGLE_BYTE_RANGE:
+            if(iter->second.index != null_entry) {
+                buf << "  at   0x" << std::setw(sizeof(uint64_t) * 2) << std::setfill('0') << std::uppercase
+                    << std::hex << iter->first << std::dec << " as " << iter->second.index << std::endl;
+            }
+            break;
         }
     }
     return buf.str();
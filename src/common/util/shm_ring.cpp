@@ -0,0 +1,178 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#include <util/shm_ring.h>
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace util;
+
+namespace {
+char const magic[8] = {'S', 'C', 'C', 'R', 'I', 'N', 'G', 0};
+const uint32_t version = 1;
+//! the data starts at a cache line boundary
+const size_t header_size = 64;
+static_assert(sizeof(shm_ring_header) <= header_size, "shm_ring_header too large");
+
+inline size_t padded(size_t size) { return (size + 7) & ~size_t(7); }
+} // namespace
+
+shm_ring_writer::shm_ring_writer(std::string const& name, size_t capacity)
+: name(name) {
+#ifndef _MSC_VER
+    capacity = padded(capacity);
+    length = header_size + capacity;
+    ::shm_unlink(name.c_str());
+    auto fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if(fd < 0)
+        throw std::runtime_error("could not create shared memory " + name);
+    if(::ftruncate(fd, length) < 0) {
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        throw std::runtime_error("could not size shared memory " + name);
+    }
+    auto* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(p == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        throw std::runtime_error("could not map shared memory " + name);
+    }
+    hdr = new(p) shm_ring_header();
+    std::memcpy(hdr->magic, magic, sizeof(magic));
+    hdr->version = version;
+    hdr->capacity = capacity;
+    hdr->write_pos.store(0, std::memory_order_relaxed);
+    hdr->readers.store(0, std::memory_order_relaxed);
+    hdr->attach_count.store(0, std::memory_order_release);
+    buffer = static_cast<char*>(p) + header_size;
+#else
+    throw std::runtime_error("shared memory ring buffers are not supported on this platform");
+#endif
+}
+
+shm_ring_writer::~shm_ring_writer() {
+#ifndef _MSC_VER
+    if(hdr) {
+        ::munmap(hdr, length);
+        ::shm_unlink(name.c_str());
+    }
+#endif
+}
+
+bool shm_ring_writer::write(char const* data, size_t size) {
+    auto capacity = hdr->capacity;
+    auto rec_size = padded(sizeof(uint32_t) + size);
+    // limiting the record size bounds the area being written while the position is not published yet
+    if(rec_size > capacity / 4)
+        return false;
+    auto pos = hdr->write_pos.load(std::memory_order_relaxed);
+    auto offs = pos % capacity;
+    if(offs + rec_size > capacity) {
+        std::memcpy(buffer + offs, &shm_ring_header::wrap_marker, sizeof(uint32_t));
+        pos += capacity - offs;
+        offs = 0;
+    }
+    auto len = static_cast<uint32_t>(size);
+    std::memcpy(buffer + offs, &len, sizeof(uint32_t));
+    std::memcpy(buffer + offs + sizeof(uint32_t), data, size);
+    hdr->write_pos.store(pos + rec_size, std::memory_order_release);
+    return true;
+}
+
+shm_ring_reader::shm_ring_reader(std::string const& name) {
+#ifndef _MSC_VER
+    auto fd = ::shm_open(name.c_str(), O_RDWR, 0);
+    if(fd < 0)
+        throw std::runtime_error("could not open shared memory " + name);
+    struct stat st;
+    if(::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < header_size) {
+        ::close(fd);
+        throw std::runtime_error(name + " is not a ring buffer");
+    }
+    length = st.st_size;
+    auto* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(p == MAP_FAILED)
+        throw std::runtime_error("could not map shared memory " + name);
+    hdr = static_cast<shm_ring_header*>(p);
+    if(std::memcmp(hdr->magic, magic, sizeof(magic)) || hdr->version != version ||
+       hdr->capacity + header_size > length) {
+        ::munmap(p, length);
+        hdr = nullptr;
+        throw std::runtime_error(name + " is not a ring buffer");
+    }
+    buffer = static_cast<char const*>(p) + header_size;
+    hdr->readers.fetch_add(1, std::memory_order_relaxed);
+    read_pos = hdr->write_pos.load(std::memory_order_acquire);
+    hdr->attach_count.fetch_add(1, std::memory_order_release);
+#else
+    throw std::runtime_error("shared memory ring buffers are not supported on this platform");
+#endif
+}
+
+shm_ring_reader::~shm_ring_reader() {
+#ifndef _MSC_VER
+    if(hdr) {
+        hdr->readers.fetch_sub(1, std::memory_order_relaxed);
+        ::munmap(hdr, length);
+    }
+#endif
+}
+
+bool shm_ring_reader::read(std::string& record) {
+    auto capacity = hdr->capacity;
+    while(true) {
+        auto write_pos = hdr->write_pos.load(std::memory_order_acquire);
+        if(read_pos == write_pos)
+            return false;
+        if(write_pos - read_pos > capacity) {
+            // the writer overwrote the records not read yet
+            ++overruns;
+            read_pos = write_pos;
+            return false;
+        }
+        auto offs = read_pos % capacity;
+        uint32_t len;
+        std::memcpy(&len, buffer + offs, sizeof(uint32_t));
+        if(len == shm_ring_header::wrap_marker) {
+            read_pos += capacity - offs;
+            continue;
+        }
+        auto rec_size = padded(sizeof(uint32_t) + len);
+        auto torn = offs + rec_size > capacity;
+        if(!torn)
+            record.assign(buffer + offs + sizeof(uint32_t), len);
+        // the writer may be busy with up to half of the capacity beyond the published position, make sure this did
+        // not reach the record while copying
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto new_write_pos = hdr->write_pos.load(std::memory_order_relaxed);
+        if(torn || new_write_pos + capacity / 2 > read_pos + capacity) {
+            ++overruns;
+            read_pos = new_write_pos;
+            return false;
+        }
+        read_pos += rec_size;
+        return true;
+    }
+}
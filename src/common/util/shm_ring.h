@@ -0,0 +1,145 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief the header of a record ring buffer in shared memory
+ *
+ * The header is followed by capacity bytes of data. A record is a uint32_t length followed by the record bytes,
+ * padded to a multiple of 8 bytes. A length of wrap_marker tells the reader to continue at the start of the data.
+ * Positions are counted in bytes since the creation of the ring, the offset into the data is position % capacity.
+ */
+struct shm_ring_header {
+    static const uint32_t wrap_marker = 0xffffffff;
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t capacity;
+    //! the position behind the last complete record
+    std::atomic<uint64_t> write_pos;
+    //! the number of attached readers
+    std::atomic<uint32_t> readers;
+    //! incremented each time a reader attaches
+    std::atomic<uint32_t> attach_count;
+};
+/**
+ * @brief the single producer of a lossy record ring buffer in shared memory
+ *
+ * The writer never waits for readers: records of slow readers are overwritten and readers detect this. has_readers()
+ * allows to skip producing the records if nobody listens.
+ */
+class shm_ring_writer {
+public:
+    /**
+     * create the shared memory, throws std::runtime_error if this fails
+     *
+     * @param name the name of the shared memory object, e.g. "/my_sim"
+     * @param capacity the size of the data area, rounded up to a multiple of 8 bytes
+     */
+    shm_ring_writer(std::string const& name, size_t capacity);
+    //! removes the shared memory object, attached readers keep their mapping
+    ~shm_ring_writer();
+
+    shm_ring_writer(const shm_ring_writer&) = delete;
+
+    shm_ring_writer& operator=(const shm_ring_writer&) = delete;
+    //! check if a reader is attached
+    bool has_readers() const { return hdr->readers.load(std::memory_order_relaxed) != 0; }
+    /**
+     * check if a reader attached since the last call
+     *
+     * @return true if a reader attached, e.g. to publish the records needed to interpret the following ones
+     */
+    bool reader_attached() {
+        auto count = hdr->attach_count.load(std::memory_order_acquire);
+        if(count == last_attach_count)
+            return false;
+        last_attach_count = count;
+        return true;
+    }
+    /**
+     * append a record
+     *
+     * @param data the record
+     * @param size its size
+     * @return false if the record is larger than a quarter of the capacity and has been dropped
+     */
+    bool write(char const* data, size_t size);
+
+private:
+    std::string name;
+    shm_ring_header* hdr{nullptr};
+    char* buffer{nullptr};
+    size_t length{0};
+    uint32_t last_attach_count{0};
+};
+/**
+ * @brief a reader of a record ring buffer in shared memory
+ *
+ * The reader starts with the records written after it attached:
+ * \code
+ * util::shm_ring_reader reader("/my_sim");
+ * std::string rec;
+ * while(running)
+ *     if(reader.read(rec))
+ *         process(rec);
+ * \endcode
+ */
+class shm_ring_reader {
+public:
+    /**
+     * attach to an existing ring, throws std::runtime_error if it does not exist
+     *
+     * @param name the name of the shared memory object
+     */
+    explicit shm_ring_reader(std::string const& name);
+
+    ~shm_ring_reader();
+
+    shm_ring_reader(const shm_ring_reader&) = delete;
+
+    shm_ring_reader& operator=(const shm_ring_reader&) = delete;
+    /**
+     * read the next record
+     *
+     * @param record the record read
+     * @return false if there is no new record
+     */
+    bool read(std::string& record);
+    //! the number of times the writer overwrote records before they were read
+    uint64_t get_overruns() const { return overruns; }
+
+private:
+    shm_ring_header* hdr{nullptr};
+    char const* buffer{nullptr};
+    size_t length{0};
+    uint64_t read_pos{0};
+    uint64_t overruns{0};
+};
+} // namespace util
+/**@}*/
@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_SNOOP_FILTER_H_
+#define _UTIL_SNOOP_FILTER_H_
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <util/open_addressing_map.h>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+/**
+ * @brief a directory of the cache lines held by the coherent masters of an interconnect
+ *
+ * For each cache line held by at least one master the set of masters which may hold it (the sharers) is kept as
+ * bit mask in an util::open_addressing_map, lines not held by any master do not occupy an entry. An interconnect
+ * only needs to snoop the masters returned by snoop_targets() instead of broadcasting each coherent access.
+ *
+ * The filter is conservative: a master may have silently dropped a clean line, snooping it is harmless. For an ACE
+ * interconnect the directory is updated as follows:
+ * - ReadShared, ReadClean, ReadNotSharedDirty, ReadOnce: add_sharer() of the requester if it allocates the line
+ * - ReadUnique, CleanUnique, MakeUnique: set_unique() of the requester after the snoops completed
+ * - WriteBack, WriteClean, WriteEvict, Evict: remove_sharer() of the requester if the line is not kept
+ * - WriteUnique, WriteLineUnique, CleanInvalid, MakeInvalid: invalidate() after the snoops completed
+ *
+ * @tparam MASK the unsigned type of the sharer mask, it limits the number of masters to the number of its bits
+ */
+template <typename MASK = uint64_t> class snoop_filter {
+    static_assert(std::is_unsigned<MASK>::value, "MASK needs to be an unsigned integral type");
+
+public:
+    //! the maximum number of masters
+    static constexpr unsigned max_masters = std::numeric_limits<MASK>::digits;
+    /**
+     * @brief constructs an empty filter
+     *
+     * @param line_size the size of a cache line in bytes, needs to be a power of 2
+     * @param capacity the initial number of lines of the table, it grows as needed
+     */
+    explicit snoop_filter(unsigned line_size = 64, size_t capacity = 1024)
+    : lines(capacity) {
+        assert(line_size && (line_size & (line_size - 1)) == 0);
+        while((1U << line_bits) < line_size)
+            ++line_bits;
+    }
+    /**
+     * @brief get the masters which may hold the line of an address
+     *
+     * @param addr the address
+     * @return the bit mask of the masters
+     */
+    MASK sharers(uint64_t addr) const {
+        auto* e = lines.find(key(addr));
+        return e ? *e : 0;
+    }
+    /**
+     * @brief get the masters to snoop for an access
+     *
+     * @param addr the address of the access
+     * @param requester the index of the requesting master
+     * @return the bit mask of the masters besides the requester which may hold the line
+     */
+    MASK snoop_targets(uint64_t addr, unsigned requester) {
+        MASK res = sharers(addr) & ~bit(requester);
+        ++lookups;
+        if(!res)
+            ++filtered;
+        return res;
+    }
+    //! record that a master holds a copy of the line of an address
+    void add_sharer(uint64_t addr, unsigned master) { lines[key(addr)] |= bit(master); }
+    //! record that a master holds the only copy of the line of an address
+    void set_unique(uint64_t addr, unsigned master) { lines[key(addr)] = bit(master); }
+    //! record that a master does not hold the line of an address anymore
+    void remove_sharer(uint64_t addr, unsigned master) {
+        auto k = key(addr);
+        if(auto* e = lines.find(k)) {
+            *e &= ~bit(master);
+            if(!*e)
+                lines.erase(k);
+        }
+    }
+    //! record that no master holds the line of an address anymore
+    void invalidate(uint64_t addr) { lines.erase(key(addr)); }
+    //! remove all entries
+    void clear() { lines.clear(); }
+    //! the number of lines held by at least one master
+    size_t size() const { return lines.size(); }
+    //! the number of calls of snoop_targets()
+    uint64_t get_lookups() const { return lookups; }
+    //! the number of calls of snoop_targets() which did not need to snoop any master
+    uint64_t get_filtered() const { return filtered; }
+
+private:
+    // the line number is offset by 1 as the key 0 marks empty slots of the map
+    uint64_t key(uint64_t addr) const { return (addr >> line_bits) + 1; }
+
+    static MASK bit(unsigned master) {
+        assert(master < max_masters);
+        return MASK(1) << master;
+    }
+
+    open_addressing_map<uint64_t, MASK> lines;
+    unsigned line_bits{0};
+    uint64_t lookups{0};
+    uint64_t filtered{0};
+};
+} // namespace util
+/**@}*/
+#endif /* _UTIL_SNOOP_FILTER_H_ */
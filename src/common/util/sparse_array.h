@@ -17,8 +17,15 @@
 #ifndef _SPARSE_ARRAY_H_
 #define _SPARSE_ARRAY_H_
 
+#include "chunk_memory.h"
 #include <array>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 /**
  * \ingroup scc-common
@@ -31,44 +38,61 @@ namespace util {
  *  @brief a sparse array suitable for large sizes
  *
  *  a simple array which allocates memory in configurable chunks (size of 2^PAGE_ADDR_BITS), used for
- *  large sparse arrays. Memory is allocated on demand
+ *  large sparse arrays. Memory is allocated on demand according to the \ref util::memory_policy, so pages may be
+ *  backed by huge pages and bound to the NUMA node of the allocating thread.
+ *
+ *  The content can be saved in a snapshot. Taking a snapshot or restoring it does not copy the data, the pages are
+ *  shared between the array and the snapshot and copied upon the next non-const page access (copy-on-write).
  */
 template <typename T, uint64_t SIZE, unsigned PAGE_ADDR_BITS = 24> class sparse_array {
 public:
     static_assert(SIZE>0, "sparse_array size must be greater than 0");
 
-    const uint64_t page_addr_mask = (1 << PAGE_ADDR_BITS) - 1;
+    static constexpr uint64_t page_addr_mask = (1ULL << PAGE_ADDR_BITS) - 1;
+
+    static constexpr uint64_t page_size = (1ULL << PAGE_ADDR_BITS);
 
-    const uint64_t page_size = (1 << PAGE_ADDR_BITS);
+    static constexpr uint64_t page_count = (SIZE + page_size - 1) / page_size;
 
-    const unsigned page_count = (SIZE + page_size - 1) / page_size;
+    static constexpr uint64_t page_addr_width = PAGE_ADDR_BITS;
+    //! the pages are allocated individually and are not contiguous in memory
+    static constexpr bool is_contiguous = false;
 
-    const uint64_t page_addr_width = PAGE_ADDR_BITS;
+    using page_type = std::array<T, 1ULL << PAGE_ADDR_BITS>;
+    /**
+     * @brief a snapshot of the content of the array
+     *
+     * holds (shared) references to all pages allocated at the time the snapshot was taken
+     */
+    class snapshot_type {
+        friend class sparse_array;
+        std::vector<std::pair<uint64_t, std::shared_ptr<page_type>>> pages;
 
-    using page_type = std::array<T, 1 << PAGE_ADDR_BITS>;
+    public:
+        //! get the number of pages held by the snapshot
+        size_t page_count() const { return pages.size(); }
+    };
     /**
      * the default constructor
      */
-    sparse_array() { arr.fill(nullptr); }
+    sparse_array() = default;
+
+    sparse_array(const sparse_array&) = delete;
+
+    sparse_array& operator=(const sparse_array&) = delete;
     /**
      * the destructor
      */
-    ~sparse_array() {
-        for(auto i : arr)
-            delete i;
-    }
+    ~sparse_array() = default;
     /**
      * element access operator
      *
      * @param addr address to access
      * @return the data type reference
      */
-    T& operator[](uint32_t addr) {
+    T& operator[](uint64_t addr) {
         assert(addr < SIZE);
-        T nr = addr >> PAGE_ADDR_BITS;
-        if(arr[nr] == nullptr)
-            arr[nr] = new page_type();
-        return arr[nr]->at(addr & page_addr_mask);
+        return (*this)(addr >> PAGE_ADDR_BITS)[addr & page_addr_mask];
     }
     /**
      * page fetch operator
@@ -76,11 +100,24 @@ public:
      * @param page_nr the page number ot fetch
      * @return reference to page
      */
-    page_type& operator()(uint32_t page_nr) {
+    page_type& operator()(uint64_t page_nr) {
         assert(page_nr < page_count);
-        if(arr[page_nr] == nullptr)
-            arr.at(page_nr) = new page_type();
-        return *(arr[page_nr]);
+        auto& p = arr[page_nr];
+        if(p == nullptr)
+            p = new_page(nullptr);
+        else if(p.use_count() > 1) // the page is shared with a snapshot
+            p = new_page(p.get());
+        return *p;
+    }
+    /**
+     * page fetch operator for read-only accesses, the page needs to be allocated. Shared pages are not copied
+     *
+     * @param page_nr the page number ot fetch
+     * @return reference to page
+     */
+    const page_type& operator()(uint64_t page_nr) const {
+        assert(page_nr < page_count && arr[page_nr] != nullptr);
+        return *arr[page_nr];
     }
     /**
      * check if page for address is allocated
@@ -88,11 +125,69 @@ public:
      * @param addr the address to check
      * @return true if the page is allocated
      */
-    bool is_allocated(uint32_t addr) {
+    bool is_allocated(uint64_t addr) {
         assert(addr < SIZE);
-        T nr = addr >> PAGE_ADDR_BITS;
+        uint64_t nr = addr >> PAGE_ADDR_BITS;
         return arr.at(nr) != nullptr;
     }
+    /**
+     * replace a page by an externally provided one (e.g. a region of a memory mapped file). The array shares the
+     * ownership of the page
+     *
+     * @param page_nr the page number to replace
+     * @param page the new page
+     */
+    void set_page(uint64_t page_nr, std::shared_ptr<page_type> page) {
+        assert(page_nr < page_count);
+        arr[page_nr] = std::move(page);
+    }
+    /**
+     * take a snapshot of the current content. The pages are shared with the snapshot until they are modified
+     *
+     * @return the snapshot
+     */
+    snapshot_type snapshot() const {
+        snapshot_type ret;
+        for(uint64_t i = 0; i < arr.size(); ++i)
+            if(arr[i])
+                ret.pages.emplace_back(i, arr[i]);
+        return ret;
+    }
+    /**
+     * restore the content from a snapshot. Pages not being part of the snapshot are released
+     *
+     * @param snap the snapshot to restore
+     */
+    void restore(const snapshot_type& snap) {
+        for(auto& p : arr)
+            p.reset();
+        for(auto& e : snap.pages)
+            arr[e.first] = e.second;
+    }
+    /**
+     * get the numbers of all pages whose content differs from the given snapshot
+     *
+     * @param snap the snapshot to compare with
+     * @return the list of page numbers in ascending order
+     */
+    std::vector<uint64_t> diff(const snapshot_type& snap) const {
+        std::vector<uint64_t> ret;
+        auto it = snap.pages.begin();
+        for(uint64_t i = 0; i < arr.size(); ++i) {
+            const page_type* snap_page = nullptr;
+            if(it != snap.pages.end() && it->first == i) {
+                snap_page = it->second.get();
+                ++it;
+            }
+            const page_type* cur_page = arr[i].get();
+            if(cur_page == snap_page)
+                continue;
+            if(cur_page && snap_page && std::memcmp(cur_page->data(), snap_page->data(), sizeof(page_type)) == 0)
+                continue;
+            ret.push_back(i);
+        }
+        return ret;
+    }
     /**
      * get the size of the array
      *
@@ -101,7 +196,22 @@ public:
     uint64_t size() { return SIZE; }
 
 protected:
-    std::array<page_type*, SIZE / (1 << PAGE_ADDR_BITS) + 1> arr;
+    //! create a zero-initialized page or a copy of src, if mapped by page_mem trivial pages are not touched
+    std::shared_ptr<page_type> new_page(const page_type* src) const {
+        if(!page_mem.is_mapped())
+            return src ? std::make_shared<page_type>(*src) : std::make_shared<page_type>();
+        auto mem = page_mem;
+        auto* p = mem.allocate(sizeof(page_type));
+        auto* page = src ? new(p) page_type(*src) : std::is_trivial<T>::value ? new(p) page_type : new(p) page_type();
+        return std::shared_ptr<page_type>(page, [mem](page_type* pg) {
+            pg->~page_type();
+            mem.release(reinterpret_cast<uint8_t*>(pg), sizeof(page_type));
+        });
+    }
+
+    std::array<std::shared_ptr<page_type>, SIZE / (1ULL << PAGE_ADDR_BITS) + 1> arr{};
+    //! the allocator of the pages according to the memory policy
+    const chunk_memory page_mem{};
 };
 } // namespace util
 /** @}*/
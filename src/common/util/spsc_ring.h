@@ -0,0 +1,132 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _UTIL_SPSC_RING_H_
+#define _UTIL_SPSC_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+/**
+ * \ingroup scc-common
+ */
+/**@{*/
+//! @brief SCC common utilities
+namespace util {
+//! the type independent interface of a spsc_ring
+struct spsc_ring_base {
+    virtual ~spsc_ring_base() = default;
+    //! make the entries pushed so far visible to the consumer
+    virtual void publish() = 0;
+};
+/**
+ * @brief a bounded lock-free single-producer/single-consumer ring of trivially copyable entries
+ *
+ * Entries pushed by the producer thread become visible to the consumer thread only when the producer calls publish().
+ * This allows to exchange data between two threads at well defined synchronization points, e.g. quantum boundaries,
+ * while both sides run without locking in between.
+ *
+ * @tparam T the entry type
+ */
+template <typename T> class spsc_ring : public spsc_ring_base {
+    static_assert(std::is_trivially_copyable<T>::value, "the entries need to be trivially copyable");
+
+public:
+    /**
+     * @param capacity the number of entries, rounded up to a power of 2
+     */
+    explicit spsc_ring(size_t capacity)
+    : entries(round_up(capacity))
+    , mask(entries.size() - 1) {}
+
+    spsc_ring(spsc_ring const&) = delete;
+
+    spsc_ring& operator=(spsc_ring const&) = delete;
+    //! the number of entries the ring can hold
+    size_t capacity() const { return entries.size(); }
+    /**
+     * add an entry, to be called by the producer
+     *
+     * @param v the entry
+     * @return false if the ring is full
+     */
+    bool push(T const& v) {
+        if(prod.pos - prod.tail_cache > mask) {
+            prod.tail_cache = tail.load(std::memory_order_acquire);
+            if(prod.pos - prod.tail_cache > mask)
+                return false;
+        }
+        entries[prod.pos & mask] = v;
+        ++prod.pos;
+        return true;
+    }
+    //! make the entries pushed so far visible to the consumer, to be called by the producer
+    void publish() override { head.store(prod.pos, std::memory_order_release); }
+    /**
+     * remove the oldest published entry, to be called by the consumer
+     *
+     * @param v the entry removed
+     * @return false if there is no published entry
+     */
+    bool pop(T& v) {
+        if(cons.pos == cons.head_cache) {
+            cons.head_cache = head.load(std::memory_order_acquire);
+            if(cons.pos == cons.head_cache)
+                return false;
+        }
+        v = entries[cons.pos & mask];
+        tail.store(++cons.pos, std::memory_order_release);
+        return true;
+    }
+    //! check if there is a published entry, to be called by the consumer
+    bool empty() {
+        if(cons.pos == cons.head_cache)
+            cons.head_cache = head.load(std::memory_order_acquire);
+        return cons.pos == cons.head_cache;
+    }
+
+private:
+    static size_t round_up(size_t n) {
+        size_t res = 2;
+        while(res < n)
+            res <<= 1;
+        return res;
+    }
+
+    static constexpr size_t cache_line = 64;
+    std::vector<T> entries;
+    const uint64_t mask;
+    // the members written by the producer and the consumer are kept on separate cache lines
+    char pad0[cache_line];
+    std::atomic<uint64_t> head{0};
+    struct {
+        uint64_t pos{0};
+        uint64_t tail_cache{0};
+    } prod;
+    char pad1[cache_line];
+    std::atomic<uint64_t> tail{0};
+    struct {
+        uint64_t pos{0};
+        uint64_t head_cache{0};
+    } cons;
+    char pad2[cache_line];
+};
+} // namespace util
+/**@}*/
+#endif /* _UTIL_SPSC_RING_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021-2022 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,10 +17,19 @@
 #ifndef _COMMON_UTIL_THREAD_POOL_H_
 #define _COMMON_UTIL_THREAD_POOL_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
 #include <deque>
+#include <functional>
 #include <future>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 /**
@@ -29,82 +38,383 @@
 /**@{*/
 //! @brief SCC common utilities
 namespace util {
-//! @brief a simple thread pool
-struct thread_pool {
-    // the mutex, condition variable and deque form a single thread-safe triggered queue of tasks:
-    std::mutex m;
-    std::condition_variable v;
-    // note that a packaged_task<void> can store a packaged_task<R>:
-    std::deque<std::packaged_task<void()>> work;
-    // this holds futures representing the worker threads being done:
-    std::vector<std::future<void>> finished;
-    // queue( lambda ) will enqueue the lambda into the tasks for the threads
-    // to use.  A future of the type the lambda returns is given to let you get
-    // the result out.
-    //  template<class F, class R=typename std::result_of<F>::type>
-    //  std::future<R> queue(F&& f) {
+/**
+ * @brief a move-only type-erased callable, small callables (like a packaged_task or a lambda capturing a few
+ * pointers) are stored in place so that wrapping them does not allocate
+ */
+class pool_task {
+    static constexpr size_t buffer_size = 4 * sizeof(void*);
+    using storage_type = typename std::aligned_storage<buffer_size, alignof(std::max_align_t)>::type;
+
+    struct ops_type {
+        void (*invoke)(void*);
+        void (*move)(void*, void*);
+        void (*destroy)(void*);
+    };
+
+    template <typename F>
+    using is_local =
+        std::integral_constant<bool, sizeof(F) <= buffer_size && alignof(F) <= alignof(std::max_align_t) &&
+                                         std::is_nothrow_move_constructible<F>::value>;
+
+    template <typename F> static ops_type const* local_ops() {
+        static const ops_type ops{[](void* p) { (*static_cast<F*>(p))(); },
+                                  [](void* dst, void* src) {
+                                      new(dst) F(std::move(*static_cast<F*>(src)));
+                                      static_cast<F*>(src)->~F();
+                                  },
+                                  [](void* p) { static_cast<F*>(p)->~F(); }};
+        return &ops;
+    }
+
+    template <typename F> static ops_type const* heap_ops() {
+        static const ops_type ops{[](void* p) { (**static_cast<F**>(p))(); },
+                                  [](void* dst, void* src) { *static_cast<F**>(dst) = *static_cast<F**>(src); },
+                                  [](void* p) { delete *static_cast<F**>(p); }};
+        return &ops;
+    }
+
+    template <typename F> void init(F&& f, std::true_type) {
+        new(&storage) F(std::move(f));
+        ops = local_ops<F>();
+    }
+
+    template <typename F> void init(F&& f, std::false_type) {
+        *reinterpret_cast<F**>(&storage) = new F(std::move(f));
+        ops = heap_ops<F>();
+    }
+
+public:
+    pool_task() = default;
+
+    template <typename F, typename FT = typename std::decay<F>::type,
+              typename = typename std::enable_if<!std::is_same<FT, pool_task>::value>::type>
+    pool_task(F&& f) {
+        FT func(std::forward<F>(f));
+        init(std::move(func), is_local<FT>());
+    }
+
+    pool_task(pool_task&& o) noexcept
+    : ops(o.ops) {
+        if(ops)
+            ops->move(&storage, &o.storage);
+        o.ops = nullptr;
+    }
+
+    pool_task& operator=(pool_task&& o) noexcept {
+        if(this != &o) {
+            reset();
+            ops = o.ops;
+            if(ops)
+                ops->move(&storage, &o.storage);
+            o.ops = nullptr;
+        }
+        return *this;
+    }
+
+    pool_task(pool_task const&) = delete;
+
+    pool_task& operator=(pool_task const&) = delete;
+
+    ~pool_task() { reset(); }
+    //! true if a callable is stored
+    explicit operator bool() const { return ops != nullptr; }
+    //! invoke the stored callable
+    void operator()() { ops->invoke(&storage); }
+
+private:
+    void reset() {
+        if(ops)
+            ops->destroy(&storage);
+        ops = nullptr;
+    }
+
+    storage_type storage;
+    ops_type const* ops{nullptr};
+};
+/**
+ * @brief a work-stealing thread pool
+ *
+ * Each worker owns a deque of tasks. Tasks posted from a worker (e.g. subtasks of a running task) go to its own deque
+ * and are taken LIFO for cache locality, tasks posted from other threads are distributed round-robin over the
+ * workers. An idle worker steals from the front of the deques of the other workers before going to sleep. post()
+ * does not create a future so its only cost is the queue insertion, enqueue() wraps the task into a packaged_task
+ * to provide the result. post_all() hands a range of tasks over with a single lock per worker and a single wakeup.
+ *
+ * The number of queued (not yet started) tasks can be bounded using set_capacity(). If the limit is reached posting
+ * threads block until workers have taken tasks, workers posting into a full pool execute the task in place instead to
+ * avoid deadlocks. For post_all() the capacity is a soft bound which is only checked once before inserting the range.
+ * Exceptions escaping a posted task terminate the process, use enqueue() to get them via the future.
+ */
+class thread_pool {
+public:
+    thread_pool() = default;
+
+    thread_pool(thread_pool const&) = delete;
+
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    ~thread_pool() { finish(); }
+    /**
+     * @brief queue a task returning a future for the result
+     *
+     * @param f the callable
+     * @param args the arguments being bound to the callable
+     * @return the future of the result
+     */
     template <class F, class... Args>
     auto enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type> {
         using return_type = typename std::result_of<F(Args...)>::type;
-        // wrap the function object into a packaged task, splitting
-        // execution from the return value:
-        std::packaged_task<return_type()> p(std::forward<F>(f));
+        // wrap the function object into a packaged task, splitting execution from the return value
+        std::packaged_task<return_type()> p(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
         auto r = p.get_future(); // get the return value before we hand off the task
-        {
-            std::unique_lock<std::mutex> l(m);
-            work.emplace_back(std::move(p)); // store the task<R()> as a task<void()>
+        post(std::move(p));
+        return r;
+    }
+    /**
+     * @brief queue a task without any means to wait for its result (fire-and-forget)
+     *
+     * @param f the callable
+     */
+    template <class F> void post(F&& f) {
+        pool_task t(std::forward<F>(f));
+        if(!wait_for_space(1)) {
+            t(); // a worker posting into a full pool
+            return;
         }
-        v.notify_one(); // wake a thread to work on the task
-        return r;       // return the future result of the task
+        push(std::move(t));
     }
-    // start N threads in the thread pool.
+    /**
+     * @brief queue a range of callables, they are moved out of the range
+     *
+     * @param first the begin of the range
+     * @param last the end of the range
+     */
+    template <class IT> void post_all(IT first, IT last) {
+        auto n = static_cast<size_t>(std::distance(first, last));
+        if(!n)
+            return;
+        wait_for_space(n);
+        std::unique_lock<std::mutex> run_lock(run_mtx);
+        // count the tasks before inserting them so that the counter never drops below zero
+        queued.fetch_add(n);
+        if(workers.empty()) {
+            std::lock_guard<std::mutex> lock(inject.mtx);
+            for(; first != last; ++first)
+                inject.tasks.emplace_back(std::move(*first));
+        } else {
+            // hand out contiguous slices, one lock per worker
+            auto per_worker = (n + workers.size() - 1) / workers.size();
+            auto idx = next.fetch_add(1, std::memory_order_relaxed);
+            while(first != last) {
+                auto& q = *workers[idx++ % workers.size()];
+                std::lock_guard<std::mutex> lock(q.mtx);
+                for(size_t i = 0; i < per_worker && first != last; ++i, ++first)
+                    q.tasks.emplace_back(std::move(*first));
+            }
+        }
+        run_lock.unlock();
+        wake(n > 1);
+    }
+    /**
+     * @brief start the worker threads, if the pool is already running it is finished first
+     *
+     * @param N the number of worker threads
+     */
     void start(std::size_t N = 1) {
-        for(std::size_t i = 0; i < N; ++i) {
-            // each thread is a std::async running this->thread_task():
-            finished.push_back(std::async(std::launch::async, [this] { thread_task(); }));
+        finish();
+        std::lock_guard<std::mutex> run_lock(run_mtx);
+        {
+            std::lock_guard<std::mutex> lock(sleep_mtx);
+            stop = false;
         }
+        running = N > 0;
+        for(std::size_t i = 0; i < N; ++i)
+            workers.emplace_back(new queue);
+        for(std::size_t i = 0; i < N; ++i)
+            threads.emplace_back([this, i] { thread_task(i); });
     }
-    // abort() cancels all non-started tasks, and tells every working thread
-    // stop running, and waits for them to finish up.
+    //! cancel all non-started tasks, tell every worker to stop and wait for them
     void abort() {
         cancel_pending();
         finish();
     }
-    // cancel_pending() merely cancels all non-started tasks:
+    //! cancel all non-started tasks, the futures of cancelled enqueue()d tasks report a broken promise
     void cancel_pending() {
-        std::unique_lock<std::mutex> l(m);
-        work.clear();
+        std::vector<pool_task> cancelled;
+        {
+            std::lock_guard<std::mutex> run_lock(run_mtx);
+            collect(inject, cancelled);
+            for(auto& q : workers)
+                collect(*q, cancelled);
+        }
+        queued.fetch_sub(cancelled.size());
+        wake_producers();
     }
-    // finish enques a "stop the thread" message for every thread, then waits for them:
+    //! wait until all queued tasks are executed and stop the worker threads
     void finish() {
         {
-            std::unique_lock<std::mutex> l(m);
-            for(auto&& unused : finished) {
-                work.push_back({});
-            }
+            std::lock_guard<std::mutex> lock(sleep_mtx);
+            stop = true;
         }
-        v.notify_all();
-        finished.clear();
+        work_cv.notify_all();
+        for(auto& t : threads)
+            t.join();
+        std::lock_guard<std::mutex> run_lock(run_mtx);
+        running = false;
+        threads.clear();
+        // tasks posted during the shutdown but not yet taken are kept for the next start()
+        for(auto& q : workers)
+            for(auto& t : q->tasks)
+                inject.tasks.emplace_back(std::move(t));
+        workers.clear();
     }
-    ~thread_pool() { finish(); }
+    /**
+     * @brief set the maximum number of queued tasks
+     *
+     * @param cap the capacity, 0 means unbounded
+     */
+    void set_capacity(size_t cap) {
+        capacity.store(cap ? cap : std::numeric_limits<size_t>::max());
+        wake_producers();
+    }
+    //! get the number of worker threads
+    size_t size() {
+        std::lock_guard<std::mutex> run_lock(run_mtx);
+        return threads.size();
+    }
+    //! get the number of tasks queued but not yet started
+    size_t get_queued_count() const { return queued.load(std::memory_order_relaxed); }
 
 private:
-    void thread_task() {
+    struct queue {
+        std::mutex mtx;
+        std::deque<pool_task> tasks;
+    };
+    //! the pool and worker index the calling thread belongs to
+    static std::pair<thread_pool*, size_t>& current() {
+        static thread_local std::pair<thread_pool*, size_t> inst{nullptr, 0};
+        return inst;
+    }
+
+    bool is_worker() const { return current().first == this; }
+    bool has_space(size_t n) const { return queued.load() + n <= capacity.load() || queued.load() == 0 || !running; }
+    //! block until there is space for n tasks, returns false if the calling thread is a worker of a full pool
+    bool wait_for_space(size_t n) {
+        if(has_space(n))
+            return true;
+        if(is_worker())
+            return false;
+        std::unique_lock<std::mutex> lock(sleep_mtx);
+        ++blocked;
+        space_cv.wait(lock, [this, n] { return has_space(n); });
+        --blocked;
+        return true;
+    }
+
+    void push(pool_task&& t) {
+        {
+            std::lock_guard<std::mutex> run_lock(run_mtx);
+            queue* q;
+            if(workers.empty())
+                q = &inject;
+            else if(is_worker())
+                q = workers[current().second].get();
+            else
+                q = workers[next.fetch_add(1, std::memory_order_relaxed) % workers.size()].get();
+            queued.fetch_add(1);
+            std::lock_guard<std::mutex> lock(q->mtx);
+            q->tasks.emplace_back(std::move(t));
+        }
+        wake(false);
+    }
+    //! wake sleeping workers, the seq_cst accesses of queued and sleeping ensure no wakeup is lost
+    void wake(bool all) {
+        if(sleeping.load() == 0)
+            return;
+        { std::lock_guard<std::mutex> lock(sleep_mtx); }
+        if(all)
+            work_cv.notify_all();
+        else
+            work_cv.notify_one();
+    }
+
+    void wake_producers() {
+        if(blocked.load() == 0)
+            return;
+        { std::lock_guard<std::mutex> lock(sleep_mtx); }
+        space_cv.notify_all();
+    }
+
+    static bool take(queue& q, pool_task& t, bool back) {
+        std::lock_guard<std::mutex> lock(q.mtx);
+        if(q.tasks.empty())
+            return false;
+        if(back) {
+            t = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        } else {
+            t = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+        return true;
+    }
+
+    static void collect(queue& q, std::vector<pool_task>& res) {
+        std::lock_guard<std::mutex> lock(q.mtx);
+        for(auto& t : q.tasks)
+            res.emplace_back(std::move(t));
+        q.tasks.clear();
+    }
+    //! get a task from the own deque, the tasks posted before start() or from another worker
+    bool pop(size_t idx, pool_task& t) {
+        if(take(*workers[idx], t, true) || take(inject, t, false))
+            return true;
+        for(size_t i = 1; i < workers.size(); ++i)
+            if(take(*workers[(idx + i) % workers.size()], t, false))
+                return true;
+        return false;
+    }
+
+    void thread_task(size_t idx) {
+        current() = std::make_pair(this, idx);
+        pool_task t;
         while(true) {
-            std::packaged_task<void()> f;
-            {
-                std::unique_lock<std::mutex> l(m);
-                if(work.empty()) {
-                    v.wait(l, [&] { return !work.empty(); });
-                }
-                f = std::move(work.front());
-                work.pop_front();
+            if(pop(idx, t)) {
+                queued.fetch_sub(1);
+                wake_producers();
+                t();
+                t = pool_task();
+                continue;
             }
-            if(!f.valid())
+            std::unique_lock<std::mutex> lock(sleep_mtx);
+            ++sleeping;
+            work_cv.wait(lock, [this] { return queued.load() > 0 || stop; });
+            --sleeping;
+            if(stop && queued.load() == 0)
                 return;
-            f();
         }
     }
+    //! protects the set of workers, the workers themselves access it without lock while running
+    std::mutex run_mtx;
+    std::vector<std::unique_ptr<queue>> workers;
+    std::vector<std::thread> threads;
+    //! tasks posted while no worker is running
+    queue inject;
+    //! the round-robin counter for tasks posted from outside
+    std::atomic<size_t> next{0};
+    //! the number of queued tasks
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> capacity{std::numeric_limits<size_t>::max()};
+    //! true while worker threads are running, a pool not being started does not block producers
+    std::atomic<bool> running{false};
+    //! protects sleeping and waking of workers and blocked producers
+    std::mutex sleep_mtx;
+    std::condition_variable work_cv;
+    std::condition_variable space_cv;
+    std::atomic<unsigned> sleeping{0};
+    std::atomic<unsigned> blocked{0};
+    bool stop{false};
 };
 } // namespace util
 /**@}*/
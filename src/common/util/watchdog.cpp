@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2020-2022 MINRES Technologies GmbH
+ * Copyright 2020-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -42,20 +42,24 @@ watchdog::~watchdog() {
 
 void watchdog::guard() {
     while(live.load()) {
-        if(idle.load()) {
+        if(idle.load() && !monitoring.load()) {
             // Sleep indefinitely until either told to become active or destruct
             std::unique_lock<std::mutex> live_lock(guard_mutex);
-            wakeup.wait(live_lock, [this]() { return !this->idle.load() || !this->live.load(); });
+            wakeup.wait(live_lock, [this]() {
+                return !this->idle.load() || this->monitoring.load() || !this->live.load();
+            });
         };
         if(!live.load())
             break;
         // the actual timeout checking
         auto now = system_clock::now();
-        if((now - touched.load()) > timeout) {
+        if(!idle.load() && (now - touched.load()) > timeout) {
             idle.store(true);
             alarm_cb();
             continue; // skip waiting for next timeout
         }
+        if(monitoring.load())
+            check_progress(now);
         {
             // sleep until next timeout check or destruction
             std::unique_lock<std::mutex> live_lock(guard_mutex);
@@ -71,3 +75,42 @@ void watchdog::arm() {
 }
 
 void watchdog::re_arm() { touched.store(system_clock::now()); }
+
+void watchdog::monitor_progress(system_clock::duration stall_timeout, double min_ratio,
+                                std::function<void(health, progress const&)> progress_cb,
+                                std::function<void(void)> sample_cb) {
+    {
+        std::unique_lock<std::mutex> lock(guard_mutex);
+        this->stall_timeout = stall_timeout;
+        this->min_ratio = min_ratio;
+        this->progress_cb = std::move(progress_cb);
+        this->sample_cb = std::move(sample_cb);
+        last_time = window_time = progress_time.load(std::memory_order_acquire);
+        last_advance = window_start = system_clock::now();
+    }
+    monitoring.store(true);
+    wakeup.notify_all();
+}
+
+void watchdog::check_progress(system_clock::time_point now) {
+    if(sample_cb)
+        sample_cb();
+    auto time = progress_time.load(std::memory_order_acquire);
+    progress p{time, progress_deltas.load(std::memory_order_relaxed), 0.};
+    if(time != last_time) {
+        last_time = time;
+        last_advance = now;
+    } else if(now - last_advance > stall_timeout) {
+        last_advance = now; // report once per stall timeout
+        progress_cb(health::STALLED, p);
+    }
+    if(now - window_start >= stall_timeout) {
+        // a simulation not advancing at all is reported as stalled
+        auto advanced = time != window_time;
+        p.ratio = (time - window_time) / duration<double>(now - window_start).count();
+        window_start = now;
+        window_time = time;
+        if(min_ratio > 0 && advanced && p.ratio < min_ratio)
+            progress_cb(health::SLOW, p);
+    }
+}
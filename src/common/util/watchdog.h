@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2017 MINRES Technologies GmbH
+ * Copyright 2017, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -20,6 +20,7 @@
 #undef noexcept
 #endif
 #include <chrono>
+#include <cstdint>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
@@ -33,9 +34,25 @@
 namespace util {
 /**
  * @brief a watch dog based on https://github.com/didenko/TimeoutGuard
+ *
+ * Besides the timeout the watch dog can monitor the progress of a simulation. The simulation reports its time and
+ * number of delta cycles using update_progress() which only stores two atomics. The guard thread raises an alarm if the
+ * reported time does not advance within the stall timeout or if the ratio of simulated to host time over the last
+ * stall timeout drops below a threshold (e.g. due to a livelock in delta cycles).
  */
 class watchdog {
 public:
+    //! the kind of a progress alarm
+    enum class health { STALLED, SLOW };
+    //! the progress figures at the time of the alarm
+    struct progress {
+        //! the last reported simulation time in seconds
+        double sim_time;
+        //! the last reported number of delta cycles
+        uint64_t deltas;
+        //! simulated seconds per host second during the last interval
+        double ratio;
+    };
     /**
      * constructor
      * @param timeout until the watch dog is going to expire
@@ -73,10 +90,38 @@ public:
      * re-arms the watch dog
      */
     void re_arm();
+    /**
+     * enable the monitoring of the simulation progress, the monitoring is independent of arming the watch dog. It
+     * must not be called while the monitoring is enabled
+     *
+     * @param stall_timeout the host time the simulation time may not advance, also the interval of checking the ratio
+     * @param min_ratio the minimum simulated seconds per host second, 0 disables the check
+     * @param progress_cb the function to be called from the guard thread if the progress is not sufficient. It is
+     * called once per stall timeout as long as the condition persists
+     * @param sample_cb the function called from the guard thread each sleep_duration before the progress is checked,
+     * e.g. to request an update of the progress from the simulation thread. It may be empty
+     */
+    void monitor_progress(std::chrono::system_clock::duration stall_timeout, double min_ratio,
+                          std::function<void(health, progress const&)> progress_cb,
+                          std::function<void(void)> sample_cb = std::function<void(void)>());
+    //! disable the monitoring of the simulation progress
+    void stop_monitoring() { monitoring.store(false); }
+    /**
+     * report the progress of the simulation, can be called from any thread and does not block
+     *
+     * @param sim_time the simulation time in seconds
+     * @param deltas the number of delta cycles so far
+     */
+    void update_progress(double sim_time, uint64_t deltas) {
+        progress_deltas.store(deltas, std::memory_order_relaxed);
+        progress_time.store(sim_time, std::memory_order_release);
+    }
 
 private:
     void guard();
 
+    void check_progress(std::chrono::system_clock::time_point now);
+
     std::chrono::system_clock::duration timeout;
     std::chrono::system_clock::duration sleep_duration;
     std::function<void(void)> alarm_cb;
@@ -86,6 +131,17 @@ private:
     std::thread guard_thread;
     std::mutex guard_mutex;
     std::condition_variable wakeup;
+    std::atomic_bool monitoring{false};
+    std::chrono::system_clock::duration stall_timeout{};
+    double min_ratio{0.};
+    std::function<void(health, progress const&)> progress_cb;
+    std::function<void(void)> sample_cb;
+    std::atomic<double> progress_time{0.};
+    std::atomic<uint64_t> progress_deltas{0};
+    // the guard thread state of the progress monitoring
+    double last_time{0.};
+    std::chrono::system_clock::time_point last_advance, window_start;
+    double window_time{0.};
 };
 } // namespace util
 /** @} */
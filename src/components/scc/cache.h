@@ -0,0 +1,207 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_CACHE_H_
+#define _SCC_CACHE_H_
+
+#include <algorithm>
+#include <cci_configuration>
+#include <limits>
+#include <memory>
+#include <scc/cached_cci_param.h>
+#include <scc/report.h>
+#include <scc/sc_variable.h>
+#include <scc/utilities.h>
+#include <tlm.h>
+#include <tlm/scc/initiator_mixin.h>
+#include <tlm/scc/target_mixin.h>
+#include <util/cache_tags.h>
+#include <vector>
+
+namespace scc {
+/**
+ * @class cache
+ * @brief a functional set associative cache model to be put in front of a memory or router
+ *
+ * The cache only holds the tags, all accesses are forwarded to the initiator socket so no data is kept. The
+ * replacement policy is selected by the parameter replacement (see util::cache_tags::replacement_policy), write misses
+ * allocate a line if write_allocate is set. The counters of hits, misses, read and write misses, and write backs of
+ * dirty lines are registered as sc_ref_variable with the names stat_{accesses,hits,misses,read_misses,write_misses,
+ * writebacks} so they are accessible using the scc::value_registry.
+ *
+ * If stats_only is false the cache models the timing: a hit takes hit_delay instead of the delay of the downstream
+ * access, a miss adds miss_delay to it, and DMI is denied. If stats_only is true the timing of the downstream path is
+ * kept and DMI requests are forwarded, so only the accesses using b_transport are seen. For a hit rate representative
+ * of the DMI accesses, a sample_window every sample_interval can be given. During the window DMI pointers are
+ * invalidated and denied, so the initiators fall back to b_transport and their accesses reach the cache.
+ *
+ * @tparam BUSWIDTH the width of the bus
+ */
+template <unsigned BUSWIDTH = LT> class cache : public sc_core::sc_module {
+public:
+    tlm::scc::target_mixin<tlm::tlm_target_socket<BUSWIDTH>> target{"ts"};
+
+    tlm::scc::initiator_mixin<tlm::tlm_initiator_socket<BUSWIDTH>> isck{"isck"};
+
+    cci::cci_param<unsigned> size{"size", 32768, "capacity of the cache in bytes"};
+
+    cci::cci_param<unsigned> line_size{"line_size", 64, "size of a cache line in bytes, needs to be a power of 2"};
+
+    cci::cci_param<unsigned> ways{"ways", 4, "the associativity"};
+
+    cci::cci_param<unsigned> replacement{"replacement", util::cache_tags::LRU,
+                                         "replacement policy, see util::cache_tags::replacement_policy"};
+
+    cci::cci_param<bool> write_allocate{"write_allocate", true, "allocate a line upon a write miss"};
+
+    scc::cached_cci_param<sc_core::sc_time> hit_delay{"hit_delay", sc_core::SC_ZERO_TIME, "delay of a hit"};
+
+    scc::cached_cci_param<sc_core::sc_time> miss_delay{"miss_delay", sc_core::SC_ZERO_TIME,
+                                                       "delay of a miss added to the downstream access"};
+
+    cci::cci_param<bool> stats_only{"stats_only", false,
+                                    "only collect statistics, keep the downstream timing and allow DMI"};
+
+    cci::cci_param<sc_core::sc_time> sample_interval{"sample_interval", sc_core::SC_ZERO_TIME,
+                                                     "interval of the sample windows in stats_only mode, 0 disables"};
+
+    cci::cci_param<sc_core::sc_time> sample_window{
+        "sample_window", sc_core::sc_time(10, sc_core::SC_US),
+        "duration DMI is denied in each sample_interval so that the accesses reach the cache"};
+
+    cache(sc_core::sc_module_name const& nm);
+    //! the number of accesses to cache lines (an access spanning several lines counts for each)
+    uint64_t get_accesses() const { return accesses; }
+
+    uint64_t get_hits() const { return hits; }
+
+    uint64_t get_misses() const { return misses; }
+
+    uint64_t get_writebacks() const { return writebacks; }
+    //! the ratio of hits and accesses
+    double get_hit_rate() const { return accesses ? static_cast<double>(hits) / accesses : 0.0; }
+
+private:
+    void end_of_elaboration() override;
+
+    void b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
+
+    bool get_direct_mem_ptr(tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
+        if(stats_only.get_value() && !sampling)
+            return isck->get_direct_mem_ptr(trans, dmi_data);
+        trans.set_dmi_allowed(false);
+        return false;
+    }
+
+    void sampler();
+
+    std::unique_ptr<util::cache_tags> tags;
+    unsigned line_bits{0};
+    bool sampling{false};
+    uint64_t accesses{0};
+    uint64_t hits{0};
+    uint64_t misses{0};
+    uint64_t read_misses{0};
+    uint64_t write_misses{0};
+    uint64_t writebacks{0};
+    std::vector<std::unique_ptr<sc_variable_b>> stat_vars;
+};
+
+template <unsigned BUSWIDTH>
+inline cache<BUSWIDTH>::cache(sc_core::sc_module_name const& nm)
+: sc_core::sc_module(nm) {
+    target.template register_b_transport<cache, &cache::b_transport>(this);
+    target.register_get_direct_mem_ptr([this](tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
+        return get_direct_mem_ptr(trans, dmi_data);
+    });
+    target.register_transport_dbg([this](tlm::tlm_generic_payload& trans) { return isck->transport_dbg(trans); });
+    isck.register_invalidate_direct_mem_ptr([this](::sc_dt::uint64 start, ::sc_dt::uint64 end) {
+        target->invalidate_direct_mem_ptr(start, end);
+    });
+    stat_vars.emplace_back(new sc_ref_variable<uint64_t>("stat_accesses", accesses));
+    stat_vars.emplace_back(new sc_ref_variable<uint64_t>("stat_hits", hits));
+    stat_vars.emplace_back(new sc_ref_variable<uint64_t>("stat_misses", misses));
+    stat_vars.emplace_back(new sc_ref_variable<uint64_t>("stat_read_misses", read_misses));
+    stat_vars.emplace_back(new sc_ref_variable<uint64_t>("stat_write_misses", write_misses));
+    stat_vars.emplace_back(new sc_ref_variable<uint64_t>("stat_writebacks", writebacks));
+    SC_HAS_PROCESS(cache);
+    SC_THREAD(sampler);
+}
+
+template <unsigned BUSWIDTH> inline void cache<BUSWIDTH>::end_of_elaboration() {
+    auto lsz = std::max(1U, line_size.get_value());
+    auto w = std::max(1U, ways.get_value());
+    size_t sets = std::max<size_t>(1, size.get_value() / (lsz * w));
+    if((lsz & (lsz - 1)) || (sets & (sets - 1)))
+        SCCERR(SCMOD) << "line size and number of sets (size / (line_size * ways)) need to be powers of 2";
+    while(sets & (sets - 1))
+        sets &= sets - 1;
+    line_bits = 0;
+    while((2U << line_bits) <= lsz)
+        ++line_bits;
+    auto policy = replacement.get_value() <= util::cache_tags::RANDOM
+                      ? static_cast<util::cache_tags::replacement_policy>(replacement.get_value())
+                      : util::cache_tags::LRU;
+    tags.reset(new util::cache_tags(sets, w, policy));
+}
+
+template <unsigned BUSWIDTH>
+inline void cache<BUSWIDTH>::b_transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+    auto write = trans.is_write();
+    auto len = std::max(1U, trans.get_data_length());
+    auto first = trans.get_address() >> line_bits;
+    auto last = (trans.get_address() + len - 1) >> line_bits;
+    bool hit = true;
+    for(auto line = first; line <= last; ++line) {
+        auto res = tags->access(line, write, !write || write_allocate.get_value());
+        ++accesses;
+        if(res.hit) {
+            ++hits;
+            continue;
+        }
+        hit = false;
+        ++misses;
+        ++(write ? write_misses : read_misses);
+        if(res.writeback)
+            ++writebacks;
+    }
+    if(stats_only.get_value()) {
+        isck->b_transport(trans, delay);
+        if(sampling)
+            trans.set_dmi_allowed(false);
+        return;
+    }
+    auto downstream = delay;
+    isck->b_transport(trans, downstream);
+    delay = hit ? delay + hit_delay.get_value() : downstream + miss_delay.get_value();
+    trans.set_dmi_allowed(false);
+}
+
+template <unsigned BUSWIDTH> inline void cache<BUSWIDTH>::sampler() {
+    auto interval = sample_interval.get_value();
+    if(!stats_only.get_value() || interval == sc_core::SC_ZERO_TIME)
+        return;
+    auto window = std::min(sample_window.get_value(), interval);
+    while(true) {
+        wait(interval - window);
+        sampling = true;
+        target->invalidate_direct_mem_ptr(0, std::numeric_limits<::sc_dt::uint64>::max());
+        wait(window);
+        sampling = false;
+    }
+}
+} // namespace scc
+#endif /* _SCC_CACHE_H_ */
@@ -0,0 +1,221 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_CHECKPOINT_H_
+#define _SCC_CHECKPOINT_H_
+
+#include "resource_access_if.h"
+#include <cci_configuration>
+#include <functional>
+#include <scc/report.h>
+#include <scc/sc_variable.h>
+#include <string>
+#include <systemc>
+#include <util/checkpoint_image.h>
+#include <vector>
+
+namespace scc {
+/**
+ * @class checkpoint_if
+ * @brief the interface of sc_objects storing their state in a checkpoint
+ */
+struct checkpoint_if {
+    virtual ~checkpoint_if() = default;
+    /**
+     * write the state into the image
+     *
+     * @param w the image writer
+     * @param name the name to use for the records
+     * @param incremental if true only the state changed since the last save or restore needs to be written
+     */
+    virtual void save_checkpoint(util::checkpoint_writer& w, std::string const& name, bool incremental) = 0;
+    /**
+     * restore the state from an image
+     *
+     * @param r the image reader
+     * @param name the name of the records
+     * @param incremental if true the image holds only the changes with respect to the previously restored one
+     */
+    virtual void restore_checkpoint(util::checkpoint_reader const& r, std::string const& name, bool incremental) = 0;
+};
+/**
+ * @class checkpoint
+ * @brief saves and restores the state of the whole platform
+ *
+ * A checkpoint image holds the state of all objects of the design hierarchy implementing scc::checkpoint_if (e.g.
+ * the pages of scc::memory), the content of all registers (sc_register, bitfield_register and other sc_objects
+ * implementing the resource_access_if), the values of the sc_variables and the values of all cci parameters. An
+ * incremental image only holds the memory pages changed since the image saved or restored last and refers to that
+ * image, restoring it restores the whole chain. Memory pages are stored page aligned and are mapped copy-on-write
+ * upon restore instead of being copied.
+ *
+ * The image given by restore_file is restored during start_of_simulation, the simulation time starts at 0 again.
+ * The state of the processes (e.g. a thread waiting on an event) is not part of a checkpoint, models keeping state
+ * outside of the objects listed above need to implement scc::checkpoint_if.
+ */
+class checkpoint : public sc_core::sc_module {
+public:
+    cci::cci_param<std::string> restore_file{"restore_file", "", "checkpoint image restored during start_of_simulation"};
+
+    cci::cci_param<std::string> save_file{"save_file", "", "checkpoint image written at save_time"};
+
+    cci::cci_param<sc_core::sc_time> save_time{
+        "save_time", sc_core::SC_ZERO_TIME,
+        "simulation time the image given by save_file is written at, 0 writes it at the end of the simulation"};
+
+    cci::cci_param<bool> restore_parameters{"restore_parameters", true,
+                                            "set the cci parameters to the values stored in the image"};
+
+    checkpoint(sc_core::sc_module_name const& nm = "checkpoint")
+    : sc_core::sc_module(nm) {
+        SC_HAS_PROCESS(checkpoint);
+        SC_THREAD(run);
+    }
+    /**
+     * write a full checkpoint image
+     *
+     * @param file_name the name of the image file
+     * @return true if the image could be written
+     */
+    bool save(std::string const& file_name) { return write(file_name, false); }
+    /**
+     * write an incremental checkpoint image relative to the image saved or restored last, a full one if there is none
+     *
+     * @param file_name the name of the image file
+     * @return true if the image could be written
+     */
+    bool save_incremental(std::string const& file_name) { return write(file_name, !last_image.empty()); }
+    /**
+     * restore a checkpoint image, incremental images restore the images they are based on first
+     *
+     * @param file_name the name of the image file
+     * @return true if the image could be restored
+     */
+    bool restore(std::string const& file_name) {
+        try {
+            util::checkpoint_reader r(file_name);
+            auto base = r.get_string("checkpoint.base");
+            if(base.size() && !restore(base))
+                return false;
+            apply(r, !base.empty());
+            last_image = file_name;
+            SCCINFO(SCMOD) << "restored checkpoint " << file_name << " taken at "
+                           << r.get_string("checkpoint.time");
+            return true;
+        } catch(std::exception& e) {
+            SCCERR(SCMOD) << "could not restore checkpoint " << file_name << ": " << e.what();
+            return false;
+        }
+    }
+
+protected:
+    void start_of_simulation() override {
+        if(restore_file.get_value().size())
+            restore(restore_file.get_value());
+    }
+
+    void end_of_simulation() override {
+        if(save_file.get_value().size() && save_time.get_value() == sc_core::SC_ZERO_TIME)
+            save(save_file.get_value());
+    }
+
+private:
+    void run() {
+        if(save_file.get_value().empty() || save_time.get_value() == sc_core::SC_ZERO_TIME)
+            return;
+        wait(save_time.get_value());
+        save(save_file.get_value());
+    }
+
+    bool write(std::string const& file_name, bool incremental) {
+        try {
+            util::checkpoint_writer w(file_name);
+            if(incremental)
+                w.add("checkpoint.base", last_image);
+            w.add("checkpoint.time", sc_core::sc_time_stamp().to_string());
+            for_each_object([&w, incremental](sc_core::sc_object* obj) {
+                std::string name = obj->name();
+                if(auto* c = dynamic_cast<checkpoint_if*>(obj))
+                    c->save_checkpoint(w, "obj:" + name, incremental);
+                else if(auto* res = dynamic_cast<resource_access_if*>(obj)) {
+                    std::vector<uint8_t> buf(res->size());
+                    if(res->read_dbg(buf.data(), buf.size()))
+                        w.add("reg:" + name, 0, buf.data(), buf.size());
+                } else if(auto* var = dynamic_cast<sc_variable_b*>(obj))
+                    w.add("var:" + name, var->to_string());
+            });
+            for(auto& h : cci::cci_get_broker(cci::cci_originator(*this)).get_param_handles())
+                w.add("param:" + std::string(h.name()), h.get_cci_value().to_json());
+            w.finish();
+            last_image = file_name;
+            SCCINFO(SCMOD) << "wrote " << (incremental ? "incremental " : "") << "checkpoint " << file_name;
+            return true;
+        } catch(std::exception& e) {
+            SCCERR(SCMOD) << "could not write checkpoint " << file_name << ": " << e.what();
+            return false;
+        }
+    }
+
+    void apply(util::checkpoint_reader const& r, bool incremental) {
+        for_each_object([this, &r, incremental](sc_core::sc_object* obj) {
+            std::string name = obj->name();
+            if(auto* c = dynamic_cast<checkpoint_if*>(obj))
+                c->restore_checkpoint(r, "obj:" + name, incremental);
+            else if(auto* res = dynamic_cast<resource_access_if*>(obj)) {
+                auto& recs = r.get("reg:" + name);
+                if(recs.size() && recs[0].size == res->size())
+                    res->write_dbg(recs[0].data, recs[0].size);
+                else
+                    SCCWARN(SCMOD) << "no matching state of " << name << " in the checkpoint";
+            } else if(auto* var = dynamic_cast<sc_variable_b*>(obj)) {
+                auto& recs = r.get("var:" + name);
+                if(recs.size())
+                    var->from_string(r.get_string("var:" + name));
+            }
+        });
+        if(!restore_parameters.get_value())
+            return;
+        std::string own_prefix = std::string(name()) + ".";
+        for(auto& h : cci::cci_get_broker(cci::cci_originator(*this)).get_param_handles()) {
+            auto& recs = r.get("param:" + std::string(h.name()));
+            // the parameters of this module control the restore itself
+            if(recs.empty() || std::string(h.name()).compare(0, own_prefix.size(), own_prefix) == 0)
+                continue;
+            auto value = cci::cci_value::from_json(r.get_string("param:" + std::string(h.name())));
+            if(value == h.get_cci_value())
+                continue;
+            if(h.is_locked())
+                SCCWARN(SCMOD) << "cannot restore the locked parameter " << h.name();
+            else
+                h.set_cci_value(value);
+        }
+    }
+
+    static void for_each_object(std::function<void(sc_core::sc_object*)> const& f) {
+        std::function<void(std::vector<sc_core::sc_object*> const&)> visit =
+            [&f, &visit](std::vector<sc_core::sc_object*> const& objs) {
+                for(auto* obj : objs) {
+                    f(obj);
+                    visit(obj->get_child_objects());
+                }
+            };
+        visit(sc_core::sc_get_top_level_objects());
+    }
+
+    std::string last_image;
+};
+} // namespace scc
+#endif /* _SCC_CHECKPOINT_H_ */
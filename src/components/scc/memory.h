@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2018 MINRES Technologies GmbH
+ * Copyright 2016, 2018, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -22,30 +22,90 @@
 #define SC_INCLUDE_DYNAMIC_PROCESSES
 #endif
 
+#include "checkpoint.h"
+#include <scc/cached_cci_param.h>
 #include <scc/mt19937_rng.h>
 #include <scc/report.h>
+#include <scc/span_tracer.h>
 #include <scc/utilities.h>
 #include <tlm/scc/target_mixin.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
 #include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 #include <tlm.h>
+#include <util/concurrent_sparse_array.h>
+#include <util/contiguous_array.h>
+#include <util/image_loader.h>
 #include <util/sparse_array.h>
 
 namespace scc {
+namespace detail {
+//! check if a storage of scc::memory allows to share externally provided pages
+template <typename S, typename = void> struct has_set_page : std::false_type {};
+template <typename S>
+struct has_set_page<S, decltype(void(std::declval<S&>().set_page(0, std::shared_ptr<typename S::page_type>())))>
+: std::true_type {};
+//! check if a storage of scc::memory is backed by a file
+template <typename S, typename = void> struct has_backing_file : std::false_type {};
+template <typename S>
+struct has_backing_file<S, decltype(void(std::declval<S&>().get_storage().file_name = std::string()))>
+: std::true_type {};
+//! check if a storage of scc::memory supports snapshots
+template <typename S, typename = void> struct has_snapshot : std::false_type {};
+template <typename S> struct has_snapshot<S, decltype(void(std::declval<S const&>().snapshot()))> : std::true_type {};
+} // namespace detail
 
 /**
  * @class memory
  * @brief simple TLM2.0 LT memory model
  *
- * This model uses the \ref util::sparse_array as backing store. Therefore it can have an arbitrary size since only
- * pages for accessed addresses are allocated.
+ * This model uses the \ref util::sparse_array as backing store by default. Therefore it can have an arbitrary size
+ * since only pages for accessed addresses are allocated. If the backing store is contiguous (e.g.
+ * \ref util::contiguous_array) a DMI request is granted for the whole memory, otherwise for the page containing the
+ * requested address. For large and sparsely used address ranges \ref util::radix_array provides small pages without
+ * the need of a huge page table. If the memory is accessed concurrently from several OS threads (e.g. via DMI pointers)
+ * \ref util::concurrent_sparse_array allows lock-free allocation of pages.
+ *
+ * If SCC_MEMORY_STATISTICS is defined the memory collects per-page access statistics (number of bytes read and
+ * written, time of first and last access) which are written to statistics_file at the end of the simulation.
+ * Accesses using DMI pointers are not covered. Otherwise the statistics are compiled out and do not incur any overhead.
+ *
+ * Besides the fixed response delays an optional bank/row-buffer timing model can be enabled using the
+ * row_buffer_model parameter. An access to an open row of a bank takes row_hit_delay, otherwise row_miss_delay is
+ * added and the row is opened. If bytes_per_cycle is non-zero the data transfer is limited to the given bandwidth at
+ * clock_period, consecutive accesses are serialized accordingly.
+ *
+ * If the storage is backed by a file (e.g. util::contiguous_array with util::file_storage) the file is given by the
+ * backing_file parameter and the memory content persists across simulation runs.
+ *
+ * If the storage supports snapshots the memory content is part of the images of scc::checkpoint. Incremental images
+ * only hold the pages changed since the last save or restore, restored pages are mapped from the image.
  *
  * TODO: add some more attributes/parameters to configure access time and type (DMI allowed, read only, etc)
  *
  * @tparam SIZE size of the memery
  * @tparam BUSWIDTH bus width of the socket
+ * @tparam STORAGE the backing store type
  */
-template <unsigned long long SIZE, unsigned BUSWIDTH = LT> class memory : public sc_core::sc_module {
+template <unsigned long long SIZE, unsigned BUSWIDTH = LT, typename STORAGE = util::sparse_array<uint8_t, SIZE>>
+class memory : public sc_core::sc_module, public checkpoint_if {
 public:
+    //! the type of this memory
+    using this_type = memory<SIZE, BUSWIDTH, STORAGE>;
+    //! the data being returned when reading memory which has not been written before
+    enum fill_type {
+        FILL_RANDOM, //!< random data (default)
+        FILL_ZERO,   //!< all bytes are zero
+        FILL_PATTERN //!< the 32bit value of fill_pattern repeated in little endian order
+    };
     //! the target socket to connect to TLM
     tlm::scc::target_mixin<tlm::tlm_target_socket<BUSWIDTH>> target{"ts"};
     /**
@@ -66,8 +126,7 @@ public:
      *
      * @param cb the callback function or functor
      */
-    void set_operation_callback(
-        std::function<int(memory<SIZE, BUSWIDTH>&, tlm::tlm_generic_payload&, sc_core::sc_time& delay)> cb) {
+    void set_operation_callback(std::function<int(this_type&, tlm::tlm_generic_payload&, sc_core::sc_time& delay)> cb) {
         operation_cb = cb;
     }
     /**
@@ -76,48 +135,275 @@ public:
      *
      * @param cb the callback function or functor
      */
-    void set_dmi_callback(std::function<int(memory<SIZE, BUSWIDTH>&, tlm::tlm_generic_payload&, tlm::tlm_dmi&)> cb) {
+    void set_dmi_callback(std::function<int(this_type&, tlm::tlm_generic_payload&, tlm::tlm_dmi&)> cb) {
         dmi_cb = cb;
     }
+    /**
+     * @fn snapshot_type snapshot()
+     * @brief take a copy-on-write snapshot of the memory content. Existing DMI pointers are invalidated as they would
+     * bypass the copy-on-write mechanism. Available if the storage supports snapshots (e.g. \ref util::sparse_array)
+     *
+     * @return the snapshot
+     */
+    template <typename S = STORAGE> typename S::snapshot_type snapshot() {
+        invalidate_dmi();
+        return mem.snapshot();
+    }
+    /**
+     * @fn void restore(const snapshot_type&)
+     * @brief restore the memory content from a snapshot, existing DMI pointers are invalidated.
+     *
+     * @param snap the snapshot
+     */
+    template <typename S = STORAGE> void restore(const typename S::snapshot_type& snap) {
+        invalidate_dmi();
+        mem.restore(snap);
+    }
+    /**
+     * @fn std::vector<uint64_t> diff(const snapshot_type&)
+     * @brief get the start addresses of all pages whose content differs from the snapshot
+     *
+     * @param snap the snapshot
+     * @return list of page addresses in ascending order
+     */
+    template <typename S = STORAGE> std::vector<uint64_t> diff(const typename S::snapshot_type& snap) const {
+        auto res = mem.diff(snap);
+        for(auto& e : res)
+            e <<= STORAGE::page_addr_width;
+        return res;
+    }
+    /**
+     * @fn bool load_binary(const std::string&, uint64_t)
+     * @brief load a raw binary file into the memory. If the storage supports it, pages being completely covered by the
+     * file are mapped (private, copy-on-write) instead of being copied
+     *
+     * @param name the file name
+     * @param addr the address to load the file to
+     * @return true if the file could be loaded
+     */
+    bool load_binary(const std::string& name, uint64_t addr = 0);
+    /**
+     * @fn bool load_elf(const std::string&, uint64_t)
+     * @brief load all loadable segments of an ELF file into the memory using the physical addresses. Pages being
+     * completely covered by segment data are mapped instead of being copied if the storage supports it
+     *
+     * @param name the file name
+     * @param offset an offset being subtracted from the segment addresses
+     * @return true if the file could be loaded
+     */
+    bool load_elf(const std::string& name, uint64_t offset = 0);
+    /**
+     * @fn bool load_ihex(const std::string&, uint64_t)
+     * @brief load an Intel HEX file into the memory
+     *
+     * @param name the file name
+     * @param offset an offset being subtracted from the record addresses
+     * @return true if the file could be loaded
+     */
+    bool load_ihex(const std::string& name, uint64_t offset = 0);
     /**
      * read response delay
      */
-    cci::cci_param<sc_core::sc_time> rd_resp_delay{"rd_resp_delay", sc_core::SC_ZERO_TIME};
+    scc::cached_cci_param<sc_core::sc_time> rd_resp_delay{"rd_resp_delay", sc_core::SC_ZERO_TIME};
     /**
      * write response delay
      */
-    cci::cci_param<sc_core::sc_time> wr_resp_delay{"wr_resp_delay", sc_core::SC_ZERO_TIME};
+    scc::cached_cci_param<sc_core::sc_time> wr_resp_delay{"wr_resp_delay", sc_core::SC_ZERO_TIME};
+    /**
+     * content of unallocated memory when being read
+     */
+    scc::cached_cci_param<unsigned> fill_mode{
+        "fill_mode", FILL_RANDOM, "Data returned when reading unallocated memory. See also scc::memory::fill_type"};
+    /**
+     * pattern used for unallocated memory if fill_mode is FILL_PATTERN
+     */
+    scc::cached_cci_param<uint32_t> fill_pattern{"fill_pattern", 0, "Pattern returned when reading unallocated memory"};
+    /**
+     * the file backing the memory content if the storage supports it
+     */
+    cci::cci_param<std::string> backing_file{"backing_file", "", "File backing the memory content (if supported)"};
+    /**
+     * enable the bank/row-buffer timing model
+     */
+    scc::cached_cci_param<bool> row_buffer_model{"row_buffer_model", false, "Enable the bank/row-buffer timing model"};
+    /**
+     * number of banks of the row-buffer timing model
+     */
+    scc::cached_cci_param<unsigned> bank_count{"bank_count", 8, "Number of banks of the timing model"};
+    /**
+     * size of a row in bytes, consecutive rows are interleaved across the banks
+     */
+    scc::cached_cci_param<unsigned> row_size{"row_size", 2048, "Size of a row in bytes"};
+    /**
+     * additional delay of an access to an open row
+     */
+    scc::cached_cci_param<sc_core::sc_time> row_hit_delay{"row_hit_delay", sc_core::SC_ZERO_TIME,
+                                                          "Additional delay of an access to an open row"};
+    /**
+     * additional delay of an access to a closed row (precharge and activate)
+     */
+    scc::cached_cci_param<sc_core::sc_time> row_miss_delay{"row_miss_delay", sc_core::SC_ZERO_TIME,
+                                                           "Additional delay of an access to a closed row"};
+    /**
+     * bandwidth limit in bytes per clock_period, 0 means unlimited
+     */
+    scc::cached_cci_param<unsigned> bytes_per_cycle{"bytes_per_cycle", 0,
+                                                    "Bandwidth limit in bytes per cycle, 0 for none"};
+    /**
+     * the clock period used for the bandwidth limit
+     */
+    scc::cached_cci_param<sc_core::sc_time> clock_period{"clock_period", sc_core::sc_time(1, sc_core::SC_NS),
+                                                         "Clock period of the bandwidth limit"};
+#ifdef SCC_MEMORY_STATISTICS
+    /**
+     * file to write the per-page access statistics to, a file name ending with .json selects JSON, otherwise CSV is
+     * written. If empty no statistics are written
+     */
+    cci::cci_param<std::string> statistics_file{"statistics_file", "",
+                                                "File the per page access statistics are written to (CSV or JSON)"};
+    //! the access statistics of a page
+    struct page_stats {
+        uint64_t rd_bytes{0};
+        uint64_t wr_bytes{0};
+        sc_core::sc_time first_access;
+        sc_core::sc_time last_access;
+    };
+    /**
+     * @fn const std::map<uint64_t, page_stats>& get_statistics()const
+     * @brief get the access statistics of all accessed pages
+     *
+     * @return map of page start address to statistics
+     */
+    const std::map<uint64_t, page_stats>& get_statistics() const { return stats; }
+#endif
+
+    void save_checkpoint(util::checkpoint_writer& w, std::string const& name, bool incremental) override {
+        save_checkpoint(w, name, incremental, detail::has_snapshot<STORAGE>());
+    }
+
+    void restore_checkpoint(util::checkpoint_reader const& r, std::string const& name, bool incremental) override {
+        restore_checkpoint(r, name, incremental, detail::has_snapshot<STORAGE>());
+    }
+
 protected:
     //! the real memory structure
-    util::sparse_array<uint8_t, SIZE> mem;
+    STORAGE mem;
+    //! copy len bytes starting at adr into ptr, the range may span an arbitrary number of pages
+    void read_data(uint64_t adr, uint8_t* ptr, unsigned len);
+    //! copy len bytes from ptr to the memory starting at adr, the range may span an arbitrary number of pages
+    void write_data(uint64_t adr, const uint8_t* ptr, unsigned len);
+    //! fill the buffer with the data returned for unallocated memory
+    void fill_data(uint64_t adr, uint8_t* ptr, uint64_t len);
+    //! load data from a mapped file into the memory, zero-copy for full pages if the storage supports it
+    void load_data(const std::shared_ptr<util::mapped_file>& f, const uint8_t* src, uint64_t addr, uint64_t len) {
+        load_data(f, src, addr, len, detail::has_set_page<STORAGE>());
+    }
+    void load_data(const std::shared_ptr<util::mapped_file>& f, const uint8_t* src, uint64_t addr, uint64_t len,
+                   std::true_type);
+    void load_data(const std::shared_ptr<util::mapped_file>&, const uint8_t* src, uint64_t addr, uint64_t len,
+                   std::false_type) {
+        copy_data(src, addr, len);
+    }
+    //! copy an arbitrary amount of data into the memory
+    void copy_data(const uint8_t* src, uint64_t addr, uint64_t len) {
+        while(len) {
+            auto chunk = static_cast<unsigned>(std::min<uint64_t>(len, 1ULL << 30));
+            write_data(addr, src, chunk);
+            addr += chunk;
+            src += chunk;
+            len -= chunk;
+        }
+    }
+#ifdef SCC_MEMORY_STATISTICS
+    //! update the statistics of all pages covered by the access
+    void record_access(uint64_t adr, unsigned len, bool write);
+    //! write the statistics
+    void end_of_simulation() override;
+    std::map<uint64_t, page_stats> stats;
+    uint64_t last_stats_page{std::numeric_limits<uint64_t>::max()};
+    page_stats* last_stats{nullptr};
+#endif
+    //! calculate the delay of an access according to the timing model
+    sc_core::sc_time access_delay(uint64_t adr, unsigned len, bool write, const sc_core::sc_time& offset);
+    //! the currently open row of each bank
+    std::vector<uint64_t> open_rows;
+    //! the point in time the data bus becomes available
+    sc_core::sc_time bus_free_time;
+    //! flag indicating a debug access which neither alters the timing model state nor the statistics
+    bool debug_access{false};
+    //! map the backing file if the storage supports it
+    void map_backing_file(std::true_type) {
+        if(backing_file.get_value().empty())
+            return;
+        mem.get_storage().file_name = backing_file.get_value();
+        try {
+            mem.data();
+        } catch(std::exception& e) {
+            SCCERR(SCMOD) << "could not map backing file " << backing_file.get_value() << ": " << e.what();
+        }
+    }
+    void map_backing_file(std::false_type) {
+        if(!backing_file.get_value().empty())
+            SCCWARN(SCMOD) << "the storage does not support a backing file, ignoring " << backing_file.get_value();
+    }
+    //! write the pages changed since the last checkpoint, all pages if not incremental
+    void save_checkpoint(util::checkpoint_writer& w, std::string const& name, bool incremental, std::true_type);
+    void save_checkpoint(util::checkpoint_writer&, std::string const&, bool, std::false_type) {
+        SCCWARN(SCMOD) << "the storage does not support checkpoints, the memory content is not saved";
+    }
+    //! map the pages of the image, pages not contained are freed if not incremental
+    void restore_checkpoint(util::checkpoint_reader const& r, std::string const& name, bool incremental,
+                            std::true_type);
+    void restore_checkpoint(util::checkpoint_reader const&, std::string const&, bool, std::false_type) {}
+    //! the snapshot of the last checkpoint saved or restored (a STORAGE::snapshot_type), the base of incremental ones
+    std::shared_ptr<void> checkpoint_snapshot;
+    //! invalidate all DMI pointers handed out
+    void invalidate_dmi() {
+        if(target.get_base_port().size())
+            target->invalidate_direct_mem_ptr(0, ::sc_dt::uint64(SIZE) - 1);
+    }
 
 public:
+    //! the blocking transport callback of the target socket
+    void b_transport(tlm::tlm_generic_payload& gp, sc_core::sc_time& delay) {
+        operation_cb ? operation_cb(*this, gp, delay) : handle_operation(gp, delay);
+    }
     //!! handle the memory operation independent on interface function used
     int handle_operation(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
     //! handle the dmi functionality
     bool handle_dmi(tlm::tlm_generic_payload& gp, tlm::tlm_dmi& dmi_data);
-    std::function<int(memory<SIZE, BUSWIDTH>&, tlm::tlm_generic_payload&, sc_core::sc_time& delay)> operation_cb;
-    std::function<int(memory<SIZE, BUSWIDTH>&, tlm::tlm_generic_payload&, tlm::tlm_dmi&)> dmi_cb;
+    std::function<int(this_type&, tlm::tlm_generic_payload&, sc_core::sc_time& delay)> operation_cb;
+    std::function<int(this_type&, tlm::tlm_generic_payload&, tlm::tlm_dmi&)> dmi_cb;
 };
 
-template <unsigned long long SIZE, unsigned BUSWIDTH>
-memory<SIZE, BUSWIDTH>::memory(const sc_core::sc_module_name& nm)
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+memory<SIZE, BUSWIDTH, STORAGE>::memory(const sc_core::sc_module_name& nm)
 : sc_module(nm) {
     // Register callback for incoming b_transport interface method call
-    target.register_b_transport([this](tlm::tlm_generic_payload& gp, sc_core::sc_time& delay) -> void {
-        operation_cb ? operation_cb(*this, gp, delay) : handle_operation(gp, delay);
-    });
+    target.template register_b_transport<this_type, &this_type::b_transport>(this);
     target.register_transport_dbg([this](tlm::tlm_generic_payload& gp) -> unsigned {
         sc_core::sc_time z = sc_core::SC_ZERO_TIME;
+        // restores the flag even if the operation throws, e.g. due to an error report
+        struct debug_access_guard {
+            bool& flag;
+            bool const prev;
+            explicit debug_access_guard(bool& flag)
+            : flag(flag)
+            , prev(flag) {
+                flag = true;
+            }
+            ~debug_access_guard() { flag = prev; }
+        } guard(debug_access);
         return operation_cb ? operation_cb(*this, gp, z) : handle_operation(gp, z);
     });
     target.register_get_direct_mem_ptr([this](tlm::tlm_generic_payload& gp, tlm::tlm_dmi& dmi_data) -> bool {
         return dmi_cb ? dmi_cb(*this, gp, dmi_data) : handle_dmi(gp, dmi_data);
     });
+    map_backing_file(detail::has_backing_file<STORAGE>());
 }
 
-template <unsigned long long SIZE, unsigned BUSWIDTH>
-int memory<SIZE, BUSWIDTH>::handle_operation(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+int memory<SIZE, BUSWIDTH, STORAGE>::handle_operation(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
     ::sc_dt::uint64 adr = trans.get_address();
     uint8_t* ptr = trans.get_data_ptr();
     unsigned len = trans.get_data_length();
@@ -149,51 +435,313 @@ int memory<SIZE, BUSWIDTH>::handle_operation(tlm::tlm_generic_payload& trans, sc
     tlm::tlm_command cmd = trans.get_command();
     SCCTRACE(SCMOD) << (cmd == tlm::TLM_READ_COMMAND ? "read" : "write") << " access to addr 0x" << std::hex << adr;
     if(cmd == tlm::TLM_READ_COMMAND) {
-        delay += rd_resp_delay;
-        if(mem.is_allocated(adr)) {
-            const auto& p = mem(adr / mem.page_size);
-            auto offs = adr & mem.page_addr_mask;
-            if((offs + len) > mem.page_size) {
-                auto first_part = mem.page_size - offs;
-                std::copy(p.data() + offs, p.data() + offs + first_part, ptr);
-                const auto& p2 = mem((adr / mem.page_size) + 1);
-                std::copy(p2.data(), p2.data() + len - first_part, ptr + first_part);
-            } else {
-                std::copy(p.data() + offs, p.data() + offs + len, ptr);
-            }
-        } else {
-            // no allocated page so return randomized data
-            for(size_t i = 0; i < len; i++)
-                ptr[i] = scc::MT19937::uniform() % 256;
-        }
+        delay += access_delay(adr, len, false, delay);
+        read_data(adr, ptr, len);
+#ifdef SCC_MEMORY_STATISTICS
+        if(!debug_access)
+            record_access(adr, len, false);
+#endif
     } else if(cmd == tlm::TLM_WRITE_COMMAND) {
-        delay += wr_resp_delay;
-        auto& p = mem(adr / mem.page_size);
-        auto offs = adr & mem.page_addr_mask;
-        if((offs + len) > mem.page_size) {
-            auto first_part = mem.page_size - offs;
-            std::copy(ptr, ptr + first_part, p.data() + offs);
-            auto& p2 = mem((adr / mem.page_size) + 1);
-            std::copy(ptr + first_part, ptr + len, p2.data());
-        } else {
-            std::copy(ptr, ptr + len, p.data() + offs);
-        }
+        delay += access_delay(adr, len, true, delay);
+        write_data(adr, ptr, len);
+#ifdef SCC_MEMORY_STATISTICS
+        if(!debug_access)
+            record_access(adr, len, true);
+#endif
     }
     trans.set_response_status(tlm::TLM_OK_RESPONSE);
     trans.set_dmi_allowed(true);
     return len;
 }
 
-template <unsigned long long SIZE, unsigned BUSWIDTH>
-inline bool memory<SIZE, BUSWIDTH>::handle_dmi(tlm::tlm_generic_payload& gp, tlm::tlm_dmi& dmi_data) {
-    auto& p = mem(gp.get_address() / mem.page_size);
-    dmi_data.set_start_address(gp.get_address() & ~mem.page_addr_mask);
-    // TODO: fix to provide the correct end address
-    dmi_data.set_end_address(dmi_data.get_start_address() + mem.page_size - 1);
-    dmi_data.set_dmi_ptr(p.data());
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+inline sc_core::sc_time memory<SIZE, BUSWIDTH, STORAGE>::access_delay(uint64_t adr, unsigned len, bool write,
+                                                                      const sc_core::sc_time& offset) {
+    auto ret = write ? wr_resp_delay.get_value() : rd_resp_delay.get_value();
+    if(!row_buffer_model.get_value() || debug_access)
+        return ret;
+    auto banks = std::max(1U, bank_count.get_value());
+    auto row = adr / std::max(1U, row_size.get_value());
+    if(open_rows.size() != banks)
+        open_rows.assign(banks, std::numeric_limits<uint64_t>::max());
+    auto& open_row = open_rows[row % banks];
+    if(open_row == row)
+        ret += row_hit_delay.get_value();
+    else {
+        ret += row_miss_delay.get_value();
+        open_row = row;
+    }
+    if(auto bpc = bytes_per_cycle.get_value()) {
+        // the data transfer starts once the latency elapsed and the data bus is free
+        auto start = sc_core::sc_time_stamp() + offset + ret;
+        if(bus_free_time > start) {
+            ret += bus_free_time - start;
+            start = bus_free_time;
+        }
+        auto transfer = clock_period.get_value() * static_cast<double>((len + bpc - 1) / bpc);
+        bus_free_time = start + transfer;
+        ret += transfer;
+    }
+    return ret;
+}
+
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+inline void memory<SIZE, BUSWIDTH, STORAGE>::read_data(uint64_t adr, uint8_t* ptr, unsigned len) {
+    SCC_SPAN("memory.read");
+    while(len) {
+        auto offs = adr & STORAGE::page_addr_mask;
+        auto chunk = static_cast<unsigned>(std::min<uint64_t>(len, STORAGE::page_size - offs));
+        if(mem.is_allocated(adr))
+            std::memcpy(ptr, static_cast<const STORAGE&>(mem)(adr >> STORAGE::page_addr_width).data() + offs, chunk);
+        else
+            fill_data(adr, ptr, chunk);
+        adr += chunk;
+        ptr += chunk;
+        len -= chunk;
+    }
+}
+
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+inline void memory<SIZE, BUSWIDTH, STORAGE>::write_data(uint64_t adr, const uint8_t* ptr, unsigned len) {
+    SCC_SPAN("memory.write");
+    while(len) {
+        auto offs = adr & STORAGE::page_addr_mask;
+        auto chunk = static_cast<unsigned>(std::min<uint64_t>(len, STORAGE::page_size - offs));
+        std::memcpy(mem(adr >> STORAGE::page_addr_width).data() + offs, ptr, chunk);
+        adr += chunk;
+        ptr += chunk;
+        len -= chunk;
+    }
+}
+
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+inline void memory<SIZE, BUSWIDTH, STORAGE>::fill_data(uint64_t adr, uint8_t* ptr, uint64_t len) {
+    switch(fill_mode.get_value()) {
+    case FILL_ZERO:
+        std::memset(ptr, 0, len);
+        break;
+    case FILL_PATTERN: {
+        uint32_t pattern = fill_pattern.get_value();
+        for(uint64_t i = 0; i < len; ++i)
+            ptr[i] = static_cast<uint8_t>(pattern >> (8 * ((adr + i) & 3)));
+    } break;
+    default:
+        // use all bytes of each random number
+        scc::MT19937::fill(ptr, len);
+        break;
+    }
+}
+
+#ifdef SCC_MEMORY_STATISTICS
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+inline void memory<SIZE, BUSWIDTH, STORAGE>::record_access(uint64_t adr, unsigned len, bool write) {
+    auto now = sc_core::sc_time_stamp();
+    while(len) {
+        auto page = adr >> STORAGE::page_addr_width;
+        auto offs = adr & STORAGE::page_addr_mask;
+        auto chunk = static_cast<unsigned>(std::min<uint64_t>(len, STORAGE::page_size - offs));
+        if(page != last_stats_page) {
+            auto it = stats.find(page << STORAGE::page_addr_width);
+            if(it == stats.end()) {
+                it = stats.emplace(page << STORAGE::page_addr_width, page_stats()).first;
+                it->second.first_access = now;
+            }
+            last_stats_page = page;
+            last_stats = &it->second;
+        }
+        (write ? last_stats->wr_bytes : last_stats->rd_bytes) += chunk;
+        last_stats->last_access = now;
+        adr += chunk;
+        len -= chunk;
+    }
+}
+
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+void memory<SIZE, BUSWIDTH, STORAGE>::end_of_simulation() {
+    auto const& fname = statistics_file.get_value();
+    if(fname.empty())
+        return;
+    std::ofstream os(fname);
+    if(!os) {
+        SCCERR(SCMOD) << "could not open statistics file " << fname;
+        return;
+    }
+    auto json = fname.size() > 5 && fname.substr(fname.size() - 5) == ".json";
+    if(json)
+        os << "{\"memory\": \"" << this->name() << "\", \"page_size\": " << STORAGE::page_size << ", \"pages\": [";
+    else
+        os << "address,read_bytes,write_bytes,first_access_ps,last_access_ps\n";
+    auto first = true;
+    for(auto& e : stats) {
+        auto first_ps = static_cast<uint64_t>(e.second.first_access.to_seconds() * 1e12);
+        auto last_ps = static_cast<uint64_t>(e.second.last_access.to_seconds() * 1e12);
+        if(json) {
+            os << (first ? "" : ",") << "\n  {\"address\": " << e.first << ", \"read_bytes\": " << e.second.rd_bytes
+               << ", \"write_bytes\": " << e.second.wr_bytes << ", \"first_access_ps\": " << first_ps
+               << ", \"last_access_ps\": " << last_ps << "}";
+        } else
+            os << "0x" << std::hex << e.first << std::dec << "," << e.second.rd_bytes << "," << e.second.wr_bytes << ","
+               << first_ps << "," << last_ps << "\n";
+        first = false;
+    }
+    if(json)
+        os << "\n]}\n";
+}
+#endif
+
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+inline void memory<SIZE, BUSWIDTH, STORAGE>::load_data(const std::shared_ptr<util::mapped_file>& f, const uint8_t* src,
+                                                       uint64_t addr, uint64_t len, std::true_type) {
+    using page_type = typename STORAGE::page_type;
+    while(len) {
+        auto offs = addr & STORAGE::page_addr_mask;
+        auto chunk = std::min<uint64_t>(len, STORAGE::page_size - offs);
+        if(chunk == STORAGE::page_size) {
+            // share the mapped region as page, its lifetime is bound to the mapping
+            auto* page = reinterpret_cast<page_type*>(const_cast<uint8_t*>(src));
+            mem.set_page(addr >> STORAGE::page_addr_width, std::shared_ptr<page_type>(f, page));
+        } else
+            copy_data(src, addr, chunk);
+        addr += chunk;
+        src += chunk;
+        len -= chunk;
+    }
+}
+
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+inline void memory<SIZE, BUSWIDTH, STORAGE>::save_checkpoint(util::checkpoint_writer& w, std::string const& name,
+                                                             bool incremental, std::true_type) {
+    using snapshot_type = typename STORAGE::snapshot_type;
+    invalidate_dmi();
+    auto snap = std::make_shared<snapshot_type>(mem.snapshot());
+    // the diff to an empty snapshot yields all allocated pages
+    snapshot_type empty;
+    auto* base = incremental ? static_cast<snapshot_type*>(checkpoint_snapshot.get()) : nullptr;
+    auto pages = mem.diff(base ? *base : empty);
+    STORAGE const& cmem = mem;
+    for(auto page_nr : pages)
+        if(mem.is_allocated(page_nr << STORAGE::page_addr_width))
+            w.add(name, page_nr, cmem(page_nr).data(), sizeof(typename STORAGE::page_type), true);
+    checkpoint_snapshot = snap;
+}
+
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+inline void memory<SIZE, BUSWIDTH, STORAGE>::restore_checkpoint(util::checkpoint_reader const& r,
+                                                                std::string const& name, bool incremental,
+                                                                std::true_type) {
+    using snapshot_type = typename STORAGE::snapshot_type;
+    invalidate_dmi();
+    if(!incremental)
+        mem.restore(snapshot_type());
+    for(auto& rec : r.get(name))
+        if(rec.key < STORAGE::page_count && rec.size == sizeof(typename STORAGE::page_type))
+            load_data(r.get_file(), rec.data, rec.key << STORAGE::page_addr_width, rec.size);
+        else
+            SCCWARN(SCMOD) << "ignoring the malformed page " << rec.key << " of the checkpoint";
+    checkpoint_snapshot = std::make_shared<snapshot_type>(mem.snapshot());
+}
+
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+bool memory<SIZE, BUSWIDTH, STORAGE>::load_binary(const std::string& name, uint64_t addr) {
+    try {
+        auto f = std::make_shared<util::mapped_file>(name);
+        if(addr + f->size() > ::sc_dt::uint64(SIZE)) {
+            SCCERR(SCMOD) << "file " << name << " exceeds memory size";
+            return false;
+        }
+        invalidate_dmi();
+        load_data(f, f->data(), addr, f->size());
+        return true;
+    } catch(std::exception& e) {
+        SCCERR(SCMOD) << "could not load " << name << ": " << e.what();
+        return false;
+    }
+}
+
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+bool memory<SIZE, BUSWIDTH, STORAGE>::load_elf(const std::string& name, uint64_t offset) {
+    try {
+        auto f = std::make_shared<util::mapped_file>(name);
+        auto segments = util::elf_segments(f->data(), f->size());
+        invalidate_dmi();
+        for(auto& seg : segments) {
+            auto addr = seg.addr - offset;
+            if(seg.addr < offset || addr + seg.mem_size > ::sc_dt::uint64(SIZE)) {
+                SCCERR(SCMOD) << "segment at 0x" << std::hex << seg.addr << " of " << name << " exceeds memory";
+                return false;
+            }
+            load_data(f, f->data() + seg.offset, addr, seg.file_size);
+            if(seg.mem_size > seg.file_size) {
+                // zero-initialize the remainder of the segment (e.g. .bss)
+                std::vector<uint8_t> zeros(std::min<uint64_t>(seg.mem_size - seg.file_size, STORAGE::page_size));
+                for(auto a = addr + seg.file_size; a < addr + seg.mem_size; a += zeros.size())
+                    copy_data(zeros.data(), a, std::min<uint64_t>(zeros.size(), addr + seg.mem_size - a));
+            }
+        }
+        return true;
+    } catch(std::exception& e) {
+        SCCERR(SCMOD) << "could not load " << name << ": " << e.what();
+        return false;
+    }
+}
+
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+bool memory<SIZE, BUSWIDTH, STORAGE>::load_ihex(const std::string& name, uint64_t offset) {
+    std::ifstream is(name);
+    if(!is) {
+        SCCERR(SCMOD) << "could not open " << name;
+        return false;
+    }
+    try {
+        invalidate_dmi();
+        util::parse_ihex(is, [this, offset](uint64_t addr, const uint8_t* data, uint64_t len) {
+            if(addr < offset || addr - offset + len > ::sc_dt::uint64(SIZE))
+                throw std::runtime_error("record exceeds memory");
+            copy_data(data, addr - offset, len);
+        });
+        return true;
+    } catch(std::exception& e) {
+        SCCERR(SCMOD) << "could not load " << name << ": " << e.what();
+        return false;
+    }
+}
+
+template <unsigned long long SIZE, unsigned BUSWIDTH, typename STORAGE>
+inline bool memory<SIZE, BUSWIDTH, STORAGE>::handle_dmi(tlm::tlm_generic_payload& gp, tlm::tlm_dmi& dmi_data) {
+    auto adr = gp.get_address();
+    if(adr >= ::sc_dt::uint64(SIZE)) {
+        // deny DMI for the range above the memory
+        dmi_data.set_start_address(::sc_dt::uint64(SIZE));
+        dmi_data.set_end_address(std::numeric_limits<::sc_dt::uint64>::max());
+        dmi_data.set_granted_access(tlm::tlm_dmi::DMI_ACCESS_NONE);
+        return false;
+    }
+    if(STORAGE::is_contiguous) {
+        dmi_data.set_start_address(0);
+        dmi_data.set_end_address(::sc_dt::uint64(SIZE) - 1);
+        dmi_data.set_dmi_ptr(mem(0).data());
+    } else {
+        auto& p = mem(adr / mem.page_size);
+        auto start = adr & ~::sc_dt::uint64(mem.page_addr_mask);
+        dmi_data.set_start_address(start);
+        dmi_data.set_end_address(std::min<::sc_dt::uint64>(start + mem.page_size, SIZE) - 1);
+        dmi_data.set_dmi_ptr(p.data());
+    }
     dmi_data.set_granted_access(tlm::tlm_dmi::DMI_ACCESS_READ_WRITE);
-    dmi_data.set_read_latency(rd_resp_delay.get_value());
-    dmi_data.set_write_latency(wr_resp_delay.get_value());
+    // DMI users are assumed to access consecutive data, so the row-hit latency and the transfer of a bus word apply
+    auto rd_lat = rd_resp_delay.get_value();
+    auto wr_lat = wr_resp_delay.get_value();
+    if(row_buffer_model.get_value()) {
+        auto word_time = sc_core::SC_ZERO_TIME;
+        if(auto bpc = bytes_per_cycle.get_value()) {
+            auto word_size = std::max(1U, BUSWIDTH / 8);
+            word_time = clock_period.get_value() * static_cast<double>((word_size + bpc - 1) / bpc);
+        }
+        rd_lat += row_hit_delay.get_value() + word_time;
+        wr_lat += row_hit_delay.get_value() + word_time;
+    }
+    dmi_data.set_read_latency(rd_lat);
+    dmi_data.set_write_latency(wr_lat);
     return true;
 }
 
@@ -0,0 +1,298 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_PARTITION_BRIDGE_H_
+#define _SCC_PARTITION_BRIDGE_H_
+
+#include <cstring>
+#include <scc/partition_link.h>
+#include <scc/peq.h>
+#include <scc/report.h>
+#include <scc/utilities.h>
+#include <tlm.h>
+#include <tlm/scc/initiator_mixin.h>
+#include <tlm/scc/target_mixin.h>
+#include <tlm/scc/tlm_signal_gp.h>
+#include <tlm/scc/tlm_signal_sockets.h>
+#include <type_traits>
+#include <vector>
+
+namespace scc {
+namespace detail {
+//! the attributes of a generic payload sent over a partition_link, followed by the data and the byte enables
+struct partition_gp_header {
+    uint64_t address;
+    uint32_t length;
+    uint32_t byte_enable_length;
+    uint32_t streaming_width;
+    uint8_t command;
+    uint8_t debug;
+    int8_t response;
+    uint8_t dmi_allowed;
+};
+
+inline void append(std::vector<uint8_t>& buf, void const* data, size_t size) {
+    auto* p = static_cast<uint8_t const*>(data);
+    buf.insert(buf.end(), p, p + size);
+}
+} // namespace detail
+/**
+ * @class partition_target
+ * @brief the local end of a bus towards a subsystem simulated in another process
+ *
+ * Transactions received by the target socket are sent over the partition_link to the partition_initiator with the same
+ * channel name in the other process which issues them there, the kernel waits for the response. The transactions are
+ * loosely timed: they are executed when the other process receives them, which is at most a lookahead of the link
+ * away from the time of the request. The annotated delay of the response covers the time until completion. Non-blocking
+ * transactions are converted to blocking ones by the target_mixin, DMI is not supported.
+ *
+ * @tparam BUSWIDTH the width of the bus
+ */
+template <unsigned BUSWIDTH = LT> class partition_target : public sc_core::sc_module {
+public:
+    tlm::scc::target_mixin<tlm::tlm_target_socket<BUSWIDTH>> target{"target"};
+    /**
+     * @param nm the instance name
+     * @param link the link to the other process
+     * @param channel the name of the channel, the partition_initiator in the other process uses the same name
+     */
+    partition_target(sc_core::sc_module_name const& nm, partition_link& link, std::string const& channel)
+    : sc_core::sc_module(nm)
+    , link(link)
+    , channel(partition_link::channel_id(channel)) {
+        target.template register_b_transport<partition_target, &partition_target::b_transport>(this);
+        target.register_transport_dbg([this](tlm::tlm_generic_payload& gp) -> unsigned {
+            sc_core::sc_time delay;
+            forward(gp, delay, true);
+            return gp.is_response_ok() ? gp.get_data_length() : 0;
+        });
+    }
+
+private:
+    void b_transport(tlm::tlm_generic_payload& gp, sc_core::sc_time& delay) { forward(gp, delay, false); }
+
+    void forward(tlm::tlm_generic_payload& gp, sc_core::sc_time& delay, bool debug) {
+        detail::partition_gp_header hdr{gp.get_address(),
+                                        gp.get_data_length(),
+                                        gp.get_byte_enable_ptr() ? gp.get_byte_enable_length() : 0,
+                                        gp.get_streaming_width(),
+                                        static_cast<uint8_t>(gp.get_command()),
+                                        debug,
+                                        static_cast<int8_t>(gp.get_response_status()),
+                                        0};
+        partition_link::message msg;
+        msg.type = partition_link::REQUEST;
+        msg.channel = channel;
+        msg.tag = link.next_tag();
+        msg.time = sc_core::sc_time_stamp() + delay;
+        msg.data.reserve(sizeof(hdr) + hdr.length + hdr.byte_enable_length);
+        detail::append(msg.data, &hdr, sizeof(hdr));
+        if(gp.is_write())
+            detail::append(msg.data, gp.get_data_ptr(), hdr.length);
+        if(hdr.byte_enable_length)
+            detail::append(msg.data, gp.get_byte_enable_ptr(), hdr.byte_enable_length);
+        link.send(msg);
+        auto rsp = link.wait_response(msg.tag);
+        if(rsp.data.size() < sizeof(hdr)) {
+            gp.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+            return;
+        }
+        std::memcpy(&hdr, rsp.data.data(), sizeof(hdr));
+        gp.set_response_status(static_cast<tlm::tlm_response_status>(hdr.response));
+        if(gp.is_read() && rsp.data.size() >= sizeof(hdr) + gp.get_data_length())
+            std::memcpy(gp.get_data_ptr(), rsp.data.data() + sizeof(hdr), gp.get_data_length());
+        auto now = sc_core::sc_time_stamp();
+        if(!debug && rsp.time > now + delay)
+            delay = rsp.time - now;
+    }
+
+    partition_link& link;
+    const uint32_t channel;
+};
+/**
+ * @class partition_initiator
+ * @brief issues the transactions received from a partition_target in another process
+ *
+ * @tparam BUSWIDTH the width of the bus
+ */
+template <unsigned BUSWIDTH = LT> class partition_initiator : public sc_core::sc_module {
+public:
+    tlm::scc::initiator_mixin<tlm::tlm_initiator_socket<BUSWIDTH>> isck{"isck"};
+    /**
+     * @param nm the instance name
+     * @param link the link to the other process
+     * @param channel the name of the channel, the partition_target in the other process uses the same name
+     */
+    partition_initiator(sc_core::sc_module_name const& nm, partition_link& link, std::string const& channel)
+    : sc_core::sc_module(nm)
+    , link(link) {
+        link.add_channel(channel, [this](partition_link::message& msg) { handle(msg); });
+    }
+
+private:
+    void handle(partition_link::message& msg) {
+        detail::partition_gp_header hdr;
+        if(msg.data.size() < sizeof(hdr)) {
+            SCCERR(SCMOD) << "received a malformed request";
+            return;
+        }
+        std::memcpy(&hdr, msg.data.data(), sizeof(hdr));
+        auto cmd = static_cast<tlm::tlm_command>(hdr.command);
+        auto* payload = msg.data.data() + sizeof(hdr);
+        // local buffers as requests may arrive nested while this one waits for a response of the other process
+        std::vector<uint8_t> data(hdr.length), byte_enables;
+        if(cmd == tlm::TLM_WRITE_COMMAND) {
+            std::memcpy(data.data(), payload, hdr.length);
+            payload += hdr.length;
+        }
+        tlm::tlm_generic_payload gp;
+        gp.set_command(cmd);
+        gp.set_address(hdr.address);
+        gp.set_data_ptr(data.data());
+        gp.set_data_length(hdr.length);
+        gp.set_streaming_width(hdr.streaming_width);
+        gp.set_response_status(static_cast<tlm::tlm_response_status>(hdr.response));
+        if(hdr.byte_enable_length) {
+            byte_enables.assign(payload, payload + hdr.byte_enable_length);
+            gp.set_byte_enable_ptr(byte_enables.data());
+            gp.set_byte_enable_length(hdr.byte_enable_length);
+        }
+        auto now = sc_core::sc_time_stamp();
+        sc_core::sc_time delay = msg.time > now ? msg.time - now : sc_core::SC_ZERO_TIME;
+        if(hdr.debug)
+            isck->transport_dbg(gp);
+        else
+            isck->b_transport(gp, delay);
+        hdr.response = static_cast<int8_t>(gp.get_response_status());
+        partition_link::message rsp;
+        rsp.type = partition_link::RESPONSE;
+        rsp.channel = msg.channel;
+        rsp.tag = msg.tag;
+        rsp.time = sc_core::sc_time_stamp() + delay;
+        detail::append(rsp.data, &hdr, sizeof(hdr));
+        if(cmd == tlm::TLM_READ_COMMAND)
+            detail::append(rsp.data, data.data(), hdr.length);
+        gp.set_data_ptr(nullptr);
+        gp.set_byte_enable_ptr(nullptr);
+        link.send(rsp);
+    }
+
+    partition_link& link;
+};
+/**
+ * @class partition_signal_out
+ * @brief sends the values of a tlm_signal to a partition_signal_in in another process
+ *
+ * The values arrive a lookahead of the link later than they were sent, this keeps the signals conservatively
+ * synchronized. The lookahead therefore needs to be smaller than the latency the signals may get.
+ *
+ * @tparam SIG the trivially copyable type of the signal
+ */
+template <typename SIG = bool>
+class partition_signal_out
+: public sc_core::sc_module,
+  public tlm::scc::tlm_signal_fw_transport_if<SIG, tlm::scc::tlm_signal_baseprotocol_types<SIG>> {
+    static_assert(std::is_trivially_copyable<SIG>::value, "the signal type needs to be trivially copyable");
+
+public:
+    using protocol_types = tlm::scc::tlm_signal_baseprotocol_types<SIG>;
+    using payload_type = typename protocol_types::tlm_payload_type;
+    using phase_type = typename protocol_types::tlm_phase_type;
+
+    tlm::scc::tlm_signal_target_socket<SIG> t_i{"t_i"};
+
+    partition_signal_out(sc_core::sc_module_name const& nm, partition_link& link, std::string const& channel)
+    : sc_core::sc_module(nm)
+    , link(link)
+    , channel(partition_link::channel_id(channel)) {
+        t_i.bind(*this);
+    }
+
+private:
+    tlm::tlm_sync_enum nb_transport_fw(payload_type& gp, phase_type& phase, sc_core::sc_time& delay) override {
+        partition_link::message msg;
+        msg.type = partition_link::SIGNAL;
+        msg.channel = channel;
+        msg.time = sc_core::sc_time_stamp() + delay + link.get_lookahead();
+        auto value = gp.get_value();
+        detail::append(msg.data, &value, sizeof(value));
+        link.send(msg);
+        return tlm::TLM_COMPLETED;
+    }
+
+    partition_link& link;
+    const uint32_t channel;
+};
+/**
+ * @class partition_signal_in
+ * @brief drives the values received from a partition_signal_out in another process onto a tlm_signal
+ *
+ * @tparam SIG the trivially copyable type of the signal
+ */
+template <typename SIG = bool>
+class partition_signal_in
+: public sc_core::sc_module,
+  public tlm::scc::tlm_signal_bw_transport_if<SIG, tlm::scc::tlm_signal_baseprotocol_types<SIG>> {
+    static_assert(std::is_trivially_copyable<SIG>::value, "the signal type needs to be trivially copyable");
+
+public:
+    using protocol_types = tlm::scc::tlm_signal_baseprotocol_types<SIG>;
+    using payload_type = typename protocol_types::tlm_payload_type;
+    using phase_type = typename protocol_types::tlm_phase_type;
+
+    SC_HAS_PROCESS(partition_signal_in); // NOLINT
+
+    tlm::scc::tlm_signal_initiator_socket<SIG> t_o{"t_o"};
+
+    partition_signal_in(sc_core::sc_module_name const& nm, partition_link& link, std::string const& channel)
+    : sc_core::sc_module(nm) {
+        t_o.bind(*this);
+        link.add_channel(channel, [this](partition_link::message& msg) {
+            SIG value;
+            if(msg.data.size() != sizeof(value)) {
+                SCCERR(SCMOD) << "received a malformed signal value";
+                return;
+            }
+            std::memcpy(&value, msg.data.data(), sizeof(value));
+            auto now = sc_core::sc_time_stamp();
+            que.notify(value, msg.time > now ? msg.time - now : sc_core::SC_ZERO_TIME);
+        });
+        SC_METHOD(que_cb);
+        sensitive << que.event();
+        dont_initialize();
+    }
+
+private:
+    tlm::tlm_sync_enum nb_transport_bw(payload_type& gp, phase_type& phase, sc_core::sc_time& delay) override {
+        return tlm::TLM_COMPLETED;
+    }
+
+    void que_cb() {
+        que.drain([this](SIG&& v) {
+            tlm::tlm_phase phase(tlm::BEGIN_REQ);
+            sc_core::sc_time delay;
+            auto* gp = payload_type::create();
+            gp->acquire();
+            gp->set_value(v);
+            t_o->nb_transport_fw(*gp, phase, delay);
+            gp->release();
+        });
+    }
+
+    scc::peq<SIG> que;
+};
+} // namespace scc
+#endif /* _SCC_PARTITION_BRIDGE_H_ */
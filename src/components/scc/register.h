@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016-2021 MINRES Technologies GmbH
+ * Copyright 2016-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -21,16 +21,15 @@
 
 #include "resetable.h"
 #include "resource_access_if.h"
+#include "resource_profile.h"
+#include "scc/observer.h"
 #include "scc/traceable.h"
 #include "scc/utilities.h"
-#ifdef _MSC_VER
-#include <functional>
-#else
 #include "util/delegate.h"
-#endif
 #include <functional>
 #include <limits>
 #include <sstream>
+#include <vector>
 
 namespace scc {
 
@@ -92,7 +91,11 @@ public:
     , res_val(reset_val)
     , rdmask(rdmask)
     , wrmask(wrmask)
-    , storage(storage) {
+    , storage(storage)
+#ifdef SCC_REGISTER_PROFILING
+    , profile(this->name())
+#endif
+    {
         owner.register_resource(this);
     }
     /**
@@ -116,10 +119,12 @@ public:
     void reset() override {
         DATATYPE r(res_val);
         if(wr_cb){
+            SCC_REGISTER_PROFILE_CALLBACK(profile, true);
             sc_core::sc_time d;
             wr_cb(*this, r, d);
         }   
         storage = r;
+        notify_observers();
     }
     /**
      * @fn bool write(const uint8_t*, size_t, uint64_t=0, sc_core::sc_time=sc_core::SC_ZERO_TIME)
@@ -134,12 +139,19 @@ public:
      */
     bool write(const uint8_t* data, size_t length, uint64_t offset, sc_core::sc_time& d) override {
         assert("Access out of range" && offset + length <= sizeof(DATATYPE));
+        SCC_REGISTER_PROFILE_ACCESS(profile, writes);
         auto temp(storage);
         auto beg = reinterpret_cast<uint8_t*>(&temp) + offset;
         std::copy(data, data + length, beg);
-        if(wr_cb)
-            return wr_cb(*this, temp, d);
+        if(wr_cb) {
+            SCC_REGISTER_PROFILE_CALLBACK(profile, true);
+            // the callback may update the storage directly
+            auto res = wr_cb(*this, temp, d);
+            notify_observers();
+            return res;
+        }
         storage = (temp & wrmask) | (storage & ~wrmask);
+        notify_observers();
         return true;
     }
     /**
@@ -155,8 +167,10 @@ public:
      */
     bool read(uint8_t* data, size_t length, uint64_t offset, sc_core::sc_time& d) const override {
         assert("Access out of range" && offset + length <= sizeof(DATATYPE));
+        SCC_REGISTER_PROFILE_ACCESS(profile, reads);
         auto temp(storage);
         if(rd_cb) {
+            SCC_REGISTER_PROFILE_CALLBACK(profile, true);
             if(!rd_cb(*this, temp, d))
                 return false;
         } else
@@ -181,6 +195,7 @@ public:
         if(length != sizeof(DATATYPE))
             return false;
         storage = *reinterpret_cast<const DATATYPE*>(data);
+        notify_observers();
         return true;
     }
     /**
@@ -220,7 +235,10 @@ public:
      *
      * @param data the new value
      */
-    void put(DATATYPE data) const { storage = data; }
+    void put(DATATYPE data) const {
+        storage = data;
+        notify_observers();
+    }
     /**
      * @fn this_type& operator =(DATATYPE)
      * @brief assignment operator
@@ -230,6 +248,7 @@ public:
      */
     this_type& operator=(DATATYPE other) {
         storage = other;
+        notify_observers();
         return *this;
     }
     /**
@@ -241,6 +260,7 @@ public:
      */
     this_type& operator|=(DATATYPE other) {
         storage |= other;
+        notify_observers();
         return *this;
     }
     /**
@@ -252,62 +272,160 @@ public:
      */
     this_type& operator&=(DATATYPE other) {
         storage &= other;
+        notify_observers();
         return *this;
     }
     /**
-     * @fn void set_read_cb(std::function<bool (const this_type&, DATATYPE&)>)
+     * @fn void set_read_cb(F&&)
      * @brief set the read callback
      *
-     * The read callback is triggered upon a read request without forwarding the annotated time
-     * this is primary for backward compatibility
+     * The read callback functor is triggered upon a read request. It has the signature
+     * `bool(const this_type&, DATATYPE&, sc_core::sc_time&)` or, for backward compatibility, without the annotated
+     * time. The functor is stored as is in a delegate so a call takes a single indirection. Passing a delegate created
+     * using util::delegate::from<C, &C::method>(obj) avoids any allocation.
      *
-     * @param read_cb the callback functor
+     * @param read_cb the callback functor, an empty one removes the callback
      */
-    void set_read_cb(std::function<bool(const this_type&, DATATYPE&)> read_cb) {
-        rd_cb = [read_cb](const this_type& reg, DATATYPE& data, sc_core::sc_time& delay) { return read_cb(reg, data); };
+    template <typename F>
+    auto set_read_cb(F&& read_cb) -> decltype(read_cb(std::declval<const this_type&>(), std::declval<DATATYPE&>(),
+                                                      std::declval<sc_core::sc_time&>()),
+                                              void()) {
+        if(util::is_empty_callable(read_cb))
+            rd_cb = read_cb_type();
+        else
+            rd_cb = std::forward<F>(read_cb);
+        callbacks_changed();
+    }
+    template <typename F>
+    auto set_read_cb(F&& read_cb)
+        -> decltype(read_cb(std::declval<const this_type&>(), std::declval<DATATYPE&>()), void()) {
+        if(util::is_empty_callable(read_cb))
+            rd_cb = read_cb_type();
+        else
+            rd_cb = untimed_cb<typename std::decay<F>::type>{std::forward<F>(read_cb)};
+        callbacks_changed();
+    }
+    //! remove the read callback
+    void set_read_cb(std::nullptr_t) {
+        rd_cb = read_cb_type();
+        callbacks_changed();
     }
     /**
-     * @fn void set_read_cb(std::function<bool (const this_type&, DATATYPE&, sc_core::sc_time)>)
-     * @brief set the read callback
+     * @fn void set_write_cb(F&&)
+     * @brief set the write callback
      *
-     * The read callback functor triggered upon a read request.
+     * The write callback functor is triggered upon a write request. It has the signature
+     * `bool(this_type&, const DATATYPE&, sc_core::sc_time&)` or, for backward compatibility, without the annotated
+     * time. The functor is stored as is in a delegate so a call takes a single indirection.
      *
-     * @param read_cb the callback functor
+     * @param write_cb the callback functor, an empty one removes the callback
      */
-    void set_read_cb(std::function<bool(const this_type&, DATATYPE&, sc_core::sc_time&)> read_cb) { rd_cb = read_cb; }
+    template <typename F>
+    auto set_write_cb(F&& write_cb) -> decltype(write_cb(std::declval<this_type&>(), std::declval<const DATATYPE&>(),
+                                                         std::declval<sc_core::sc_time&>()),
+                                                void()) {
+        if(util::is_empty_callable(write_cb))
+            wr_cb = write_cb_type();
+        else
+            wr_cb = std::forward<F>(write_cb);
+        callbacks_changed();
+    }
+    template <typename F>
+    auto set_write_cb(F&& write_cb)
+        -> decltype(write_cb(std::declval<this_type&>(), std::declval<const DATATYPE&>()), void()) {
+        if(util::is_empty_callable(write_cb))
+            wr_cb = write_cb_type();
+        else
+            wr_cb = untimed_cb<typename std::decay<F>::type>{std::forward<F>(write_cb)};
+        callbacks_changed();
+    }
+    //! remove the write callback
+    void set_write_cb(std::nullptr_t) {
+        wr_cb = write_cb_type();
+        callbacks_changed();
+    }
     /**
-     * @fn void set_write_cb(std::function<bool (this_type&, const DATATYPE&)>)
-     * @brief set the write callback
+     * @fn uint8_t* get_dmi_ptr(bool)
+     * @brief get the storage for direct accesses, only possible if there are no callbacks and masks, no observers
+     * for writes and no access profiling
      *
-     * The write callback functor is triggered upon a write request without forwarding the annotated time
-     * this is primary for backward compatibility
-     *
-     * @param write_cb the callback functor
+     * @param write if true direct writes need to be possible as well
+     * @return the pointer to the storage or nullptr
      */
-    void set_write_cb(std::function<bool(this_type&, const DATATYPE&)> write_cb) {
-        wr_cb = [write_cb](this_type& reg, DATATYPE& data, sc_core::sc_time& delay) { return write_cb(reg, data); };
+    uint8_t* get_dmi_ptr(bool write) override {
+#ifdef SCC_REGISTER_PROFILING
+        // the accesses are counted so they need to go through read() and write()
+        (void)write;
+        return nullptr;
+#else
+        if(rd_cb || rdmask != get_max_uval<DATATYPE>())
+            return nullptr;
+        // the observers are notified by write() only
+        if(write && (wr_cb || !hndl.empty() || wrmask != get_max_uval<DATATYPE>()))
+            return nullptr;
+        return reinterpret_cast<uint8_t*>(&storage);
+#endif
     }
     /**
-     * @fn void set_write_cb(std::function<bool (this_type&, const DATATYPE&, sc_core::sc_time)>)
-     * @brief set the write callback
+     * @fn void set_dmi_invalidate_cb(std::function<void()>)
+     * @brief set the function called when a callback or an observer is registered
      *
-     * The write callback functor is triggered upon a write request.
+     * @param cb the callback functor
+     */
+    void set_dmi_invalidate_cb(std::function<void()> cb) override { dmi_invalidate_cb = cb; }
+    /**
+     * @fn uint8_t* get_reset_storage(const uint8_t*&)
+     * @brief get the storage and the reset value for resetting by a copy, only possible if there is no write callback
+     * and no observer to notify
      *
-     * @param write_cb the callback functor
+     * @param reset_value set to the reset value
+     * @return the pointer to the storage or nullptr
      */
+    uint8_t* get_reset_storage(const uint8_t*& reset_value) override {
+        if(wr_cb || !hndl.empty())
+            return nullptr;
+        reset_value = reinterpret_cast<const uint8_t*>(&res_val);
+        return reinterpret_cast<uint8_t*>(&storage);
+    }
     /**
-     * set the write callback triggered upon a write request
+     * @fn void set_reset_invalidate_cb(std::function<void()>)
+     * @brief set the function called when a write callback or an observer is added
      *
-     * @param write_cb
+     * @param cb the callback functor
      */
-    void set_write_cb(std::function<bool(this_type&, const DATATYPE&, sc_core::sc_time&)> write_cb) { wr_cb = write_cb; }
+    void set_reset_invalidate_cb(std::function<void()> cb) override { reset_invalidate_cb = cb; }
+#ifdef SCC_REGISTER_PROFILING
+    //! get the access counters
+    const resource_profile* get_profile() const override { return &profile; }
+#endif
     /**
      * @fn void trace(sc_core::sc_trace_file*)const
      * @brief trace the register value to the given trace file
      *
      * @param trf the trace file
      */
-    void trace(sc_core::sc_trace_file* trf) const override { sc_core::sc_trace(trf, storage, this->name()); }
+    void trace(sc_core::sc_trace_file* trf) const override {
+        if(trace_on_change)
+            if(auto* obs = dynamic_cast<observer*>(trf))
+                if(auto* h = observe_storage(obs, storage, this->name(), 0)) {
+                    hndl.push_back(h);
+                    callbacks_changed();
+                    return;
+                }
+        sc_core::sc_trace(trf, storage, this->name());
+    }
+    /**
+     * @fn void set_trace_on_change(bool)
+     * @brief let the register notify trace files implementing scc::observer (like scc::vcd_push_trace_file and
+     * scc::fst_trace_file) about changes instead of being sampled in every cycle. Needs to be set before the register
+     * is traced.
+     *
+     * The notifications are issued by the accesses through the register (bus and debug accesses, reset, put() and the
+     * assignment operators), so changes of the underlying storage by other means are not recorded.
+     *
+     * @param enable if true changes are pushed to observers
+     */
+    void set_trace_on_change(bool enable) { trace_on_change = enable; }
     //! \brief the reset value
     const DATATYPE res_val;
     //! \brief the SW read mask
@@ -316,16 +434,54 @@ public:
     const DATATYPE wrmask;
 
 private:
-    DATATYPE& storage;
-    std::function<bool(const this_type&, DATATYPE&, sc_core::sc_time&)> rd_cb;
-    std::function<bool(this_type&, DATATYPE&, sc_core::sc_time&)> wr_cb;
-
 #ifdef _MSC_VER
-    std::function<bool(const this_type&, DATATYPE&, sc_core::sc_time&)> rd_dlgt;
-    std::function<bool(this_type&, DATATYPE&, sc_core::sc_time&)> wr_dlgt;
+    using read_cb_type = std::function<bool(const this_type&, DATATYPE&, sc_core::sc_time&)>;
+    using write_cb_type = std::function<bool(this_type&, DATATYPE&, sc_core::sc_time&)>;
 #else
-    util::delegate<bool(const this_type&, DATATYPE&, sc_core::sc_time&)> rd_dlgt;
-    util::delegate<bool(this_type&, DATATYPE&, sc_core::sc_time&)> wr_dlgt;
+    using read_cb_type = util::delegate<bool(const this_type&, DATATYPE&, sc_core::sc_time&)>;
+    using write_cb_type = util::delegate<bool(this_type&, DATATYPE&, sc_core::sc_time&)>;
+#endif
+    //! adapts a callback without annotated time, it is stored inline in the callback storage
+    template <typename F> struct untimed_cb {
+        F f;
+        template <typename REG> bool operator()(REG& reg, DATATYPE& data, sc_core::sc_time&) { return f(reg, data); }
+    };
+
+    //! revoke DMI pointers and reset images as they depend on the callbacks and observers
+    void callbacks_changed() const {
+        if(dmi_invalidate_cb)
+            dmi_invalidate_cb();
+        if(reset_invalidate_cb)
+            reset_invalidate_cb();
+    }
+
+    //! observe the storage if the observer interface has an overload taking exactly DATATYPE, return nullptr otherwise
+    template <typename T>
+    static auto observe_storage(observer* obs, T const& v, std::string const& nm, int)
+        -> decltype(static_cast<observer::notification_handle* (*)(observer*, T const&, std::string const&)>(
+            &::scc::observe)(obs, v, nm)) {
+        return ::scc::observe(obs, v, nm);
+    }
+    template <typename T>
+    static observer::notification_handle* observe_storage(observer*, T const&, std::string const&, long) {
+        return nullptr;
+    }
+
+    void notify_observers() const {
+        for(auto h : hndl)
+            h->notify();
+    }
+
+    DATATYPE& storage;
+    read_cb_type rd_cb;
+    write_cb_type wr_cb;
+    std::function<void()> dmi_invalidate_cb;
+    std::function<void()> reset_invalidate_cb;
+    bool trace_on_change{false};
+    //! the handles of the observers being notified about changes
+    mutable std::vector<observer::notification_handle*> hndl;
+#ifdef SCC_REGISTER_PROFILING
+    mutable resource_profile profile;
 #endif
 };
 } // namespace impl
@@ -417,6 +573,15 @@ public:
         for(size_t idx = START; idx < SIZE + START; ++idx)
             _reg_field[idx].set_write_cb([this, idx](sc_register<DATATYPE>& reg, const DATATYPE& dt, sc_core::sc_time& delay){return this->wr_time_cb(idx, reg, dt, delay);});
     }
+    /**
+     * let all registers notify observing trace files about changes, see sc_register::set_trace_on_change()
+     *
+     * @param enable if true changes are pushed to observers
+     */
+    void set_trace_on_change(bool enable) {
+        for(size_t idx = START; idx < SIZE + START; ++idx)
+            _reg_field[idx].set_trace_on_change(enable);
+    }
     /**
      * Element access operator
      *
@@ -0,0 +1,336 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SYSC_REGISTER_ARRAY_H_
+#define _SYSC_REGISTER_ARRAY_H_
+
+#include "register.h"
+#include "resetable.h"
+#include "resource_access_if.h"
+#include "util/delegate.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <vector>
+
+namespace scc {
+/**
+ * @class sc_register_array
+ * @brief an indexed register for large register files like descriptor tables
+ *
+ * In contrast to sc_register_indexed the elements are not sc_objects of their own but lightweight resources
+ * referring to an element of the storage, all elements share the masks, the reset value and the callbacks. The
+ * callbacks get the index of the accessed element. The elements are reset as a whole, by filling the storage if
+ * there is no write callback.
+ *
+ * @tparam DATATYPE the (integral) type of an element
+ * @tparam SIZE the number of elements
+ */
+template <typename DATATYPE, size_t SIZE> class sc_register_array : public sc_core::sc_object,
+                                                                     public indexed_resource_access_if {
+public:
+    using this_type = sc_register_array<DATATYPE, SIZE>;
+    /**
+     * @class element
+     * @brief the resource of a single element
+     */
+    class element : public resource_access_if {
+    public:
+        explicit element(this_type& array)
+        : array(&array) {}
+
+        size_t size() const override { return sizeof(DATATYPE); }
+
+        void reset() override { array->reset_element(index()); }
+
+        bool write(const uint8_t* data, size_t length, uint64_t offset, sc_core::sc_time& d) override {
+            return array->write_element(index(), data, length, offset, d);
+        }
+
+        bool read(uint8_t* data, size_t length, uint64_t offset, sc_core::sc_time& d) const override {
+            return array->read_element(index(), data, length, offset, d);
+        }
+
+        bool write_dbg(const uint8_t* data, size_t length, uint64_t offset = 0) override {
+            assert("Offset out of range" && offset == 0);
+            if(length != sizeof(DATATYPE))
+                return false;
+            std::copy(data, data + length, reinterpret_cast<uint8_t*>(&array->storage[index()]));
+            return true;
+        }
+
+        bool read_dbg(uint8_t* data, size_t length, uint64_t offset = 0) const override {
+            assert("Offset out of range" && offset == 0);
+            if(length != sizeof(DATATYPE))
+                return false;
+            auto beg = reinterpret_cast<const uint8_t*>(&array->storage[index()]);
+            std::copy(beg, beg + length, data);
+            return true;
+        }
+
+        uint8_t* get_dmi_ptr(bool write) override {
+            return array->dmi_allowed(write) ? reinterpret_cast<uint8_t*>(&array->storage[index()]) : nullptr;
+        }
+        //! all elements are mapped by the same target so the callback is kept once in the array
+        void set_dmi_invalidate_cb(std::function<void()> cb) override { array->dmi_invalidate_cb = cb; }
+        //! the index of the element
+        size_t index() const { return static_cast<size_t>(this - array->elements.data()); }
+
+    private:
+        this_type* array;
+    };
+    /**
+     * the constructor
+     *
+     * @param nm the instance name
+     * @param storage the storage of the elements
+     * @param reset_val the reset value of all elements
+     * @param owner the owning object which needs to implement the resettable interface
+     * @param rdmask the SW read mask of all elements
+     * @param wrmask the SW write mask of all elements
+     */
+    sc_register_array(sc_core::sc_module_name nm, std::array<DATATYPE, SIZE>& storage, const DATATYPE reset_val,
+                      resetable& owner, DATATYPE rdmask = impl::get_max_uval<DATATYPE>(),
+                      DATATYPE wrmask = impl::get_max_uval<DATATYPE>())
+    : sc_core::sc_object(nm)
+    , res_val(reset_val)
+    , rdmask(rdmask)
+    , wrmask(wrmask)
+    , storage(storage)
+    , elements(SIZE, element(*this))
+    , reset_proxy(*this) {
+        owner.register_resource(&reset_proxy);
+    }
+
+    sc_register_array(const sc_register_array&) = delete;
+
+    sc_register_array& operator=(const sc_register_array&) = delete;
+    /**
+     * get the number of elements
+     *
+     * @return the size
+     */
+    size_t size() override { return SIZE; }
+    /**
+     * reset all elements
+     */
+    void reset() {
+        if(!wr_cb) {
+            storage.fill(res_val);
+            return;
+        }
+        for(size_t idx = 0; idx < SIZE; ++idx)
+            reset_element(idx);
+    }
+    /**
+     * get the value of an element
+     *
+     * @param idx the index
+     * @return the value
+     */
+    DATATYPE get(size_t idx) const { return storage[idx]; }
+    /**
+     * set the value of an element without invoking the callbacks
+     *
+     * @param idx the index
+     * @param data the new value
+     */
+    void put(size_t idx, DATATYPE data) { storage[idx] = data; }
+    /**
+     * @fn void set_read_cb(F&&)
+     * @brief set the read callback shared by all elements
+     *
+     * The read callback functor is triggered upon a read request. It has the signature
+     * `bool(size_t idx, DATATYPE& value, sc_core::sc_time&)` or without the annotated time, value holds the stored
+     * (unmasked) value of the element upon the call.
+     *
+     * @param read_cb the callback functor, an empty one removes the callback
+     */
+    template <typename F>
+    auto set_read_cb(F&& read_cb)
+        -> decltype(read_cb(size_t(), std::declval<DATATYPE&>(), std::declval<sc_core::sc_time&>()), void()) {
+        if(util::is_empty_callable(read_cb))
+            rd_cb = read_cb_type();
+        else
+            rd_cb = std::forward<F>(read_cb);
+        callbacks_changed();
+    }
+    template <typename F>
+    auto set_read_cb(F&& read_cb) -> decltype(read_cb(size_t(), std::declval<DATATYPE&>()), void()) {
+        if(util::is_empty_callable(read_cb))
+            rd_cb = read_cb_type();
+        else
+            rd_cb = untimed_cb<typename std::decay<F>::type>{std::forward<F>(read_cb)};
+        callbacks_changed();
+    }
+    //! remove the read callback
+    void set_read_cb(std::nullptr_t) {
+        rd_cb = read_cb_type();
+        callbacks_changed();
+    }
+    /**
+     * @fn void set_write_cb(F&&)
+     * @brief set the write callback shared by all elements
+     *
+     * The write callback functor is triggered upon a write request and upon reset. It has the signature
+     * `bool(size_t idx, const DATATYPE& value, sc_core::sc_time&)` or without the annotated time. Like the one of
+     * sc_register it is responsible for updating the storage (e.g. using put()).
+     *
+     * @param write_cb the callback functor, an empty one removes the callback
+     */
+    template <typename F>
+    auto set_write_cb(F&& write_cb)
+        -> decltype(write_cb(size_t(), std::declval<const DATATYPE&>(), std::declval<sc_core::sc_time&>()), void()) {
+        if(util::is_empty_callable(write_cb))
+            wr_cb = write_cb_type();
+        else
+            wr_cb = std::forward<F>(write_cb);
+        callbacks_changed();
+    }
+    template <typename F>
+    auto set_write_cb(F&& write_cb) -> decltype(write_cb(size_t(), std::declval<const DATATYPE&>()), void()) {
+        if(util::is_empty_callable(write_cb))
+            wr_cb = write_cb_type();
+        else
+            wr_cb = untimed_cb<typename std::decay<F>::type>{std::forward<F>(write_cb)};
+        callbacks_changed();
+    }
+    //! remove the write callback
+    void set_write_cb(std::nullptr_t) {
+        wr_cb = write_cb_type();
+        callbacks_changed();
+    }
+    /**
+     * Element access operator
+     *
+     * @param idx the index
+     * @return the resource of the element
+     */
+    reference operator[](size_t idx) noexcept override { return elements[idx]; }
+    /**
+     * const element access operator
+     *
+     * @param idx the index
+     * @return the resource of the element
+     */
+    const_reference operator[](size_t idx) const noexcept override { return elements[idx]; }
+    /**
+     * Element access operator with range checking
+     *
+     * @param idx the index
+     * @return the resource of the element
+     */
+    reference at(size_t idx) override {
+        assert("access out of bound" && idx < SIZE);
+        return elements[idx];
+    }
+    /**
+     * const element access operator with range checking
+     *
+     * @param idx the index
+     * @return the resource of the element
+     */
+    const_reference at(size_t idx) const override {
+        assert("access out of bound" && idx < SIZE);
+        return elements[idx];
+    }
+    //! \brief the reset value
+    const DATATYPE res_val;
+    //! \brief the SW read mask
+    const DATATYPE rdmask;
+    //! \brief the SW write mask
+    const DATATYPE wrmask;
+
+private:
+#ifdef _MSC_VER
+    using read_cb_type = std::function<bool(size_t, DATATYPE&, sc_core::sc_time&)>;
+    using write_cb_type = std::function<bool(size_t, const DATATYPE&, sc_core::sc_time&)>;
+#else
+    using read_cb_type = util::delegate<bool(size_t, DATATYPE&, sc_core::sc_time&)>;
+    using write_cb_type = util::delegate<bool(size_t, const DATATYPE&, sc_core::sc_time&)>;
+#endif
+    //! adapts a callback without annotated time, it is stored inline in the callback storage
+    template <typename F> struct untimed_cb {
+        F f;
+        template <typename T> bool operator()(size_t idx, T& data, sc_core::sc_time&) { return f(idx, data); }
+    };
+    //! the resource registered with the reset domain, it resets all elements at once
+    struct reset_resource : public resource_access_if {
+        explicit reset_resource(this_type& array)
+        : array(array) {}
+        size_t size() const override { return SIZE * sizeof(DATATYPE); }
+        void reset() override { array.reset(); }
+        bool write(const uint8_t*, size_t, uint64_t, sc_core::sc_time&) override { return false; }
+        bool read(uint8_t*, size_t, uint64_t, sc_core::sc_time&) const override { return false; }
+        bool write_dbg(const uint8_t*, size_t, uint64_t) override { return false; }
+        bool read_dbg(uint8_t*, size_t, uint64_t) const override { return false; }
+        this_type& array;
+    };
+
+    void reset_element(size_t idx) {
+        DATATYPE r(res_val);
+        if(wr_cb) {
+            sc_core::sc_time d;
+            wr_cb(idx, r, d);
+        }
+        storage[idx] = r;
+    }
+
+    bool write_element(size_t idx, const uint8_t* data, size_t length, uint64_t offset, sc_core::sc_time& d) {
+        assert("Access out of range" && offset + length <= sizeof(DATATYPE));
+        auto temp(storage[idx]);
+        std::copy(data, data + length, reinterpret_cast<uint8_t*>(&temp) + offset);
+        if(wr_cb)
+            return wr_cb(idx, temp, d);
+        storage[idx] = (temp & wrmask) | (storage[idx] & ~wrmask);
+        return true;
+    }
+
+    bool read_element(size_t idx, uint8_t* data, size_t length, uint64_t offset, sc_core::sc_time& d) const {
+        assert("Access out of range" && offset + length <= sizeof(DATATYPE));
+        auto temp(storage[idx]);
+        if(rd_cb) {
+            if(!rd_cb(idx, temp, d))
+                return false;
+        } else
+            temp &= rdmask;
+        auto beg = reinterpret_cast<const uint8_t*>(&temp) + offset;
+        std::copy(beg, beg + length, data);
+        return true;
+    }
+
+    bool dmi_allowed(bool write) const {
+        if(rd_cb || rdmask != impl::get_max_uval<DATATYPE>())
+            return false;
+        return !write || (!wr_cb && wrmask == impl::get_max_uval<DATATYPE>());
+    }
+    //! revoke DMI pointers as they depend on the callbacks
+    void callbacks_changed() {
+        if(dmi_invalidate_cb)
+            dmi_invalidate_cb();
+    }
+
+    std::array<DATATYPE, SIZE>& storage;
+    std::vector<element> elements;
+    reset_resource reset_proxy;
+    read_cb_type rd_cb;
+    write_cb_type wr_cb;
+    std::function<void()> dmi_invalidate_cb;
+};
+} // namespace scc
+
+#endif /* _SYSC_REGISTER_ARRAY_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2018 MINRES Technologies GmbH
+ * Copyright 2016-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,6 +18,9 @@
 #define _SYSC_RESETTABLE_H_
 
 #include "resource_access_if.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <vector>
 
 namespace scc {
@@ -39,8 +42,7 @@ public:
      */
     virtual void reset_start() {
         _in_reset = true;
-        for(auto res : resources)
-            res->reset();
+        reset_resources();
     }
     /**
      * @fn void reset_stop()
@@ -48,8 +50,7 @@ public:
      *
      */
     virtual void reset_stop() {
-        for(auto res : resources)
-            res->reset();
+        reset_resources();
         _in_reset = false;
     }
     /**
@@ -65,11 +66,76 @@ public:
      *
      * @param res the resource belonging to this reset domain
      */
-    void register_resource(resource_access_if* res) { resources.push_back(res); }
+    void register_resource(resource_access_if* res) {
+        resources.push_back(res);
+        res->set_reset_invalidate_cb([this]() { this->reset_plan_dirty = true; });
+    }
 
 protected:
+    /**
+     * @fn void reset_resources()
+     * @brief reset all registered resources
+     *
+     * The resources without side effects upon reset (see resource_access_if::get_reset_storage()) are reset by
+     * copying their reset values from an image, resources with adjacent storage are handled by a single copy. Only
+     * the remaining resources are reset by calling their reset() afterwards, in the order of registration.
+     */
+    void reset_resources() {
+        if(reset_plan_dirty || planned_resources != resources.size())
+            build_reset_plan();
+        for(auto& r : reset_runs)
+            std::memcpy(r.storage, reset_image.data() + r.offset, r.size);
+        for(auto res : reset_hooks)
+            res->reset();
+    }
+
     std::vector<resource_access_if*> resources;
     bool _in_reset = false;
+
+private:
+    struct reset_run {
+        uint8_t* storage;
+        size_t offset;
+        size_t size;
+    };
+
+    void build_reset_plan() {
+        struct plain_resource {
+            uint8_t* storage;
+            const uint8_t* reset_value;
+            size_t size;
+        };
+        std::vector<plain_resource> plain;
+        reset_hooks.clear();
+        for(auto res : resources) {
+            const uint8_t* reset_value = nullptr;
+            if(auto* storage = res->get_reset_storage(reset_value))
+                plain.push_back(plain_resource{storage, reset_value, res->size()});
+            else
+                reset_hooks.push_back(res);
+        }
+        std::stable_sort(plain.begin(), plain.end(), [](plain_resource const& a, plain_resource const& b) {
+            return std::less<uint8_t*>()(a.storage, b.storage);
+        });
+        reset_runs.clear();
+        reset_image.clear();
+        for(auto& p : plain) {
+            if(!reset_runs.empty() && reset_runs.back().storage + reset_runs.back().size == p.storage)
+                reset_runs.back().size += p.size;
+            else
+                reset_runs.push_back(reset_run{p.storage, reset_image.size(), p.size});
+            reset_image.insert(reset_image.end(), p.reset_value, p.reset_value + p.size);
+        }
+        planned_resources = resources.size();
+        reset_plan_dirty = false;
+    }
+    //! the runs of adjacent storage being reset by a copy from reset_image
+    std::vector<reset_run> reset_runs;
+    std::vector<uint8_t> reset_image;
+    //! the resources needing a call of reset()
+    std::vector<resource_access_if*> reset_hooks;
+    size_t planned_resources{0};
+    bool reset_plan_dirty{true};
 };
 
 } /* namespace scc */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2018 MINRES Technologies GmbH
+ * Copyright 2016-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,9 +19,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <sysc/kernel/sc_time.h>
 
 namespace scc {
+struct resource_profile;
 /**
  * @class resource_access_if
  * @brief interface defining access to a resource e.g. a register
@@ -88,6 +90,47 @@ public:
      * @return true it the access is successful
      */
     virtual bool read_dbg(uint8_t* data, std::size_t length, uint64_t offset = 0) const = 0;
+    /**
+     * @fn uint8_t* get_dmi_ptr(bool)
+     * @brief get the storage of the resource if it can be accessed directly (DMI)
+     *
+     * This is only possible if accessing the storage directly is equivalent to calling read() resp. write(), i.e.
+     * the accesses have no side effects and the value is not masked
+     *
+     * @param write if true direct writes need to be possible as well
+     * @return the pointer to the storage of size() bytes or nullptr if no direct access is possible
+     */
+    virtual uint8_t* get_dmi_ptr(bool write) { return nullptr; }
+    /**
+     * @fn void set_dmi_invalidate_cb(std::function<void()>)
+     * @brief set the function to be called if a pointer returned by get_dmi_ptr() may not be used anymore
+     *
+     * @param cb the callback functor
+     */
+    virtual void set_dmi_invalidate_cb(std::function<void()> cb) {}
+    /**
+     * @fn uint8_t* get_reset_storage(const uint8_t*&)
+     * @brief get the storage and the reset value of the resource if a reset is equivalent to copying the reset value
+     * into the storage, i.e. the reset has no side effects
+     *
+     * @param reset_value set to the reset value of size() bytes
+     * @return the pointer to the storage of size() bytes or nullptr if reset() needs to be called
+     */
+    virtual uint8_t* get_reset_storage(const uint8_t*& reset_value) { return nullptr; }
+    /**
+     * @fn void set_reset_invalidate_cb(std::function<void()>)
+     * @brief set the function to be called if the result of get_reset_storage() changes
+     *
+     * @param cb the callback functor
+     */
+    virtual void set_reset_invalidate_cb(std::function<void()> cb) {}
+    /**
+     * @fn const resource_profile* get_profile()const
+     * @brief get the access counters of the resource
+     *
+     * @return the counters or nullptr if the resource does not collect them (see SCC_REGISTER_PROFILING)
+     */
+    virtual const resource_profile* get_profile() const { return nullptr; }
 };
 /**
  * @class indexed_resource_access_if
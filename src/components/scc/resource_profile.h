@@ -0,0 +1,98 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SYSC_RESOURCE_PROFILE_H_
+#define _SYSC_RESOURCE_PROFILE_H_
+
+#include <scc/counters.h>
+#include <chrono>
+#include <string>
+
+namespace scc {
+/**
+ * @class resource_profile
+ * @brief the access counters of a resource, they are compiled into the registers if SCC_REGISTER_PROFILING is
+ * defined (CMake option SCC_REGISTER_PROFILING)
+ *
+ * The counters are registered with the counter_registry as \<name\>.reads and \<name\>.writes and the host time spent
+ * in the callbacks as histogram \<name\>.callback_ns, so they are reported by value_registry::get_counters() as well.
+ */
+struct resource_profile {
+    /**
+     * @brief measures the host time while being alive, if active
+     */
+    class callback_timer {
+    public:
+        callback_timer(resource_profile& profile, bool active = true)
+        : profile(active ? &profile : nullptr)
+        , start(active ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()) {}
+
+        callback_timer(const callback_timer&) = delete;
+
+        callback_timer& operator=(const callback_timer&) = delete;
+
+        ~callback_timer() {
+            if(profile)
+                profile->callback_time.add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                               std::chrono::steady_clock::now() - start)
+                                               .count());
+        }
+
+    private:
+        resource_profile* profile;
+        std::chrono::steady_clock::time_point start;
+    };
+    /**
+     * @param name the hierarchical name of the resource
+     */
+    explicit resource_profile(std::string const& name)
+    : reads_name(name + ".reads")
+    , writes_name(name + ".writes")
+    , callback_name(name + ".callback_ns")
+    , reads_site(reads_name.c_str(), false)
+    , writes_site(writes_name.c_str(), false)
+    , callback_site(callback_name.c_str(), true)
+    , reads(reads_site.local_slot())
+    , writes(writes_site.local_slot())
+    , callback_time(callback_site.local_slot()) {}
+
+    resource_profile(const resource_profile&) = delete;
+
+    resource_profile& operator=(const resource_profile&) = delete;
+
+private:
+    // the sites keep pointers to the names
+    const std::string reads_name, writes_name, callback_name;
+    counter_site reads_site, writes_site, callback_site;
+
+public:
+    counter_slot& reads;
+    counter_slot& writes;
+    counter_slot& callback_time;
+};
+} // namespace scc
+
+#ifdef SCC_REGISTER_PROFILING
+//! count an access of kind (reads or writes) in the resource_profile profile
+#define SCC_REGISTER_PROFILE_ACCESS(profile, kind) (profile).kind.inc()
+//! measure the time of the remaining scope in the resource_profile profile if active is true
+#define SCC_REGISTER_PROFILE_CALLBACK(profile, active)                                                                 \
+    ::scc::resource_profile::callback_timer scc_register_profile_timer(profile, active)
+#else
+#define SCC_REGISTER_PROFILE_ACCESS(profile, kind) ((void)0)
+#define SCC_REGISTER_PROFILE_CALLBACK(profile, active) ((void)0)
+#endif
+#endif /* _SYSC_RESOURCE_PROFILE_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2018 MINRES Technologies GmbH
+ * Copyright 2016-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,30 +17,65 @@
 #ifndef _SYSC_ROUTER_H_
 #define _SYSC_ROUTER_H_
 
+#include <scc/elab_profiler.h>
+#include <scc/sc_variable.h>
+#include <scc/span_tracer.h>
 #include <scc/utilities.h>
 #include <tlm/scc/initiator_mixin.h>
 #include <tlm/scc/target_mixin.h>
 #include <util/range_lut.h>
+#include <algorithm>
+#include <atomic>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <sysc/utils/sc_vector.h>
 #include <tlm.h>
 #include <tlm/scc/scv/tlm_rec_initiator_socket.h>
 #include <tlm/scc/scv/tlm_rec_target_socket.h>
+#include <thread>
 #include <unordered_map>
 
 namespace scc {
+/**
+ * @struct batch_transport_if
+ * @brief interface of targets accepting a batch of blocking transactions in one call
+ *
+ * The transactions are processed in order as if they were issued back to back, delay holds the accumulated
+ * annotated delay.
+ */
+struct batch_transport_if {
+    virtual void b_transport_batch(tlm::tlm_generic_payload** trans, size_t count, sc_core::sc_time& delay) = 0;
+    virtual ~batch_transport_if() = default;
+};
 /**
  * @class router
  * @brief a TLM2.0 router for loosly-timed (LT) models
  *
- * It uses the tlm::scc::scv::tlm_rec_initiator_socket so that incoming and outgoing accesses can be traced using SCV
+ * It uses the tlm::scc::scv::tlm_rec_target_socket so that incoming accesses can be traced using SCV. If RECORDING is
+ * false plain tlm::tlm_target_socket are used instead, the default is set by the CMake option SCC_TLM_RECORDING.
  *
  * @tparam BUSWIDTH the width of the bus
+ * @tparam RECORDING if true the target sockets record the transactions
  */
-template <unsigned BUSWIDTH = LT> class router : sc_core::sc_module {
+template <unsigned BUSWIDTH = LT, bool RECORDING = tlm::scc::scv::recording_default> class router : sc_core::sc_module {
 public:
+    //! the serialization of concurrent blocking accesses to a target
+    enum lock_policy {
+        MUTEX,   //!< accesses are serialized using a sc_mutex (default)
+        CHECKED, //!< accesses are serialized using a busy flag, waiting only if the target is occupied
+        NONE,    //!< accesses are not serialized, suitable for targets never calling wait()
+        ATOMIC   //!< accesses are serialized using a host level atomic flag, safe for initiators in different threads,
+                 //!< the SystemC processes of the kernel thread are serialized by a sc_mutex in addition
+    };
+    //! the access statistics of a pair of target and initiator socket
+    struct access_stats {
+        uint64_t count{0};
+        uint64_t bytes{0};
+        sc_core::sc_time delay;
+    };
     using intor_sckt = tlm::scc::initiator_mixin<tlm::tlm_initiator_socket<BUSWIDTH>>;
-    using target_sckt = tlm::scc::target_mixin<tlm::scc::scv::tlm_rec_target_socket<BUSWIDTH>>;
+    using target_sckt = tlm::scc::target_mixin<tlm::scc::scv::target_socket_select<BUSWIDTH, RECORDING>>;
     //! \brief the array of target sockets
     sc_core::sc_vector<target_sckt> target;
     //! \brief  the array of initiator sockets
@@ -53,11 +88,12 @@ public:
      * @param slave_cnt number of slaves to be connected
      * @param master_cnt number of masters to be connected
      */
-    router(const sc_core::sc_module_name& nm, unsigned slave_cnt = 1, unsigned master_cnt = 1);
+    router(const sc_core::sc_module_name& nm, unsigned slave_cnt = 1, unsigned master_cnt = 1)
+    : router(nm, slave_cnt, master_cnt, true) {}
 
     ~router() = default;
     /**
-     * @fn void bind_target(TYPE&, size_t, uint64_t, uint64_t, bool=true)
+     * @fn void bind_target(TYPE&, size_t, uint64_t, uint64_t, bool=true, lock_policy=MUTEX)
      * @brief bind the initiator socket of the router to some target giving a base and size
      *
      * @tparam TYPE the socket type to bind
@@ -66,10 +102,13 @@ public:
      * @param base base address of the target
      * @param size size of the address range occupied by the target
      * @param remap if true address will be rewritten in accesses to be 0-based at the target
+     * @param policy the serialization of concurrent accesses to the target
      */
     template <typename TYPE>
-    void bind_target(TYPE& socket, size_t idx, uint64_t base, uint64_t size, bool remap = true) {
+    void bind_target(TYPE& socket, size_t idx, uint64_t base, uint64_t size, bool remap = true,
+                     lock_policy policy = MUTEX) {
         set_target_range(idx, base, size, remap);
+        set_target_lock_policy(idx, policy);
         initiator[idx].bind(socket);
     }
     /**
@@ -85,6 +124,35 @@ public:
         set_target_name(idx, name);
         initiator[idx].bind(socket);
     }
+    /**
+     * @fn void bind_router(router&, size_t, size_t, uint64_t, uint64_t, bool=true)
+     * @brief bind the initiator socket of the router to a target socket of a cascaded router giving a base and size
+     *
+     * Besides the binding the cascade is registered so that the address maps of the routers are flattened at the end
+     * of elaboration. Blocking accesses hitting a range of a target of the cascaded router are then forwarded directly
+     * to this target (using its lock policy) bypassing the decoding and recording in the cascaded router.
+     *
+     * @param sub the cascaded router
+     * @param idx number of the target
+     * @param sub_idx number of the target socket of the cascaded router
+     * @param base base address of the cascaded router
+     * @param size size of the address range occupied by the cascaded router
+     * @param remap if true address will be rewritten in accesses to be 0-based at the cascaded router
+     */
+    void bind_router(router& sub, size_t idx, size_t sub_idx, uint64_t base, uint64_t size, bool remap = true) {
+        bind_target(sub.target[sub_idx], idx, base, size, remap);
+        sub_routers.emplace_back(sub_router{idx, &sub, sub_idx});
+        sub.parent_routers.push_back(this);
+    }
+    /**
+     * @fn void flatten_address_map()
+     * @brief merge the address maps of all cascaded routers into a flat map
+     *
+     * This is called at the end of elaboration and needs to be called again if the address map of this or any
+     * cascaded router changes later on. remap_target_range() does this for the router and all routers it is
+     * cascaded into.
+     */
+    void flatten_address_map();
     /**
      * @fn void set_initiator_base(size_t, uint64_t)
      * @brief define a base address of a socket
@@ -133,6 +201,75 @@ public:
      * @param remap if true address will be rewritten in accesses to be 0-based at the target
      */
     void set_target_range(size_t idx, uint64_t base, uint64_t size, bool remap = true);
+    /**
+     * @fn void remap_target_range(size_t, uint64_t, uint64_t)
+     * @brief move the address range of a socket, e.g. when a BAR is reprogrammed during simulation
+     *
+     * The mapping is replaced in place, if the new range overlaps another range a std::runtime_error is thrown and
+     * the address map stays unchanged. DMI regions of the old range are invalidated. The flattened address maps of
+     * the routers this one is cascaded into are rebuilt as well.
+     *
+     * @param idx the index of the socket
+     * @param base the new base address of the target
+     * @param size the new size of the address range occupied by the target
+     */
+    void remap_target_range(size_t idx, uint64_t base, uint64_t size);
+    /**
+     * @fn void set_target_lock_policy(size_t, lock_policy)
+     * @brief define how concurrent blocking accesses to a target are serialized
+     *
+     * MUTEX locks a sc_mutex around each access. CHECKED marks the target as busy and waits only if another access
+     * is ongoing, so an uncontended access needs no kernel interaction. NONE does not serialize at all.
+     *
+     * @param idx the index of the target
+     * @param policy the lock policy
+     */
+    void set_target_lock_policy(size_t idx, lock_policy policy) { lock_policies[idx] = policy; }
+    /**
+     * @fn void set_statistics(bool)
+     * @brief enable the collection of access statistics, needs to be called during elaboration
+     *
+     * If enabled, the number of transactions, the number of bytes and the accumulated annotated delay of blocking
+     * accesses are counted for each pair of target and initiator socket as well as the number of accesses routed
+     * to the default target and the number of address errors. The counters are registered as sc_ref_variable with the
+     * names stat_<target socket>_<initiator socket>_{count,bytes,delay}, stat_default_hits and stat_address_errors
+     * so they are accessible using the scc::value_registry.
+     *
+     * @param enable
+     */
+    void set_statistics(bool enable) { statistics = enable; }
+    /**
+     * @fn const access_stats& get_statistics(size_t, size_t)
+     * @brief get the access statistics of a pair of sockets
+     *
+     * @param i the index of the target socket (the initiator side)
+     * @param idx the index of the initiator socket (the target side)
+     * @return the statistics
+     */
+    const access_stats& get_statistics(size_t i, size_t idx) const { return stats[i * initiator.size() + idx]; }
+    //! get the number of accesses routed to the default target
+    uint64_t get_default_hits() const { return default_hits.load(std::memory_order_relaxed); }
+    //! get the number of accesses not hitting any address range
+    uint64_t get_address_errors() const { return address_errors.load(std::memory_order_relaxed); }
+    /**
+     * @fn void set_thread_safe(bool)
+     * @brief enable the use of the router by initiators running in different OS threads (parallel SystemC kernels)
+     *
+     * In this mode addresses are decoded using an immutable decode table which is atomically replaced upon changes of
+     * the address map, the decode and DMI caches are not used. Each target socket of the router still needs to be
+     * used by one thread only. Targets being accessed from different threads need to use the ATOMIC lock policy.
+     * The address map cannot be changed by remap_target_range() while the simulation runs as the flattened address
+     * map of cascaded routers is not protected.
+     *
+     * @param enable
+     */
+    void set_thread_safe(bool enable) {
+        thread_safe = enable;
+        if(enable) {
+            set_dmi_caching(false);
+            publish_decode_table();
+        }
+    }
     /**
      * @fn void b_transport(int, tlm::tlm_generic_payload&, sc_core::sc_time&)
      * @brief tagged blocking transport method
@@ -142,6 +279,28 @@ public:
      * @param delay the annotated delay
      */
     void b_transport(int i, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay);
+    /**
+     * @fn void b_transport_batch(int, tlm::tlm_generic_payload**, size_t, sc_core::sc_time&)
+     * @brief tagged blocking transport method for a batch of transactions
+     *
+     * All transactions are decoded in one pass and grouped by target. Each group is forwarded in one call to targets
+     * registered using set_batch_target(), other targets receive the transactions one by one. Transactions within a
+     * group keep their order while the order of the groups follows the target index.
+     *
+     * @param i the tag
+     * @param trans the array of incoming transactions
+     * @param count the number of transactions
+     * @param delay the annotated delay accumulated over all transactions
+     */
+    void b_transport_batch(int i, tlm::tlm_generic_payload** trans, size_t count, sc_core::sc_time& delay);
+    /**
+     * @fn void set_batch_target(size_t, batch_transport_if*)
+     * @brief register the batch interface of the target bound to an initiator socket
+     *
+     * @param idx the index of the initiator socket
+     * @param tgt the batch interface of the target or nullptr to forward transactions one by one
+     */
+    void set_batch_target(size_t idx, batch_transport_if* tgt) { batch_targets[idx] = tgt; }
     /**
      * @fn bool get_direct_mem_ptr(int, tlm::tlm_generic_payload&, tlm::tlm_dmi&)
      * @brief tagged forward DMI method
@@ -169,33 +328,216 @@ public:
      * @param end_range address range end address
      */
     void invalidate_direct_mem_ptr(int id, ::sc_dt::uint64 start_range, ::sc_dt::uint64 end_range);
+    /**
+     * @fn void set_dmi_caching(bool)
+     * @brief enable or disable the caching of granted DMI regions (enabled by default)
+     *
+     * If enabled, DMI regions granted by a target are remembered and repeated requests hitting such a region are
+     * answered by the router without forwarding them. Regions are removed upon invalidation by the target.
+     *
+     * @param enable
+     */
+    void set_dmi_caching(bool enable) {
+        dmi_caching = enable;
+        if(!enable)
+            for(auto& e : dmi_cache)
+                e.clear();
+    }
+    /**
+     * @fn void set_dmi_invalidation_batching(bool)
+     * @brief enable or disable the coalescing of DMI invalidations (disabled by default)
+     *
+     * Invalidations are only forwarded to target sockets having been granted a DMI region overlapping the invalidated
+     * range. If batching is enabled, the invalidations received during a delta cycle are merged and forwarded once per
+     * target socket in the following delta cycle. This suits initiators not accessing invalidated regions in the
+     * meantime, e.g. while a large memory region is remapped range by range.
+     *
+     * @param enable
+     */
+    void set_dmi_invalidation_batching(bool enable) {
+        if(!enable)
+            flush_dmi_invalidations();
+        dmi_batching = enable;
+    }
 
 protected:
+    /**
+     * @brief constructs a router, derived classes decoding accesses differently register their own blocking transport
+     *
+     * @param nm the component name
+     * @param slave_cnt number of slaves to be connected
+     * @param master_cnt number of masters to be connected
+     * @param reg_b_transport if false the blocking transport of the target sockets is not registered
+     */
+    router(const sc_core::sc_module_name& nm, unsigned slave_cnt, unsigned master_cnt, bool reg_b_transport);
+
     struct range_entry {
         uint64_t base, size;
         bool remap;
     };
+    //! a cascaded router bound to an initiator socket
+    struct sub_router {
+        size_t idx;
+        router* rtr;
+        size_t sub_idx;
+    };
+    //! an address range of a target in a cascaded router, the target address is the system address plus offset
+    struct flat_entry {
+        uint64_t start, end;
+        router* rtr;
+        size_t idx;
+        uint64_t offset;
+    };
+
+    void before_end_of_elaboration() override;
+
+    void end_of_elaboration() override { flatten_address_map(); }
+    //! update the statistics of an access
+    void record(int i, size_t idx, tlm::tlm_generic_payload& trans, sc_core::sc_time const& start_delay,
+                sc_core::sc_time const& delay) {
+        auto& s = stats[i * initiator.size() + idx];
+        ++s.count;
+        s.bytes += trans.get_data_length();
+        s.delay += delay - start_delay;
+    }
+    /**
+     * @fn void collect_ranges(uint64_t, uint64_t, uint64_t, std::vector<flat_entry>&)
+     * @brief collect the final target ranges within an address range of this router
+     *
+     * @param start the start address in the system address space of this router
+     * @param end the end address in the system address space of this router
+     * @param offset the offset to convert an address of the calling router into the address space of this router
+     * @param res the list of ranges in the address space of the calling router
+     */
+    void collect_ranges(uint64_t start, uint64_t end, uint64_t offset, std::vector<flat_entry>& res);
+    //! flatten the address maps of all routers this router is cascaded into as they hold copies of its ranges
+    void flatten_parent_maps() {
+        for(auto* p : parent_routers) {
+            p->flatten_address_map();
+            p->flatten_parent_maps();
+        }
+    }
+    //! check if this router or any router it is cascaded into is used in thread safe mode
+    bool is_thread_safe_cascade() const {
+        if(thread_safe)
+            return true;
+        for(auto* p : parent_routers)
+            if(p->is_thread_safe_cascade())
+                return true;
+        return false;
+    }
+    //! forward a blocking access to a target honoring its lock policy
+    void forward(size_t idx, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+        locked(idx, [this, idx, &trans, &delay]() { initiator[idx]->b_transport(trans, delay); });
+    }
+    //! execute a function while holding the target according to its lock policy
+    template <typename FUNC> void locked(size_t idx, FUNC f);
+    //! the last decoded address range of a target socket, start > end denotes an empty entry
+    struct decode_cache_entry {
+        uint64_t start{1}, end{0};
+        size_t idx{0};
+    };
+    /**
+     * @fn size_t decode(int, uint64_t)
+     * @brief find the initiator socket for an address checking the last hit of the target socket first
+     *
+     * @param i the index of the target socket
+     * @param address the address in the system address space
+     * @return the initiator index, addr_decoder.null_entry if no range is hit
+     */
+    size_t decode(int i, uint64_t address);
+    //! invalidate the decode caches of all target sockets
+    void invalidate_decode_cache() {
+        for(auto& e : decode_cache)
+            e = decode_cache_entry();
+        if(thread_safe)
+            publish_decode_table();
+    }
+    //! an immutable snapshot of the address map sorted by start address
+    struct decode_table {
+        std::vector<uint64_t> starts, ends;
+        std::vector<size_t> idx;
+    };
+    //! build a new decode table from the target ranges and replace the current one atomically
+    void publish_decode_table();
+    //! remember a DMI region granted or denied to a target socket, in system address space
+    void record_dmi_grant(size_t i, uint64_t start, uint64_t end);
+    //! forward an invalidation in system address space to all target sockets having requested DMI in the range
+    void invalidate_upstream(uint64_t start, uint64_t end);
+    //! forward the merged pending invalidations
+    void flush_dmi_invalidations();
     size_t default_idx = std::numeric_limits<size_t>::max();
     std::vector<uint64_t> ibases;
+    std::vector<decode_cache_entry> decode_cache;
     std::vector<range_entry> tranges;
     std::vector<sc_core::sc_mutex> mutexes;
+    std::vector<lock_policy> lock_policies;
+    //! the busy flags and number of waiting accesses of targets using the CHECKED policy
+    std::vector<bool> busy;
+    std::vector<unsigned> waiting;
+    std::vector<sc_core::sc_event> free_evt;
+    //! the host level lock flags of targets using the ATOMIC policy
+    std::unique_ptr<std::atomic<bool>[]> atomic_locks;
+    //! the thread running the SystemC kernel, the router is constructed during elaboration
+    const std::thread::id kernel_thread{std::this_thread::get_id()};
+    bool thread_safe{false};
+    //! the decode table used in thread safe mode, accessed using std::atomic_load/std::atomic_store only
+    std::shared_ptr<const decode_table> decode_tbl;
+    //! the granted DMI regions per initiator socket in system address space
+    std::vector<std::vector<tlm::tlm_dmi>> dmi_cache;
+    bool dmi_caching{true};
+    //! the DMI regions granted or denied per target socket in system address space, an initiator may cache a denial
+    //! until it gets an invalidation
+    std::vector<std::vector<std::pair<uint64_t, uint64_t>>> dmi_granted;
+    //! the invalidated ranges per target socket not yet forwarded
+    std::vector<std::vector<std::pair<uint64_t, uint64_t>>> dmi_pending;
+    //! guards dmi_granted and dmi_pending, the target sockets may be used by different threads in thread safe mode
+    std::mutex dmi_grant_mtx;
+    bool dmi_batching{false};
+    sc_core::sc_event dmi_flush_evt;
     util::range_lut<unsigned> addr_decoder;
     std::unordered_map<std::string, size_t> target_name_lut;
+    std::vector<sub_router> sub_routers;
+    //! the routers this router is cascaded into using bind_router()
+    std::vector<router*> parent_routers;
+    //! the flattened ranges per initiator socket sorted by start address, empty if no router is cascaded
+    std::vector<std::vector<flat_entry>> flat_map;
+    bool statistics{false};
+    std::vector<access_stats> stats;
+    //! the counters are shared by all target sockets, which may be used by different threads in thread safe mode
+    std::atomic<uint64_t> default_hits{0};
+    std::atomic<uint64_t> address_errors{0};
+    std::vector<std::unique_ptr<sc_variable_b>> stat_vars;
+    std::vector<batch_transport_if*> batch_targets;
+    //! the transactions per pair of target and initiator socket of the batches being processed
+    std::vector<std::vector<tlm::tlm_generic_payload*>> batch_groups;
 };
 
-template <unsigned BUSWIDTH>
-router<BUSWIDTH>::router(const sc_core::sc_module_name& nm, unsigned slave_cnt, unsigned master_cnt)
+template <unsigned BUSWIDTH, bool RECORDING>
+router<BUSWIDTH, RECORDING>::router(const sc_core::sc_module_name& nm, unsigned slave_cnt, unsigned master_cnt,
+                                    bool reg_b_transport)
 : sc_module(nm)
 , target("target", master_cnt)
 , initiator("intor", slave_cnt)
 , ibases(master_cnt)
+, decode_cache(master_cnt)
 , tranges(slave_cnt)
 , mutexes(slave_cnt)
+, lock_policies(slave_cnt, MUTEX)
+, busy(slave_cnt, false)
+, waiting(slave_cnt, 0)
+, free_evt(slave_cnt)
+, dmi_cache(slave_cnt)
+, dmi_granted(master_cnt)
+, dmi_pending(master_cnt)
+, flat_map(slave_cnt)
+, stats(master_cnt * slave_cnt)
+, batch_targets(slave_cnt, nullptr)
+, batch_groups(master_cnt * slave_cnt)
 , addr_decoder(std::numeric_limits<unsigned>::max()) {
     for(size_t i = 0; i < target.size(); ++i) {
-        target[i].register_b_transport([=](tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) -> void {
-            this->b_transport(i, trans, delay);
-        });
+        if(reg_b_transport)
+            target[i].template register_b_transport<router, &router::b_transport>(this, i);
         target[i].register_get_direct_mem_ptr([=](tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) -> bool {
             return this->get_direct_mem_ptr(i, trans, dmi_data);
         });
@@ -212,18 +554,46 @@ router<BUSWIDTH>::router(const sc_core::sc_module_name& nm, unsigned slave_cnt,
         tranges[i].size = 0ULL;
         tranges[i].remap = false;
     }
+    atomic_locks.reset(new std::atomic<bool>[slave_cnt]);
+    for(size_t i = 0; i < slave_cnt; ++i)
+        atomic_locks[i].store(false, std::memory_order_relaxed);
+    SC_HAS_PROCESS(router);
+    SC_METHOD(flush_dmi_invalidations);
+    sensitive << dmi_flush_evt;
+    dont_initialize();
 }
 
-template <unsigned BUSWIDTH>
-void router<BUSWIDTH>::set_target_range(size_t idx, uint64_t base, uint64_t size, bool remap) {
+template <unsigned BUSWIDTH, bool RECORDING>
+void router<BUSWIDTH, RECORDING>::set_target_range(size_t idx, uint64_t base, uint64_t size, bool remap) {
     tranges[idx].base = base;
     tranges[idx].size = size;
     tranges[idx].remap = remap;
     addr_decoder.addEntry(idx, base, size);
+    invalidate_decode_cache();
 }
 
-template <unsigned BUSWIDTH>
-void router<BUSWIDTH>::add_target_range(std::string name, uint64_t base, uint64_t size, bool remap) {
+template <unsigned BUSWIDTH, bool RECORDING>
+void router<BUSWIDTH, RECORDING>::remap_target_range(size_t idx, uint64_t base, uint64_t size) {
+    if(is_thread_safe_cascade() && sc_core::sc_is_running()) {
+        SCCERR(SCMOD) << "the address map of a thread safe router cannot be changed during simulation";
+        return;
+    }
+    auto old_base = tranges[idx].base;
+    auto old_end = tranges[idx].base + tranges[idx].size - 1;
+    if(!addr_decoder.remap(idx, base, size))
+        addr_decoder.addEntry(idx, base, size);
+    tranges[idx].base = base;
+    tranges[idx].size = size;
+    invalidate_decode_cache();
+    flatten_address_map();
+    flatten_parent_maps();
+    dmi_cache[idx].clear();
+    if(old_end >= old_base && sc_core::sc_is_running())
+        invalidate_upstream(old_base, old_end);
+}
+
+template <unsigned BUSWIDTH, bool RECORDING>
+void router<BUSWIDTH, RECORDING>::add_target_range(std::string name, uint64_t base, uint64_t size, bool remap) {
     auto it = target_name_lut.find(name);
 #ifndef NDEBUG
 #if(SYSTEMC_VERSION >= 20171012)
@@ -241,39 +611,258 @@ void router<BUSWIDTH>::add_target_range(std::string name, uint64_t base, uint64_
     tranges[idx].size = size;
     tranges[idx].remap = remap;
     addr_decoder.addEntry(idx, base, size);
+    invalidate_decode_cache();
+}
+
+template <unsigned BUSWIDTH, bool RECORDING> void router<BUSWIDTH, RECORDING>::flatten_address_map() {
+    SCC_PROFILE_SCOPE("scc::router::flatten_address_map");
+    for(auto& e : flat_map)
+        e.clear();
+    for(auto& s : sub_routers) {
+        auto& r = tranges[s.idx];
+        if(!r.size)
+            continue;
+        // convert an address of this router into the system address space of the cascaded router
+        uint64_t offset = s.rtr->ibases[s.sub_idx] - (r.remap ? r.base : 0);
+        uint64_t start = r.base + offset;
+        uint64_t end = r.base + r.size - 1 + offset;
+        if(end < start)
+            continue;
+        s.rtr->collect_ranges(start, end, offset, flat_map[s.idx]);
+        std::sort(flat_map[s.idx].begin(), flat_map[s.idx].end(),
+                  [](flat_entry const& a, flat_entry const& b) { return a.start < b.start; });
+    }
+}
+
+template <unsigned BUSWIDTH, bool RECORDING>
+void router<BUSWIDTH, RECORDING>::collect_ranges(uint64_t start, uint64_t end, uint64_t offset,
+                                                 std::vector<flat_entry>& res) {
+    for(size_t k = 0; k < tranges.size(); ++k) {
+        auto& r = tranges[k];
+        if(!r.size)
+            continue;
+        auto lo = std::max(start, r.base);
+        auto hi = std::min(end, r.base + r.size - 1);
+        if(lo > hi)
+            continue;
+        auto it = std::find_if(sub_routers.begin(), sub_routers.end(), [k](sub_router const& s) { return s.idx == k; });
+        if(it != sub_routers.end()) {
+            uint64_t sub_offset = it->rtr->ibases[it->sub_idx] - (r.remap ? r.base : 0);
+            if(hi + sub_offset < lo + sub_offset)
+                continue;
+            it->rtr->collect_ranges(lo + sub_offset, hi + sub_offset, offset + sub_offset, res);
+        } else
+            res.emplace_back(flat_entry{lo - offset, hi - offset, this, k, offset - (r.remap ? r.base : 0)});
+    }
+}
+
+template <unsigned BUSWIDTH, bool RECORDING> void router<BUSWIDTH, RECORDING>::publish_decode_table() {
+    using lut_type = util::range_lut<unsigned>;
+    // the address decoder holds all ranges including the ones added by add_target_range(), sorted by address
+    auto tbl = std::make_shared<decode_table>();
+    for(auto it = addr_decoder.begin(); it != addr_decoder.end(); ++it) {
+        if(it->second.index == addr_decoder.null_entry)
+            continue;
+        switch(it->second.type) {
+        case lut_type::SINGLE_BYTE_RANGE:
+            tbl->starts.push_back(it->first);
+            tbl->ends.push_back(it->first);
+            tbl->idx.push_back(it->second.index);
+            break;
+        case lut_type::BEGIN_RANGE:
+            tbl->starts.push_back(it->first);
+            tbl->idx.push_back(it->second.index);
+            break;
+        case lut_type::END_RANGE:
+            tbl->ends.push_back(it->first);
+            break;
+        }
+    }
+    std::atomic_store(&decode_tbl, std::shared_ptr<const decode_table>(tbl));
+}
+
+template <unsigned BUSWIDTH, bool RECORDING>
+inline size_t router<BUSWIDTH, RECORDING>::decode(int i, uint64_t address) {
+    SCC_SPAN("router.decode");
+    if(thread_safe) {
+        auto tbl = std::atomic_load(&decode_tbl);
+        auto it = std::upper_bound(tbl->starts.begin(), tbl->starts.end(), address);
+        if(it == tbl->starts.begin())
+            return addr_decoder.null_entry;
+        auto pos = std::distance(tbl->starts.begin(), it) - 1;
+        return address <= tbl->ends[pos] ? tbl->idx[pos] : addr_decoder.null_entry;
+    }
+    auto& cache = decode_cache[i];
+    if(address >= cache.start && address <= cache.end)
+        return cache.idx;
+    size_t idx = addr_decoder.getEntry(address);
+    if(idx == addr_decoder.null_entry)
+        return idx;
+    cache.start = tranges[idx].base;
+    cache.end = tranges[idx].base + tranges[idx].size - 1;
+    cache.idx = idx;
+    return idx;
 }
 
-template <unsigned BUSWIDTH>
-void router<BUSWIDTH>::b_transport(int i, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+template <unsigned BUSWIDTH, bool RECORDING>
+void router<BUSWIDTH, RECORDING>::b_transport(int i, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
     ::sc_dt::uint64 address = trans.get_address();
     if(ibases[i]) {
         address += ibases[i];
         trans.set_address(address);
     }
-    size_t idx = addr_decoder.getEntry(address);
+    size_t idx = decode(i, address);
+    auto start_delay = delay;
     if(idx == addr_decoder.null_entry) {
         if(default_idx == std::numeric_limits<size_t>::max()) {
+            if(statistics)
+                address_errors.fetch_add(1, std::memory_order_relaxed);
             trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
             return;
         }
+        if(statistics)
+            default_hits.fetch_add(1, std::memory_order_relaxed);
         idx = default_idx;
     } else {
+        auto& ranges = flat_map[idx];
+        if(ranges.size()) {
+            auto it = std::upper_bound(ranges.begin(), ranges.end(), address,
+                                       [](uint64_t a, flat_entry const& e) { return a < e.start; });
+            if(it != ranges.begin() && address <= (--it)->end) {
+                // Forward transaction directly to the target of the cascaded router
+                trans.set_address(address + it->offset);
+                it->rtr->forward(it->idx, trans, delay);
+                if(statistics)
+                    record(i, idx, trans, start_delay, delay);
+                return;
+            }
+        }
         // Modify address within transaction
         trans.set_address(address - (tranges[idx].remap ? tranges[idx].base : 0));
     }
     // Forward transaction to appropriate target
-    mutexes[idx].lock();
-    initiator[idx]->b_transport(trans, delay);
-    mutexes[idx].unlock();
+    forward(idx, trans, delay);
+    if(statistics)
+        record(i, idx, trans, start_delay, delay);
+}
+
+template <unsigned BUSWIDTH, bool RECORDING> void router<BUSWIDTH, RECORDING>::before_end_of_elaboration() {
+    if(!statistics)
+        return;
+    for(size_t i = 0; i < target.size(); ++i)
+        for(size_t idx = 0; idx < initiator.size(); ++idx) {
+            auto& s = stats[i * initiator.size() + idx];
+            std::string prefix = "stat_" + std::to_string(i) + "_" + std::to_string(idx) + "_";
+            stat_vars.emplace_back(new sc_ref_variable<uint64_t>(prefix + "count", s.count));
+            stat_vars.emplace_back(new sc_ref_variable<uint64_t>(prefix + "bytes", s.bytes));
+            stat_vars.emplace_back(new sc_ref_variable<sc_core::sc_time>(prefix + "delay", s.delay));
+        }
+    stat_vars.emplace_back(new sc_ref_variable<std::atomic<uint64_t>>("stat_default_hits", default_hits));
+    stat_vars.emplace_back(new sc_ref_variable<std::atomic<uint64_t>>("stat_address_errors", address_errors));
+}
+
+template <unsigned BUSWIDTH, bool RECORDING>
+void router<BUSWIDTH, RECORDING>::b_transport_batch(int i, tlm::tlm_generic_payload** trans, size_t count,
+                                         sc_core::sc_time& delay) {
+    for(size_t n = 0; n < count; ++n) {
+        auto& t = *trans[n];
+        ::sc_dt::uint64 address = t.get_address();
+        if(ibases[i]) {
+            address += ibases[i];
+            t.set_address(address);
+        }
+        size_t idx = decode(i, address);
+        if(idx == addr_decoder.null_entry) {
+            if(default_idx == std::numeric_limits<size_t>::max()) {
+                if(statistics)
+                    address_errors.fetch_add(1, std::memory_order_relaxed);
+                t.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+                continue;
+            }
+            if(statistics)
+                default_hits.fetch_add(1, std::memory_order_relaxed);
+            idx = default_idx;
+        } else if(flat_map[idx].size()) {
+            // let the cascaded routers handle it
+            if(ibases[i])
+                t.set_address(address - ibases[i]);
+            b_transport(i, t, delay);
+            continue;
+        } else
+            t.set_address(address - (tranges[idx].remap ? tranges[idx].base : 0));
+        batch_groups[i * initiator.size() + idx].push_back(&t);
+    }
+    for(size_t idx = 0; idx < initiator.size(); ++idx) {
+        auto& group = batch_groups[i * initiator.size() + idx];
+        if(group.empty())
+            continue;
+        auto start_delay = delay;
+        if(batch_targets[idx])
+            locked(idx, [this, idx, &group, &delay]() {
+                batch_targets[idx]->b_transport_batch(group.data(), group.size(), delay);
+            });
+        else
+            for(auto* t : group)
+                forward(idx, *t, delay);
+        if(statistics) {
+            auto& s = stats[i * initiator.size() + idx];
+            s.count += group.size();
+            for(auto* t : group)
+                s.bytes += t->get_data_length();
+            s.delay += delay - start_delay;
+        }
+        group.clear();
+    }
+}
+
+template <unsigned BUSWIDTH, bool RECORDING> template <typename FUNC>
+void router<BUSWIDTH, RECORDING>::locked(size_t idx, FUNC f) {
+    switch(lock_policies[idx]) {
+    case MUTEX:
+        mutexes[idx].lock();
+        f();
+        mutexes[idx].unlock();
+        break;
+    case CHECKED:
+        while(busy[idx]) {
+            ++waiting[idx];
+            sc_core::wait(free_evt[idx]);
+            --waiting[idx];
+        }
+        busy[idx] = true;
+        f();
+        busy[idx] = false;
+        if(waiting[idx])
+            free_evt[idx].notify(sc_core::SC_ZERO_TIME);
+        break;
+    case ATOMIC: {
+        // a SystemC process may call wait() while holding the flag, so a second process of the kernel thread
+        // spinning on it would never let the first one resume. The processes are serialized by the mutex and only
+        // host threads outside the kernel compete for the flag
+        auto in_kernel = std::this_thread::get_id() == kernel_thread;
+        if(in_kernel)
+            mutexes[idx].lock();
+        while(atomic_locks[idx].exchange(true, std::memory_order_acquire))
+            std::this_thread::yield();
+        f();
+        atomic_locks[idx].store(false, std::memory_order_release);
+        if(in_kernel)
+            mutexes[idx].unlock();
+        break;
+    }
+    default:
+        f();
+        break;
+    }
 }
-template <unsigned BUSWIDTH>
-bool router<BUSWIDTH>::get_direct_mem_ptr(int i, tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
+template <unsigned BUSWIDTH, bool RECORDING>
+bool router<BUSWIDTH, RECORDING>::get_direct_mem_ptr(int i, tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) {
     ::sc_dt::uint64 address = trans.get_address();
     if(ibases[i]) {
         address += ibases[i];
         trans.set_address(address);
     }
-    size_t idx = addr_decoder.getEntry(address);
+    size_t idx = decode(i, address);
     if(idx == addr_decoder.null_entry) {
         if(default_idx == std::numeric_limits<size_t>::max()) {
             trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
@@ -284,20 +873,45 @@ bool router<BUSWIDTH>::get_direct_mem_ptr(int i, tlm::tlm_generic_payload& trans
         // Modify address within transaction
         trans.set_address(address - (tranges[idx].remap ? tranges[idx].base : 0));
     }
+    if(dmi_caching) {
+        auto cmd = trans.get_command();
+        for(auto& e : dmi_cache[idx]) {
+            if(address >= e.get_start_address() && address <= e.get_end_address() &&
+               (cmd != tlm::TLM_READ_COMMAND || e.is_read_allowed()) &&
+               (cmd != tlm::TLM_WRITE_COMMAND || e.is_write_allowed())) {
+                dmi_data = e;
+                record_dmi_grant(i, e.get_start_address(), e.get_end_address());
+                dmi_data.set_start_address(e.get_start_address() - ibases[i]);
+                dmi_data.set_end_address(e.get_end_address() - ibases[i]);
+                trans.set_dmi_allowed(true);
+                return true;
+            }
+        }
+    }
     bool status = initiator[idx]->get_direct_mem_ptr(trans, dmi_data);
     // Calculate DMI address of target in system address space
     auto offset = tranges[idx].remap ? tranges[idx].base : 0;
-    dmi_data.set_start_address(dmi_data.get_start_address() - ibases[i] + offset);
-    dmi_data.set_end_address(dmi_data.get_end_address() - ibases[i] + offset);
+    auto end = dmi_data.get_end_address() + offset;
+    dmi_data.set_start_address(dmi_data.get_start_address() + offset);
+    // a denial usually covers the whole address space
+    dmi_data.set_end_address(end < dmi_data.get_end_address() ? std::numeric_limits<::sc_dt::uint64>::max() : end);
+    if(status && dmi_caching)
+        dmi_cache[idx].push_back(dmi_data);
+    // denials are recorded as well since the initiator may retry only after an invalidation
+    record_dmi_grant(i, dmi_data.get_start_address(), dmi_data.get_end_address());
+    auto start = dmi_data.get_start_address();
+    dmi_data.set_start_address(start > ibases[i] ? start - ibases[i] : 0);
+    dmi_data.set_end_address(dmi_data.get_end_address() - ibases[i]);
     return status;
 }
-template <unsigned BUSWIDTH> unsigned router<BUSWIDTH>::transport_dbg(int i, tlm::tlm_generic_payload& trans) {
+template <unsigned BUSWIDTH, bool RECORDING>
+unsigned router<BUSWIDTH, RECORDING>::transport_dbg(int i, tlm::tlm_generic_payload& trans) {
     ::sc_dt::uint64 address = trans.get_address();
     if(ibases[i]) {
         address += ibases[i];
         trans.set_address(address);
     }
-    size_t idx = addr_decoder.getEntry(address);
+    size_t idx = decode(i, address);
     if(idx == addr_decoder.null_entry) {
         if(default_idx == std::numeric_limits<size_t>::max()) {
             trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
@@ -311,8 +925,9 @@ template <unsigned BUSWIDTH> unsigned router<BUSWIDTH>::transport_dbg(int i, tlm
     // Forward debug transaction to appropriate target
     return initiator[idx]->transport_dbg(trans);
 }
-template <unsigned BUSWIDTH>
-void router<BUSWIDTH>::invalidate_direct_mem_ptr(int id, ::sc_dt::uint64 start_range, ::sc_dt::uint64 end_range) {
+template <unsigned BUSWIDTH, bool RECORDING>
+void router<BUSWIDTH, RECORDING>::invalidate_direct_mem_ptr(int id, ::sc_dt::uint64 start_range,
+                                                            ::sc_dt::uint64 end_range) {
     // Reconstruct address range in system memory map
     ::sc_dt::uint64 bw_start_range = start_range;
     if(tranges[id].remap)
@@ -320,8 +935,76 @@ void router<BUSWIDTH>::invalidate_direct_mem_ptr(int id, ::sc_dt::uint64 start_r
     ::sc_dt::uint64 bw_end_range = end_range;
     if(tranges[id].remap)
         bw_end_range += tranges[id].base;
+    // remove all cached regions overlapping the invalidated range
+    auto cache_end = bw_end_range < bw_start_range ? std::numeric_limits<::sc_dt::uint64>::max() : bw_end_range;
+    auto& cache = dmi_cache[id];
+    cache.erase(std::remove_if(cache.begin(), cache.end(),
+                               [bw_start_range, cache_end](tlm::tlm_dmi const& e) {
+                                   return e.get_start_address() <= cache_end && e.get_end_address() >= bw_start_range;
+                               }),
+                cache.end());
+    invalidate_upstream(bw_start_range, cache_end);
+}
+template <unsigned BUSWIDTH, bool RECORDING>
+void router<BUSWIDTH, RECORDING>::record_dmi_grant(size_t i, uint64_t start, uint64_t end) {
+    std::lock_guard<std::mutex> lock(dmi_grant_mtx);
+    auto& granted = dmi_granted[i];
+    for(auto& e : granted)
+        if(e.first <= start && e.second >= end)
+            return;
+    granted.emplace_back(start, end);
+}
+template <unsigned BUSWIDTH, bool RECORDING>
+void router<BUSWIDTH, RECORDING>::invalidate_upstream(uint64_t start, uint64_t end) {
+    // the invalidations are issued without holding the lock as the initiators may request DMI again right away
+    std::vector<size_t> affected;
+    auto batched = dmi_batching && sc_core::sc_is_running();
+    {
+        std::lock_guard<std::mutex> lock(dmi_grant_mtx);
+        for(size_t i = 0; i < target.size(); ++i) {
+            auto& granted = dmi_granted[i];
+            auto it = std::remove_if(granted.begin(), granted.end(),
+                                     [start, end](std::pair<uint64_t, uint64_t> const& e) {
+                                         return e.first <= end && e.second >= start;
+                                     });
+            // the initiators of this socket never requested DMI in the range
+            if(it == granted.end())
+                continue;
+            granted.erase(it, granted.end());
+            if(batched)
+                dmi_pending[i].emplace_back(start, end);
+            else
+                affected.push_back(i);
+        }
+    }
+    if(batched)
+        dmi_flush_evt.notify(sc_core::SC_ZERO_TIME);
+    for(auto i : affected)
+        target[i]->invalidate_direct_mem_ptr(start - ibases[i], end - ibases[i]);
+}
+template <unsigned BUSWIDTH, bool RECORDING>
+void router<BUSWIDTH, RECORDING>::flush_dmi_invalidations() {
     for(size_t i = 0; i < target.size(); ++i) {
-        target[i]->invalidate_direct_mem_ptr(bw_start_range - ibases[i], bw_end_range - ibases[i]);
+        std::vector<std::pair<uint64_t, uint64_t>> pending;
+        {
+            std::lock_guard<std::mutex> lock(dmi_grant_mtx);
+            pending.swap(dmi_pending[i]);
+        }
+        if(pending.empty())
+            continue;
+        std::sort(pending.begin(), pending.end());
+        auto start = pending.front().first;
+        auto end = pending.front().second;
+        for(auto& e : pending) {
+            // merge overlapping and adjacent ranges
+            if(end != std::numeric_limits<uint64_t>::max() && e.first > end + 1) {
+                target[i]->invalidate_direct_mem_ptr(start - ibases[i], end - ibases[i]);
+                start = e.first;
+                end = e.second;
+            } else
+                end = std::max(end, e.second);
+        }
+        target[i]->invalidate_direct_mem_ptr(start - ibases[i], end - ibases[i]);
     }
 }
 
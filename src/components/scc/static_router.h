@@ -0,0 +1,139 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SYSC_STATIC_ROUTER_H_
+#define _SYSC_STATIC_ROUTER_H_
+
+#include "router.h"
+
+namespace scc {
+/**
+ * @struct static_range
+ * @brief an entry of a compile time address map
+ */
+struct static_range {
+    //! base address of the target
+    uint64_t base;
+    //! size of the address range occupied by the target
+    uint64_t size;
+    //! number of the target (initiator socket of the router)
+    size_t idx;
+    //! if true address will be rewritten in accesses to be 0-based at the target
+    bool remap;
+};
+/**
+ * @class static_router
+ * @brief a router using an address map known at compile time
+ *
+ * The address map is given as reference to a constexpr array of ranges sorted by base address. Blocking accesses are
+ * decoded using a binary search which is unrolled at compile time into a tree of compares against constants. The
+ * router has the same interface as \ref scc::router, the address map is registered with it so that DMI,
+ * debug accesses and DMI invalidation behave the same. Therefore targets are bound directly to the initiator sockets
+ * instead of using bind_target(). Example:
+ * @code
+ * constexpr scc::static_range mem_map[] = {{0x0, 0x1000, 0, true}, {0x10000, 0x100, 1, true}};
+ * scc::static_router<scc::LT, 2, mem_map> rtr{"rtr", 2, 1};
+ * rtr.initiator[0](mem.target);
+ * @endcode
+ *
+ * @tparam BUSWIDTH the width of the bus
+ * @tparam N the number of address ranges
+ * @tparam MAP the address map
+ */
+template <unsigned BUSWIDTH, size_t N, const static_range (&MAP)[N]> class static_router : public router<BUSWIDTH> {
+    static_assert(N > 0, "the address map of a static_router must not be empty");
+
+    static constexpr bool is_sorted(size_t i = 0) {
+        return i + 1 >= N || (MAP[i].base + MAP[i].size <= MAP[i + 1].base && is_sorted(i + 1));
+    }
+
+public:
+    /**
+     * @fn  static_router(const sc_core::sc_module_name&, unsigned=1, unsigned=1)
+     * @brief constructs a router
+     *
+     * @param nm the component name
+     * @param slave_cnt number of slaves to be connected
+     * @param master_cnt number of masters to be connected
+     */
+    static_router(const sc_core::sc_module_name& nm, unsigned slave_cnt = 1, unsigned master_cnt = 1)
+    : router<BUSWIDTH>(nm, slave_cnt, master_cnt, false) {
+        static_assert(is_sorted(), "the address map of a static_router needs to be sorted and must not overlap");
+        for(auto& e : MAP)
+            router<BUSWIDTH>::set_target_range(e.idx, e.base, e.size, e.remap);
+        // the router does not register its blocking transport so the compile time decoder is used
+        for(size_t i = 0; i < this->target.size(); ++i)
+            this->target[i].template register_b_transport<static_router, &static_router::b_transport>(this, i);
+    }
+    /**
+     * @fn void b_transport(int, tlm::tlm_generic_payload&, sc_core::sc_time&)
+     * @brief tagged blocking transport method using the compile time address map
+     *
+     * @param i the tag
+     * @param trans the incoming transaction
+     * @param delay the annotated delay
+     */
+    void b_transport(int i, tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+        ::sc_dt::uint64 address = trans.get_address();
+        if(this->ibases[i]) {
+            address += this->ibases[i];
+            trans.set_address(address);
+        }
+        auto pos = decoder<0, N>::find(address);
+        auto start_delay = delay;
+        size_t idx;
+        if(pos == N) {
+            if(this->default_idx == std::numeric_limits<size_t>::max()) {
+                if(this->statistics)
+                    this->address_errors.fetch_add(1, std::memory_order_relaxed);
+                trans.set_response_status(tlm::TLM_ADDRESS_ERROR_RESPONSE);
+                return;
+            }
+            if(this->statistics)
+                this->default_hits.fetch_add(1, std::memory_order_relaxed);
+            idx = this->default_idx;
+        } else {
+            idx = MAP[pos].idx;
+            // Modify address within transaction
+            trans.set_address(address - (MAP[pos].remap ? MAP[pos].base : 0));
+        }
+        // Forward transaction to appropriate target
+        this->forward(idx, trans, delay);
+        if(this->statistics)
+            this->record(i, idx, trans, start_delay, delay);
+    }
+
+private:
+    //! binary search over the address map entries [L, H), returns N if no range is hit
+    template <size_t L, size_t H, bool LEAF = (H - L == 1)> struct decoder {
+        static size_t find(uint64_t addr) {
+            return addr < MAP[(L + H) / 2].base ? decoder<L, (L + H) / 2>::find(addr)
+                                                 : decoder<(L + H) / 2, H>::find(addr);
+        }
+    };
+    template <size_t L, size_t H> struct decoder<L, H, true> {
+        static size_t find(uint64_t addr) {
+            return addr >= MAP[L].base && addr - MAP[L].base < MAP[L].size ? L : N;
+        }
+    };
+    // the ranges are fixed
+    void set_target_range(size_t, uint64_t, uint64_t, bool) = delete;
+    void remap_target_range(size_t, uint64_t, uint64_t) = delete;
+};
+
+} // namespace scc
+
+#endif /* _SYSC_STATIC_ROUTER_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2018 MINRES Technologies GmbH
+ * Copyright 2016-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,12 +18,20 @@
 #define _SYSC_TLM_TARGET_H_
 
 #include "resource_access_if.h"
+#include "resource_profile.h"
 #include <scc/utilities.h>
+#include <tlm/scc/quantum_keeper.h>
 #include <tlm/scc/target_mixin.h>
 #include <tlm/scc/scv/tlm_rec_target_socket.h>
 #include <util/range_lut.h>
+#include <algorithm>
 #include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <numeric>
+#include <string>
+#include <vector>
 
 namespace scc {
 /**
@@ -44,6 +52,8 @@ struct addr_range {
 template <unsigned int BUSWIDTH = LT, unsigned int ADDR_UNIT_WIDTH = 8> class tlm_target {
 public:
     using this_type = tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>;
+    //! the direct memory accesses granted to resources without side effects (see resource_access_if::get_dmi_ptr())
+    enum dmi_mode_e { NO_DMI, READ_DMI, READ_WRITE_DMI };
     /**
      * @fn  tlm_target(sc_core::sc_time&)
      * @brief the constructor
@@ -51,11 +61,12 @@ public:
      * @param clock the clock period of the component
      */
     tlm_target(sc_core::sc_time& clock);
-    //! the target socket
-    tlm::scc::target_mixin<tlm::scc::scv::tlm_rec_target_socket<BUSWIDTH>> socket;
+    //! the target socket, a recording one unless disabled by the CMake option SCC_TLM_RECORDING
+    tlm::scc::target_mixin<tlm::scc::scv::target_socket_select<BUSWIDTH>> socket;
     /**
      * @fn void b_tranport_cb(tlm::tlm_generic_payload&, sc_core::sc_time&)
-     * @brief the blocking transport callback
+     * @brief the blocking transport callback. Accesses larger than the addressed resource are split into accesses to
+     * the consecutive resources
      *
      * @param gp the generic payload
      * @param d the delay in the local time domain
@@ -63,12 +74,47 @@ public:
     void b_tranport_cb(tlm::tlm_generic_payload& gp, sc_core::sc_time& d);
     /**
      * @fn unsigned int tranport_dbg_cb(tlm::tlm_generic_payload&)
-     * @brief the debug transport callback
+     * @brief the debug transport callback. Accesses may span several complete resources, they are handled in
+     * ascending address order until the first resource failing
      *
      * @param gp the generic payload
      * @return number of transferred bytes
      */
     unsigned int tranport_dbg_cb(tlm::tlm_generic_payload& gp);
+    /**
+     * @fn bool get_direct_mem_ptr_cb(tlm::tlm_generic_payload&, tlm::tlm_dmi&)
+     * @brief the DMI callback, grants access to the largest contiguous storage of resources without side effects
+     * around the requested address
+     *
+     * @param gp the generic payload
+     * @param dmi the DMI descriptor
+     * @return true if access is granted
+     */
+    bool get_direct_mem_ptr_cb(tlm::tlm_generic_payload& gp, tlm::tlm_dmi& dmi);
+    /**
+     * @fn void set_dmi_mode(dmi_mode_e)
+     * @brief enable DMI to the resources, disabled by default. Granted accesses are invalidated as soon as a
+     * callback is registered at one of the resources
+     *
+     * @param mode the accesses being granted
+     */
+    void set_dmi_mode(dmi_mode_e mode) {
+        if(mode < dmi_mode)
+            invalidate_dmi();
+        dmi_mode = mode;
+    }
+    /**
+     * @fn void set_sync_hint(tlm::scc::quantum_manager::sync_hint)
+     * @brief set the synchronization hint given for each blocking access (see tlm::scc::quantum_manager)
+     *
+     * A target whose registers only annotate their latency sets tlm::scc::quantum_manager::sync_hint::ANNOTATE so
+     * that initiators using tlm::scc::initiator_mixin::b_transport_td() do not wait after each access. A callback of
+     * a register having a side effect on the timing of other components can override this per access by calling
+     * tlm::scc::quantum_manager::get().request_sync().
+     *
+     * @param hint the hint, NONE (the default) gives no hint
+     */
+    void set_sync_hint(tlm::scc::quantum_manager::sync_hint hint) { sync_hint = hint; }
     /**
      * @fn void addResource(resource_access_if&, uint64_t)
      * @brief add a resource to this target at a certain address within the socket address range
@@ -79,6 +125,9 @@ public:
     void addResource(resource_access_if& rai, uint64_t base_addr) {
         socket_map.addEntry(std::make_pair(&rai, base_addr), base_addr,
                             std::max<size_t>(1, rai.size() / (ADDR_UNIT_WIDTH / 8)));
+        rai.set_dmi_invalidate_cb([this]() { this->invalidate_dmi(); });
+        dense_dirty = true;
+        invalidate_dmi();
     }
     /**
      * @fn void addResource(indexed_resource_access_if&, uint64_t)
@@ -90,15 +139,108 @@ public:
         for(size_t idx = 0; idx < irai.size(); ++idx) {
             auto irai_size = std::max<size_t>(1, irai[idx].size() / (ADDR_UNIT_WIDTH / 8));
             socket_map.addEntry(std::make_pair(&irai[idx], base_addr), base_addr, irai_size);
+            irai[idx].set_dmi_invalidate_cb([this]() { this->invalidate_dmi(); });
             base_addr += irai_size;
         }
+        dense_dirty = true;
+        invalidate_dmi();
     }
 
+    /**
+     * @brief the access counters of a resource
+     */
+    struct access_profile {
+        //! the base address of the resource
+        uint64_t address;
+        //! the hierarchical name of the resource if it is an sc_object
+        std::string name;
+        uint64_t reads;
+        uint64_t writes;
+        //! the number of accesses invoking callbacks and the host time spent in them
+        uint64_t callbacks;
+        uint64_t callback_ns;
+    };
+    /**
+     * get the access counters of the resources, the most frequently accessed ones first. The registers collect them
+     * only if SCC_REGISTER_PROFILING is defined (CMake option SCC_REGISTER_PROFILING), otherwise the result is empty
+     */
+    std::vector<access_profile> get_access_profile() const;
+
 private:
     sc_core::sc_time& clk;
+    tlm::scc::quantum_manager::sync_hint sync_hint{tlm::scc::quantum_manager::sync_hint::NONE};
 
 protected:
-    util::range_lut<std::pair<resource_access_if*, uint64_t>> socket_map;
+    using resource_entry = std::pair<resource_access_if*, uint64_t>;
+    //! the maximum number of slots of the direct mapped register window
+    static constexpr size_t max_dense_slots = 4096;
+    /**
+     * get the resource mapped at an address. If the resources are densely packed the direct mapped window is used,
+     * socket_map otherwise
+     */
+    resource_entry get_resource(uint64_t addr) {
+        if(dense_dirty)
+            build_dense_map();
+        if(dense_map.empty())
+            return socket_map.getEntry(addr);
+        // addresses below dense_base wrap around and yield an index beyond the window
+        auto idx = (addr - dense_base) >> dense_shift;
+        return idx < dense_map.size() ? dense_map[idx] : socket_map.null_entry;
+    }
+    /**
+     * build the direct mapped window covering all resources. A slot spans 2^dense_shift address units, at most a bus
+     * word, so that no slot is shared by two resources. The window is not used if it would exceed max_dense_slots
+     */
+    void build_dense_map();
+    /**
+     * get the range of enabled bytes
+     *
+     * @param be the byte enables
+     * @param len the number of byte enables
+     * @param lower the first enabled byte
+     * @param count the number of enabled bytes
+     * @return false if the enabled bytes are not contiguous
+     */
+    static bool get_enabled_bytes(const unsigned char* be, unsigned len, unsigned& lower, unsigned& count);
+    /**
+     * iterate over the resources covering length bytes starting at addr in ascending address order
+     *
+     * @param addr the start address
+     * @param length the number of bytes
+     * @param f the function being called with the resource, the byte offset within the resource, the byte offset
+     * within the range and the number of bytes falling into the resource. Returning false stops the iteration
+     * @return false if the iteration stopped early or a part of the range is not mapped
+     */
+    template <typename F> bool for_each_resource(uint64_t addr, unsigned length, F f);
+    /**
+     * handle an access spanning several resources. The resources are accessed in ascending address order, each one
+     * once with the (enabled) bytes it holds. Unmapped gaps and non-contiguous byte enables within a resource are
+     * detected before any resource is accessed, if a resource fails the access stops there and the preceding ones
+     * keep their effect
+     */
+    void burst_transport(tlm::tlm_generic_payload& gp, sc_core::sc_time& delay);
+    //! get the address ranges (first and last address) of all resources sorted by address
+    std::vector<std::pair<uint64_t, uint64_t>> get_ranges() const;
+    //! get the DMI pointer of a resource, resources being profiled need to see each access
+    static uint8_t* get_dmi_ptr(resource_access_if* ra, bool write) {
+        return ra->get_profile() ? nullptr : ra->get_dmi_ptr(write);
+    }
+    //! revoke all granted DMI pointers
+    void invalidate_dmi() {
+        if(dmi_granted) {
+            dmi_granted = false;
+            socket->invalidate_direct_mem_ptr(0, std::numeric_limits<sc_dt::uint64>::max());
+        }
+    }
+
+    util::range_lut<resource_entry> socket_map;
+    //! the direct mapped view of socket_map, empty if the resources are too sparse
+    std::vector<resource_entry> dense_map;
+    uint64_t dense_base{0};
+    unsigned dense_shift{0};
+    bool dense_dirty{true};
+    dmi_mode_e dmi_mode{NO_DMI};
+    bool dmi_granted{false};
 };
 /**
  * helper structure to define a address range for a socket
@@ -132,56 +274,159 @@ inline scc::tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>::tlm_target(sc_core::sc_time&
     socket.register_b_transport(
         [=](tlm::tlm_generic_payload& gp, sc_core::sc_time& delay) -> void { this->b_tranport_cb(gp, delay); });
     socket.register_transport_dbg([=](tlm::tlm_generic_payload& gp) -> unsigned { return this->tranport_dbg_cb(gp); });
+    socket.register_get_direct_mem_ptr([=](tlm::tlm_generic_payload& gp, tlm::tlm_dmi& dmi) -> bool {
+        return this->get_direct_mem_ptr_cb(gp, dmi);
+    });
+}
+
+template <unsigned int BUSWIDTH, unsigned int ADDR_UNIT_WIDTH>
+auto scc::tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>::get_ranges() const -> std::vector<std::pair<uint64_t, uint64_t>> {
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    for(auto it = socket_map.begin(); it != socket_map.end(); ++it) {
+        if(it->second.index == socket_map.null_entry)
+            continue;
+        if(it->second.type == util::range_lut<resource_entry>::SINGLE_BYTE_RANGE)
+            ranges.emplace_back(it->first, it->first);
+        else if(it->second.type == util::range_lut<resource_entry>::BEGIN_RANGE)
+            ranges.emplace_back(it->first, it->first);
+        else if(!ranges.empty())
+            ranges.back().second = it->first;
+    }
+    return ranges;
+}
+
+template <unsigned int BUSWIDTH, unsigned int ADDR_UNIT_WIDTH>
+auto scc::tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>::get_access_profile() const -> std::vector<access_profile> {
+    std::vector<access_profile> res;
+    for(auto& r : get_ranges()) {
+        auto entry = socket_map.getEntry(r.first);
+        auto* profile = entry.first ? entry.first->get_profile() : nullptr;
+        if(!profile)
+            continue;
+        auto* obj = dynamic_cast<const sc_core::sc_object*>(entry.first);
+        res.push_back(access_profile{entry.second, obj ? obj->name() : std::string(),
+                                     profile->reads.count.load(std::memory_order_relaxed),
+                                     profile->writes.count.load(std::memory_order_relaxed),
+                                     profile->callback_time.count.load(std::memory_order_relaxed),
+                                     profile->callback_time.sum.load(std::memory_order_relaxed)});
+    }
+    std::stable_sort(res.begin(), res.end(), [](access_profile const& a, access_profile const& b) {
+        return a.reads + a.writes > b.reads + b.writes;
+    });
+    return res;
+}
+
+template <unsigned int BUSWIDTH, unsigned int ADDR_UNIT_WIDTH>
+void scc::tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>::build_dense_map() {
+    dense_dirty = false;
+    dense_map.clear();
+    auto ranges = get_ranges();
+    if(ranges.empty())
+        return;
+    dense_base = ranges.front().first;
+    auto span = ranges.back().second - dense_base + 1;
+    // the slot size is limited by the alignment of all range boundaries relative to the window base
+    unsigned shift = 0;
+    while((BUSWIDTH / ADDR_UNIT_WIDTH) >> (shift + 1))
+        ++shift;
+    for(auto& r : ranges)
+        for(auto boundary : {r.first - dense_base, r.second + 1 - dense_base})
+            while(shift && (boundary & ((uint64_t(1) << shift) - 1)))
+                --shift;
+    if(span == 0 || ((span - 1) >> shift) >= max_dense_slots)
+        return;
+    dense_shift = shift;
+    dense_map.assign(((span - 1) >> shift) + 1, socket_map.null_entry);
+    for(auto& r : ranges) {
+        auto entry = socket_map.getEntry(r.first);
+        for(auto idx = (r.first - dense_base) >> shift; idx <= (r.second - dense_base) >> shift; ++idx)
+            dense_map[idx] = entry;
+    }
+}
+
+template <unsigned int BUSWIDTH, unsigned int ADDR_UNIT_WIDTH>
+bool scc::tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>::get_enabled_bytes(const unsigned char* be, unsigned len,
+                                                                    unsigned& lower, unsigned& count) {
+    if(len <= 8) {
+        // gather a bit per byte enable into a mask (assumes a little endian host), a contiguous range of enabled
+        // bytes is a single run of ones
+        uint64_t x = 0;
+        std::memcpy(&x, be, len);
+        x |= x >> 4;
+        x |= x >> 2;
+        x |= x >> 1;
+        x &= 0x0101010101010101ULL;
+        auto mask = static_cast<unsigned>((x * 0x0102040810204080ULL) >> 56);
+        if(!mask) {
+            lower = count = 0;
+            return true;
+        }
+        lower = __builtin_ctz(mask);
+        auto run = mask >> lower;
+        count = __builtin_popcount(run);
+        return (run & (run + 1)) == 0;
+    }
+    auto i = 0u;
+    while(i < len && !be[i])
+        ++i;
+    lower = i;
+    while(i < len && be[i])
+        ++i;
+    count = i - lower;
+    while(i < len && !be[i])
+        ++i;
+    return i == len;
+}
+
+template <unsigned int BUSWIDTH, unsigned int ADDR_UNIT_WIDTH>
+template <typename F>
+bool scc::tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>::for_each_resource(uint64_t addr, unsigned length, F f) {
+    constexpr unsigned unit_bytes = ADDR_UNIT_WIDTH > 8 ? ADDR_UNIT_WIDTH / 8 : 1;
+    for(unsigned pos = 0; pos < length;) {
+        resource_access_if* ra = nullptr;
+        uint64_t base = 0;
+        std::tie(ra, base) = get_resource(addr);
+        if(!ra)
+            return false;
+        auto byte_offset = (addr - base) * unit_bytes;
+        if(byte_offset >= ra->size())
+            return false;
+        auto chunk = static_cast<unsigned>(std::min<uint64_t>(length - pos, ra->size() - byte_offset));
+        if(!f(ra, byte_offset, pos, chunk))
+            return false;
+        pos += chunk;
+        addr += std::max(1u, chunk / unit_bytes);
+    }
+    return true;
 }
 
 template <unsigned int BUSWIDTH, unsigned int ADDR_UNIT_WIDTH>
 void scc::tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>::b_tranport_cb(tlm::tlm_generic_payload& gp, sc_core::sc_time& delay) {
+    // given upfront so that a request_sync() of a callback takes precedence
+    if(sync_hint != tlm::scc::quantum_manager::sync_hint::NONE)
+        tlm::scc::quantum_manager::get().set_sync_hint(sync_hint);
     resource_access_if* ra = nullptr;
     uint64_t base = 0;
-    std::tie(ra, base) = socket_map.getEntry(gp.get_address());
+    std::tie(ra, base) = get_resource(gp.get_address());
     if(ra) {
-        auto offset = 0;
+        if(dmi_mode != NO_DMI)
+            gp.set_dmi_allowed(ADDR_UNIT_WIDTH == 8 && get_dmi_ptr(ra, dmi_mode == READ_WRITE_DMI) != nullptr);
+        auto offset = 0u;
         auto len = gp.get_data_length();
         auto contigous = true;
-        if(gp.get_byte_enable_ptr()) {
-            auto lower = std::numeric_limits<unsigned>::max();
-            auto upper = std::numeric_limits<unsigned>::max();
-            auto en = false;
-            auto p = gp.get_byte_enable_ptr();
-            auto i = 0u;
-            for(; i < gp.get_byte_enable_length(); ++i, ++p){
-                if(*p && !en) {
-                    if(lower != std::numeric_limits<unsigned>::max()) {
-                        contigous = false;
-                        break;
-                    } else {
-                        lower = i;
-                        en = true;
-                    }
-                }
-                if(!*p && en) {
-                    if(upper != std::numeric_limits<unsigned>::max()) {
-                        contigous = false;
-                        break;
-                    } else {
-                        upper = i;
-                        en = false;
-                    }
-                }
-            }
-            if(i== gp.get_byte_enable_length() && upper == std::numeric_limits<unsigned>::max())
-                upper = i;
-            if(contigous) {
-                offset = lower;
-                len = upper-lower;
-            }
-        }
         if(gp.get_data_length() > ra->size()) {
-            gp.set_response_status(tlm::TLM_BURST_ERROR_RESPONSE);
-        } else if(gp.get_data_length() != gp.get_streaming_width()){
+            burst_transport(gp, delay);
+            return;
+        }
+        if(gp.get_byte_enable_ptr())
+            contigous = get_enabled_bytes(gp.get_byte_enable_ptr(), gp.get_byte_enable_length(), offset, len);
+        if(gp.get_data_length() != gp.get_streaming_width()){
             gp.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
         } else if(gp.get_byte_enable_ptr() != nullptr && !(contigous && gp.get_byte_enable_length()==gp.get_data_length())) {
             gp.set_response_status(tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE);
+        } else if(len == 0) {
+            // all bytes are disabled, nothing to access
+            gp.set_response_status(tlm::TLM_OK_RESPONSE);
         } else {
             gp.set_response_status(tlm::TLM_COMMAND_ERROR_RESPONSE);
             switch(gp.get_command()) {
@@ -201,25 +446,120 @@ void scc::tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>::b_tranport_cb(tlm::tlm_generic_
     delay += clk;
 }
 
+template <unsigned int BUSWIDTH, unsigned int ADDR_UNIT_WIDTH>
+void scc::tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>::burst_transport(tlm::tlm_generic_payload& gp, sc_core::sc_time& delay) {
+    auto* be = gp.get_byte_enable_ptr();
+    if(gp.get_data_length() != gp.get_streaming_width() ||
+       (gp.get_command() != tlm::TLM_READ_COMMAND && gp.get_command() != tlm::TLM_WRITE_COMMAND)) {
+        gp.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+        delay += clk;
+        return;
+    }
+    if(be && gp.get_byte_enable_length() != gp.get_data_length()) {
+        gp.set_response_status(tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE);
+        delay += clk;
+        return;
+    }
+    // check the whole burst before accessing any resource so that address and byte enable errors have no side effects
+    auto be_error = false;
+    auto mapped = for_each_resource(gp.get_address(), gp.get_data_length(),
+                                    [be, &be_error](resource_access_if*, uint64_t, unsigned pos, unsigned chunk) {
+                                        unsigned lower, count;
+                                        be_error = be && !get_enabled_bytes(be + pos, chunk, lower, count);
+                                        return !be_error;
+                                    });
+    if(!mapped) {
+        gp.set_response_status(be_error ? tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE : tlm::TLM_ADDRESS_ERROR_RESPONSE);
+        delay += clk;
+        return;
+    }
+    auto* data = gp.get_data_ptr();
+    auto is_read = gp.is_read();
+    auto ok = for_each_resource(
+        gp.get_address(), gp.get_data_length(),
+        [this, be, data, is_read, &delay](resource_access_if* ra, uint64_t byte_offset, unsigned pos, unsigned chunk) {
+            unsigned lower = 0, count = chunk;
+            if(be)
+                get_enabled_bytes(be + pos, chunk, lower, count);
+            delay += clk;
+            if(!count)
+                return true;
+            return is_read ? ra->read(data + pos + lower, count, byte_offset + lower, delay)
+                           : ra->write(data + pos + lower, count, byte_offset + lower, delay);
+        });
+    gp.set_response_status(ok ? tlm::TLM_OK_RESPONSE : tlm::TLM_COMMAND_ERROR_RESPONSE);
+}
+
 template <unsigned int BUSWIDTH, unsigned int ADDR_UNIT_WIDTH>
 unsigned int scc::tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>::tranport_dbg_cb(tlm::tlm_generic_payload& gp) {
-    resource_access_if* ra = nullptr;
-    uint64_t base = 0;
-    std::tie(ra, base) = socket_map.getEntry(gp.get_address());
-    if(ra) {
-        if(gp.get_data_length() == ra->size() && gp.get_byte_enable_ptr() == nullptr &&
-           gp.get_data_length() == gp.get_streaming_width()) {
-            if(gp.get_command() == tlm::TLM_READ_COMMAND) {
-                if(ra->read_dbg(gp.get_data_ptr(), gp.get_data_length(), (gp.get_address() - base) / ra->size()))
-                    return gp.get_data_length();
-            } else if(gp.get_command() == tlm::TLM_WRITE_COMMAND) {
-                if(ra->write_dbg(gp.get_data_ptr(), gp.get_data_length(), (gp.get_address() - base) / ra->size()))
-                    return gp.get_data_length();
-            }
+    if(gp.get_byte_enable_ptr() != nullptr || gp.get_data_length() != gp.get_streaming_width())
+        return 0;
+    auto* data = gp.get_data_ptr();
+    auto cmd = gp.get_command();
+    unsigned transferred = 0;
+    // complete resources are accessed in ascending address order until the first one failing
+    for_each_resource(gp.get_address(), gp.get_data_length(),
+                      [data, cmd, &transferred](resource_access_if* ra, uint64_t byte_offset, unsigned pos,
+                                                unsigned chunk) {
+                          if(byte_offset != 0 || chunk != ra->size())
+                              return false;
+                          auto ok = cmd == tlm::TLM_READ_COMMAND    ? ra->read_dbg(data + pos, chunk, 0)
+                                    : cmd == tlm::TLM_WRITE_COMMAND ? ra->write_dbg(data + pos, chunk, 0)
+                                                                    : false;
+                          if(ok)
+                              transferred += chunk;
+                          return ok;
+                      });
+    return transferred;
+}
+
+template <unsigned int BUSWIDTH, unsigned int ADDR_UNIT_WIDTH>
+bool scc::tlm_target<BUSWIDTH, ADDR_UNIT_WIDTH>::get_direct_mem_ptr_cb(tlm::tlm_generic_payload& gp,
+                                                                        tlm::tlm_dmi& dmi) {
+    // the storage is byte addressed, so DMI is only possible if an address unit is a byte
+    if(dmi_mode == NO_DMI || ADDR_UNIT_WIDTH != 8)
+        return false;
+    auto ranges = get_ranges();
+    auto addr = gp.get_address();
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), addr,
+                               [](uint64_t a, std::pair<uint64_t, uint64_t> const& r) { return a < r.first; });
+    if(it == ranges.begin() || (--it)->second < addr)
+        return false;
+    auto idx = static_cast<size_t>(it - ranges.begin());
+    auto ptr_of = [this, &ranges](size_t i, bool write) -> uintptr_t {
+        return reinterpret_cast<uintptr_t>(get_dmi_ptr(socket_map.getEntry(ranges[i].first).first, write));
+    };
+    for(auto write : {gp.is_write() && dmi_mode == READ_WRITE_DMI, false}) {
+        auto first_ptr = ptr_of(idx, write);
+        if(!first_ptr)
+            continue;
+        // extend the window as long as adjacent resources are adjacent in memory as well
+        auto first = idx, last = idx;
+        while(first > 0 && ranges[first - 1].second + 1 == ranges[first].first) {
+            auto p = ptr_of(first - 1, write);
+            if(!p || p + (ranges[first].first - ranges[first - 1].first) != first_ptr)
+                break;
+            first_ptr = p;
+            --first;
+        }
+        auto last_ptr = ptr_of(last, write);
+        while(last + 1 < ranges.size() && ranges[last].second + 1 == ranges[last + 1].first) {
+            auto p = ptr_of(last + 1, write);
+            if(!p || last_ptr + (ranges[last + 1].first - ranges[last].first) != p)
+                break;
+            last_ptr = p;
+            ++last;
         }
+        dmi.set_dmi_ptr(reinterpret_cast<unsigned char*>(first_ptr));
+        dmi.set_start_address(ranges[first].first);
+        dmi.set_end_address(ranges[last].second);
+        dmi.set_granted_access(write ? tlm::tlm_dmi::DMI_ACCESS_READ_WRITE : tlm::tlm_dmi::DMI_ACCESS_READ);
+        dmi.set_read_latency(clk);
+        dmi.set_write_latency(clk);
+        dmi_granted = true;
+        return true;
     }
-    return 0;
+    return false;
 }
 
-
 #endif /* _SYSC_TLM_TARGET_H_ */
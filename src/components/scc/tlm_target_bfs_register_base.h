@@ -26,6 +26,8 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <string>
 #include <vector>
@@ -41,9 +43,11 @@
 
 #include "resetable.h"
 #include "resource_access_if.h"
+#include "resource_profile.h"
 #include "sysc/kernel/sc_module_name.h"
 #include "sysc/kernel/sc_object.h"
 #include "tlm_target.h"
+#include "util/delegate.h"
 
 #define ID_SCC_TLM_TARGET_BFS_REGISTER_BASE "scc: tlm target bitfield support register base"
 
@@ -65,6 +69,18 @@ public:
     virtual void write(datatype_t& valueToWrite) = 0;
     virtual datatype_t read() = 0;
     virtual ~abstract_bitfield() = default;
+    /**
+     * The following queries allow the register to skip calling write() and read() of bitfields which behave like
+     * plain storage. The defaults are conservative so that these functions are always called.
+     */
+    //! @return true if write() needs to be called upon a write access
+    virtual bool hasWriteCallback() const { return true; }
+    //! @return true if read() needs to be called upon a read access
+    virtual bool hasReadCallback() const { return true; }
+    //! @return true if writes to this bitfield are ignored
+    virtual bool isReadOnly() const { return false; }
+    //! @return true if write() is only be called if the written value differs from the stored one
+    virtual bool notifyChangesOnly() const { return false; }
 
     constexpr bool affected(size_t byteOffset, size_t byteLength) const noexcept {
         return (byteOffset * 8 < bitOffset + bitSize) && (bitOffset < (byteOffset + byteLength) * 8);
@@ -102,7 +118,12 @@ public:
     , offset{offset}
     , resetValue{resetValue}
     , writeMask{writeMask}
-    , readMask{readMask} {}
+    , readMask{readMask}
+#ifdef SCC_REGISTER_PROFILING
+    , profile{this->name()}
+#endif
+    {
+    }
 
     /**
      * @return The size of the register in bytes
@@ -110,19 +131,35 @@ public:
     constexpr size_t size() const noexcept override { return sizeof(datatype_t); }
 
     void reset() override { storage = resetValue; }
+    //! a reset has no side effects so it can be done by copying the reset value
+    uint8_t* get_reset_storage(const uint8_t*& reset_value) override {
+        reset_value = reinterpret_cast<const uint8_t*>(&resetValue);
+        return reinterpret_cast<uint8_t*>(&storage);
+    }
+#ifdef SCC_REGISTER_PROFILING
+    //! get the access counters
+    const scc::resource_profile* get_profile() const override { return &profile; }
+#endif
 
     bool write(const uint8_t* data, std::size_t length, uint64_t offset,
                sc_core::sc_time& d) override {
         assert("Access out of range" && offset + length <= this->size());
+        if(fieldsDirty)
+            updateFieldTable();
+        SCC_REGISTER_PROFILE_ACCESS(profile, writes);
+        SCC_REGISTER_PROFILE_CALLBACK(profile, !writeFields.empty() || writeCallback);
         auto valueToWrite{storage};
         std::copy(data, data + length, reinterpret_cast<uint8_t*>(&valueToWrite) + offset);
-        for(auto&& bitfield : bitfields) {
-            if(bitfield.get().affected(offset, length)) {
-                auto mask = bitfield.get().mask();
-                auto bits = (valueToWrite & mask) >> bitfield.get().bitOffset;
-                bitfield.get().write(bits);
-                valueToWrite = (valueToWrite & ~mask) | ((bits << bitfield.get().bitOffset) & mask);
-            }
+        // read only bitfields without callback keep their value, plain bitfields take the written one
+        valueToWrite = (valueToWrite & ~readOnlyFieldMask) | (storage & readOnlyFieldMask);
+        for(auto& field : writeFields) {
+            if(!field.bitfield->affected(offset, length))
+                continue;
+            if(field.changesOnly && !((valueToWrite ^ storage) & field.mask))
+                continue;
+            auto bits = (valueToWrite & field.mask) >> field.bitOffset;
+            field.bitfield->write(bits);
+            valueToWrite = (valueToWrite & ~field.mask) | ((bits << field.bitOffset) & field.mask);
         }
         if(writeCallback)
             writeCallback(*this, valueToWrite);
@@ -133,13 +170,16 @@ public:
     bool read(uint8_t* data, std::size_t length, uint64_t offset,
               sc_core::sc_time& d) const override {
         assert("Access out of range" && offset + length <= this->size());
-        auto result{storage};
-        result &= readMask;
-        for(auto&& bitfield : bitfields) {
-            if(bitfield.get().affected(offset, length)) {
-                auto bitfieldValue = bitfield.get().read();
-                auto mask = bitfield.get().mask();
-                result = (result & ~mask) | ((bitfieldValue << bitfield.get().bitOffset) & mask);
+        if(fieldsDirty)
+            updateFieldTable();
+        SCC_REGISTER_PROFILE_ACCESS(profile, reads);
+        SCC_REGISTER_PROFILE_CALLBACK(profile, !readFields.empty() || readCallback);
+        // bitfields without callback read their stored value regardless of the read mask
+        auto result = storage & (readMask | plainReadFieldMask);
+        for(auto& field : readFields) {
+            if(field.bitfield->affected(offset, length)) {
+                auto bitfieldValue = field.bitfield->read();
+                result = (result & ~field.mask) | ((bitfieldValue << field.bitOffset) & field.mask);
             }
         }
         if(readCallback)
@@ -175,7 +215,15 @@ public:
      */
     void put(datatype_t value) { storage = value; }
 
-    void registerBitfield(abstract_bitfield<datatype_t>& bitfield) { bitfields.push_back(bitfield); }
+    void registerBitfield(abstract_bitfield<datatype_t>& bitfield) {
+        bitfields.push_back(bitfield);
+        fieldsDirty = true;
+    }
+    /**
+     * Mark the table of bitfields needing their read() or write() being called as outdated, it is rebuilt upon the
+     * next access. Needs to be called if the callbacks or the access of a bitfield change.
+     */
+    void invalidateFieldTable() { fieldsDirty = true; }
 
     /**
      * Convenience function to access the stored data
@@ -200,9 +248,14 @@ public:
      * the value of the parameter valueToWrite. Direct writes to the register do
      * not work.
      */
-    void setWriteCallback(std::function<void(bitfield_register<datatype_t>&, datatype_t& valueToWrite)> callback) {
-        writeCallback = std::move(callback);
+    template <typename F> void setWriteCallback(F&& callback) {
+        if(util::is_empty_callable(callback))
+            writeCallback = write_cb_type();
+        else
+            writeCallback = std::forward<F>(callback);
     }
+    //! remove the write callback
+    void setWriteCallback(std::nullptr_t) { writeCallback = write_cb_type(); }
     /**
      * Register a \p callback that gets called on read. Overwrites previously
      * stored callbacks. Signature: `void onRead(const
@@ -210,9 +263,14 @@ public:
      *
      * Callback is called after the individual bitfields.
      */
-    void setReadCallback(std::function<void(const bitfield_register<datatype_t>&, datatype_t& result)> callback) {
-        readCallback = std::move(callback);
+    template <typename F> void setReadCallback(F&& callback) {
+        if(util::is_empty_callable(callback))
+            readCallback = read_cb_type();
+        else
+            readCallback = std::forward<F>(callback);
     }
+    //! remove the read callback
+    void setReadCallback(std::nullptr_t) { readCallback = read_cb_type(); }
 
     const size_t offset;
 
@@ -222,9 +280,50 @@ protected:
     const datatype_t readMask;
     datatype_t storage;
 
-    std::function<void(bitfield_register<datatype_t>&, datatype_t&)> writeCallback;
-    std::function<void(const bitfield_register<datatype_t>&, datatype_t&)> readCallback;
+    // the callbacks are stored in delegates so that calling them takes a single indirection
+    using write_cb_type = util::delegate<void(bitfield_register<datatype_t>&, datatype_t&)>;
+    using read_cb_type = util::delegate<void(const bitfield_register<datatype_t>&, datatype_t&)>;
+    write_cb_type writeCallback;
+    read_cb_type readCallback;
     std::vector<std::reference_wrapper<abstract_bitfield<datatype_t>>> bitfields;
+
+    struct field_entry {
+        abstract_bitfield<datatype_t>* bitfield;
+        datatype_t mask;
+        size_t bitOffset;
+        bool changesOnly;
+    };
+
+    void updateFieldTable() const {
+        writeFields.clear();
+        readFields.clear();
+        readOnlyFieldMask = 0;
+        plainReadFieldMask = 0;
+        for(auto&& ref : bitfields) {
+            auto& bitfield = ref.get();
+            field_entry entry{&bitfield, bitfield.mask(), bitfield.bitOffset, bitfield.notifyChangesOnly()};
+            if(bitfield.hasWriteCallback())
+                writeFields.push_back(entry);
+            else if(bitfield.isReadOnly())
+                readOnlyFieldMask |= entry.mask;
+            if(bitfield.hasReadCallback())
+                readFields.push_back(entry);
+            else
+                plainReadFieldMask |= entry.mask;
+        }
+        fieldsDirty = false;
+    }
+    //! the bitfields whose write() resp. read() needs to be called, computed from bitfields upon the first access
+    mutable std::vector<field_entry> writeFields;
+    mutable std::vector<field_entry> readFields;
+    //! the bits of read only bitfields without write callback
+    mutable datatype_t readOnlyFieldMask{0};
+    //! the bits of bitfields without read callback
+    mutable datatype_t plainReadFieldMask{0};
+    mutable bool fieldsDirty{true};
+#ifdef SCC_REGISTER_PROFILING
+    mutable scc::resource_profile profile;
+#endif
 };
 
 template <typename datatype_t> class bitfield : public abstract_bitfield<datatype_t> {
@@ -266,6 +365,14 @@ public:
             return get();
     }
 
+    bool hasWriteCallback() const override { return static_cast<bool>(writeCallback); }
+
+    bool hasReadCallback() const override { return static_cast<bool>(readCallback); }
+
+    bool isReadOnly() const override { return access == ReadOnly; }
+
+    bool notifyChangesOnly() const override { return changesOnly; }
+
     /**
      * @return the data stored in this bitfield
      */
@@ -297,9 +404,23 @@ public:
      * If you want to change the value that gets written to the bitfield change
      * the value of the parameter valueToWrite. Direct writes to the bitfield do
      * not work.
+     *
+     * If \p changesOnly is set the callback is only called if a write changes
+     * the value of the bitfield. Do not use this for bits having side effects
+     * when writing the stored value, e.g. write-one-to-clear bits.
      */
-    void setWriteCallback(std::function<void(bitfield<datatype_t>&, datatype_t& valueToWrite)> callback) {
-        writeCallback = std::move(callback);
+    template <typename F> void setWriteCallback(F&& callback, bool changesOnly = false) {
+        if(util::is_empty_callable(callback))
+            writeCallback = write_cb_type();
+        else
+            writeCallback = std::forward<F>(callback);
+        this->changesOnly = changesOnly;
+        reg.invalidateFieldTable();
+    }
+    //! remove the write callback
+    void setWriteCallback(std::nullptr_t) {
+        writeCallback = write_cb_type();
+        reg.invalidateFieldTable();
     }
     /**
      * Register a \p callback that gets called on read. Overwrites previously
@@ -308,16 +429,29 @@ public:
      *
      * Callback is called before the register.
      */
-    void setReadCallback(std::function<datatype_t(const bitfield<datatype_t>&)> callback) {
-        readCallback = std::move(callback);
+    template <typename F> void setReadCallback(F&& callback) {
+        if(util::is_empty_callable(callback))
+            readCallback = read_cb_type();
+        else
+            readCallback = std::forward<F>(callback);
+        reg.invalidateFieldTable();
+    }
+    //! remove the read callback
+    void setReadCallback(std::nullptr_t) {
+        readCallback = read_cb_type();
+        reg.invalidateFieldTable();
     }
 
     bitfield_register<datatype_t>& reg;
+    //! call reg.invalidateFieldTable() when changing the access after the first register access
     Access access;
 
 protected:
-    std::function<void(bitfield<datatype_t>&, datatype_t&)> writeCallback;
-    std::function<datatype_t(const bitfield<datatype_t>&)> readCallback;
+    using write_cb_type = util::delegate<void(bitfield<datatype_t>&, datatype_t&)>;
+    using read_cb_type = util::delegate<datatype_t(const bitfield<datatype_t>&)>;
+    write_cb_type writeCallback;
+    read_cb_type readCallback;
+    bool changesOnly{false};
 };
 
 /**
@@ -417,6 +551,157 @@ private:
     derived_t& asDerived() { return static_cast<derived_t&>(*this); }
 };
 
+/**
+ * @brief Compile time description of a register of a \ref tlm_target_bfs_register_table
+ */
+struct bfs_register_desc {
+    /**
+     * @param name The name of the register
+     * @param offset Offset in bytes of the register from the peripheral base address
+     * @param resetValue see bitfield_register
+     * @param writeMask see bitfield_register
+     * @param readMask see bitfield_register
+     */
+    constexpr bfs_register_desc(char const* name, size_t offset, uint32_t resetValue = 0,
+                                uint32_t writeMask = 0xffffffffU, uint32_t readMask = 0xffffffffU)
+    : name{name}
+    , offset{offset}
+    , resetValue{resetValue}
+    , writeMask{writeMask}
+    , readMask{readMask} {}
+
+    char const* name;
+    size_t offset;
+    uint32_t resetValue;
+    uint32_t writeMask;
+    uint32_t readMask;
+};
+
+/**
+ * @brief Compile time description of a bitfield of a \ref tlm_target_bfs_register_table
+ */
+struct bfs_bitfield_desc {
+    /**
+     * The bitfields of a table need to be sorted by register index and bit offset.
+ *
+ * @param reg The index of the containing register in the register table
+     * @param name The name of the bitfield
+     * @param bitOffset The position of the bitfield in the containing register
+     * @param bitSize The size of the bitfield
+     * @param urid Unique resource id, see bitfield
+     * @param readOnly If true writes to the bitfield are ignored
+     */
+    constexpr bfs_bitfield_desc(size_t reg, char const* name, size_t bitOffset, size_t bitSize, char const* urid,
+                                bool readOnly = false)
+    : reg{reg}
+    , name{name}
+    , bitOffset{bitOffset}
+    , bitSize{bitSize}
+    , urid{urid}
+    , readOnly{readOnly} {}
+
+    size_t reg;
+    char const* name;
+    size_t bitOffset;
+    size_t bitSize;
+    char const* urid;
+    bool readOnly;
+};
+
+namespace impl {
+// the checks split the ranges in halves so that the recursion depth grows logarithmically with the table size
+template <size_t N>
+constexpr bool bfs_registers_sorted(bfs_register_desc const (&regs)[N], size_t first, size_t last) {
+    return last - first > 1
+               ? bfs_registers_sorted(regs, first, first + (last - first) / 2) &&
+                     bfs_registers_sorted(regs, first + (last - first) / 2, last)
+               : first + 1 >= N || regs[first].offset + sizeof(uint32_t) <= regs[first + 1].offset;
+}
+
+// a bitfield needs to fit into an existing register and end before the next one starts
+template <size_t NUM_REGS, size_t N> constexpr bool bfs_bitfield_valid(bfs_bitfield_desc const (&fields)[N], size_t idx) {
+    return fields[idx].reg < NUM_REGS && fields[idx].bitSize > 0 && fields[idx].bitOffset + fields[idx].bitSize <= 32 &&
+           (idx + 1 >= N || fields[idx].reg < fields[idx + 1].reg ||
+            (fields[idx].reg == fields[idx + 1].reg &&
+             fields[idx].bitOffset + fields[idx].bitSize <= fields[idx + 1].bitOffset));
+}
+
+template <size_t NUM_REGS, size_t N>
+constexpr bool bfs_bitfields_valid(bfs_bitfield_desc const (&fields)[N], size_t first, size_t last) {
+    return last - first > 1 ? bfs_bitfields_valid<NUM_REGS>(fields, first, first + (last - first) / 2) &&
+                                  bfs_bitfields_valid<NUM_REGS>(fields, first + (last - first) / 2, last)
+                            : first >= last || bfs_bitfield_valid<NUM_REGS>(fields, first);
+}
+} // namespace impl
+
+/**
+ * @brief Check a register table at compile time
+ *
+ * @return true if the registers are sorted by offset and do not overlap
+ */
+template <size_t NUM_REGS> constexpr bool bfs_layout_valid(bfs_register_desc const (&regs)[NUM_REGS]) {
+    return impl::bfs_registers_sorted(regs, 0, NUM_REGS);
+}
+/**
+ * @brief Check a register and bitfield table at compile time, e.g. using
+ * `static_assert(scc::bfs_layout_valid(registers, bitfields), "invalid register layout")`
+ *
+ * @return true if the registers are sorted by offset and do not overlap and if the bitfields are sorted by register
+ * index and bit offset, fit into existing registers and do not overlap
+ */
+template <size_t NUM_REGS, size_t NUM_FIELDS>
+constexpr bool bfs_layout_valid(bfs_register_desc const (&regs)[NUM_REGS],
+                                bfs_bitfield_desc const (&fields)[NUM_FIELDS]) {
+    return bfs_layout_valid(regs) && impl::bfs_bitfields_valid<NUM_REGS>(fields, 0, NUM_FIELDS);
+}
+
+/**
+ * @brief Register layout created from constant tables
+ *
+ * Register layouts generated from a description can declare the registers and bitfields as constexpr tables of
+ * \ref bfs_register_desc and \ref bfs_bitfield_desc at namespace scope instead of initializer lists of registers
+ * and bitfields. The tables can be checked at compile time using bfs_layout_valid(), offsets, reset values and masks
+ * are constants of the table and the registers and bitfields are created in a single pass without name lookups.
+ * Registers and bitfields are accessible by their table index as well.
+ * \code
+ * namespace my_layout {
+ * constexpr scc::bfs_register_desc registers[] = {{"R0", 0x0}, {"R1", 0x4, 0x1}};
+ * constexpr scc::bfs_bitfield_desc bitfields[] = {{1, "EN", 0, 1, "regs.R1.EN"}};
+ * static_assert(scc::bfs_layout_valid(registers, bitfields), "invalid register layout");
+ * }
+ * class my_regs : public scc::tlm_target_bfs_register_table<my_regs> {
+ * public:
+ *     my_regs(sc_core::sc_module_name nm)
+ *     : tlm_target_bfs_register_table(nm, my_layout::registers, my_layout::bitfields) {}
+ * };
+ * \endcode
+ * @tparam derived_t Type of the concrete register class. Used for CRTP.
+ * @tparam use_URID see \ref tlm_target_bfs_register_base
+ */
+template <typename derived_t, bool use_URID = false>
+class tlm_target_bfs_register_table : public tlm_target_bfs_register_base<derived_t, use_URID> {
+public:
+    template <size_t NUM_REGS>
+    tlm_target_bfs_register_table(sc_core::sc_module_name name, bfs_register_desc const (&register_descs)[NUM_REGS])
+    : tlm_target_bfs_register_base<derived_t, use_URID>{name} {
+        for(auto& d : register_descs)
+            registers.emplace_back(d.name, d.offset, d.resetValue, d.writeMask, d.readMask);
+    }
+
+    template <size_t NUM_REGS, size_t NUM_FIELDS>
+    tlm_target_bfs_register_table(sc_core::sc_module_name name, bfs_register_desc const (&register_descs)[NUM_REGS],
+                                  bfs_bitfield_desc const (&bitfield_descs)[NUM_FIELDS])
+    : tlm_target_bfs_register_table{name, register_descs} {
+        for(auto& d : bitfield_descs)
+            bitfields.emplace_back(registers[d.reg], d.name, d.bitOffset, d.bitSize, d.urid,
+                                   d.readOnly ? bitfield<uint32_t>::ReadOnly : bitfield<uint32_t>::RW);
+    }
+    //! the registers in the order of the table, a deque keeps them in place while being created
+    std::deque<bitfield_register<uint32_t>> registers;
+    //! the bitfields in the order of the table
+    std::deque<bitfield<uint32_t>> bitfields;
+};
+
 } // namespace scc
 
 /**
@@ -0,0 +1,192 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_TRACE_GENERATOR_H_
+#define _SCC_TRACE_GENERATOR_H_
+
+#include <cci_configuration>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <scc/report.h>
+#include <scc/utilities.h>
+#include <tlm.h>
+#include <tlm/scc/initiator_mixin.h>
+#include <tlm/scc/tlm_mm.h>
+#include <util/bus_trace.h>
+
+namespace scc {
+/**
+ * @class trace_generator
+ * @brief an initiator replaying a util::bus_trace
+ *
+ * The trace given by trace_file is mapped into memory and its records are issued at their time using payloads (and
+ * data buffers) of the tlm::scc::tlm_mm. If max_outstanding is 0 the accesses are issued using b_transport with
+ * temporal decoupling (see tlm::scc::quantum_keeper), which is the fastest mode if decoupling is enabled. Otherwise
+ * the accesses are issued as base protocol AT transactions and up to max_outstanding of them may be in flight.
+ *
+ * Protocol specific attributes (e.g. the extension of an AXI socket) can be added by a callback given to
+ * set_prepare_callback() which is called for each payload before it is issued.
+ *
+ * @tparam BUSWIDTH the width of the bus
+ * @tparam TYPES the protocol types
+ * @tparam SOCKET the initiator socket type
+ */
+template <unsigned BUSWIDTH = LT, typename TYPES = tlm::tlm_base_protocol_types,
+          typename SOCKET = tlm::tlm_initiator_socket<BUSWIDTH, TYPES>>
+class trace_generator : public sc_core::sc_module {
+public:
+    using payload_type = typename TYPES::tlm_payload_type;
+    using phase_type = typename TYPES::tlm_phase_type;
+
+    tlm::scc::initiator_mixin<SOCKET, TYPES> isck{"isck"};
+
+    cci::cci_param<std::string> trace_file{"trace_file", "", "the bus trace to replay"};
+
+    cci::cci_param<unsigned> max_outstanding{"max_outstanding", 0,
+                                             "number of AT transactions in flight, 0 uses b_transport"};
+
+    trace_generator(sc_core::sc_module_name const& nm)
+    : sc_core::sc_module(nm) {
+        isck.register_nb_transport_bw([this](payload_type& trans, phase_type& phase, sc_core::sc_time& t) {
+            return nb_transport_bw(trans, phase, t);
+        });
+        SC_HAS_PROCESS(trace_generator);
+        SC_THREAD(run);
+    }
+    //! set the callback being invoked for each payload before it is issued
+    void set_prepare_callback(std::function<void(payload_type&, util::bus_trace::record const&)> cb) {
+        prepare_cb = std::move(cb);
+    }
+    //! the event notified when all records have been issued and completed
+    sc_core::sc_event const& done_event() const { return done_evt; }
+    //! the number of completed accesses
+    uint64_t get_completed() const { return completed; }
+
+private:
+    void run();
+
+    void issue_at(payload_type& trans);
+
+    tlm::tlm_sync_enum nb_transport_bw(payload_type& trans, phase_type& phase, sc_core::sc_time& t) {
+        if(phase == tlm::END_REQ) {
+            if(&trans == req_pending)
+                req_pending = nullptr;
+            req_evt.notify(t);
+            return tlm::TLM_ACCEPTED;
+        }
+        if(phase == tlm::BEGIN_RESP) {
+            // a response implies the end of the request phase
+            req_evt.notify(t);
+            finish(trans);
+            phase = tlm::END_RESP;
+            return tlm::TLM_COMPLETED;
+        }
+        return tlm::TLM_ACCEPTED;
+    }
+
+    void finish(payload_type& trans) {
+        if(&trans == req_pending)
+            req_pending = nullptr;
+        trans.release();
+        --outstanding;
+        ++completed;
+        resp_evt.notify(sc_core::SC_ZERO_TIME);
+    }
+
+    std::function<void(payload_type&, util::bus_trace::record const&)> prepare_cb;
+    sc_core::sc_event req_evt, resp_evt, done_evt;
+    payload_type* req_pending{nullptr};
+    unsigned outstanding{0};
+    uint64_t completed{0};
+};
+
+template <unsigned BUSWIDTH, typename TYPES, typename SOCKET>
+inline void trace_generator<BUSWIDTH, TYPES, SOCKET>::run() {
+    if(trace_file.get_value().empty())
+        return;
+    std::unique_ptr<util::bus_trace::reader> trace;
+    try {
+        trace.reset(new util::bus_trace::reader(trace_file.get_value()));
+    } catch(std::exception& e) {
+        SCCERR(SCMOD) << e.what();
+        return;
+    }
+    auto& mm = tlm::scc::tlm_mm<TYPES>::get();
+    auto window = max_outstanding.get_value();
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < trace->size(); ++i) {
+        auto& rec = (*trace)[i];
+        auto* trans = mm.allocate(rec.length);
+        trans->acquire();
+        trans->set_command(rec.command == util::bus_trace::WRITE ? tlm::TLM_WRITE_COMMAND : tlm::TLM_READ_COMMAND);
+        trans->set_address(rec.address);
+        trans->set_streaming_width(rec.length);
+        trans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        if(prepare_cb)
+            prepare_cb(*trans, rec);
+        sc_core::sc_time t(static_cast<double>(rec.time_ps), sc_core::SC_PS);
+        if(!window) {
+            auto now = isck.get_current_time();
+            if(t > now)
+                isck.advance(t - now);
+            isck.b_transport_td(*trans);
+            trans->release();
+            ++completed;
+            continue;
+        }
+        auto now = sc_core::sc_time_stamp();
+        if(t > now)
+            wait(t - now);
+        while(outstanding >= window)
+            wait(resp_evt);
+        issue_at(*trans);
+    }
+    if(!window)
+        isck.sync();
+    while(outstanding)
+        wait(resp_evt);
+    auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    SCCINFO(SCMOD) << "replayed " << completed << " accesses in " << secs << "s ("
+                   << (secs > 0 ? completed / secs : 0.0) << " accesses/s)";
+    done_evt.notify(sc_core::SC_ZERO_TIME);
+}
+
+template <unsigned BUSWIDTH, typename TYPES, typename SOCKET>
+inline void trace_generator<BUSWIDTH, TYPES, SOCKET>::issue_at(payload_type& trans) {
+    // the base protocol allows only one request phase in flight
+    while(req_pending)
+        wait(req_evt);
+    ++outstanding;
+    req_pending = &trans;
+    phase_type phase{tlm::BEGIN_REQ};
+    sc_core::sc_time delay;
+    auto status = isck->nb_transport_fw(trans, phase, delay);
+    if(status == tlm::TLM_COMPLETED) {
+        finish(trans);
+    } else if(status == tlm::TLM_UPDATED) {
+        if(phase == tlm::END_REQ)
+            req_pending = nullptr;
+        else if(phase == tlm::BEGIN_RESP) {
+            phase = tlm::END_RESP;
+            sc_core::sc_time end_delay;
+            isck->nb_transport_fw(trans, phase, end_delay);
+            finish(trans);
+        }
+    }
+}
+} // namespace scc
+#endif /* _SCC_TRACE_GENERATOR_H_ */
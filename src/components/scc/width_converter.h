@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SYSC_WIDTH_CONVERTER_H_
+#define _SYSC_WIDTH_CONVERTER_H_
+
+#include <scc/cached_cci_param.h>
+#include <scc/utilities.h>
+#include <tlm.h>
+#include <tlm/scc/initiator_mixin.h>
+#include <tlm/scc/target_mixin.h>
+#include <tlm/scc/tlm_gp_view.h>
+
+namespace scc {
+/**
+ * @class width_converter
+ * @brief a TLM2.0 bus width and burst converter for loosely-timed (LT) models
+ *
+ * Transactions crossing a boundary of max_beats beats of the outgoing bus are split into transactions not crossing
+ * it. The split transactions are zero-copy views of the incoming one (see tlm::scc::tlm_gp_view) sent one after the
+ * other, the incoming transaction is completed after the last of them finished. Its response status is the first
+ * error response of the split transactions. Transactions fitting the outgoing bus are forwarded unchanged.
+ *
+ * @tparam IN_WIDTH the width of the incoming bus
+ * @tparam OUT_WIDTH the width of the outgoing bus
+ */
+template <unsigned IN_WIDTH = LT, unsigned OUT_WIDTH = 32> class width_converter : public sc_core::sc_module {
+    static_assert(OUT_WIDTH >= 8, "the outgoing bus needs to be at least one byte wide");
+
+public:
+    //! \brief the incoming socket
+    tlm::scc::target_mixin<tlm::tlm_target_socket<IN_WIDTH>> target{"target"};
+    //! \brief the outgoing socket
+    tlm::scc::initiator_mixin<tlm::tlm_initiator_socket<OUT_WIDTH>> initiator{"initiator"};
+    //! \brief the maximum number of beats of the outgoing bus per transaction
+    scc::cached_cci_param<unsigned> max_beats{"max_beats", 1, "Maximum number of beats per outgoing transaction"};
+
+    width_converter(sc_core::sc_module_name const& nm)
+    : sc_core::sc_module(nm) {
+        target.register_b_transport(
+            [this](tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) -> void { transport(trans, delay); });
+        target.register_transport_dbg(
+            [this](tlm::tlm_generic_payload& trans) -> unsigned { return transport_dbg(trans); });
+        target.register_get_direct_mem_ptr([this](tlm::tlm_generic_payload& trans, tlm::tlm_dmi& dmi_data) -> bool {
+            return initiator->get_direct_mem_ptr(trans, dmi_data);
+        });
+        initiator.register_invalidate_direct_mem_ptr([this](::sc_dt::uint64 start, ::sc_dt::uint64 end) -> void {
+            target->invalidate_direct_mem_ptr(start, end);
+        });
+    }
+
+    width_converter(width_converter const&) = delete;
+
+    width_converter& operator=(width_converter const&) = delete;
+
+private:
+    //! the number of bytes an outgoing transaction may span
+    size_t chunk_size() const { return std::max(1U, max_beats.get_value()) * (OUT_WIDTH / 8); }
+
+    static bool fits(tlm::tlm_generic_payload const& trans, size_t chunk) {
+        if(!trans.get_data_ptr())
+            return true;
+        // streaming transactions access the same locations repeatedly and are forwarded unchanged
+        if(trans.get_streaming_width() && trans.get_streaming_width() < trans.get_data_length())
+            return true;
+        return trans.get_address() % chunk + trans.get_data_length() <= chunk;
+    }
+    //! a byte enable pattern can only be shared if each split transaction starts at a multiple of its length
+    static bool splittable(tlm::tlm_generic_payload const& trans, size_t chunk) {
+        auto be_len = trans.get_byte_enable_ptr() ? trans.get_byte_enable_length() : 0;
+        return !be_len || be_len >= trans.get_data_length() ||
+               (chunk % be_len == 0 && trans.get_address() % be_len == 0);
+    }
+
+    void transport(tlm::tlm_generic_payload& trans, sc_core::sc_time& delay) {
+        auto chunk = chunk_size();
+        if(fits(trans, chunk)) {
+            initiator->b_transport(trans, delay);
+            return;
+        }
+        if(!splittable(trans, chunk)) {
+            trans.set_response_status(tlm::TLM_BYTE_ENABLE_ERROR_RESPONSE);
+            return;
+        }
+        tlm::scc::tlm_gp_view view(tlm::scc::tlm_gp_shared_ptr(&trans), chunk, true);
+        trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        for(size_t i = 0; i < view.size(); ++i) {
+            auto beat = view.beat(i);
+            initiator->b_transport(*beat, delay);
+            view.merge(*beat);
+        }
+    }
+
+    unsigned transport_dbg(tlm::tlm_generic_payload& trans) {
+        auto chunk = chunk_size();
+        if(fits(trans, chunk))
+            return initiator->transport_dbg(trans);
+        if(!splittable(trans, chunk))
+            return 0;
+        tlm::scc::tlm_gp_view view(tlm::scc::tlm_gp_shared_ptr(&trans), chunk, true);
+        unsigned count = 0;
+        for(size_t i = 0; i < view.size(); ++i) {
+            auto beat = view.beat(i);
+            auto res = initiator->transport_dbg(*beat);
+            count += res;
+            if(res < beat->get_data_length())
+                break;
+        }
+        return count;
+    }
+};
+} // namespace scc
+
+#endif /* _SYSC_WIDTH_CONVERTER_H_ */
@@ -16,10 +16,17 @@
 
 #pragma once
 
+#include "scc/cache.h"
+#include "scc/checkpoint.h"
 #include "scc/clock_if_mixins.h"
 #include "scc/memory.h"
+#include "scc/partition_bridge.h"
 #include "scc/register.h"
+#include "scc/register_array.h"
 #include "scc/resetable.h"
 #include "scc/resource_access_if.h"
 #include "scc/router.h"
+#include "scc/static_router.h"
 #include "scc/tlm_target.h"
+#include "scc/trace_generator.h"
+#include "scc/width_converter.h"
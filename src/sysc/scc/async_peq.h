@@ -0,0 +1,149 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_ASYNC_PEQ_H_
+#define _SCC_ASYNC_PEQ_H_
+
+#include "peq.h"
+#include <atomic>
+#include <systemc>
+#include <util/pool_allocator.h>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @struct async_peq
+ * @brief a priority event queue being fed from threads outside of the SystemC kernel
+ *
+ * Any OS thread may post entries with post(), they are pushed onto a lock-free multi-producer/single-consumer list.
+ * The first entry posted onto an empty list requests an update of the channel using async_request_update(), in the
+ * update phase all posted entries are moved into the \ref peq in the order of posting, the delay is relative to the
+ * simulation time at this point. The consumer side (get(), get_next(), has_next(), drain() and event()) must only be
+ * used from SystemC processes. There is no polling involved so the latency of an injection is determined by the
+ * kernel only.
+ *
+ * @tparam TYPE the type of the entries
+ * @tparam QUEUE the backend of the peq
+ */
+template <class TYPE, class QUEUE = peq_map_queue<TYPE>> struct async_peq : public sc_core::sc_prim_channel {
+    /**
+     * @fn  async_peq()
+     * @brief default constructor creating a unnamed async_peq
+     *
+     */
+    async_peq()
+    : async_peq(sc_core::sc_gen_unique_name("async_peq")) {}
+    /**
+     * @fn  async_peq(const char*)
+     * @brief named async_peq constructor
+     *
+     * @param name
+     */
+    explicit async_peq(const char* name)
+    : sc_core::sc_prim_channel(name)
+    , que((std::string(name) + "_que").c_str()) {}
+
+    ~async_peq() {
+        auto* n = pending.exchange(nullptr, std::memory_order_acquire);
+        while(n) {
+            auto* next = n->next;
+            release(n);
+            n = next;
+        }
+    }
+    /**
+     * @fn void post(TYPE, const sc_core::sc_time&)
+     * @brief non-blocking push from any thread
+     *
+     * @param entry the value to insert
+     * @param delay the delay relative to the simulation time when the entry is taken over by the SystemC kernel
+     */
+    void post(TYPE entry, const sc_core::sc_time& delay = sc_core::SC_ZERO_TIME) {
+        auto* n = new(node_pool::get().allocate(0, false)) node{std::move(entry), delay, nullptr};
+        auto* head = pending.load(std::memory_order_relaxed);
+        do {
+            n->next = head;
+        } while(!pending.compare_exchange_weak(head, n, std::memory_order_release, std::memory_order_relaxed));
+        if(!head) // the list was empty, so no update is pending
+            async_request_update();
+    }
+#if SYSTEMC_VERSION >= 20171012
+    /**
+     * @fn void set_keep_alive(bool)
+     * @brief if set the simulation does not end due to event starvation but waits for entries being posted
+     *
+     * @param keep_alive
+     */
+    void set_keep_alive(bool keep_alive) {
+        if(keep_alive)
+            async_attach_suspending();
+        else
+            async_detach_suspending();
+    }
+#endif
+    //! @brief blocking get, see \ref peq::get()
+    TYPE get() { return que.get(); }
+    //! @brief non-blocking get, see \ref peq::get_next()
+    boost::optional<TYPE> get_next() { return que.get_next(); }
+    //! @brief check if an entry is due, see \ref peq::has_next()
+    bool has_next() { return que.has_next(); }
+    //! @brief hand all due entries to the callback, see \ref peq::drain()
+    template <typename FUNC> size_t drain(FUNC f) { return que.drain(f); }
+    //! @brief the event being notified if an entry is due
+    sc_core::sc_event& event() { return que.event(); }
+
+private:
+    struct node {
+        TYPE entry;
+        sc_core::sc_time delay;
+        node* next;
+    };
+    //! nodes are allocated by the posting threads and returned by the SystemC thread
+    using node_pool = util::mt_pool_allocator<sizeof(node)>;
+
+    static void release(node* n) {
+        n->~node();
+        node_pool::get().free(n);
+    }
+
+    void update() override {
+        // take over the list and reverse it to get the posting order
+        auto* n = pending.exchange(nullptr, std::memory_order_acquire);
+        node* head = nullptr;
+        while(n) {
+            auto* next = n->next;
+            n->next = head;
+            head = n;
+            n = next;
+        }
+        while(head) {
+            auto* next = head->next;
+            que.notify(std::move(head->entry), head->delay);
+            release(head);
+            head = next;
+        }
+    }
+
+    std::atomic<node*> pending{nullptr};
+    peq<TYPE, QUEUE> que;
+};
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_ASYNC_PEQ_H_ */
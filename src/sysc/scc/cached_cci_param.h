@@ -0,0 +1,68 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_CACHED_CCI_PARAM_H_
+#define _SCC_CACHED_CCI_PARAM_H_
+
+#include <cci_configuration>
+#include <utility>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @brief a cci_param for values being read in hot paths
+ *
+ * The parameter keeps a copy of its value which is updated by a post write callback, get_value() and the conversion
+ * operator return this copy without going through the CCI machinery. As a consequence read callbacks are not invoked
+ * for these reads, all other accesses (including reads using an originator or through handles) behave like the ones
+ * of a cci::cci_param.
+ *
+ * @tparam T the value type
+ */
+template <typename T> class cached_cci_param : public cci::cci_param<T> {
+public:
+    using base_type = cci::cci_param<T>;
+    using value_type = T;
+    //! takes the same arguments as the constructors of cci::cci_param
+    template <typename... ARGS>
+    cached_cci_param(ARGS&&... args)
+    : base_type(std::forward<ARGS>(args)...)
+    , cached(base_type::get_value()) {
+        this->register_post_write_callback(&cached_cci_param::update, this);
+    }
+
+    cached_cci_param(const cached_cci_param&) = delete;
+
+    using base_type::operator=;
+
+    using base_type::get_value;
+    //! get the cached value
+    const value_type& get_value() const { return cached; }
+    //! get the cached value
+    operator const value_type&() const { return cached; }
+
+private:
+    void update(const cci::cci_param_write_event<value_type>& ev) { cached = ev.new_value; }
+
+    value_type cached;
+};
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_CACHED_CCI_PARAM_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2022 MINRES Technologies GmbH
+ * Copyright 2022, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -60,17 +60,30 @@ cci_originator cci_broker::get_value_origin(const std::string &parname) const {
 
 void cci_broker::insert_matching_preset_value(const std::string &parname) {
 	bool match=false;
-	for(auto const& e: wildcard_presets){
-		if(std::regex_match(parname, e.second.rr)) {
-			consuming_broker::set_preset_cci_value(parname, e.second.value, e.second.originator);
+	cci_value value;
+	if(resolver && resolver(parname, value)) {
+		consuming_broker::set_preset_cci_value(parname, value, resolver_originator);
+		match=true;
+	} else {
+		auto id = glob_presets.match(parname);
+		if(id != util::glob_matcher::npos) {
+			auto const& e = glob_preset_values[id];
+			consuming_broker::set_preset_cci_value(parname, e.value, e.originator);
 			match=true;
-			break;
+		} else for(auto const& e: wildcard_presets){
+			if(std::regex_match(parname, e.second.rr)) {
+				consuming_broker::set_preset_cci_value(parname, e.second.preset.value, e.second.preset.originator);
+				match=true;
+				break;
+			}
 		}
 	}
-	if(match) for(auto const& e: wildcard_locks){
-		if(std::regex_match(parname, e.second)) {
+	if(match) {
+		bool locked = glob_locks.match(parname) != util::glob_matcher::npos;
+		for(auto it = wildcard_locks.begin(); !locked && it != wildcard_locks.end(); ++it)
+			locked = std::regex_match(parname, it->second);
+		if(locked)
 			consuming_broker::lock_preset_value(parname);
-		}
 	}
 }
 
@@ -162,16 +175,19 @@ void cci_broker::set_preset_cci_value(
 		return m_parent.set_preset_cci_value(parname,value, originator);
 	} else {
 		try {
-			if(parname.find_first_of("*?[")!=std::string::npos) {
-				wildcard_presets.insert(std::pair<std::string, wildcard_entry>(parname,
-						wildcard_entry{std::regex(util::glob_to_regex(parname)), value, originator}));
-			} else if(parname[0]=='^') {
+			if(parname[0]=='^') {
 				wildcard_presets.insert(std::pair<std::string, wildcard_entry>(parname,
-						wildcard_entry{std::regex(parname), value, originator}));
+						wildcard_entry{std::regex(parname), preset_entry{value, originator}}));
+			} else if(parname.find_first_of("*?[")!=std::string::npos) {
+				// the first preset of a pattern is kept as with the regular expressions
+				if(glob_presets.add(parname) == glob_preset_values.size())
+					glob_preset_values.push_back(preset_entry{value, originator});
 			} else
 				consuming_broker::set_preset_cci_value(parname, value, originator);
 		} catch (std::regex_error& e) {
 			SCCERR()<<"Invalid preset parameter name '"<<parname<<"', "<<e.what();
+		} catch (std::invalid_argument& e) {
+			SCCERR()<<"Invalid preset parameter name '"<<parname<<"', "<<e.what();
 		}
 	}
 }
@@ -181,14 +197,16 @@ void cci_broker::lock_preset_value(const std::string &parname) {
 		m_parent.lock_preset_value(parname);
 	} else {
 		try {
-			if(parname.find_first_of("*?[")!=std::string::npos) {
-				wildcard_locks.insert(std::pair<std::string, std::regex>(parname, std::regex(util::glob_to_regex(parname))));
-			} else if(parname[0]=='^') {
+			if(parname[0]=='^') {
 				wildcard_locks.insert(std::pair<std::string, std::regex>(parname, std::regex(parname)));
+			} else if(parname.find_first_of("*?[")!=std::string::npos) {
+				glob_locks.add(parname);
 			} else
 				consuming_broker::lock_preset_value(parname);
 		} catch (std::regex_error& e) {
 			SCCERR()<<"Invalid preset parameter name '"<<parname<<"', "<<e.what();
+		} catch (std::invalid_argument& e) {
+			SCCERR()<<"Invalid preset parameter name '"<<parname<<"', "<<e.what();
 		}
 	}
 }
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2022 MINRES Technologies GmbH
+ * Copyright 2022, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -23,9 +23,15 @@
 #include <regex>
 #include <vector>
 #include <cci_utils/broker.h>
+#include <functional>
+#include <util/glob_matcher.h>
 
 namespace scc {
 class cci_broker : public cci_utils::consuming_broker {
+public:
+  using preset_resolver = std::function<bool(const std::string&, cci::cci_value&)>;
+
+private:
   std::unordered_set<std::string> expose;
 
   bool has_parent;
@@ -46,15 +52,52 @@ class cci_broker : public cci_utils::consuming_broker {
 
   void insert_matching_preset_value(const std::string &parname);
 
-  struct wildcard_entry {
-	  std::regex rr;
+  struct preset_entry {
 	  cci::cci_value value;
 	  cci::cci_originator originator;
   };
+  struct wildcard_entry {
+	  std::regex rr;
+	  preset_entry preset;
+  };
+  // the globbing presets and locks are matched at once, the values are indexed by the id of their pattern
+  util::glob_matcher glob_presets;
+  std::vector<preset_entry> glob_preset_values;
+  util::glob_matcher glob_locks;
+  preset_resolver resolver;
+  cci::cci_originator resolver_originator;
+  // the presets and locks given as regular expression
   std::unordered_map<std::string, wildcard_entry> wildcard_presets;
   std::unordered_map<std::string, std::regex> wildcard_locks;
 
 public:
+  /**
+   * @brief get the scc::cci_broker behind a broker handle
+   *
+   * @param handle the broker handle
+   * @return the broker or nullptr if the handle refers to another broker implementation
+   */
+  static cci_broker* get(cci::cci_broker_handle handle) {
+      return dynamic_cast<cci_broker*>(&unwrap_broker(handle));
+  }
+  /**
+   * @brief set a function providing preset values on demand
+   *
+   * The resolver is asked for the preset value if a parameter has no preset value yet, it takes precedence over the
+   * wildcard presets. This allows to keep large configurations unconverted until their parameters are created.
+   *
+   * @param resolver the function returning true if it provides a value for the name, nullptr to remove it
+   * @param originator the originator of the values being provided
+   */
+  void set_preset_resolver(preset_resolver resolver, const cci::cci_originator& originator) {
+      this->resolver = std::move(resolver);
+      resolver_originator = originator;
+  }
+  //! check for a preset value of exactly this name without consulting the resolver and the wildcard presets
+  bool has_exact_preset_value(const std::string &parname) const {
+      return consuming_broker::has_preset_value(parname);
+  }
+
 
   cci::cci_originator get_value_origin(const std::string &parname) const override;
 
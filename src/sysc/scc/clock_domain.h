@@ -0,0 +1,150 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_CLOCK_DOMAIN_H_
+#define _SCC_CLOCK_DOMAIN_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <systemc>
+#include <unordered_map>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @class clock_domain
+ * @brief the period of a clock together with a version counter
+ *
+ * The version is incremented upon each change of the period. Components keep a clock_domain_ref and compare the
+ * version when they need the period, so a frequency change costs O(1) independent of the number of components in the
+ * domain and no callbacks are needed.
+ */
+class clock_domain {
+public:
+    explicit clock_domain(sc_core::sc_time const& period)
+    : period_value(period.value()) {}
+
+    clock_domain(clock_domain const&) = delete;
+
+    clock_domain& operator=(clock_domain const&) = delete;
+    //! the current period
+    sc_core::sc_time get_period() const {
+        return sc_core::sc_time::from_value(period_value.load(std::memory_order_acquire));
+    }
+    //! the version of the period, incremented by each call of set_period()
+    uint64_t get_version() const { return version.load(std::memory_order_acquire); }
+    /**
+     * change the period of the domain
+     *
+     * @param period the new period
+     */
+    void set_period(sc_core::sc_time const& period) {
+        period_value.store(period.value(), std::memory_order_release);
+        version.fetch_add(1, std::memory_order_acq_rel);
+    }
+    /**
+     * get the domain of a clock channel, it is created upon the first call using the period of the clock if it is a
+     * sc_clock
+     *
+     * @param clk the clock channel
+     * @return the domain or nullptr if the clock is not a sc_clock and has no domain yet
+     */
+    static clock_domain* get(sc_core::sc_interface const* clk) {
+        auto& domains = registry();
+        auto it = domains.find(clk);
+        if(it != domains.end())
+            return it->second.get();
+        if(auto* clk_if = dynamic_cast<sc_core::sc_clock const*>(clk))
+            return add(clk, clk_if->period());
+        return nullptr;
+    }
+    /**
+     * register a clock channel with the domain it drives
+     *
+     * @param clk the clock channel
+     * @param period the initial period of the domain
+     * @return the domain
+     */
+    static clock_domain* add(sc_core::sc_interface const* clk, sc_core::sc_time const& period) {
+        auto& entry = registry()[clk];
+        if(!entry)
+            entry.reset(new clock_domain(period));
+        return entry.get();
+    }
+    /**
+     * remove the domain of a clock channel, the references to it become dangling
+     *
+     * @param clk the clock channel
+     */
+    static void remove(sc_core::sc_interface const* clk) { registry().erase(clk); }
+
+private:
+    static std::unordered_map<sc_core::sc_interface const*, std::unique_ptr<clock_domain>>& registry() {
+        static std::unordered_map<sc_core::sc_interface const*, std::unique_ptr<clock_domain>> domains;
+        return domains;
+    }
+
+    std::atomic<uint64_t> period_value;
+    std::atomic<uint64_t> version{0};
+};
+/**
+ * @class clock_domain_ref
+ * @brief the view of a component onto the clock domain it belongs to
+ *
+ * The period is re-read from the domain only if its version changed since the last access.
+ */
+class clock_domain_ref {
+public:
+    clock_domain_ref() = default;
+    /**
+     * resolve the domain of the clock bound to a port, to be called at end_of_elaboration
+     *
+     * @param clk the clock input
+     * @return true if the clock belongs to a domain
+     */
+    template <typename T> bool resolve(sc_core::sc_in<T>& clk) {
+        domain = clock_domain::get(clk.get_interface());
+        version = ~uint64_t(0);
+        return domain != nullptr;
+    }
+    /**
+     * get the current period of the domain
+     *
+     * @return the period, zero if there is no domain
+     */
+    sc_core::sc_time const& get_period() {
+        if(domain && domain->get_version() != version) {
+            version = domain->get_version();
+            period = domain->get_period();
+        }
+        return period;
+    }
+    //! true if the period changed since the last call of get_period()
+    bool changed() const { return domain && domain->get_version() != version; }
+
+private:
+    clock_domain* domain{nullptr};
+    uint64_t version{~uint64_t(0)};
+    sc_core::sc_time period;
+};
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_CLOCK_DOMAIN_H_ */
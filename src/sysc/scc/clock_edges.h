@@ -0,0 +1,121 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_CLOCK_EDGES_H_
+#define _SCC_CLOCK_EDGES_H_
+
+#include <systemc>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @class clock_edges
+ * @brief computes the rising edges of a clock instead of waiting for each of them
+ *
+ * If the clock is a sc_clock (or the period is known otherwise, e.g. from a tick-less clock, see scc::tick2time) the
+ * time of the n-th next rising edge is calculated from the period and the start time of the clock so that a process
+ * waiting for n cycles is activated once instead of n times. Otherwise the waits fall back to counting the rising edges
+ * of the clock signal.
+ *
+ * Note: a computed wait returns in the first delta cycle of the time stamp of the edge, i.e. before the processes
+ * sensitive to the clock signal.
+ */
+class clock_edges {
+public:
+    clock_edges() = default;
+    /**
+     * resolve the clock bound to a port, to be called at end_of_elaboration
+     *
+     * @param clk the clock input
+     */
+    void resolve(sc_core::sc_in<bool>& clk) {
+        clk_i = &clk;
+        if(auto* clk_if = dynamic_cast<sc_core::sc_clock*>(clk.get_interface())) {
+            period = clk_if->period();
+            first = clk_if->posedge_first() ? clk_if->start_time()
+                                            : clk_if->start_time() + clk_if->period() * (1.0 - clk_if->duty_cycle());
+        } else
+            period = sc_core::SC_ZERO_TIME;
+    }
+    /**
+     * set the clock period for clocks not being a sc_clock, a zero period makes the waits fall back to counting edges
+     *
+     * @param clk_period the period
+     * @param first_edge the time of the first rising edge
+     */
+    void set_period(sc_core::sc_time const& clk_period, sc_core::sc_time const& first_edge = sc_core::SC_ZERO_TIME) {
+        period = clk_period;
+        first = first_edge;
+    }
+    //! true if the edges are computed
+    bool is_tickless() const { return period != sc_core::SC_ZERO_TIME; }
+    //! the clock period, zero if unknown
+    sc_core::sc_time const& get_period() const { return period; }
+    /**
+     * the time of the cycles-th rising edge after the current time, a rising edge at the current time does not count
+     *
+     * @param cycles the number of cycles
+     * @return the absolute time, only valid if is_tickless() is true
+     */
+    sc_core::sc_time next_edge(unsigned cycles = 1) const {
+        auto now = sc_core::sc_time_stamp();
+        if(!cycles)
+            return now;
+        if(now < first)
+            return first + period * (cycles - 1);
+        auto elapsed = (now - first).value() / period.value() + cycles;
+        return first + sc_core::sc_time::from_value(elapsed * period.value());
+    }
+    /**
+     * wait for a number of rising edges of the clock, to be called from a thread
+     *
+     * @param cycles the number of cycles
+     */
+    void wait(unsigned cycles = 1) const {
+        if(!cycles)
+            return;
+        if(is_tickless())
+            sc_core::wait(next_edge(cycles) - sc_core::sc_time_stamp());
+        else
+            for(unsigned i = 0; i < cycles; ++i)
+                sc_core::wait(clk_i->posedge_event());
+    }
+    /**
+     * re-trigger the calling method at the cycles-th rising edge
+     *
+     * @param cycles the number of cycles, needs to be at least one if the edges are not computed
+     */
+    void next_trigger(unsigned cycles = 1) const {
+        if(is_tickless())
+            sc_core::next_trigger(next_edge(cycles) - sc_core::sc_time_stamp());
+        else {
+            sc_assert(cycles == 1);
+            sc_core::next_trigger(clk_i->posedge_event());
+        }
+    }
+
+private:
+    sc_core::sc_in<bool>* clk_i{nullptr};
+    sc_core::sc_time period;
+    sc_core::sc_time first;
+};
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_CLOCK_EDGES_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2018-2022 MINRES Technologies GmbH
+ * Copyright 2018-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -15,8 +15,14 @@
  *******************************************************************************/
 
 #include "configurable_tracer.h"
+#include "elab_profiler.h"
+#include "report.h"
 #include "traceable.h"
-#include <unordered_set>
+#include "utilities.h"
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <util/ities.h>
 
 using namespace sc_core;
 using namespace scc;
@@ -48,42 +54,61 @@ scc::configurable_tracer::~configurable_tracer() {
         delete ptr;
 }
 
-//const std::unordered_set<std::string> traceable_kinds = {};
 void configurable_tracer::descend(const sc_core::sc_object* obj, bool trace) {
     if(obj == this)
         return;
-    const std::string kind = obj->kind();
-    if((types_to_trace & trace_types::SIGNALS) == trace_types::SIGNALS && kind == "tlm_signal") {
-        if(trace)
-            obj->trace(trf);
-        return;
-    } else if(kind == "sc_vector") {
+    switch(get_object_kind(obj)) {
+    case object_kind::VECTOR:
         if(trace)
             for(auto o : obj->get_child_objects())
                 descend(o, trace);
         return;
-    } else if(kind == "sc_module") {
+    case object_kind::MODULE: {
         auto trace_enable = get_trace_enabled(obj, default_trace_enable);
-        if(trace_enable)
+        if(trace_enable) {
+            apply_decimation(obj);
             obj->trace(trf);
+        }
         for(auto o : obj->get_child_objects())
             descend(o, trace_enable);
-    } else if(kind == "sc_variable") {
-        if(trace && (types_to_trace & trace_types::VARIABLES) == trace_types::VARIABLES)
+        return;
+    }
+    case object_kind::VARIABLE:
+        if(trace && (types_to_trace & trace_types::VARIABLES) == trace_types::VARIABLES) {
+            apply_decimation(obj);
             obj->trace(trf);
-    } else if(kind == "sc_signal" || kind == "sc_clock" || kind == "sc_buffer" || kind == "sc_signal_rv") {
-        if(trace && (types_to_trace & trace_types::SIGNALS) == trace_types::SIGNALS)
+        }
+        return;
+    case object_kind::SIGNAL:
+        if(trace && (types_to_trace & trace_types::SIGNALS) == trace_types::SIGNALS) {
+            apply_decimation(obj);
             try_trace(trf, obj, types_to_trace);
-    } else if(kind == "sc_in" || kind == "sc_out" || kind == "sc_inout") {
-        if(trace && (types_to_trace & trace_types::PORTS) == trace_types::PORTS)
+        }
+        return;
+    case object_kind::PORT:
+        if(trace && (types_to_trace & trace_types::PORTS) == trace_types::PORTS) {
+            apply_decimation(obj);
             try_trace(trf, obj, types_to_trace);
-    } else if(const auto* tr = dynamic_cast<const scc::traceable*>(obj)) {
-        if(tr->is_trace_enabled())
-            obj->trace(trf);
-        for(auto o : obj->get_child_objects())
-            descend(o, tr->is_trace_enabled());
-//    } else if(trace && traceable_kinds.find(kind)!=traceable_kinds.end()) {
-//        try_trace(trf, obj, types_to_trace);
+        }
+        return;
+    case object_kind::TLM_SIGNAL:
+        if((types_to_trace & trace_types::SIGNALS) == trace_types::SIGNALS) {
+            if(trace) {
+                apply_decimation(obj);
+                obj->trace(trf);
+            }
+            return;
+        }
+        // fall through
+    default:
+        if(const auto* tr = dynamic_cast<const scc::traceable*>(obj)) {
+            if(tr->is_trace_enabled()) {
+                apply_decimation(obj);
+                obj->trace(trf);
+            }
+            for(auto o : obj->get_child_objects())
+                descend(o, tr->is_trace_enabled());
+        }
     }
 }
 
@@ -94,6 +119,9 @@ auto scc::configurable_tracer::get_trace_enabled(const sc_core::sc_object* obj,
         return a->value;
     } else {
         std::string hier_name{obj->name()};
+        auto it = trace_enables.find(hier_name);
+        if(it != trace_enables.end())
+            return it->second;
         auto h = cci_broker.get_param_handle(hier_name.append("." EN_TRACING_STR));
         if(h.is_valid())
             return h.get_cci_value().get_bool();
@@ -101,6 +129,74 @@ auto scc::configurable_tracer::get_trace_enabled(const sc_core::sc_object* obj,
     return fall_back;
 }
 
+void configurable_tracer::resolve_trace_enables() {
+    // the parameters created by add_control() are read directly, all others are looked up using the broker
+    trace_enables.clear();
+    trace_enables.reserve(params.size());
+    auto suffix_len = std::strlen("." EN_TRACING_STR);
+    for(auto* p : params) {
+        std::string name = p->name();
+        if(name.size() > suffix_len)
+            trace_enables[name.substr(0, name.size() - suffix_len)] = p->get_cci_value().get_bool();
+    }
+}
+
+void configurable_tracer::parse_decimations() {
+    decimation_patterns.clear();
+    decimations.clear();
+    cur_decimation = util::glob_matcher::npos;
+    decimation_tf = dynamic_cast<trace_decimation_if*>(trf);
+    auto spec = trace_decimation.get_value();
+    if(spec.empty())
+        return;
+    if(!decimation_tf) {
+        SCCWARN(SCMOD) << "the signal trace file does not support decimation, ignoring trace_decimation";
+        return;
+    }
+    for(auto& e : util::split(spec, ';')) {
+        util::trim(e);
+        if(e.empty())
+            continue;
+        auto eq = e.rfind('=');
+        auto args = eq == std::string::npos ? std::vector<std::string>{} : util::split(e.substr(eq + 1), ',');
+        scc::trace_decimation cfg;
+        char* end = nullptr;
+        if(args.size()) {
+            util::trim(args[0]);
+            cfg.every_nth = std::strtoul(args[0].c_str(), &end, 10);
+        }
+        if(!end || *end || args.size() > 2) {
+            SCCERR(SCMOD) << "invalid trace_decimation entry '" << e << "'";
+            continue;
+        }
+        if(args.size() > 1) {
+            util::trim(args[1]);
+            if(args[1].empty() || !std::isdigit(static_cast<unsigned char>(args[1][0]))) {
+                SCCERR(SCMOD) << "invalid minimum interval in trace_decimation entry '" << e << "'";
+                continue;
+            }
+            cfg.min_interval = parse_from_string(args[1]).value() / sc_core::sc_time(1, sc_core::SC_PS).value();
+        }
+        try {
+            // identical patterns get the id of the first one which stays in effect
+            if(decimation_patterns.add(e.substr(0, eq)) == decimations.size())
+                decimations.push_back(cfg);
+        } catch(std::invalid_argument& ex) {
+            SCCERR(SCMOD) << "invalid pattern in trace_decimation: " << ex.what();
+        }
+    }
+}
+
+void configurable_tracer::apply_decimation(const sc_core::sc_object* obj) {
+    if(!decimation_tf || decimations.empty())
+        return;
+    auto id = decimation_patterns.match(obj->name());
+    if(id == cur_decimation)
+        return;
+    decimation_tf->set_decimation(id == util::glob_matcher::npos ? scc::trace_decimation{} : decimations[id]);
+    cur_decimation = id;
+}
+
 void configurable_tracer::augment_object_hierarchical(sc_core::sc_object* obj) {
     if(dynamic_cast<sc_core::sc_module*>(obj) != nullptr || dynamic_cast<scc::traceable*>(obj) != nullptr) {
         auto* attr = obj->get_attribute(EN_TRACING_STR);
@@ -125,6 +221,10 @@ void configurable_tracer::augment_object_hierarchical(sc_core::sc_object* obj) {
 }
 
 void configurable_tracer::end_of_elaboration() {
+    SCC_PROFILE_SCOPE("scc::configurable_tracer::end_of_elaboration");
     add_control();
+    resolve_trace_enables();
+    parse_decimations();
     tracer::end_of_elaboration();
+    trace_enables.clear();
 }
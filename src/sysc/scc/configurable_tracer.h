@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2017, 2018 MINRES Technologies GmbH
+ * Copyright 2017-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,7 +17,10 @@
 #ifndef _SCC_CONFIGURABLE_TRACER_H_
 #define _SCC_CONFIGURABLE_TRACER_H_
 
+#include "trace_decimation.h"
 #include "tracer.h"
+#include <unordered_map>
+#include <util/glob_matcher.h>
 /** \ingroup scc-sysc
  *  @{
  */
@@ -31,9 +34,20 @@ namespace scc {
  * This class traverses the SystemC object hierarchy and registers all signals and ports found with the tracing
  * infrastructure. Using a sc_core::sc_attribute or a CCI param named "enableTracing" this can be switch on or off
  * on a per module basis
+ *
+ * If the signal trace file supports it (see scc::trace_decimation_if) the changes of fast toggling objects can be
+ * decimated using the parameter trace_decimation, see there.
  */
 class configurable_tracer : public tracer {
 public:
+    /**
+     * cci parameter holding the decimation of the traced objects as a semicolon separated list of entries
+     * <pattern>=<n>[,<min interval>], e.g. "top.clk=10;top.**.cnt*=1,100ns". The changes of the objects whose
+     * hierarchical name matches the globbing pattern are recorded only every n-th time and only if at least the
+     * minimum interval has passed since the last recorded change. The first matching entry applies.
+     */
+    cci::cci_param<std::string> trace_decimation{"trace_decimation", "",
+                                                 "Decimation of traced objects: <pattern>=<n>[,<min interval>];..."};
     /**
      * constructs a tracer object
      *
@@ -119,11 +133,25 @@ protected:
     bool get_trace_enabled(const sc_core::sc_object*, bool = false);
     //! add the 'enableTracing' attribute to sc_module
     void augment_object_hierarchical(sc_core::sc_object*);
+    //! read the values of the parameters created by add_control() into trace_enables
+    void resolve_trace_enables();
+    //! parse the parameter trace_decimation
+    void parse_decimations();
+    //! set the decimation of the traces of obj being added next
+    void apply_decimation(const sc_core::sc_object* obj);
 
     void end_of_elaboration() override;
     //! array of created cci parameter
     std::vector<cci::cci_param_untyped*> params;
+    //! the values of the 'enableTracing' parameters by module name while descending
+    std::unordered_map<std::string, bool> trace_enables;
     bool control_added{false};
+    //! the decimation patterns and their configurations indexed by the pattern id
+    util::glob_matcher decimation_patterns;
+    std::vector<scc::trace_decimation> decimations;
+    //! the trace file if it supports decimation and the id of the pattern applied last
+    trace_decimation_if* decimation_tf{nullptr};
+    size_t cur_decimation{util::glob_matcher::npos};
 };
 
 } /* namespace scc */
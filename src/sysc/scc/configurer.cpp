@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2017-2022 MINRES Technologies GmbH
+ * Copyright 2017-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -15,6 +15,8 @@
  *******************************************************************************/
 
 #include "configurer.h"
+#include "cci_broker.h"
+#include "elab_profiler.h"
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 #include "report.h"
@@ -27,10 +29,14 @@
 #include <rapidjson/ostreamwrapper.h>
 #include <rapidjson/prettywriter.h>
 #include <cci_configuration>
+#include <algorithm>
 #include <cci_utils/broker.h>
 #include <cstring>
 #include <fstream>
+#include <limits>
+#include <memory>
 #include <unordered_map>
+#include <util/binary_config.h>
 #ifdef HAS_YAMPCPP
 #include <yaml-cpp/exceptions.h>
 #include <yaml-cpp/node/parse.h>
@@ -211,17 +217,60 @@ struct json_config_dumper {
 	}
 };
 
+inline bool is_wildcard_name(std::string const& name) {
+	return name[0] == '^' || name.find_first_of("*?[") != std::string::npos;
+}
+
+inline bool to_cci_value(Value const& val, cci::cci_value& res) {
+	if(val.IsString()) {
+		res = cci::cci_value(std::string(val.GetString(), val.GetStringLength()));
+	} else if(val.IsBool()) {
+		res = cci::cci_value(val.Get<bool>());
+	} else if(val.IsInt()) {
+		res = cci::cci_value(val.Get<int>());
+	} else if(val.IsInt64()) {
+		res = cci::cci_value(val.Get<int64_t>());
+	} else if(val.IsUint()) {
+		res = cci::cci_value(val.Get<unsigned>());
+	} else if(val.IsUint64()) {
+		res = cci::cci_value(val.Get<uint64_t>());
+	} else if(val.IsDouble()) {
+		res = cci::cci_value(val.Get<double>());
+	} else
+		return false;
+	return true;
+}
+
 struct json_config_reader: public config_reader {
 	configurer::broker_t& broker;
 	Document document;
 	bool valid{false};
+	//! if set the presets are not set but kept in the index of the top level reader
+	bool indexed{false};
+	json_config_reader* root{this};
+	std::unordered_map<std::string, Value const*> index;
+	// the readers of included files in indexed mode, they own the values being referenced by the index
+	std::vector<std::unique_ptr<json_config_reader>> sub_readers;
+	std::vector<char> buffer;
 
 	json_config_reader(configurer::broker_t& broker)
 	: broker(broker) {}
 
 	void parse(std::istream& is) {
-		IStreamWrapper stream(is);
-		document.ParseStream(stream);
+		// reading the input at once and parsing it in place avoids copying it char by char and the strings
+		is.seekg(0, std::ios::end);
+		auto size = is.tellg();
+		is.seekg(0, std::ios::beg);
+		if(size >= 0) {
+			buffer.resize(static_cast<size_t>(size) + 1);
+			is.read(buffer.data(), size);
+			buffer.resize(static_cast<size_t>(is.gcount()));
+		} else {
+			is.clear();
+			buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+		}
+		buffer.push_back(0);
+		document.ParseInsitu(buffer.data());
 		valid = !document.HasParseError();
 	}
 	std::string get_error_msg() {
@@ -236,6 +285,22 @@ struct json_config_reader: public config_reader {
 		configure_cci_hierarchical(document, "");
 	}
 
+	bool resolve(std::string const& name, cci::cci_value& value) {
+		auto it = index.find(name);
+		if(it == index.end())
+			return false;
+		auto res = to_cci_value(*it->second, value);
+		index.erase(it);
+		return res;
+	}
+
+	void erase(std::string const& name) { index.erase(name); }
+	//! add the names of the values not having been resolved
+	void get_unresolved(std::vector<std::string>& names) const {
+		for(auto& e : index)
+			names.push_back(e.first);
+	}
+
 	void configure_cci_hierarchical(Value const& value, std::string prefix) {
 		if(value.IsObject()) {
 			auto o = value.GetObject();
@@ -250,13 +315,16 @@ struct json_config_reader: public config_reader {
 				else if(val.IsObject())
 					configure_cci_hierarchical(val, hier_name);
 				else {
-					if(key_name == "!include") {
-						json_config_reader sub_reader(broker);
+					if(key_name == std::string("!include")) {
+						std::unique_ptr<json_config_reader> sub_reader(new json_config_reader(broker));
+						sub_reader->root = root;
 						std::ifstream ifs(find_in_include_path(val.GetString()));
 						if(ifs.is_open()) {
-							sub_reader.parse(ifs);
-							if(sub_reader.valid) {
-								sub_reader.configure_cci_hierarchical(sub_reader.document, prefix);
+							sub_reader->parse(ifs);
+							if(sub_reader->valid) {
+								sub_reader->configure_cci_hierarchical(sub_reader->document, prefix);
+								if(root->indexed)
+									root->sub_readers.push_back(std::move(sub_reader));
 							} else {
 								std::ostringstream os;
 								os<<"Could not parse include file "<<val.GetString();
@@ -269,38 +337,14 @@ struct json_config_reader: public config_reader {
 						}
 					} else {
 						auto param_handle = broker.get_param_handle(hier_name);
+						cci::cci_value cci_val;
 						if(param_handle.is_valid()) {
-							if(val.IsString()) {
-								param_handle.set_cci_value(cci::cci_value(std::string(val.GetString())));
-							} else if(val.IsBool()) {
-								param_handle.set_cci_value(cci::cci_value(val.Get<bool>()));
-							} else if(val.IsInt()) {
-								param_handle.set_cci_value(cci::cci_value(val.Get<int>()));
-							} else if(val.IsInt64()) {
-								param_handle.set_cci_value(cci::cci_value(val.Get<int64_t>()));
-							} else if(val.IsUint()) {
-								param_handle.set_cci_value(cci::cci_value(val.Get<unsigned>()));
-							} else if(val.IsUint64()) {
-								param_handle.set_cci_value(cci::cci_value(val.Get<uint64_t>()));
-							} else if(val.IsDouble()) {
-								param_handle.set_cci_value(cci::cci_value(val.Get<double>()));
-							}
-						} else {
-							if(val.IsString()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(std::string(val.GetString())));
-							} else if(val.IsBool()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(val.Get<bool>()));
-							} else if(val.IsInt()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(val.Get<int>()));
-							} else if(val.IsInt64()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(val.Get<int64_t>()));
-							} else if(val.IsUint()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(val.Get<unsigned>()));
-							} else if(val.IsUint64()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(val.Get<uint64_t>()));
-							} else if(val.IsDouble()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(val.Get<double>()));
-							}
+							if(to_cci_value(val, cci_val))
+								param_handle.set_cci_value(cci_val);
+						} else if(root->indexed && !is_wildcard_name(hier_name)) {
+							root->index[hier_name] = &val;
+						} else if(to_cci_value(val, cci_val)) {
+							broker.set_preset_cci_value(hier_name, cci_val);
 						}
 					}
 				}
@@ -380,10 +424,35 @@ struct yaml_config_dumper {
 	}
 };
 
+inline bool to_cci_value(YAML::Node const& val, cci::cci_value& res) {
+	if(auto v = YAML::as_if<bool, optional<bool>>(val)()) {
+		res = cci::cci_value(v.value());
+	} else if(auto v = YAML::as_if<unsigned, optional<unsigned>>(val)()) {
+		res = cci::cci_value(v.value());
+	} else if(auto v = YAML::as_if<uint64_t, optional<uint64_t>>(val)()) {
+		res = cci::cci_value(v.value());
+	} else if(auto v = YAML::as_if<int, optional<int>>(val)()) {
+		res = cci::cci_value(v.value());
+	} else if(auto v = YAML::as_if<int64_t, optional<int64_t>>(val)()) {
+		res = cci::cci_value(v.value());
+	} else if(auto v = YAML::as_if<double, optional<double>>(val)()) {
+		res = cci::cci_value(v.value());
+	} else if(auto v = YAML::as_if<std::string, optional<std::string>>(val)()) {
+		res = cci::cci_value(v.value());
+	} else
+		return false;
+	return true;
+}
+
 struct yaml_config_reader: public config_reader {
 	configurer::broker_t& broker;
 	YAML::Node document;
 	bool valid{false};
+	//! if set the presets are not set but kept in the index of the top level reader
+	bool indexed{false};
+	yaml_config_reader* root{this};
+	// the nodes keep the memory of their documents alive
+	std::unordered_map<std::string, YAML::Node> index;
 
 	yaml_config_reader(configurer::broker_t& broker)
 	: broker(broker) {}
@@ -411,6 +480,22 @@ struct yaml_config_reader: public config_reader {
 		}
 	}
 
+	bool resolve(std::string const& name, cci::cci_value& value) {
+		auto it = index.find(name);
+		if(it == index.end())
+			return false;
+		auto res = to_cci_value(it->second, value);
+		index.erase(it);
+		return res;
+	}
+
+	void erase(std::string const& name) { index.erase(name); }
+	//! add the names of the values not having been resolved
+	void get_unresolved(std::vector<std::string>& names) const {
+		for(auto& e : index)
+			names.push_back(e.first);
+	}
+
 	void configure_cci_hierarchical(YAML::Node const& value, std::string const& prefix) {
 		if(value.IsMap()) {
 			for(auto it = value.begin(); it != value.end(); ++it) {
@@ -425,6 +510,7 @@ struct yaml_config_reader: public config_reader {
 					auto& tag = val.Tag();
 					if(tag == "!include") {
 						yaml_config_reader sub_reader(broker);
+						sub_reader.root = root;
 						std::ifstream ifs(find_in_include_path(val.as<std::string>()));
 						if(ifs.is_open()) {
 							sub_reader.parse(ifs);
@@ -459,22 +545,12 @@ struct yaml_config_reader: public config_reader {
 							} else if(param.is_string()) {
 								param.set_string(val.as<std::string>());
 							}
+						} else if(root->indexed && !is_wildcard_name(hier_name)) {
+							root->index[hier_name] = val;
 						} else {
-							if(auto res = YAML::as_if<bool, optional<bool>>(val)()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(res.value()));
-							} else if(auto res = YAML::as_if<unsigned, optional<unsigned>>(val)()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(res.value()));
-							} else if(auto res = YAML::as_if<uint64_t, optional<uint64_t>>(val)()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(res.value()));
-							} else if(auto res = YAML::as_if<int, optional<int>>(val)()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(res.value()));
-							} else if(auto res = YAML::as_if<int64_t, optional<int64_t>>(val)()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(res.value()));
-							} else if(auto res = YAML::as_if<double, optional<double>>(val)()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(res.value()));
-							} else if(auto res = YAML::as_if<std::string, optional<std::string>>(val)()) {
-								broker.set_preset_cci_value(hier_name, cci::cci_value(res.value()));
-							}
+							cci::cci_value cci_val;
+							if(to_cci_value(val, cci_val))
+								broker.set_preset_cci_value(hier_name, cci_val);
 						}
 					}
 				}
@@ -575,37 +651,112 @@ bool mirror_sc_attribute(configurer::broker_t& broker, configurer::cci_param_cln
 	return false;
 }
 
-void mirror_sc_attributes(configurer::broker_t& broker, configurer::cci_param_cln& params, cci::cci_originator& cci_originator, sc_core::sc_object* topobj = nullptr, bool update = false) {
+/*
+ * if mirrored is given the attributes of modules whose attribute collection did not grow since the last call are
+ * skipped so that repeated calls only handle the attributes being added in between
+ */
+void mirror_sc_attributes(configurer::broker_t& broker, configurer::cci_param_cln& params, cci::cci_originator& cci_originator, sc_core::sc_object* topobj = nullptr, bool update = false,
+		std::unordered_map<sc_core::sc_object*, size_t>* mirrored = nullptr) {
 	for(auto obj : get_sc_objects(topobj)) {
 		if(auto mod = dynamic_cast<sc_core::sc_module*>(obj)) {
-			for(auto base_attr : mod->attr_cltn()) {
-				std::string hier_name = fmt::format("{}.{}", mod->name(), base_attr->name());
-				mirror_sc_attribute(broker, params, cci_originator, hier_name, base_attr, update);
+			auto& attrs = mod->attr_cltn();
+			if(!mirrored || (*mirrored)[mod] != static_cast<size_t>(attrs.size())) {
+				for(auto base_attr : attrs) {
+					std::string hier_name = fmt::format("{}.{}", mod->name(), base_attr->name());
+					mirror_sc_attribute(broker, params, cci_originator, hier_name, base_attr, update);
+				}
+				if(mirrored)
+					(*mirrored)[mod] = attrs.size();
 			}
-			mirror_sc_attributes(broker, params, cci_originator, mod, update);
+			mirror_sc_attributes(broker, params, cci_originator, mod, update, mirrored);
 		}
 	}
 }
 
-bool cci_name_ignore(std::pair<std::string, cci::cci_value> const& preset_value) {
+inline bool is_log_level_name(std::string const& name) {
 	std::string ending(SCC_LOG_LEVEL_PARAM_NAME);
-	auto& name = preset_value.first;
 	if (name.length() >= ending.length()) {
 		return (0 == name.compare(name.length() - ending.length(), ending.length(), ending));
 	} else {
 		return false;
 	}
 }
-} // namespace
+
+bool cci_name_ignore(std::pair<std::string, cci::cci_value> const& preset_value) {
+	return is_log_level_name(preset_value.first);
+}
+
+inline cci::cci_value to_cci_value(util::binary_config::value const& val) {
+	switch(val.type) {
+	case util::binary_config::BOOL:
+		return cci::cci_value(val.b);
+	case util::binary_config::INT:
+		if(val.i >= std::numeric_limits<int>::min() && val.i <= std::numeric_limits<int>::max())
+			return cci::cci_value(static_cast<int>(val.i));
+		return cci::cci_value(static_cast<int64_t>(val.i));
+	case util::binary_config::UINT:
+		if(val.u <= std::numeric_limits<unsigned>::max())
+			return cci::cci_value(static_cast<unsigned>(val.u));
+		return cci::cci_value(static_cast<uint64_t>(val.u));
+	case util::binary_config::DOUBLE:
+		return cci::cci_value(val.d);
+	default:
+		return cci::cci_value(std::string(val.str, val.len));
+	}
+}
 #ifdef HAS_YAMPCPP
-struct configurer::ConfigHolder: public yaml_config_reader {
-	ConfigHolder(configurer::broker_t& broker) : yaml_config_reader(broker) {}
-};
+using text_config_reader = yaml_config_reader;
 #else
-struct configurer::ConfigHolder: public json_config_reader {
-	ConfigHolder(configurer::broker_t& broker) : json_config_reader(broker) {}
-};
+using text_config_reader = json_config_reader;
 #endif
+} // namespace
+
+struct configurer::ConfigHolder: public text_config_reader {
+	ConfigHolder(configurer::broker_t& broker) : text_config_reader(broker) {}
+	//! a binary configuration being resolved on demand
+	struct binary_input {
+		std::unique_ptr<util::binary_config> config;
+		std::vector<bool> resolved;
+	};
+	std::vector<binary_input> binary_inputs;
+	// the binary configurations take precedence over the text ones, the value is consumed from all inputs
+	bool resolve(std::string const& name, cci::cci_value& value) {
+		bool found = false;
+		for(auto it = binary_inputs.rbegin(); it != binary_inputs.rend(); ++it) {
+			auto idx = it->config->find(name);
+			if(idx != util::binary_config::npos && !it->resolved[idx]) {
+				if(!found)
+					value = to_cci_value(it->config->get_value(idx));
+				it->resolved[idx] = found = true;
+			}
+		}
+		cci::cci_value text_value;
+		if(text_config_reader::resolve(name, text_value) && !found) {
+			value = text_value;
+			found = true;
+		}
+		return found;
+	}
+
+	void erase(std::string const& name) {
+		for(auto& e : binary_inputs) {
+			auto idx = e.config->find(name);
+			if(idx != util::binary_config::npos)
+				e.resolved[idx] = true;
+		}
+		text_config_reader::erase(name);
+	}
+
+	void get_unresolved(std::vector<std::string>& names) const {
+		text_config_reader::get_unresolved(names);
+		for(auto& e : binary_inputs)
+			for(size_t idx = 0; idx < e.config->size(); ++idx)
+				if(!e.resolved[idx])
+					names.push_back(e.config->get_name(idx));
+	}
+	//! the number of attributes per module having been mirrored already
+	std::unordered_map<sc_core::sc_object*, size_t> mirrored_attributes;
+};
 
 configurer::configurer(const std::string& filename, unsigned config_phases) : configurer(filename, config_phases, "$$$configurer$$$") {}
 
@@ -616,13 +767,63 @@ configurer::configurer(const std::string& filename, unsigned config_phases, sc_c
 , cci_originator(cci_broker.get_originator())
 , root(new ConfigHolder(cci_broker))
 {
+	if(config_phases & INDEXED_PRESETS)
+		use_preset_index();
 	if (filename.length() > 0)
 		read_input_file(filename);
 }
 
-configurer::~configurer() {}
+bool configurer::use_preset_index() {
+	if(!root->indexed) {
+		if(auto* scc_broker = scc::cci_broker::get(cci_broker)) {
+			root->indexed = true;
+			auto* holder = root.get();
+			scc_broker->set_preset_resolver([holder](std::string const& name, cci::cci_value& value) {
+				return holder->resolve(name, value);
+			}, cci_originator);
+		}
+	}
+	return root->indexed;
+}
+
+configurer::~configurer() {
+	if(root->indexed)
+		if(auto* scc_broker = scc::cci_broker::get(cci_broker))
+			scc_broker->set_preset_resolver(nullptr, cci_originator);
+}
 
 void configurer::read_input_file(const std::string &filename) {
+	SCC_PROFILE_SCOPE("scc::configurer::read_input_file");
+	if(util::ends_with(filename, ".bcfg")) {
+		try {
+			std::unique_ptr<util::binary_config> config(new util::binary_config(filename));
+			if(use_preset_index()) {
+				std::vector<bool> resolved(config->size(), false);
+				// the parameters created already need their values now
+				for(auto& h : cci_broker.get_param_handles()) {
+					auto idx = config->find(h.name());
+					if(idx != util::binary_config::npos) {
+						h.set_cci_value(to_cci_value(config->get_value(idx)));
+						resolved[idx] = true;
+					}
+				}
+				root->binary_inputs.push_back({std::move(config), std::move(resolved)});
+			} else {
+				for(size_t idx = 0; idx < config->size(); ++idx) {
+					auto name = config->get_name(idx);
+					auto param_handle = cci_broker.get_param_handle(name);
+					if(param_handle.is_valid())
+						param_handle.set_cci_value(to_cci_value(config->get_value(idx)));
+					else
+						cci_broker.set_preset_cci_value(name, to_cci_value(config->get_value(idx)));
+				}
+			}
+			reset_log_verbosity_cache();
+		} catch (std::runtime_error &e) {
+			SCCERR() << "Could not read input file " << filename << ", reason: " << e.what();
+		}
+		return;
+	}
 	root->add_to_includes(util::dir_name(filename));
 	std::ifstream is(filename);
 	if (is.is_open()) {
@@ -633,6 +834,7 @@ void configurer::read_input_file(const std::string &filename) {
 						<< ", " << root->get_error_msg();
 			} else {
 				root->configure_cci();
+				reset_log_verbosity_cache();
 			}
 		} catch (std::runtime_error &e) {
 			SCCERR() << "Could not parse input file " << filename
@@ -665,8 +867,36 @@ void configurer::dump_configuration(std::ostream& os, bool as_yaml, bool with_de
 	writer.EndObject();
 }
 
+void configurer::dump_binary_configuration(std::string const& file_name) {
+	util::binary_config_writer writer;
+	for(auto& h : cci_broker.get_param_handles()) {
+		auto value = h.get_cci_value();
+		std::string name{h.name()};
+		if(value.is_bool())
+			writer.add_bool(name, value.get_bool());
+		else if(value.is_int())
+			writer.add_int(name, value.get_int());
+		else if(value.is_int64())
+			writer.add_int(name, value.get_int64());
+		else if(value.is_uint())
+			writer.add_uint(name, value.get_uint());
+		else if(value.is_uint64())
+			writer.add_uint(name, value.get_uint64());
+		else if(value.is_double())
+			writer.add_double(name, value.get_double());
+		else if(value.is_string())
+			writer.add_string(name, value.get_string());
+	}
+	try {
+		writer.write(file_name);
+	} catch (std::runtime_error &e) {
+		SCCERR() << "Could not write binary configuration " << file_name << ", reason: " << e.what();
+	}
+}
+
 void configurer::configure() {
-	mirror_sc_attributes(cci_broker, cci2sc_attr, cci_originator);
+	SCC_PROFILE_SCOPE("scc::configurer::configure");
+	mirror_sc_attributes(cci_broker, cci2sc_attr, cci_originator, nullptr, false, &root->mirrored_attributes);
 }
 
 void configurer::set_configuration_value(sc_core::sc_attr_base* attr_base, sc_core::sc_object* owner) {
@@ -685,6 +915,15 @@ std::string hier_name_as_regex(std::string const& parname){
 }
 
 void configurer::set_value(const std::string &hier_name, cci::cci_value value) {
+	if(batch_depth) {
+		batch_values.emplace_back(hier_name, std::move(value));
+		return;
+	}
+	apply_value(hier_name, value);
+	reset_log_verbosity_cache();
+}
+
+void configurer::apply_value(const std::string &hier_name, cci::cci_value const& value) {
 	auto regex_str = hier_name_as_regex(hier_name);
 	if(regex_str.length()) {
 		auto rr = std::regex(regex_str);
@@ -699,19 +938,77 @@ void configurer::set_value(const std::string &hier_name, cci::cci_value value) {
 		if(param_handle.is_valid()) {
 			param_handle.set_cci_value(value);
 		} else {
+			// the value replaces the one of the input file
+			root->erase(hier_name);
 			cci_broker.set_preset_cci_value(hier_name, value);
 		}
 	}
 }
 
+void configurer::end_batch() {
+	if(!batch_depth || --batch_depth)
+		return;
+	std::vector<std::pair<std::string, cci::cci_value>> values;
+	values.swap(batch_values);
+	// determine the last value of each parameter, the parameters are written in the order of their first update
+	std::vector<cci::cci_param_untyped_handle> handles;
+	std::vector<cci::cci_value const*> final_values;
+	std::unordered_map<std::string, size_t> index;
+	auto update = [&](cci::cci_param_untyped_handle const& hndl, cci::cci_value const& value) {
+		auto res = index.emplace(hndl.name(), handles.size());
+		if(res.second) {
+			handles.push_back(hndl);
+			final_values.push_back(&value);
+		} else
+			final_values[res.first->second] = &value;
+	};
+	std::vector<cci::cci_param_untyped_handle> all_handles;
+	for(auto& e:values) {
+		auto regex_str = hier_name_as_regex(e.first);
+		if(regex_str.length()) {
+			if(all_handles.empty())
+				all_handles = cci_broker.get_param_handles();
+			auto rr = std::regex(regex_str);
+			for(auto& hndl:all_handles)
+				if(regex_match(hndl.name(), rr))
+					update(hndl, e.second);
+		} else {
+			auto param_handle = cci_broker.get_param_handle(e.first);
+			if(param_handle.is_valid())
+				update(param_handle, e.second);
+			else
+				apply_value(e.first, e.second);
+		}
+	}
+	for(size_t i = 0; i < handles.size(); ++i)
+		handles[i].set_cci_value(*final_values[i]);
+	reset_log_verbosity_cache();
+	for(auto& cb:batch_callbacks)
+		cb();
+}
+
 void configurer::config_check() {
+	SCC_PROFILE_SCOPE("scc::configurer::config_check");
 	try {
 		cci_broker.ignore_unconsumed_preset_values(&cci_name_ignore);
-		auto res = cci_broker.get_unconsumed_preset_values();
+		std::vector<std::string> res;
+		for(auto& val:cci_broker.get_unconsumed_preset_values())
+			res.push_back(val.first);
+		if(root->indexed) {
+			// the indexed values are consumed when being resolved, so the ones left are unused unless their parameter
+			// got its value otherwise. They stay in the index so that they are still resolved on demand.
+			std::vector<std::string> unresolved;
+			root->get_unresolved(unresolved);
+			for(auto& name:unresolved)
+				if(!is_log_level_name(name) && !cci_broker.get_param_handle(name).is_valid())
+					res.push_back(name);
+			std::sort(res.begin(), res.end());
+			res.erase(std::unique(res.begin(), res.end()), res.end());
+		}
 		if(res.size()) {
 			std::ostringstream oss;
-			for(auto& val:res)
-				oss<<"\t - "<<val.first<<"\n";
+			for(auto& name:res)
+				oss<<"\t - "<<name<<"\n";
 			if(res.size()==1) {
 				SCCWARN("scc::configurer")<<"There is " << res.size() << " unused CCI preset value:\n"
 						<< oss.str() << "Please check your setup!";
@@ -728,9 +1025,13 @@ void configurer::config_check() {
 }
 
 void configurer::start_of_simulation() {
+	SCC_PROFILE_SCOPE("scc::configurer::start_of_simulation");
 	if(config_phases & START_OF_SIMULATION) configure();
 	config_check();
-	if(dump_file_name.size()) {
+	if(util::ends_with(dump_file_name, ".bcfg")) {
+		mirror_sc_attributes(cci_broker, cci2sc_attr, cci_originator, nullptr, true);
+		dump_binary_configuration(dump_file_name);
+	} else if(dump_file_name.size()) {
 		auto as_json = util::ends_with(dump_file_name, "json");
 		std::ofstream of{dump_file_name};
 		if(of.is_open()) {
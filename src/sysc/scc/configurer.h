@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2017-2022 MINRES Technologies GmbH
+ * Copyright 2017-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -20,7 +20,10 @@
 #include "report.h"
 #include "utilities.h"
 #include <cci_configuration>
+#include <functional>
 #include <regex>
+#include <utility>
+#include <vector>
 
 /** \ingroup scc-sysc
  *  @{
@@ -50,10 +53,18 @@ public:
 				std::unique_ptr<cci::cci_param_untyped>
 			>>;
     enum {
-        NEVER=0, BEFORE_END_OF_ELABORATION=1, END_OF_ELABORATION=2, START_OF_SIMULATION=4
+        NEVER=0, BEFORE_END_OF_ELABORATION=1, END_OF_ELABORATION=2, START_OF_SIMULATION=4,
+        //! flag to keep the values of the input files indexed by name and to convert them once they are used
+        INDEXED_PRESETS=0x100
     };
     /**
      * create a configurer using an input file
+     *
+     * If INDEXED_PRESETS is or'ed to the phases and the scc::cci_broker is used the values of the input files are not
+     * set as preset values when being read. They are resolved when the corresponding parameter is created, the
+     * values never being used are reported at the start of the simulation without converting them. They stay in the
+     * index so that they can still be resolved later on.
+     *
      * @param filename the input file to read containing the values to apply
      * @param sc_attr_config_phases defines when to apply the values to sc_attribute instances
      */
@@ -71,6 +82,14 @@ public:
 
     configurer& operator=(configurer&&) = delete;
 
+	/**
+	 * read an input file, files ending with .bcfg are read as binary configuration (see dump_binary_configuration()).
+	 *
+	 * A binary configuration is mapped into memory. If the scc::cci_broker is used its values are resolved on demand as
+	 * with INDEXED_PRESETS, otherwise they are set as preset values.
+	 *
+	 * @param filename the name of the input file
+	 */
 	void read_input_file(std::string const&filename);
 	/**
      * configure the design hierarchy using the input file. Apply the values to
@@ -84,9 +103,17 @@ public:
      * @param obj if not null specifies the root object of the dump
      */
     void dump_configuration(std::ostream& os = std::cout, bool as_yaml=false, bool with_description = false, sc_core::sc_object* obj = nullptr);
+    /**
+     * dump the values of all cci parameters to a binary configuration immediately. The file holds the name table
+     * sorted so that read_input_file() can open it in constant time and look up values without parsing.
+     *
+     * @param file_name the name of the file to write
+     */
+    void dump_binary_configuration(std::string const& file_name);
     /**
      * schedule the dump the parameters of a design hierarchy to a file
-     * during start_of_simulation()
+     * during start_of_simulation(). File names ending with .bcfg are written as binary configuration, names ending
+     * with json as JSON and all others as YAML.
      *
      * @param file_name the output stream, std::cout by default
      */
@@ -106,6 +133,34 @@ public:
     template <typename T> void set_value(std::string const& hier_name, T value) {
     	set_value(hier_name, cci::cci_value(value));
     }
+    /**
+     * start a batch of updates. Until the matching end_batch() values being set using set_value() are only collected,
+     * batches may be nested.
+     */
+    void begin_batch() { ++batch_depth; }
+    /**
+     * end a batch of updates. When the outermost batch ends the collected values are applied in the order they have
+     * been set where each parameter is written only once with the last value applying to it, so its pre and post
+     * write callbacks fire once. Afterwards the callbacks registered with register_batch_callback() are invoked.
+     */
+    void end_batch();
+    /**
+     * @brief a scope collecting the values being set during its lifetime as batch
+     */
+    struct batch {
+        explicit batch(configurer& cfg) : cfg(cfg) { cfg.begin_batch(); }
+        batch(const batch&) = delete;
+        batch& operator=(const batch&) = delete;
+        ~batch() { cfg.end_batch(); }
+        configurer& cfg;
+    };
+    /**
+     * register a callback being invoked after a batch of updates has been applied, e.g. to recompute state derived
+     * from several parameters only once
+     *
+     * @param cb the callback
+     */
+    void register_batch_callback(std::function<void()> cb) { batch_callbacks.push_back(std::move(cb)); }
     /**
      * set a value of an sc_attribute from given configuration. This is being used by the scc::ext_attribute
      * which allows to use config values during construction
@@ -132,6 +187,7 @@ protected:
     bool with_description{false};
     configurer(std::string const& filename, unsigned sc_attr_config_phases, sc_core::sc_module_name nm);
     void config_check();
+    bool use_preset_index();
     void before_end_of_elaboration() override {
         if(config_phases & BEFORE_END_OF_ELABORATION) configure();
     }
@@ -144,6 +200,10 @@ protected:
     cci_param_cln cci2sc_attr;
     cci::cci_originator cci_originator;
     std::unique_ptr<ConfigHolder> root;
+    void apply_value(const std::string& hier_name, cci::cci_value const& value);
+    unsigned batch_depth{0};
+    std::vector<std::pair<std::string, cci::cci_value>> batch_values;
+    std::vector<std::function<void()>> batch_callbacks;
 };
 
 } // namespace scc
@@ -0,0 +1,224 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_COUNTERS_H_
+#define _SCC_COUNTERS_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @brief the counters of a call site owned by one thread
+ *
+ * Only the owning thread updates the counters, the atomics just make reading them from other threads well defined
+ * and compile to plain loads and stores.
+ */
+struct counter_slot {
+    //! the number of log2 buckets of a histogram, bucket i counts the values in [2^(i-1), 2^i)
+    static const size_t buckets_count = 65;
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> min{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max{0};
+    std::array<std::atomic<uint64_t>, buckets_count> buckets{};
+
+    //! count an event
+    void inc() { count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+    //! count an event and add its value to the histogram
+    void add(uint64_t value) {
+        inc();
+        sum.store(sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        if(value < min.load(std::memory_order_relaxed))
+            min.store(value, std::memory_order_relaxed);
+        if(value > max.load(std::memory_order_relaxed))
+            max.store(value, std::memory_order_relaxed);
+        auto& b = buckets[bucket_of(value)];
+        b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    //! the bucket of a value
+    static size_t bucket_of(uint64_t value) {
+#if defined(__GNUC__)
+        return value ? 64 - __builtin_clzll(value) : 0;
+#else
+        size_t n = 0;
+        for(; value; value >>= 1)
+            ++n;
+        return n;
+#endif
+    }
+};
+/**
+ * @brief the aggregated counters of all call sites and threads sharing a name
+ */
+struct counter_statistics {
+    std::string name;
+    bool histogram{false};
+    uint64_t count{0};
+    uint64_t sum{0};
+    uint64_t min{0};
+    uint64_t max{0};
+    std::array<uint64_t, counter_slot::buckets_count> buckets{};
+    //! the mean of the values of a histogram
+    double mean() const { return count ? static_cast<double>(sum) / count : 0.; }
+    /**
+     * get an upper bound of the value at a percentile of a histogram
+     *
+     * @param percentile the percentile in the range of 0..100
+     * @return the upper bound of the bucket holding the percentile, clamped to the largest value
+     */
+    uint64_t value_at_percentile(double percentile) const {
+        auto target = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100. * count + 0.5));
+        uint64_t acc = 0;
+        for(size_t i = 0; i < buckets.size(); ++i) {
+            acc += buckets[i];
+            if(acc >= target)
+                return i ? std::min<uint64_t>(i < 64 ? (1ULL << i) - 1 : std::numeric_limits<uint64_t>::max(), max) : 0;
+        }
+        return max;
+    }
+};
+/**
+ * @brief a call site of SCC_COUNT or SCC_HIST, each thread using it gets a slot of its own
+ */
+class counter_site {
+public:
+    counter_site(char const* name, bool histogram);
+
+    ~counter_site();
+
+    counter_site(const counter_site&) = delete;
+
+    counter_site& operator=(const counter_site&) = delete;
+    //! get a new slot for the calling thread
+    counter_slot& local_slot() {
+        std::lock_guard<std::mutex> lock(mtx);
+        slots.emplace_back();
+        return slots.back();
+    }
+    //! add the counters of all threads to stats
+    void aggregate(counter_statistics& stats) {
+        std::lock_guard<std::mutex> lock(mtx);
+        for(auto& s : slots) {
+            auto count = s.count.load(std::memory_order_relaxed);
+            if(!count)
+                continue;
+            stats.min = stats.count ? std::min(stats.min, s.min.load(std::memory_order_relaxed))
+                                    : s.min.load(std::memory_order_relaxed);
+            stats.max = std::max(stats.max, s.max.load(std::memory_order_relaxed));
+            stats.count += count;
+            stats.sum += s.sum.load(std::memory_order_relaxed);
+            for(size_t i = 0; i < stats.buckets.size(); ++i)
+                stats.buckets[i] += s.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    char const* const name;
+    bool const histogram;
+
+private:
+    std::mutex mtx;
+    // a deque keeps the slots in place when growing
+    std::deque<counter_slot> slots;
+};
+/**
+ * @brief the registry of all counter sites
+ */
+class counter_registry {
+public:
+    //! the registry getter
+    static counter_registry& get() {
+        static counter_registry inst;
+        return inst;
+    }
+
+    void add(counter_site* site) {
+        std::lock_guard<std::mutex> lock(mtx);
+        sites.push_back(site);
+    }
+
+    void remove(counter_site* site) {
+        std::lock_guard<std::mutex> lock(mtx);
+        // sites are usually destroyed in the reverse order of their creation
+        auto it = std::find(sites.rbegin(), sites.rend(), site);
+        if(it != sites.rend())
+            sites.erase(std::next(it).base());
+    }
+    //! get the aggregated counters sorted by name, sites sharing a name are aggregated into one entry
+    std::vector<counter_statistics> get_statistics() {
+        std::map<std::string, counter_statistics> by_name;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for(auto* site : sites) {
+                auto& stats = by_name[site->name];
+                stats.name = site->name;
+                stats.histogram |= site->histogram;
+                site->aggregate(stats);
+            }
+        }
+        std::vector<counter_statistics> res;
+        res.reserve(by_name.size());
+        for(auto& e : by_name)
+            res.push_back(e.second);
+        return res;
+    }
+
+private:
+    counter_registry() = default;
+    std::mutex mtx;
+    std::vector<counter_site*> sites;
+};
+
+inline counter_site::counter_site(char const* name, bool histogram)
+: name(name)
+, histogram(histogram) {
+    counter_registry::get().add(this);
+}
+
+inline counter_site::~counter_site() { counter_registry::get().remove(this); }
+} // namespace scc
+/** @} */ // end of scc-sysc
+#ifdef SCC_NO_COUNTERS
+#define SCC_COUNT(name) ((void)0)
+#define SCC_HIST(name, value) ((void)0)
+#else
+//! the counter slot of the calling thread for the call site, name needs to be a string literal
+#define SCC_COUNTER_SLOT(name, histogram)                                                                              \
+    ([]() -> ::scc::counter_slot& {                                                                                    \
+        static ::scc::counter_site site(name, histogram);                                                              \
+        thread_local ::scc::counter_slot& slot = site.local_slot();                                                    \
+        return slot;                                                                                                   \
+    }())
+//! count an event, the counters of all call sites using the same name are aggregated
+#define SCC_COUNT(name) SCC_COUNTER_SLOT(name, false).inc()
+//! add an (unsigned integral) value to a histogram, the values of all call sites using the same name are aggregated
+#define SCC_HIST(name, value) SCC_COUNTER_SLOT(name, true).add(value)
+#endif
+#endif /* _SCC_COUNTERS_H_ */
@@ -0,0 +1,140 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_ELAB_PROFILER_H_
+#define _SCC_ELAB_PROFILER_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @brief records the time spent in nested sections of the elaboration
+ *
+ * Sections are opened and closed using SCC_PROFILE_SCOPE, each thread has a stack of open sections of its own. The
+ * time of a section not spent in nested sections is accumulated per stack of section names, the total time per
+ * section name in addition. The sections are meant for coarse grained work like the elaboration callbacks of a
+ * module so recording is always active, scc::perf_estimator reports the results if its elab_profile parameter is set.
+ */
+class elab_profiler {
+public:
+    using clock = std::chrono::steady_clock;
+    //! the aggregated time of the sections sharing a name, recursive sections are counted once
+    struct section {
+        std::string name;
+        clock::duration total;
+        unsigned count;
+    };
+    //! the profiler getter
+    static elab_profiler& get() {
+        static elab_profiler inst;
+        return inst;
+    }
+    //! open a section nested into the section currently open in the calling thread
+    void enter(std::string name) { stack().push_back(frame{std::move(name), clock::now(), clock::duration::zero()}); }
+    //! close the section opened last by the calling thread
+    void leave() {
+        auto& s = stack();
+        if(s.empty())
+            return;
+        auto elapsed = clock::now() - s.back().start;
+        auto f = std::move(s.back());
+        s.pop_back();
+        if(!s.empty())
+            s.back().children += elapsed;
+        std::string path;
+        bool recursive = false;
+        for(auto& e : s) {
+            path += e.name;
+            path += ';';
+            recursive |= e.name == f.name;
+        }
+        path += f.name;
+        std::lock_guard<std::mutex> lock(mtx);
+        folded[path] += elapsed - f.children;
+        if(!recursive) {
+            auto& t = totals[f.name];
+            t.first += elapsed;
+            ++t.second;
+        }
+    }
+    /**
+     * write the times spent in the sections (excluding the nested ones) in the folded stack format understood by
+     * flamegraph.pl, speedscope and similar tools
+     *
+     * @param os the stream to write to, each line holds the stack of section names separated by ';' and the time in
+     * microseconds
+     */
+    void write_folded(std::ostream& os) const {
+        std::lock_guard<std::mutex> lock(mtx);
+        for(auto& e : folded)
+            os << e.first << " " << std::chrono::duration_cast<std::chrono::microseconds>(e.second).count() << "\n";
+    }
+    //! get the sections sorted by their total time, the longest first
+    std::vector<section> get_sections() const {
+        std::vector<section> res;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for(auto& e : totals)
+                res.push_back(section{e.first, e.second.first, e.second.second});
+        }
+        std::sort(res.begin(), res.end(), [](section const& a, section const& b) { return a.total > b.total; });
+        return res;
+    }
+    /**
+     * @brief a section lasting as long as the scope
+     */
+    struct scope {
+        explicit scope(std::string name) { get().enter(std::move(name)); }
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+        ~scope() { get().leave(); }
+    };
+
+private:
+    elab_profiler() = default;
+    struct frame {
+        std::string name;
+        clock::time_point start;
+        clock::duration children;
+    };
+    static std::vector<frame>& stack() {
+        thread_local std::vector<frame> s;
+        return s;
+    }
+    mutable std::mutex mtx;
+    std::map<std::string, clock::duration> folded;
+    std::map<std::string, std::pair<clock::duration, unsigned>> totals;
+};
+} // namespace scc
+/** @} */ // end of scc-sysc
+#define SCC_PROFILE_CONCAT_(a, b) a##b
+#define SCC_PROFILE_CONCAT(a, b) SCC_PROFILE_CONCAT_(a, b)
+//! record the time of the enclosing scope as section of the elaboration profile
+#define SCC_PROFILE_SCOPE(name) ::scc::elab_profiler::scope SCC_PROFILE_CONCAT(scc_profile_scope_, __LINE__)(name)
+#endif /* _SCC_ELAB_PROFILER_H_ */
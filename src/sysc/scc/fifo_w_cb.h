@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2019 MINRES Technologies GmbH
+ * Copyright 2019-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -16,9 +16,15 @@
 
 #pragma once
 
-#include <deque>
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <sysc/communication/sc_prim_channel.h>
+#include <type_traits>
+#include <utility>
 
 /** \ingroup scc-sysc
  *  @{
@@ -33,6 +39,12 @@ namespace scc {
  * A fifo with callbacks upon running empty or being filled. The registered callbacks are triggered if the fifo is empty
  * or if an element is inserted. This can be used to control the sensitivity of processes reading this fifo.
  *
+ * Elements written become visible to the reader in the update phase. They are kept in a ring buffer growing on
+ * demand, so the update only moves an index regardless of the number of elements written. Ranges of elements can be
+ * pushed and popped in one go. Instead of the per update callback (set_avail_cb()) and the empty callback
+ * (set_empty_cb()) watermark callbacks can be used which are only called if the number of available elements
+ * crosses the level.
+ *
  * @tparam T the type name of the elements to be store in the fifo
  */
 template <typename T> class fifo_w_cb : public sc_core::sc_prim_channel {
@@ -43,53 +55,173 @@ public:
     fifo_w_cb(const char* name)
     : sc_core::sc_prim_channel(name) {}
 
-    virtual ~fifo_w_cb(){};
+    virtual ~fifo_w_cb() {
+        while(head != tail)
+            slot(head++)->~T();
+    }
 
-    void push_back(T& t) {
-        in_queue.push_back(t);
+    void push_back(T& t) { emplace_back(t); }
+    void push_back(const T& t) { emplace_back(t); }
+    void push_back(T&& t) { emplace_back(std::move(t)); }
+    /**
+     * @brief construct an element at the end of the fifo
+     *
+     * @param args the constructor arguments
+     */
+    template <typename... ARGS> void emplace_back(ARGS&&... args) {
+        reserve(1);
+        new(slot(tail)) T(std::forward<ARGS>(args)...);
+        ++tail;
         request_update();
     }
-    void push_back(const T& t) {
-        in_queue.push_back(t);
+    /**
+     * @brief push a range of elements, this requests only one update
+     *
+     * @param first the begin of the range
+     * @param last the end of the range
+     */
+    template <typename IT> void push(IT first, IT last) {
+        auto n = static_cast<size_t>(std::distance(first, last));
+        if(!n)
+            return;
+        reserve(n);
+        for(; first != last; ++first, ++tail)
+            new(slot(tail)) T(*first);
         request_update();
     }
 
-    T& back() { return in_queue.back(); }
-    const T& back() const { return in_queue.back(); }
+    T& back() { return *slot(tail - 1); }
+    const T& back() const { return *slot(tail - 1); }
 
     void pop_front() {
-        out_queue.pop_front();
-        if(empty_cb && !out_queue.size())
-            empty_cb();
+        slot(head++)->~T();
+        popped(avail() + 1);
+    }
+    /**
+     * @brief remove up to n elements from the front of the fifo
+     *
+     * @param n the number of elements
+     * @return the number of elements removed
+     */
+    size_t pop(size_t n) {
+        auto before = avail();
+        n = std::min(n, before);
+        for(size_t i = 0; i < n; ++i)
+            slot(head++)->~T();
+        if(n)
+            popped(before);
+        return n;
+    }
+    /**
+     * @brief move up to n elements from the front of the fifo to an output iterator
+     *
+     * @param n the number of elements
+     * @param out the output iterator
+     * @return the number of elements removed
+     */
+    template <typename OUT> size_t pop(size_t n, OUT out) {
+        auto before = avail();
+        n = std::min(n, before);
+        for(size_t i = 0; i < n; ++i, ++out) {
+            auto* e = slot(head++);
+            *out = std::move(*e);
+            e->~T();
+        }
+        if(n)
+            popped(before);
+        return n;
     }
 
-    T& front() { return out_queue.front(); }
-    const T& front() const { return out_queue.front(); }
+    T& front() { return *slot(head); }
+    const T& front() const { return *slot(head); }
+    //! access the i-th available element
+    T& operator[](size_t i) { return *slot(head + i); }
+    const T& operator[](size_t i) const { return *slot(head + i); }
 
-    size_t avail() const { return out_queue.size(); }
-    bool empty() const { return out_queue.empty(); }
+    size_t avail() const { return static_cast<size_t>(visible - head); }
+    bool empty() const { return visible == head; }
 
     void set_avail_cb(std::function<void(void)> f) { avail_cb = f; }
     void set_empty_cb(std::function<void(void)> f) { empty_cb = f; }
+    /**
+     * @brief set a callback being called in the update phase if the number of available elements reaches or
+     * exceeds the level
+     *
+     * @param level the high watermark
+     * @param f the callback
+     */
+    void set_high_watermark_cb(size_t level, std::function<void(void)> f) {
+        high_level = level;
+        high_cb = f;
+    }
+    /**
+     * @brief set a callback being called if popping elements lets the number of available elements drop to or
+     * below the level
+     *
+     * @param level the low watermark
+     * @param f the callback
+     */
+    void set_low_watermark_cb(size_t level, std::function<void(void)> f) {
+        low_level = level;
+        low_cb = f;
+    }
 
     inline sc_core::sc_event const& data_written_event() const { return data_written_evt; }
 
 protected:
+    using storage_type = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
     // the update method (does nothing by default)
     virtual void update() {
-        if(in_queue.empty())
+        if(visible == tail)
             return;
-        out_queue.insert(out_queue.end(), in_queue.begin(), in_queue.end());
-        in_queue.clear();
+        auto before = avail();
+        visible = tail;
         if(avail_cb)
             avail_cb();
+        if(high_cb && before < high_level && avail() >= high_level)
+            high_cb();
         data_written_evt.notify(sc_core::SC_ZERO_TIME);
     }
 
-    std::deque<T> in_queue{};
-    std::deque<T> out_queue{};
+    void popped(size_t before) {
+        if(empty_cb && empty())
+            empty_cb();
+        if(low_cb && before > low_level && avail() <= low_level)
+            low_cb();
+    }
+
+    T* slot(uint64_t idx) const { return reinterpret_cast<T*>(&buffer[idx & (capacity - 1)]); }
+    //! make sure there is space for n more elements, the capacity is kept a power of 2
+    void reserve(size_t n) {
+        auto used = static_cast<size_t>(tail - head);
+        if(used + n <= capacity)
+            return;
+        auto new_cap = capacity ? capacity : 16;
+        while(new_cap < used + n)
+            new_cap *= 2;
+        std::unique_ptr<storage_type[]> new_buffer(new storage_type[new_cap]);
+        for(size_t i = 0; i < used; ++i) {
+            auto* e = slot(head + i);
+            new(&new_buffer[i]) T(std::move(*e));
+            e->~T();
+        }
+        buffer = std::move(new_buffer);
+        capacity = new_cap;
+        visible -= head;
+        tail -= head;
+        head = 0;
+    }
+
+    std::unique_ptr<storage_type[]> buffer{};
+    size_t capacity{0};
+    //! the ring buffer indices: [head, visible) can be read, [visible, tail) becomes visible in the next update
+    uint64_t head{0}, visible{0}, tail{0};
     std::function<void(void)> avail_cb{};
     std::function<void(void)> empty_cb{};
+    size_t high_level{0}, low_level{0};
+    std::function<void(void)> high_cb{};
+    std::function<void(void)> low_cb{};
     sc_core::sc_event data_written_evt{};
 };
 
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -16,8 +16,12 @@
 
 #include "fst_trace.hh"
 #include "fstapi.h"
+#include "run_report.h"
+#include "span_tracer.h"
+#include "trace/scope_tree.hh"
 #include "trace/types.hh"
 #include "utilities.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
@@ -33,9 +37,13 @@
 
 namespace scc {
 namespace trace {
-inline size_t get_buffer_size(int length) {
-    size_t sz = (static_cast<size_t>(length) + 4096) & (~static_cast<size_t>(4096 - 1));
-    return std::max<decltype(sz)>(1024UL, sz);
+//! emit a wide sc_signed or sc_unsigned using its packed representation of 32bit words
+template <typename T> inline void emit_packed(void* m_fst, fstHandle hndl, unsigned bits, T const& val) {
+    static std::vector<sc_dt::sc_digit> words;
+    // the packed representation of sc_unsigned holds a sign bit, hence one word more for multiples of 32 bits
+    words.assign(bits / 32 + 1, 0);
+    val.get_packed_rep(words.data());
+    fstWriterEmitValueChangeVec32(m_fst, hndl, bits, words.data());
 }
 
 inline unsigned get_bits(const char** literals) {
@@ -117,12 +125,7 @@ template <typename T, typename OT = T> struct fst_trace_t : public fst_trace {
 };
 
 template <typename T, typename OT> inline void fst_trace_t<T, OT>::record(void* m_fst) {
-    static std::vector<char> rawdata(65);
-    char *s = &rawdata[0];
-    for (size_t i = 0; i < 8*sizeof(T); ++i)
-            *s++ = '0' + ((old_val >> (8*sizeof(T) - i - 1)) & 1);
-    *s=0;
-    fstWriterEmitValueChange(m_fst, fst_hndl, &rawdata[0]);
+    fstWriterEmitValueChange64(m_fst, fst_hndl, bits, static_cast<uint64_t>(old_val));
 }
 template <> void fst_trace_t<bool, bool>::record(void* m_fst) {
     fstWriterEmitValueChange(m_fst, fst_hndl, old_val ? "1" : "0");
@@ -143,44 +146,22 @@ template <> void fst_trace_t<double, double>::record(void* m_fst) {
     fstWriterEmitValueChange(m_fst, fst_hndl, &old_val);
 }
 template <> void fst_trace_t<sc_dt::sc_int_base, sc_dt::sc_int_base>::record(void* m_fst) {
-    static std::vector<char> rawdata(1024);
-    if(rawdata.size()< old_val.length()+1)
-        rawdata.resize(old_val.length()+1);
-    char* rawdata_ptr = &rawdata[0];
-    for(int bitindex = old_val.length() - 1; bitindex >= 0; --bitindex)
-        *rawdata_ptr++ = '0' + old_val[bitindex].value();
-    *rawdata_ptr=0;
-    fstWriterEmitValueChange(m_fst, fst_hndl, &rawdata[0]);
+    fstWriterEmitValueChange64(m_fst, fst_hndl, bits, static_cast<uint64_t>(old_val.value()));
 }
 template <> void fst_trace_t<sc_dt::sc_uint_base, sc_dt::sc_uint_base>::record(void* m_fst) {
-    static std::vector<char> rawdata(1024);
-    if(rawdata.size()< old_val.length()+1)
-        rawdata.resize(old_val.length()+1);
-    char* rawdata_ptr = &rawdata[0];
-    for(int bitindex = old_val.length() - 1; bitindex >= 0; --bitindex)
-        *rawdata_ptr++ = '0' + old_val[bitindex].value();
-    *rawdata_ptr=0;
-    fstWriterEmitValueChange(m_fst, fst_hndl, &rawdata[0]);
+    fstWriterEmitValueChange64(m_fst, fst_hndl, bits, old_val.value());
 }
 template <> void fst_trace_t<sc_dt::sc_signed, sc_dt::sc_signed>::record(void* m_fst) {
-    static std::vector<char> rawdata(1024);
-    if(rawdata.size()< old_val.length()+1)
-        rawdata.resize(old_val.length()+1);
-    char* rawdata_ptr = &rawdata[0];
-    for(int bitindex = old_val.length() - 1; bitindex >= 0; --bitindex)
-        *rawdata_ptr++ = '0' + old_val[bitindex].value();
-    *rawdata_ptr=0;
-    fstWriterEmitValueChange(m_fst, fst_hndl, &rawdata[0]);
+    if(bits <= 64)
+        fstWriterEmitValueChange64(m_fst, fst_hndl, bits, old_val.to_uint64());
+    else
+        emit_packed(m_fst, fst_hndl, bits, old_val);
 }
 template <> void fst_trace_t<sc_dt::sc_unsigned, sc_dt::sc_unsigned>::record(void* m_fst) {
-    static std::vector<char> rawdata(1024);
-    if(rawdata.size()< old_val.length()+1)
-        rawdata.resize(old_val.length()+1);
-    char* rawdata_ptr = &rawdata[0];
-    for(int bitindex = old_val.length() - 1; bitindex >= 0; --bitindex)
-        *rawdata_ptr++ = '0' + old_val[bitindex].value();
-    *rawdata_ptr=0;
-    fstWriterEmitValueChange(m_fst, fst_hndl, &rawdata[0]);
+    if(bits <= 64)
+        fstWriterEmitValueChange64(m_fst, fst_hndl, bits, old_val.to_uint64());
+    else
+        emit_packed(m_fst, fst_hndl, bits, old_val);
 }
 template <> void fst_trace_t<sc_dt::sc_fxval, sc_dt::sc_fxval>::record(void* m_fst) {
     auto val = old_val.to_double();
@@ -198,37 +179,109 @@ template <> void fst_trace_t<sc_dt::sc_fxnum_fast, sc_dt::sc_fxval_fast>::record
     fstWriterEmitValueChange(m_fst, fst_hndl, &val);
 }
 template <> void fst_trace_t<sc_dt::sc_bv_base, sc_dt::sc_bv_base>::record(void* m_fst) {
-    auto str = old_val.to_string();
-    auto* cstr = str.c_str();
-    auto c = *cstr;
-    if(c != '1')
-        while(c == *(cstr + 1))
-            cstr++;
-    fstWriterEmitValueChange(m_fst, fst_hndl, str.c_str());
+    static std::vector<uint32_t> words;
+    words.resize(old_val.size());
+    for(int i = 0; i < old_val.size(); ++i)
+        words[i] = old_val.get_word(i);
+    fstWriterEmitValueChangeVec32(m_fst, fst_hndl, bits, words.data());
 }
 template <> void fst_trace_t<sc_dt::sc_lv_base, sc_dt::sc_lv_base>::record(void* m_fst) {
-    auto str = old_val.to_string();
-    auto* cstr = str.c_str();
-    auto c = *cstr;
-    if(c != '1')
-        while(c == *(cstr + 1))
-            cstr++;
-    fstWriterEmitValueChange(m_fst, fst_hndl, str.c_str());
+    static std::vector<uint32_t> words;
+    words.resize(old_val.size());
+    for(int i = 0; i < old_val.size(); ++i) {
+        if(old_val.get_cword(i)) { // there are X or Z bits, use the string representation
+            fstWriterEmitValueChange(m_fst, fst_hndl, old_val.to_string().c_str());
+            return;
+        }
+        words[i] = old_val.get_word(i);
+    }
+    fstWriterEmitValueChangeVec32(m_fst, fst_hndl, bits, words.data());
+}
+
+struct fst_trace_lv7 : public fst_trace {
+    fst_trace_lv7(uint64_t const* planes, unsigned width, std::string const& name)
+    : fst_trace(name, trace::WIRE, width)
+    , act_val(planes)
+    , words((width + 63) / 64)
+    , old_val(planes, planes + 3 * words) {}
+
+    uintptr_t get_hash() override { return reinterpret_cast<uintptr_t>(act_val); }
+
+    inline bool changed() { return !is_alias && !std::equal(old_val.begin(), old_val.end(), act_val); }
+
+    inline void update() { std::copy(act_val, act_val + old_val.size(), old_val.begin()); }
+
+    void record(void* m_fst) override;
+
+    void update_and_record(void* m_fst) override {
+        update();
+        record(m_fst);
+    };
+
+    uint64_t const* act_val;
+    const unsigned words;
+    std::vector<uint64_t> old_val;
+};
+
+void fst_trace_lv7::record(void* m_fst) {
+    // the planes 1 and 2 are 0 if all values are 0 or 1, plane 0 holds the value then
+    if(std::all_of(old_val.begin() + words, old_val.end(), [](uint64_t w) { return w == 0; })) {
+        if(bits <= 64)
+            fstWriterEmitValueChange64(m_fst, fst_hndl, bits, old_val[0]);
+        else
+            fstWriterEmitValueChangeVec64(m_fst, fst_hndl, bits, old_val.data());
+        return;
+    }
+    static const char lv7_to_char[] = {'0', '1', 'l', 'h', 'z', 'x', 'u', 'x'};
+    static std::vector<char> buf;
+    buf.resize(bits + 1);
+    for(unsigned i = 0; i < bits; ++i) {
+        auto w = i / 64;
+        auto s = i % 64;
+        auto code = ((old_val[w] >> s) & 1) | ((old_val[words + w] >> s) & 1) << 1 |
+                    ((old_val[2 * words + w] >> s) & 1) << 2;
+        buf[bits - 1 - i] = lv7_to_char[code];
+    }
+    buf[bits] = 0;
+    fstWriterEmitValueChange(m_fst, fst_hndl, buf.data());
 }
 } // namespace trace
 
 fst_trace_file::fst_trace_file(const char* name, std::function<bool()>& enable)
-: check_enabled(enable) {
+: check_enabled(enable)
+, parallel_mode{std::string(name) + ".parallel_mode", false, "compress the FST blocks in a background thread",
+                cci::CCI_ABSOLUTE_NAME, cci::cci_originator(name)}
+, pack_type{std::string(name) + ".pack_type", "fastlz", "compression of the FST blocks: lz4, fastlz or zlib",
+            cci::CCI_ABSOLUTE_NAME, cci::cci_originator(name)}
+, block_size{std::string(name) + ".block_size", 0,
+             "number of value changes per FST block, 0 uses the default of the FST library", cci::CCI_ABSOLUTE_NAME,
+             cci::cci_originator(name)} {
     std::stringstream ss;
     ss << name << ".fst";
-    m_fst = fstWriterCreate(ss.str().c_str(), 1);
+    file_name = ss.str();
+    m_fst = fstWriterCreate(file_name.c_str(), 1);
     if(!m_fst) {
     	fprintf(stderr, "Could not open '%s', exiting.\n", ss.str().c_str());
     	exit(255);
     }
-    fstWriterSetPackType(m_fst, FST_WR_PT_FASTLZ);
+    auto const& pack = pack_type.get_value();
+    if(pack == "lz4")
+        fstWriterSetPackType(m_fst, FST_WR_PT_LZ4);
+    else if(pack == "zlib")
+        fstWriterSetPackType(m_fst, FST_WR_PT_ZLIB);
+    else {
+        if(pack != "fastlz")
+            SC_REPORT_WARNING("scc::fst_trace_file", ("unknown pack type " + pack + ", using fastlz").c_str());
+        fstWriterSetPackType(m_fst, FST_WR_PT_FASTLZ);
+    }
     fstWriterSetRepackOnClose(m_fst, 1);
+#ifdef FST_WRITER_PARALLEL
+    fstWriterSetParallelMode(m_fst, parallel_mode.get_value());
+#else
+    if(parallel_mode.get_value())
+        SC_REPORT_WARNING("scc::fst_trace_file", "the FST library has been built without parallel mode support");
     fstWriterSetParallelMode(m_fst, 0);
+#endif
     fstWriterSetTimescale(m_fst, -12); // femto seconds 1*10-12
     fstWriterSetTimezero(m_fst, 0);
     char tbuf[200];
@@ -253,6 +306,7 @@ fst_trace_file::~fst_trace_file() {
     if(m_fst) {
         //fstWriterFlushContext(m_fst);
         fstWriterClose(m_fst);
+        account_trace_file(file_name);
     }
 }
 
@@ -316,6 +370,19 @@ DECL_TRACE_METHOD_A(sc_dt::sc_lv_base)
 #undef DECL_TRACE_METHOD_B
 #undef DECL_TRACE_METHOD_C
 
+void fst_trace_file::trace_lv7(uint64_t const* planes, unsigned width, std::string const& name) {
+    all_traces.emplace_back(
+        this,
+        [](trace::fst_trace* t) {
+            auto* trc = static_cast<trace::fst_trace_lv7*>(t);
+            if(!trc->changed())
+                return false;
+            trc->update();
+            return true;
+        },
+        new trace::fst_trace_lv7(planes, width, name));
+}
+
 void fst_trace_file::trace(const unsigned int& object, const std::string& name, const char** enum_literals) {
     // all_traces.emplace_back(this, &changed<unsigned int>, new fst_trace_enum(object, name, enum_literals));
 }
@@ -377,71 +444,50 @@ DECL_REGISTER_METHOD_A(sc_dt::sc_lv_base)
 #undef DECL_REGISTER_METHOD_C
 
 bool fst_trace_file::trace_entry::notify() {
-    if(!trc->is_alias && compare_and_update(trc))
-        that->triggered_traces.push_back(trc);
-    return !trc->is_alias;
+    if(trc->is_alias)
+        return false;
+    // the value is compared in cycle() so that many changes within a timestep cost only a flag check
+    if(!queued) {
+        queued = true;
+        that->triggered_traces.push_back(this);
+    }
+    return true;
 }
 
 void fst_trace_file::write_comment(const std::string& comment) {}
-namespace {
-struct scope_stack {
-    void add_trace(trace::fst_trace *trace){
-        auto hier = util::split(trace->name, '.');
-        add_trace_rec(std::begin(hier), std::end(hier), trace);
-    }
-
-    void writeScopes(void* fst, std::unordered_map<uintptr_t, fstHandle>& alias_map, const char *scope_name = nullptr){
-    	if(m_traces.size() || scope_name) {
-    		fstWriterSetScope(fst, FST_ST_VCD_SCOPE, scope_name?scope_name:"SystemC", nullptr);
-    		for (auto& e : m_traces) {
-    			auto hier_tokens = util::split(e.second->name, '.');
-    			auto sig_name = hier_tokens.back();
-    			auto alias_it = alias_map.find(e.second->get_hash());
-    			e.second->is_alias = alias_it != std::end(alias_map);
-    			e.second->fst_hndl =
-    					fstWriterCreateVar(fst, e.second->type == trace::REAL ? FST_VT_VCD_REAL : FST_VT_VCD_WIRE, FST_VD_IMPLICIT,
-    							e.second->bits, sig_name.c_str(), e.second->is_alias ? alias_it->second : 0);
-    			if(!e.second->is_alias)
-    				alias_map.insert({e.second->get_hash(), e.second->fst_hndl});
-    		}
-        	for (auto& e : m_scopes)
-        		e.second->writeScopes(fst, alias_map, e.first.c_str());
-    		fstWriterSetUpscope(fst);
-    	} else
-    		for (auto& e : m_scopes)
-    			e.second->writeScopes(fst, alias_map, e.first.c_str());
-    }
-
-    ~scope_stack(){
-        for (auto& s : m_scopes)
-            delete s.second;
-    }
-private:
-    void add_trace_rec(std::vector<std::string>::iterator beg, std::vector<std::string>::iterator const& end, trace::fst_trace *trace){
-        if(std::distance(beg,  end)==1){
-            m_traces.push_back(std::make_pair(*beg, trace));
-        } else {
-            auto sc = m_scopes.find(*beg);
-            if(sc == std::end(m_scopes))
-                sc = m_scopes.insert({*beg, new scope_stack}).first;
-            sc->second->add_trace_rec(++beg, end, trace);
-        }
-    }
-    std::vector<std::pair<std::string,trace::fst_trace*> > m_traces{0};
-    std::unordered_map<std::string, scope_stack*> m_scopes{0};
-};
 
+void fst_trace_file::set_decimation(trace_decimation const& cfg) {
+    decimations.emplace_back(all_traces.size(), cfg);
 }
+
 void fst_trace_file::init() {
+    apply_decimations(all_traces, decimations);
     std::vector<trace_entry*> traces;
     traces.reserve(all_traces.size());
-    scope_stack scope;
-    for(auto& e : all_traces) {
-        scope.add_trace(e.trc);
+    for(auto& e : all_traces)
         traces.push_back(&e);
-    }
-    std::unordered_map<uintptr_t, fstHandle> alias_map;
-    scope.writeScopes(m_fst, alias_map);
+    trace::sort_by_name(traces, [](trace_entry const* e) { return e->trc; });
+    trace::scope_tree<trace::fst_trace> tree;
+    for(auto e : traces)
+        tree.add_trace(e->trc);
+    trace::alias_map<trace::fst_trace> aliases(traces.size());
+    auto fst = m_fst;
+    auto enter = [fst](trace::scope_tree<trace::fst_trace>::scope const& s) {
+        fstWriterSetScope(fst, FST_ST_VCD_SCOPE, s.name.c_str(), nullptr);
+    };
+    auto visit = [fst, &aliases](trace::fst_trace* trc, const char* leaf_name) {
+        auto* orig = aliases.insert(trc);
+        trc->fst_hndl = fstWriterCreateVar(fst, trc->type == trace::REAL ? FST_VT_VCD_REAL : FST_VT_VCD_WIRE,
+                                           FST_VD_IMPLICIT, trc->bits, leaf_name, orig ? orig->fst_hndl : 0);
+    };
+    auto leave = [fst](trace::scope_tree<trace::fst_trace>::scope const&) { fstWriterSetUpscope(fst); };
+    // the traces at top level are put into the scope SystemC
+    tree.root.name = "SystemC";
+    if(tree.root.traces.size())
+        enter(tree.root);
+    tree.traverse(enter, visit, leave);
+    if(tree.root.traces.size())
+        leave(tree.root);
     std::copy_if(std::begin(traces), std::end(traces), std::back_inserter(pull_traces),
                  [](trace_entry const* e) { return !(e->trc->is_alias || e->trc->is_triggered); });
     changed_traces.reserve(pull_traces.size());
@@ -451,10 +497,11 @@ void fst_trace_file::init() {
 void fst_trace_file::cycle(bool delta_cycle) {
     if(delta_cycle)
         return;
+    SCC_SPAN("trace.cycle");
     if(last_emitted_ts==std::numeric_limits<uint64_t>::max())
         init();
     if(last_emitted_ts==std::numeric_limits<uint64_t>::max()) {
-        uint64_t time_stamp = sc_core::sc_time_stamp().value() / (1_ps).value();
+        uint64_t time_stamp = trace::time_stamp_ticks();
         fstWriterEmitTimeChange(m_fst, time_stamp);
         for(auto& e : all_traces)
             if(!e.trc->is_alias)
@@ -463,25 +510,30 @@ void fst_trace_file::cycle(bool delta_cycle) {
     } else {
         if(check_enabled && !check_enabled())
             return;
+        auto now = trace::time_stamp_ticks();
         for(auto e : pull_traces) {
-            if(e->compare_and_update(e->trc))
+            if(e->compare_and_update(e->trc) && (!e->dec.cfg.active() || e->dec.record(now)))
                 changed_traces.push_back(e->trc);
         }
-        if(triggered_traces.size() || changed_traces.size()) {
-            uint64_t time_stamp = sc_core::sc_time_stamp().value() / (1_ps).value();
+        // the observed traces are only queued upon notification, their values are compared once per timestep
+        for(auto e : triggered_traces) {
+            e->queued = false;
+            if(e->compare_and_update(e->trc) && (!e->dec.cfg.active() || e->dec.record(now)))
+                changed_traces.push_back(e->trc);
+        }
+        triggered_traces.clear();
+        if(changed_traces.size()) {
+            uint64_t time_stamp = trace::time_stamp_ticks();
             if(last_emitted_ts<time_stamp)
                 fstWriterEmitTimeChange(m_fst, time_stamp);
-            if(triggered_traces.size()) {
-                auto end = std::unique(std::begin(triggered_traces), std::end(triggered_traces));
-                triggered_traces.erase(end, triggered_traces.end());
-                for(auto t : triggered_traces)
-                    t->record(m_fst);
-                triggered_traces.clear();
-            }
-            if(changed_traces.size()) {
-                for(auto t : changed_traces)
-                    t->record(m_fst);
-                changed_traces.clear();
+            changes_in_block += changed_traces.size();
+            for(auto t : changed_traces)
+                t->record(m_fst);
+            changed_traces.clear();
+            if(block_size.get_value() && changes_in_block >= block_size.get_value()) {
+                // takes effect with the next time change, in parallel mode the block is compressed in the background
+                fstWriterFlushContext(m_fst);
+                changes_in_block = 0;
             }
             last_emitted_ts = time_stamp;
         }
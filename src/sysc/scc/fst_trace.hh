@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,10 +18,14 @@
 #ifndef SCC_FST_TRACE_H
 #define SCC_FST_TRACE_H
 
+#include <cci_configuration>
 #include <scc/observer.h>
+#include <scc/sc_lv7.h>
+#include <scc/trace_decimation.h>
 #include <sysc/tracing/sc_trace.h>
 #include <sysc/kernel/sc_ver.h>
 #include <deque>
+#include <utility>
 #include <vector>
 #include <functional>
 
@@ -38,12 +42,27 @@ namespace scc {
 namespace trace {
 class fst_trace;
 }
-struct fst_trace_file : public sc_core::sc_trace_file, public observer {
+/**
+ * @brief a FST trace file
+ *
+ * The writer is configured using the CCI parameters <name>.parallel_mode, <name>.pack_type and <name>.block_size
+ * where <name> is the name of the trace file. In parallel mode the compression of a block of value changes happens in
+ * a background thread of the FST library while the simulation continues.
+ *
+ * Besides the SystemC data types it traces vectors of 7-valued logic (see scc::dt::sc_lv7). The changes of traces
+ * can be decimated (see scc::trace_decimation_if).
+ */
+struct fst_trace_file : public sc_core::sc_trace_file, public observer, public dt::sc_lv7_trace_if,
+                        public trace_decimation_if {
 
     fst_trace_file(const char *name, std::function<bool()>& enable);
 
     virtual ~fst_trace_file();
 
+    void trace_lv7(uint64_t const* planes, unsigned width, std::string const& name) override;
+
+    void set_decimation(trace_decimation const& cfg) override;
+
 protected:
 #define DECL_TRACE_METHOD_A(tp) void trace(const tp& object, const std::string& name) override;
 #define DECL_TRACE_METHOD_B(tp) void trace(const tp& object, const std::string& name, int width) override;
@@ -141,21 +160,36 @@ private:
 
     void init();
     std::function<bool()> check_enabled;
+    //! compress blocks in a background thread (requires the FST library being built with FST_WRITER_PARALLEL)
+    cci::cci_param<bool> parallel_mode;
+    //! the compression of the value change blocks, one of lz4, fastlz or zlib
+    cci::cci_param<std::string> pack_type;
+    //! the number of value changes after which a block is compressed, 0 leaves the decision to the FST library
+    cci::cci_param<unsigned> block_size;
 
     void* m_fst{nullptr};
+    std::string file_name;
+    unsigned changes_in_block{0};
     struct trace_entry: public observer::notification_handle {
         bool (*compare_and_update)(trace::fst_trace*);
         trace::fst_trace* trc;
         fst_trace_file* that;
+        //! set if the entry is in triggered_traces
+        bool queued{false};
+        //! the decimation of the trace
+        trace_decimation_state dec;
         bool notify() override;
         trace_entry(fst_trace_file* owner, bool (*compare_and_update)(trace::fst_trace*), trace::fst_trace* trc)
         :compare_and_update{compare_and_update}, trc{trc}, that{owner}{}
         virtual ~trace_entry(){}
     };
     std::deque<trace_entry> all_traces;
+    //! the decimation configurations and the index of the first trace in all_traces they apply to
+    std::vector<std::pair<size_t, trace_decimation>> decimations;
     std::vector<trace_entry*> pull_traces;
     std::vector<trace::fst_trace*> changed_traces;
-    std::vector<trace::fst_trace*> triggered_traces;
+    //! the observed traces notified since the last cycle, each is queued once
+    std::vector<trace_entry*> triggered_traces;
     uint64_t last_emitted_ts{std::numeric_limits<uint64_t>::max()};
 };
 } // namespace scc
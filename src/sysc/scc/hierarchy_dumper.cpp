@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2022 MINRES Technologies GmbH
+ * Copyright 2022, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,6 +18,7 @@
 #define SC_INCLUDE_DYNAMIC_PROCESSES
 #endif
 #include "hierarchy_dumper.h"
+#include "elab_profiler.h"
 #include "configurer.h"
 #include "tracer.h"
 #include "perf_estimator.h"
@@ -29,10 +30,15 @@
 #include <fstream>
 #include <regex>
 #include <sstream>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include "trace/gz_writer.hh"
 #include <rapidjson/rapidjson.h>
-#include <rapidjson/istreamwrapper.h>
-#include <rapidjson/ostreamwrapper.h>
 #include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 #ifdef FMT_SPDLOG_INTERNAL
 #include <fmt/fmt.h>
 #else
@@ -49,7 +55,6 @@
 
 namespace scc {
 using namespace rapidjson;
-using writer_type = PrettyWriter<OStreamWrapper>;
 
 namespace {
 #ifdef __GNUG__
@@ -96,6 +101,16 @@ struct Port {
     { }
 };
 
+struct Module;
+
+struct Edge {
+    Module const* srcmod;
+    Port const* srcport;
+    Module const* tgtmod;
+    Port const* tgtport;
+    std::string const id;
+};
+
 struct Module {
     std::string const fullname;
     std::string const name;
@@ -104,6 +119,9 @@ struct Module {
     std::string const id{fmt::format("{}", ++object_counter)};
     std::vector<Module> submodules;
     std::vector<Port> ports;
+    std::vector<Edge> edges;
+    //! the largest id having been assigned when the edges of the module got their ids
+    unsigned max_id{0};
 
     Module(std::string const& fullname, std::string const& name, std::string const& type, bool top)
     : fullname(fullname)
@@ -198,10 +216,44 @@ std::vector<std::string> scanModule(sc_core::sc_object const* obj, Module *curre
     return {};
 }
 
+/*
+ * determine the edges of a module and its submodules. The ids are assigned in the order the edges are written so that
+ * the subtrees can be serialized independent of each other
+ */
+void connect(Module& module) {
+    for(auto& m : module.submodules)
+        connect(m);
+    // the ports of the submodules by interface, each list keeps the order of the submodules and their ports
+    std::unordered_map<sc_core::sc_interface const*, std::vector<std::pair<Module const*, Port const*>>> sub_ports;
+    for(auto& m : module.submodules)
+        for(auto& p : m.ports)
+            if(p.port_if)
+                sub_ports[p.port_if].emplace_back(&m, &p);
+    // edges module <-> submodule:
+    for(auto& srcport : module.ports) {
+        auto it = srcport.port_if ? sub_ports.find(srcport.port_if) : sub_ports.end();
+        if(it != sub_ports.end())
+            for(auto& tgt : it->second)
+                module.edges.push_back(
+                        Edge{&module, &srcport, tgt.first, tgt.second, fmt::format("{}", ++object_counter)});
+    }
+    // edges submodule -> submodule:
+    for(auto& srcmod : module.submodules)
+        for(auto& srcport : srcmod.ports) {
+            if(srcport.input || !srcport.port_if)
+                continue;
+            for(auto& tgt : sub_ports[srcport.port_if])
+                if(tgt.second != &srcport && tgt.second->input)
+                    module.edges.push_back(
+                            Edge{&srcmod, &srcport, tgt.first, tgt.second, fmt::format("{}", ++object_counter)});
+        }
+    module.max_id = object_counter;
+}
+
 void generateElk(std::ostream& e, Module const& module, unsigned level=0) {
     SCCDEBUG() << module.name;
     unsigned num_in{0}, num_out{0};
-    for (auto port : module.ports) if(port.input) num_in++; else num_out++;
+    for (auto& port : module.ports) if(port.input) num_in++; else num_out++;
     if(!module.ports.size() && !module.submodules.size()) return;
     e << indent*level << "node " << module.name << " {" << "\n";
     level++;
@@ -209,43 +261,22 @@ void generateElk(std::ostream& e, Module const& module, unsigned level=0) {
     e << indent*level << "portConstraints: FIXED_SIDE\n";
     e << indent*level << "label \"" << module.name << "\"\n";
 
-    for (auto port : module.ports) {
+    for (auto& port : module.ports) {
         SCCDEBUG() << "    " << port.name << "\n";
         auto side = port.input?"WEST":"EAST";
         e << indent*level << "port " << port.name << " { ^port.side: "<<side<<" label '" << port.name<< "' }\n";
     }
 
-    for (auto m : module.submodules)
+    for (auto& m : module.submodules)
         generateElk(e, m, level);
-    // Draw edges module <-> submodule:
-    for (auto srcport : module.ports) {
-        if(srcport.port_if)
-            for (auto tgtmod : module.submodules) {
-                for (auto tgtport : tgtmod.ports) {
-                    if (tgtport.port_if == srcport.port_if)
-                        e << indent*level << "edge " << srcport.fullname << " -> " << tgtport.fullname << "\n";
-                }
-            }
-    }
-    // Draw edges submodule -> submodule:
-    for (auto srcmod : module.submodules) {
-        for (auto srcport : srcmod.ports) {
-            if(!srcport.input && srcport.port_if)
-                for (auto tgtmod : module.submodules) {
-                    for (auto tgtport : tgtmod.ports) {
-                        if(srcmod.fullname == tgtmod.fullname && tgtport.fullname == srcport.fullname)
-                            continue;
-                        if (tgtport.port_if == srcport.port_if && tgtport.input)
-                            e << indent*level << "edge " << srcport.fullname << " -> " << tgtport.fullname << "\n";
-                    }
-                }
-        }
-    }
+    for (auto& edge : module.edges)
+        e << indent*level << "edge " << edge.srcport->fullname << " -> " << edge.tgtport->fullname << "\n";
     level--;
     e << indent*level << "}\n" << "\n";
 }
 
-void generatePortJson(writer_type &writer, hierarchy_dumper::file_type type, const scc::Port &p) {
+template <typename WRITER>
+void generatePortJson(WRITER &writer, hierarchy_dumper::file_type type, const scc::Port &p) {
     writer.StartObject(); {
         writer.Key("id"); writer.String(p.id.c_str());
         if(type != hierarchy_dumper::D3JSON) {
@@ -281,26 +312,28 @@ void generatePortJson(writer_type &writer, hierarchy_dumper::file_type type, con
     } writer.EndObject();
 }
 
-void generateEdgeJson(writer_type &writer, const scc::Port &srcport, const scc::Port &tgtport) {
+template <typename WRITER>
+void generateEdgeJson(WRITER &writer, const scc::Edge &edge) {
     writer.StartObject(); {
-        auto edge_name = fmt::format("{}", ++object_counter);
-        writer.Key("id"); writer.String(edge_name.c_str());
+        writer.Key("id"); writer.String(edge.id.c_str());
         writer.Key("sources"); writer.StartArray(); {
-            writer.String(srcport.id.c_str());
+            writer.String(edge.srcport->id.c_str());
         } writer.EndArray();
         writer.Key("targets"); writer.StartArray(); {
-            writer.String(tgtport.id.c_str());
+            writer.String(edge.tgtport->id.c_str());
         }writer.EndArray();
     } writer.EndObject();
 }
 
-void generateEdgeD3Json(writer_type &writer, const scc::Module &srcmod, const scc::Port &srcport, const scc::Module &tgtmod, const scc::Port &tgtport) {
+template <typename WRITER>
+void generateEdgeD3Json(WRITER &writer, const scc::Edge &edge) {
+    auto& srcport = *edge.srcport;
+    auto& tgtport = *edge.tgtport;
     writer.StartObject(); {
-        auto edge_name = fmt::format("{}", ++object_counter);
-        writer.Key("id"); writer.String(edge_name.c_str());
-        writer.Key("source");writer.String(srcmod.id.c_str());
+        writer.Key("id"); writer.String(edge.id.c_str());
+        writer.Key("source");writer.String(edge.srcmod->id.c_str());
         writer.Key("sourcePort");writer.String(srcport.id.c_str());
-        writer.Key("target");writer.String(tgtmod.id.c_str());
+        writer.Key("target");writer.String(edge.tgtmod->id.c_str());
         writer.Key("targetPort");writer.String(tgtport.id.c_str());
         writer.Key("hwMeta"); writer.StartObject(); {
             if(srcport.sig_name.size()) {
@@ -316,9 +349,13 @@ void generateEdgeD3Json(writer_type &writer, const scc::Module &srcmod, const sc
     } writer.EndObject();
 }
 
-void generateModJson(writer_type& writer, hierarchy_dumper::file_type type, Module const& module, unsigned level=0) {
+template <typename WRITER>
+void generateModJsonParallel(WRITER& writer, hierarchy_dumper::file_type type, std::vector<Module> const& modules);
+
+template <typename WRITER>
+void generateModJson(WRITER& writer, hierarchy_dumper::file_type type, Module const& module, bool parallel=false) {
     unsigned num_in{0}, num_out{0};
-    for (auto port : module.ports) if(port.input) num_in++; else num_out++;
+    for (auto& port : module.ports) if(port.input) num_in++; else num_out++;
     writer.StartObject(); {
         writer.Key("id"); writer.String(module.id.c_str());
         // process ports
@@ -328,43 +365,19 @@ void generateModJson(writer_type& writer, hierarchy_dumper::file_type type, Modu
         // process modules
         if(type==hierarchy_dumper::D3JSON && !module.topModule) writer.Key("_children"); else
         writer.Key("children"); writer.StartArray(); {
-            for(auto& c: module.submodules) generateModJson(writer, type, c, level*1);
+            if(parallel && module.submodules.size() > 1)
+                generateModJsonParallel(writer, type, module.submodules);
+            else
+                for(auto& c: module.submodules) generateModJson(writer, type, c, parallel);
         } writer.EndArray();
         // process connections
         if(type==hierarchy_dumper::D3JSON && !module.topModule) writer.Key("_edges"); else
         writer.Key("edges"); writer.StartArray(); {
-            // Draw edges module <-> submodule:
-            for (auto srcport : module.ports) {
-                if(srcport.port_if) {
-                    for (auto tgtmod : module.submodules) {
-                        for (auto tgtport : tgtmod.ports) {
-                            if (tgtport.port_if == srcport.port_if)
-                                if(type == hierarchy_dumper::D3JSON)
-                                    generateEdgeD3Json(writer, module, srcport, tgtmod, tgtport);
-                                else
-                                    generateEdgeJson(writer, srcport, tgtport);
-                        }
-                    }
-                }
-            }
-            // Draw edges submodule -> submodule:
-            for (auto srcmod : module.submodules) {
-                for (auto srcport : srcmod.ports) {
-                    if(!srcport.input && srcport.port_if) {
-                        for (auto tgtmod : module.submodules) {
-                            for (auto tgtport : tgtmod.ports) {
-                                if(srcmod.fullname == tgtmod.fullname && tgtport.fullname == srcport.fullname)
-                                    continue;
-                                if (tgtport.port_if == srcport.port_if && tgtport.input)
-                                    if(type == hierarchy_dumper::D3JSON)
-                                        generateEdgeD3Json(writer, srcmod, srcport, tgtmod, tgtport);
-                                    else
-                                        generateEdgeJson(writer, srcport, tgtport);
-                            }
-                        }
-                    }
-                }
-            }
+            for(auto& edge : module.edges)
+                if(type == hierarchy_dumper::D3JSON)
+                    generateEdgeD3Json(writer, edge);
+                else
+                    generateEdgeJson(writer, edge);
         } writer.EndArray();
         if(type != hierarchy_dumper::D3JSON) {
             writer.Key("labels"); writer.StartArray(); {
@@ -384,7 +397,7 @@ void generateModJson(writer_type& writer, hierarchy_dumper::file_type type, Modu
                 writer.Key("name"); writer.String(module.name.c_str());
                 writer.Key("cls"); writer.String(module.type.c_str());
                 // writer.Key("bodyText"); writer.String(module.type.c_str());
-                writer.Key("maxId"); writer.Uint(object_counter);
+                writer.Key("maxId"); writer.Uint(module.max_id);
                 writer.Key("isExternalPort"); writer.Bool(false);
                 // writer.Key("cssClass"); writer.String("node-style0");
                 // writer.Key("cssStyle"); writer.String("fill:red");
@@ -396,8 +409,94 @@ void generateModJson(writer_type& writer, hierarchy_dumper::file_type type, Modu
         }
     } writer.EndObject();
 }
+/*
+ * serialize the modules in a pool of threads, each into a buffer of its own, and insert the results in their order
+ */
+template <typename WRITER>
+void generateModJsonParallel(WRITER& writer, hierarchy_dumper::file_type type, std::vector<Module> const& modules) {
+    std::vector<std::unique_ptr<StringBuffer>> buffers(modules.size());
+    std::atomic<size_t> next{0};
+    auto worker = [&buffers, &next, &modules, type]() {
+        for(auto idx = next++; idx < modules.size(); idx = next++) {
+            buffers[idx].reset(new StringBuffer);
+            Writer<StringBuffer> w(*buffers[idx]);
+            generateModJson(w, type, modules[idx]);
+        }
+    };
+    auto count = std::min<size_t>(modules.size(), std::max(1U, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < count; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for(auto& t : threads)
+        t.join();
+    for(auto& b : buffers)
+        writer.RawValue(b->GetString(), b->GetSize(), kObjectType);
+}
+
+template <typename WRITER>
+void generateJson(WRITER& writer, hierarchy_dumper::file_type format, std::vector<Module> const& topModules, bool parallel) {
+    writer.StartObject(); {
+        auto elems = util::split(sc_core::sc_argv()[0], '/');
+        writer.Key("id"); writer.String("0");
+        writer.Key("labels"); writer.StartArray(); {
+            writer.StartObject(); {
+                writer.Key("text"); writer.String(elems[elems.size()-1].c_str());
+            } writer.EndObject();
+        } writer.EndArray();
+        writer.Key("layoutOptions"); writer.StartObject(); {
+            writer.Key("algorithm"); writer.String("layered");
+        } writer.EndObject();
+        writer.Key("children"); writer.StartArray(); {
+            for(auto& c:topModules) generateModJson(writer, format, c, parallel);
+        } writer.EndArray();
+        writer.Key("edges");writer.StartArray();
+        writer.EndArray();
+        if(format == hierarchy_dumper::D3JSON) {
+            writer.Key("hwMeta"); writer.StartObject(); {
+                writer.Key("cls"); writer.Null();
+                writer.Key("maxId"); writer.Uint(65536);
+                writer.Key("name"); writer.String(elems[elems.size()-1].c_str());
+            } writer.EndObject();
+            writer.Key("properties"); writer.StartObject(); {
+                writer.Key("org.eclipse.elk.layered.mergeEdges");  writer.Uint(1);
+                writer.Key("org.eclipse.elk.portConstraints"); writer.String("FIXED_ORDER");
+            } writer.EndObject();
+        }
+    } writer.EndObject();
+}
+
+using sink_type = std::function<void(char const*, size_t)>;
+/*
+ * a rapidjson output stream handing the output over to a sink in large blocks
+ */
+struct block_stream {
+    typedef char Ch;
+    static const size_t block_size = 1024 * 1024;
+    sink_type const sink;
+    std::vector<char> buffer;
+
+    explicit block_stream(sink_type sink)
+    : sink(std::move(sink)) {
+        buffer.reserve(block_size);
+    }
+
+    ~block_stream() { Flush(); }
+
+    void Put(Ch c) {
+        buffer.push_back(c);
+        if(buffer.size() == block_size)
+            Flush();
+    }
+
+    void Flush() {
+        if(buffer.size())
+            sink(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+};
 
-void dump_structure(std::ostream& e, hierarchy_dumper::file_type format) {
+void dump_structure(sink_type const& sink, hierarchy_dumper::file_type format, bool pretty) {
     std::vector<Module> topModules;
     std::vector<sc_core::sc_object*> obja = sc_core::sc_get_top_level_objects();
     if(obja.size()==1 && std::string(obja[0]->kind()) == "sc_module" && std::string(obja[0]->basename()).substr(0, 3) != "$$$") {
@@ -411,52 +510,38 @@ void dump_structure(std::ostream& e, hierarchy_dumper::file_type format) {
         for (auto* child : obja)
             scanModule(child, &topModules.back(), 1);
     }
+    // the modules do not move anymore so the edges can refer to them
+    for (auto& module : topModules)
+        connect(module);
     if(format == hierarchy_dumper::ELKT) {
+        std::ostringstream e;
         e<<"algorithm: org.eclipse.elk.layered\n";
         e<<"edgeRouting: ORTHOGONAL\n";
-        for (auto module : topModules)
+        for (auto& module : topModules)
             generateElk(e, module);
+        auto str = e.str();
+        sink(str.data(), str.size());
         SCCINFO() << "SystemC Structure Dumped to ELK file";
     } else {
-        OStreamWrapper stream(e);
-        writer_type writer(stream);
-        writer.StartObject(); {
-            auto elems = util::split(sc_core::sc_argv()[0], '/');
-            writer.Key("id"); writer.String("0");
-            writer.Key("labels"); writer.StartArray(); {
-                writer.StartObject(); {
-                    writer.Key("text"); writer.String(elems[elems.size()-1].c_str());
-                } writer.EndObject();
-            } writer.EndArray();
-            writer.Key("layoutOptions"); writer.StartObject(); {
-                writer.Key("algorithm"); writer.String("layered");
-            } writer.EndObject();
-            writer.Key("children"); writer.StartArray(); {
-                for(auto& c:topModules) generateModJson(writer, format, c);
-            } writer.EndArray();
-            writer.Key("edges");writer.StartArray();
-            writer.EndArray();
-            if(format == hierarchy_dumper::D3JSON) {
-                writer.Key("hwMeta"); writer.StartObject(); {
-                    writer.Key("cls"); writer.Null();
-                    writer.Key("maxId"); writer.Uint(65536);
-                    writer.Key("name"); writer.String(elems[elems.size()-1].c_str());
-                } writer.EndObject();
-                writer.Key("properties"); writer.StartObject(); {
-                    writer.Key("org.eclipse.elk.layered.mergeEdges");  writer.Uint(1);
-                    writer.Key("org.eclipse.elk.portConstraints"); writer.String("FIXED_ORDER");
-                } writer.EndObject();
-            }
-        } writer.EndObject();
+        block_stream stream(sink);
+        if(pretty) {
+            PrettyWriter<block_stream> writer(stream);
+            generateJson(writer, format, topModules, false);
+        } else {
+            Writer<block_stream> writer(stream);
+            generateJson(writer, format, topModules, true);
+        }
         SCCINFO() << "SystemC Structure Dumped to JSON file";
     }
 }
 } // namespace anonymous
 
-hierarchy_dumper::hierarchy_dumper(const std::string &filename, file_type format)
+hierarchy_dumper::hierarchy_dumper(const std::string &filename, file_type format, bool pretty, compression_type compression)
 : sc_core::sc_module(sc_core::sc_module_name("$$$hierarchy_dumper$$$"))
 , dump_hier_file_name{filename}
 , dump_format{format}
+, pretty{pretty}
+, compression{compression}
 {
 }
 
@@ -464,10 +549,16 @@ hierarchy_dumper::~hierarchy_dumper() {
 }
 
 void hierarchy_dumper::start_of_simulation() {
-    if(dump_hier_file_name.size()) {
+    SCC_PROFILE_SCOPE("scc::hierarchy_dumper::start_of_simulation");
+    if(dump_hier_file_name.empty())
+        return;
+    if(compression == NONE) {
         std::ofstream of{dump_hier_file_name};
         if(of.is_open())
-            dump_structure(of, dump_format);
+            dump_structure([&of](char const* data, size_t size) { of.write(data, size); }, dump_format, pretty);
+    } else {
+        trace::gz_writer writer(dump_hier_file_name, compression == LZ4 ? vcd_compression::LZ4 : vcd_compression::GZIP);
+        dump_structure([&writer](char const* data, size_t size) { writer.write(data, size); }, dump_format, pretty);
     }
 }
 }
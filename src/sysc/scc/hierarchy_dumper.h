@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2022 MINRES Technologies GmbH
+ * Copyright 2022, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -29,14 +29,27 @@ namespace scc {
 class hierarchy_dumper: public sc_core::sc_module {
 public:
     enum file_type { ELKT, JSON, D3JSON, DBGJSON};
-
-    hierarchy_dumper(const std::string& filename, file_type format);
+    //! the compression of the file, the file name is used as given
+    enum compression_type { NONE, GZIP, LZ4 };
+    /**
+     * create a dumper writing the hierarchy at start of simulation
+     *
+     * @param filename the name of the file to write
+     * @param format the format being written
+     * @param pretty if set the JSON formats are indented, otherwise they are written compact. In compact mode the
+     * subtrees of the hierarchy are serialized in parallel
+     * @param compression the compression of the file
+     */
+    hierarchy_dumper(const std::string& filename, file_type format, bool pretty = true,
+                     compression_type compression = NONE);
 
     virtual ~hierarchy_dumper();
 private:
     std::string dump_hier_file_name{""};
     void start_of_simulation() override;
     file_type const dump_format;
+    bool const pretty;
+    compression_type const compression;
 };
 }
 /** @} */ // end of scc-sysc
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2020-2022 MINRES Technologies GmbH
+ * Copyright 2020-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -15,54 +15,70 @@
  *******************************************************************************/
 
 #include "mt19937_rng.h"
+#include <atomic>
+#include <cstdlib>
 #include <systemc>
 #include <unordered_map>
-#include <cstdlib>
 
 namespace {
-struct {
+std::atomic<uint64_t> seed_value{std::mt19937_64::default_seed};
+std::atomic<bool> global_seed{false};
+//! incremented by each change of the seeding, the thread states compare it lazily
+std::atomic<unsigned> seed_epoch{0};
+//! the generators of a thread
+struct thread_state {
+    unsigned epoch{~0U};
     std::mt19937_64 global;
     std::unordered_map<void*, std::mt19937_64> inst;
-    uint64_t seed{std::mt19937_64::default_seed};
-    bool global_seed;
-} rng;
+};
+
+thread_state& get_state() {
+    static thread_local thread_state state;
+    auto epoch = seed_epoch.load(std::memory_order_acquire);
+    if(state.epoch != epoch) {
+        state.epoch = epoch;
+        state.inst.clear();
+        state.global.seed(seed_value.load(std::memory_order_relaxed));
+    }
+    return state;
+}
 
 bool debug_randomization = getenv("SCC_DEBUG_RANDOMIZATION")!=nullptr;
 }; // namespace
 
+uint64_t scc::MT19937::stream_seed(std::string const& name) {
+    auto seed = seed_value.load(std::memory_order_relaxed);
+    if(global_seed.load(std::memory_order_relaxed))
+        return seed;
+    std::hash<std::string> h;
+    return h(name) ^ seed;
+}
+
 auto scc::MT19937::inst() -> std::mt19937_64& {
+    auto& state = get_state();
 #ifndef NCSC
     if(auto* obj = sc_core::sc_get_current_object()) {
-        auto sz = rng.inst.size();
-        auto& ret = rng.inst[obj];
-        if(rng.inst.size() > sz) {
-            uint64_t seed{0};
-            if(rng.global_seed) {
-                seed = reinterpret_cast<uintptr_t>(&rng.inst) ^ rng.seed;
-                if(debug_randomization)
-                    std::cout<<"seeding rng for "<<obj->name()<<" with global seed "<<seed<<"\n";
-            } else {
-                std::string name{obj->name()};
-                std::hash<std::string> h;
-                seed = (h(name) ^ rng.seed);
-                if(debug_randomization)
-                    std::cout<<"seeding rng for "<<obj->name()<<" with local seed "<<seed<<"\n";
-            }
-            ret.seed(seed);
-        } if(debug_randomization) {
-            std::cout<<"retrieving next rnd number for "<<obj->name()<<"\n";
+        auto it = state.inst.find(obj);
+        if(it == state.inst.end()) {
+            auto seed = stream_seed(obj->name());
+            if(debug_randomization)
+                std::cout<<"seeding rng for "<<obj->name()<<" with "<<(global_seed ? "global" : "local")<<" seed "<<seed<<"\n";
+            it = state.inst.emplace(obj, std::mt19937_64(seed)).first;
         }
-        return ret;
+        if(debug_randomization)
+            std::cout<<"retrieving next rnd number for "<<obj->name()<<"\n";
+        return it->second;
     }
 #endif
-    return rng.global;
+    return state.global;
 }
 
 void scc::MT19937::seed(uint64_t new_seed) {
-    rng.seed = new_seed;
-    rng.global.seed(new_seed);
-    for(auto& e : rng.inst)
-        e.second.seed(new_seed);
+    seed_value.store(new_seed, std::memory_order_relaxed);
+    seed_epoch.fetch_add(1, std::memory_order_release);
 }
 
-void scc::MT19937::enable_global_seed(bool enable) { rng.global_seed = enable; }
+void scc::MT19937::enable_global_seed(bool enable) {
+    global_seed.store(enable, std::memory_order_relaxed);
+    seed_epoch.fetch_add(1, std::memory_order_release);
+}
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2020-2022 MINRES Technologies GmbH
+ * Copyright 2020-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,8 +18,11 @@
 #define _SCC_MT19937_RNG_H_
 
 #include <assert.h>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <random>
+#include <string>
 
 /** \ingroup scc-sysc
  *  @{
@@ -34,6 +37,11 @@ namespace scc {
  * This random number generator provides various distribution of random numbers being specific to the SystemC process
  * invoking the generator function. This makes the generator independent of the order of invocation in a delta cycle and
  * allows to replay with the same seed
+ *
+ * The generators are kept per OS thread so that parallel kernels or worker threads do not race and need no locks. The
+ * stream of a process is seeded from its hierarchical name (see stream_seed()) so it is the same independent of the
+ * thread running it. Calls outside of a process use a per thread generator seeded with the global seed. seed() and
+ * enable_global_seed() take effect in all threads upon their next call of a generator function.
  */
 class MT19937 {
 public:
@@ -51,6 +59,14 @@ public:
      * @param enable use the same seed for all MT rng instances
      */
     static void enable_global_seed(bool enable);
+    /**
+     * get the seed of the stream of a named object, e.g. to seed a generator owned by a component which is used by
+     * tasks running outside of the SystemC processes
+     *
+     * @param name the hierarchical name
+     * @return the seed derived from name and the global seed
+     */
+    static uint64_t stream_seed(std::string const& name);
 
     /**
      * generates the next random integer number with uniform distribution (similar to rand() )
@@ -101,7 +117,46 @@ public:
         return u(inst());
     }
 
+    /**
+     * fills a buffer with random bytes. The bytes are those of the numbers uniform() would have returned in the order of
+     * the calls (in host byte order), so filling produces the same data as a loop of uniform() calls while the
+     * generator is looked up only once
+     *
+     * @param data the buffer to fill
+     * @param len the number of bytes
+     */
+    static void fill(uint8_t* data, size_t len) { fill_bytes(inst(), data, len); }
+    /**
+     * fills a buffer with random 32bit numbers, each number returned by uniform() provides two of them
+     *
+     * @param data the buffer to fill
+     * @param count the number of elements
+     */
+    static void fill(uint32_t* data, size_t count) { fill_bytes(inst(), data, count * sizeof(uint32_t)); }
+    /**
+     * fills a buffer with random 64bit numbers, the same numbers uniform() would have returned
+     *
+     * @param data the buffer to fill
+     * @param count the number of elements
+     */
+    static void fill(uint64_t* data, size_t count) {
+        auto& eng = inst();
+        for(size_t i = 0; i < count; ++i)
+            data[i] = eng();
+    }
+
 private:
+    static void fill_bytes(std::mt19937_64& eng, void* data, size_t len) {
+        auto* ptr = static_cast<uint8_t*>(data);
+        for(; len >= sizeof(uint64_t); len -= sizeof(uint64_t), ptr += sizeof(uint64_t)) {
+            uint64_t val = eng();
+            std::memcpy(ptr, &val, sizeof(uint64_t));
+        }
+        if(len) {
+            uint64_t val = eng();
+            std::memcpy(ptr, &val, len);
+        }
+    }
     static std::mt19937_64& inst();
 };
 
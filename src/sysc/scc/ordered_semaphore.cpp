@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2019 MINRES Technologies GmbH
+ * Copyright 2019-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -43,8 +43,7 @@ void ordered_semaphore::set_capacity(unsigned c) {
         auto diff = static_cast<int>(capacity) - static_cast<int>(c);
         capacity = c;
         value -= diff;
-        if(value > 0)
-            free_evt.notify(sc_core::SC_ZERO_TIME);
+        grant();
     } else {
         SCCWARN(SCMOD) << "cannot resize fixed size ordered semaphore";
     }
@@ -60,9 +59,9 @@ void ordered_semaphore::report_error(const char* id, const char* add_msg) const
 
 ordered_semaphore::ordered_semaphore(unsigned init_value_)
 : sc_core::sc_object(sc_core::sc_gen_unique_name("semaphore"))
-, free_evt(gen_unique_event_name("free_event").c_str())
 , value(init_value_)
-, capacity(init_value_) {
+, capacity(init_value_)
+, queue(2) {
     if(value < 0) {
         report_error(sc_core::SC_ID_INVALID_SEMAPHORE_VALUE_);
     }
@@ -70,36 +69,43 @@ ordered_semaphore::ordered_semaphore(unsigned init_value_)
 
 ordered_semaphore::ordered_semaphore(const char* name_, unsigned init_value_)
 : sc_object(name_)
-, free_evt(gen_unique_event_name("free_event").c_str())
 , value(init_value_)
-, capacity(init_value_) {}
+, capacity(init_value_)
+, queue(2) {}
 
 // interface methods
 
 // lock (take) the semaphore, block if not available
 
-auto ordered_semaphore::wait() -> int {
-    queue.at(0).push_back(sc_core::sc_get_current_process_handle());
-    while(in_use()) {
-        sc_core::wait(free_evt);
-    }
-    --value;
-    return value;
-}
+auto ordered_semaphore::wait() -> int { return wait(0); }
 
 auto ordered_semaphore::wait(unsigned priority) -> int {
-    queue.at(priority).push_back(sc_core::sc_get_current_process_handle());
-    while(in_use()) {
-        sc_core::wait(free_evt);
+    if(value > 0 && !waiting) {
+        --value;
+        return value;
     }
-    --value;
+    if(priority >= queue.size())
+        queue.resize(priority + 1);
+    if(free_waiters.empty()) {
+        waiter_pool.emplace_back(new waiter(gen_unique_event_name("free_event").c_str()));
+        free_waiters.push_back(waiter_pool.back().get());
+    }
+    auto* w = free_waiters.back();
+    free_waiters.pop_back();
+    w->granted = false;
+    queue[priority].push_back(w);
+    ++waiting;
+    while(!w->granted)
+        sc_core::wait(w->evt);
+    free_waiters.push_back(w);
+    // the value has been decremented when the semaphore was handed over
     return value;
 }
 
 // lock (take) the semaphore, return -1 if not available
 
 auto ordered_semaphore::trywait() -> int {
-    if(in_use()) {
+    if(value <= 0 || waiting) {
         return -1;
     }
     --value;
@@ -113,9 +119,22 @@ auto ordered_semaphore::post() -> int {
         SCCWARN(SCMOD) << "post() called on entirely free semaphore!";
     } else
         ++value;
-    if(value > 0)
-        free_evt.notify();
+    grant();
     return value;
 }
 
+void ordered_semaphore::grant() {
+    for(auto prio = queue.size(); value > 0 && waiting && prio > 0; --prio) {
+        auto& q = queue[prio - 1];
+        while(value > 0 && q.size()) {
+            auto* w = q.front();
+            q.pop_front();
+            --waiting;
+            --value;
+            w->granted = true;
+            w->evt.notify();
+        }
+    }
+}
+
 } // namespace scc
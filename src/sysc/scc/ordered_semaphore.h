@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2019 MINRES Technologies GmbH
+ * Copyright 2019-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,9 +19,9 @@
 #include "sysc/communication/sc_semaphore_if.h"
 #include "sysc/kernel/sc_event.h"
 #include "sysc/kernel/sc_object.h"
-#include <array>
 #include <deque>
-#include <sysc/kernel/sc_process_handle.h>
+#include <memory>
+#include <vector>
 
 #ifndef SC_API
 #define SC_API
@@ -38,7 +38,9 @@ namespace scc {
  * @brief The ordered_semaphore primitive channel class.
  *
  * The ordered semaphore acts like an ordinary semaphore. It gives the guarantee that access is granted in the order of
- * arrival (FCFS)
+ * arrival (FCFS) within a priority class, waiters of a higher priority class are served first. A post() hands the
+ * semaphore over to the next waiter directly and wakes only this one using a per-waiter event, so a grant costs
+ * O(1) independent of the number of waiting processes.
  */
 class SC_API ordered_semaphore : public sc_core::sc_semaphore_if, public sc_core::sc_object {
 public:
@@ -71,9 +73,10 @@ public:
      */
     int wait() override;
     /**
-     * @fn int wait()
+     * @fn int wait(unsigned)
      * @brief lock (take) the semaphore, block if not available
      *
+     * @param priority the priority class of the request, higher values are served first
      * @return value after locking
      */
     int wait(unsigned priority);
@@ -111,6 +114,13 @@ public:
      * @return current value
      */
     int get_value() const override { return value; }
+    /**
+     * @fn size_t get_waiting_count()const
+     * @brief get the number of processes waiting for the semaphore
+     *
+     * @return number of waiters
+     */
+    size_t get_waiting_count() const { return waiting; }
     /**
      * @fn const char* kind()const
      * @brief kind of this SastemC object
@@ -163,32 +173,27 @@ public:
     };
 
 protected:
-    // support methods
-    bool in_use() {
-        if(value > 0) {
-            if(queue[1].size()) {
-                if(queue[1].front() == sc_core::sc_get_current_process_handle()) {
-                    queue[1].pop_front();
-                    return false;
-                }
-            } else {
-                if(queue[0].front() == sc_core::sc_get_current_process_handle()) {
-                    queue[0].pop_front();
-                    return false;
-                }
-            }
-        }
-        return true;
-    }
+    struct waiter {
+        sc_core::sc_event evt;
+        bool granted{false};
+        waiter(const char* name)
+        : evt(name) {}
+    };
+    //! hand the semaphore over to waiting processes as long as it is available
+    void grant();
 
     // error reporting
     void report_error(const char* id, const char* add_msg = 0) const;
 
 protected:
-    sc_core::sc_event free_evt; // event to block on when m_value is negative
-    int value;                  // current value of the semaphore
+    int value; // current value of the semaphore
     unsigned capacity;
-    std::array<std::deque<sc_core::sc_process_handle>, 2> queue;
+    //! the waiters per priority class in order of arrival
+    std::vector<std::deque<waiter*>> queue;
+    //! the waiter objects being reused, each of them carries its event
+    std::vector<std::unique_ptr<waiter>> waiter_pool;
+    std::vector<waiter*> free_waiters;
+    size_t waiting{0};
 };
 
 template <unsigned CAPACITY> struct ordered_semaphore_t : public ordered_semaphore {
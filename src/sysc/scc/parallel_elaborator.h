@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+
+#ifndef _SCC_PARALLEL_ELABORATOR_H_
+#define _SCC_PARALLEL_ELABORATOR_H_
+
+#include "elab_profiler.h"
+#include "report.h"
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <sysc/kernel/sc_simcontext.h>
+#include <thread>
+#include <type_traits>
+#include <util/thread_pool.h>
+#include <utility>
+#include <vector>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @class parallel_elaborator
+ * @brief builds the parts of independent subsystems not depending on the SystemC kernel on worker threads
+ *
+ * SystemC objects can only be created on the thread running the SystemC kernel as their constructors modify the
+ * object hierarchy. Therefore the elaboration of a subsystem is split into a preparation and an attachment: the
+ * preparation runs on a worker thread of a util::thread_pool and creates a staging object (e.g. register tables,
+ * parsed configuration files or loaded memory images), the attachment runs on the calling thread, creates the SystemC
+ * objects and moves the staged data into them. The preparations start as soon as they are added so they overlap with
+ * the construction of the rest of the design, attach() runs the attachments in the order they were added.
+ *
+ * A preparation must neither create SystemC objects nor use the CCI broker or the reporting of SystemC, values of
+ * parameters need to be read on the calling thread and be captured by the preparation.
+ *
+ * @code
+ * scc::parallel_elaborator elab;
+ * auto image = image_name.get_value();
+ * elab.add("load " + image, [image]() { return load_image(image); },
+ *          [this](image_data&& data) { mem.reset(new memory_model("mem", std::move(data))); });
+ * // ... construct other parts of the platform
+ * elab.attach(); // create the SystemC objects of the staged subsystems
+ * @endcode
+ */
+class parallel_elaborator {
+public:
+    /**
+     * @brief the constructor
+     *
+     * @param threads the number of worker threads, 0 uses the number of hardware threads
+     */
+    explicit parallel_elaborator(unsigned threads = 0) {
+        auto n = threads ? threads : std::thread::hardware_concurrency();
+        pool.start(n ? n : 1);
+    }
+
+    parallel_elaborator(parallel_elaborator const&) = delete;
+
+    parallel_elaborator& operator=(parallel_elaborator const&) = delete;
+    //! attaches the remaining staged subsystems
+    ~parallel_elaborator() {
+        if(stages.empty())
+            return;
+        try {
+            attach();
+        } catch(std::exception& e) {
+            SCCERR("scc::parallel_elaborator") << "elaboration of a subsystem failed: " << e.what();
+        }
+    }
+    /**
+     * @brief add a subsystem, its preparation is started immediately
+     *
+     * @param name the name of the subsystem used for elaboration profiling (see scc::elab_profiler)
+     * @param prepare the callable preparing the staging object on a worker thread
+     * @param attach the callable creating the SystemC objects on the calling thread, it gets the staging object as
+     * rvalue reference (or no argument if prepare returns void)
+     */
+    template <typename PREP, typename ATTACH> void add(std::string const& name, PREP&& prepare, ATTACH&& attach) {
+        using result_type = typename std::result_of<PREP()>::type;
+        auto p = std::make_shared<typename std::decay<PREP>::type>(std::forward<PREP>(prepare));
+        auto fut = std::make_shared<std::future<result_type>>(pool.enqueue([name, p]() -> result_type {
+            SCC_PROFILE_SCOPE("prepare " + name);
+            return (*p)();
+        }));
+        stages.emplace_back(name, make_attach(fut, std::forward<ATTACH>(attach), std::is_void<result_type>()));
+    }
+    /**
+     * @brief wait for the preparations and run the attachments in the order the subsystems were added
+     *
+     * SystemC objects created by the attachments become children of the module being constructed when attach() is
+     * called. An exception thrown by a preparation is rethrown here.
+     */
+    void attach() {
+        if(sc_core::sc_get_status() & ~(sc_core::SC_ELABORATION | sc_core::SC_BEFORE_END_OF_ELABORATION))
+            SCCWARN("scc::parallel_elaborator") << "attaching subsystems after elaboration";
+        auto staged = std::move(stages);
+        stages.clear();
+        for(auto& e : staged) {
+            SCC_PROFILE_SCOPE("attach " + e.first);
+            e.second();
+        }
+    }
+    //! the number of subsystems not yet attached
+    size_t pending() const { return stages.size(); }
+
+private:
+    template <typename R, typename ATTACH>
+    static std::function<void()> make_attach(std::shared_ptr<std::future<R>> fut, ATTACH&& attach, std::false_type) {
+        auto a = std::make_shared<typename std::decay<ATTACH>::type>(std::forward<ATTACH>(attach));
+        return [fut, a]() { (*a)(fut->get()); };
+    }
+
+    template <typename ATTACH>
+    static std::function<void()> make_attach(std::shared_ptr<std::future<void>> fut, ATTACH&& attach,
+                                             std::true_type) {
+        auto a = std::make_shared<typename std::decay<ATTACH>::type>(std::forward<ATTACH>(attach));
+        return [fut, a]() {
+            fut->get();
+            (*a)();
+        };
+    }
+
+    std::vector<std::pair<std::string, std::function<void()>>> stages;
+    util::thread_pool pool;
+};
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_PARALLEL_ELABORATOR_H_ */
@@ -0,0 +1,294 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#include "partition_link.h"
+#include "report.h"
+#include <cstring>
+#include <stdexcept>
+#ifndef _MSC_VER
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace scc {
+namespace {
+//! the fixed size header preceding the data of each message on the wire
+struct wire_header {
+    uint8_t type;
+    uint8_t reserved[3];
+    uint32_t channel;
+    uint64_t tag;
+    uint64_t time;
+    uint32_t length;
+    uint32_t reserved2;
+};
+static_assert(sizeof(wire_header) == 32, "unexpected padding of wire_header");
+
+#ifndef _MSC_VER
+int open_socket(std::string const& address, bool listen) {
+    int fd = -1;
+    if(address.compare(0, 5, "unix:") == 0) {
+        auto path = address.substr(5);
+        sockaddr_un sa{};
+        sa.sun_family = AF_UNIX;
+        if(path.size() >= sizeof(sa.sun_path))
+            throw std::runtime_error("socket path too long: " + path);
+        std::strncpy(sa.sun_path, path.c_str(), sizeof(sa.sun_path) - 1);
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if(fd < 0)
+            throw std::runtime_error("could not create socket");
+        if(listen) {
+            ::unlink(path.c_str());
+            if(::bind(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) < 0 || ::listen(fd, 1) < 0) {
+                ::close(fd);
+                throw std::runtime_error("could not listen on " + address);
+            }
+            auto conn = ::accept(fd, nullptr, nullptr);
+            ::close(fd);
+            ::unlink(path.c_str());
+            if(conn < 0)
+                throw std::runtime_error("could not accept on " + address);
+            return conn;
+        }
+        if(::connect(fd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) < 0) {
+            ::close(fd);
+            throw std::runtime_error("could not connect to " + address);
+        }
+        return fd;
+    }
+    auto pos = address.rfind(':');
+    if(pos == std::string::npos)
+        throw std::runtime_error("illegal address " + address + ", expected host:port or unix:path");
+    auto host = address.substr(0, pos);
+    auto port = address.substr(pos + 1);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listen ? AI_PASSIVE : 0;
+    addrinfo* res = nullptr;
+    if(::getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &res) != 0)
+        throw std::runtime_error("could not resolve " + address);
+    for(auto* ai = res; ai && fd < 0; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if(fd < 0)
+            continue;
+        if(listen) {
+            int one = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if(::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, 1) == 0) {
+                auto conn = ::accept(fd, nullptr, nullptr);
+                ::close(fd);
+                fd = conn;
+            } else {
+                ::close(fd);
+                fd = -1;
+            }
+        } else if(::connect(fd, ai->ai_addr, ai->ai_addrlen) < 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    ::freeaddrinfo(res);
+    if(fd < 0)
+        throw std::runtime_error("could not " + std::string(listen ? "listen on " : "connect to ") + address);
+    // the messages are small and latency bound
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+#endif
+} // namespace
+
+partition_link::partition_link(sc_core::sc_module_name const& nm, std::string const& address, bool listen,
+                               sc_core::sc_time const& lookahead)
+: sc_core::sc_module(nm)
+, address(address)
+, listen(listen)
+, lookahead(lookahead) {
+    sc_assert(lookahead > sc_core::SC_ZERO_TIME);
+    SC_HAS_PROCESS(partition_link);
+    SC_THREAD(run);
+}
+
+partition_link::~partition_link() { close(); }
+
+uint32_t partition_link::channel_id(std::string const& name) {
+    // FNV-1a, it needs to give the same result in both processes
+    uint32_t hash = 2166136261U;
+    for(auto c : name)
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619U;
+    return hash;
+}
+
+uint32_t partition_link::add_channel(std::string const& name, handler_fct handler) {
+    auto id = channel_id(name);
+    if(handlers.count(id))
+        SCCERR(SCMOD) << "channel " << name << " registered twice or its id collides with another channel";
+    handlers[id] = std::move(handler);
+    return id;
+}
+
+void partition_link::start_of_simulation() {
+#ifndef _MSC_VER
+    SCCINFO(SCMOD) << (listen ? "waiting for the peer on " : "connecting to ") << address;
+    fd = open_socket(address, listen);
+#else
+    SCCERR(SCMOD) << "partition links are not supported on this platform";
+#endif
+}
+
+void partition_link::end_of_simulation() {
+    if(fd >= 0 && !peer_ended) {
+        message msg;
+        msg.type = END;
+        msg.time = sc_core::sc_time_stamp();
+        send(msg);
+    }
+    close();
+}
+
+void partition_link::run() {
+    if(fd < 0)
+        return;
+    while(!peer_ended) {
+        wait(lookahead);
+        auto now = sc_core::sc_time_stamp();
+        message msg;
+        msg.type = TIME;
+        msg.time = now;
+        send(msg);
+        while(peer_time < now && !peer_ended)
+            receive();
+    }
+    SCCINFO(SCMOD) << "the peer finished its simulation";
+    sc_core::sc_stop();
+}
+
+void partition_link::send(message const& msg) {
+    if(fd < 0)
+        return;
+    wire_header hdr{};
+    hdr.type = msg.type;
+    hdr.channel = msg.channel;
+    hdr.tag = msg.tag;
+    hdr.time = msg.time.value();
+    hdr.length = static_cast<uint32_t>(msg.data.size());
+    write_all(&hdr, sizeof(hdr));
+    if(msg.data.size())
+        write_all(msg.data.data(), msg.data.size());
+}
+
+partition_link::message partition_link::wait_response(uint64_t tag) {
+    auto it = responses.find(tag);
+    while(it == responses.end()) {
+        if(peer_ended || fd < 0) {
+            SCCERR(SCMOD) << "the peer finished before responding";
+            return message{};
+        }
+        receive();
+        it = responses.find(tag);
+    }
+    auto res = std::move(it->second);
+    responses.erase(it);
+    return res;
+}
+
+void partition_link::receive() {
+    wire_header hdr;
+    message msg;
+    if(!read_all(&hdr, sizeof(hdr))) {
+        peer_ended = true;
+        return;
+    }
+    msg.type = static_cast<msg_type>(hdr.type);
+    msg.channel = hdr.channel;
+    msg.tag = hdr.tag;
+    msg.time = sc_core::sc_time::from_value(hdr.time);
+    msg.data.resize(hdr.length);
+    if(hdr.length && !read_all(msg.data.data(), hdr.length)) {
+        peer_ended = true;
+        return;
+    }
+    switch(msg.type) {
+    case RESPONSE:
+        responses[msg.tag] = std::move(msg);
+        break;
+    case TIME:
+        if(msg.time > peer_time)
+            peer_time = msg.time;
+        break;
+    case END:
+        peer_ended = true;
+        break;
+    default: {
+        auto it = handlers.find(msg.channel);
+        if(it != handlers.end())
+            it->second(msg);
+        else
+            SCCERR(SCMOD) << "received a message for the unknown channel id " << msg.channel;
+    }
+    }
+}
+
+void partition_link::write_all(void const* data, size_t size) {
+#ifndef _MSC_VER
+    auto* p = static_cast<char const*>(data);
+    while(size) {
+        auto n = ::send(fd, p, size, MSG_NOSIGNAL);
+        if(n <= 0) {
+            SCCERR(SCMOD) << "the connection to the peer broke";
+            close();
+            peer_ended = true;
+            return;
+        }
+        p += n;
+        size -= n;
+    }
+#endif
+}
+
+bool partition_link::read_all(void* data, size_t size) {
+#ifndef _MSC_VER
+    auto* p = static_cast<char*>(data);
+    while(size) {
+        auto n = ::recv(fd, p, size, 0);
+        if(n <= 0) {
+            if(!sc_core::sc_end_of_simulation_invoked())
+                SCCWARN(SCMOD) << "the connection to the peer closed";
+            close();
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void partition_link::close() {
+#ifndef _MSC_VER
+    if(fd >= 0)
+        ::close(fd);
+#endif
+    fd = -1;
+}
+} // namespace scc
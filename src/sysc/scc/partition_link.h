@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_PARTITION_LINK_H_
+#define _SCC_PARTITION_LINK_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <systemc>
+#include <unordered_map>
+#include <vector>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @class partition_link
+ * @brief connects the simulation to a simulation running in another process and synchronizes their time
+ *
+ * One side listens, the other one connects during start_of_simulation. The address is either host:port for a TCP
+ * connection or unix:path for a Unix domain socket between processes on the same host. Both simulations need to use
+ * the same time resolution.
+ *
+ * The time is synchronized conservatively: every lookahead each side sends its simulation time and waits until the peer
+ * reached the same time, so neither side runs more than a lookahead ahead of the other one. Between the
+ * synchronization points both simulations run in parallel. The bridges of partition_bridge.h exchange their messages
+ * over named channels of a link. Messages arriving while the kernel waits for the peer, either at a synchronization
+ * point or for the response of a forwarded transaction, are handled right away by the handler of their channel.
+ *
+ * If either side ends its simulation the peer is notified and stops as well.
+ */
+class partition_link : public sc_core::sc_module {
+public:
+    enum msg_type : uint8_t { REQUEST = 1, RESPONSE, SIGNAL, TIME, END };
+
+    struct message {
+        msg_type type{REQUEST};
+        uint32_t channel{0};
+        //! identifies the response belonging to a request
+        uint64_t tag{0};
+        //! the absolute simulation time of the message
+        sc_core::sc_time time;
+        std::vector<uint8_t> data;
+    };
+
+    using handler_fct = std::function<void(message&)>;
+    /**
+     * @param nm the instance name
+     * @param address host:port or unix:path
+     * @param listen if true this side waits for the peer to connect
+     * @param lookahead the interval of the time synchronization
+     */
+    partition_link(sc_core::sc_module_name const& nm, std::string const& address, bool listen,
+                   sc_core::sc_time const& lookahead);
+
+    ~partition_link();
+    /**
+     * register the handler of the requests and signals of a channel, to be called during elaboration
+     *
+     * @param name the name of the channel, both sides need to use the same name
+     * @param handler the function handling the messages, it is called in the context of a SystemC thread
+     * @return the id of the channel
+     */
+    uint32_t add_channel(std::string const& name, handler_fct handler);
+    //! send a message to the peer
+    void send(message const& msg);
+    //! get a new tag to match the response of a request
+    uint64_t next_tag() { return ++tag_count; }
+    /**
+     * wait for the response of a request, the kernel is blocked until it arrives
+     *
+     * @param tag the tag of the request
+     * @return the response
+     */
+    message wait_response(uint64_t tag);
+    //! the interval of the time synchronization
+    sc_core::sc_time const& get_lookahead() const { return lookahead; }
+    //! the id of a channel name
+    static uint32_t channel_id(std::string const& name);
+
+protected:
+    void start_of_simulation() override;
+
+    void end_of_simulation() override;
+
+private:
+    void run();
+
+    void receive();
+
+    void write_all(void const* data, size_t size);
+
+    bool read_all(void* data, size_t size);
+
+    void close();
+
+    std::string address;
+    bool listen;
+    sc_core::sc_time lookahead;
+    int fd{-1};
+    uint64_t tag_count{0};
+    sc_core::sc_time peer_time;
+    bool peer_ended{false};
+    std::unordered_map<uint32_t, handler_fct> handlers;
+    std::unordered_map<uint64_t, message> responses;
+};
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_PARTITION_LINK_H_ */
@@ -17,8 +17,12 @@
 #ifndef _SCC_PEQ_H_
 #define _SCC_PEQ_H_
 
+#include <algorithm>
+#include <array>
 #include <boost/optional.hpp>
+#include <cassert>
 #include <deque>
+#include <iterator>
 #include <map>
 #include <systemc>
 #include <type_traits>
@@ -30,20 +34,238 @@
 /**@{*/
 //! @brief SCC SystemC utilities
 namespace scc {
+/**
+ * @struct peq_map_queue
+ * @brief the default backend of \ref peq keeping the entries in a map with one FIFO per time point
+ *
+ * @tparam TYPE the type of the entries
+ */
+template <class TYPE> struct peq_map_queue {
+    using map_type = std::map<const sc_core::sc_time, std::deque<TYPE>*>;
+
+    peq_map_queue() = default;
+
+    peq_map_queue(const peq_map_queue&) = delete;
+
+    peq_map_queue& operator=(const peq_map_queue&) = delete;
+
+    ~peq_map_queue() {
+        clear();
+        for(auto* p : free_pool)
+            delete p;
+    }
+
+    bool empty() const { return m_scheduled_events.empty(); }
+
+    template <typename U> void insert(U&& entry, sc_core::sc_time abs_time, sc_core::sc_time) {
+        auto it = m_scheduled_events.find(abs_time);
+        if(it == m_scheduled_events.end()) {
+            if(free_pool.size()) {
+                auto r = m_scheduled_events.insert(std::make_pair(abs_time, free_pool.front()));
+                free_pool.pop_front();
+                r.first->second->push_back(std::forward<U>(entry));
+            } else {
+                auto r = m_scheduled_events.insert(std::make_pair(abs_time, new std::deque<TYPE>()));
+                r.first->second->push_back(std::forward<U>(entry));
+            }
+        } else
+            it->second->push_back(std::forward<U>(entry));
+    }
+
+    sc_core::sc_time head_time() const { return m_scheduled_events.begin()->first; }
+
+    TYPE pop() {
+        auto entry = m_scheduled_events.begin()->second;
+        auto ret = std::move(entry->front());
+        entry->pop_front();
+        if(!entry->size()) {
+            free_pool.push_back(entry);
+            m_scheduled_events.erase(m_scheduled_events.begin());
+        }
+        return ret;
+    }
+
+    void clear() {
+        for(auto& e : m_scheduled_events) {
+            e.second->clear();
+            free_pool.push_back(e.second);
+        }
+        m_scheduled_events.clear();
+    }
+
+private:
+    map_type m_scheduled_events;
+    std::deque<std::deque<TYPE>*> free_pool;
+};
+/**
+ * @struct peq_wheel_queue
+ * @brief a backend of \ref peq using a timing wheel for the near future and a heap for far events
+ *
+ * The wheel consists of SLOTS slots covering one time granule each (1ns by default), the slot at the cursor holds the
+ * earliest entries. Entries beyond the horizon of the wheel are kept in a binary heap and are moved into the wheel once
+ * the cursor advances far enough. Insertion into the wheel and removal are O(1) (besides a scan of an occupancy
+ * bitmap), entries of the same time point are kept in FIFO order.
+ *
+ * @tparam TYPE the type of the entries
+ * @tparam SLOTS the number of slots of the wheel, needs to be a power of 2
+ */
+template <class TYPE, unsigned SLOTS = 1024> struct peq_wheel_queue {
+    static_assert(SLOTS >= 64 && (SLOTS & (SLOTS - 1)) == 0, "SLOTS needs to be a power of 2 of at least 64");
+    /**
+     * @fn  peq_wheel_queue(sc_core::sc_time)
+     * @brief constructor
+     *
+     * @param granule the time span covered by a slot, defaults to 1ns (or the time resolution if it is larger)
+     */
+    explicit peq_wheel_queue(sc_core::sc_time granule = sc_core::SC_ZERO_TIME)
+    : granule_time(granule) {}
+
+    bool empty() const { return !wheel_count && far.empty(); }
+
+    template <typename U> void insert(U&& entry, sc_core::sc_time abs_time, sc_core::sc_time now) {
+        if(!granule)
+            granule = std::max<uint64_t>(granule_time.value() ? granule_time.value()
+                                                              : sc_core::sc_time(1, sc_core::SC_NS).value(),
+                                         1);
+        advance(now.value());
+        auto t = abs_time.value();
+        if(t >= base + SLOTS * granule) {
+            far.push_back(far_entry{t, seq++, std::forward<U>(entry)});
+            std::push_heap(far.begin(), far.end(), later);
+        } else
+            insert_wheel(t, std::forward<U>(entry));
+    }
+
+    sc_core::sc_time head_time() const {
+        return sc_core::sc_time::from_value(wheel_count ? slots[head_slot()].front().first : far.front().time);
+    }
+
+    TYPE pop() {
+        if(!wheel_count)
+            migrate(far.front().time);
+        auto idx = head_slot();
+        auto& slot = slots[idx];
+        auto ret = std::move(slot.front().second);
+        slot.pop_front();
+        --wheel_count;
+        if(slot.empty())
+            occupancy[idx / 64] &= ~(1ULL << (idx % 64));
+        return ret;
+    }
+
+    void clear() {
+        for(auto& s : slots)
+            s.clear();
+        for(auto& o : occupancy)
+            o = 0;
+        far.clear();
+        wheel_count = 0;
+    }
+
+private:
+    struct far_entry {
+        uint64_t time;
+        uint64_t seq;
+        TYPE entry;
+    };
+    //! heap order, the earliest (and first inserted) entry is on top
+    static bool later(far_entry const& a, far_entry const& b) {
+        return a.time == b.time ? a.seq > b.seq : a.time > b.time;
+    }
+
+    template <typename U> void insert_wheel(uint64_t t, U&& entry) {
+        auto idx = t < base ? cursor : (cursor + (t - base) / granule) % SLOTS;
+        auto& slot = slots[idx];
+        // the slot is kept sorted by time, usually the entry is appended
+        auto it = slot.end();
+        while(it != slot.begin() && std::prev(it)->first > t)
+            --it;
+        slot.emplace(it, t, std::forward<U>(entry));
+        occupancy[idx / 64] |= 1ULL << (idx % 64);
+        ++wheel_count;
+    }
+    //! the index of the first occupied slot starting at the cursor, the wheel must not be empty
+    size_t head_slot() const {
+        auto word = cursor / 64;
+        auto bits = occupancy[word] & (~0ULL << (cursor % 64));
+        for(size_t i = 0; i <= SLOTS / 64; ++i) {
+            if(bits)
+                return (word * 64 + ctz(bits)) % SLOTS;
+            word = (word + 1) % (SLOTS / 64);
+            bits = occupancy[word];
+        }
+        assert(false);
+        return cursor;
+    }
+    //! move the cursor towards now but not beyond the earliest entry
+    void advance(uint64_t now) {
+        auto target = now - now % granule;
+        if(wheel_count) {
+            auto idx = head_slot();
+            auto head_base = base + ((idx + SLOTS - cursor) % SLOTS) * granule;
+            target = std::min(target, head_base);
+        }
+        if(target <= base)
+            return;
+        auto steps = (target - base) / granule;
+        cursor = (cursor + steps) % SLOTS;
+        base += steps * granule;
+        migrate_far();
+    }
+    //! restart the empty wheel at the given time
+    void migrate(uint64_t t) {
+        base = t - t % granule;
+        cursor = 0;
+        migrate_far();
+    }
+    //! move the far entries being within the horizon into the wheel
+    void migrate_far() {
+        while(!far.empty() && far.front().time < base + SLOTS * granule) {
+            std::pop_heap(far.begin(), far.end(), later);
+            insert_wheel(far.back().time, std::move(far.back().entry));
+            far.pop_back();
+        }
+    }
+
+    static unsigned ctz(uint64_t v) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(v);
+#else
+        unsigned n = 0;
+        while(!(v & 1)) {
+            v >>= 1;
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    sc_core::sc_time granule_time;
+    uint64_t granule{0};
+    uint64_t base{0};
+    size_t cursor{0};
+    size_t wheel_count{0};
+    uint64_t seq{0};
+    std::array<std::deque<std::pair<uint64_t, TYPE>>, SLOTS> slots;
+    std::array<uint64_t, SLOTS / 64> occupancy{};
+    std::vector<far_entry> far;
+};
 /**
  * @struct peq
  * @brief priority event queue
  *
- * A simple priority event queue with a copy of the original value
+ * A simple priority event queue holding a copy (or the moved original) of the value. The event is only (re-)notified if the head of
+ * the queue changes. The entries are kept in a QUEUE backend, by default in a map (\ref peq_map_queue). With many
+ * outstanding entries the timing wheel (\ref peq_wheel_queue) is faster, see \ref wheel_peq
  *
  * @tparam TYPE the type name of the object to keep in th equeue
+ * @tparam QUEUE the backend keeping the entries
  */
-template <class TYPE> struct peq : public sc_core::sc_object {
+template <class TYPE, class QUEUE = peq_map_queue<TYPE>> struct peq : public sc_core::sc_object {
 
-    static_assert(std::is_copy_constructible<TYPE>::value, "TYPE needs to be copy-constructible");
+    static_assert(std::is_move_constructible<TYPE>::value, "TYPE needs to be move-constructible");
 
     using pair_type = std::pair<const sc_core::sc_time, TYPE>;
-    using map_type = std::map<const sc_core::sc_time, std::deque<TYPE>*>;
     /**
      * @fn  peq()
      * @brief default constructor creating a unnamed peq
@@ -64,7 +286,7 @@ template <class TYPE> struct peq : public sc_core::sc_object {
      * @brief destructor
      *
      */
-    ~peq();
+    ~peq() = default;
     /**
      * @fn void notify(const TYPE&, const sc_core::sc_time&)
      * @brief non-blocking push.
@@ -74,9 +296,24 @@ template <class TYPE> struct peq : public sc_core::sc_object {
      * @param entry the value to insert
      * @param t the delay for calling get
      */
-    void notify(const TYPE& entry, const sc_core::sc_time& t) {
-        insert_entry(entry, t + sc_core::sc_time_stamp());
-		m_event.notify(m_scheduled_events.begin()->first - sc_core::sc_time_stamp());
+    void notify(const TYPE& entry, const sc_core::sc_time& t) { push(entry, t); }
+    /**
+     * @fn void notify(TYPE&&, const sc_core::sc_time&)
+     * @brief non-blocking push moving the entry into the queue
+     *
+     * @param entry the value to insert
+     * @param t the delay for calling get
+     */
+    void notify(TYPE&& entry, const sc_core::sc_time& t) { push(std::move(entry), t); }
+    /**
+     * @fn void emplace(const sc_core::sc_time&, ARGS&&...)
+     * @brief non-blocking push constructing the entry from the given arguments
+     *
+     * @param t the delay for calling get
+     * @param args the constructor arguments of the entry
+     */
+    template <typename... ARGS> void emplace(const sc_core::sc_time& t, ARGS&&... args) {
+        push(TYPE(std::forward<ARGS>(args)...), t);
     }
     /**
      * @fn void notify(const TYPE&)
@@ -86,32 +323,30 @@ template <class TYPE> struct peq : public sc_core::sc_object {
      *
      * @param entry the value to insert
      */
-    void notify(const TYPE& entry) {
-        insert_entry(entry, sc_core::sc_time_stamp());
-        m_event.notify(); // immediate notification
-    }
+    void notify(const TYPE& entry) { push_now(entry); }
+    /**
+     * @fn void notify(TYPE&&)
+     * @brief non-blocking push moving the entry into the queue with immediate notification
+     *
+     * @param entry the value to insert
+     */
+    void notify(TYPE&& entry) { push_now(std::move(entry)); }
     /**
      * @fn boost::optional<TYPE> get_next()
      * @brief non-blocking get
      *
-     * @return optional copy of the head element
+     * @return optional head element, it is moved out of the queue
      */
     boost::optional<TYPE> get_next() {
-        if(m_scheduled_events.empty())
-            return boost::none;
-        sc_core::sc_time now = sc_core::sc_time_stamp();
-        if(!m_scheduled_events.size() || m_scheduled_events.begin()->first > now) {
-            if(m_scheduled_events.size())
-                m_event.notify(m_scheduled_events.begin()->first - now);
+        if(!has_next())
             return boost::none;
-        } else
-            return get_entry();
+        return get_entry();
     }
     /**
      * @fn TYPE get()
      * @brief blocking get
      *
-     * @return copy of the next entry.
+     * @return the next entry, it is moved out of the queue
      */
     TYPE get() {
         while(!has_next()) {
@@ -119,6 +354,38 @@ template <class TYPE> struct peq : public sc_core::sc_object {
         }
         return get_entry();
     }
+    /**
+     * @fn size_t drain(FUNC)
+     * @brief non-blocking get of all entries being due at the current time
+     *
+     * The callback is called with each entry (moved out of the queue) in order, entries being inserted for the
+     * current time by the callback are handed over as well. The event is notified only once for the next time point.
+     *
+     * @param f the callback taking the entry as rvalue
+     * @return the number of entries handed to the callback
+     */
+    template <typename FUNC> size_t drain(FUNC f) {
+        auto now = sc_core::sc_time_stamp();
+        size_t cnt = 0;
+        while(!m_queue.empty() && m_queue.head_time() <= now) {
+            f(m_queue.pop());
+            ++cnt;
+        }
+        if(!m_queue.empty() && m_queue.head_time() != m_notified)
+            notify_head(now);
+        return cnt;
+    }
+    /**
+     * @fn std::vector<TYPE> get_all()
+     * @brief non-blocking get of all entries being due at the current time, see \ref drain()
+     *
+     * @return the entries in queue order
+     */
+    std::vector<TYPE> get_all() {
+        std::vector<TYPE> res;
+        drain([&res](TYPE&& e) { res.push_back(std::move(e)); });
+        return res;
+    }
     /**
      * @fn sc_core::sc_event& event()
      * @brief get the available event
@@ -132,8 +399,9 @@ template <class TYPE> struct peq : public sc_core::sc_object {
      *
      */
     void cancel_all() {
-        m_scheduled_events.clear();
+        m_queue.clear();
         m_event.cancel();
+        m_notified = sc_core::SC_ZERO_TIME;
     }
     /**
      * @fn bool has_next()
@@ -142,65 +410,71 @@ template <class TYPE> struct peq : public sc_core::sc_object {
      * @return true if data is available for \ref get()
      */
     bool has_next() {
-        if(m_scheduled_events.empty())
+        if(m_queue.empty())
             return false;
-        sc_core::sc_time now = sc_core::sc_time_stamp();
-        if(!m_scheduled_events.size() || m_scheduled_events.begin()->first > now) {
-            if(m_scheduled_events.size())
-                m_event.notify(m_scheduled_events.begin()->first - now);
+        auto now = sc_core::sc_time_stamp();
+        auto head = m_queue.head_time();
+        if(head > now) {
+            if(head != m_notified)
+                notify_head(now);
             return false;
-        } else {
-            return true;
         }
+        return true;
     }
+    /**
+     * @fn bool empty()
+     * @brief check if there are entries in the queue regardless of their time
+     *
+     * @return true if no value is queued
+     */
+    bool empty() const { return m_queue.empty(); }
 
     void clear() {
-    	while(!m_scheduled_events.empty()){
-    		get_entry();
-    	}
+        while(!m_queue.empty()) {
+            get_entry();
+        }
     }
+
 private:
-    map_type m_scheduled_events;
-    std::deque<std::deque<TYPE>*> free_pool;
+    QUEUE m_queue;
     sc_core::sc_event m_event;
+    //! the time point the event has been notified for last
+    sc_core::sc_time m_notified;
 
-    void insert_entry(const TYPE& entry, sc_core::sc_time abs_time) {
-        auto it = m_scheduled_events.find(abs_time);
-        if(it == m_scheduled_events.end()) {
-            if(free_pool.size()) {
-                auto r = m_scheduled_events.insert(std::make_pair(abs_time, free_pool.front()));
-                free_pool.pop_front();
-                r.first->second->push_back(entry);
-            } else {
-                auto r = m_scheduled_events.insert(std::make_pair(abs_time, new std::deque<TYPE>()));
-                r.first->second->push_back(entry);
-            }
-        } else
-            it->second->push_back(entry);
+    template <typename U> void push(U&& entry, const sc_core::sc_time& t) {
+        auto now = sc_core::sc_time_stamp();
+        auto abs_time = t + now;
+        auto new_head = m_queue.empty() || abs_time < m_queue.head_time();
+        m_queue.insert(std::forward<U>(entry), abs_time, now);
+        if(new_head)
+            notify_head(now);
+    }
+
+    template <typename U> void push_now(U&& entry) {
+        auto now = sc_core::sc_time_stamp();
+        m_queue.insert(std::forward<U>(entry), now, now);
+        m_event.notify(); // immediate notification
+        m_notified = now;
+    }
+
+    void notify_head(sc_core::sc_time const& now) {
+        m_notified = m_queue.head_time();
+        m_event.notify(m_notified > now ? m_notified - now : sc_core::SC_ZERO_TIME);
     }
 
     TYPE get_entry() {
-        auto entry = m_scheduled_events.begin()->second;
-        auto ret = entry->front();
-        entry->pop_front();
-        if(!entry->size()) {
-            free_pool.push_back(entry);
-            m_scheduled_events.erase(m_scheduled_events.begin());
-        }
-        if(m_scheduled_events.size())
-            m_event.notify( m_scheduled_events.begin()->first-sc_core::sc_time_stamp());
+        auto now = sc_core::sc_time_stamp();
+        auto ret = m_queue.pop();
+        // remaining entries being due need a delta notification, later ones only if the head changed
+        if(!m_queue.empty() && (m_queue.head_time() <= now || m_queue.head_time() != m_notified))
+            notify_head(now);
         return ret;
     }
 };
-
-template <class TYPE> inline peq<TYPE>::~peq() {
-    while(m_scheduled_events.size()) {
-        free_pool.push_back(m_scheduled_events.begin()->second);
-        m_scheduled_events.erase(m_scheduled_events.begin());
-    }
-    for(auto* p : free_pool)
-        delete p;
-}
+/**
+ * @brief a \ref peq using a timing wheel as backend
+ */
+template <class TYPE> using wheel_peq = peq<TYPE, peq_wheel_queue<TYPE>>;
 
 } // namespace scc
 /** @} */ // end of scc-sysc
@@ -15,7 +15,14 @@
  *******************************************************************************/
 
 #include "perf_estimator.h"
+#include "counters.h"
+#include "elab_profiler.h"
+#include "process_profiler.h"
 #include "report.h"
+#include "run_report.h"
+#include "span_tracer.h"
+#include <fstream>
+#include <sstream>
 
 #if defined(_WIN32)
 #include <Windows.h>
@@ -28,6 +35,7 @@
 #error "Cannot compile file because of an unknown method to retrieve OS time."
 #endif
 #include <malloc.h>
+#include <util/pool_allocator.h>
 
 namespace scc {
 using namespace sc_core;
@@ -38,12 +46,16 @@ perf_estimator::perf_estimator(const sc_module_name& nm, sc_time beat_delay_)
 : sc_module(nm)
 , beat_delay(beat_delay_) {
     soc.set();
+    elab_profiler::get().enter("construction");
     if(beat_delay.value()) {
         SC_METHOD(beat);
     }
+    SC_METHOD(report_elab_profile);
 }
 
 perf_estimator::~perf_estimator() {
+    if(heartbeat_os)
+        heartbeat_os->close();
     time_stamp eod;
     eod.set();
     SCCINFO("perf_estimator") << "constr & elab time:  " << (eoe.proc_clock_stamp - soc.proc_clock_stamp) << "s";
@@ -55,13 +67,98 @@ perf_estimator::~perf_estimator() {
                        << " cycles/s";
     }
     SCCINFO("perf_estimator") << "max resident memory: " << max_memory << "kB";
+    write_run_report();
+    write_span_trace();
 }
 
-void perf_estimator::end_of_elaboration() { eoe.set(); }
+void perf_estimator::write_run_report() {
+    auto const& file_name = run_report.get_value();
+    if(file_name.empty())
+        return;
+    get_memory();
+    scc::run_report rep;
+    rep.sim_time_s = sc_time_stamp().to_seconds();
+    rep.elab_cpu_time_s = eoe.proc_clock_stamp - soc.proc_clock_stamp;
+    // end_of_simulation is not called if the simulation was not stopped
+    time_stamp end;
+    if(eos.wall_clock_stamp >= sos.wall_clock_stamp)
+        end = eos;
+    rep.wall_time_s = (end.wall_clock_stamp - sos.wall_clock_stamp).total_microseconds() / 1000000.;
+    rep.cpu_time_s = end.proc_clock_stamp - sos.proc_clock_stamp;
+    rep.deltas = sc_delta_count();
+    rep.cycles = cycle_period.value() ? sc_time_stamp().value() / cycle_period.value() : 0;
+    rep.peak_rss_kB = max_memory;
+    if(!rep.write(file_name))
+        SCCERR("perf_estimator") << "could not open run report " << file_name;
+}
+
+void perf_estimator::before_end_of_elaboration() {
+    elab_profiler::get().leave();
+    elab_profiler::get().enter("before_end_of_elaboration");
+}
+
+void perf_estimator::end_of_elaboration() {
+    eoe.set();
+    elab_profiler::get().leave();
+    elab_profiler::get().enter("end_of_elaboration");
+}
 
 void perf_estimator::start_of_simulation() {
     sos.set();
     get_memory();
+    last_beat.stamp = sos;
+    if(process_profile_top.get_value() || !process_profile.get_value().empty())
+        process_profiler::get().enable();
+    if(!span_trace.get_value().empty()) {
+#ifndef SCC_WITH_SPANS
+        SCCWARN("perf_estimator") << "the spans are not compiled in, " << span_trace.get_value() << " stays empty";
+#endif
+        span_tracer::get().set_thread_name("SystemC");
+        span_tracer::get().enable();
+    }
+    auto const& file_name = heartbeat_file.get_value();
+    if(beat_delay.value() && !file_name.empty()) {
+        heartbeat_os.reset(new std::ofstream(file_name));
+        if(!heartbeat_os->is_open()) {
+            SCCERR("perf_estimator") << "could not open heart beat file " << file_name;
+            heartbeat_os.reset();
+        } else {
+            heartbeat_json = file_name.size() > 5 && file_name.compare(file_name.size() - 5, 5, ".json") == 0;
+            if(!heartbeat_json)
+                *heartbeat_os << "sim_time_s,wall_time_s,cpu_time_s,sim_per_wall,deltas_per_s,allocations_per_s,rss_kB,"
+                                 "subsystem_events\n";
+        }
+    }
+    elab_profiler::get().leave();
+    elab_profiler::get().enter("start_of_simulation");
+}
+
+void perf_estimator::write_span_trace() {
+    auto const& file_name = span_trace.get_value();
+    if(file_name.empty())
+        return;
+    span_tracer::get().disable();
+    std::ofstream os(file_name);
+    if(os.is_open())
+        span_tracer::get().write_chrome_json(os);
+    else
+        SCCERR("perf_estimator") << "could not open span trace " << file_name;
+}
+
+void perf_estimator::report_elab_profile() {
+    elab_profiler::get().leave();
+    auto const& file_name = elab_profile.get_value();
+    if(file_name.empty())
+        return;
+    for(auto& s : elab_profiler::get().get_sections())
+        SCCINFO("perf_estimator") << "elaboration section " << s.name << ": "
+                                  << std::chrono::duration_cast<std::chrono::microseconds>(s.total).count() / 1000.
+                                  << "ms in " << s.count << " calls";
+    std::ofstream os(file_name);
+    if(os.is_open())
+        elab_profiler::get().write_folded(os);
+    else
+        SCCERR("perf_estimator") << "could not open elaboration profile " << file_name;
 }
 
 void perf_estimator::end_of_simulation() {
@@ -77,14 +174,125 @@ void perf_estimator::end_of_simulation() {
                        << proc_perf << ")";
     }
     get_memory();
+    report_pool_statistics();
+    report_counter_statistics();
+    report_process_profile();
+}
+
+void perf_estimator::report_status() {
+    time_stamp now;
+    auto wall = (now.wall_clock_stamp - sos.wall_clock_stamp).total_microseconds() / 1000000.;
+    auto sim = sc_time_stamp().to_seconds();
+    SCCINFO("perf_estimator") << "status at " << sc_time_stamp() << ": " << wall << "s wall clock, "
+                              << (now.proc_clock_stamp - sos.proc_clock_stamp) << "s process clock, "
+                              << (wall > 0 ? sim / wall : 0.) << " (sim s/wall s), " << sc_delta_count()
+                              << " deltas, rss mem: " << get_memory() << "kB";
+    report_pool_statistics();
+    report_counter_statistics();
+}
+
+void perf_estimator::report_process_profile() {
+    auto& profiler = process_profiler::get();
+    if(!profiler.is_enabled())
+        return;
+    auto stats = profiler.get_statistics();
+    auto top = std::min<size_t>(process_profile_top.get_value(), stats.size());
+    for(size_t i = 0; i < top; ++i)
+        SCCINFO("perf_estimator") << "process " << stats[i].name << ": "
+                                  << std::chrono::duration_cast<std::chrono::microseconds>(stats[i].total).count() / 1000.
+                                  << "ms in " << stats[i].count << " activations";
+    auto const& file_name = process_profile.get_value();
+    if(file_name.empty())
+        return;
+    std::ofstream os(file_name);
+    if(os.is_open())
+        profiler.write_folded(os);
+    else
+        SCCERR("perf_estimator") << "could not open process profile " << file_name;
 }
 
 void perf_estimator::beat() {
-    if(sc_time_stamp().value())
+    if(sc_time_stamp().value()) {
         SCCINFO("perf_estimator") << "Heart beat, rss mem: " << get_memory() << "kB";
+        report_beat_sample();
+        report_pool_statistics();
+        report_counter_statistics();
+    }
     next_trigger(beat_delay);
+    // give the memory of pool chunks not being used anymore back to the heap (keeping one spare chunk per pool)
+    util::pool_registry::get().trim(1);
     malloc_trim(0);
 }
+
+void perf_estimator::report_beat_sample() {
+    beat_sample now;
+    now.sim_time = sc_time_stamp();
+    now.deltas = sc_delta_count();
+    for(auto& s : util::pool_registry::get().get_statistics())
+        now.allocations += s.allocations;
+    for(auto& s : counter_registry::get().get_statistics())
+        if(s.count && !s.histogram)
+            now.subsystem_events[s.name.substr(0, s.name.find('.'))] += s.count;
+    auto wall = (now.stamp.wall_clock_stamp - last_beat.stamp.wall_clock_stamp).total_microseconds() / 1000000.;
+    auto sim = (now.sim_time - last_beat.sim_time).to_seconds();
+    auto per_s = [wall](uint64_t v) { return wall > 0 ? v / wall : 0.; };
+    auto sim_per_wall = wall > 0 ? sim / wall : 0.;
+    auto deltas_per_s = per_s(now.deltas - last_beat.deltas);
+    auto allocations_per_s = per_s(now.allocations - last_beat.allocations);
+    SCCINFO("perf_estimator") << "simulation speed " << sim_per_wall << " (sim s/wall s), " << deltas_per_s
+                              << " deltas/s, " << allocations_per_s << " allocations/s";
+    std::ostringstream events;
+    auto sep = "";
+    for(auto& e : now.subsystem_events) {
+        auto it = last_beat.subsystem_events.find(e.first);
+        auto cnt = e.second - (it != last_beat.subsystem_events.end() ? it->second : 0);
+        SCCINFO("perf_estimator") << "subsystem " << e.first << ": " << per_s(cnt) << " events/s";
+        if(heartbeat_json)
+            events << sep << "\"" << e.first << "\":" << cnt;
+        else
+            events << sep << e.first << "=" << cnt;
+        sep = heartbeat_json ? "," : ";";
+    }
+    if(heartbeat_os) {
+        auto total_wall = (now.stamp.wall_clock_stamp - sos.wall_clock_stamp).total_microseconds() / 1000000.;
+        auto total_cpu = now.stamp.proc_clock_stamp - sos.proc_clock_stamp;
+        if(heartbeat_json)
+            *heartbeat_os << "{\"sim_time_s\":" << now.sim_time.to_seconds() << ",\"wall_time_s\":" << total_wall
+                          << ",\"cpu_time_s\":" << total_cpu << ",\"sim_per_wall\":" << sim_per_wall
+                          << ",\"deltas_per_s\":" << deltas_per_s << ",\"allocations_per_s\":" << allocations_per_s
+                          << ",\"rss_kB\":" << max_memory << ",\"subsystem_events\":{" << events.str() << "}}\n";
+        else
+            *heartbeat_os << now.sim_time.to_seconds() << "," << total_wall << "," << total_cpu << "," << sim_per_wall
+                          << "," << deltas_per_s << "," << allocations_per_s << "," << max_memory << ","
+                          << events.str() << "\n";
+        heartbeat_os->flush();
+    }
+    last_beat = std::move(now);
+}
+
+void perf_estimator::report_pool_statistics() {
+    auto elapsed = (boost::posix_time::microsec_clock::universal_time() - sos.wall_clock_stamp).total_microseconds();
+    for(auto& s : util::pool_registry::get().get_statistics()) {
+        if(!s.chunks)
+            continue;
+        SCCINFO("perf_estimator") << "pool of " << s.elem_size << "B elements: " << s.chunks << " chunks, " << s.used
+                                  << "/" << s.capacity << " elements used, high water " << s.high_water << ", "
+                                  << (elapsed > 0 ? s.allocations * 1000000.0 / elapsed : 0.0) << " allocations/s";
+    }
+}
+
+void perf_estimator::report_counter_statistics() {
+    for(auto& s : counter_registry::get().get_statistics()) {
+        if(!s.count)
+            continue;
+        if(s.histogram)
+            SCCINFO("perf_estimator") << "histogram " << s.name << ": " << s.count << " values, min " << s.min
+                                      << ", mean " << s.mean() << ", p50 <=" << s.value_at_percentile(50) << ", p99 <="
+                                      << s.value_at_percentile(99) << ", max " << s.max;
+        else
+            SCCINFO("perf_estimator") << "counter " << s.name << ": " << s.count;
+    }
+}
 } /* namespace scc */
 
 auto scc::perf_estimator::time_stamp::get_cpu_time() -> double {
@@ -18,6 +18,10 @@
 #define _SCC_PERFORMANCETRACER_H_
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <cci_configuration>
+#include <iosfwd>
+#include <map>
+#include <memory>
 #include <systemc>
 #include <tuple>
 
@@ -34,6 +38,32 @@ namespace scc {
  * It records the time stamps a various time points (start and end of simulation) and calculates
  * some performance figures. Optionally it provides a heart beat which periodically calls a functor
  * If a cycle time is provides it calculates also the cycles per (wall clock) second
+ * With each heart beat and at the end of simulation the statistics of the pool allocators (size class, chunks,
+ * elements in use, high water mark and allocation rate) are logged. The heart beat also releases the fully free chunks
+ * of the pools of the simulation thread so that a phase with a high allocation rate does not inflate the memory
+ * footprint for the rest of the simulation.
+ *
+ * Each heart beat also logs the simulation speed of the last interval (simulated time per wall clock time), the delta
+ * cycles per second and the allocation rate of the pool allocators. The events counted with SCC_COUNT are attributed
+ * to subsystems by the part of their name before the first dot. If the CCI parameter
+ * scc_perf_estimator.heartbeat_file is set these samples are written to that file, as JSON lines if the name ends with
+ * .json or as CSV otherwise.
+ *
+ * If the CCI parameter scc_perf_estimator.process_profile_top or scc_perf_estimator.process_profile is set the
+ * activations recorded by the \ref process_profiler are reported at the end of simulation: the given number of processes
+ * with the highest host time are logged and the profile is written to the named file in folded stack format.
+ *
+ * If the CCI parameter scc_perf_estimator.elab_profile is set the sections recorded by the \ref elab_profiler are
+ * reported at the start of simulation and written to the file named by the parameter in folded stack format (e.g. for
+ * flamegraph.pl). The perf_estimator adds the elaboration phases as outermost sections, this requires it to be
+ * created before the design.
+ *
+ * If the CCI parameter scc_perf_estimator.run_report is set a \ref run_report is written to the named file when the
+ * perf_estimator is destroyed, i.e. after the trace files and recorders created later have been closed.
+ *
+ * If the CCI parameter scc_perf_estimator.span_trace is set the \ref span_tracer is enabled at the start of simulation
+ * and the recorded host time spans are written to the named file in Chrome trace event format (e.g. for Perfetto)
+ * when the perf_estimator is destroyed. The spans need to be compiled in using SCC_WITH_SPANS.
  *
  */
 class perf_estimator : public sc_core::sc_module {
@@ -87,10 +117,44 @@ public:
      * @param cycle_period
      */
     void set_cycle_time(sc_core::sc_time cycle_period) { this->cycle_period = cycle_period; };
+    /**
+     * @fn void report_status()
+     * @brief log the simulation speed since the start of simulation, the memory use and the pool and counter statistics
+     *
+     * To be called from the SystemC thread while the simulation runs, e.g. by a \ref sim_watchdog. It does not affect
+     * the intervals of the heart beat.
+     */
+    void report_status();
+    //! the file the elaboration profile is written to, if empty no profile is reported
+    cci::cci_param<std::string> elab_profile{"scc_perf_estimator.elab_profile", "",
+                                             "file the elaboration profile is written to in folded stack format",
+                                             cci::CCI_ABSOLUTE_NAME, cci::cci_originator("scc_perf_estimator")};
+
+    //! the file the heart beat samples are written to, if empty the samples are only logged
+    cci::cci_param<std::string> heartbeat_file{"scc_perf_estimator.heartbeat_file", "",
+                                               "file the heart beat samples are written to as CSV or JSON lines (*.json)",
+                                               cci::CCI_ABSOLUTE_NAME, cci::cci_originator("scc_perf_estimator")};
+    //! the file the process profile is written to in folded stack format, if empty no profile is written
+    cci::cci_param<std::string> process_profile{"scc_perf_estimator.process_profile", "",
+                                                "file the process profile is written to in folded stack format",
+                                                cci::CCI_ABSOLUTE_NAME, cci::cci_originator("scc_perf_estimator")};
+    //! the number of processes with the highest host time logged at the end of simulation
+    cci::cci_param<unsigned> process_profile_top{"scc_perf_estimator.process_profile_top", 0,
+                                                 "number of processes with the highest host time being reported",
+                                                 cci::CCI_ABSOLUTE_NAME, cci::cci_originator("scc_perf_estimator")};
+    //! the file the run report is written to as JSON, if empty no report is written
+    cci::cci_param<std::string> run_report{"scc_perf_estimator.run_report", "",
+                                           "file the machine readable report of the run is written to as JSON",
+                                           cci::CCI_ABSOLUTE_NAME, cci::cci_originator("scc_perf_estimator")};
+    //! the file the host time spans are written to in Chrome trace event format, if empty no spans are recorded
+    cci::cci_param<std::string> span_trace{"scc_perf_estimator.span_trace", "",
+                                           "file the host time spans are written to in Chrome trace event format",
+                                           cci::CCI_ABSOLUTE_NAME, cci::cci_originator("scc_perf_estimator")};
 
 protected:
     perf_estimator(const sc_core::sc_module_name& nm, sc_core::sc_time heart_beat);
     //! SystemC callbacks
+    void before_end_of_elaboration() override;
     void end_of_elaboration() override;
     void start_of_simulation() override;
     void end_of_simulation() override;
@@ -101,8 +165,32 @@ protected:
     time_stamp eos;
     sc_core::sc_time beat_delay, cycle_period;
     void beat();
+    //! log the statistics of all \ref util::pool_allocator instances
+    void report_pool_statistics();
+    //! log the counters and histograms of SCC_COUNT and SCC_HIST
+    void report_counter_statistics();
+    //! close the elaboration phases and report the elaboration profile once all start_of_simulation callbacks ran
+    void report_elab_profile();
+    //! log the processes with the highest host time and write the process profile
+    void report_process_profile();
+    //! log the speed figures of the interval since the last heart beat and write them to the heart beat file
+    void report_beat_sample();
+    //! write the run report if requested by scc_perf_estimator.run_report
+    void write_run_report();
+    //! write the spans of the span_tracer if requested by scc_perf_estimator.span_trace
+    void write_span_trace();
     long get_memory();
     long max_memory{0};
+    //! the figures at the last heart beat, the next heart beat reports the difference
+    struct beat_sample {
+        time_stamp stamp;
+        sc_core::sc_time sim_time;
+        uint64_t deltas{0};
+        uint64_t allocations{0};
+        std::map<std::string, uint64_t> subsystem_events;
+    } last_beat;
+    std::unique_ptr<std::ofstream> heartbeat_os;
+    bool heartbeat_json{false};
 };
 
 } /* namespace scc */
@@ -0,0 +1,137 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_PROCESS_PROFILER_H_
+#define _SCC_PROCESS_PROFILER_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <systemc>
+#include <unordered_map>
+#include <vector>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @brief accumulates the number of activations and the host time per SystemC process
+ *
+ * An activation is recorded by a SCC_PROFILE_ACTIVATION scope and attributed to the process running it. In a SC_METHOD
+ * the scope should span the whole body, in a SC_THREAD it should start after a wait and end before the next one as
+ * the time spent in wait() belongs to other processes. Recording is off by default, scc::perf_estimator switches it on
+ * if the parameters scc_perf_estimator.process_profile or scc_perf_estimator.process_profile_top are set and reports
+ * the results at the end of simulation. As all processes run in the simulation thread no locking is done.
+ */
+class process_profiler {
+public:
+    using clock = std::chrono::steady_clock;
+    //! the figures of a process
+    struct process_stats {
+        std::string name;
+        clock::duration total;
+        uint64_t count;
+    };
+    //! the profiler getter
+    static process_profiler& get() {
+        static process_profiler inst;
+        return inst;
+    }
+    //! switch the recording on or off
+    void enable(bool on = true) { enabled = on; }
+    //! true if activations are recorded
+    bool is_enabled() const { return enabled; }
+    /**
+     * add an activation of the current process
+     *
+     * @param elapsed the host time the activation took
+     */
+    void record(clock::duration elapsed) {
+        auto* proc = sc_core::sc_get_current_process_b();
+        auto& e = entries[proc];
+        if(e.name.empty())
+            e.name = proc ? proc->name() : "<no process>";
+        e.total += elapsed;
+        ++e.count;
+    }
+    //! get the figures of all processes sorted by their total time, the longest first
+    std::vector<process_stats> get_statistics() const {
+        std::vector<process_stats> res;
+        res.reserve(entries.size());
+        for(auto& e : entries)
+            res.push_back(process_stats{e.second.name, e.second.total, e.second.count});
+        std::sort(res.begin(), res.end(),
+                  [](process_stats const& a, process_stats const& b) { return a.total > b.total; });
+        return res;
+    }
+    /**
+     * write the times of the processes in the folded stack format understood by flamegraph.pl, speedscope and similar
+     * tools, the stack of a process is its hierarchical name
+     *
+     * @param os the stream to write to, each line holds the hierarchy levels separated by ';' and the time in
+     * microseconds
+     */
+    void write_folded(std::ostream& os) const {
+        for(auto& e : entries) {
+            auto stack = e.second.name;
+            std::replace(stack.begin(), stack.end(), '.', ';');
+            os << stack << " " << std::chrono::duration_cast<std::chrono::microseconds>(e.second.total).count() << "\n";
+        }
+    }
+    /**
+     * @brief an activation lasting as long as the scope
+     */
+    struct scope {
+        scope()
+        : active(get().is_enabled()) {
+            if(active)
+                start = clock::now();
+        }
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+        ~scope() {
+            if(active)
+                get().record(clock::now() - start);
+        }
+
+    private:
+        bool active;
+        clock::time_point start;
+    };
+
+private:
+    process_profiler() = default;
+    struct entry {
+        std::string name;
+        clock::duration total{clock::duration::zero()};
+        uint64_t count{0};
+    };
+    std::unordered_map<sc_core::sc_process_b const*, entry> entries;
+    bool enabled{false};
+};
+} // namespace scc
+/** @} */ // end of scc-sysc
+#define SCC_PROFILE_ACTIVATION_CONCAT_(a, b) a##b
+#define SCC_PROFILE_ACTIVATION_CONCAT(a, b) SCC_PROFILE_ACTIVATION_CONCAT_(a, b)
+//! record the enclosing scope as activation of the current process in the process profile
+#define SCC_PROFILE_ACTIVATION()                                                                                       \
+    ::scc::process_profiler::scope SCC_PROFILE_ACTIVATION_CONCAT(scc_activation_scope_, __LINE__)
+#endif /* _SCC_PROCESS_PROFILER_H_ */
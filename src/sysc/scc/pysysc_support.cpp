@@ -0,0 +1,114 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#include "pysysc_support.h"
+#include "report.h"
+#include <algorithm>
+#include <systemc>
+#include <tlm>
+#include <vector>
+
+namespace scc {
+namespace pysysc {
+namespace {
+tlm::tlm_fw_transport_if<>* get_fw_if(std::string const& socket) {
+    auto* obj = sc_core::sc_find_object(socket.c_str());
+    auto* exp = dynamic_cast<sc_core::sc_export_base*>(obj);
+    auto* fw_if = exp ? dynamic_cast<tlm::tlm_fw_transport_if<>*>(exp->get_interface()) : nullptr;
+    if(!fw_if)
+        SCCERR("scc::pysysc") << socket << " is not a bound TLM target socket";
+    return fw_if;
+}
+// the chunk size of debug accesses, targets may limit the length of a single debug access
+const size_t dbg_chunk = 64 * 1024;
+
+size_t transport_dbg(std::string const& socket, tlm::tlm_command cmd, uint64_t addr, uint8_t* buf, size_t len) {
+    auto* fw_if = get_fw_if(socket);
+    if(!fw_if)
+        return 0;
+    tlm::tlm_generic_payload gp;
+    size_t done = 0;
+    while(done < len) {
+        auto chunk = static_cast<unsigned>(std::min(len - done, dbg_chunk));
+        gp.set_command(cmd);
+        gp.set_address(addr + done);
+        gp.set_data_ptr(buf + done);
+        gp.set_data_length(chunk);
+        gp.set_streaming_width(chunk);
+        gp.set_byte_enable_ptr(nullptr);
+        gp.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        auto res = fw_if->transport_dbg(gp);
+        done += std::min<size_t>(res, chunk);
+        if(res < chunk)
+            break;
+    }
+    return done;
+}
+} // namespace
+
+size_t run_for(sc_core::sc_time const& t, size_t n_steps, size_t callback_every, std::function<bool(size_t)> cb) {
+    size_t step = 0;
+    while(step < n_steps) {
+        sc_core::sc_start(t);
+        ++step;
+        if(sc_core::sc_get_status() != sc_core::SC_PAUSED)
+            break;
+        if(cb && callback_every && step % callback_every == 0 && !cb(step))
+            break;
+    }
+    return step;
+}
+
+size_t run_for(sc_core::sc_time const& t, size_t n_steps) { return run_for(t, n_steps, 0, nullptr); }
+
+size_t read_memory(std::string const& socket, uint64_t addr, uint8_t* buf, size_t len) {
+    return transport_dbg(socket, tlm::TLM_READ_COMMAND, addr, buf, len);
+}
+
+size_t write_memory(std::string const& socket, uint64_t addr, uint8_t const* buf, size_t len) {
+    // the target does not change the data of a write access
+    return transport_dbg(socket, tlm::TLM_WRITE_COMMAND, addr, const_cast<uint8_t*>(buf), len);
+}
+
+memory_view get_memory_view(std::string const& socket, uint64_t addr, bool write) {
+    memory_view res;
+    auto* fw_if = get_fw_if(socket);
+    if(!fw_if)
+        return res;
+    tlm::tlm_generic_payload gp;
+    tlm::tlm_dmi dmi;
+    gp.set_command(write ? tlm::TLM_WRITE_COMMAND : tlm::TLM_READ_COMMAND);
+    gp.set_address(addr);
+    if(!fw_if->get_direct_mem_ptr(gp, dmi) || addr < dmi.get_start_address() || addr > dmi.get_end_address() ||
+       (write ? !dmi.is_write_allowed() : !dmi.is_read_allowed()))
+        return res;
+    res.data = dmi.get_dmi_ptr() + (addr - dmi.get_start_address());
+    res.size = dmi.get_end_address() - addr + 1;
+    return res;
+}
+
+double read_snapshot(value_registry const& reg, double* values, size_t count) {
+    thread_local std::vector<value_registry::sample> samples;
+    sc_core::sc_time t;
+    if(!reg.read_snapshot(samples, &t))
+        return -1.0;
+    auto n = std::min(count, samples.size());
+    for(size_t i = 0; i < n; ++i)
+        values[i] = samples[i].to_double();
+    return t.to_seconds();
+}
+} // namespace pysysc
+} // namespace scc
@@ -0,0 +1,104 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_PYSYSC_SUPPORT_H_
+#define _SCC_PYSYSC_SUPPORT_H_
+
+#include "value_registry.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <sysc/kernel/sc_time.h>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @brief entry points for scripting languages (e.g. PySysC using cppyy)
+ *
+ * Each call into C++ from a language binding through reflection is costly, so these functions do a bulk of work per
+ * call and exchange data using plain pointers to buffers, which cppyy maps to objects supporting the Python buffer
+ * protocol (bytearray, numpy arrays) without copying.
+ */
+namespace pysysc {
+/**
+ * @brief run the simulation for n_steps steps of duration t
+ *
+ * @param t the duration of a step
+ * @param n_steps the number of steps
+ * @param callback_every the number of steps between two invocations of cb, 0 disables the callback
+ * @param cb the callback being called with the number of executed steps, the simulation stops if it returns false
+ * @return the number of executed steps, less than n_steps if the simulation stopped or cb returned false
+ */
+size_t run_for(sc_core::sc_time const& t, size_t n_steps, size_t callback_every, std::function<bool(size_t)> cb);
+//! run the simulation for n_steps steps of duration t without callback
+size_t run_for(sc_core::sc_time const& t, size_t n_steps = 1);
+/**
+ * @brief read memory using debug transactions of a TLM target socket
+ *
+ * @param socket the hierarchical name of the target socket (e.g. of a scc::memory or scc::router)
+ * @param addr the address
+ * @param buf the buffer receiving the data
+ * @param len the number of bytes to read
+ * @return the number of bytes read
+ */
+size_t read_memory(std::string const& socket, uint64_t addr, uint8_t* buf, size_t len);
+/**
+ * @brief write memory using debug transactions of a TLM target socket
+ *
+ * @param socket the hierarchical name of the target socket
+ * @param addr the address
+ * @param buf the buffer holding the data
+ * @param len the number of bytes to write
+ * @return the number of bytes written
+ */
+size_t write_memory(std::string const& socket, uint64_t addr, uint8_t const* buf, size_t len);
+//! a directly accessible memory region
+struct memory_view {
+    //! the pointer to the byte at the requested address, nullptr if direct access is not possible
+    uint8_t* data{nullptr};
+    //! the number of bytes accessible starting at data
+    uint64_t size{0};
+};
+/**
+ * @brief get direct access to the memory behind a TLM target socket using DMI
+ *
+ * For a scc::memory the view covers the page of its storage holding the address, so the data can be accessed
+ * without copying. The view is only valid until the simulation continues as the DMI grant may be invalidated.
+ *
+ * @param socket the hierarchical name of the target socket
+ * @param addr the address
+ * @param write if true the view needs to allow write accesses
+ * @return the view, its data is nullptr if DMI is not granted
+ */
+memory_view get_memory_view(std::string const& socket, uint64_t addr, bool write = false);
+/**
+ * @brief read the snapshot of the value registry published last as doubles (see value_registry::read_snapshot)
+ *
+ * @param reg the value registry
+ * @param values the buffer receiving the values in the order of value_registry::get_snapshot_names()
+ * @param count the size of the buffer, surplus values are dropped
+ * @return the simulation time of the snapshot in seconds, negative if no snapshot has been published yet
+ */
+double read_snapshot(value_registry const& reg, double* values, size_t count);
+} // namespace pysysc
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_PYSYSC_SUPPORT_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2017, 2018 MINRES Technologies GmbH
+ * Copyright 2017, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -21,10 +21,17 @@
  */
 
 #include "report.h"
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <deque>
 #include <fstream>
 #include "configurer.h"
+#include "counters.h"
+#include "span_tracer.h"
+#include <fmt/format.h>
+#include <iterator>
 #include <mutex>
 #include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
@@ -33,6 +40,10 @@
 #include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <util/binary_log.h>
+#include <util/io-redirector.h>
+#include <util/lz4_streambuf.h>
+#include <util/open_addressing_map.h>
 #ifdef __GNUC__
 #define GCC_VERSION (__GNUC__ * 10000 + __GNUC_MINOR__ * 100 + __GNUC_PATCHLEVEL__)
 #if GCC_VERSION < 40900
@@ -50,6 +61,14 @@
 #else
 #include <regex>
 #endif
+#ifdef _MSC_VER
+#include <io.h>
+#define dup _dup
+#define fdopen _fdopen
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
 #ifdef ERROR
 #undef ERROR
 #endif
@@ -75,9 +94,13 @@ struct char_hash{
     	return hash;
     }
 };
+//! the generation of the log level configuration, the caches of all threads are refreshed if it changes
+std::atomic<unsigned> log_level_generation{1};
 thread_local struct {
 	std::unordered_map<char const*, sc_core::sc_verbosity, char_hash, char_equal_to> table;
-	std::vector<std::string> cache;
+	// a deque keeps the strings (and hence the keys of the table) in place when growing
+	std::deque<std::string> cache;
+	unsigned generation{1};
 	void insert(char const* key, sc_core::sc_verbosity verb) {
 		cache.push_back(key);
 		table.insert({cache.back().c_str(), verb});
@@ -86,7 +109,43 @@ thread_local struct {
 	    table.clear();
 	    cache.clear();
 	}
+	void refresh() {
+		auto current = log_level_generation.load(std::memory_order_relaxed);
+		if(generation != current) {
+			clear();
+			generation = current;
+		}
+	}
 } lut;
+/*
+ * the per-instance verbosity keyed by the address of the name as most log statements pass the (stable) name of the
+ * sc_object. The name is kept to detect addresses being reused for a different string, entries of an older generation
+ * are resolved again.
+ */
+struct verbosity_slot {
+	std::string name;
+	sc_core::sc_verbosity verb{sc_core::SC_MEDIUM};
+	unsigned generation{0};
+};
+//! the upper bound of slots to avoid growing due to temporary strings
+const size_t max_verbosity_slots = 4096;
+thread_local struct {
+	util::open_addressing_map<uintptr_t, verbosity_slot> table{256};
+	sc_core::sc_verbosity const* find(char const* key) {
+		auto* slot = table.find(reinterpret_cast<uintptr_t>(key));
+		if(likely(slot && slot->generation == log_level_generation.load(std::memory_order_relaxed) && slot->name == key))
+			return &slot->verb;
+		return nullptr;
+	}
+	void insert(char const* key, sc_core::sc_verbosity verb) {
+		if(unlikely(table.size() >= max_verbosity_slots))
+			table.clear();
+		auto& slot = table[reinterpret_cast<uintptr_t>(key)];
+		slot.name = key;
+		slot.verb = verb;
+		slot.generation = log_level_generation.load(std::memory_order_relaxed);
+	}
+} ptr_lut;
 #ifdef MTI_SYSTEMC
 static const cci::cci_originator originator;
 #else
@@ -101,17 +160,26 @@ bool& inst_based_logging() {
 struct ExtLogConfig : public scc::LogConfig {
 	shared_ptr<spdlog::logger> file_logger;
 	shared_ptr<spdlog::logger> console_logger;
+	shared_ptr<util::binary_log_writer> binary_logger;
 #ifdef USE_C_REGEX
 	regex_t start_state{};
 #else
 	regex reg_ex;
 #endif
 	sc_time cycle_base{0, SC_NS};
+	//! true in threads which inherited the configuration, their messages are buffered
+	bool worker{false};
+	//! the tag of the thread printed after the time stamp
+	std::string thread_tag;
+	ExtLogConfig() = default;
+	ExtLogConfig(ExtLogConfig const&) = default;
+	~ExtLogConfig();
+	ExtLogConfig& operator=(ExtLogConfig const&) = default;
 	auto operator=(const scc::LogConfig& o) -> ExtLogConfig& {
 		scc::LogConfig::operator=(o);
 		return *this;
 	}
-	auto match(const char* type) -> bool {
+	auto match(const char* type) const -> bool {
 #ifdef USE_C_REGEX
 		return regexec(&start_state, type, 0, nullptr, 0) == 0;
 #else
@@ -120,8 +188,126 @@ struct ExtLogConfig : public scc::LogConfig {
 	}
 };
 
+/*
+ * a file sink writing large blocks instead of going through stdio with its default buffer size, optionally
+ * compressing the log on the fly. The data reaches the file when a block is full, when the logger flushes (warnings
+ * and above) and in the intervals of spdlog::flush_every()
+ */
+class block_file_sink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+	block_file_sink(std::string const& name, size_t block_size, bool compress)
+	: buffer(compress ? 0 : block_size) {
+		if(!compress)
+			ofs.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+		ofs.open(name, ios::out | ios::trunc | ios::binary);
+		if(!ofs.is_open())
+			throw spdlog::spdlog_ex("could not open log file " + name);
+		if(compress)
+			strbuf.reset(new util::lz4c_mt_streambuf(ofs, block_size, 2));
+		os.rdbuf(compress ? static_cast<std::streambuf*>(strbuf.get()) : ofs.rdbuf());
+	}
+
+	~block_file_sink() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		os.flush();
+		if(strbuf)
+			strbuf->close();
+		ofs.close();
+	}
+
+protected:
+	void sink_it_(spdlog::details::log_msg const& msg) override {
+		spdlog::memory_buf_t formatted;
+		formatter_->format(msg, formatted);
+		os.write(formatted.data(), formatted.size());
+	}
+
+	void flush_() override { os.flush(); }
+
+private:
+	std::vector<char> buffer;
+	std::ofstream ofs;
+	std::unique_ptr<util::lz4c_mt_streambuf> strbuf;
+	std::ostream os{nullptr};
+};
+
 thread_local ExtLogConfig log_cfg;
 
+std::mutex cfg_guard;
+//! the configuration of the thread which initialized the logging, other threads inherit it
+ExtLogConfig* primary_log_cfg{nullptr};
+std::atomic<unsigned> worker_thread_count{0};
+
+ExtLogConfig::~ExtLogConfig() {
+	std::lock_guard<mutex> lock(cfg_guard);
+	if(primary_log_cfg == this)
+		primary_log_cfg = nullptr;
+}
+/*
+ * let a thread which did not initialize the logging (e.g. a worker thread of a parallel model) use the loggers of the
+ * thread which did
+ */
+auto inherit_log_config() -> bool {
+	if(likely(log_cfg.console_logger != nullptr))
+		return true;
+	std::lock_guard<mutex> lock(cfg_guard);
+	if(!primary_log_cfg || !primary_log_cfg->console_logger)
+		return false;
+	log_cfg = *primary_log_cfg;
+	log_cfg.worker = true;
+	log_cfg.thread_tag = fmt::format("[T{}]", ++worker_thread_count);
+	return true;
+}
+//! the number of messages of a worker thread passed to the loggers at once
+const size_t worker_batch_size = 64;
+std::mutex worker_guard;
+/*
+ * the messages of a worker thread. They are passed to the loggers in batches so that the threads only synchronize
+ * once per batch and the messages of a batch are not interleaved with those of other threads. Warnings and above
+ * are passed immediately.
+ */
+struct worker_log_buffer {
+	struct entry {
+		spdlog::logger* logger{nullptr};
+		spdlog::level::level_enum level{spdlog::level::info};
+		std::string msg;
+	};
+	std::vector<entry> entries;
+	size_t used{0};
+
+	~worker_log_buffer() { flush(); }
+
+	void add(spdlog::logger& logger, spdlog::level::level_enum lvl, spdlog::string_view_t msg) {
+		if(used == entries.size())
+			entries.emplace_back();
+		// the entries are reused to keep the allocated strings
+		auto& e = entries[used++];
+		e.logger = &logger;
+		e.level = lvl;
+		e.msg.assign(msg.data(), msg.size());
+		if(lvl >= spdlog::level::warn || used >= worker_batch_size)
+			flush();
+	}
+
+	void flush() {
+		if(!used)
+			return;
+		std::lock_guard<mutex> lock(worker_guard);
+		for(size_t i = 0; i < used; ++i)
+			entries[i].logger->log(entries[i].level, entries[i].msg);
+		used = 0;
+	}
+};
+// constructed after log_cfg of the thread so it is flushed before the loggers are released
+thread_local worker_log_buffer worker_log;
+
+inline void emit(spdlog::logger& logger, spdlog::level::level_enum lvl, spdlog::string_view_t msg) {
+	if(likely(!log_cfg.worker))
+		logger.log(lvl, msg);
+	else
+		worker_log.add(logger, lvl, msg);
+}
+
 auto get_tuple(const sc_time& t) -> tuple<sc_time::value_type, sc_time_unit> {
 	auto val = t.value();
 	auto tr = (uint64_t)(sc_time::from_value(1).to_seconds() * 1E15);
@@ -143,7 +329,7 @@ auto get_tuple(const sc_time& t) -> tuple<sc_time::value_type, sc_time_unit> {
 	return make_tuple(val, static_cast<sc_time_unit>(tu));
 }
 
-auto time2string(const sc_time& t) -> string {
+void append_time(fmt::memory_buffer& buf, const sc_time& t) {
 	const array<const char*, 6> time_units{"fs", "ps", "ns", "us", "ms", "s "};
 	const array<uint64_t, 6> multiplier{1ULL,
 		1000ULL,
@@ -151,9 +337,8 @@ auto time2string(const sc_time& t) -> string {
 		1000ULL * 1000 * 1000,
 		1000ULL * 1000 * 1000 * 1000,
 		1000ULL * 1000 * 1000 * 1000 * 1000};
-	ostringstream oss;
 	if(!t.value()) {
-		oss << "0 s ";
+		fmt::format_to(std::back_inserter(buf), "0 s ");
 	} else {
 		const auto tt = get_tuple(t);
 		const auto val = get<0>(tt);
@@ -163,14 +348,20 @@ auto time2string(const sc_time& t) -> string {
 			if(fs_val >= multiplier[j]) {
 				const auto i = val / multiplier[j - scale];
 				const auto f = val % multiplier[j - scale];
-				oss << i << '.' << setw(3 * (j - scale)) << setfill('0') << right << f << ' ' << time_units[j];
+				fmt::format_to(std::back_inserter(buf), "{}.{:0{}} {}", i, f, 3 * (j - scale), time_units[j]);
 				break;
 			}
 		}
 	}
-	return oss.str();
+}
+
+auto time2string(const sc_time& t) -> string {
+	fmt::memory_buffer buf;
+	append_time(buf, t);
+	return fmt::to_string(buf);
 }
 auto compose_message(const sc_report& rep, const scc::LogConfig& cfg) -> const string {
+	SCC_SPAN("report.format");
 	if(rep.get_severity() > SC_INFO || cfg.log_filter_regex.length() == 0 ||
 			rep.get_verbosity() == sc_core::SC_MEDIUM || log_cfg.match(rep.get_msg_type())) {
 		stringstream os;
@@ -191,6 +382,7 @@ auto compose_message(const sc_report& rep, const scc::LogConfig& cfg) -> const s
 					os << "[" << std::setw(20) << std::setfill(' ') << t << "]";
 			}
 		}
+		os << log_cfg.thread_tag;
 		if(unlikely(rep.get_id() >= 0))
 			os << "("
 			<< "IWEF"[rep.get_severity()] << rep.get_id() << ") " << rep.get_msg_type() << ": ";
@@ -231,30 +423,97 @@ inline void log2logger(spdlog::logger& logger, const sc_report& rep, const scc::
 		switch(get_verbosity(rep)) {
 		case SC_DEBUG:
 		case SC_FULL:
-			logger.trace(msg);
+			emit(logger, spdlog::level::trace, msg);
 			break;
 		case SC_HIGH:
-			logger.debug(msg);
+			emit(logger, spdlog::level::debug, msg);
 			break;
 		default:
-			logger.info(msg);
+			emit(logger, spdlog::level::info, msg);
 			break;
 		}
 		break;
 		case SC_WARNING:
-			logger.warn(msg);
+			emit(logger, spdlog::level::warn, msg);
 			break;
 		case SC_ERROR:
-			logger.error(msg);
+			emit(logger, spdlog::level::err, msg);
 			break;
 		case SC_FATAL:
-			logger.critical(msg);
+			emit(logger, spdlog::level::critical, msg);
 			break;
 		default:
 			break;
 	}
 }
 
+/*
+ * compose an info message of the SCC logging macros in the same format as compose_message() does without creating
+ * a sc_report, the time is formatted into a separate buffer to right align it
+ */
+auto compose_info(fmt::memory_buffer& buf, char const* msg_type, std::string const& msg, int verbosity,
+		bool print_sim_time, unsigned type_field_width) -> bool {
+	SCC_SPAN("report.format");
+	if(log_cfg.log_filter_regex.length() && verbosity != sc_core::SC_MEDIUM && !log_cfg.match(msg_type))
+		return false;
+	buf.clear();
+	auto out = std::back_inserter(buf);
+	if(likely(print_sim_time)) {
+		if(unlikely(log_cfg.cycle_base.value())) {
+			auto cycles = sc_time_stamp().value() / log_cfg.cycle_base.value();
+			if(unlikely(log_cfg.print_delta))
+				fmt::format_to(out, "[{:>7}({:>5})]", cycles, sc_delta_count());
+			else
+				fmt::format_to(out, "[{:>7}]", cycles);
+		} else {
+			thread_local fmt::memory_buffer time_buf;
+			time_buf.clear();
+			append_time(time_buf, sc_time_stamp());
+			auto t = fmt::string_view(time_buf.data(), time_buf.size());
+			if(unlikely(log_cfg.print_delta))
+				fmt::format_to(out, "[{:>20}({:>5})]", t, sc_delta_count());
+			else
+				fmt::format_to(out, "[{:>20}]", t);
+		}
+	}
+	buf.append(log_cfg.thread_tag.data(), log_cfg.thread_tag.data() + log_cfg.thread_tag.size());
+	if(type_field_width) {
+		auto width = type_field_width;
+		auto len = strlen(msg_type);
+		if(width == std::numeric_limits<unsigned>::max() || width < 7)
+			fmt::format_to(out, "{}: ", msg_type);
+		else if(len > width) // the same as util::padded()
+			fmt::format_to(out, "{}...{}: ", fmt::string_view(msg_type, 3),
+					fmt::string_view(msg_type + len - (width - 6), width - 6));
+		else
+			fmt::format_to(out, "{:<{}}: ", msg_type, width);
+	}
+	buf.append(msg.data(), msg.data() + msg.size());
+	return true;
+}
+
+inline void log2logger(spdlog::logger& logger, fmt::memory_buffer const& buf, int verbosity) {
+	auto msg = spdlog::string_view_t(buf.data(), buf.size());
+	switch(verbosity) {
+	case SC_DEBUG:
+	case SC_FULL:
+		emit(logger, spdlog::level::trace, msg);
+		break;
+	case SC_HIGH:
+		emit(logger, spdlog::level::debug, msg);
+		break;
+	default:
+		emit(logger, spdlog::level::info, msg);
+		break;
+	}
+}
+
+inline void log2binary(util::binary_log_writer& logger, sc_severity severity, char const* msg_type, char const* msg,
+		size_t len, int verbosity, char const* file, int line) {
+	logger.write(severity, verbosity, msg_type, file ? file : "", line, sc_time_stamp().value(), sc_delta_count(), msg,
+			len);
+}
+
 inline void log2logger(spdlog::logger& logger, scc::log lvl, const string& msg) {
 	switch(lvl) {
 	case scc::log::DBGTRACE:
@@ -281,14 +540,57 @@ inline void log2logger(spdlog::logger& logger, scc::log lvl, const string& msg)
 	}
 }
 
+/*
+ * wait until the thread pool of the async loggers processed the queued messages and flush the sinks, the sinks are
+ * locked while a message is written so this also waits for the message being processed
+ */
+void flush_loggers() {
+	if(log_cfg.log_async)
+		if(auto pool = spdlog::thread_pool()) {
+			auto deadline = chrono::steady_clock::now() + chrono::seconds(1);
+			while(pool->queue_size() && chrono::steady_clock::now() < deadline)
+				this_thread::yield();
+		}
+	for(auto* logger : {log_cfg.console_logger.get(), log_cfg.file_logger.get()})
+		if(logger)
+			for(auto& sink : logger->sinks())
+				sink->flush();
+	if(log_cfg.binary_logger)
+		log_cfg.binary_logger->flush();
+}
+
+// the messages per severity are part of the run report (see scc::run_report), info messages reach this either via
+// report_handler() or via scc::log_info_direct()
+inline void count_report(sc_severity severity) {
+	switch(severity) {
+	case SC_INFO:
+		SCC_COUNT("report.info");
+		break;
+	case SC_WARNING:
+		SCC_COUNT("report.warning");
+		break;
+	case SC_ERROR:
+		SCC_COUNT("report.error");
+		break;
+	default:
+		SCC_COUNT("report.fatal");
+	}
+}
+
 void report_handler(const sc_report& rep, const sc_actions& actions) {
 	thread_local bool sc_stop_called = false;
 	if(actions & SC_DO_NOTHING)
 		return;
+	if(unlikely(!inherit_log_config()))
+		return;
+	count_report(rep.get_severity());
 	if(rep.get_severity() == sc_core::SC_INFO || !log_cfg.report_only_first_error ||
 			sc_report_handler::get_count(SC_ERROR) < 2) {
-		if((actions & SC_DISPLAY) && (!log_cfg.file_logger || get_verbosity(rep) < SC_HIGH))
+		if((actions & SC_DISPLAY) && ((!log_cfg.file_logger && !log_cfg.binary_logger) || get_verbosity(rep) < SC_HIGH))
 			log2logger(*log_cfg.console_logger, rep, log_cfg);
+		if((actions & SC_LOG) && log_cfg.binary_logger)
+			log2binary(*log_cfg.binary_logger, rep.get_severity(), rep.get_msg_type(), rep.get_msg(), strlen(rep.get_msg()),
+					get_verbosity(rep), rep.get_file_name(), rep.get_line_number());
 		if((actions & SC_LOG) && log_cfg.file_logger) {
 			scc::LogConfig lcfg(log_cfg);
 			lcfg.print_sim_time = true;
@@ -298,26 +600,24 @@ void report_handler(const sc_report& rep, const sc_actions& actions) {
 		}
 	}
 	if(actions & SC_STOP) {
-		this_thread::sleep_for(chrono::milliseconds(static_cast<unsigned>(log_cfg.level) * 10));
+		flush_loggers();
 		if(sc_is_running() && !sc_stop_called) {
 			sc_stop();
 			sc_stop_called = true;
 		}
 	}
 	if(actions & SC_ABORT) {
-		this_thread::sleep_for(chrono::milliseconds(static_cast<unsigned>(log_cfg.level) * 20));
+		flush_loggers();
+		// joins the threads of the async loggers after they wrote the remaining messages
+		spdlog::shutdown();
 		abort();
 	}
 	if(actions & SC_THROW) {
-		this_thread::sleep_for(chrono::milliseconds(static_cast<unsigned>(log_cfg.level) * 20));
+		flush_loggers();
 		throw rep;
 	}
-	if(sc_time_stamp().value() && !sc_is_running()) {
-		log_cfg.console_logger->flush();
-		if(log_cfg.file_logger)
-			log_cfg.file_logger->flush();
-		this_thread::sleep_for(chrono::milliseconds(static_cast<unsigned>(log_cfg.level) * 10));
-	}
+	if(sc_time_stamp().value() && !sc_is_running())
+		flush_loggers();
 }
 } // namespace
 
@@ -375,10 +675,23 @@ auto scc::stream_redirection::sync() -> int {
 	return 0; // Success
 }
 
-static std::mutex cfg_guard;
+static auto console_pattern() -> std::string {
+	auto logger_fmt = log_cfg.print_severity ? "[%L] %v" : "%v";
+	if(log_cfg.colored_output) {
+		std::ostringstream os;
+		os << "%^" << logger_fmt << "%$";
+		return os.str();
+	} else
+		return "[%L] %v";
+}
+
 static void configure_logging() {
 	std::lock_guard<mutex> lock(cfg_guard);
 	static bool spdlog_initialized = false;
+	primary_log_cfg = &log_cfg;
+	log_cfg.worker = false;
+	log_cfg.thread_tag.clear();
+	scc::log_site_limit() = log_cfg.message_limit_per_site;
 	if(!log_cfg.dont_create_broker)
 		scc::init_cci("SCCBroker");
 	if(log_cfg.install_handler){
@@ -391,13 +704,7 @@ static void configure_logging() {
 					log_cfg.log_file_name.size() ? 2U : 1U); // queue with 8k items and 1 backing thread.
 			log_cfg.console_logger = log_cfg.log_async ? spdlog::stdout_color_mt<spdlog::async_factory>("console_logger")
 					: spdlog::stdout_color_mt("console_logger");
-			auto logger_fmt = log_cfg.print_severity ? "[%L] %v" : "%v";
-			if(log_cfg.colored_output) {
-				std::ostringstream os;
-				os << "%^" << logger_fmt << "%$";
-				log_cfg.console_logger->set_pattern(os.str());
-			} else
-				log_cfg.console_logger->set_pattern("[%L] %v");
+			log_cfg.console_logger->set_pattern(console_pattern());
 			log_cfg.console_logger->flush_on(spdlog::level::warn);
 			log_cfg.console_logger->set_level(spdlog::level::level_enum::trace);
 			if(log_cfg.log_file_name.size()) {
@@ -405,9 +712,19 @@ static void configure_logging() {
 					ofstream ofs;
 					ofs.open(log_cfg.log_file_name, ios::out | ios::trunc);
 				}
-				log_cfg.file_logger =
-						log_cfg.log_async ? spdlog::basic_logger_mt<spdlog::async_factory>("file_logger", log_cfg.log_file_name)
-								: spdlog::basic_logger_mt("file_logger", log_cfg.log_file_name);
+				if(log_cfg.log_file_block_size || log_cfg.log_file_compression) {
+					auto block_size = max<size_t>(log_cfg.log_file_block_size, 64 * 1024);
+					log_cfg.file_logger = log_cfg.log_async
+							? spdlog::create_async<block_file_sink>("file_logger", log_cfg.log_file_name, block_size,
+									log_cfg.log_file_compression)
+							: spdlog::create<block_file_sink>("file_logger", log_cfg.log_file_name, block_size,
+									log_cfg.log_file_compression);
+					if(log_cfg.log_file_flush_interval)
+						spdlog::flush_every(std::chrono::seconds(log_cfg.log_file_flush_interval));
+				} else
+					log_cfg.file_logger =
+							log_cfg.log_async ? spdlog::basic_logger_mt<spdlog::async_factory>("file_logger", log_cfg.log_file_name)
+									: spdlog::basic_logger_mt("file_logger", log_cfg.log_file_name);
 				if(log_cfg.print_severity)
 					log_cfg.file_logger->set_pattern("[%8l] %v");
 				else
@@ -421,6 +738,10 @@ static void configure_logging() {
 			if(log_cfg.log_file_name.size())
 				log_cfg.file_logger = spdlog::get("file_logger");
 		}
+		if(log_cfg.binary_log_file_name.size() && !log_cfg.binary_logger) {
+			auto resolution_fs = static_cast<uint64_t>(sc_time::from_value(1).to_seconds() * 1e15 + 0.5);
+			log_cfg.binary_logger = make_shared<util::binary_log_writer>(log_cfg.binary_log_file_name, resolution_fs);
+		}
 		if(log_cfg.log_filter_regex.size()) {
 #ifdef USE_C_REGEX
 			regcomp(&log_cfg.start_state, log_cfg.log_filter_regex.c_str(), REG_EXTENDED);
@@ -434,7 +755,7 @@ static void configure_logging() {
 void scc::reinit_logging(scc::log level) {
 	if(log_cfg.install_handler) sc_report_handler::set_handler(report_handler);
 	log_cfg.level = level;
-	lut.clear();
+	scc::reset_log_verbosity_cache();
 	if(!log_cfg.instance_based_log_levels || getenv("SCC_DISABLE_INSTANCE_BASED_LOGGING"))
 		inst_based_logging()=false;
 }
@@ -443,16 +764,19 @@ void scc::init_logging(scc::log level, unsigned type_field_width, bool print_tim
 	log_cfg.msg_type_field_width = type_field_width;
 	log_cfg.print_sys_time = print_time;
 	log_cfg.level = level;
+	scc::reset_log_verbosity_cache();
 	configure_logging();
 }
 
 void scc::init_logging(const scc::LogConfig& log_config) {
 	log_cfg = log_config;
+	scc::reset_log_verbosity_cache();
 	configure_logging();
 }
 
 void scc::set_logging_level(scc::log level) {
 	log_cfg.level = level;
+	scc::reset_log_verbosity_cache();
 	sc_report_handler::set_verbosity_level(verbosity[static_cast<unsigned>(level)]);
 	log_cfg.console_logger->set_level(static_cast<spdlog::level::level_enum>(
 			SPDLOG_LEVEL_OFF - min<int>(SPDLOG_LEVEL_OFF, static_cast<int>(log_cfg.level))));
@@ -502,6 +826,15 @@ auto scc::LogConfig::logFileName(const string& name) -> scc::LogConfig& {
 	return *this;
 }
 
+auto scc::LogConfig::logFileName(const string& name, size_t block_size, bool compress, unsigned flush_interval)
+		-> scc::LogConfig& {
+	this->log_file_name = name;
+	this->log_file_block_size = block_size;
+	this->log_file_compression = compress;
+	this->log_file_flush_interval = flush_interval;
+	return *this;
+}
+
 auto scc::LogConfig::coloredOutput(bool enable) -> scc::LogConfig& {
 	this->colored_output = enable;
 	return *this;
@@ -539,12 +872,125 @@ auto scc::LogConfig::installHandler(bool v) -> scc::LogConfig& {
 	this->install_handler = v;
 	return *this;
 }
+auto scc::LogConfig::directInfoLogging(bool v) -> scc::LogConfig& {
+	this->direct_info_logging = v;
+	return *this;
+}
+auto scc::LogConfig::binaryLogFileName(const string& name) -> scc::LogConfig& {
+	this->binary_log_file_name = name;
+	return *this;
+}
+auto scc::LogConfig::messageLimitPerSite(unsigned limit, sc_time period) -> scc::LogConfig& {
+	this->message_limit_per_site = limit;
+	this->message_limit_period = period;
+	return *this;
+}
+
+auto scc::check_log_site(log_site& site, char const* file, int line) -> bool {
+	auto period = log_cfg.message_limit_period.value();
+	auto idx = period ? sc_time_stamp().value() / period : 0;
+	if(idx != site.period) {
+		if(site.suppressed) {
+			auto msg = fmt::format("{} messages of {}:{} have been suppressed", site.suppressed, file, line);
+			sc_report_handler::report(SC_WARNING, "scc::report", msg.c_str(), SC_MEDIUM, file, line);
+		}
+		site.period = idx;
+		site.count = 0;
+		site.suppressed = 0;
+	}
+	if(site.count < log_site_limit()) {
+		++site.count;
+		return true;
+	}
+	if(!site.suppressed++) {
+		auto msg = fmt::format("limit of {} messages reached, further messages of {}:{} are suppressed{}",
+				log_site_limit(), file, line, period ? " in this period" : "");
+		sc_report_handler::report(SC_WARNING, "scc::report", msg.c_str(), SC_MEDIUM, file, line);
+	}
+	return false;
+}
+
+auto scc::log_info_direct(char const* msg_type, std::string const& msg, int verbosity, char const* file, int line)
+		-> bool {
+	// after the simulation the sc_report path takes care of flushing the loggers
+	if(!inherit_log_config() || !log_cfg.direct_info_logging || sc_report_handler::get_handler() != report_handler ||
+			(sc_time_stamp().value() && !sc_is_running()))
+		return false;
+	// the same filter as in sc_report_handler::report()
+	if(verbosity > sc_report_handler::get_verbosity_level())
+		return true;
+	count_report(SC_INFO);
+	thread_local fmt::memory_buffer buf;
+	auto verb = verbosity > sc_core::SC_NONE && verbosity < sc_core::SC_LOW ? verbosity * 10 : verbosity;
+	if(log_cfg.binary_logger)
+		log2binary(*log_cfg.binary_logger, SC_INFO, msg_type, msg.data(), msg.size(), verb, file, line);
+	if(((!log_cfg.file_logger && !log_cfg.binary_logger) || verb < SC_HIGH) &&
+			compose_info(buf, msg_type, msg, verbosity, log_cfg.print_sim_time, log_cfg.msg_type_field_width))
+		log2logger(*log_cfg.console_logger, buf, verb);
+	// the file log always has the time and the message type, see report_handler()
+	if(log_cfg.file_logger && compose_info(buf, msg_type, msg, verbosity, true,
+			log_cfg.msg_type_field_width ? log_cfg.msg_type_field_width : 24))
+		log2logger(*log_cfg.file_logger, buf, verb);
+	return true;
+}
+
+void scc::flush_log_buffer() { worker_log.flush(); }
+
+void scc::forward_output_to_log(bool enable, char const* msg_type) {
+	auto& redirector = util::IoRedirector::get();
+	if(!enable) {
+		redirector.stop();
+		return;
+	}
+	if(redirector.is_active())
+		return;
+	// the console logger needs to write to the original stdout, otherwise its output would be captured as well
+	static FILE* console_out{nullptr};
+	if(!console_out) {
+		flush_loggers();
+		console_out = fdopen(dup(fileno(stdout)), "w");
+		if(!console_out) {
+			SCCWARN("scc::report") << "could not duplicate stdout, the output is not forwarded";
+			return;
+		}
+#ifndef _WIN32
+		if(log_cfg.console_logger) {
+			log_cfg.console_logger->sinks()[0] =
+					make_shared<spdlog::sinks::ansicolor_sink<spdlog::details::console_mutex>>(console_out,
+							spdlog::color_mode::automatic);
+			log_cfg.console_logger->set_pattern(console_pattern());
+		}
+#endif
+	}
+	std::string type(msg_type);
+	redirector.start([type](char const* data, size_t len) {
+		auto end = data + len;
+		while(data < end) {
+			auto eol = std::find(data, end, '\n');
+			std::string line(data, eol);
+			if(!log_info_direct(type.c_str(), line, SC_MEDIUM, __FILE__, __LINE__)) {
+				line += '\n';
+				fwrite(line.data(), 1, line.size(), console_out);
+				fflush(console_out);
+			}
+			data = eol + 1;
+		}
+		flush_log_buffer();
+	});
+}
+
+void scc::reset_log_verbosity_cache() { log_level_generation.fetch_add(1, std::memory_order_relaxed); }
 
 auto scc::get_log_verbosity(char const* str) -> sc_core::sc_verbosity {
 	if(inst_based_logging()){
+		if(auto* verb = ptr_lut.find(str))
+			return *verb;
+		lut.refresh();
 		auto it = lut.table.find(str);
-		if(it != lut.table.end())
+		if(it != lut.table.end()) {
+			ptr_lut.insert(str, it->second);
 			return it->second;
+		}
 		if(strchr(str, '.') == nullptr || sc_core::sc_get_current_object()) {
 			string current_name = std::string(str);
 			auto broker = sc_core::sc_get_current_object()? cci::cci_get_broker(): cci::cci_get_global_broker(originator);
@@ -554,17 +1000,20 @@ auto scc::get_log_verbosity(char const* str) -> sc_core::sc_verbosity {
 				if (h.is_valid()) {
 					sc_core::sc_verbosity ret = verbosity.at(std::min<unsigned>(h.get_cci_value().get_int(), verbosity.size() - 1));
 					lut.insert(str, ret);
+					ptr_lut.insert(str, ret);
 					return ret;
 				} else {
 					auto val = broker.get_preset_cci_value(param_name);
 					if (val.is_int()) {
 						sc_core::sc_verbosity ret = verbosity.at(std::min<unsigned>(val.get_int(), verbosity.size() - 1));
 						lut.insert(str, ret);
+						ptr_lut.insert(str, ret);
 						return ret;
 					} else {
 						if (current_name.empty()) {
 							sc_core::sc_verbosity ret = static_cast<sc_core::sc_verbosity>(::sc_core::sc_report_handler::get_verbosity_level());
 							lut.insert(str, ret);
+							ptr_lut.insert(str, ret);
 							return ret;
 						}
 						auto pos = current_name.rfind(".");
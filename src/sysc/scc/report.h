@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2018 MINRES Technologies GmbH
+ * Copyright 2016, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -160,12 +160,19 @@ struct LogConfig {
     bool print_severity{true};
     bool colored_output{true};
     std::string log_file_name{""};
+    size_t log_file_block_size{0};
+    bool log_file_compression{false};
+    unsigned log_file_flush_interval{5};
     std::string log_filter_regex{""};
     bool log_async{true};
     bool dont_create_broker{false};
     bool report_only_first_error{false};
     bool instance_based_log_levels{true};
     bool install_handler{true};
+    bool direct_info_logging{true};
+    std::string binary_log_file_name{""};
+    unsigned message_limit_per_site{0};
+    sc_core::sc_time message_limit_period{};
 
     /**
      * set the logging level
@@ -221,6 +228,17 @@ struct LogConfig {
      * @return self
      */
     LogConfig& logFileName(const std::string&);
+    /**
+     * set the file name for the log output file being written in large blocks, e.g. for big logs on network file
+     * systems. Warnings and above still flush the file immediately
+     * @param name of the log file to be generated
+     * @param block_size the size of the blocks being written (at least 64kB)
+     * @param compress compress the log using the LZ4 frame format (decompress e.g. using lz4 -d)
+     * @param flush_interval the interval in seconds to flush the file, 0 to flush only when a block is full
+     * @return self
+     */
+    LogConfig& logFileName(const std::string& name, size_t block_size, bool compress = false,
+                           unsigned flush_interval = 5);
     /**
      * set the file name for the log output file
      * @param name
@@ -263,6 +281,28 @@ struct LogConfig {
      * @return self
      */
     LogConfig& installHandler(bool = true);
+    /**
+     * disable/enable passing info messages of the SCC macros directly to the logger without creating a sc_report.
+     * Per message type actions of the sc_report_handler are not applied to them
+     * @param
+     * @return self
+     */
+    LogConfig& directInfoLogging(bool = true);
+    /**
+     * set the file name for a binary log. It receives all messages as raw records being formatted only when decoded
+     * (e.g. using logdecode). As with the log file only messages below debug level are printed on the console
+     * @param name of the binary log file to be generated
+     * @return self
+     */
+    LogConfig& binaryLogFileName(const std::string&);
+    /**
+     * limit the number of messages each log statement below error level emits, the number of suppressed messages is
+     * reported once the next period starts
+     * @param limit the number of messages per period, 0 for no limit
+     * @param period the length of the period in simulated time, SC_ZERO_TIME for the whole simulation
+     * @return self
+     */
+    LogConfig& messageLimitPerSite(unsigned limit, sc_core::sc_time period = sc_core::SC_ZERO_TIME);
 };
 /**
  * @fn void init_logging(const LogConfig&)
@@ -325,6 +365,78 @@ sc_core::sc_verbosity get_log_verbosity(char const* t);
  * @return the verbosity level
  */
 inline sc_core::sc_verbosity get_log_verbosity(std::string const& t) { return get_log_verbosity(t.c_str()); }
+/**
+ * @fn bool log_info_direct(const char*, std::string const&, int, const char*, int)
+ * @brief pass an info message directly to the loggers of the SCC report handler bypassing the sc_report_handler
+ *
+ * This is only done if the SCC report handler is installed and direct info logging is enabled
+ *
+ * @param msg_type the type (category) of the message
+ * @param msg the message
+ * @param verbosity the verbosity of the message
+ * @param file where the log entry originates
+ * @param line number where the log entry originates
+ * @return true if the message has been handled
+ */
+bool log_info_direct(char const* msg_type, std::string const& msg, int verbosity, char const* file, int line);
+/**
+ * @struct log_site
+ * @brief the state of a log statement used to limit the number of its messages, see LogConfig::messageLimitPerSite()
+ */
+struct log_site {
+    //! the index of the current period
+    uint64_t period{0};
+    unsigned count{0};
+    uint64_t suppressed{0};
+};
+//! the limit of messages per log statement and period, 0 if the messages are not limited
+inline unsigned& log_site_limit() {
+    static unsigned limit{0};
+    return limit;
+}
+/**
+ * @fn bool check_log_site(log_site&, const char*, int)
+ * @brief count a message of a log statement and report the messages suppressed in the previous period
+ *
+ * @param site the state of the log statement
+ * @param file where the log statement is located
+ * @param line the line of the log statement
+ * @return true if the message shall be emitted
+ */
+bool check_log_site(log_site& site, char const* file, int line);
+//! check if a message of a log statement shall be emitted, this is cheap as long as there is no limit
+inline bool allow_log_site(log_site& site, char const* file, int line) {
+    return !log_site_limit() || check_log_site(site, file, line);
+}
+/**
+ * @fn void flush_log_buffer()
+ * @brief pass the buffered messages of the calling thread to the loggers
+ *
+ * Threads other than the one which initialized the logging use its configuration and buffer their messages,
+ * the buffer is passed on when it is full, upon a warning or above, and when the thread ends.
+ */
+void flush_log_buffer();
+/**
+ * @fn void forward_output_to_log(bool, const char*)
+ * @brief capture the output written to stdout and stderr (e.g. by printf of legacy models) and pass it line by line
+ * as info messages to the loggers
+ *
+ * A background thread reads the output in large chunks so the writers do not synchronize with the simulation thread.
+ * The console logger keeps writing to the original stdout. This needs to be called after the logging has been
+ * initialized and while no other thread is logging.
+ *
+ * @param enable start or stop forwarding
+ * @param msg_type the message type of the forwarded lines
+ */
+void forward_output_to_log(bool enable = true, char const* msg_type = "stdout");
+/**
+ * @fn void reset_log_verbosity_cache()
+ * @brief invalidate the cached scope-based verbosity levels of all threads
+ *
+ * The levels are looked up again upon the next log statement of the scope. This needs to be called if the log_level
+ * parameters are changed after they have been used.
+ */
+void reset_log_verbosity_cache();
 /**
  * @struct ScLogger
  * @brief the logger class
@@ -359,11 +471,13 @@ template <sc_core::sc_severity SEVERITY> struct ScLogger {
     ScLogger& operator=(ScLogger&&) = delete;
     /**
      * @fn  ~ScLogger()
-     * @brief the destructor generating the SystemC report
+     * @brief the destructor generating the SystemC report, info messages are passed directly to the logger if possible
      *
      */
     virtual ~ScLogger() {
-        ::sc_core::sc_report_handler::report(SEVERITY, t ? t : "SystemC", os.str().c_str(), level, file, line);
+        auto msg = os.str();
+        if(SEVERITY != ::sc_core::SC_INFO || !::scc::log_info_direct(t ? t : "SystemC", msg, level, file, line))
+            ::sc_core::sc_report_handler::report(SEVERITY, t ? t : "SystemC", msg.c_str(), level, file, line);
     }
     /**
      * @fn ScLogger& type()
@@ -413,21 +527,35 @@ protected:
     const int level;
 };
 
+/**
+ * @brief the most verbose log level being compiled in as value of scc::log, e.g. 4 for INFO
+ *
+ * Log statements of a higher verbosity are removed at compile time including the check of the runtime log level,
+ * all levels up to SCC_MIN_LOG_LEVEL are filtered at runtime as usual. Errors and fatals are always kept.
+ */
+#ifndef SCC_MIN_LOG_LEVEL
+#define SCC_MIN_LOG_LEVEL 7
+#endif
+//! check at compile time if statements of the scc::log level lvl are compiled in
+#define SCC_LOG_LEVEL_ENABLED(lvl) (SCC_MIN_LOG_LEVEL >= static_cast<int>(lvl))
+//! check the message limit of the log statement, each expansion owns a static counter
+#define SCC_LOG_SITE_ALLOWED()                                                                                         \
+    ::scc::allow_log_site([]() -> ::scc::log_site& { static ::scc::log_site site; return site; }(), __FILE__, __LINE__)
 /**
  * logging macros
  */
 //! macro for log output
 #define SCCLOG(lvl, ...) ::scc::ScLogger<::sc_core::SC_INFO>(__FILE__, __LINE__, lvl / 10).type(__VA_ARGS__).get()
 //! macro for debug trace level output
-#define SCCTRACEALL(...) if(::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_DEBUG) SCCLOG(sc_core::SC_DEBUG, __VA_ARGS__)
+#define SCCTRACEALL(...) if(SCC_LOG_LEVEL_ENABLED(::scc::log::TRACEALL) && ::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_DEBUG && SCC_LOG_SITE_ALLOWED()) SCCLOG(sc_core::SC_DEBUG, __VA_ARGS__)
 //! macro for trace level output
-#define SCCTRACE(...) if(::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_FULL) SCCLOG(sc_core::SC_FULL, __VA_ARGS__)
+#define SCCTRACE(...) if(SCC_LOG_LEVEL_ENABLED(::scc::log::TRACE) && ::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_FULL && SCC_LOG_SITE_ALLOWED()) SCCLOG(sc_core::SC_FULL, __VA_ARGS__)
 //! macro for debug level output
-#define SCCDEBUG(...) if(::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_HIGH) SCCLOG(sc_core::SC_HIGH, __VA_ARGS__)
+#define SCCDEBUG(...) if(SCC_LOG_LEVEL_ENABLED(::scc::log::DEBUG) && ::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_HIGH && SCC_LOG_SITE_ALLOWED()) SCCLOG(sc_core::SC_HIGH, __VA_ARGS__)
 //! macro for info level output
-#define SCCINFO(...) if(::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_MEDIUM) SCCLOG(sc_core::SC_MEDIUM, __VA_ARGS__)
+#define SCCINFO(...) if(SCC_LOG_LEVEL_ENABLED(::scc::log::INFO) && ::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_MEDIUM && SCC_LOG_SITE_ALLOWED()) SCCLOG(sc_core::SC_MEDIUM, __VA_ARGS__)
 //! macro for warning level output
-#define SCCWARN(...) if(::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_LOW) ::scc::ScLogger<::sc_core::SC_WARNING>(__FILE__, __LINE__, sc_core::SC_MEDIUM).type(__VA_ARGS__).get()
+#define SCCWARN(...) if(SCC_LOG_LEVEL_ENABLED(::scc::log::WARNING) && ::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_LOW && SCC_LOG_SITE_ALLOWED()) ::scc::ScLogger<::sc_core::SC_WARNING>(__FILE__, __LINE__, sc_core::SC_MEDIUM).type(__VA_ARGS__).get()
 //! macro for error level output
 #define SCCERR(...) ::scc::ScLogger<::sc_core::SC_ERROR>(__FILE__, __LINE__, sc_core::SC_MEDIUM).type(__VA_ARGS__).get()
 //! macro for fatal message output
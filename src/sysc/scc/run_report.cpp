@@ -0,0 +1,167 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+
+#include "run_report.h"
+#include "counters.h"
+#include <algorithm>
+#include <fstream>
+#include <rapidjson/ostreamwrapper.h>
+#include <rapidjson/prettywriter.h>
+#include <util/pool_allocator.h>
+#include <utility>
+
+namespace scc {
+namespace {
+using writer_type = rapidjson::PrettyWriter<rapidjson::OStreamWrapper>;
+//! the counters of the report handler and the keys they are reported with
+const std::pair<char const*, char const*> log_counters[] = {
+    {"info", "report.info"}, {"warning", "report.warning"}, {"error", "report.error"}, {"fatal", "report.fatal"}};
+
+void write_value(writer_type& writer, char const* key, double value) {
+    writer.Key(key);
+    writer.Double(value);
+}
+
+void write_value(writer_type& writer, char const* key, uint64_t value) {
+    writer.Key(key);
+    writer.Uint64(value);
+}
+} // namespace
+
+void run_report::write(std::ostream& os) const {
+    auto counters = counter_registry::get().get_statistics();
+    // the statistics are sorted by name
+    auto find = [&counters](char const* name) -> counter_statistics const* {
+        auto it = std::lower_bound(counters.begin(), counters.end(), name,
+                                   [](counter_statistics const& s, char const* n) { return s.name < n; });
+        return it != counters.end() && it->name == name ? &*it : nullptr;
+    };
+    auto per_s = [this](double v) { return wall_time_s > 0 ? v / wall_time_s : 0.; };
+    rapidjson::OStreamWrapper stream(os);
+    writer_type writer(stream);
+    writer.StartObject();
+    writer.Key("schema");
+    writer.String("scc-run-report");
+    write_value(writer, "version", static_cast<uint64_t>(version));
+
+    writer.Key("simulation");
+    writer.StartObject();
+    write_value(writer, "sim_time_s", sim_time_s);
+    write_value(writer, "elab_cpu_time_s", elab_cpu_time_s);
+    write_value(writer, "wall_time_s", wall_time_s);
+    write_value(writer, "cpu_time_s", cpu_time_s);
+    write_value(writer, "sim_per_wall", per_s(sim_time_s));
+    write_value(writer, "deltas", deltas);
+    write_value(writer, "deltas_per_s", per_s(static_cast<double>(deltas)));
+    write_value(writer, "cycles", cycles);
+    write_value(writer, "cycles_per_s", per_s(static_cast<double>(cycles)));
+    writer.EndObject();
+
+    writer.Key("memory");
+    writer.StartObject();
+    writer.Key("peak_rss_kB");
+    writer.Int64(peak_rss_kB);
+    uint64_t high_water_bytes = 0;
+    writer.Key("pools");
+    writer.StartArray();
+    for(auto& s : util::pool_registry::get().get_statistics()) {
+        high_water_bytes += static_cast<uint64_t>(s.high_water) * s.elem_size;
+        writer.StartObject();
+        write_value(writer, "elem_size", static_cast<uint64_t>(s.elem_size));
+        write_value(writer, "chunks", static_cast<uint64_t>(s.chunks));
+        write_value(writer, "capacity", static_cast<uint64_t>(s.capacity));
+        write_value(writer, "used", static_cast<uint64_t>(s.used));
+        write_value(writer, "high_water", static_cast<uint64_t>(s.high_water));
+        write_value(writer, "allocations", s.allocations);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    write_value(writer, "pool_high_water_bytes", high_water_bytes);
+    writer.EndObject();
+
+    writer.Key("trace");
+    writer.StartObject();
+    auto* trace_bytes = find("trace.bytes");
+    write_value(writer, "files", trace_bytes ? trace_bytes->count : 0);
+    write_value(writer, "bytes", trace_bytes ? trace_bytes->sum : 0);
+    writer.EndObject();
+
+    writer.Key("log");
+    writer.StartObject();
+    uint64_t total = 0;
+    for(auto& c : log_counters) {
+        auto* s = find(c.second);
+        total += s ? s->count : 0;
+        write_value(writer, c.first, s ? s->count : 0);
+    }
+    write_value(writer, "total", total);
+    writer.EndObject();
+
+    writer.Key("recorder");
+    writer.StartObject();
+    auto* tx_ns = find("recorder.tx_ns");
+    write_value(writer, "sampled_tx", tx_ns ? tx_ns->count : 0);
+    write_value(writer, "ns_per_tx", tx_ns ? tx_ns->mean() : 0.);
+    write_value(writer, "p99_ns", tx_ns ? tx_ns->value_at_percentile(99) : 0);
+    writer.EndObject();
+
+    writer.Key("counters");
+    writer.StartObject();
+    for(auto& s : counters)
+        if(s.count && !s.histogram)
+            write_value(writer, s.name.c_str(), s.count);
+    writer.EndObject();
+
+    writer.Key("histograms");
+    writer.StartObject();
+    for(auto& s : counters) {
+        if(!s.count || !s.histogram)
+            continue;
+        writer.Key(s.name.c_str());
+        writer.StartObject();
+        write_value(writer, "count", s.count);
+        write_value(writer, "sum", s.sum);
+        write_value(writer, "min", s.min);
+        write_value(writer, "mean", s.mean());
+        write_value(writer, "p50", s.value_at_percentile(50));
+        write_value(writer, "p99", s.value_at_percentile(99));
+        write_value(writer, "max", s.max);
+        writer.EndObject();
+    }
+    writer.EndObject();
+
+    writer.EndObject();
+    os << std::endl;
+}
+
+bool run_report::write(std::string const& file_name) const {
+    std::ofstream os(file_name);
+    if(!os.is_open())
+        return false;
+    write(os);
+    return true;
+}
+
+void account_trace_file(std::string const& file_name) {
+    std::ifstream is(file_name, std::ios::binary | std::ios::ate);
+    if(!is)
+        return;
+    auto size = is.tellg();
+    if(size >= 0)
+        SCC_HIST("trace.bytes", static_cast<uint64_t>(size));
+}
+} // namespace scc
@@ -0,0 +1,80 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+
+#ifndef _SCC_RUN_REPORT_H_
+#define _SCC_RUN_REPORT_H_
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @brief a machine readable report of a simulation run
+ *
+ * The report is written as a single JSON object. The keys schema and version identify its layout, so the reports of
+ * many runs (e.g. of each CI run) can be compared reliably. Keys are only added within a version. Besides the figures
+ * set by the creator (usually the \ref perf_estimator), the report contains:
+ * - the statistics of all util::pool_allocator instances;
+ * - the bytes of the trace files closed so far (counter trace.bytes, see account_trace_file());
+ * - the messages emitted by the SCC report handler (counters report.info, report.warning, report.error and
+ *   report.fatal);
+ * - the host time the TLM recorders spend per transaction (histogram recorder.tx_ns, sampled every 64th blocking
+ *   transaction);
+ * - all other counters and histograms of SCC_COUNT and SCC_HIST.
+ */
+struct run_report {
+    //! the version of the schema, it is incremented if keys change their meaning or are removed
+    static const unsigned version = 1;
+    //! the simulated time in seconds
+    double sim_time_s{0};
+    //! the process time of construction and elaboration in seconds
+    double elab_cpu_time_s{0};
+    //! the wall clock time of the simulation phase in seconds
+    double wall_time_s{0};
+    //! the process time of the simulation phase in seconds
+    double cpu_time_s{0};
+    //! the number of delta cycles
+    uint64_t deltas{0};
+    //! the number of simulated clock cycles, 0 if no cycle time is known
+    uint64_t cycles{0};
+    //! the peak resident set size in kB
+    long peak_rss_kB{0};
+    //! write the report to a stream
+    void write(std::ostream& os) const;
+    /**
+     * @brief write the report to a file
+     *
+     * @param file_name the name of the file
+     * @return false if the file could not be created
+     */
+    bool write(std::string const& file_name) const;
+};
+/**
+ * @brief add the size of a closed trace file to the counter trace.bytes of the run report
+ *
+ * @param file_name the name of the file
+ */
+void account_trace_file(std::string const& file_name);
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_RUN_REPORT_H_ */
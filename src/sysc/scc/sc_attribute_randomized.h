@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2022 MINRES Technologies GmbH
+ * Copyright 2022, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,8 +18,13 @@
 #define _SCC_SC_ATTRIBUTE_RANDOMIZED_H_
 
 #include "mt19937_rng.h"
+#include <cstdint>
+#include <limits>
+#include <string>
 #include <sysc/kernel/sc_attribute.h>
+#include <sysc/kernel/sc_simcontext.h>
 #include <type_traits>
+#include <vector>
 
 /** \ingroup scc-sysc
  *  @{
@@ -27,19 +32,125 @@
 /**@{*/
 //! @brief SCC SystemC utilities
 namespace scc {
+/**
+ * @brief the common part of all sc_attribute_randomized allowing to draw their values in a batch
+ *
+ * By default a randomized attribute draws a new value from the MT19937 generator of the calling process with each
+ * call of get_value(). In batch mode (see enable_batch_mode()) the value of an attribute is drawn once for all
+ * attributes constructed in this mode in a single pass of randomize_all(), e.g. called at end_of_elaboration. If it
+ * is not called explicitly the first call of get_value() of one of these attributes runs it. Each attribute uses its
+ * own substream seeded with MT19937::stream_seed() of its hierarchical name (the name of the object being constructed
+ * when the attribute is created and the name of the attribute) so the values do not depend on the construction order.
+ */
+class sc_attribute_randomized_base {
+public:
+    //! enable the batch mode for the attributes being constructed subsequently
+    static void enable_batch_mode(bool enable) { batch_mode_enabled() = enable; }
+    //! check if the batch mode is enabled for the attributes being constructed
+    static bool is_batch_mode() { return batch_mode_enabled(); }
+    //! draw the values of all attributes in batch mode whose value has not been drawn yet
+    static void randomize_all() {
+        auto& entries = pending();
+        for(auto* e : entries) {
+            // splitmix64 turns the substream seed into a well distributed random number
+            auto z = MT19937::stream_seed(e->path) + 0x9e3779b97f4a7c15ULL;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            e->rnd = z ^ (z >> 31);
+            e->drawn = true;
+            std::string().swap(e->path);
+        }
+        entries.clear();
+    }
+
+protected:
+    explicit sc_attribute_randomized_base(std::string const& name)
+    : batched{batch_mode_enabled()} {
+        if(!batched)
+            return;
+        auto* obj = sc_core::sc_get_current_object();
+        path = obj ? std::string(obj->name()) + "." + name : name;
+        add_pending();
+    }
+    //! a copy draws the same value as the original
+    sc_attribute_randomized_base(sc_attribute_randomized_base const& o)
+    : batched{o.batched}
+    , drawn{o.drawn}
+    , rnd{o.rnd}
+    , path{o.path} {
+        if(batched && !drawn)
+            add_pending();
+    }
+
+    sc_attribute_randomized_base& operator=(sc_attribute_randomized_base const&) = delete;
+
+    virtual ~sc_attribute_randomized_base() {
+        if(!batched || drawn)
+            return;
+        auto& entries = pending();
+        entries[idx] = entries.back();
+        entries[idx]->idx = idx;
+        entries.pop_back();
+    }
+    /**
+     * get the drawn random value between 0 and max (both included)
+     *
+     * @param max the upper limit
+     * @return the random value
+     */
+    uint64_t get_drawn(uint64_t max) {
+        if(!drawn)
+            randomize_all();
+        return max == std::numeric_limits<uint64_t>::max() ? rnd : rnd % (max + 1);
+    }
+    //! true if the attribute has been constructed in batch mode
+    const bool batched;
+
+private:
+    void add_pending() {
+        idx = pending().size();
+        pending().push_back(this);
+    }
+
+    static bool& batch_mode_enabled() {
+        static bool enabled{false};
+        return enabled;
+    }
+
+    static std::vector<sc_attribute_randomized_base*>& pending() {
+        static std::vector<sc_attribute_randomized_base*> entries;
+        return entries;
+    }
+
+    //! true if the random number has been drawn by randomize_all()
+    bool drawn{false};
+    //! the uniformly distributed random number
+    uint64_t rnd{0};
+    //! the hierarchical name of the attribute as long as it is pending
+    std::string path;
+    size_t idx{0};
+};
+/**
+ * @brief an attribute whose negative values denote a random value between 0 and the absolute value (both included)
+ *
+ * @tparam T the type of the attribute
+ */
 template <typename T>
-class sc_attribute_randomized: public sc_core::sc_attribute<T> {
+class sc_attribute_randomized: public sc_core::sc_attribute<T>, public sc_attribute_randomized_base {
 public:
     sc_attribute_randomized( const std::string& name_ )
         : sc_core::sc_attribute<T>( name_ )
+        , sc_attribute_randomized_base( name_ )
         {}
 
     sc_attribute_randomized( const std::string& name_, const T& value_ )
-        : sc_core::sc_attribute<T>( name_ )
+        : sc_core::sc_attribute<T>( name_, value_ )
+        , sc_attribute_randomized_base( name_ )
         {}
 
     sc_attribute_randomized( const sc_core::sc_attribute<T>& a )
-        : sc_core::sc_attribute<T>( a.name() )
+        : sc_core::sc_attribute<T>( a.name(), a.value )
+        , sc_attribute_randomized_base( a.name() )
         {}
 
 
@@ -53,9 +164,11 @@ public:
     template< typename U = T >
     resolvedType< std::is_signed<T>::value, U >
     get_value(){
-        if(this->value < 0)
-            return MT19937::uniform(0, -this->value);
-        else
+        if(this->value < 0) {
+            if(!batched)
+                return MT19937::uniform(0, -this->value);
+            return static_cast<T>(get_drawn(static_cast<uint64_t>(-static_cast<int64_t>(this->value))));
+        } else
             return this->value;
     }
 
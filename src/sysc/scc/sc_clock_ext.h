@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2022 MINRES Technologies GmbH
+ * Copyright 2022-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,6 +17,7 @@
 #ifndef _SCC_SC_CLOCK_EXT_H_
 #define _SCC_SC_CLOCK_EXT_H_
 
+#include "clock_domain.h"
 #include <sysc/communication/sc_clock.h>
 
 /** \ingroup scc-sysc
@@ -27,6 +28,9 @@
 namespace scc {
 /**
  * \brief A clock source with construction time configurable start delay
+ *
+ * The clock drives a scc::clock_domain, its period can be changed during simulation using set_period(). The change
+ * becomes effective with the next clock edge, components re-read the period via their scc::clock_domain_ref.
  */
 struct sc_clock_ext : public sc_core::sc_clock {
 
@@ -41,13 +45,25 @@ struct sc_clock_ext : public sc_core::sc_clock {
     , initial_delay("start_time", start_time_)
     {
         add_attribute(initial_delay);
+        domain = clock_domain::add(this, period_);
+    }
+    /**
+     * change the period of the clock and its domain
+     *
+     * @param new_period the new period
+     */
+    void set_period(sc_core::sc_time const& new_period) {
+        period.value = new_period;
+        init(new_period, duty_cycle.value, m_start_time, m_posedge_first);
+        domain->set_period(new_period);
     }
 
-    virtual ~sc_clock_ext() = default;
+    virtual ~sc_clock_ext() { clock_domain::remove(this); }
 
 protected:
     void end_of_elaboration() override {
         init(period.value, duty_cycle.value, initial_delay.value, m_posedge_first);
+        domain->set_period(period.value);
         if(initial_delay.value!=m_start_time) {
             if( m_posedge_first ) {
                 m_next_posedge_event.cancel();
@@ -58,6 +74,9 @@ protected:
             }
         }
     }
+
+private:
+    clock_domain* domain{nullptr};
 };
 }
 /** @} */ // end of scc-sysc
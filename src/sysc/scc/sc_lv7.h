@@ -0,0 +1,278 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_SC_LV7_H_
+#define _SCC_SC_LV7_H_
+
+#include "sc_logic_7.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <systemc>
+#include <vector>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+namespace dt {
+//! the interface of trace files being able to record sc_lv7 vectors (e.g. scc::fst_trace_file)
+struct sc_lv7_trace_if {
+    /**
+     * @brief trace a vector given by its bit planes
+     *
+     * @param planes the 3 bit planes of (width + 63) / 64 words each, they need to stay valid while tracing
+     * @param width the number of values
+     * @param name the name of the trace
+     */
+    virtual void trace_lv7(uint64_t const* planes, unsigned width, std::string const& name) = 0;
+
+protected:
+    virtual ~sc_lv7_trace_if() = default;
+};
+
+namespace detail {
+/**
+ * the strengths driven onto the 64 values of a word. Resolving several drivers is ORing their strengths, the result
+ * is encoded back into the bit planes of a sc_lv7 (a conflict of two weak values resolves to X as there is no W).
+ */
+struct lv7_drive {
+    uint64_t s0{0}, s1{0}, w0{0}, w1{0}, u{0};
+    //! add a driver given by the 3 bit planes of its value codes (see sc_logic_7_value_t)
+    void add(uint64_t b0, uint64_t b1, uint64_t b2) {
+        s0 |= ~b1 & ~(b2 ^ b0); // 0 and X
+        s1 |= ~b1 & b0;         // 1 and X
+        w0 |= ~b2 & b1 & ~b0;   // L
+        w1 |= ~b2 & b1 & b0;    // H
+        u |= b2 & b1;           // U
+    }
+    //! get the bit planes of the resolved values
+    void get(uint64_t& b0, uint64_t& b1, uint64_t& b2) const {
+        auto strong = s0 | s1;
+        b0 = ~u & (s1 | (~strong & w1));
+        b1 = u | (~strong & (w0 ^ w1));
+        b2 = u | (s0 & s1) | (~strong & ~(w0 ^ w1));
+    }
+};
+} // namespace detail
+/**
+ * @brief a vector of N 7-valued logic values (see sc_logic_7)
+ *
+ * The values are stored as 3 bit planes, the bits of plane p hold bit p of the sc_logic_7_value_t of each value.
+ * Resolution of several drivers and comparison are done 64 values at a time using bitwise operations on the words of
+ * the planes. Bit 0 is the least significant value, strings are written and read most significant value first.
+ *
+ * @tparam N the number of values
+ */
+template <unsigned N> class sc_lv7 {
+    static_assert(N > 0, "sc_lv7 needs at least one value");
+
+public:
+    //! the number of words of each bit plane
+    static constexpr unsigned words = (N + 63) / 64;
+    //! constructs a vector with all values being U
+    sc_lv7() { fill(Log_U); }
+    //! constructs a vector with all values being v
+    explicit sc_lv7(sc_logic_7 const& v) { fill(v.value()); }
+    //! constructs a vector from a string of the characters 0, 1, L, H, Z, X and U, missing values are 0
+    explicit sc_lv7(std::string const& str) { *this = str; }
+
+    explicit sc_lv7(char const* str)
+    : sc_lv7(std::string(str)) {}
+
+    sc_lv7& operator=(std::string const& str) {
+        std::fill(std::begin(planes), std::end(planes), 0);
+        auto len = std::min<size_t>(str.size(), N);
+        for(size_t i = 0; i < len; ++i) {
+            auto c = static_cast<unsigned char>(str[str.size() - 1 - i]);
+            set_code(i, c < sc_logic_7::char_to_logic.size() ? sc_logic_7::char_to_logic[c] : Log_X);
+        }
+        return *this;
+    }
+    //! the number of values
+    static constexpr unsigned length() { return N; }
+
+    sc_logic_7 get_bit(unsigned i) const {
+        auto v = get_code(i);
+        // the constructor of sc_logic_7 rejects U
+        return v == Log_U ? sc_logic_7() : sc_logic_7(v);
+    }
+
+    void set_bit(unsigned i, sc_logic_7 const& v) { set_code(i, v.value()); }
+
+    sc_logic_7 operator[](unsigned i) const { return get_bit(i); }
+    //! resolve the value with the one of another driver
+    sc_lv7& resolve(sc_lv7 const& o) {
+        for(unsigned w = 0; w < words; ++w) {
+            detail::lv7_drive d;
+            d.add(planes[w], planes[words + w], planes[2 * words + w]);
+            d.add(o.planes[w], o.planes[words + w], o.planes[2 * words + w]);
+            d.get(planes[w], planes[words + w], planes[2 * words + w]);
+        }
+        return *this;
+    }
+    /**
+     * @brief resolve the values of several drivers, no driver resolves to all Z
+     *
+     * @param begin the iterator to the first driver, dereferencing it yields a (pointer to a) sc_lv7
+     * @param end the iterator behind the last driver
+     * @return the resolved value
+     */
+    template <typename IT> static sc_lv7 resolve(IT begin, IT end) {
+        sc_lv7 res;
+        for(unsigned w = 0; w < words; ++w) {
+            detail::lv7_drive d;
+            for(auto it = begin; it != end; ++it) {
+                sc_lv7 const& v = deref(*it);
+                d.add(v.planes[w], v.planes[words + w], v.planes[2 * words + w]);
+            }
+            d.get(res.planes[w], res.planes[words + w], res.planes[2 * words + w]);
+        }
+        res.planes[words - 1] &= last_mask();
+        res.planes[2 * words - 1] &= last_mask();
+        res.planes[3 * words - 1] &= last_mask();
+        return res;
+    }
+    //! check if all values are 0 or 1
+    bool is_01() const {
+        for(unsigned w = words; w < 3 * words; ++w)
+            if(planes[w])
+                return false;
+        return true;
+    }
+    //! get the least significant 64 values as integer, only meaningful if is_01() is true
+    uint64_t to_uint64() const { return planes[0]; }
+
+    std::string to_string() const {
+        std::string res(N, '0');
+        for(unsigned i = 0; i < N; ++i)
+            res[N - 1 - i] = sc_logic_7::logic_to_char[get_code(i)];
+        return res;
+    }
+    //! the bit planes, 3 * words words, e.g. for tracing
+    uint64_t const* data() const { return planes; }
+
+    bool operator==(sc_lv7 const& o) const {
+        uint64_t diff = 0;
+        for(unsigned w = 0; w < 3 * words; ++w)
+            diff |= planes[w] ^ o.planes[w];
+        return diff == 0;
+    }
+
+    bool operator!=(sc_lv7 const& o) const { return !(*this == o); }
+
+private:
+    static constexpr uint64_t last_mask() { return N % 64 ? (uint64_t(1) << (N % 64)) - 1 : ~uint64_t(0); }
+
+    static sc_lv7 const& deref(sc_lv7 const& v) { return v; }
+
+    static sc_lv7 const& deref(sc_lv7 const* v) { return *v; }
+
+    template <typename P> static sc_lv7 const& deref(P const& v) { return *v; }
+
+    void fill(sc_logic_7_value_t v) {
+        for(unsigned p = 0; p < 3; ++p)
+            for(unsigned w = 0; w < words; ++w)
+                planes[p * words + w] = (v >> p) & 1 ? (w == words - 1 ? last_mask() : ~uint64_t(0)) : 0;
+    }
+
+    sc_logic_7_value_t get_code(unsigned i) const {
+        auto w = i / 64;
+        auto s = i % 64;
+        return static_cast<sc_logic_7_value_t>(((planes[w] >> s) & 1) | ((planes[words + w] >> s) & 1) << 1 |
+                                               ((planes[2 * words + w] >> s) & 1) << 2);
+    }
+
+    void set_code(unsigned i, sc_logic_7_value_t v) {
+        auto w = i / 64;
+        auto m = uint64_t(1) << (i % 64);
+        for(unsigned p = 0; p < 3; ++p)
+            planes[p * words + w] = (v >> p) & 1 ? planes[p * words + w] | m : planes[p * words + w] & ~m;
+    }
+
+    uint64_t planes[3 * words];
+};
+
+template <unsigned N> inline std::ostream& operator<<(std::ostream& os, sc_lv7<N> const& v) {
+    return os << v.to_string();
+}
+/**
+ * trace a sc_lv7, this is only supported by trace files implementing sc_lv7_trace_if
+ */
+template <unsigned N> inline void sc_trace(sc_core::sc_trace_file* tf, sc_lv7<N> const& v, std::string const& name) {
+    if(auto* lv7_tf = dynamic_cast<sc_lv7_trace_if*>(tf))
+        lv7_tf->trace_lv7(v.data(), N, name);
+    else if(tf)
+        SC_REPORT_WARNING("scc::dt::sc_lv7", ("the trace file does not support sc_lv7, ignoring " + name).c_str());
+}
+/**
+ * @brief a resolved signal of sc_lv7 values
+ *
+ * Like sc_core::sc_signal_rv each process writing the signal is a driver, its last written value is kept. Upon update
+ * the values of all drivers are resolved word-parallel.
+ *
+ * @tparam N the number of values
+ */
+template <unsigned N> class sc_signal_rv7 : public sc_core::sc_signal<sc_lv7<N>, sc_core::SC_MANY_WRITERS> {
+public:
+    using value_type = sc_lv7<N>;
+    using base_type = sc_core::sc_signal<value_type, sc_core::SC_MANY_WRITERS>;
+
+    sc_signal_rv7()
+    : base_type(sc_core::sc_gen_unique_name("signal_rv7")) {}
+
+    explicit sc_signal_rv7(const char* name)
+    : base_type(name) {}
+
+    void write(value_type const& value) override {
+        auto* cur_proc = sc_core::sc_get_current_process_b();
+        for(size_t i = 0; i < drivers.size(); ++i)
+            if(drivers[i] == cur_proc) {
+                if(*values[i] != value) {
+                    *values[i] = value;
+                    this->request_update();
+                }
+                return;
+            }
+        drivers.push_back(cur_proc);
+        values.emplace_back(new value_type(value));
+        this->request_update();
+    }
+
+    sc_signal_rv7& operator=(value_type const& value) {
+        write(value);
+        return *this;
+    }
+
+    const char* kind() const override { return "sc_signal_rv7"; }
+
+protected:
+    void update() override {
+        this->m_new_val = value_type::resolve(values.begin(), values.end());
+        base_type::update();
+    }
+
+    std::vector<sc_core::sc_process_b*> drivers;
+    std::vector<std::unique_ptr<value_type>> values;
+};
+} // namespace dt
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_SC_LV7_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2020 MINRES Technologies GmbH
+ * Copyright 2020, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,6 +19,10 @@
 
 #include <sysc/communication/sc_signal.h>
 #include <tlm>
+#include <unordered_set>
+#include <util/pool_allocator.h>
+#include <utility>
+#include <vector>
 /** \ingroup scc-sysc
  *  @{
  */
@@ -29,6 +33,13 @@ namespace scc {
  * @class sc_owning_signal
  * @brief sc_signal which takes ownership of the data (acquire()/release())
  *
+ * Objects having a memory manager are acquired when written and released when replaced. Objects without a memory
+ * manager can be obtained from the signal using create(), these are owned by the signal. Once such an object has been
+ * replaced by the update of the signal it is put into a free list of the signal and constructed again in place by the
+ * next call of create(), so streaming data through the signal does not allocate memory in the steady state. The
+ * memory of the owned objects is taken from a util::pool_allocator and returned upon destruction of the signal.
+ * Any pointer to a replaced value becomes invalid at the end of the update phase.
+ *
  * @tparam T
  * @tparam POL
  */
@@ -49,7 +60,41 @@ public: // constructors and destructor:
     sc_owning_signal(const char* name_, T* initial_value_)
     : sc_core::sc_signal<T*, POL>(name_, initial_value_) {}
 
-    virtual ~sc_owning_signal() {}
+    virtual ~sc_owning_signal() {
+        for(auto* p : owned) {
+            p->~T();
+            pool_type::get().free(p);
+        }
+    }
+    /**
+     * @brief get an object owned by the signal to be written to it
+     *
+     * The object is constructed using args, either in the memory of a recycled object, which is destructed before, or
+     * in memory taken from the pool.
+     *
+     * @param args the arguments of the constructor of T
+     * @return the object
+     */
+    template <typename... Args> T* create(Args&&... args) {
+        if(!free_objs.empty()) {
+            auto* p = free_objs.back();
+            free_objs.pop_back();
+            p->~T();
+            try {
+                return new(p) T(std::forward<Args>(args)...);
+            } catch(...) {
+                // the memory does not hold an object anymore
+                owned.erase(p);
+                pool_type::get().free(p);
+                throw;
+            }
+        }
+        auto* p = new(pool_type::get().allocate(0, false)) T(std::forward<Args>(args)...);
+        owned.insert(p);
+        return p;
+    }
+    //! the number of objects owned by the signal, used or free
+    size_t owned_count() const { return owned.size(); }
 
     // write the new value
     void write(const type& value_) override {
@@ -57,17 +102,21 @@ public: // constructors and destructor:
         if(!policy_type::check_write(this, value_changed))
             return;
         // release a potentially previosu written value
-        if(super::m_new_val && super::m_new_val != super::m_cur_val && super::m_new_val->has_mm())
-            super::m_new_val->release();
-        super::m_new_val = value_;
-        // acquire the scheduled value
-        if(super::m_new_val && super::m_new_val->has_mm())
-            super::m_new_val->acquire();
+        if(super::m_new_val != value_) {
+            if(super::m_new_val && super::m_new_val != super::m_cur_val)
+                dispose(super::m_new_val);
+            super::m_new_val = value_;
+            // acquire the scheduled value
+            if(super::m_new_val && super::m_new_val->has_mm())
+                super::m_new_val->acquire();
+        }
         if(value_changed)
             super::request_update();
     }
 
     void clear() {
+        if(super::m_new_val && super::m_new_val != super::m_cur_val)
+            dispose(super::m_new_val);
         super::m_new_val = nullptr;
         if(super::m_new_val != super::m_cur_val)
             super::request_update();
@@ -78,11 +127,25 @@ public: // constructors and destructor:
 protected:
     void update() override {
         if(!(super::m_new_val == super::m_cur_val)) {
-            if(super::m_cur_val && super::m_cur_val->has_mm())
-                super::m_cur_val->release();
+            if(super::m_cur_val)
+                dispose(super::m_cur_val);
             super::update();
         }
     }
+
+private:
+    static_assert(alignof(T) <= alignof(void*), "the pool does not provide the required alignment");
+    using pool_type = util::pool_allocator<sizeof(T)>;
+    //! release an object being replaced, objects owned by the signal are recycled
+    void dispose(T* p) {
+        if(p->has_mm())
+            p->release();
+        else if(!owned.empty() && owned.count(p))
+            free_objs.push_back(p);
+    }
+
+    std::unordered_set<T*> owned;
+    std::vector<T*> free_objs;
 };
 
 } // namespace scc
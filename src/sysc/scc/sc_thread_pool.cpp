@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -14,6 +14,7 @@
  * limitations under the License.
  *******************************************************************************/
 
+#include <algorithm>
 #include <functional>
 #include <ostream>
 
@@ -25,27 +26,63 @@
 namespace scc {
 
 sc_thread_pool::sc_thread_pool()
-: sc_core::sc_object(sc_core::sc_gen_unique_name("pool")) {}
+: sc_core::sc_prim_channel(sc_core::sc_gen_unique_name("pool")) {}
 
 sc_thread_pool::~sc_thread_pool() = default;
 
-void sc_thread_pool::execute(std::function<void(void)> fct) {
+void sc_thread_pool::end_of_elaboration() {
+    auto cnt = std::min(prespawned_threads.get_value(), max_concurrent_threads.get_value());
+    while(thread_active < cnt)
+        spawn_thread();
+}
+
+void sc_thread_pool::spawn_thread() {
+    sc_core::sc_spawn_options opts;
+    opts.set_stack_size(thread_stack_size.get_value());
+    // a new thread counts as idle right away so that tasks queued before it starts do not spawn further threads
+    thread_active++;
+    thread_avail++;
+    sc_core::sc_spawn(
+        [this]() {
+            while(true) {
+                auto fct = dispatch_queue.get();
+                sc_assert(thread_avail > 0 && tasks_queued > 0);
+                thread_avail--;
+                tasks_queued--;
+                fct();
+                thread_avail++;
+            }
+        },
+        nullptr, &opts);
+}
+
+void sc_thread_pool::spawn_method() {
     sc_core::sc_spawn_options opts;
-    opts.set_stack_size(0x10000);
-    if(thread_avail == 0 && thread_active < max_concurrent_threads.get_value())
-        sc_core::sc_spawn(
-            [this]() {
-                thread_active++;
-                while(true) {
-                    thread_avail++;
-                    auto fct = dispatch_queue.get();
-                    sc_assert(thread_avail > 0);
-                    thread_avail--;
-                    fct();
-                }
-            },
-            nullptr, &opts);
-    dispatch_queue.notify(fct);
+    opts.spawn_method();
+    opts.set_sensitivity(&method_queue.event());
+    opts.dont_initialize();
+    sc_core::sc_spawn(
+        [this]() {
+            // take the due tasks first so that tasks being queued by them are executed in the next delta cycle
+            for(auto& fct : method_queue.get_all())
+                fct();
+        },
+        nullptr, &opts);
+    method_spawned = true;
+}
+
+void sc_thread_pool::execute(std::function<void(void)> fct) {
+    // all idle threads are already claimed by queued tasks
+    if(tasks_queued >= thread_avail && thread_active < max_concurrent_threads.get_value())
+        spawn_thread();
+    tasks_queued++;
+    dispatch_queue.notify(std::move(fct));
+}
+
+void sc_thread_pool::execute_nowait(std::function<void(void)> fct) {
+    if(!method_spawned)
+        spawn_method();
+    method_queue.notify(std::move(fct));
 }
 
 } /* namespace scc */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -28,18 +28,51 @@
 //! @brief SCC SystemC utilities
 namespace scc {
 
-class sc_thread_pool : sc_core::sc_object {
+/**
+ * @class sc_thread_pool
+ * @brief a pool of reusable SC_THREADs executing tasks
+ *
+ * execute() hands a task to an idle thread of the pool, new threads are spawned on demand up to
+ * max_concurrent_threads. Using prespawned_threads the pool creates this number of threads at end_of_elaboration
+ * instead of creating them during simulation. Tasks which never call wait() should use execute_nowait(), they are
+ * executed by a single SC_METHOD in the next delta cycle which avoids the thread context switches altogether.
+ */
+class sc_thread_pool : sc_core::sc_prim_channel {
 public:
     sc_thread_pool();
     virtual ~sc_thread_pool();
-
+    /**
+     * @fn void execute(std::function<void(void)>)
+     * @brief execute a task in a thread of the pool, the task may call wait()
+     *
+     * @param fct the task
+     */
     void execute(std::function<void(void)> fct);
+    /**
+     * @fn void execute_nowait(std::function<void(void)>)
+     * @brief execute a task which must not call wait() in the method process of the pool
+     *
+     * @param fct the task
+     */
+    void execute_nowait(std::function<void(void)> fct);
 
     cci::cci_param<unsigned> max_concurrent_threads{"max_concurrent_threads", 16};
 
+    cci::cci_param<unsigned> prespawned_threads{"prespawned_threads", 0};
+
+    cci::cci_param<size_t> thread_stack_size{"thread_stack_size", 0x10000};
+
 private:
+    void end_of_elaboration() override;
+
+    void spawn_thread();
+
+    void spawn_method();
+
     scc::peq<std::function<void(void)>> dispatch_queue{"dispatch_queue"};
-    unsigned thread_avail{0}, thread_active{0};
+    scc::peq<std::function<void(void)>> method_queue{"method_queue"};
+    unsigned thread_avail{0}, thread_active{0}, tasks_queued{0};
+    bool method_spawned{false};
 };
 } /* namespace scc */
 /** @} */ // end of scc-sysc
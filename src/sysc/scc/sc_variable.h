@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2019 MINRES Technologies GmbH
+ * Copyright 2019, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,7 +17,10 @@
 #ifndef _SCC_SC_VARIABLE_H_
 #define _SCC_SC_VARIABLE_H_
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cassert>
 #include <functional>
 #include "observer.h"
 #include "report.h"
@@ -25,6 +28,8 @@
 #include <sysc/kernel/sc_event.h>
 #include <sysc/kernel/sc_simcontext.h>
 #include <sysc/tracing/sc_trace.h>
+#include <type_traits>
+#include <vector>
 
 #ifndef SC_API
 #define SC_API
@@ -68,10 +73,23 @@ struct sc_variable_b : sc_core::sc_object {
      * @return
      */
     virtual std::string to_string() const { return ""; };
+    /**
+     * @fn bool from_string(const std::string&)
+     * @brief set the value from its textual representation as created by to_string(), e.g. to restore a checkpoint
+     *
+     * @param str the textual representation
+     * @return false if the value cannot be set from a string
+     */
+    virtual bool from_string(std::string const& str) { return false; }
 
     virtual void trace(observer* obs) const = 0;
 
 };
+namespace detail {
+template <typename T, typename = void> struct is_extractable : std::false_type {};
+template <typename T>
+struct is_extractable<T, decltype(void(std::declval<std::istream&>() >> std::declval<T&>()))> : std::true_type {};
+} // namespace detail
 /**
  * @struct sc_variable
  * @brief the sc_variable for a particular plain data type
@@ -111,6 +129,16 @@ template <typename T> struct sc_variable : public sc_variable_b {
         ss << value;
         return ss.str();
     }
+    /**
+     * @fn bool from_string(const std::string&)
+     * @brief set the value from its textual representation if T can be read from a stream
+     *
+     * @param str the textual representation
+     * @return true if the value could be set
+     */
+    bool from_string(std::string const& str) override {
+        return from_string(str, detail::is_extractable<T>());
+    }
     /**
      * @brief value getter
      *
@@ -267,6 +295,16 @@ template <typename T> struct sc_variable : public sc_variable_b {
     };
 
 private:
+    bool from_string(std::string const& str, std::true_type) {
+        std::istringstream is(str);
+        T v;
+        if(!(is >> v))
+            return false;
+        *this = v;
+        return true;
+    }
+
+    bool from_string(std::string const&, std::false_type) { return false; }
     //! the wrapped value
     T value;
     //! the observer handle
@@ -297,6 +335,12 @@ template <> struct sc_variable<bool> : public sc_variable_b {
         ss << value;
         return ss.str();
     }
+    bool from_string(std::string const& str) override {
+        if(str != "0" && str != "1")
+            return false;
+        *this = str == "1";
+        return true;
+    }
     bool get() const { return value; }
     operator bool() const { return value; }
     sc_variable& operator=(const bool other) {
@@ -412,6 +456,187 @@ private:
     std::vector<sc_variable<T>*> values;
     std::function<sc_variable<T>*(char const*, size_t)> creator;
 };
+/**
+ * @struct sc_variable_array
+ * @brief an array of plain data type values being visible as a single sc_object
+ *
+ * In contrast to sc_variable_vector, which creates a sc_variable (and hence a sc_object) per element, the values are
+ * kept in one contiguous array and only the array is registered in the object hierarchy. This keeps large arrays of
+ * statistics (e.g. per ID counters or histograms) cheap to elaborate and to update. The elements are accessed using
+ * views returned by operator[], several or all elements can be changed at once using update().
+ *
+ * When traced each element is traced as <name>(<index>). Observing trace files are notified per changed element,
+ * other trace files sample the values at the end of each timestep.
+ *
+ * @note the size of the array is fixed upon construction
+ *
+ * @tparam T the data type of the elements
+ */
+template <typename T> struct sc_variable_array : public sc_variable_b {
+    //! a view of an element, changing it notifies the observers of this element
+    struct reference {
+        operator T() const { return owner.values[idx]; }
+
+        reference& operator=(T const& v) {
+            owner.values[idx] = v;
+            owner.notify(idx);
+            return *this;
+        }
+
+        reference& operator=(reference const& o) { return *this = static_cast<T>(o); }
+
+        reference& operator++() {
+            ++owner.values[idx];
+            owner.notify(idx);
+            return *this;
+        }
+
+        T operator++(int) {
+            auto orig = owner.values[idx]++;
+            owner.notify(idx);
+            return orig;
+        }
+
+        reference& operator--() {
+            --owner.values[idx];
+            owner.notify(idx);
+            return *this;
+        }
+
+        T operator--(int) {
+            auto orig = owner.values[idx]--;
+            owner.notify(idx);
+            return orig;
+        }
+
+        reference& operator+=(T const& v) {
+            owner.values[idx] += v;
+            owner.notify(idx);
+            return *this;
+        }
+
+        reference& operator-=(T const& v) {
+            owner.values[idx] -= v;
+            owner.notify(idx);
+            return *this;
+        }
+
+    private:
+        friend struct sc_variable_array;
+        reference(sc_variable_array& owner, size_t idx)
+        : owner(owner)
+        , idx(idx) {}
+        sc_variable_array& owner;
+        const size_t idx;
+    };
+    /**
+     * @fn  sc_variable_array(const std::string&, size_t, const T&)
+     * @brief constructor taking a name, the number of elements and their initial value
+     *
+     * @param name the name
+     * @param size the number of elements
+     * @param def_val the initial value of the elements
+     */
+    sc_variable_array(const std::string& name, size_t size, const T& def_val = T{})
+    : sc_variable_b(name.c_str())
+    , values(size, def_val) {}
+
+    virtual ~sc_variable_array() = default;
+
+    size_t size() const { return values.size(); }
+
+    reference operator[](size_t idx) {
+        assert(idx < values.size());
+        return reference(*this, idx);
+    }
+
+    T const& operator[](size_t idx) const { return values[idx]; }
+    //! the contiguous storage of the elements
+    T const* data() const { return values.data(); }
+    /**
+     * @brief change several elements at once, the observers are notified once per element afterwards
+     *
+     * @param func the function being called with a pointer to the elements and their number
+     */
+    template <typename F> void update(F&& func) {
+        func(values.data(), values.size());
+        if(hndl.size())
+            for(size_t i = 0; i < values.size(); ++i)
+                notify(i);
+    }
+    //! set all elements to v
+    void fill(T const& v) {
+        update([&v](T* data, size_t size) { std::fill(data, data + size, v); });
+    }
+    /**
+     * @fn std::string to_string()const
+     * @brief create a textual representation of the values, they are separated by a space
+     *
+     * @return the string representing the values
+     */
+    std::string to_string() const override {
+        std::stringstream ss;
+        for(size_t i = 0; i < values.size(); ++i)
+            ss << (i ? " " : "") << values[i];
+        return ss.str();
+    }
+    /**
+     * @fn bool from_string(const std::string&)
+     * @brief set the values from a textual representation as created by to_string() if T can be read from a stream
+     *
+     * @param str the textual representation
+     * @return true if all values could be set
+     */
+    bool from_string(std::string const& str) override { return from_string(str, detail::is_extractable<T>()); }
+    /**
+     * @fn void trace(sc_core::sc_trace_file*)const
+     * @brief register the elements with the SystemC trace implementation
+     *
+     * @param tf
+     */
+    void trace(sc_core::sc_trace_file* tf) const override {
+        if(auto* obs = dynamic_cast<observer*>(tf))
+            trace(obs);
+        else
+            for(size_t i = 0; i < values.size(); ++i)
+                sc_core::sc_trace(tf, values[i], element_name(i));
+    }
+
+    void trace(observer* obs) const override {
+        hndl.emplace_back(values.size(), nullptr);
+        for(size_t i = 0; i < values.size(); ++i)
+            hndl.back()[i] = observe(obs, values[i], element_name(i));
+    }
+
+private:
+    std::string element_name(size_t idx) const {
+        std::ostringstream os;
+        os << name() << "(" << idx << ")";
+        return os.str();
+    }
+
+    void notify(size_t idx) {
+        for(auto& h : hndl)
+            if(h[idx])
+                h[idx]->notify();
+    }
+
+    bool from_string(std::string const& str, std::true_type) {
+        std::istringstream is(str);
+        std::vector<T> v(values.size());
+        for(auto& e : v)
+            if(!(is >> e))
+                return false;
+        update([&v](T* data, size_t size) { std::copy(v.begin(), v.end(), data); });
+        return true;
+    }
+
+    bool from_string(std::string const&, std::false_type) { return false; }
+    //! the values
+    std::vector<T> values;
+    //! the observer handles, one vector of handles per observing trace file
+    mutable std::vector<std::vector<observer::notification_handle*>> hndl;
+};
 /**
  * @struct sc_ref_variable
  * @brief the sc_ref_variable for a particular plain data type. This marks an existing C++
@@ -478,6 +703,29 @@ template <> struct sc_ref_variable<sc_core::sc_event> : public sc_variable_b {
 
     void trace(sc_core::sc_trace_file* tf) const override { sc_core::sc_trace(tf, value, name()); }
 };
+/**
+ * the sc_ref_variable of an atomic, e.g. of a counter updated by several threads. Tracing reads the value like a
+ * plain T, which requires the atomic to have the layout of T.
+ */
+template <typename T> struct sc_ref_variable<std::atomic<T>> : public sc_variable_b {
+    const std::atomic<T>& value;
+    T operator*() { return value.load(std::memory_order_relaxed); }
+    sc_ref_variable(const std::string& name, const std::atomic<T>& value)
+    : sc_variable_b(name.c_str())
+    , value(value) {}
+    std::string to_string() const override {
+        std::stringstream ss;
+        ss << value.load(std::memory_order_relaxed);
+        return ss.str();
+    }
+
+    void trace(observer* obs) const override {}
+
+    void trace(sc_core::sc_trace_file* tf) const override {
+        static_assert(sizeof(std::atomic<T>) == sizeof(T), "the atomic needs to have the layout of the value");
+        sc_core::sc_trace(tf, *reinterpret_cast<const T*>(&value), name());
+    }
+};
 /**
  * @struct sc_ref_variable_masked
  * @brief the sc_variable for a particular plain data type with limited bit width
@@ -517,6 +765,11 @@ template <class T> inline void sc_trace(sc_trace_file* tf, const ::scc::sc_varia
     object->trace(tf);
 }
 
+template <class T>
+inline void sc_trace(sc_trace_file* tf, const ::scc::sc_variable_array<T>& object, const char* name) {
+    object.trace(tf);
+}
+
 template <class T> inline void sc_trace(sc_trace_file* tf, const ::scc::sc_ref_variable<T>& object, const char* name) {
     object.trace(tf);
 }
@@ -0,0 +1,178 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_SCV_ATTRIBUTE_SCHEMA_H_
+#define _SCC_SCV_ATTRIBUTE_SCHEMA_H_
+
+#ifdef HAS_SCV
+#include <scv.h>
+#ifndef SCVNS
+#define SCVNS
+#endif
+#else
+#include <scv-tr.h>
+#ifndef SCVNS
+#define SCVNS ::scv_tr::
+#endif
+#endif
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace scc {
+/**
+ * @brief the flattened attribute layout of an scv_extensions_if
+ *
+ * The layout of the begin and end attributes of a generator is fixed by its type, so the attribute names and the
+ * position of the leaves in the extension tree can be determined once when the generator is created. Recording a
+ * transaction then only needs to resolve the leaves instead of walking the tree and composing the names again.
+ * Records and arrays are flattened. Pointers are either leaves themselves or, if follow_pointers is set, make the
+ * layout depend on the value so such a schema is not cacheable.
+ */
+class attribute_schema {
+public:
+    struct attribute {
+        //! the name as composed by attribute_schema::get_name()
+        std::string name;
+        //! the field or array element indices leading from the root to the leaf
+        std::vector<int> path;
+    };
+
+    attribute_schema() = default;
+    /**
+     * @brief flatten an extension
+     *
+     * @param prefix the attribute name of the generator
+     * @param exts the extension of the generator, may be nullptr
+     * @param follow_pointers true if the backend records the pointee instead of the pointer
+     */
+    attribute_schema(char const* prefix, const SCVNS scv_extensions_if* exts, bool follow_pointers)
+    : cacheable(exts != nullptr) {
+        std::vector<int> path;
+        if(exts)
+            build(prefix ? prefix : "", exts, follow_pointers, path);
+    }
+    //! true if the layout does not depend on the values
+    bool is_cacheable() const { return cacheable; }
+    //! the attributes in the order of a recursive walk
+    std::vector<attribute> const& get_attributes() const { return attributes; }
+    /**
+     * @brief visit the leaves of an extension having the layout of this schema
+     *
+     * @param exts the extension of a transaction
+     * @param visit called with the attribute name and the leaf extension
+     */
+    template <typename F> void for_each(const SCVNS scv_extensions_if* exts, F visit) const {
+        for(auto& attr : attributes) {
+            auto* leaf = exts;
+            for(auto idx = attr.path.begin(); leaf && idx != attr.path.end(); ++idx)
+                leaf = leaf->get_type() == SCVNS scv_extensions_if::RECORD
+                           ? (*idx < leaf->get_num_fields() ? leaf->get_field(*idx) : nullptr)
+                           : (*idx < leaf->get_array_size() ? leaf->get_array_elt(*idx) : nullptr);
+            if(leaf)
+                visit(attr.name, leaf);
+        }
+    }
+    /**
+     * @brief compose the name of an attribute the way the SCV text recorder does
+     *
+     * @param prefix the prefix, e.g. the attribute name of the generator
+     * @param exts the extension being recorded
+     * @return the name
+     */
+    static std::string get_name(char const* prefix, const SCVNS scv_extensions_if* exts) {
+        std::string name;
+        if(!prefix || strlen(prefix) == 0) {
+            name = exts->get_name() ? exts->get_name() : "";
+        } else if(exts->get_name() == nullptr || strlen(exts->get_name()) == 0) {
+            name = prefix;
+        } else {
+            name = std::string(prefix) + "." + exts->get_name();
+        }
+        return name.empty() ? "<unnamed>" : name;
+    }
+
+private:
+    void build(std::string const& prefix, const SCVNS scv_extensions_if* exts, bool follow_pointers,
+               std::vector<int>& path) {
+        switch(exts->get_type()) {
+        case SCVNS scv_extensions_if::RECORD:
+            for(int i = 0; i < exts->get_num_fields(); ++i) {
+                path.push_back(i);
+                build(prefix, exts->get_field(i), follow_pointers, path);
+                path.pop_back();
+            }
+            break;
+        case SCVNS scv_extensions_if::ARRAY:
+            for(int i = 0; i < exts->get_array_size(); ++i) {
+                path.push_back(i);
+                build(prefix, exts->get_array_elt(i), follow_pointers, path);
+                path.pop_back();
+            }
+            break;
+        case SCVNS scv_extensions_if::POINTER:
+            if(follow_pointers) {
+                cacheable = false;
+                break;
+            }
+            // fall-through
+        default:
+            attributes.push_back({get_name(prefix.c_str(), exts), path});
+        }
+    }
+
+    bool cacheable{false};
+    std::vector<attribute> attributes;
+};
+/**
+ * @brief the attribute schemas of the generators of a database, keyed by the generator id
+ */
+class attribute_schema_cache {
+public:
+    explicit attribute_schema_cache(bool follow_pointers)
+    : follow_pointers(follow_pointers) {}
+    //! add the schemas of a newly created generator
+    void add(const SCVNS scv_tr_generator_base& g) {
+        auto& e = schemas[g.get_id()];
+        e.begin = attribute_schema(g.get_begin_attribute_name(), g.get_begin_exts_p(), follow_pointers);
+        e.end = attribute_schema(g.get_end_attribute_name(), g.get_end_exts_p(), follow_pointers);
+    }
+    /**
+     * @brief get the schema of the begin or end attributes of a generator
+     *
+     * @return the schema or nullptr if there is none being cacheable
+     */
+    attribute_schema const* find(uint64_t generator, bool end) const {
+        auto it = schemas.find(generator);
+        if(it == schemas.end())
+            return nullptr;
+        auto& s = end ? it->second.end : it->second.begin;
+        return s.is_cacheable() ? &s : nullptr;
+    }
+
+    void clear() { schemas.clear(); }
+
+private:
+    struct entry {
+        attribute_schema begin, end;
+    };
+    bool const follow_pointers;
+    std::unordered_map<uint64_t, entry> schemas;
+};
+} // namespace scc
+#endif /* _SCC_SCV_ATTRIBUTE_SCHEMA_H_ */
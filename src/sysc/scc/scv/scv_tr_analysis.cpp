@@ -0,0 +1,254 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+#include "scv_tr_dispatcher.h"
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <rapidjson/ostreamwrapper.h>
+#include <rapidjson/prettywriter.h>
+#include <stdexcept>
+#include <string>
+#include <systemc>
+#include <util/hdr_histogram.h>
+#include <util/open_addressing_map.h>
+#include <vector>
+// ----------------------------------------------------------------------------
+namespace {
+using namespace rapidjson;
+using writer_type = PrettyWriter<OStreamWrapper>;
+//! the latency percentiles being reported
+const std::pair<char const*, double> percentiles[] = {{"p50", 50.}, {"p90", 90.}, {"p99", 99.}, {"p99_9", 99.9}};
+/**
+ * the statistics of a stream, i.e. of one kind of accesses of a socket. The memory does not depend on the number of
+ * transactions.
+ */
+struct stream_stats {
+    std::string name;
+    std::string kind;
+    //! the latency of the transactions, the time between begin and end
+    util::hdr_histogram<> latency;
+    //! the number of bytes transferred per time window
+    util::hdr_histogram<> window_bytes;
+    uint64_t outstanding{0};
+    uint64_t max_outstanding{0};
+    //! the integral of the outstanding transactions over time to get the average
+    double outstanding_area{0};
+    uint64_t last_change{0};
+    uint64_t first_time{std::numeric_limits<uint64_t>::max()};
+    uint64_t last_time{0};
+    uint64_t bytes{0};
+    uint64_t window{0};
+    uint64_t bytes_in_window{0};
+
+    void update_outstanding(uint64_t time, bool inc) {
+        outstanding_area += static_cast<double>(outstanding) * (time - last_change);
+        last_change = time;
+        if(inc) {
+            ++outstanding;
+            max_outstanding = std::max(max_outstanding, outstanding);
+        } else if(outstanding)
+            --outstanding;
+        first_time = std::min(first_time, time);
+        last_time = std::max(last_time, time);
+    }
+    //! close the last window and the integral of the outstanding transactions
+    void finish() {
+        if(bytes_in_window)
+            window_bytes.add(bytes_in_window);
+        bytes_in_window = 0;
+        outstanding_area += static_cast<double>(outstanding) * (last_time - last_change);
+        last_change = last_time;
+    }
+    //! account the bytes of a transaction ending at time, the windows passed without any access count as 0
+    void add_bytes(uint64_t time, uint64_t window_len, uint64_t count) {
+        auto idx = time / window_len;
+        if(idx != window) {
+            if(bytes || bytes_in_window)
+                window_bytes.add(bytes_in_window);
+            if(bytes && idx > window + 1)
+                window_bytes.add(0, idx - window - 1);
+            window = idx;
+            bytes_in_window = 0;
+        }
+        bytes += count;
+        bytes_in_window += count;
+    }
+};
+//! a transaction being open
+struct open_tx {
+    size_t stream{0};
+    uint64_t begin{0};
+    uint64_t bytes{0};
+};
+
+class analysis_backend : public scc::tx::backend {
+public:
+    explicit analysis_backend(uint64_t window_ns)
+    : window_ns(window_ns ? window_ns : 1000) {}
+
+    bool open(std::string const& name) override {
+        file_name = name + ".stats.json";
+        tick = sc_core::sc_get_time_resolution().to_seconds();
+        window_len = std::max<uint64_t>(1, static_cast<uint64_t>(window_ns * 1e-9 / tick + 0.5));
+        std::ofstream probe(file_name);
+        return probe.is_open();
+    }
+
+    void close() override {
+        std::ofstream os(file_name);
+        if(!os.is_open())
+            throw std::runtime_error("could not open " + file_name);
+        OStreamWrapper stream(os);
+        writer_type writer(stream);
+        // all times are reported in ns
+        auto ns = tick * 1e9;
+        writer.StartObject();
+        writer.Key("time_unit");
+        writer.String("ns");
+        writer.Key("window");
+        writer.Uint64(window_ns);
+        writer.Key("streams");
+        writer.StartArray();
+        for(auto& s : streams) {
+            if(!s.latency.count() && !s.max_outstanding)
+                continue;
+            s.finish();
+            auto span = s.last_time > s.first_time ? s.last_time - s.first_time : 0;
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(s.name.c_str());
+            writer.Key("kind");
+            writer.String(s.kind.c_str());
+            writer.Key("transactions");
+            writer.Uint64(s.latency.count());
+            writer.Key("latency");
+            writer.StartObject();
+            write_value(writer, "min", s.latency.min() * ns);
+            write_value(writer, "mean", s.latency.mean() * ns);
+            for(auto& p : percentiles)
+                write_value(writer, p.first, s.latency.value_at_percentile(p.second) * ns);
+            write_value(writer, "max", s.latency.max() * ns);
+            writer.EndObject();
+            writer.Key("outstanding");
+            writer.StartObject();
+            writer.Key("max");
+            writer.Uint64(s.max_outstanding);
+            write_value(writer, "mean", span ? s.outstanding_area / span : 0.);
+            writer.Key("open_at_end");
+            writer.Uint64(s.outstanding);
+            writer.EndObject();
+            writer.Key("bytes");
+            writer.StartObject();
+            writer.Key("total");
+            writer.Uint64(s.bytes);
+            write_value(writer, "bandwidth_MBps", span ? s.bytes / (span * tick) / 1e6 : 0.);
+            writer.Key("per_window");
+            writer.StartObject();
+            write_value(writer, "mean", s.window_bytes.mean());
+            writer.Key("p50");
+            writer.Uint64(s.window_bytes.value_at_percentile(50));
+            writer.Key("p99");
+            writer.Uint64(s.window_bytes.value_at_percentile(99));
+            writer.Key("max");
+            writer.Uint64(s.window_bytes.max());
+            writer.EndObject();
+            writer.EndObject();
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+        os << std::endl;
+        open_txs.clear();
+    }
+
+    void stream(uint64_t id, std::string const& name, std::string const& kind) override {
+        stream_index[id + 1] = streams.size();
+        streams.emplace_back();
+        streams.back().name = name;
+        streams.back().kind = kind;
+    }
+
+    void generator(uint64_t, std::string const&, uint64_t, std::vector<scc::tx::attribute_desc> const&) override {}
+
+    void begin_transaction(uint64_t id, uint64_t, uint64_t stream, uint64_t time) override {
+        auto* idx = stream_index.find(stream + 1);
+        if(!idx)
+            return;
+        auto& tx = open_txs[id + 1];
+        tx.stream = *idx;
+        tx.begin = time;
+        tx.bytes = 0;
+        streams[*idx].update_outstanding(time, true);
+    }
+
+    void end_transaction(uint64_t id, uint64_t, uint64_t time) override {
+        open_tx tx;
+        if(!open_txs.take(id + 1, tx))
+            return;
+        auto& s = streams[tx.stream];
+        s.update_outstanding(time, false);
+        s.latency.add(time > tx.begin ? time - tx.begin : 0);
+        s.add_bytes(time, window_len, tx.bytes);
+    }
+
+    void attribute(uint64_t id, scc::tx::event_type, std::string const& name, scc::tx::value const& val) override {
+        static const std::string suffix{"data_length"};
+        if(name.size() < suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix))
+            return;
+        if(auto* tx = open_txs.find(id + 1))
+            tx->bytes = val.type == scc::tx::INTEGER ? static_cast<uint64_t>(val.i) : val.u;
+    }
+
+    void relation(std::string const&, uint64_t, uint64_t) override {}
+
+private:
+    static void write_value(writer_type& writer, char const* key, double value) {
+        writer.Key(key);
+        writer.Double(value);
+    }
+
+    uint64_t const window_ns;
+    std::string file_name;
+    double tick{1e-12};
+    uint64_t window_len{1};
+    std::deque<stream_stats> streams;
+    //! the index into streams keyed by the stream id + 1 as 0 marks empty slots
+    util::open_addressing_map<uint64_t, size_t> stream_index;
+    //! the transactions being open keyed by their id + 1
+    util::open_addressing_map<uint64_t, open_tx> open_txs;
+};
+} // namespace
+// clang-format off
+#ifdef HAS_SCV
+#include <scv.h>
+#else
+#include <scv-tr.h>
+namespace scv_tr {
+#endif
+// clang-format on
+// ----------------------------------------------------------------------------
+void scv_tr_analysis_init(unsigned long window_ns) {
+    scc::tx::dispatcher::get().add(scc::tx::create_analysis_backend(window_ns));
+}
+// ----------------------------------------------------------------------------
+#ifndef HAS_SCV
+}
+#endif
+std::unique_ptr<scc::tx::backend> scc::tx::create_analysis_backend(uint64_t window_ns) {
+    return std::unique_ptr<backend>(new analysis_backend(window_ns));
+}
@@ -13,14 +13,15 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  *******************************************************************************/
+#include "scv_tr_dispatcher.h"
+#include <algorithm>
 #include <array>
 #include <boost/filesystem.hpp>
 #include <cmath>
-#include <cstdio>
 #include <cstring>
 #include <fcntl.h>
 #include <iostream>
-#include <sstream>
+#include <memory>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -310,260 +311,96 @@ struct Database : Base {
     }
 };
 
-vector<vector<uint64_t>*> concurrencyLevel;
-Database* db;
-std::unordered_map<uint64_t, uint64_t> id2offset;
-
-void dbCb(const scv_tr_db& _scv_tr_db, scv_tr_db::callback_reason reason, void* data) {
-    // This is called from the scv_tr_db ctor.
-    static string fName("DEFAULT_scv_tr_sqlite");
-    switch(reason) {
-    case scv_tr_db::CREATE:
-        if((_scv_tr_db.get_name() != nullptr) && (strlen(_scv_tr_db.get_name()) != 0))
-            fName = _scv_tr_db.get_name();
-        try {
-            db = new Database(fName);
-        } catch(...) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't open recording file");
-        }
-        break;
-    case scv_tr_db::DELETE:
-        try {
-            delete db;
-        } catch(...) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't close recording file");
-        }
-        break;
-    default:
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Unknown reason in scv_tr_db callback");
-    }
-}
-// ----------------------------------------------------------------------------
-void streamCb(const scv_tr_stream& s, scv_tr_stream::callback_reason reason, void* data) {
-    if(reason == scv_tr_stream::CREATE) {
-        try {
-            db->writeStream(s.get_id(), s.get_name(), s.get_stream_kind());
-        } catch(std::runtime_error& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create stream");
-        }
-    }
-}
-// ----------------------------------------------------------------------------
-void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, const string& value) {
-    try {
-        db->writeAttribute(id, event, name, type, value);
-    } catch(std::runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
-    }
-}
-// ----------------------------------------------------------------------------
-void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, long long value) {
-    try {
-        db->writeAttribute(id, event, name, type, static_cast<uint64_t>(value));
-    } catch(std::runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
-    }
-}
-// ----------------------------------------------------------------------------
-inline void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, double value) {
-    try {
-        db->writeAttribute(id, event, name, type, value);
-    } catch(std::runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
-    }
-}
-// ----------------------------------------------------------------------------
-void recordAttributes(uint64_t id, EventType eventType, string& prefix, const scv_extensions_if* my_exts_p) {
-    if(my_exts_p == nullptr)
-        return;
-    string name;
-    if(prefix == "") {
-        name = my_exts_p->get_name();
-    } else {
-        if((my_exts_p->get_name() == nullptr) || (strlen(my_exts_p->get_name()) == 0)) {
-            name = prefix;
-        } else {
-            name = prefix + "." + my_exts_p->get_name();
-        }
-    }
-    if(name == "")
-        name = "<unnamed>";
-    switch(my_exts_p->get_type()) {
-    case scv_extensions_if::RECORD: {
-        int num_fields = my_exts_p->get_num_fields();
-        if(num_fields > 0) {
-            for(int field_counter = 0; field_counter < num_fields; field_counter++) {
-                const scv_extensions_if* field_data_p = my_exts_p->get_field(field_counter);
-                recordAttributes(id, eventType, prefix, field_data_p);
-            }
-        }
-    } break;
-    case scv_extensions_if::ENUMERATION:
-        recordAttribute(id, eventType, name, scv_extensions_if::ENUMERATION,
-                        my_exts_p->get_enum_string((int)(my_exts_p->get_integer())));
-        break;
-    case scv_extensions_if::BOOLEAN:
-        recordAttribute(id, eventType, name, scv_extensions_if::BOOLEAN, my_exts_p->get_bool() ? "TRUE" : "FALSE");
-        break;
-    case scv_extensions_if::INTEGER:
-    case scv_extensions_if::FIXED_POINT_INTEGER:
-        recordAttribute(id, eventType, name, scv_extensions_if::INTEGER, my_exts_p->get_integer());
-        break;
-    case scv_extensions_if::UNSIGNED:
-        recordAttribute(id, eventType, name, scv_extensions_if::UNSIGNED, my_exts_p->get_integer());
-        break;
-    case scv_extensions_if::POINTER:
-        recordAttribute(id, eventType, name, scv_extensions_if::POINTER, (long long)my_exts_p->get_pointer());
-        break;
-    case scv_extensions_if::STRING:
-        recordAttribute(id, eventType, name, scv_extensions_if::STRING, my_exts_p->get_string());
-        break;
-    case scv_extensions_if::FLOATING_POINT_NUMBER:
-        recordAttribute(id, eventType, name, scv_extensions_if::FLOATING_POINT_NUMBER, my_exts_p->get_double());
-        break;
-    case scv_extensions_if::BIT_VECTOR: {
-        sc_bv_base tmp_bv(my_exts_p->get_bitwidth());
-        my_exts_p->get_value(tmp_bv);
-        recordAttribute(id, eventType, name, scv_extensions_if::BIT_VECTOR, tmp_bv.to_string());
-    } break;
-    case scv_extensions_if::LOGIC_VECTOR: {
-        sc_lv_base tmp_lv(my_exts_p->get_bitwidth());
-        my_exts_p->get_value(tmp_lv);
-        recordAttribute(id, eventType, name, scv_extensions_if::LOGIC_VECTOR, tmp_lv.to_string());
-    } break;
-    case scv_extensions_if::ARRAY:
-        for(int array_elt_index = 0; array_elt_index < my_exts_p->get_array_size(); array_elt_index++) {
-            const scv_extensions_if* field_data_p = my_exts_p->get_array_elt(array_elt_index);
-            recordAttributes(id, eventType, prefix, field_data_p);
-        }
-        break;
-    default: {
-        std::array<char, 100> tmpString;
-        sprintf(tmpString.data(), "Unsupported attribute type = %d", my_exts_p->get_type());
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, tmpString.data());
-    }
-    }
-}
-// ----------------------------------------------------------------------------
-void generatorCb(const scv_tr_generator_base& g, scv_tr_generator_base::callback_reason reason, void* data) {
-    if(reason == scv_tr_generator_base::CREATE && db) {
-        try {
-            db->writeGenerator(g.get_id(), g.get_name(), g.get_scv_tr_stream().get_id());
-        } catch(std::runtime_error& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create generator entry");
-        }
-    }
-}
-// ----------------------------------------------------------------------------
-void transactionCb(const scv_tr_handle& t, scv_tr_handle::callback_reason reason, void* data) {
-    if(!db)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
-
-    uint64_t id = t.get_id();
-    uint64_t streamId = t.get_scv_tr_stream().get_id();
-    vector<uint64_t>::size_type concurrencyIdx;
-    const scv_extensions_if* my_exts_p;
-    switch(reason) {
-    case scv_tr_handle::BEGIN: {
-        try {
-            if(concurrencyLevel.size() <= streamId)
-                concurrencyLevel.resize(streamId + 1);
-            vector<uint64_t>* levels = concurrencyLevel.at(streamId);
-            if(levels == nullptr) {
-                levels = new vector<uint64_t>();
-                concurrencyLevel[id] = levels;
-            }
-            for(concurrencyIdx = 0; concurrencyIdx < levels->size(); ++concurrencyIdx)
-                if((*levels)[concurrencyIdx] == 0)
-                    break;
-            if(concurrencyIdx == levels->size())
-                levels->push_back(id);
-            else
-                (*levels)[concurrencyIdx] = id;
-            auto offset = db->writeTransaction(id, t.get_scv_tr_generator_base().get_id(), concurrencyIdx);
-            db->writeTxTimepoint(id, BEGIN, t.get_begin_sc_time().value(), offset);
-            id2offset[id] = offset;
-        } catch(std::runtime_error& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, e.what());
-        }
-        my_exts_p = t.get_begin_exts_p();
-        if(my_exts_p == nullptr)
-            my_exts_p = t.get_scv_tr_generator_base().get_begin_exts_p();
-        if(my_exts_p) {
-            string tmp_str = t.get_scv_tr_generator_base().get_begin_attribute_name()
-                                 ? t.get_scv_tr_generator_base().get_begin_attribute_name()
-                                 : "";
-            recordAttributes(id, BEGIN, tmp_str, my_exts_p);
-        }
-    } break;
-    case scv_tr_handle::END: {
-        try {
-            vector<uint64_t>* levels = concurrencyLevel[streamId];
-            for(concurrencyIdx = 0; concurrencyIdx < levels->size(); ++concurrencyIdx)
-                if((*levels)[concurrencyIdx] == id)
-                    break;
-            if(concurrencyIdx == levels->size())
-                levels->push_back(id);
-            else
-                (*levels)[concurrencyIdx] = id;
-            db->writeTxTimepoint(id, END, t.get_begin_sc_time().value(), id2offset[id]);
-            id2offset.erase(id);
-        } catch(std::runtime_error& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create transaction end");
-        }
-        my_exts_p = t.get_end_exts_p();
-        if(my_exts_p == nullptr)
-            my_exts_p = t.get_scv_tr_generator_base().get_end_exts_p();
-        if(my_exts_p) {
-            string tmp_str = t.get_scv_tr_generator_base().get_end_attribute_name()
-                                 ? t.get_scv_tr_generator_base().get_end_attribute_name()
-                                 : "";
-            recordAttributes(t.get_id(), END, tmp_str, my_exts_p);
+//! the database as backend of the scc::tx::dispatcher
+class binary_backend : public scc::tx::backend {
+    struct open_tx {
+        uint64_t offset;
+        uint64_t stream;
+    };
+    std::unique_ptr<Database> db;
+    //! the transactions occupying the concurrency levels of a stream, 0 denotes a free level
+    std::unordered_map<uint64_t, vector<uint64_t>> concurrency_levels;
+    std::unordered_map<uint64_t, uint64_t> generator_stream;
+    std::unordered_map<uint64_t, open_tx> open_txs;
+
+public:
+    bool open(std::string const& name) override {
+        db.reset(new Database(name));
+        return true;
+    }
+
+    void close() override {
+        db.reset();
+        concurrency_levels.clear();
+        generator_stream.clear();
+        open_txs.clear();
+    }
+
+    void stream(uint64_t id, std::string const& name, std::string const& kind) override {
+        db->writeStream(id, name, kind);
+    }
+
+    void generator(uint64_t id, std::string const& name, uint64_t stream,
+                   std::vector<scc::tx::attribute_desc> const&) override {
+        generator_stream[id] = stream;
+        db->writeGenerator(id, name, stream);
+    }
+
+    void begin_transaction(uint64_t id, uint64_t generator, uint64_t stream, uint64_t time) override {
+        auto& levels = concurrency_levels[stream];
+        size_t level = std::find(levels.begin(), levels.end(), 0) - levels.begin();
+        if(level == levels.size())
+            levels.push_back(id);
+        else
+            levels[level] = id;
+        auto offset = db->writeTransaction(id, generator, level);
+        db->writeTxTimepoint(id, BEGIN, time, offset);
+        open_txs[id] = open_tx{offset, stream};
+    }
+
+    void end_transaction(uint64_t id, uint64_t generator, uint64_t time) override {
+        auto it = open_txs.find(id);
+        if(it == open_txs.end())
+            return;
+        auto& levels = concurrency_levels[it->second.stream];
+        auto level = std::find(levels.begin(), levels.end(), id);
+        if(level != levels.end())
+            *level = 0;
+        db->writeTxTimepoint(id, END, time, it->second.offset);
+        open_txs.erase(it);
+    }
+
+    void attribute(uint64_t id, scc::tx::event_type event, std::string const& name,
+                   scc::tx::value const& val) override {
+        // the event types and the data types of both sides have the same values
+        auto evt = static_cast<EventType>(event);
+        auto type = static_cast<data_type>(val.type);
+        switch(val.type) {
+        case scc::tx::BOOLEAN:
+            db->writeAttribute(id, evt, name, type, std::string(val.b ? "TRUE" : "FALSE"));
+            break;
+        case scc::tx::INTEGER:
+            db->writeAttribute(id, evt, name, type, static_cast<uint64_t>(val.i));
+            break;
+        case scc::tx::UNSIGNED:
+            db->writeAttribute(id, evt, name, type, val.u);
+            break;
+        case scc::tx::FLOATING_POINT_NUMBER:
+            db->writeAttribute(id, evt, name, type, val.d);
+            break;
+        default:
+            db->writeAttribute(id, evt, name, type, val.str);
         }
-    } break;
-    default:;
     }
-}
-// ----------------------------------------------------------------------------
-void attributeCb(const scv_tr_handle& t, const char* name, const scv_extensions_if* ext, void* data) {
-    if(!db)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
-    string tmp_str(name == nullptr ? "" : name);
-    recordAttributes(t.get_id(), RECORD, tmp_str, ext);
-}
-// ----------------------------------------------------------------------------
-void relationCb(const scv_tr_handle& tr_1, const scv_tr_handle& tr_2, void* data,
-                scv_tr_relation_handle_t relation_handle) {
-    if(!db)
-        return;
-    if(tr_1.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(tr_1.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
-    try {
-        db->writeRelation(tr_1.get_scv_tr_stream().get_scv_tr_db()->get_relation_name(relation_handle), tr_1.get_id(),
-                          tr_2.get_id());
-    } catch(std::runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create transaction relation");
+
+    void relation(std::string const& name, uint64_t sink_id, uint64_t src_id) override {
+        db->writeRelation(name, sink_id, src_id);
     }
-}
+};
 } // namespace
 // ----------------------------------------------------------------------------
 void scv_tr_binary_init() {
-    scv_tr_db::register_class_cb(dbCb);
-    scv_tr_stream::register_class_cb(streamCb);
-    scv_tr_generator_base::register_class_cb(generatorCb);
-    scv_tr_handle::register_class_cb(transactionCb);
-    scv_tr_handle::register_record_attribute_cb(attributeCb);
-    scv_tr_handle::register_relation_cb(relationCb);
+    scc::tx::dispatcher::get().add(std::unique_ptr<scc::tx::backend>(new binary_backend));
 }
 // ----------------------------------------------------------------------------
 #ifndef HAS_SCV
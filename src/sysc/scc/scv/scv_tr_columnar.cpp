@@ -0,0 +1,338 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+#include "scv_tr_columnar.h"
+#include "scv_tr_dispatcher.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+// clang-format off
+#ifdef HAS_SCV
+#include <scv.h>
+#else
+#include <scv-tr.h>
+namespace scv_tr {
+#endif
+// clang-format on
+// ----------------------------------------------------------------------------
+// ----------------------------------------------------------------------------
+using namespace std;
+using namespace scc::txcol;
+namespace txcol = scc::txcol;
+using data_type = scv_extensions_if::data_type;
+// ----------------------------------------------------------------------------
+namespace {
+const uint32_t rows_per_block = 8192;
+
+template <typename T> inline void append(std::vector<char>& buf, T const& val) {
+    auto* p = reinterpret_cast<char const*>(&val);
+    buf.insert(buf.end(), p, p + sizeof(T));
+}
+/**
+ * the writer of the columnar database. Transactions are kept until they end, then they are appended to the current
+ * block. A full block is written to the file, the tables and the block index are written when the file is closed.
+ */
+class Database {
+    struct open_tx {
+        uint64_t generator;
+        uint64_t begin;
+        std::vector<char> attributes;
+    };
+    std::ofstream out;
+    uint64_t pos{0};
+    std::unordered_map<std::string, uint32_t> string_ids;
+    std::vector<std::string const*> strings;
+    std::vector<stream_info> streams;
+    std::vector<generator_info> generators;
+    std::vector<relation_info> relations;
+    std::unordered_map<uint64_t, uint64_t> generator_stream;
+    std::unordered_map<uint64_t, open_tx> open_txs;
+    // the columns of the current block
+    std::array<std::vector<uint64_t>, 5> columns;
+    std::vector<char> payload;
+    std::vector<uint64_t> current_streams;
+    std::vector<block_info> blocks;
+    std::vector<uint64_t> block_streams;
+    uint64_t max_time{0};
+
+    void write(void const* data, size_t size) {
+        out.write(static_cast<char const*>(data), size);
+        pos += size;
+    }
+
+    void align() {
+        static const std::array<char, 8> zeros{};
+        if(pos % 8)
+            write(zeros.data(), 8 - pos % 8);
+    }
+
+    template <typename T> uint64_t write_table(std::vector<T> const& table) {
+        align();
+        auto offset = pos;
+        if(table.size())
+            write(table.data(), table.size() * sizeof(T));
+        return offset;
+    }
+
+    void add_row(uint64_t id, open_tx& tx, uint64_t end) {
+        auto& c = columns;
+        c[0].push_back(id);
+        c[1].push_back(tx.generator);
+        c[2].push_back(tx.begin);
+        c[3].push_back(end);
+        c[4].push_back(payload.size());
+        payload.insert(payload.end(), tx.attributes.begin(), tx.attributes.end());
+        current_streams.push_back(generator_stream[tx.generator]);
+        if(c[0].size() == rows_per_block)
+            flush_block();
+    }
+
+    void flush_block() {
+        auto rows = static_cast<uint32_t>(columns[0].size());
+        if(!rows)
+            return;
+        align();
+        block_info info{pos, payload.size(), rows, 0, block_streams.size(), std::numeric_limits<uint64_t>::max(), 0, 0,
+                        0};
+        for(auto row = 0U; row < rows; ++row) {
+            info.min_begin = std::min(info.min_begin, columns[2][row]);
+            info.max_end = std::max(info.max_end, columns[3][row]);
+        }
+        for(auto& c : columns) {
+            write(c.data(), c.size() * sizeof(uint64_t));
+            c.clear();
+        }
+        write(payload.data(), payload.size());
+        payload.clear();
+        std::sort(current_streams.begin(), current_streams.end());
+        auto last = std::unique(current_streams.begin(), current_streams.end());
+        block_streams.insert(block_streams.end(), current_streams.begin(), last);
+        info.stream_count = static_cast<uint32_t>(last - current_streams.begin());
+        current_streams.clear();
+        blocks.push_back(info);
+    }
+
+    void attribute(uint64_t id, event_type event, const string& name, data_type type, void const* value, size_t size) {
+        auto it = open_txs.find(id);
+        if(it == open_txs.end())
+            return;
+        attribute_header hdr{get_string_id(name), static_cast<uint8_t>(event), static_cast<uint8_t>(type), 0,
+                             static_cast<uint32_t>(size)};
+        auto& buf = it->second.attributes;
+        append(buf, hdr);
+        buf.insert(buf.end(), static_cast<char const*>(value), static_cast<char const*>(value) + size);
+    }
+
+public:
+    uint32_t get_string_id(std::string const& str) {
+        auto res = string_ids.insert({str, static_cast<uint32_t>(strings.size())});
+        if(res.second)
+            strings.push_back(&res.first->first);
+        return res.first->second;
+    }
+
+    bool open(const std::string& name) {
+        out.open(name, std::ios::binary | std::ios::trunc);
+        if(!out.is_open())
+            return false;
+        pos = 0;
+        file_header hdr;
+        std::memcpy(hdr.magic, txcol::magic, sizeof(txcol::magic));
+        hdr.version = txcol::version;
+        hdr.rows_per_block = rows_per_block;
+        hdr.time_resolution_fs = static_cast<uint64_t>(sc_core::sc_get_time_resolution().to_seconds() * 1e15 + 0.5);
+        write(&hdr, sizeof(hdr));
+        for(auto& c : columns)
+            c.reserve(rows_per_block);
+        return true;
+    }
+
+    void close() {
+        if(!out.is_open())
+            return;
+        // transactions not being ended get the time of the last event
+        for(auto& e : open_txs)
+            add_row(e.first, e.second, std::max(max_time, e.second.begin));
+        open_txs.clear();
+        flush_block();
+        uint64_t bound = 0;
+        for(auto& b : blocks)
+            b.end_bound = bound = std::max(bound, b.max_end);
+        bound = std::numeric_limits<uint64_t>::max();
+        for(auto it = blocks.rbegin(); it != blocks.rend(); ++it)
+            it->begin_bound = bound = std::min(bound, it->min_begin);
+        file_trailer trl;
+        std::memcpy(trl.magic, txcol::magic, sizeof(txcol::magic));
+        align();
+        trl.string_offset = pos;
+        trl.string_count = strings.size();
+        uint64_t offset = 0;
+        for(auto* s : strings) {
+            write(&offset, sizeof(offset));
+            offset += s->size() + 1;
+        }
+        write(&offset, sizeof(offset));
+        for(auto* s : strings)
+            write(s->c_str(), s->size() + 1);
+        trl.stream_offset = write_table(streams);
+        trl.stream_count = streams.size();
+        trl.generator_offset = write_table(generators);
+        trl.generator_count = generators.size();
+        trl.relation_offset = write_table(relations);
+        trl.relation_count = relations.size();
+        trl.block_stream_offset = write_table(block_streams);
+        trl.block_stream_count = block_streams.size();
+        trl.block_offset = write_table(blocks);
+        trl.block_count = blocks.size();
+        align();
+        write(&trl, sizeof(trl));
+        out.close();
+        string_ids.clear();
+        strings.clear();
+        streams.clear();
+        generators.clear();
+        relations.clear();
+        generator_stream.clear();
+        blocks.clear();
+        block_streams.clear();
+    }
+
+    void writeStream(uint64_t id, std::string const& name, std::string const& kind) {
+        streams.push_back({id, get_string_id(name), get_string_id(kind)});
+    }
+
+    void writeGenerator(uint64_t id, std::string const& name, uint64_t stream, std::string const& begin_attr,
+                        std::string const& end_attr) {
+        generators.push_back(
+            {id, stream, get_string_id(name), get_string_id(begin_attr), get_string_id(end_attr), 0});
+        generator_stream[id] = stream;
+    }
+
+    void writeTransaction(uint64_t id, uint64_t generator, event_type type, uint64_t time) {
+        max_time = std::max(max_time, time);
+        if(type == BEGIN) {
+            auto& tx = open_txs[id];
+            tx.generator = generator;
+            tx.begin = time;
+            tx.attributes.clear();
+        } else {
+            auto it = open_txs.find(id);
+            if(it == open_txs.end())
+                return;
+            add_row(id, it->second, time);
+            open_txs.erase(it);
+        }
+    }
+
+    void writeAttribute(uint64_t id, event_type event, const string& name, data_type type, const string& value) {
+        attribute(id, event, name, type, value.data(), value.size());
+    }
+
+    void writeAttribute(uint64_t id, event_type event, const string& name, data_type type, int64_t value) {
+        attribute(id, event, name, type, &value, sizeof(value));
+    }
+
+    void writeAttribute(uint64_t id, event_type event, const string& name, data_type type, uint64_t value) {
+        attribute(id, event, name, type, &value, sizeof(value));
+    }
+
+    void writeAttribute(uint64_t id, event_type event, const string& name, data_type type, bool value) {
+        uint8_t val = value ? 1 : 0;
+        attribute(id, event, name, type, &val, sizeof(val));
+    }
+
+    void writeAttribute(uint64_t id, event_type event, const string& name, data_type type, double value) {
+        attribute(id, event, name, type, &value, sizeof(value));
+    }
+
+    void writeRelation(const std::string& name, uint64_t sink_id, uint64_t src_id) {
+        relations.push_back({sink_id, src_id, get_string_id(name), 0});
+    }
+
+};
+//! the database as backend of the scc::tx::dispatcher, the dispatcher flattens the SCV extensions
+class columnar_backend : public scc::tx::backend {
+    Database db;
+
+public:
+    bool open(std::string const& name) override { return db.open(name); }
+
+    void close() override { db.close(); }
+
+    void stream(uint64_t id, std::string const& name, std::string const& kind) override {
+        db.writeStream(id, name, kind);
+    }
+
+    void generator(uint64_t id, std::string const& name, uint64_t stream,
+                   std::vector<scc::tx::attribute_desc> const& attributes) override {
+        std::string begin_attr, end_attr;
+        for(auto& attr : attributes)
+            (attr.event == scc::tx::END ? end_attr : begin_attr) = attr.name;
+        db.writeGenerator(id, name, stream, begin_attr, end_attr);
+    }
+
+    void begin_transaction(uint64_t id, uint64_t generator, uint64_t, uint64_t time) override {
+        db.writeTransaction(id, generator, BEGIN, time);
+    }
+
+    void end_transaction(uint64_t id, uint64_t generator, uint64_t time) override {
+        db.writeTransaction(id, generator, END, time);
+    }
+
+    void attribute(uint64_t id, scc::tx::event_type event, std::string const& name,
+                   scc::tx::value const& val) override {
+        // the event types and the data types of both sides have the same values
+        auto evt = static_cast<event_type>(event);
+        auto type = static_cast<data_type>(val.type);
+        switch(val.type) {
+        case scc::tx::BOOLEAN:
+            db.writeAttribute(id, evt, name, type, val.b);
+            break;
+        case scc::tx::INTEGER:
+            db.writeAttribute(id, evt, name, type, val.i);
+            break;
+        case scc::tx::UNSIGNED:
+            db.writeAttribute(id, evt, name, type, val.u);
+            break;
+        case scc::tx::FLOATING_POINT_NUMBER:
+            db.writeAttribute(id, evt, name, type, val.d);
+            break;
+        default:
+            db.writeAttribute(id, evt, name, type, val.str);
+        }
+    }
+
+    void relation(std::string const& name, uint64_t sink_id, uint64_t src_id) override {
+        db.writeRelation(name, sink_id, src_id);
+    }
+};
+} // namespace
+// ----------------------------------------------------------------------------
+void scv_tr_columnar_init() {
+    scc::tx::dispatcher::get().add(std::unique_ptr<scc::tx::backend>(new columnar_backend));
+}
+// ----------------------------------------------------------------------------
+#ifndef HAS_SCV
+}
+using scv_tr::columnar_backend;
+#endif
+std::unique_ptr<scc::tx::backend> scc::tx::create_columnar_backend() {
+    return std::unique_ptr<backend>(new columnar_backend);
+}
@@ -0,0 +1,233 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_SCV_TR_COLUMNAR_H_
+#define _SCC_SCV_TR_COLUMNAR_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <util/image_loader.h>
+
+namespace scc {
+/**
+ * @brief the columnar transaction database written by scv_tr_columnar_init()
+ *
+ * The file is written in the byte order of the host and consists of
+ * - the \ref file_header
+ * - the data blocks, each holding up to file_header::rows_per_block transactions ordered by the time they ended.
+ *   A block of n rows stores the columns id, generator, begin time, end time and attribute offset as arrays of n
+ *   uint64_t each, followed by the attribute payload. The attributes of row i start at the attribute offset of row
+ *   i relative to the payload and end at the offset of row i+1 or at the end of the payload. Each attribute is an
+ *   \ref attribute_header followed by attribute_header::size bytes of value: 8 bytes for (unsigned) integers and
+ *   floating point numbers, 1 byte for booleans and the characters (without termination) for all other types
+ * - the string table, the streams, the generators, the relations, the stream ids of the blocks and the block index
+ * - the \ref file_trailer holding the offsets of the tables
+ * All sections start at multiples of 8 bytes so the file can be used in place once mapped into memory.
+ * Times are in units of file_header::time_resolution_fs femto seconds.
+ */
+namespace txcol {
+//! the magic number at the start and the end of the file
+static char const magic[8] = {'S', 'C', 'C', 'T', 'X', 'C', 'O', 'L'};
+//! the format version
+static const uint32_t version = 1;
+
+struct file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t rows_per_block;
+    uint64_t time_resolution_fs;
+};
+
+struct block_info {
+    //! file offset of the block
+    uint64_t offset;
+    //! size of the attribute payload
+    uint64_t payload_size;
+    uint32_t rows;
+    //! the number of streams having transactions in this block
+    uint32_t stream_count;
+    //! the index of the first stream id of the block in the block stream table
+    uint64_t stream_index;
+    //! the minimum begin time of the transactions of the block
+    uint64_t min_begin;
+    //! the maximum end time of the transactions of the block
+    uint64_t max_end;
+    //! the minimum begin time of this and all following blocks, non-decreasing over the blocks
+    uint64_t begin_bound;
+    //! the maximum end time of this and all preceding blocks, non-decreasing over the blocks
+    uint64_t end_bound;
+};
+
+struct stream_info {
+    uint64_t id;
+    uint32_t name;
+    uint32_t kind;
+};
+
+struct generator_info {
+    uint64_t id;
+    uint64_t stream;
+    uint32_t name;
+    uint32_t begin_attribute;
+    uint32_t end_attribute;
+    uint32_t reserved;
+};
+
+struct relation_info {
+    uint64_t sink;
+    uint64_t source;
+    uint32_t name;
+    uint32_t reserved;
+};
+//! the event an attribute belongs to
+enum event_type : uint8_t { BEGIN, RECORD, END };
+
+struct attribute_header {
+    //! the string id of the name
+    uint32_t name;
+    //! the \ref event_type
+    uint8_t event;
+    //! the scv_extensions_if::data_type
+    uint8_t type;
+    uint16_t reserved;
+    //! the size of the value following the header
+    uint32_t size;
+};
+/**
+ * the string table is an array of count+1 uint64_t offsets relative to the end of the array, followed by the null
+ * terminated strings
+ */
+struct file_trailer {
+    uint64_t string_offset;
+    uint64_t string_count;
+    uint64_t stream_offset;
+    uint64_t stream_count;
+    uint64_t generator_offset;
+    uint64_t generator_count;
+    uint64_t relation_offset;
+    uint64_t relation_count;
+    uint64_t block_stream_offset;
+    uint64_t block_stream_count;
+    uint64_t block_offset;
+    uint64_t block_count;
+    char magic[8];
+};
+//! a table of the file
+template <typename T> struct table {
+    T const* data;
+    size_t size;
+    T const& operator[](size_t idx) const { return data[idx]; }
+    T const* begin() const { return data; }
+    T const* end() const { return data + size; }
+};
+//! the columns of a data block
+struct block_view {
+    uint64_t const* id;
+    uint64_t const* generator;
+    uint64_t const* begin;
+    uint64_t const* end;
+    uint64_t const* attribute_offset;
+    uint8_t const* payload;
+    uint64_t payload_size;
+    uint32_t rows;
+    //! get the range of the attribute payload of a row
+    std::pair<uint8_t const*, uint8_t const*> attributes(size_t row) const {
+        return {payload + attribute_offset[row], payload + (row + 1 < rows ? attribute_offset[row + 1] : payload_size)};
+    }
+};
+/**
+ * @brief a reader of the columnar transaction database
+ *
+ * The file is memory mapped, only the parts being accessed are actually read. Two binary searches over the block
+ * index yield the blocks holding the transactions overlapping a time window.
+ */
+class reader {
+public:
+    /**
+     * open the database, throws std::runtime_error if the file cannot be mapped or is not a columnar database
+     *
+     * @param name the file name
+     */
+    explicit reader(std::string const& name)
+    : file(name) {
+        if(file.size() < sizeof(file_header) + sizeof(file_trailer))
+            throw std::runtime_error(name + " is not a columnar transaction database");
+        hdr = reinterpret_cast<file_header const*>(file.data());
+        trl = reinterpret_cast<file_trailer const*>(file.data() + file.size() - sizeof(file_trailer));
+        if(std::memcmp(hdr->magic, magic, sizeof(magic)) || std::memcmp(trl->magic, magic, sizeof(magic)))
+            throw std::runtime_error(name + " is not a columnar transaction database");
+        if(hdr->version != version)
+            throw std::runtime_error(name + " has an unsupported version");
+        string_offsets = at<uint64_t>(trl->string_offset);
+        string_data = reinterpret_cast<char const*>(string_offsets + trl->string_count + 1);
+        streams = {at<stream_info>(trl->stream_offset), trl->stream_count};
+        generators = {at<generator_info>(trl->generator_offset), trl->generator_count};
+        relations = {at<relation_info>(trl->relation_offset), trl->relation_count};
+        block_streams = {at<uint64_t>(trl->block_stream_offset), trl->block_stream_count};
+        blocks = {at<block_info>(trl->block_offset), trl->block_count};
+    }
+
+    file_header const& header() const { return *hdr; }
+    //! get a string of the string table
+    char const* string(uint32_t id) const { return string_data + string_offsets[id]; }
+    /**
+     * @brief get the blocks which may hold transactions overlapping the time window [begin, end]
+     *
+     * @return the index of the first block and the index behind the last block
+     */
+    std::pair<size_t, size_t> blocks_in_window(uint64_t begin, uint64_t end) const {
+        auto first = std::lower_bound(blocks.begin(), blocks.end(), begin,
+                                      [](block_info const& b, uint64_t t) { return b.end_bound < t; });
+        auto last = std::upper_bound(first, blocks.end(), end,
+                                     [](uint64_t t, block_info const& b) { return t < b.begin_bound; });
+        return {static_cast<size_t>(first - blocks.begin()), static_cast<size_t>(last - blocks.begin())};
+    }
+    //! check if a block holds transactions of a stream
+    bool has_stream(size_t block, uint64_t stream) const {
+        auto start = block_streams.begin() + blocks[block].stream_index;
+        return std::binary_search(start, start + blocks[block].stream_count, stream);
+    }
+    //! get the columns of a block
+    block_view block(size_t idx) const {
+        auto const& b = blocks[idx];
+        auto* col = at<uint64_t>(b.offset);
+        return {col, col + b.rows, col + 2 * b.rows, col + 3 * b.rows, col + 4 * b.rows,
+                reinterpret_cast<uint8_t const*>(col + 5 * b.rows), b.payload_size, b.rows};
+    }
+
+    table<stream_info> streams{nullptr, 0};
+    table<generator_info> generators{nullptr, 0};
+    table<relation_info> relations{nullptr, 0};
+    table<block_info> blocks{nullptr, 0};
+
+private:
+    template <typename T> T const* at(uint64_t offset) const {
+        return reinterpret_cast<T const*>(file.data() + offset);
+    }
+    util::mapped_file file;
+    file_header const* hdr{nullptr};
+    file_trailer const* trl{nullptr};
+    uint64_t const* string_offsets{nullptr};
+    char const* string_data{nullptr};
+    table<uint64_t> block_streams{nullptr, 0};
+};
+} // namespace txcol
+} // namespace scc
+#endif /* _SCC_SCV_TR_COLUMNAR_H_ */
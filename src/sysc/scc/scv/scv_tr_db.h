@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2018 MINRES Technologies GmbH
+ * Copyright 2018-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -21,11 +21,16 @@ namespace scv_tr {
 #endif
 
 /**
- * @fn void scv_tr_sqlite_init()
+ * @fn void scv_tr_sqlite_init(bool)
  * @brief initializes the infrastructure to use a SQLite based transaction recording database
  *
+ * In asynchronous mode the records are inserted by a background thread in large batches, each one being a single SQL
+ * transaction, and the database uses a write ahead log. The simulation does not wait for the database, the queued
+ * records are written when the database is closed.
+ *
+ * @param async use the asynchronous mode
  */
-void scv_tr_sqlite_init();
+void scv_tr_sqlite_init(bool async = false);
 /**
  * @fn void scv_tr_compressed_init()
  * @brief initializes the infrastructure to use a gzip compressed text based transaction recording database
@@ -38,7 +43,8 @@ void scv_tr_compressed_init();
  * @fn void scv_tr_plain_init()
  * @brief initializes the infrastructure to use a plain text based transaction recording database
  *
- * TODO: add a multithreaded writer
+ * The database is written by a scc::tx::text_backend registered at the scc::tx::dispatcher. Further sinks or
+ * backends can be added there to record into several destinations at once.
  *
  */
 void scv_tr_plain_init();
@@ -46,15 +52,30 @@ void scv_tr_plain_init();
  * @fn void scv_tr_lz4_init()
  * @brief initializes the infrastructure to use a LZ4 compressed text based transaction recording database
  *
- * TODO: add a multithreaded writer
+ * The database is written by a scc::tx::text_backend registered at the scc::tx::dispatcher. Further sinks or
+ * backends can be added there to record into several destinations at once.
  *
  */
 void scv_tr_lz4_init();
 /**
- * @fn void scv_tr_mtc_init()
- * @brief initializes the infrastructure to use a compressed text based transaction recording database with a
- * multithreaded writer
+ * @fn void scv_tr_shm_init(char const*)
+ * @brief initializes the infrastructure to publish the transactions in the text format into a shared memory ring
+ * buffer
+ *
+ * This can be used in addition to any file based database. Viewers attach using util::shm_ring_reader, the records
+ * are only formatted while a reader is attached. See also scc::tx::shm_sink()
  *
+ * @param name the name of the shared memory object, if nullptr or empty it is derived from the database name
+ */
+void scv_tr_shm_init(char const* name = nullptr);
+/**
+ * @fn void scv_tr_cbor_init(bool)
+ * @brief initializes the infrastructure to use a CBOR based transaction recording database (FTR)
+ *
+ * The encoding and the compression are done by a worker thread, the simulation only blocks if the worker falls
+ * behind by more than a few chunks of recorded calls.
+ *
+ * @param compressed compress the chunks of the database
  */
 void scv_tr_cbor_init(bool compressed);
 /**
@@ -62,8 +83,33 @@ void scv_tr_cbor_init(bool compressed);
  * @brief initializes the infrastructure to use a compressed text based transaction recording database with a
  * multithreaded writer
  *
+ * Each stream collects its transactions in chunks which are formatted and LZ4 compressed by a pool of worker threads,
+ * chunks of different streams are processed in parallel. The file is a sequence of LZ4 frames holding the text
+ * format, the relations are written at the end.
  */
 void scv_tr_mtc_init();
+/**
+ * @fn void scv_tr_columnar_init()
+ * @brief initializes the infrastructure to use a columnar binary transaction recording database
+ *
+ * The transactions are stored in blocks of fixed size columns ordered by their end time, the index of the blocks
+ * at the end of the file allows to find the blocks of a time window using binary searches on the memory mapped file.
+ * The format and a reader are described in scv_tr_columnar.h
+ */
+void scv_tr_columnar_init();
+/**
+ * @fn void scv_tr_analysis_init(unsigned long)
+ * @brief initializes the infrastructure to analyze the transactions while they are being recorded
+ *
+ * Instead of storing the transactions, statistics are kept per stream (i.e. per kind of access of a recorded
+ * socket) in memory not depending on the number of transactions: the latency percentiles based on HDR histograms,
+ * the number of outstanding transactions and the bytes transferred per time window. They are written as JSON into
+ * <database name>.stats.json when the database is closed. This can be used alone or in addition to any other
+ * database.
+ *
+ * @param window_ns the length of the time windows of the bandwidth statistics in ns
+ */
+void scv_tr_analysis_init(unsigned long window_ns = 1000);
 
 #ifdef USE_EXTENDED_DB
 /**
@@ -72,6 +118,10 @@ void scv_tr_mtc_init();
 void scv_tr_binary_init();
 /**
  * initializes the infrastructure to use a LevelDB based transaction recording database
+ *
+ * The entries are collected in write batches holding complete simulation time steps which are written by a
+ * background thread. The CCI parameters or preset values scv_tr_ldb.compression (bool, default true) and
+ * scv_tr_ldb.write_buffer_size (bytes, default 64MiB) configure the database when it is created.
  */
 void scv_tr_ldb_init();
 
@@ -0,0 +1,273 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+#include "scv_tr_dispatcher.h"
+#include "attribute_schema.h"
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// clang-format off
+#ifdef HAS_SCV
+#include <scv.h>
+#else
+#include <scv-tr.h>
+namespace scv_tr {
+#endif
+// clang-format on
+// ----------------------------------------------------------------------------
+using namespace std;
+namespace tx = scc::tx;
+// ----------------------------------------------------------------------------
+namespace {
+//! the backends having been opened successfully
+std::vector<tx::backend*> active;
+scc::attribute_schema_cache schemas(true);
+
+template <typename F> inline void for_all(char const* what, F f) {
+    for(auto* be : active)
+        try {
+            f(*be);
+        } catch(...) {
+            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, what);
+        }
+}
+// ----------------------------------------------------------------------------
+void dbCb(const scv_tr_db& _scv_tr_db, scv_tr_db::callback_reason reason, void* data) {
+    // This is called from the scv_tr_db ctor.
+    static string fName("DEFAULT_scv_tr_db");
+    switch(reason) {
+    case scv_tr_db::CREATE:
+        if((_scv_tr_db.get_name() != nullptr) && (strlen(_scv_tr_db.get_name()) != 0))
+            fName = _scv_tr_db.get_name();
+        active.clear();
+        for(auto& be : tx::dispatcher::get().get_backends()) {
+            try {
+                if(be->open(fName)) {
+                    active.push_back(be.get());
+                    continue;
+                }
+            } catch(...) {
+            }
+            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't open recording file");
+        }
+        break;
+    case scv_tr_db::DELETE:
+        for_all("Can't close recording file", [](tx::backend& be) { be.close(); });
+        active.clear();
+        schemas.clear();
+        break;
+    default:
+        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Unknown reason in scv_tr_db callback");
+    }
+}
+// ----------------------------------------------------------------------------
+void streamCb(const scv_tr_stream& s, scv_tr_stream::callback_reason reason, void* data) {
+    if(reason == scv_tr_stream::CREATE) {
+        std::string name{s.get_name()}, kind{s.get_stream_kind() ? s.get_stream_kind() : ""};
+        for_all("Can't create stream", [&](tx::backend& be) { be.stream(s.get_id(), name, kind); });
+    }
+}
+// ----------------------------------------------------------------------------
+void recordAttributes(uint64_t id, tx::event_type eventType, char const* prefix, const scv_extensions_if* my_exts_p);
+// ----------------------------------------------------------------------------
+void recordAttribute(uint64_t id, tx::event_type eventType, const string& name, const scv_extensions_if* my_exts_p) {
+    tx::value val;
+    val.type = static_cast<tx::data_type>(my_exts_p->get_type());
+    switch(my_exts_p->get_type()) {
+    case scv_extensions_if::POINTER:
+        if(auto ptr = my_exts_p->get_pointer()) {
+            std::stringstream ss;
+            ss << name << "*";
+            recordAttributes(id, eventType, ss.str().c_str(), ptr);
+        }
+        return;
+    case scv_extensions_if::ENUMERATION:
+        val.str = my_exts_p->get_enum_string((int)(my_exts_p->get_integer()));
+        break;
+    case scv_extensions_if::BOOLEAN:
+        val.b = my_exts_p->get_bool();
+        break;
+    case scv_extensions_if::INTEGER:
+    case scv_extensions_if::FIXED_POINT_INTEGER:
+        val.type = tx::INTEGER;
+        val.i = my_exts_p->get_integer();
+        break;
+    case scv_extensions_if::UNSIGNED:
+        val.u = my_exts_p->get_unsigned();
+        break;
+    case scv_extensions_if::STRING:
+        val.str = my_exts_p->get_string();
+        break;
+    case scv_extensions_if::FLOATING_POINT_NUMBER:
+        val.d = my_exts_p->get_double();
+        break;
+    case scv_extensions_if::BIT_VECTOR: {
+        sc_bv_base tmp_bv(my_exts_p->get_bitwidth());
+        my_exts_p->get_value(tmp_bv);
+        val.str = tmp_bv.to_string();
+    } break;
+    case scv_extensions_if::LOGIC_VECTOR: {
+        sc_lv_base tmp_lv(my_exts_p->get_bitwidth());
+        my_exts_p->get_value(tmp_lv);
+        val.str = tmp_lv.to_string();
+    } break;
+    default: {
+        std::array<char, 100> tmpString;
+        sprintf(tmpString.data(), "Unsupported attribute type = %d", my_exts_p->get_type());
+        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, tmpString.data());
+        return;
+    }
+    }
+    for_all("Can't create attribute entry", [&](tx::backend& be) { be.attribute(id, eventType, name, val); });
+}
+// ----------------------------------------------------------------------------
+void recordAttributes(uint64_t id, tx::event_type eventType, char const* prefix, const scv_extensions_if* my_exts_p) {
+    if(my_exts_p == nullptr)
+        return;
+    switch(my_exts_p->get_type()) {
+    case scv_extensions_if::RECORD: {
+        int num_fields = my_exts_p->get_num_fields();
+        for(int field_counter = 0; field_counter < num_fields; field_counter++)
+            recordAttributes(id, eventType, prefix, my_exts_p->get_field(field_counter));
+    } break;
+    case scv_extensions_if::ARRAY:
+        for(int array_elt_index = 0; array_elt_index < my_exts_p->get_array_size(); array_elt_index++)
+            recordAttributes(id, eventType, prefix, my_exts_p->get_array_elt(array_elt_index));
+        break;
+    case scv_extensions_if::POINTER:
+        // the pointee is recorded with the prefix, not the name of the pointer
+        recordAttribute(id, eventType, prefix ? prefix : "", my_exts_p);
+        break;
+    default:
+        recordAttribute(id, eventType, scc::attribute_schema::get_name(prefix, my_exts_p), my_exts_p);
+    }
+}
+// ----------------------------------------------------------------------------
+void recordAttributes(uint64_t id, tx::event_type eventType, const scv_tr_generator_base& g,
+                      const scv_extensions_if* my_exts_p) {
+    if(auto* schema = schemas.find(g.get_id(), eventType == tx::END))
+        schema->for_each(my_exts_p, [id, eventType](std::string const& name, const scv_extensions_if* leaf) {
+            recordAttribute(id, eventType, name, leaf);
+        });
+    else {
+        auto attr_name = eventType == tx::END ? g.get_end_attribute_name() : g.get_begin_attribute_name();
+        recordAttributes(id, eventType, attr_name ? attr_name : "", my_exts_p);
+    }
+}
+// ----------------------------------------------------------------------------
+void generatorCb(const scv_tr_generator_base& g, scv_tr_generator_base::callback_reason reason, void* data) {
+    if(reason == scv_tr_generator_base::CREATE) {
+        schemas.add(g);
+        std::vector<tx::attribute_desc> attrs;
+        if(auto* exts = g.get_begin_exts_p())
+            attrs.push_back({tx::BEGIN, static_cast<tx::data_type>(exts->get_type()),
+                             g.get_begin_attribute_name() ? g.get_begin_attribute_name() : ""});
+        if(auto* exts = g.get_end_exts_p())
+            attrs.push_back({tx::END, static_cast<tx::data_type>(exts->get_type()),
+                             g.get_end_attribute_name() ? g.get_end_attribute_name() : ""});
+        std::string name{g.get_name()};
+        for_all("Can't create generator entry", [&](tx::backend& be) {
+            be.generator(g.get_id(), name, g.get_scv_tr_stream().get_id(), attrs);
+        });
+    }
+}
+// ----------------------------------------------------------------------------
+void transactionCb(const scv_tr_handle& t, scv_tr_handle::callback_reason reason, void* data) {
+    if(active.empty() || t.get_scv_tr_stream().get_scv_tr_db() == nullptr)
+        return;
+    if(t.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
+        return;
+    auto id = t.get_id();
+    auto& gen = t.get_scv_tr_generator_base();
+    switch(reason) {
+    case scv_tr_handle::BEGIN: {
+        auto time = t.get_begin_sc_time().value();
+        for_all("Can't create transaction", [&](tx::backend& be) {
+            be.begin_transaction(id, gen.get_id(), gen.get_scv_tr_stream().get_id(), time);
+        });
+        auto* my_exts_p = t.get_begin_exts_p();
+        if(my_exts_p == nullptr)
+            my_exts_p = gen.get_begin_exts_p();
+        if(my_exts_p)
+            recordAttributes(id, tx::BEGIN, gen, my_exts_p);
+    } break;
+    case scv_tr_handle::END: {
+        auto* my_exts_p = t.get_end_exts_p();
+        if(my_exts_p == nullptr)
+            my_exts_p = gen.get_end_exts_p();
+        if(my_exts_p)
+            recordAttributes(id, tx::END, gen, my_exts_p);
+        auto time = t.get_end_sc_time().value();
+        for_all("Can't create transaction end", [&](tx::backend& be) { be.end_transaction(id, gen.get_id(), time); });
+    } break;
+    default:;
+    }
+}
+// ----------------------------------------------------------------------------
+void attributeCb(const scv_tr_handle& t, const char* name, const scv_extensions_if* ext, void* data) {
+    if(active.empty() || t.get_scv_tr_stream().get_scv_tr_db() == nullptr)
+        return;
+    if(t.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
+        return;
+    recordAttributes(t.get_id(), tx::RECORD, name == nullptr ? "" : name, ext);
+}
+// ----------------------------------------------------------------------------
+void relationCb(const scv_tr_handle& tr_1, const scv_tr_handle& tr_2, void* data,
+                scv_tr_relation_handle_t relation_handle) {
+    if(active.empty() || tr_1.get_scv_tr_stream().get_scv_tr_db() == nullptr)
+        return;
+    if(tr_1.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
+        return;
+    std::string name{tr_1.get_scv_tr_stream().get_scv_tr_db()->get_relation_name(relation_handle)};
+    auto stream_1 = tr_1.get_scv_tr_stream().get_id(), stream_2 = tr_2.get_scv_tr_stream().get_id();
+    for_all("Can't create transaction relation", [&](tx::backend& be) {
+        be.stream_relation(name, tr_1.get_id(), stream_1, tr_2.get_id(), stream_2);
+    });
+}
+// ----------------------------------------------------------------------------
+void register_callbacks() {
+    scv_tr_db::register_class_cb(dbCb);
+    scv_tr_stream::register_class_cb(streamCb);
+    scv_tr_generator_base::register_class_cb(generatorCb);
+    scv_tr_handle::register_class_cb(transactionCb);
+    scv_tr_handle::register_record_attribute_cb(attributeCb);
+    scv_tr_handle::register_relation_cb(relationCb);
+}
+} // namespace
+// ----------------------------------------------------------------------------
+#ifndef HAS_SCV
+}
+#endif
+// ----------------------------------------------------------------------------
+scc::tx::dispatcher& scc::tx::dispatcher::get() {
+    static dispatcher inst;
+    return inst;
+}
+
+void scc::tx::dispatcher::add(std::unique_ptr<backend>&& be) {
+    if(!registered) {
+#ifdef HAS_SCV
+        register_callbacks();
+#else
+        scv_tr::register_callbacks();
+#endif
+        registered = true;
+    }
+    backends.push_back(std::move(be));
+}
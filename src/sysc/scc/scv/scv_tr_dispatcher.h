@@ -0,0 +1,220 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_SCV_TR_DISPATCHER_H_
+#define _SCC_SCV_TR_DISPATCHER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace scc {
+/**
+ * @brief the transaction recording backend interface
+ *
+ * The \ref dispatcher registers the SCV callbacks once, turns the SCV extensions into flat attribute values and
+ * forwards the events to all registered backends. Hence recording into several databases does not walk the
+ * transactions twice and a backend does not need to know about SCV at all.
+ */
+namespace tx {
+//! the event an attribute belongs to
+enum event_type { BEGIN, RECORD, END };
+//! the attribute types, the values match scv_extensions_if::data_type
+enum data_type {
+    BOOLEAN,
+    ENUMERATION,
+    INTEGER,
+    UNSIGNED,
+    FLOATING_POINT_NUMBER,
+    BIT_VECTOR,
+    LOGIC_VECTOR,
+    FIXED_POINT_INTEGER,
+    UNSIGNED_FIXED_POINT_INTEGER,
+    RECORD_TYPE,
+    POINTER,
+    ARRAY,
+    STRING
+};
+//! the top level attribute of a generator
+struct attribute_desc {
+    event_type event;
+    data_type type;
+    std::string name;
+};
+/**
+ * @brief an attribute value, ENUMERATION, BIT_VECTOR, LOGIC_VECTOR and STRING are held as string in str
+ */
+struct value {
+    data_type type;
+    union {
+        bool b;
+        int64_t i;
+        uint64_t u;
+        double d;
+    };
+    std::string str;
+};
+/**
+ * @brief a transaction recording backend
+ *
+ * All times are in units of the SystemC time resolution. The methods are called from the simulation thread.
+ */
+class backend {
+public:
+    virtual ~backend() = default;
+    //! open the database named after the scv_tr_db, returns false if this fails
+    virtual bool open(std::string const& name) = 0;
+
+    virtual void close() = 0;
+
+    virtual void stream(uint64_t id, std::string const& name, std::string const& kind) = 0;
+
+    virtual void generator(uint64_t id, std::string const& name, uint64_t stream,
+                           std::vector<attribute_desc> const& attributes) = 0;
+
+    virtual void begin_transaction(uint64_t id, uint64_t generator, uint64_t stream, uint64_t time) = 0;
+
+    virtual void end_transaction(uint64_t id, uint64_t generator, uint64_t time) = 0;
+
+    virtual void attribute(uint64_t id, event_type event, std::string const& name, value const& val) = 0;
+
+    virtual void relation(std::string const& name, uint64_t sink_id, uint64_t src_id) = 0;
+    //! a relation including the streams of both transactions, by default the streams are dropped
+    virtual void stream_relation(std::string const& name, uint64_t sink_id, uint64_t sink_stream, uint64_t src_id,
+                                 uint64_t src_stream) {
+        relation(name, sink_id, src_id);
+    }
+};
+/**
+ * @brief the fan-out of the SCV transaction recording callbacks to the registered backends
+ */
+class dispatcher {
+public:
+    static dispatcher& get();
+    /**
+     * @brief add a backend, the SCV callbacks are registered with the first backend being added
+     *
+     * Backends need to be added before the scv_tr_db is created.
+     *
+     * @param be the backend
+     */
+    void add(std::unique_ptr<backend>&& be);
+    //! the backends being registered
+    std::vector<std::unique_ptr<backend>> const& get_backends() const { return backends; }
+
+private:
+    dispatcher() = default;
+    std::vector<std::unique_ptr<backend>> backends;
+    bool registered{false};
+};
+//! a destination of formatted data, e.g. a file or a socket
+class byte_sink {
+public:
+    virtual ~byte_sink() = default;
+
+    virtual void write(char const* data, size_t size) = 0;
+    //! write a definition of a stream or generator, the records refer to them
+    virtual void define(char const* data, size_t size) { write(data, size); }
+    //! check if the records are consumed at all, otherwise the formatting is skipped
+    virtual bool is_active() const { return true; }
+};
+//! creates a sink when the database is opened, the argument is the name of the database
+using sink_factory = std::function<std::unique_ptr<byte_sink>(std::string const&)>;
+//! get a factory of a plain file sink, the file is named after the database with the extension appended
+sink_factory file_sink(std::string const& extension = "");
+//! get a factory of a LZ4 compressed file sink, the file is named after the database with the extension appended
+sink_factory lz4_file_sink(std::string const& extension = "");
+//! get a factory of a gzip compressed file sink, only available if SCC is built with zlib
+sink_factory gz_file_sink(std::string const& extension = "");
+/**
+ * @brief get a factory of a sink publishing the records into a shared memory ring buffer
+ *
+ * External viewers attach using util::shm_ring_reader, each ring buffer record holds one line of the text format.
+ * Records are only produced while a reader is attached and a reader attaching gets the stream and generator
+ * definitions first. A reader falling behind loses records but never slows down the simulation.
+ *
+ * @param name the name of the shared memory object, if empty it is derived from the name of the database
+ * @param capacity the size of the ring buffer
+ */
+sink_factory shm_sink(std::string const& name = "", size_t capacity = 16 << 20);
+/**
+ * @brief a backend writing the SCV text format
+ *
+ * Each record is formatted once and the bytes go to all sinks, e.g. a compressed file and a socket feeding a live
+ * viewer.
+ */
+class text_backend : public backend {
+public:
+    text_backend() = default;
+    //! create the backend with a single sink
+    explicit text_backend(sink_factory&& factory) { add_sink(std::move(factory)); }
+    //! add a sink, it is created when the database is opened
+    void add_sink(sink_factory&& factory) { factories.push_back(std::move(factory)); }
+
+    bool open(std::string const& name) override;
+
+    void close() override;
+
+    void stream(uint64_t id, std::string const& name, std::string const& kind) override;
+
+    void generator(uint64_t id, std::string const& name, uint64_t stream,
+                   std::vector<attribute_desc> const& attributes) override;
+
+    void begin_transaction(uint64_t id, uint64_t generator, uint64_t stream, uint64_t time) override;
+
+    void end_transaction(uint64_t id, uint64_t generator, uint64_t time) override;
+
+    void attribute(uint64_t id, event_type event, std::string const& name, value const& val) override;
+
+    void relation(std::string const& name, uint64_t sink_id, uint64_t src_id) override;
+
+private:
+    bool is_active() const {
+        for(auto& s : sinks)
+            if(s->is_active())
+                return true;
+        return false;
+    }
+    void write(std::string const& buf) {
+        for(auto& s : sinks)
+            if(s->is_active())
+                s->write(buf.data(), buf.size());
+    }
+    void define(std::string const& buf) {
+        for(auto& s : sinks)
+            s->define(buf.data(), buf.size());
+    }
+    std::vector<sink_factory> factories;
+    std::vector<std::unique_ptr<byte_sink>> sinks;
+    //! the end attributes of the transaction being ended, they are written after the tx_end line
+    std::string end_attributes;
+};
+/**
+ * @brief create the backend used by scv_tr_mtc_init()
+ *
+ * The backends can be driven without a simulation, e.g. to convert databases. The times are in units of the SystemC
+ * time resolution which is 1ps unless set otherwise.
+ */
+std::unique_ptr<backend> create_mtc_backend();
+//! create the backend writing the format of scv_tr_columnar_init(), see create_mtc_backend()
+std::unique_ptr<backend> create_columnar_backend();
+//! create the backend used by scv_tr_analysis_init(), see create_mtc_backend()
+std::unique_ptr<backend> create_analysis_backend(uint64_t window_ns = 1000);
+} // namespace tx
+} // namespace scc
+#endif /* _SCC_SCV_TR_DISPATCHER_H_ */
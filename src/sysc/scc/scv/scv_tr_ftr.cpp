@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2018 MINRES Technologies GmbH
+ * Copyright 2018-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -13,21 +13,23 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  *******************************************************************************/
-#include <array>
 #include <boost/filesystem.hpp>
 #include <cmath>
-#include <cstdio>
 #include <cstring>
+#include <deque>
 #include <fcntl.h>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include <ftr/ftr_writer.h>
+#include "scv_tr_dispatcher.h"
+#include <util/thread_pool.h>
 // clang-format off
 #ifdef HAS_SCV
 #include <scv.h>
@@ -41,239 +43,211 @@ using namespace std;
 using namespace ftr;
 // ----------------------------------------------------------------------------
 namespace {
-template<bool COMPRESSED>
-struct tx_db {
-	static ftr_writer<COMPRESSED>* db;
-	static void dbCb(const scv_tr_db& _scv_tr_db, scv_tr_db::callback_reason reason, void* data) {
-		// This is called from the scv_tr_db ctor.
-		static string fName("DEFAULT_scv_tr_cbor");
-		switch(reason) {
-		case scv_tr_db::CREATE:
-			if((_scv_tr_db.get_name() != nullptr) && (strlen(_scv_tr_db.get_name()) != 0))
-				fName = _scv_tr_db.get_name();
-			try {
-				db = new ftr_writer<COMPRESSED>(fName+".ftr");
-			} catch(...) {
-				_scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't open recording file");
-			}
-			if(!db->cw.enc.ofs.is_open()) {
-				delete db;
-				db=nullptr;
-			} else {
-			    double secs = sc_core::sc_time::from_value(1ULL).to_seconds();
-			    auto exp = rint(log(secs)/log(10.0));
-	            db->writeInfo(static_cast<int8_t>(exp));
-			}
-			break;
-		case scv_tr_db::DELETE:
-			try {
-				delete db;
-			} catch(...) {
-				_scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't close recording file");
-			}
-			break;
-		default:
-			_scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Unknown reason in scv_tr_db callback");
+/**
+ * executes the calls of the ftr_writer in a worker thread so that neither the CBOR encoding nor the compression runs
+ * on the simulation thread. The calls are collected in chunks, a full chunk is queued for the worker while the next
+ * one is being filled. At most max_chunks chunks are queued, if the worker falls behind the simulation thread blocks
+ * instead of buffering an unbounded amount of data.
+ */
+class ftr_worker {
+	using chunk_type = std::vector<util::pool_task>;
+	static constexpr size_t chunk_size = 4096;
+	chunk_type current;
+	std::deque<chunk_type> full_chunks;
+	std::vector<chunk_type> free_chunks;
+	std::mutex mtx;
+	std::string error;
+	util::thread_pool pool;
+
+	void run_chunk() {
+		chunk_type chunk;
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			chunk = std::move(full_chunks.front());
+			full_chunks.pop_front();
 		}
-	}
-	// ----------------------------------------------------------------------------
-	static void streamCb(const scv_tr_stream& s, scv_tr_stream::callback_reason reason, void* data) {
-		if(db && reason == scv_tr_stream::CREATE) {
+		for(auto& call : chunk)
 			try {
-				db->writeStream(s.get_id(), s.get_name(), s.get_stream_kind());
-			} catch(std::runtime_error& e) {
-				_scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create stream");
+				call();
+			} catch(std::exception& e) {
+				std::lock_guard<std::mutex> lock(mtx);
+				if(error.empty())
+					error = e.what();
 			}
+		chunk.clear();
+		std::lock_guard<std::mutex> lock(mtx);
+		free_chunks.push_back(std::move(chunk));
+	}
+
+public:
+	explicit ftr_worker(size_t max_chunks = 4) {
+		current.reserve(chunk_size);
+		pool.set_capacity(max_chunks);
+		pool.start(1);
+	}
+
+	template<typename F>
+	inline void push(F&& f) {
+		current.emplace_back(std::forward<F>(f));
+		if(current.size() == chunk_size)
+			flush();
+	}
+	//! queue the current chunk, the pool runs the chunks in their order as all tasks take the oldest one
+	void flush() {
+		if(current.empty())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			full_chunks.push_back(std::move(current));
+			if(free_chunks.size()) {
+				current = std::move(free_chunks.back());
+				free_chunks.pop_back();
+			} else
+				current = chunk_type();
 		}
+		current.reserve(chunk_size);
+		pool.post([this]() { run_chunk(); });
+	}
+	//! execute all outstanding calls, returns the message of the first failing call if any
+	std::string finish() {
+		flush();
+		pool.finish();
+		return error;
+	}
+};
+
+/**
+ * the FTR writer as backend of the scc::tx::dispatcher. The calls of the writer are executed by the ftr_worker, the
+ * names of the attributes are interned as they need to live until the worker has finished.
+ */
+template<bool COMPRESSED>
+class ftr_backend : public scc::tx::backend {
+	std::unique_ptr<ftr_writer<COMPRESSED>> db;
+	std::unique_ptr<ftr_worker> worker;
+	std::unordered_set<std::string> names;
+
+	std::string const* intern(std::string const& name) {
+		return &*names.insert(name).first;
 	}
-	// ----------------------------------------------------------------------------
-	static inline void recordAttribute(uint64_t id, event_type event, const string& name, ftr::data_type type, const string& value) {
-	    if(db) try {
-	        db->writeAttribute(id, event, name, type, value);
-	    } catch(std::runtime_error& e) {
-	        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
-	    }
+	//! the FTR database is written in units of 1ps
+	static uint64_t to_ps(uint64_t time) {
+		return sc_core::sc_time::from_value(time) / sc_core::sc_time(1, sc_core::SC_PS);
 	}
-	// ----------------------------------------------------------------------------
-	static inline void recordAttribute(uint64_t id, event_type event, const string& name, ftr::data_type type, char const * value) {
-	    if(db) try {
-			db->writeAttribute(id, event, name, type, value);
-		} catch(std::runtime_error& e) {
-			_scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
+	static event_type get_event(scc::tx::event_type event) {
+		switch(event) {
+		case scc::tx::BEGIN:
+			return event_type::BEGIN;
+		case scc::tx::RECORD:
+			return event_type::RECORD;
+		default:
+			return event_type::END;
 		}
 	}
-	// ----------------------------------------------------------------------------
 	template<typename T>
-	static inline void recordAttribute(uint64_t id, event_type event, const string& name, ftr::data_type type, T value) {
-	    if(db) try {
-			db->writeAttribute(id, event, name, type, value);
-		} catch(std::runtime_error& e) {
-			_scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
+	void record(uint64_t id, event_type event, std::string const* name, ftr::data_type type, T value) {
+		auto* w = db.get();
+		worker->push([w, id, event, name, type, value]() { w->writeAttribute(id, event, *name, type, value); });
+	}
+
+public:
+	bool open(std::string const& name) override {
+		db.reset(new ftr_writer<COMPRESSED>(name + ".ftr"));
+		if(!db->cw.enc.ofs.is_open()) {
+			db.reset();
+			return false;
 		}
+		double secs = sc_core::sc_time::from_value(1ULL).to_seconds();
+		auto exp = rint(log(secs) / log(10.0));
+		db->writeInfo(static_cast<int8_t>(exp));
+		worker.reset(new ftr_worker());
+		return true;
 	}
-	// ----------------------------------------------------------------------------
-	static inline std::string get_name(const char* prefix, const scv_extensions_if* my_exts_p) {
-	    string name{prefix};
-		if(!prefix || strlen(prefix) == 0) {
-			name = my_exts_p->get_name();
-		} else {
-        if((my_exts_p->get_name() != nullptr) && (strlen(my_exts_p->get_name()) > 0)) {
-            name += ".";
-            name += my_exts_p->get_name();
-			}
+
+	void close() override {
+		if(worker) {
+			auto error = worker->finish();
+			worker.reset();
+			if(error.size())
+				_scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, error.c_str());
 		}
-		return (name == "") ? "<unnamed>" : name;
+		names.clear();
+		db.reset();
 	}
-	// ----------------------------------------------------------------------------
-	static void recordAttributes(uint64_t id, event_type eventType, char const* prefix, const scv_extensions_if* my_exts_p) {
-		if(!db || my_exts_p == nullptr)
-			return;
-		auto name = get_name(prefix, my_exts_p);
-		switch(my_exts_p->get_type()) {
-		case scv_extensions_if::RECORD: {
-			int num_fields = my_exts_p->get_num_fields();
-			if(num_fields > 0) {
-				for(int field_counter = 0; field_counter < num_fields; field_counter++) {
-					const scv_extensions_if* field_data_p = my_exts_p->get_field(field_counter);
-					recordAttributes(id, eventType, prefix, field_data_p);
-				}
-			}
-		} break;
-		case scv_extensions_if::ENUMERATION:
-			recordAttribute(id, eventType, name, ftr::data_type::ENUMERATION,
-					my_exts_p->get_enum_string((int)(my_exts_p->get_integer())));
-			break;
-		case scv_extensions_if::BOOLEAN:
-			recordAttribute(id, eventType, name, ftr::data_type::BOOLEAN, my_exts_p->get_bool());
+
+	void stream(uint64_t id, std::string const& name, std::string const& kind) override {
+		auto* w = db.get();
+		worker->push([w, id, name, kind]() { w->writeStream(id, name, kind); });
+	}
+
+	void generator(uint64_t id, std::string const& name, uint64_t stream,
+			std::vector<scc::tx::attribute_desc> const&) override {
+		auto* w = db.get();
+		worker->push([w, id, name, stream]() { w->writeGenerator(id, name, stream); });
+	}
+
+	void begin_transaction(uint64_t id, uint64_t generator, uint64_t stream, uint64_t time) override {
+		auto* w = db.get();
+		auto t = to_ps(time);
+		worker->push([w, id, generator, stream, t]() { w->startTransaction(id, generator, stream, t); });
+	}
+
+	void end_transaction(uint64_t id, uint64_t, uint64_t time) override {
+		auto* w = db.get();
+		auto t = to_ps(time);
+		worker->push([w, id, t]() { w->endTransaction(id, t); });
+	}
+
+	void attribute(uint64_t id, scc::tx::event_type event, std::string const& name,
+			scc::tx::value const& val) override {
+		auto evt = get_event(event);
+		auto* n = intern(name);
+		// the integer types are written as long long like the values of the SCV extensions
+		switch(val.type) {
+		case scc::tx::BOOLEAN:
+			record(id, evt, n, ftr::data_type::BOOLEAN, val.b);
 			break;
-		case scv_extensions_if::INTEGER:
-		case scv_extensions_if::FIXED_POINT_INTEGER:
-			recordAttribute(id, eventType, name, ftr::data_type::INTEGER, my_exts_p->get_integer());
+		case scc::tx::INTEGER:
+			record(id, evt, n, ftr::data_type::INTEGER, static_cast<long long>(val.i));
 			break;
-		case scv_extensions_if::UNSIGNED:
-			recordAttribute(id, eventType, name, ftr::data_type::UNSIGNED, my_exts_p->get_integer());
+		case scc::tx::UNSIGNED:
+			record(id, evt, n, ftr::data_type::UNSIGNED, static_cast<long long>(val.u));
 			break;
-		case scv_extensions_if::POINTER:
-			recordAttribute(id, eventType, name, ftr::data_type::POINTER, (long long)my_exts_p->get_pointer());
+		case scc::tx::FLOATING_POINT_NUMBER:
+			record(id, evt, n, ftr::data_type::FLOATING_POINT_NUMBER, val.d);
 			break;
-		case scv_extensions_if::STRING:
-			recordAttribute(id, eventType, name, ftr::data_type::STRING, my_exts_p->get_string());
+		case scc::tx::ENUMERATION:
+			record(id, evt, n, ftr::data_type::ENUMERATION, val.str);
 			break;
-		case scv_extensions_if::FLOATING_POINT_NUMBER:
-			recordAttribute(id, eventType, name, ftr::data_type::FLOATING_POINT_NUMBER, my_exts_p->get_double());
+		case scc::tx::BIT_VECTOR:
+			record(id, evt, n, ftr::data_type::BIT_VECTOR, val.str);
 			break;
-		case scv_extensions_if::BIT_VECTOR: {
-			sc_bv_base tmp_bv(my_exts_p->get_bitwidth());
-			my_exts_p->get_value(tmp_bv);
-			recordAttribute(id, eventType, name, ftr::data_type::BIT_VECTOR, tmp_bv.to_string());
-		} break;
-		case scv_extensions_if::LOGIC_VECTOR: {
-			sc_lv_base tmp_lv(my_exts_p->get_bitwidth());
-			my_exts_p->get_value(tmp_lv);
-			recordAttribute(id, eventType, name, ftr::data_type::LOGIC_VECTOR, tmp_lv.to_string());
-		} break;
-		case scv_extensions_if::ARRAY:
-			for(int array_elt_index = 0; array_elt_index < my_exts_p->get_array_size(); array_elt_index++) {
-				const scv_extensions_if* field_data_p = my_exts_p->get_array_elt(array_elt_index);
-				recordAttributes(id, eventType, prefix, field_data_p);
-			}
+		case scc::tx::LOGIC_VECTOR:
+			record(id, evt, n, ftr::data_type::LOGIC_VECTOR, val.str);
 			break;
-		default: {
-			std::array<char, 100> tmpString;
-			sprintf(tmpString.data(), "Unsupported attribute type = %d", my_exts_p->get_type());
-			_scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, tmpString.data());
-		}
+		default:
+			record(id, evt, n, ftr::data_type::STRING, val.str);
 		}
 	}
-	// ----------------------------------------------------------------------------
-	static void generatorCb(const scv_tr_generator_base& g, scv_tr_generator_base::callback_reason reason, void* data) {
-		if(db && reason == scv_tr_generator_base::CREATE) {
-			try {
-				db->writeGenerator(g.get_id(), g.get_name(), g.get_scv_tr_stream().get_id());
-			} catch(std::runtime_error& e) {
-				_scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create generator entry");
-			}
-		}
+	//! only the dispatcher drives this backend and it provides the streams, see stream_relation()
+	void relation(std::string const& name, uint64_t sink_id, uint64_t src_id) override {
+		stream_relation(name, sink_id, 0, src_id, 0);
 	}
-	// ----------------------------------------------------------------------------
-	static void transactionCb(const scv_tr_handle& t, scv_tr_handle::callback_reason reason, void* data) {
-		if(!db ||
-				!t.get_scv_tr_stream().get_scv_tr_db() ||
-				!t.get_scv_tr_stream().get_scv_tr_db()->get_recording())
-			return;
-		uint64_t id = t.get_id();
-		switch(reason) {
-		case scv_tr_handle::BEGIN: {
-			db->startTransaction(id, t.get_scv_tr_generator_base().get_id(),
-					t.get_scv_tr_generator_base().get_scv_tr_stream().get_id(), t.get_begin_sc_time()/sc_core::sc_time(1, sc_core::SC_PS));
 
-			auto my_exts_p = t.get_begin_exts_p();
-			if(my_exts_p == nullptr)
-				my_exts_p = t.get_scv_tr_generator_base().get_begin_exts_p();
-			if(my_exts_p) {
-				auto tmp_str = t.get_scv_tr_generator_base().get_begin_attribute_name() ?
-						t.get_scv_tr_generator_base().get_begin_attribute_name() : "";
-				recordAttributes(id, event_type::BEGIN, tmp_str, my_exts_p);
-			}
-		} break;
-		case scv_tr_handle::END: {
-			auto my_exts_p = t.get_end_exts_p();
-			if(my_exts_p == nullptr)
-				my_exts_p = t.get_scv_tr_generator_base().get_end_exts_p();
-			if(my_exts_p) {
-				auto tmp_str = t.get_scv_tr_generator_base().get_end_attribute_name() ?
-						t.get_scv_tr_generator_base().get_end_attribute_name() : "";
-				recordAttributes(id, event_type::END, tmp_str, my_exts_p);
-			}
-			db->endTransaction(id, t.get_end_sc_time()/sc_core::sc_time(1, sc_core::SC_PS));
-		} break;
-		default:;
-		}
-	}
-	// ----------------------------------------------------------------------------
-	static void attributeCb(const scv_tr_handle& t, const char* name, const scv_extensions_if* ext, void* data) {
-		if(!db ||
-				! t.get_scv_tr_stream().get_scv_tr_db()||
-				! t.get_scv_tr_stream().get_scv_tr_db()->get_recording())
-			return;
-		recordAttributes(t.get_id(), event_type::RECORD, name == nullptr ? "" : name, ext);
-	}
-	// ----------------------------------------------------------------------------
-	static void relationCb(const scv_tr_handle& tr_1, const scv_tr_handle& tr_2, void* data,
-			scv_tr_relation_handle_t relation_handle) {
-	    auto& stream1 = tr_1.get_scv_tr_stream();
-	    auto txdb = stream1.get_scv_tr_db();
-		if(!db || !txdb || !txdb->get_recording())
-			return;
-		try {
-	        auto& stream2 = tr_2.get_scv_tr_stream();
-			db->writeRelation(txdb->get_relation_name(relation_handle), stream1.get_id(), tr_1.get_id(), stream2.get_id(), tr_2.get_id());
-		} catch(std::runtime_error& e) {
-			_scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create transaction relation");
-		}
+	void stream_relation(std::string const& name, uint64_t sink_id, uint64_t sink_stream, uint64_t src_id,
+			uint64_t src_stream) override {
+		auto* w = db.get();
+		worker->push([w, name, sink_stream, sink_id, src_stream, src_id]() {
+			w->writeRelation(name, sink_stream, sink_id, src_stream, src_id);
+		});
 	}
 };
-template<bool COMPRESSED>
-ftr_writer<COMPRESSED>* tx_db<COMPRESSED>::db{nullptr};
 } // namespace
 // ----------------------------------------------------------------------------
 void scv_tr_cbor_init(bool compressed) {
-	if(compressed){
-		scv_tr_db::register_class_cb(tx_db<true>::dbCb);
-		scv_tr_stream::register_class_cb(tx_db<true>::streamCb);
-		scv_tr_generator_base::register_class_cb(tx_db<true>::generatorCb);
-		scv_tr_handle::register_class_cb(tx_db<true>::transactionCb);
-		scv_tr_handle::register_record_attribute_cb(tx_db<true>::attributeCb);
-		scv_tr_handle::register_relation_cb(tx_db<true>::relationCb);
-
-	} else {
-		scv_tr_db::register_class_cb(tx_db<false>::dbCb);
-		scv_tr_stream::register_class_cb(tx_db<false>::streamCb);
-		scv_tr_generator_base::register_class_cb(tx_db<false>::generatorCb);
-		scv_tr_handle::register_class_cb(tx_db<false>::transactionCb);
-		scv_tr_handle::register_record_attribute_cb(tx_db<false>::attributeCb);
-		scv_tr_handle::register_relation_cb(tx_db<false>::relationCb);
-	}
+	if(compressed)
+		scc::tx::dispatcher::get().add(std::unique_ptr<scc::tx::backend>(new ftr_backend<true>));
+	else
+		scc::tx::dispatcher::get().add(std::unique_ptr<scc::tx::backend>(new ftr_backend<false>));
 }
 // ----------------------------------------------------------------------------
 #ifndef HAS_SCV
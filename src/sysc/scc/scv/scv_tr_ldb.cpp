@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2018 MINRES Technologies GmbH
+ * Copyright 2018-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -14,19 +14,28 @@
  * limitations under the License.
  *******************************************************************************/
 #include "leveldb/db.h"
+#include "leveldb/write_batch.h"
+#include "scv_tr_dispatcher.h"
+#include <cci_configuration>
 #include <json/json.h>
 
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
+#include <deque>
 #include <fcntl.h>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -57,8 +66,89 @@ const char* EventTypeStr[] = {"BEGIN", "RECORD", "END"};
 using data_type = scv_extensions_if::data_type;
 // ----------------------------------------------------------------------------
 namespace {
+/**
+ * the thread writing the batches to the database so that the simulation only waits if the writer falls behind
+ */
+class batch_writer {
+public:
+    batch_writer(DB* db, WriteOptions const& options)
+    : db(db)
+    , options(options)
+    , thread([this]() { run(); }) {}
+
+    ~batch_writer() { finish(); }
+    //! hand over a batch, blocks if too many batches are pending
+    void push(unique_ptr<WriteBatch>&& batch) {
+        unique_lock<mutex> lock(mtx);
+        cond.wait(lock, [this]() { return queue.size() < max_pending; });
+        queue.push_back(move(batch));
+        cond.notify_all();
+    }
+    //! wait until all pending batches are written
+    void drain() {
+        unique_lock<mutex> lock(mtx);
+        cond.wait(lock, [this]() { return queue.empty() && !busy; });
+    }
+    //! write the pending batches and stop the thread, returns the first error
+    Status finish() {
+        {
+            lock_guard<mutex> lock(mtx);
+            stop = true;
+            cond.notify_all();
+        }
+        if(thread.joinable())
+            thread.join();
+        return status;
+    }
+
+private:
+    void run() {
+        unique_lock<mutex> lock(mtx);
+        while(true) {
+            cond.wait(lock, [this]() { return stop || !queue.empty(); });
+            if(queue.empty())
+                return;
+            auto batch = move(queue.front());
+            queue.pop_front();
+            busy = true;
+            cond.notify_all();
+            lock.unlock();
+            auto res = db->Write(options, batch.get());
+            lock.lock();
+            if(status.ok() && !res.ok())
+                status = res;
+            busy = false;
+            cond.notify_all();
+        }
+    }
+    static const size_t max_pending = 4;
+    DB* db;
+    WriteOptions options;
+    mutex mtx;
+    condition_variable cond;
+    deque<unique_ptr<WriteBatch>> queue;
+    bool stop{false};
+    bool busy{false};
+    Status status;
+    std::thread thread;
+};
+/**
+ * get a setting of the database, the value is taken from the CCI parameter or preset value
+ * scv_tr_ldb.<name> if there is one
+ */
+template <typename T> T get_setting(char const* name, T def) {
+    static cci::cci_originator originator("scv_tr_ldb");
+    auto broker = cci::cci_get_global_broker(originator);
+    auto param_name = string("scv_tr_ldb.") + name;
+    auto h = broker.get_param_handle(param_name);
+    auto val = h.is_valid() ? h.get_cci_value() : broker.get_preset_cci_value(param_name);
+    T res;
+    return val.try_get(res) ? res : def;
+}
 
 struct Database {
+    //! the minimum size of a batch being handed to the writer, batches always hold complete time steps
+    static const size_t min_batch_size = 1 << 20;
 
     Database(const string& name)
     : key_len(1024) {
@@ -66,16 +156,27 @@ struct Database {
         CharReaderBuilder::strictMode(&rbuilder.settings_);
         Options options;
         options.create_if_missing = true;
-        options.compression = kSnappyCompression;
+        options.compression = get_setting("compression", true) ? kSnappyCompression : kNoCompression;
+        options.write_buffer_size = get_setting<uint64_t>("write_buffer_size", 64 << 20);
         DestroyDB(name, options);
         if(!DB::Open(options, name, &db).ok())
             throw runtime_error("Could not create database");
         key_buf = new char[key_len];
+        writer.reset(new batch_writer(db, write_options));
     }
 
     ~Database() {
+        writer.reset();
         delete db;
-        delete key_buf;
+        delete[] key_buf;
+    }
+    //! write all pending entries, throws runtime_error if the database could not be written
+    void close() {
+        pending_time = numeric_limits<uint64_t>::max();
+        flush();
+        auto status = writer->finish();
+        if(!status.ok())
+            throw runtime_error(status.ToString());
     }
     /**
      *
@@ -83,7 +184,8 @@ struct Database {
      * @param val   the JSON Value to write
      */
     inline bool writeEntry(string& key, Value& val) {
-        return db->Put(write_options, Slice(key.c_str(), key.size()), writeString(wbuilder, val)).ok();
+        batch->Put(Slice(key.c_str(), key.size()), writeString(wbuilder, val));
+        return true;
     }
     /**
      *
@@ -91,7 +193,8 @@ struct Database {
      * @param val   the JSON Value to write
      */
     inline bool writeEntry(string&& key, Value& val) {
-        return db->Put(write_options, Slice(key.c_str(), key.size()), writeString(wbuilder, val)).ok();
+        batch->Put(Slice(key.c_str(), key.size()), writeString(wbuilder, val));
+        return true;
     }
     /**
      *
@@ -105,7 +208,7 @@ struct Database {
         node["id"] = id;
         node["name"] = name;
         node["kind"] = kind;
-        db->Put(write_options, Slice(key_buf, len), writeString(wbuilder, node));
+        batch->Put(Slice(key_buf, len), writeString(wbuilder, node));
     }
     /**
      *
@@ -119,7 +222,7 @@ struct Database {
         node["id"] = id;
         node["name"] = name;
         node["stream"] = stream;
-        db->Put(write_options, Slice(key_buf, len), writeString(wbuilder, node));
+        batch->Put(Slice(key_buf, len), writeString(wbuilder, node));
     }
     /**
      *
@@ -133,14 +236,14 @@ struct Database {
         val["s"] = stream_id;
         val["g"] = generator_id;
         val["conc"] = concurrencyLevel;
-        db->Put(write_options,
-                Slice(key_buf, sprintf(key_buf, "sgx~" scv_tr_TEXT_16LLX "~" scv_tr_TEXT_16LLX "~" scv_tr_TEXT_16LLX,
-                                       stream_id, generator_id, id)),
-                "");
+        batch->Put(Slice(key_buf, sprintf(key_buf, "sgx~" scv_tr_TEXT_16LLX "~" scv_tr_TEXT_16LLX "~" scv_tr_TEXT_16LLX,
+                                          stream_id, generator_id, id)),
+                   "");
         tx_lut[id] = val;
-        // db->Put(write_options, Slice(key, sprintf(key, "x~" scv_tr_TEXT_16LLX, id)), writeString(wbuilder, val));
     }
     /**
+     * The ids of a time point are collected in memory until the simulation time advances instead of reading back
+     * and rewriting the entry for each transaction.
      *
      * @param id        transaction id
      * @param streamid  stream transaction id
@@ -148,17 +251,28 @@ struct Database {
      * @param time
      */
     inline void writeTxTimepoint(uint64_t id, uint64_t streamid, EventType type, uint64_t time) {
-        string value;
-        Value node{arrayValue};
+        auto now = sc_time_stamp().value();
+        if(now != pending_time) {
+            pending_time = now;
+            if(batch->ApproximateSize() >= min_batch_size)
+                flush();
+        }
         auto len =
             sprintf(key_buf, "st~" scv_tr_TEXT_16LLX "~" scv_tr_TEXT_16LLX "~%s", streamid, time, EventTypeStr[type]);
-        if(db->Get(read_options, key_buf, &value).ok() &&
-           rbuilder.newCharReader()->parse(value.data(), value.data() + value.size(), &node, nullptr)) {
-            node[node.size()] = Value(id);
-        } else {
-            node[0u] = Value(id);
+        auto it = timepoints.find(string(key_buf, len));
+        if(it == timepoints.end()) {
+            it = timepoints.emplace(string(key_buf, len), timepoint{time, Value{arrayValue}, false}).first;
+            // an entry of a time point which has been flushed already needs to be read back
+            if(time < oldest_timepoint) {
+                string value;
+                writer->drain();
+                if(db->Get(read_options, it->first, &value).ok())
+                    unique_ptr<CharReader>(rbuilder.newCharReader())
+                        ->parse(value.data(), value.data() + value.size(), &it->second.ids, nullptr);
+            }
         }
-        db->Put(write_options, Slice(key_buf, len), writeString(wbuilder, node));
+        it->second.ids.append(Value(id));
+        it->second.dirty = true;
         updateTx(id, type, time);
     }
 
@@ -167,14 +281,12 @@ struct Database {
         auto& node = tx_lut[id];
         node[typeStr[type]] = time;
         if(type == END) {
-            db->Put(write_options, Slice(key_buf, sprintf(key_buf, "x~" scv_tr_TEXT_16LLX, id)),
-                    writeString(wbuilder, node));
+            batch->Put(Slice(key_buf, sprintf(key_buf, "x~" scv_tr_TEXT_16LLX, id)), writeString(wbuilder, node));
             tx_lut.erase(id);
         }
     }
 
     inline void updateTx(uint64_t id, Value&& val) {
-        auto len = sprintf(key_buf, "x~" scv_tr_TEXT_16LLX, id);
         auto& node = tx_lut[id];
         auto& arrNode = node["attr"];
         if(arrNode.isNull()) {
@@ -185,7 +297,6 @@ struct Database {
             arrNode.append(val);
         }
     }
-
     /**
      *
      * @param id        transaction id
@@ -242,21 +353,41 @@ struct Database {
      */
     inline void writeRelation(const string& name, uint64_t sink_id, uint64_t src_id) {
         if(key_len < (name.size() + 32 + 5)) { // reallocate buffer if needed, making sure no buffer overflow
-            delete key_buf;
+            delete[] key_buf;
             key_len = name.size() + 32 + 5;
             key_buf = new char[key_len];
         }
-        db->Put(write_options,
-                Slice(key_buf, sprintf(key_buf, "ro~" scv_tr_TEXT_16LLX "~" scv_tr_TEXT_16LLX "~%s", src_id, sink_id,
-                                       name.c_str())),
-                "");
-        db->Put(write_options,
-                Slice(key_buf, sprintf(key_buf, "ri~" scv_tr_TEXT_16LLX "~" scv_tr_TEXT_16LLX "~%s", sink_id, src_id,
-                                       name.c_str())),
-                "");
+        batch->Put(Slice(key_buf, sprintf(key_buf, "ro~" scv_tr_TEXT_16LLX "~" scv_tr_TEXT_16LLX "~%s", src_id, sink_id,
+                                          name.c_str())),
+                   "");
+        batch->Put(Slice(key_buf, sprintf(key_buf, "ri~" scv_tr_TEXT_16LLX "~" scv_tr_TEXT_16LLX "~%s", sink_id, src_id,
+                                          name.c_str())),
+                   "");
     }
 
 private:
+    struct timepoint {
+        uint64_t time;
+        Value ids;
+        bool dirty;
+    };
+    //! move the collected entries to the writer, time points before the current time are not kept in memory
+    void flush() {
+        auto now = sc_time_stamp().value();
+        for(auto it = timepoints.begin(); it != timepoints.end();) {
+            if(it->second.dirty) {
+                batch->Put(it->first, writeString(wbuilder, it->second.ids));
+                it->second.dirty = false;
+            }
+            if(it->second.time < now || pending_time == numeric_limits<uint64_t>::max()) {
+                oldest_timepoint = max(oldest_timepoint, it->second.time + 1);
+                it = timepoints.erase(it);
+            } else
+                ++it;
+        }
+        writer->push(move(batch));
+        batch.reset(new WriteBatch);
+    }
     DB* db;
     ReadOptions read_options;
     WriteOptions write_options;
@@ -265,261 +396,112 @@ private:
     StreamWriterBuilder wbuilder;
     CharReaderBuilder rbuilder;
     unordered_map<uint64_t, Value> tx_lut;
+    unique_ptr<WriteBatch> batch{new WriteBatch};
+    unique_ptr<batch_writer> writer;
+    //! the time points of the pending batch
+    unordered_map<string, timepoint> timepoints;
+    //! the time step of the pending batch
+    uint64_t pending_time{0};
+    //! time points before this have been flushed
+    uint64_t oldest_timepoint{0};
 };
 
-vector<vector<uint64_t>> concurrencyLevel;
-
-Database* db;
-
-void dbCb(const scv_tr_db& _scv_tr_db, scv_tr_db::callback_reason reason, void* data) {
-    // This is called from the scv_tr_db ctor.
-    static string fName("DEFAULT_scv_tr_sqlite");
-    switch(reason) {
-    case scv_tr_db::CREATE:
-        if((_scv_tr_db.get_name() != nullptr) && (strlen(_scv_tr_db.get_name()) != 0))
-            fName = _scv_tr_db.get_name();
+/**
+ * The backend writing the LevelDB database, the SCV extensions are flattened by the \ref scc::tx::dispatcher
+ */
+class ldb_backend : public scc::tx::backend {
+public:
+    bool open(string const& name) override {
         try {
-            db = new Database(fName);
+            db.reset(new Database(name));
             Value val{objectValue};
             val["resolution"] = (long)(sc_get_time_resolution().to_seconds() * 1e15);
             db->writeEntry("__config", val);
         } catch(runtime_error& e) {
             _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, e.what());
-        } catch(...) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't open recording file");
-        }
-        break;
-    case scv_tr_db::DELETE:
-        try {
-            delete db;
-        } catch(...) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't close recording file");
-        }
-        break;
-    default:
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Unknown reason in scv_tr_db callback");
-    }
-}
-// ----------------------------------------------------------------------------
-void streamCb(const scv_tr_stream& s, scv_tr_stream::callback_reason reason, void* data) {
-    if(reason == scv_tr_stream::CREATE) {
-        try {
-            db->writeStream(s.get_id(), s.get_name(), s.get_stream_kind());
-        } catch(runtime_error& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create stream");
+            db.reset();
+            return false;
         }
+        return true;
     }
-}
-// ----------------------------------------------------------------------------
-void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, const string& value) {
-    try {
-        db->writeAttribute(id, event, name, type, value);
-    } catch(runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
-    }
-}
-// ----------------------------------------------------------------------------
-void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, long long value) {
-    try {
-        db->writeAttribute(id, event, name, type, static_cast<uint64_t>(value));
-    } catch(runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
+
+    void close() override {
+        concurrencyLevel.clear();
+        tx2stream.clear();
+        auto database = move(db);
+        database->close();
     }
-}
-// ----------------------------------------------------------------------------
-inline void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, double value) {
-    try {
-        db->writeAttribute(id, event, name, type, value);
-    } catch(runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
+
+    void stream(uint64_t id, string const& name, string const& kind) override { db->writeStream(id, name, kind); }
+
+    void generator(uint64_t id, string const& name, uint64_t stream,
+                   vector<scc::tx::attribute_desc> const& attributes) override {
+        db->writeGenerator(id, name, stream);
     }
-}
-// ----------------------------------------------------------------------------
-void recordAttributes(uint64_t id, EventType eventType, string& prefix, const scv_extensions_if* my_exts_p) {
-    if(my_exts_p == nullptr)
-        return;
-    string name;
-    if(prefix == "") {
-        name = my_exts_p->get_name();
-    } else {
-        if((my_exts_p->get_name() == nullptr) || (strlen(my_exts_p->get_name()) == 0)) {
-            name = prefix;
-        } else {
-            name = prefix + "." + my_exts_p->get_name();
-        }
+
+    void begin_transaction(uint64_t id, uint64_t generator, uint64_t stream, uint64_t time) override {
+        vector<uint64_t>& levels = concurrencyLevel[stream];
+        vector<uint64_t>::size_type concurrencyIdx;
+        for(concurrencyIdx = 0; concurrencyIdx < levels.size(); ++concurrencyIdx) // find a free slot
+            if(levels[concurrencyIdx] == 0)
+                break;
+        if(concurrencyIdx == levels.size())
+            levels.push_back(id);
+        else
+            levels[concurrencyIdx] = id;
+        tx2stream[id] = stream;
+        db->writeTransaction(id, stream, generator, concurrencyIdx);
+        db->writeTxTimepoint(id, stream, BEGIN, time);
     }
-    if(name == "")
-        name = "<unnamed>";
-    switch(my_exts_p->get_type()) {
-    case scv_extensions_if::RECORD: {
-        int num_fields = my_exts_p->get_num_fields();
-        if(num_fields > 0) {
-            for(int field_counter = 0; field_counter < num_fields; field_counter++) {
-                const scv_extensions_if* field_data_p = my_exts_p->get_field(field_counter);
-                recordAttributes(id, eventType, prefix, field_data_p);
+
+    void end_transaction(uint64_t id, uint64_t generator, uint64_t time) override {
+        auto it = tx2stream.find(id);
+        if(it == tx2stream.end())
+            return;
+        auto streamId = it->second;
+        tx2stream.erase(it);
+        db->writeTxTimepoint(id, streamId, END, time);
+        vector<uint64_t>& levels = concurrencyLevel[streamId];
+        for(auto& level : levels)
+            if(level == id) {
+                level = 0;
+                break;
             }
-        }
-    } break;
-    case scv_extensions_if::ENUMERATION:
-        recordAttribute(id, eventType, name, scv_extensions_if::ENUMERATION,
-                        my_exts_p->get_enum_string((int)(my_exts_p->get_integer())));
-        break;
-    case scv_extensions_if::BOOLEAN:
-        recordAttribute(id, eventType, name, scv_extensions_if::BOOLEAN, my_exts_p->get_bool() ? "TRUE" : "FALSE");
-        break;
-    case scv_extensions_if::INTEGER:
-    case scv_extensions_if::FIXED_POINT_INTEGER:
-        recordAttribute(id, eventType, name, scv_extensions_if::INTEGER, my_exts_p->get_integer());
-        break;
-    case scv_extensions_if::UNSIGNED:
-        recordAttribute(id, eventType, name, scv_extensions_if::UNSIGNED, my_exts_p->get_integer());
-        break;
-    case scv_extensions_if::POINTER:
-        recordAttribute(id, eventType, name, scv_extensions_if::POINTER, (long long)my_exts_p->get_pointer());
-        break;
-    case scv_extensions_if::STRING:
-        recordAttribute(id, eventType, name, scv_extensions_if::STRING, my_exts_p->get_string());
-        break;
-    case scv_extensions_if::FLOATING_POINT_NUMBER:
-        recordAttribute(id, eventType, name, scv_extensions_if::FLOATING_POINT_NUMBER, my_exts_p->get_double());
-        break;
-    case scv_extensions_if::BIT_VECTOR: {
-        sc_bv_base tmp_bv(my_exts_p->get_bitwidth());
-        my_exts_p->get_value(tmp_bv);
-        recordAttribute(id, eventType, name, scv_extensions_if::BIT_VECTOR, tmp_bv.to_string());
-    } break;
-    case scv_extensions_if::LOGIC_VECTOR: {
-        sc_lv_base tmp_lv(my_exts_p->get_bitwidth());
-        my_exts_p->get_value(tmp_lv);
-        recordAttribute(id, eventType, name, scv_extensions_if::LOGIC_VECTOR, tmp_lv.to_string());
-    } break;
-    case scv_extensions_if::ARRAY:
-        for(int array_elt_index = 0; array_elt_index < my_exts_p->get_array_size(); array_elt_index++) {
-            const scv_extensions_if* field_data_p = my_exts_p->get_array_elt(array_elt_index);
-            recordAttributes(id, eventType, prefix, field_data_p);
-        }
-        break;
-    default: {
-        array<char, 100> tmpString;
-        sprintf(tmpString.data(), "Unsupported attribute type = %d", my_exts_p->get_type());
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, tmpString.data());
-    }
     }
-}
-// ----------------------------------------------------------------------------
-void generatorCb(const scv_tr_generator_base& g, scv_tr_generator_base::callback_reason reason, void* data) {
-    if(reason == scv_tr_generator_base::CREATE && db) {
-        try {
-            db->writeGenerator(g.get_id(), g.get_name(), g.get_scv_tr_stream().get_id());
-        } catch(runtime_error& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create generator entry");
-        }
-    }
-}
-// ----------------------------------------------------------------------------
-void transactionCb(const scv_tr_handle& t, scv_tr_handle::callback_reason reason, void* data) {
-    if(!db)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
 
-    uint64_t id = t.get_id();
-    uint64_t streamId = t.get_scv_tr_stream().get_id();
-    vector<uint64_t>::size_type concurrencyIdx;
-    const scv_extensions_if* my_exts_p;
-    switch(reason) {
-    case scv_tr_handle::BEGIN: {
-        try {
-            if(concurrencyLevel.size() <= streamId)
-                concurrencyLevel.resize(streamId + 1);
-            vector<uint64_t>& levels = concurrencyLevel.at(streamId);
-            for(concurrencyIdx = 0; concurrencyIdx < levels.size(); ++concurrencyIdx) // find a free slot
-                if(levels[concurrencyIdx] == 0)
-                    break;
-            if(concurrencyIdx == levels.size())
-                levels.push_back(id);
-            else
-                levels[concurrencyIdx] = id;
-            db->writeTransaction(id, t.get_scv_tr_stream().get_id(), t.get_scv_tr_generator_base().get_id(),
-                                 concurrencyIdx);
-            db->writeTxTimepoint(id, t.get_scv_tr_stream().get_id(), BEGIN, t.get_begin_sc_time().value());
-        } catch(runtime_error& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, e.what());
-        }
-        my_exts_p = t.get_begin_exts_p();
-        if(my_exts_p == nullptr)
-            my_exts_p = t.get_scv_tr_generator_base().get_begin_exts_p();
-        if(my_exts_p) {
-            string tmp_str = t.get_scv_tr_generator_base().get_begin_attribute_name()
-                                 ? t.get_scv_tr_generator_base().get_begin_attribute_name()
-                                 : "";
-            recordAttributes(id, BEGIN, tmp_str, my_exts_p);
-        }
-    } break;
-    case scv_tr_handle::END: {
-        my_exts_p = t.get_end_exts_p();
-        if(my_exts_p == nullptr)
-            my_exts_p = t.get_scv_tr_generator_base().get_end_exts_p();
-        if(my_exts_p) {
-            string tmp_str = t.get_scv_tr_generator_base().get_end_attribute_name()
-                                 ? t.get_scv_tr_generator_base().get_end_attribute_name()
-                                 : "";
-            recordAttributes(t.get_id(), END, tmp_str, my_exts_p);
-        }
-        try {
-            db->writeTxTimepoint(id, t.get_scv_tr_stream().get_id(), END, t.get_end_sc_time().value());
-            vector<uint64_t>& levels = concurrencyLevel[streamId];
-            for(concurrencyIdx = 0; concurrencyIdx < levels.size(); ++concurrencyIdx)
-                if(levels[concurrencyIdx] == id)
-                    break;
-            if(concurrencyIdx == levels.size())
-                levels.push_back(0);
-            else
-                levels[concurrencyIdx] = 0;
-        } catch(runtime_error& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create transaction end");
+    void attribute(uint64_t id, scc::tx::event_type event, string const& name, scc::tx::value const& val) override {
+        auto type = static_cast<data_type>(val.type);
+        auto evt = static_cast<EventType>(event);
+        switch(val.type) {
+        case scc::tx::BOOLEAN:
+            db->writeAttribute(id, evt, name, type, string(val.b ? "TRUE" : "FALSE"));
+            break;
+        case scc::tx::INTEGER:
+            db->writeAttribute(id, evt, name, type, static_cast<uint64_t>(val.i));
+            break;
+        case scc::tx::UNSIGNED:
+            db->writeAttribute(id, evt, name, type, val.u);
+            break;
+        case scc::tx::FLOATING_POINT_NUMBER:
+            db->writeAttribute(id, evt, name, type, val.d);
+            break;
+        default:
+            db->writeAttribute(id, evt, name, type, val.str);
         }
-    } break;
-    default:;
     }
-}
-// ----------------------------------------------------------------------------
-void attributeCb(const scv_tr_handle& t, const char* name, const scv_extensions_if* ext, void* data) {
-    if(!db)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
-    string tmp_str(name == nullptr ? "" : name);
-    recordAttributes(t.get_id(), RECORD, tmp_str, ext);
-}
-// ----------------------------------------------------------------------------
-void relationCb(const scv_tr_handle& tr_1, const scv_tr_handle& tr_2, void* data,
-                scv_tr_relation_handle_t relation_handle) {
-    if(!db)
-        return;
-    if(tr_1.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(tr_1.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
-    try {
-        db->writeRelation(tr_1.get_scv_tr_stream().get_scv_tr_db()->get_relation_name(relation_handle), tr_1.get_id(),
-                          tr_2.get_id());
-    } catch(runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create transaction relation");
+
+    void relation(string const& name, uint64_t sink_id, uint64_t src_id) override {
+        db->writeRelation(name, sink_id, src_id);
     }
-}
+
+private:
+    unique_ptr<Database> db;
+    unordered_map<uint64_t, vector<uint64_t>> concurrencyLevel;
+    unordered_map<uint64_t, uint64_t> tx2stream;
+};
 } // namespace
 // ----------------------------------------------------------------------------
 void scv_tr_ldb_init() {
-    scv_tr_db::register_class_cb(dbCb);
-    scv_tr_stream::register_class_cb(streamCb);
-    scv_tr_generator_base::register_class_cb(generatorCb);
-    scv_tr_handle::register_class_cb(transactionCb);
-    scv_tr_handle::register_record_attribute_cb(attributeCb);
-    scv_tr_handle::register_relation_cb(relationCb);
+    scc::tx::dispatcher::get().add(unique_ptr<scc::tx::backend>(new ldb_backend));
 }
 // ----------------------------------------------------------------------------
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2018 MINRES Technologies GmbH
+ * Copyright 2018-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -13,19 +13,21 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  *******************************************************************************/
-#include <array>
-#include <boost/filesystem.hpp>
-#include <cmath>
-#include <cstdio>
+#include "scv_tr_dispatcher.h"
+#include <algorithm>
+#include <condition_variable>
 #include <cstring>
-#include <fcntl.h>
+#include <deque>
 #include <fstream>
-#include <iostream>
-#include <sstream>
+#include <lz4frame.h>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <util/thread_pool.h>
 #include <vector>
 // clang-format off
 #ifdef HAS_SCV
@@ -36,310 +38,248 @@ namespace scv_tr {
 #endif
 // clang-format on
 // ----------------------------------------------------------------------------
-// ----------------------------------------------------------------------------
-using namespace std;
-
-// ----------------------------------------------------------------------------
-enum EventType { BEGIN, RECORD, END };
-using data_type = scv_extensions_if::data_type;
-// ----------------------------------------------------------------------------
 namespace {
-class Base {
-protected:
-    boost::filesystem::path dir;
-    std::ofstream out;
-    bool const is_open;
-    std::array<char, 1024> buffer;
-    Base(const std::string& name)
-    : dir(name.c_str())
-    , out(name)
-    , is_open(out.is_open()) {
-        //        if(boost::filesystem::exists(dir))
-        //            boost::filesystem::remove_all(dir);
-        //        boost::filesystem::create_directory(dir);
-    }
-    ~Base() {
-        if(is_open)
-            out.close();
-    }
+namespace tx = scc::tx;
+
+struct string_sink : public tx::byte_sink {
+    std::string& buf;
+    explicit string_sink(std::string& buf)
+    : buf(buf) {}
+    void write(char const* data, size_t size) override { buf.append(data, size); }
 };
 
-struct Database : Base {
-    uint64_t idx{0};
-    Database(const std::string& name)
-    : Base(name) {}
+tx::sink_factory to_string(std::string& buf) {
+    return [&buf](std::string const&) { return std::unique_ptr<tx::byte_sink>(new string_sink(buf)); };
+}
 
-    inline uint64_t getIdOf(const std::string& str) { return idx; }
+std::vector<char> compress(std::string const& src) {
+    LZ4F_preferences_t prefs;
+    std::memset(&prefs, 0, sizeof(prefs));
+    std::vector<char> dst(LZ4F_compressFrameBound(src.size(), &prefs));
+    auto size = LZ4F_compressFrame(dst.data(), dst.size(), src.data(), src.size(), &prefs);
+    if(LZ4F_isError(size))
+        throw std::runtime_error(LZ4F_getErrorName(size));
+    dst.resize(size);
+    return dst;
+}
+/**
+ * a recorded call of a transaction, the formatting is deferred to the worker threads
+ */
+struct record {
+    enum kind_type { TX_BEGIN, TX_END, ATTRIBUTE };
+    kind_type kind;
+    tx::event_type event;
+    uint64_t id;
+    uint64_t generator;
+    uint64_t time;
+    std::string const* name;
+    tx::value val;
+};
+/**
+ * The recorder writing the LZ4 compressed text format using all cores.
+ *
+ * Each stream collects its transactions in chunks which are formatted and compressed by a worker pool. The chunks of
+ * a stream are processed one after the other by one worker at a time while different streams are processed in
+ * parallel. Each chunk becomes an LZ4 frame of the file so the file is the concatenation of the frames. Stream and
+ * generator definitions are written before the chunks referring to them, relations are written at the end when all
+ * transactions are known.
+ */
+class mtc_backend : public tx::backend {
+    static const size_t chunk_size = 4096;
 
-    inline void writeStream(uint64_t id, std::string const& name, std::string const& kind) {
-        if(is_open) {
-            auto len = sprintf(buffer.data(), "scv_tr_stream (ID %lu, name \"%s\", kind \"%s\")\n", id, name.c_str(),
-                               kind.c_str());
-            out.write(buffer.data(), len);
+    struct stream_state {
+        std::string text;
+        tx::text_backend encoder;
+        std::vector<record> current;
+        //! the chunks waiting for the worker, guarded by mtx
+        std::deque<std::vector<record>> pending;
+        bool scheduled{false};
+        std::mutex mtx;
+        stream_state()
+        : encoder(to_string(text)) {
+            encoder.open("");
+            current.reserve(chunk_size);
         }
-    }
+    };
 
-    inline void writeGenerator(uint64_t id, std::string const& name, uint64_t stream) {
-        if(is_open) {
-            auto len = sprintf(buffer.data(), "scv_tr_generator (ID %lu, name \"%s\", scv_tr_stream %lu,\n", id,
-                               name.c_str(), stream);
-            out.write(buffer.data(), len);
-        }
+    struct relation_info {
+        std::string name;
+        uint64_t sink;
+        uint64_t src;
+    };
+
+public:
+    bool open(std::string const& name) override {
+        out.open(name, std::ios::binary | std::ios::trunc);
+        if(!out.is_open())
+            return false;
+        defs.open("");
+        auto cores = std::max(2U, std::thread::hardware_concurrency());
+        max_pending = 4 * cores;
+        pool.reset(new util::thread_pool);
+        pool->start(cores - 1);
+        return true;
     }
 
-    inline uint64_t writeTransaction(uint64_t id, uint64_t generator) {
-        return ++idx; // d.writeTx(id, generator, concurrencyLevel);
+    void close() override {
+        for(auto& e : streams)
+            flush(*e.second);
+        write_definitions();
+        pool.reset();
+        for(auto& r : relations)
+            defs.relation(r.name, r.sink, r.src);
+        write_definitions();
+        out.close();
+        defs.close();
+        streams.clear();
+        tx2stream.clear();
+        relations.clear();
+        names.clear();
+        if(!error.empty())
+            throw std::runtime_error(error);
     }
 
-    inline void writeTxTimepoint(uint64_t id, int type, uint64_t time, uint64_t file_offset) {
-        //        t.append(type, time, file_offset);
+    void stream(uint64_t id, std::string const& name, std::string const& kind) override {
+        streams[id].reset(new stream_state);
+        defs.stream(id, name, kind);
     }
 
-    inline void writeAttribute(uint64_t id, EventType event, const string& name, data_type type, const string& value) {
-        //        d.writeAttribute(id, event, c.getIdOf(name), type, c.getIdOf(value));
+    void generator(uint64_t id, std::string const& name, uint64_t stream,
+                   std::vector<tx::attribute_desc> const& attributes) override {
+        defs.generator(id, name, stream, attributes);
     }
 
-    inline void writeAttribute(uint64_t id, EventType event, const string& name, data_type type, uint64_t value) {
-        //        d.writeAttribute(id, event, c.getIdOf(name), type, value);
+    void begin_transaction(uint64_t id, uint64_t generator, uint64_t stream, uint64_t time) override {
+        auto it = streams.find(stream);
+        if(it == streams.end())
+            return;
+        tx2stream[id] = it->second.get();
+        push(*it->second, record{record::TX_BEGIN, tx::BEGIN, id, generator, time, nullptr, tx::value()});
     }
 
-    inline void writeAttribute(uint64_t id, EventType event, const string& name, data_type type, double value) {
-        //        int exponent;
-        //        const double mantissa = frexp(value, &exponent);
+    void end_transaction(uint64_t id, uint64_t generator, uint64_t time) override {
+        auto it = tx2stream.find(id);
+        if(it == tx2stream.end())
+            return;
+        push(*it->second, record{record::TX_END, tx::END, id, generator, time, nullptr, tx::value()});
+        tx2stream.erase(it);
     }
 
-    inline void writeRelation(const std::string& name, uint64_t sink_id, uint64_t src_id) {
-        //        d.writeRelation(c.getIdOf(name), src_id, sink_id);
+    void attribute(uint64_t id, tx::event_type event, std::string const& name, tx::value const& val) override {
+        auto it = tx2stream.find(id);
+        if(it == tx2stream.end())
+            return;
+        // the names are kept during the recording, the workers refer to them
+        auto* n = &*names.insert(name).first;
+        push(*it->second, record{record::ATTRIBUTE, event, id, 0, 0, n, val});
     }
-};
 
-Database* db;
-std::unordered_map<uint64_t, uint64_t> id2offset;
+    void relation(std::string const& name, uint64_t sink_id, uint64_t src_id) override {
+        relations.push_back(relation_info{name, sink_id, src_id});
+    }
 
-void dbCb(const scv_tr_db& _scv_tr_db, scv_tr_db::callback_reason reason, void* data) {
-    // This is called from the scv_tr_db ctor.
-    static string fName("DEFAULT_scv_tr_sqlite");
-    switch(reason) {
-    case scv_tr_db::CREATE:
-        if((_scv_tr_db.get_name() != nullptr) && (strlen(_scv_tr_db.get_name()) != 0))
-            fName = _scv_tr_db.get_name();
-        try {
-            db = new Database(fName);
-        } catch(...) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't open recording file");
-        }
-        break;
-    case scv_tr_db::DELETE:
-        try {
-            delete db;
-        } catch(...) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't close recording file");
-        }
-        break;
-    default:
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Unknown reason in scv_tr_db callback");
+private:
+    void push(stream_state& s, record&& rec) {
+        s.current.push_back(std::move(rec));
+        if(s.current.size() == chunk_size)
+            flush(s);
     }
-}
-// ----------------------------------------------------------------------------
-void streamCb(const scv_tr_stream& s, scv_tr_stream::callback_reason reason, void* data) {
-    if(reason == scv_tr_stream::CREATE) {
-        try {
-            db->writeStream(s.get_id(), s.get_name(), s.get_stream_kind());
-        } catch(std::runtime_error& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create stream");
+    //! hand the current chunk of a stream over to the workers, blocks if they fall behind
+    void flush(stream_state& s) {
+        if(s.current.empty())
+            return;
+        write_definitions();
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cond.wait(lock, [this]() { return pending_chunks < max_pending; });
+            ++pending_chunks;
         }
-    }
-}
-// ----------------------------------------------------------------------------
-inline void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, const string& value) {
-    try {
-        db->writeAttribute(id, event, name, type, value);
-    } catch(std::runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
-    }
-}
-// ----------------------------------------------------------------------------
-inline void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, long long value) {
-    try {
-        db->writeAttribute(id, event, name, type, static_cast<uint64_t>(value));
-    } catch(std::runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
-    }
-}
-// ----------------------------------------------------------------------------
-inline void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, double value) {
-    try {
-        db->writeAttribute(id, event, name, type, value);
-    } catch(std::runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
-    }
-}
-
-inline std::string get_name(const char* prefix, const scv_extensions_if* my_exts_p) {
-    static thread_local std::unordered_map<const scv_extensions_if*, std::string> name_lut;
-    auto it = name_lut.find(my_exts_p);
-    if(it != name_lut.end())
-        return it->second;
-    string name;
-    if(!prefix || strlen(prefix) == 0) {
-        name = my_exts_p->get_name();
-    } else {
-        if((my_exts_p->get_name() == nullptr) || (strlen(my_exts_p->get_name()) == 0)) {
-            name = prefix;
-        } else {
-            name = std::string(prefix) + "." + my_exts_p->get_name();
+        bool schedule;
+        {
+            std::lock_guard<std::mutex> lock(s.mtx);
+            s.pending.push_back(std::move(s.current));
+            schedule = !s.scheduled;
+            s.scheduled = true;
         }
+        s.current = std::vector<record>();
+        s.current.reserve(chunk_size);
+        if(schedule)
+            pool->post([this, &s]() { drain(s); });
     }
-    name_lut[my_exts_p] = (name == "") ? "<unnamed>" : name;
-    return (name == "") ? "<unnamed>" : name;
-}
-
-// ----------------------------------------------------------------------------
-void recordAttributes(uint64_t id, EventType eventType, char const* prefix, const scv_extensions_if* my_exts_p) {
-    if(my_exts_p == nullptr)
-        return;
-    auto name = get_name(prefix, my_exts_p);
-    switch(my_exts_p->get_type()) {
-    case scv_extensions_if::RECORD: {
-        int num_fields = my_exts_p->get_num_fields();
-        if(num_fields > 0) {
-            for(int field_counter = 0; field_counter < num_fields; field_counter++) {
-                const scv_extensions_if* field_data_p = my_exts_p->get_field(field_counter);
-                recordAttributes(id, eventType, prefix, field_data_p);
+    //! format and compress the pending chunks of a stream in their order
+    void drain(stream_state& s) {
+        while(true) {
+            std::vector<record> chunk;
+            {
+                std::lock_guard<std::mutex> lock(s.mtx);
+                if(s.pending.empty()) {
+                    s.scheduled = false;
+                    return;
+                }
+                chunk = std::move(s.pending.front());
+                s.pending.pop_front();
             }
+            try {
+                s.text.clear();
+                for(auto& r : chunk)
+                    switch(r.kind) {
+                    case record::TX_BEGIN:
+                        s.encoder.begin_transaction(r.id, r.generator, 0, r.time);
+                        break;
+                    case record::TX_END:
+                        s.encoder.end_transaction(r.id, r.generator, r.time);
+                        break;
+                    case record::ATTRIBUTE:
+                        s.encoder.attribute(r.id, r.event, *r.name, r.val);
+                        break;
+                    }
+                write(compress(s.text));
+            } catch(std::exception& e) {
+                std::lock_guard<std::mutex> lock(mtx);
+                if(error.empty())
+                    error = e.what();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                --pending_chunks;
+            }
+            cond.notify_all();
         }
-    } break;
-    case scv_extensions_if::ENUMERATION:
-        recordAttribute(id, eventType, name, scv_extensions_if::ENUMERATION,
-                        my_exts_p->get_enum_string((int)(my_exts_p->get_integer())));
-        break;
-    case scv_extensions_if::BOOLEAN:
-        recordAttribute(id, eventType, name, scv_extensions_if::BOOLEAN, my_exts_p->get_bool() ? "TRUE" : "FALSE");
-        break;
-    case scv_extensions_if::INTEGER:
-    case scv_extensions_if::FIXED_POINT_INTEGER:
-        recordAttribute(id, eventType, name, scv_extensions_if::INTEGER, my_exts_p->get_integer());
-        break;
-    case scv_extensions_if::UNSIGNED:
-        recordAttribute(id, eventType, name, scv_extensions_if::UNSIGNED, my_exts_p->get_integer());
-        break;
-    case scv_extensions_if::POINTER:
-        recordAttribute(id, eventType, name, scv_extensions_if::POINTER, (long long)my_exts_p->get_pointer());
-        break;
-    case scv_extensions_if::STRING:
-        recordAttribute(id, eventType, name, scv_extensions_if::STRING, my_exts_p->get_string());
-        break;
-    case scv_extensions_if::FLOATING_POINT_NUMBER:
-        recordAttribute(id, eventType, name, scv_extensions_if::FLOATING_POINT_NUMBER, my_exts_p->get_double());
-        break;
-    case scv_extensions_if::BIT_VECTOR: {
-        sc_bv_base tmp_bv(my_exts_p->get_bitwidth());
-        my_exts_p->get_value(tmp_bv);
-        recordAttribute(id, eventType, name, scv_extensions_if::BIT_VECTOR, tmp_bv.to_string());
-    } break;
-    case scv_extensions_if::LOGIC_VECTOR: {
-        sc_lv_base tmp_lv(my_exts_p->get_bitwidth());
-        my_exts_p->get_value(tmp_lv);
-        recordAttribute(id, eventType, name, scv_extensions_if::LOGIC_VECTOR, tmp_lv.to_string());
-    } break;
-    case scv_extensions_if::ARRAY:
-        for(int array_elt_index = 0; array_elt_index < my_exts_p->get_array_size(); array_elt_index++) {
-            const scv_extensions_if* field_data_p = my_exts_p->get_array_elt(array_elt_index);
-            recordAttributes(id, eventType, prefix, field_data_p);
-        }
-        break;
-    default: {
-        std::array<char, 100> tmpString;
-        sprintf(tmpString.data(), "Unsupported attribute type = %d", my_exts_p->get_type());
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, tmpString.data());
-    }
     }
-}
-// ----------------------------------------------------------------------------
-void generatorCb(const scv_tr_generator_base& g, scv_tr_generator_base::callback_reason reason, void* data) {
-    if(reason == scv_tr_generator_base::CREATE && db) {
-        try {
-            db->writeGenerator(g.get_id(), g.get_name(), g.get_scv_tr_stream().get_id());
-        } catch(std::runtime_error& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create generator entry");
-        }
+    //! write the definitions collected so far, they need to precede the chunks referring to them
+    void write_definitions() {
+        if(defs_text.empty())
+            return;
+        write(compress(defs_text));
+        defs_text.clear();
     }
-}
-// ----------------------------------------------------------------------------
-void transactionCb(const scv_tr_handle& t, scv_tr_handle::callback_reason reason, void* data) {
-    if(!db)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
 
-    uint64_t id = t.get_id();
-    vector<uint64_t>::size_type concurrencyIdx;
-    const scv_extensions_if* my_exts_p;
-    switch(reason) {
-    case scv_tr_handle::BEGIN: {
-        my_exts_p = t.get_begin_exts_p();
-        if(my_exts_p == nullptr)
-            my_exts_p = t.get_scv_tr_generator_base().get_begin_exts_p();
-        if(my_exts_p) {
-            auto tmp_str = t.get_scv_tr_generator_base().get_begin_attribute_name()
-                               ? t.get_scv_tr_generator_base().get_begin_attribute_name()
-                               : "";
-            recordAttributes(id, BEGIN, tmp_str, my_exts_p);
-        }
-    } break;
-    case scv_tr_handle::END: {
-        my_exts_p = t.get_end_exts_p();
-        if(my_exts_p == nullptr)
-            my_exts_p = t.get_scv_tr_generator_base().get_end_exts_p();
-        if(my_exts_p) {
-            auto tmp_str = t.get_scv_tr_generator_base().get_end_attribute_name()
-                               ? t.get_scv_tr_generator_base().get_end_attribute_name()
-                               : "";
-            recordAttributes(t.get_id(), END, tmp_str, my_exts_p);
-        }
-    } break;
-    default:;
-    }
-}
-// ----------------------------------------------------------------------------
-void attributeCb(const scv_tr_handle& t, const char* name, const scv_extensions_if* ext, void* data) {
-    if(!db)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
-    recordAttributes(t.get_id(), RECORD, name == nullptr ? "" : name, ext);
-}
-// ----------------------------------------------------------------------------
-void relationCb(const scv_tr_handle& tr_1, const scv_tr_handle& tr_2, void* data,
-                scv_tr_relation_handle_t relation_handle) {
-    if(!db)
-        return;
-    if(tr_1.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(tr_1.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
-    try {
-        db->writeRelation(tr_1.get_scv_tr_stream().get_scv_tr_db()->get_relation_name(relation_handle), tr_1.get_id(),
-                          tr_2.get_id());
-    } catch(std::runtime_error& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create transaction relation");
+    void write(std::vector<char> const& frame) {
+        std::lock_guard<std::mutex> lock(out_mtx);
+        out.write(frame.data(), frame.size());
     }
-}
+
+    std::ofstream out;
+    std::mutex out_mtx;
+    std::string defs_text;
+    tx::text_backend defs{to_string(defs_text)};
+    std::unordered_map<uint64_t, std::unique_ptr<stream_state>> streams;
+    std::unordered_map<uint64_t, stream_state*> tx2stream;
+    std::unordered_set<std::string> names;
+    std::vector<relation_info> relations;
+    std::unique_ptr<util::thread_pool> pool;
+    std::mutex mtx;
+    std::condition_variable cond;
+    size_t pending_chunks{0};
+    size_t max_pending{0};
+    std::string error;
+};
 } // namespace
 // ----------------------------------------------------------------------------
-void scv_tr_mtc_init() {
-    scv_tr_db::register_class_cb(dbCb);
-    scv_tr_stream::register_class_cb(streamCb);
-    scv_tr_generator_base::register_class_cb(generatorCb);
-    scv_tr_handle::register_class_cb(transactionCb);
-    scv_tr_handle::register_record_attribute_cb(attributeCb);
-    scv_tr_handle::register_relation_cb(relationCb);
-}
+void scv_tr_mtc_init() { tx::dispatcher::get().add(std::unique_ptr<tx::backend>(new mtc_backend)); }
 // ----------------------------------------------------------------------------
 #ifndef HAS_SCV
 }
+using scv_tr::mtc_backend;
 #endif
+std::unique_ptr<scc::tx::backend> scc::tx::create_mtc_backend() { return std::unique_ptr<backend>(new mtc_backend); }
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2014, 2018 MINRES Technologies GmbH
+ * Copyright 2014-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -13,26 +13,37 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  *******************************************************************************/
+#include "scv_tr_dispatcher.h"
 #include "sqlite3.h"
+#include <algorithm>
 #include <array>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
+#include <initializer_list>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
-#include <vector>
+#include <thread>
 #include <unordered_map>
+#include <vector>
+// clang-format off
 #ifdef HAS_SCV
 #include <scv.h>
 #else
 #include <scv-tr.h>
 namespace scv_tr {
 #endif
+// clang-format on
 // ----------------------------------------------------------------------------
 constexpr auto SQLITEWRAPPER_ERROR = 1000;
 constexpr auto with_transactions = false;
 // ----------------------------------------------------------------------------
 using namespace std;
+namespace tx = scc::tx;
+namespace {
 
 class SQLiteDB {
 public:
@@ -131,13 +142,119 @@ private:
     sqlite3* db{nullptr};
 };
 // ----------------------------------------------------------------------------
-static SQLiteDB db;
-static vector<vector<uint64_t>*> concurrencyLevel;
-static sqlite3_stmt *string_stmt, *stream_stmt, *gen_stmt, *tx_stmt, *evt_stmt, *attr_stmt, *rel_stmt;
+/**
+ * the values of a row to be inserted using one of the prepared statements, the integer values are bound to the
+ * first parameters followed by the text if there is one
+ */
+struct db_record {
+    sqlite3_stmt* stmt;
+    std::array<sqlite3_int64, 5> values;
+    unsigned count;
+    bool has_text;
+    std::string text;
+    db_record(sqlite3_stmt* stmt, std::initializer_list<sqlite3_int64> vals, bool has_text = false,
+              std::string const& text = std::string())
+    : stmt(stmt)
+    , count(vals.size())
+    , has_text(has_text)
+    , text(text) {
+        std::copy(vals.begin(), vals.end(), values.begin());
+    }
+};
 
-// ----------------------------------------------------------------------------
-enum EventType { BEGIN, RECORD, END };
-using data_type = scv_extensions_if::data_type;
+void execute(SQLiteDB& db, db_record const& r) {
+    for(unsigned i = 0; i < r.count; ++i)
+        sqlite3_bind_int64(r.stmt, i + 1, r.values[i]);
+    if(r.has_text)
+        sqlite3_bind_text(r.stmt, r.count + 1, r.text.c_str(), -1, SQLITE_STATIC);
+    db.exec(r.stmt);
+}
+/**
+ * the writer of the asynchronous mode. The simulation thread collects the records in a batch which is handed over
+ * to a background thread once it is full, taking the lock only for moving the batch. The background thread inserts
+ * each batch in a single SQL transaction. The queue of batches is not bounded so the simulation thread never waits
+ * for the database.
+ */
+class async_writer {
+public:
+    static constexpr size_t batch_size = 64 * 1024;
+
+    ~async_writer() { stop(); }
+
+    bool is_active() const { return thread.joinable(); }
+
+    void start(SQLiteDB& database) {
+        db = &database;
+        done = false;
+        error.clear();
+        batch.reserve(batch_size);
+        thread = std::thread([this]() { run(); });
+    }
+
+    void push(db_record&& r) {
+        batch.push_back(std::move(r));
+        if(batch.size() >= batch_size)
+            submit();
+    }
+    //! write the outstanding records and stop the background thread, errors are reported on the calling thread
+    void stop() {
+        if(!is_active())
+            return;
+        submit();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            done = true;
+        }
+        cond.notify_one();
+        thread.join();
+        if(!error.empty())
+            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, error.c_str());
+    }
+
+private:
+    void submit() {
+        if(batch.empty())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            queue.push_back(std::move(batch));
+        }
+        cond.notify_one();
+        batch = std::vector<db_record>();
+        batch.reserve(batch_size);
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while(true) {
+            cond.wait(lock, [this]() -> bool { return done || !queue.empty(); });
+            if(queue.empty())
+                return;
+            auto records = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+            try {
+                db->exec("BEGIN TRANSACTION");
+                for(auto& r : records)
+                    execute(*db, r);
+                db->exec("COMMIT TRANSACTION");
+            } catch(SQLiteDB::SQLiteException& e) {
+                if(error.empty())
+                    error = std::string("Can't write transaction records: ") + e.errorMessage();
+            }
+            lock.lock();
+        }
+    }
+
+    SQLiteDB* db{nullptr};
+    std::vector<db_record> batch;
+    std::deque<std::vector<db_record>> queue;
+    std::mutex mtx;
+    std::condition_variable cond;
+    bool done{false};
+    std::string error;
+    std::thread thread;
+};
 // ----------------------------------------------------------------------------
 #define SIM_PROPS "ScvSimProps"
 #define STRING_TABLE "ScvStrings"
@@ -147,26 +264,28 @@ using data_type = scv_extensions_if::data_type;
 #define TX_EVENT_TABLE "ScvTxEvent"
 #define TX_ATTRIBUTE_TABLE "ScvTxAttribute"
 #define TX_RELATION_TABLE "ScvTxRelation"
+/**
+ * The backend writing the SQLite database. The attribute values are stored as text, the SCV extensions are
+ * flattened by the \ref scc::tx::dispatcher
+ */
+class sqlite_backend : public tx::backend {
+public:
+    explicit sqlite_backend(bool async)
+    : async_mode(async) {}
 
-static void dbCb(const scv_tr_db& _scv_tr_db, scv_tr_db::callback_reason reason, void* data) {
-    char* tail = nullptr;
-    // This is called from the scv_tr_db ctor.
-    static string fName("DEFAULT_scv_tr_sqlite");
-    switch(reason) {
-    case scv_tr_db::CREATE:
-        if((_scv_tr_db.get_name() != nullptr) && (strlen(_scv_tr_db.get_name()) != 0))
-            fName = _scv_tr_db.get_name();
+    bool open(std::string const& name) override {
         try {
-            remove(fName.c_str());
-            db.open(fName);
+            remove(name.c_str());
+            db.open(name);
             // performance related according to
             // http://blog.quibb.org/2010/08/fast-bulk-inserts-into-sqlite/
             db.exec("PRAGMA synchronous=OFF");
             db.exec("PRAGMA count_changes=OFF");
             db.exec("PRAGMA journal_mode=OFF");
             db.exec("PRAGMA temp_store=MEMORY");
-            // scv_out << "TB Transaction Recording has started, file = " <<
-            // my_sqlite_file_name << endl;
+            // the write ahead log allows reading the database while it is being written
+            if(async_mode)
+                db.exec("PRAGMA journal_mode=WAL");
             db.exec("CREATE TABLE  IF NOT EXISTS " STRING_TABLE "("
             		"id INTEGER NOT null PRIMARY KEY, "
             		"value TEXT"
@@ -207,7 +326,7 @@ static void dbCb(const scv_tr_db& _scv_tr_db, scv_tr_db::callback_reason reason,
 					"sink INTEGER REFERENCES " TX_TABLE "(id)"
 					");");
             db.exec("CREATE TABLE IF NOT EXISTS " SIM_PROPS "(time_resolution INTEGER);");
-            if(with_transactions) db.exec("BEGIN TRANSACTION");
+            if(with_transactions && !async_mode) db.exec("BEGIN TRANSACTION");
             std::ostringstream ss;
             ss << "INSERT INTO " SIM_PROPS " (time_resolution) values ("
                << (long)(sc_core::sc_get_time_resolution().to_seconds() * 1e15) << ");";
@@ -224,284 +343,134 @@ static void dbCb(const scv_tr_db& _scv_tr_db, scv_tr_db::callback_reason reason,
                                    "values (@ID,@EVENTID,@NAME,@TYPE,@VALUE);");
             rel_stmt = db.prepare("INSERT INTO " TX_RELATION_TABLE " (name,sink,src)"
                                   "values (@NAME,@ID1,@ID2);");
+            if(async_mode)
+                writer.start(db);
         } catch(SQLiteDB::SQLiteException& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't open recording file");
-        }
-        break;
-    case scv_tr_db::DELETE:
-        try {
-            // scv_out << "Transaction Recording is closing file: " <<
-            // my_sqlite_file_name << endl;
-        	if(with_transactions) db.exec("COMMIT TRANSACTION");
-            db.close();
-        } catch(SQLiteDB::SQLiteException& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't close recording file");
-        }
-        break;
-    default:
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Unknown reason in scv_tr_db callback");
-    }
-}
-// ----------------------------------------------------------------------------
-static std::unordered_map<std::string, uint64_t> str_map;
-uint64_t getStringId(std::string const& s){
-	auto it = str_map.find(s);
-	if(it!=std::end(str_map)) return it->second;
-	auto id = str_map.size();
-	str_map.insert({s, id});
-    try {
-    	sqlite3_bind_int64(string_stmt, 1, id);
-    	sqlite3_bind_text(string_stmt, 2, s.c_str(), -1, SQLITE_TRANSIENT);
-    	db.exec(string_stmt);
-	} catch(SQLiteDB::SQLiteException& e) {
-		_scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create string entry");
-	}
-	return id;
-}
-// ----------------------------------------------------------------------------
-static void streamCb(const scv_tr_stream& s, scv_tr_stream::callback_reason reason, void* data) {
-    if(reason == scv_tr_stream::CREATE && db.isOpen()) {
-        try {
-            sqlite3_bind_int64(stream_stmt, 1, s.get_id());
-            sqlite3_bind_int64(stream_stmt, 2, getStringId(s.get_name()));
-            sqlite3_bind_int64(stream_stmt, 3, getStringId(s.get_stream_kind() ? s.get_stream_kind() : "<unnamed>"));
-            db.exec(stream_stmt);
-            if(concurrencyLevel.size() <= s.get_id())
-                concurrencyLevel.resize(s.get_id() + 1);
-            concurrencyLevel[s.get_id()] = new vector<uint64_t>();
-        } catch(SQLiteDB::SQLiteException& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create stream");
+            return false;
         }
+        return true;
     }
-}
-// ----------------------------------------------------------------------------
-void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, const string& value) {
-    try {
-        sqlite3_bind_int64(attr_stmt, 1, id);
-        sqlite3_bind_int64(attr_stmt, 2, event);
-        sqlite3_bind_int64(attr_stmt, 3, getStringId(name));
-        sqlite3_bind_int64(attr_stmt, 4, type);
-        sqlite3_bind_int64(attr_stmt, 5, getStringId(value));
-        db.exec(attr_stmt);
-    } catch(SQLiteDB::SQLiteException& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create attribute entry");
+
+    void close() override {
+        writer.stop();
+        str_map.clear();
+        concurrency_level.clear();
+        tx2stream.clear();
+        if(with_transactions && !async_mode) db.exec("COMMIT TRANSACTION");
+        db.close();
     }
-}
-// ----------------------------------------------------------------------------
-inline void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, long long value) {
-    recordAttribute(id, event, name, type, std::to_string(value));
-}
-// ----------------------------------------------------------------------------
-inline void recordAttribute(uint64_t id, EventType event, const string& name, data_type type, double value) {
-    recordAttribute(id, event, name, type, std::to_string(value));
-}
-// ----------------------------------------------------------------------------
-static void recordAttributes(uint64_t id, EventType eventType, string& prefix, const scv_extensions_if* my_exts_p) {
-    if(my_exts_p == nullptr)
-        return;
-    string name;
-    if(prefix == "") {
-        name = my_exts_p->get_name();
-    } else {
-        if((my_exts_p->get_name() == nullptr) || (strlen(my_exts_p->get_name()) == 0)) {
-            name = prefix;
-        } else {
-            name = prefix + "." + my_exts_p->get_name();
-        }
+
+    void stream(uint64_t id, std::string const& name, std::string const& kind) override {
+        sqlite3_int64 name_id = get_string_id(name);
+        sqlite3_int64 kind_id = get_string_id(kind.empty() ? "<unnamed>" : kind);
+        record(db_record(stream_stmt, {static_cast<sqlite3_int64>(id), name_id, kind_id}), "Can't create stream");
     }
-    if(name == "")
-        name = "<unnamed>";
-    switch(my_exts_p->get_type()) {
-    case scv_extensions_if::RECORD: {
-        int num_fields = my_exts_p->get_num_fields();
-        if(num_fields > 0) {
-            for(int field_counter = 0; field_counter < num_fields; field_counter++) {
-                const scv_extensions_if* field_data_p = my_exts_p->get_field(field_counter);
-                recordAttributes(id, eventType, prefix, field_data_p);
-            }
-        }
-    } break;
-    case scv_extensions_if::ENUMERATION:
-        recordAttribute(id, eventType, name, scv_extensions_if::ENUMERATION,
-                        my_exts_p->get_enum_string((int)(my_exts_p->get_integer())));
-        break;
-    case scv_extensions_if::BOOLEAN:
-        recordAttribute(id, eventType, name, scv_extensions_if::BOOLEAN, my_exts_p->get_bool() ? "TRUE" : "FALSE");
-        break;
-    case scv_extensions_if::INTEGER:
-    case scv_extensions_if::FIXED_POINT_INTEGER:
-        recordAttribute(id, eventType, name, scv_extensions_if::INTEGER, my_exts_p->get_integer());
-        break;
-    case scv_extensions_if::UNSIGNED:
-        recordAttribute(id, eventType, name, scv_extensions_if::UNSIGNED, my_exts_p->get_integer());
-        break;
-    case scv_extensions_if::POINTER:
-        recordAttribute(id, eventType, name, scv_extensions_if::POINTER, (long long)my_exts_p->get_pointer());
-        break;
-    case scv_extensions_if::STRING:
-        recordAttribute(id, eventType, name, scv_extensions_if::STRING, my_exts_p->get_string());
-        break;
-    case scv_extensions_if::FLOATING_POINT_NUMBER:
-        recordAttribute(id, eventType, name, scv_extensions_if::FLOATING_POINT_NUMBER, my_exts_p->get_double());
-        break;
-    case scv_extensions_if::BIT_VECTOR: {
-        sc_bv_base tmp_bv(my_exts_p->get_bitwidth());
-        my_exts_p->get_value(tmp_bv);
-        recordAttribute(id, eventType, name, scv_extensions_if::BIT_VECTOR, tmp_bv.to_string());
-    } break;
-    case scv_extensions_if::LOGIC_VECTOR: {
-        sc_lv_base tmp_lv(my_exts_p->get_bitwidth());
-        my_exts_p->get_value(tmp_lv);
-        recordAttribute(id, eventType, name, scv_extensions_if::LOGIC_VECTOR, tmp_lv.to_string());
-    } break;
-    case scv_extensions_if::ARRAY:
-        for(int array_elt_index = 0; array_elt_index < my_exts_p->get_array_size(); array_elt_index++) {
-            const scv_extensions_if* field_data_p = my_exts_p->get_array_elt(array_elt_index);
-            recordAttributes(id, eventType, prefix, field_data_p);
-        }
-        break;
-    default: {
-        std::array<char, 100> tmpString{};
-        sprintf(tmpString.data(), "Unsupported attribute type = %d", my_exts_p->get_type());
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, tmpString.data());
+
+    void generator(uint64_t id, std::string const& name, uint64_t stream,
+                   std::vector<tx::attribute_desc> const& attributes) override {
+        sqlite3_int64 name_id = get_string_id(name);
+        record(db_record(gen_stmt,
+                         {static_cast<sqlite3_int64>(id), static_cast<sqlite3_int64>(stream), name_id}),
+               "Can't create generator entry");
     }
+
+    void begin_transaction(uint64_t id, uint64_t generator, uint64_t stream, uint64_t time) override {
+        // a transaction occupies the lowest free concurrency level of its stream until it ends
+        auto& levels = concurrency_level[stream];
+        size_t level = 0;
+        while(level < levels.size() && levels[level])
+            ++level;
+        if(level == levels.size())
+            levels.push_back(id);
+        else
+            levels[level] = id;
+        tx2stream[id] = stream;
+        record(db_record(tx_stmt, {static_cast<sqlite3_int64>(id), static_cast<sqlite3_int64>(generator),
+                                   static_cast<sqlite3_int64>(stream), static_cast<sqlite3_int64>(level)}),
+               "Can't create transaction");
+        record(db_record(evt_stmt, {static_cast<sqlite3_int64>(id), tx::BEGIN, static_cast<sqlite3_int64>(time)}),
+               "Can't create transaction begin");
     }
-}
-// ----------------------------------------------------------------------------
-static void generatorCb(const scv_tr_generator_base& g, scv_tr_generator_base::callback_reason reason, void* data) {
-    if(reason == scv_tr_generator_base::CREATE && db.isOpen()) {
-        try {
-            sqlite3_bind_int64(gen_stmt, 1, g.get_id());
-            sqlite3_bind_int64(gen_stmt, 2, g.get_scv_tr_stream().get_id());
-            sqlite3_bind_int64(gen_stmt, 3, getStringId(g.get_name()));
-            db.exec(gen_stmt);
-        } catch(SQLiteDB::SQLiteException& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create generator entry");
+
+    void end_transaction(uint64_t id, uint64_t generator, uint64_t time) override {
+        auto it = tx2stream.find(id);
+        if(it != tx2stream.end()) {
+            auto& levels = concurrency_level[it->second];
+            auto level = std::find(levels.begin(), levels.end(), id);
+            if(level != levels.end())
+                *level = 0;
+            tx2stream.erase(it);
         }
+        record(db_record(evt_stmt, {static_cast<sqlite3_int64>(id), tx::END, static_cast<sqlite3_int64>(time)}),
+               "Can't create transaction end");
     }
-}
-// ----------------------------------------------------------------------------
-static void transactionCb(const scv_tr_handle& t, scv_tr_handle::callback_reason reason, void* data) {
-    if(!db.isOpen())
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
 
-    uint64_t id = t.get_id();
-    uint64_t streamId = t.get_scv_tr_stream().get_id();
-    vector<uint64_t>::size_type concurrencyIdx;
-    const scv_extensions_if* my_exts_p;
-    switch(reason) {
-    case scv_tr_handle::BEGIN: {
-        try {
-            if(concurrencyLevel.size() <= streamId)
-                concurrencyLevel.resize(streamId + 1);
-            vector<uint64_t>* levels = concurrencyLevel[streamId];
-            if(levels == nullptr) {
-                levels = new vector<uint64_t>();
-                concurrencyLevel[id] = levels;
-            }
-            for(concurrencyIdx = 0; concurrencyIdx < levels->size(); ++concurrencyIdx)
-                if((*levels)[concurrencyIdx] == 0)
-                    break;
-            if(concurrencyIdx == levels->size())
-                levels->push_back(id);
-            else
-                (*levels)[concurrencyIdx] = id;
-
-            sqlite3_bind_int64(tx_stmt, 1, id);
-            sqlite3_bind_int64(tx_stmt, 2, t.get_scv_tr_generator_base().get_id());
-            sqlite3_bind_int64(tx_stmt, 3, t.get_scv_tr_stream().get_id());
-            sqlite3_bind_int64(tx_stmt, 3, concurrencyIdx);
-            db.exec(tx_stmt);
+    void attribute(uint64_t id, tx::event_type event, std::string const& name, tx::value const& val) override {
+        sqlite3_int64 name_id = get_string_id(name);
+        sqlite3_int64 value_id = get_string_id(to_string(val));
+        record(db_record(attr_stmt, {static_cast<sqlite3_int64>(id), event, name_id, val.type, value_id}),
+               "Can't create attribute entry");
+    }
 
-            sqlite3_bind_int64(evt_stmt, 1, id);
-            sqlite3_bind_int(evt_stmt, 2, BEGIN);
-            sqlite3_bind_int64(evt_stmt, 3, t.get_begin_sc_time().value());
-            db.exec(evt_stmt);
+    void relation(std::string const& name, uint64_t sink_id, uint64_t src_id) override {
+        sqlite3_int64 name_id = get_string_id(name);
+        record(db_record(rel_stmt,
+                         {name_id, static_cast<sqlite3_int64>(sink_id), static_cast<sqlite3_int64>(src_id)}),
+               "Can't create transaction relation");
+    }
 
-        } catch(SQLiteDB::SQLiteException& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, e.errorMessage());
+private:
+    static std::string to_string(tx::value const& val) {
+        switch(val.type) {
+        case tx::BOOLEAN:
+            return val.b ? "TRUE" : "FALSE";
+        case tx::INTEGER:
+            return std::to_string(val.i);
+        case tx::UNSIGNED:
+            return std::to_string(val.u);
+        case tx::FLOATING_POINT_NUMBER:
+            return std::to_string(val.d);
+        default:
+            return val.str;
         }
-        my_exts_p = t.get_begin_exts_p();
-        if(my_exts_p == nullptr) {
-            my_exts_p = t.get_scv_tr_generator_base().get_begin_exts_p();
+    }
+    //! insert a row either directly or using the background thread
+    void record(db_record&& r, const char* err_msg) {
+        if(writer.is_active()) {
+            writer.push(std::move(r));
+            return;
         }
-        string tmp_str = t.get_scv_tr_generator_base().get_begin_attribute_name()
-                             ? t.get_scv_tr_generator_base().get_begin_attribute_name()
-                             : "";
-        recordAttributes(id, BEGIN, tmp_str, my_exts_p);
-    } break;
-    case scv_tr_handle::END: {
         try {
-            vector<uint64_t>* levels = concurrencyLevel[streamId];
-            for(concurrencyIdx = 0; concurrencyIdx < levels->size(); ++concurrencyIdx)
-                if((*levels)[concurrencyIdx] == id)
-                    break;
-            if(concurrencyIdx == levels->size())
-                levels->push_back(id);
-            else
-                levels->at(concurrencyIdx) = id;
-
-            sqlite3_bind_int64(evt_stmt, 1, t.get_id());
-            sqlite3_bind_int(evt_stmt, 2, END);
-            sqlite3_bind_int64(evt_stmt, 3, t.get_end_sc_time().value());
-            db.exec(evt_stmt);
-
+            execute(db, r);
         } catch(SQLiteDB::SQLiteException& e) {
-            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create transaction end");
-        }
-        my_exts_p = t.get_end_exts_p();
-        if(my_exts_p == nullptr) {
-            my_exts_p = t.get_scv_tr_generator_base().get_end_exts_p();
+            _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, err_msg);
         }
-        string tmp_str = t.get_scv_tr_generator_base().get_end_attribute_name()
-                             ? t.get_scv_tr_generator_base().get_end_attribute_name()
-                             : "";
-        recordAttributes(t.get_id(), END, tmp_str, my_exts_p);
-    } break;
-    default:;
     }
-}
-// ----------------------------------------------------------------------------
-static void attributeCb(const scv_tr_handle& t, const char* name, const scv_extensions_if* ext, void* data) {
-    if(!db.isOpen())
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(t.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
-    string tmp_str(name == nullptr ? "" : name);
-    recordAttributes(t.get_id(), RECORD, tmp_str, ext);
-}
-// ----------------------------------------------------------------------------
-static void relationCb(const scv_tr_handle& tr_1, const scv_tr_handle& tr_2, void* data,
-                       scv_tr_relation_handle_t relation_handle) {
-    if(!db.isOpen())
-        return;
-    if(tr_1.get_scv_tr_stream().get_scv_tr_db() == nullptr)
-        return;
-    if(tr_1.get_scv_tr_stream().get_scv_tr_db()->get_recording() == false)
-        return;
-    try {
-    	sqlite3_bind_int64(rel_stmt, 1, getStringId(tr_1.get_scv_tr_stream().get_scv_tr_db()->get_relation_name(relation_handle)));
-        sqlite3_bind_int64(rel_stmt, 2, tr_1.get_id());
-        sqlite3_bind_int64(rel_stmt, 3, tr_2.get_id());
-        db.exec(rel_stmt);
-    } catch(SQLiteDB::SQLiteException& e) {
-        _scv_message::message(_scv_message::TRANSACTION_RECORDING_INTERNAL, "Can't create transaction relation");
+
+    uint64_t get_string_id(std::string const& s) {
+        auto it = str_map.find(s);
+        if(it != std::end(str_map))
+            return it->second;
+        auto id = str_map.size();
+        str_map.insert({s, id});
+        record(db_record(string_stmt, {static_cast<sqlite3_int64>(id)}, true, s), "Can't create string entry");
+        return id;
     }
-}
+
+    const bool async_mode;
+    SQLiteDB db;
+    async_writer writer;
+    sqlite3_stmt *string_stmt{nullptr}, *stream_stmt{nullptr}, *gen_stmt{nullptr}, *tx_stmt{nullptr},
+        *evt_stmt{nullptr}, *attr_stmt{nullptr}, *rel_stmt{nullptr};
+    std::unordered_map<std::string, uint64_t> str_map;
+    //! the transaction ids occupying the concurrency levels of each stream, 0 denotes a free level
+    std::unordered_map<uint64_t, std::vector<uint64_t>> concurrency_level;
+    std::unordered_map<uint64_t, uint64_t> tx2stream;
+};
+} // namespace
 // ----------------------------------------------------------------------------
-void scv_tr_sqlite_init() {
-    scv_tr_db::register_class_cb(dbCb);
-    scv_tr_stream::register_class_cb(streamCb);
-    scv_tr_generator_base::register_class_cb(generatorCb);
-    scv_tr_handle::register_class_cb(transactionCb);
-    scv_tr_handle::register_record_attribute_cb(attributeCb);
-    scv_tr_handle::register_relation_cb(relationCb);
+void scv_tr_sqlite_init(bool async) {
+    tx::dispatcher::get().add(std::unique_ptr<tx::backend>(new sqlite_backend(async)));
 }
 // ----------------------------------------------------------------------------
 #ifndef HAS_SCV
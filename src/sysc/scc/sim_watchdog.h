@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_SIM_WATCHDOG_H_
+#define _SCC_SIM_WATCHDOG_H_
+
+#include "perf_estimator.h"
+#include "report.h"
+#include "value_registry.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <systemc>
+#include <util/watchdog.h>
+#include <vector>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @class sim_watchdog
+ * @brief monitors the progress of the simulation using a util::watchdog
+ *
+ * The guard thread of the watch dog periodically requests an asynchronous update of this channel. The update runs in
+ * the next update phase of the kernel, also if the simulation is caught in a delta cycle livelock, and stores the
+ * simulation time and the delta count in the atomics of the watch dog. If the simulation time stalls or the ratio of
+ * simulated to host time drops below the threshold the alarm is logged and the dump callbacks are executed in the
+ * SystemC thread during the next update phase while the simulation keeps running. If the kernel does not reach an
+ * update phase anymore (e.g. a process spinning in host code) only the alarm callback is called from the guard thread.
+ *
+ * The monitoring is active between start_of_simulation and end_of_simulation, time spent in a paused simulation
+ * counts as stalled.
+ */
+class sim_watchdog : public sc_core::sc_prim_channel {
+public:
+    using health = util::watchdog::health;
+    using progress = util::watchdog::progress;
+    /**
+     * @param stall_timeout the host time the simulation time may not advance
+     * @param min_ratio the minimum of simulated per host seconds over the last stall timeout, 0 disables the check
+     */
+    sim_watchdog(std::chrono::system_clock::duration stall_timeout, double min_ratio = 0.)
+    : sc_core::sc_prim_channel(sc_core::sc_gen_unique_name("sim_watchdog"))
+    , stall_timeout(stall_timeout)
+    , min_ratio(min_ratio)
+    , wd(stall_timeout, []() {}, stall_timeout / 10) {}
+
+    sim_watchdog(sim_watchdog const&) = delete;
+
+    sim_watchdog& operator=(sim_watchdog const&) = delete;
+
+    ~sim_watchdog() { wd.stop_monitoring(); }
+    /**
+     * set the function called from the guard thread upon an alarm, it must not access the simulation
+     *
+     * @param cb the callback, it is set before the simulation starts
+     */
+    void set_alarm_cb(std::function<void(health, progress const&)> cb) { alarm_cb = std::move(cb); }
+    /**
+     * add a function being called in the SystemC thread after an alarm, to be called before the simulation starts
+     *
+     * @param cb the callback
+     */
+    void add_dump_cb(std::function<void()> cb) { dump_cbs.push_back(std::move(cb)); }
+    //! dump the status of a perf_estimator upon an alarm
+    void add_dump(perf_estimator& pe) {
+        add_dump_cb([&pe]() { pe.report_status(); });
+    }
+    //! dump all values of a value_registry upon an alarm
+    void add_dump(value_registry& vr) {
+        add_dump_cb([&vr]() {
+            for(auto& name : vr.get_names())
+                if(auto* v = vr.get_value(name))
+                    SCCINFO("sim_watchdog") << name << " = " << v->to_string();
+        });
+    }
+
+protected:
+    void start_of_simulation() override {
+        wd.monitor_progress(
+            stall_timeout, min_ratio,
+            [this](health h, progress const& p) {
+                if(alarm_cb)
+                    alarm_cb(h, p);
+                alarm.store(h == health::STALLED ? STALLED : SLOW, std::memory_order_release);
+            },
+            [this]() { async_request_update(); });
+    }
+
+    void end_of_simulation() override { wd.stop_monitoring(); }
+
+    void update() override {
+        wd.update_progress(sc_core::sc_time_stamp().to_seconds(), sc_core::sc_delta_count());
+        auto a = alarm.exchange(NONE, std::memory_order_acq_rel);
+        if(a == NONE)
+            return;
+        if(a == STALLED)
+            SCCWARN("sim_watchdog") << "simulation time did not advance, currently at " << sc_core::sc_time_stamp()
+                                    << " after " << sc_core::sc_delta_count() << " delta cycles";
+        else
+            SCCWARN("sim_watchdog") << "simulation speed dropped below " << min_ratio << " (sim s/wall s)";
+        for(auto& cb : dump_cbs)
+            cb();
+    }
+
+private:
+    enum alarm_e { NONE, STALLED, SLOW };
+    std::chrono::system_clock::duration stall_timeout;
+    double min_ratio;
+    std::function<void(health, progress const&)> alarm_cb;
+    std::vector<std::function<void()>> dump_cbs;
+    std::atomic<int> alarm{NONE};
+    // needs to be the last member so that the guard thread is joined before the other members are destroyed
+    util::watchdog wd;
+};
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_SIM_WATCHDOG_H_ */
@@ -0,0 +1,242 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+
+#ifndef _SCC_SPAN_TRACER_H_
+#define _SCC_SPAN_TRACER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <sysc/kernel/sc_simcontext.h>
+#include <vector>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @brief records host time spans of SCC internals to be shown on a timeline, e.g. by Perfetto or chrome://tracing
+ *
+ * Spans are opened with SCC_SPAN, which is only compiled in if SCC_WITH_SPANS is defined (CMake option SCC_SPANS).
+ * Otherwise the macro expands to nothing. If it is compiled in but the tracer is not enabled, a span costs a relaxed
+ * load of a flag.
+ *
+ * Each thread appends its spans to a buffer of its own without locking. The buffer is a list of fixed size chunks.
+ * Its owner publishes each span by a release store of the fill level, so the spans can be written while other threads
+ * still record. A span carries the simulation time of its start. Span names need to be string literals.
+ */
+class span_tracer {
+public:
+    using clock = std::chrono::steady_clock;
+    //! a recorded span
+    struct span {
+        char const* name;
+        //! the start in ns since the tracer was enabled
+        uint64_t start;
+        //! the duration in ns
+        uint64_t duration;
+        //! the simulation time at the start in units of the time resolution
+        uint64_t sim_time;
+    };
+    //! the tracer getter
+    static span_tracer& get() {
+        static span_tracer inst;
+        return inst;
+    }
+    /**
+     * @brief start recording spans
+     *
+     * @param max_spans the maximum number of spans recorded per thread, further spans are counted as dropped
+     */
+    void enable(size_t max_spans = 1 << 20) {
+        limit = max_spans;
+        origin = clock::now();
+        enabled.store(true, std::memory_order_release);
+    }
+    //! stop recording, the spans recorded so far are kept
+    void disable() { enabled.store(false, std::memory_order_release); }
+
+    //! check if spans are recorded, the acquire pairs with enable() and is a plain load on x86
+    bool is_enabled() const { return enabled.load(std::memory_order_acquire); }
+    //! the nanoseconds since the tracer was enabled
+    uint64_t now() const {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - origin);
+        return static_cast<uint64_t>(elapsed.count());
+    }
+    //! set the name the calling thread is shown with
+    void set_thread_name(std::string name) { local().name = std::move(name); }
+    //! add a span of the calling thread
+    void add(char const* name, uint64_t start, uint64_t duration, uint64_t sim_time) {
+        auto& b = local();
+        if(b.count == limit) {
+            b.dropped.store(b.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        auto* c = b.tail;
+        auto sz = c->size.load(std::memory_order_relaxed);
+        if(sz == chunk::capacity) {
+            auto* n = new chunk;
+            c->next.store(n, std::memory_order_release);
+            b.tail = c = n;
+            sz = 0;
+        }
+        c->spans[sz] = span{name, start, duration, sim_time};
+        c->size.store(sz + 1, std::memory_order_release);
+        ++b.count;
+    }
+    /**
+     * @brief write the spans in the JSON format of the Chrome trace event profiler, which Perfetto reads as well
+     *
+     * Each span becomes a complete event of the thread having recorded it, the simulation time is given in the
+     * arguments of the event (sim_time) in units of the time resolution.
+     *
+     * @param os the stream to write to
+     */
+    void write_chrome_json(std::ostream& os) const {
+        std::vector<buffer*> bufs;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for(auto& b : buffers)
+                bufs.push_back(b.get());
+        }
+        os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        auto sep = "\n";
+        for(size_t tid = 0; tid < bufs.size(); ++tid) {
+            auto* b = bufs[tid];
+            os << sep << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << tid << R"(,"args":{"name":)";
+            write_string(os, b->name.empty() ? "thread " + std::to_string(tid) : b->name);
+            os << "}}";
+            sep = ",\n";
+            for(auto* c = &b->head; c; c = c->next.load(std::memory_order_acquire)) {
+                auto sz = c->size.load(std::memory_order_acquire);
+                for(unsigned i = 0; i < sz; ++i) {
+                    auto& s = c->spans[i];
+                    os << sep << R"({"name":)";
+                    write_string(os, s.name);
+                    os << R"(,"ph":"X","pid":1,"tid":)" << tid << ",\"ts\":";
+                    write_us(os, s.start);
+                    os << ",\"dur\":";
+                    write_us(os, s.duration);
+                    os << R"(,"args":{"sim_time":)" << s.sim_time << "}}";
+                }
+            }
+            auto dropped = b->dropped.load(std::memory_order_relaxed);
+            if(dropped)
+                os << sep << R"({"name":"dropped spans","ph":"C","pid":1,"tid":)" << tid
+                   << R"(,"ts":0,"args":{"count":)" << dropped << "}}";
+        }
+        os << "\n]}\n";
+    }
+    /**
+     * @brief a span lasting as long as the scope, nothing is recorded if the tracer is disabled when the scope starts
+     */
+    struct scope {
+        explicit scope(char const* name)
+        : name(get().is_enabled() ? name : nullptr) {
+            if(this->name) {
+                sim_time = sc_core::sc_time_stamp().value();
+                start = get().now();
+            }
+        }
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+        ~scope() {
+            if(name) {
+                auto& t = get();
+                t.add(name, start, t.now() - start, sim_time);
+            }
+        }
+
+    private:
+        char const* const name;
+        uint64_t start{0};
+        uint64_t sim_time{0};
+    };
+
+private:
+    span_tracer() = default;
+    struct chunk {
+        static const unsigned capacity = 4096;
+        span spans[capacity];
+        std::atomic<unsigned> size{0};
+        std::atomic<chunk*> next{nullptr};
+    };
+    struct buffer {
+        chunk head;
+        //! only the owning thread accesses tail, count and name
+        chunk* tail{&head};
+        size_t count{0};
+        std::string name;
+        std::atomic<uint64_t> dropped{0};
+        ~buffer() {
+            for(auto* c = head.next.load(); c;) {
+                auto* n = c->next.load();
+                delete c;
+                c = n;
+            }
+        }
+    };
+    //! get the buffer of the calling thread, it is created upon the first span and lives as long as the tracer
+    buffer& local() {
+        thread_local buffer* b = nullptr;
+        if(!b) {
+            std::lock_guard<std::mutex> lock(mtx);
+            buffers.emplace_back(new buffer);
+            b = buffers.back().get();
+        }
+        return *b;
+    }
+
+    //! write nanoseconds as microseconds with 3 decimals, the time unit of the trace event format
+    static void write_us(std::ostream& os, uint64_t ns) {
+        os << ns / 1000 << '.' << static_cast<char>('0' + ns / 100 % 10) << static_cast<char>('0' + ns / 10 % 10)
+           << static_cast<char>('0' + ns % 10);
+    }
+
+    static void write_string(std::ostream& os, std::string const& str) {
+        os << '"';
+        for(auto c : str) {
+            if(c == '"' || c == '\\')
+                os << '\\';
+            os << c;
+        }
+        os << '"';
+    }
+
+    std::atomic<bool> enabled{false};
+    size_t limit{0};
+    clock::time_point origin{clock::now()};
+    mutable std::mutex mtx;
+    std::vector<std::unique_ptr<buffer>> buffers;
+};
+} // namespace scc
+/** @} */ // end of scc-sysc
+#ifdef SCC_WITH_SPANS
+#define SCC_SPAN_CONCAT_(a, b) a##b
+#define SCC_SPAN_CONCAT(a, b) SCC_SPAN_CONCAT_(a, b)
+//! record the host time of the enclosing scope as span of the span_tracer, name needs to be a string literal
+#define SCC_SPAN(name) ::scc::span_tracer::scope SCC_SPAN_CONCAT(scc_span_, __LINE__)(name)
+#else
+#define SCC_SPAN(name) ((void)0)
+#endif
+#endif /* _SCC_SPAN_TRACER_H_ */
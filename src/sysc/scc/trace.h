@@ -39,9 +39,16 @@ sc_core::sc_trace_file* create_vcd_push_trace_file(const char* name,
 //! close the VCD file
 void close_vcd_push_trace_file(sc_core::sc_trace_file* tf);
 
+//! the compression of VCD files written by the multithreaded VCD writer
+enum class vcd_compression {
+    GZIP, //!< gzip, the file gets the extension .vcd.gz
+    LZ4,  //!< LZ4 frame format, the file gets the extension .vcd.lz4
+    ZSTD  //!< Zstandard using multithreaded compression if available, the file gets the extension .vcd.zst
+};
 //! create compressed VCD file which uses push mechanism and multithreading
 sc_core::sc_trace_file* create_vcd_mt_trace_file(const char* name,
-                                                 std::function<bool()> enable = std::function<bool()>());
+                                                 std::function<bool()> enable = std::function<bool()>(),
+                                                 vcd_compression compression = vcd_compression::GZIP);
 //! close the VCD file
 void close_vcd_mt_trace_file(sc_core::sc_trace_file* tf);
 
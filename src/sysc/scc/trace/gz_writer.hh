@@ -8,106 +8,233 @@
 #ifndef _SCC_TRACE_GZ_WRITER_HH_
 #define _SCC_TRACE_GZ_WRITER_HH_
 
-#include <boost/lockfree/spsc_queue.hpp>
-#include <boost/atomic.hpp>
-#include <thread>
-#include <mutex>
+#include "../trace.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
 #include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
-#include <cstring>
+#include <thread>
+#include <util/lz4_streambuf.h>
+#include <vector>
 #include <zlib.h>
-#include <chrono>
+#ifdef HAS_ZSTD
+#include <zstd.h>
+#endif
 
 namespace scc {
 namespace trace {
-
+/**
+ * @brief a compressed file writer compressing in a background thread
+ *
+ * Despite its name the writer supports all compressions of \ref scc::vcd_compression, Zstandard is only available
+ * if SCC was built with zstd (HAS_ZSTD being defined), is_supported() tells if this is the case.
+ * The data is collected in large blocks, a filled block is handed over to the background thread for compression and
+ * writing while the next block is being filled. The number of blocks is fixed so there is no allocation per write,
+ * if the background thread falls behind the writing thread blocks until a block is available again.
+ * write() expects the caller to hold writer_mtx if multiple threads are writing, write_single() locks it itself.
+ */
 class gz_writer {
-    static const size_t queue_size=16*1024;
-    std::deque<char*> pool;
-    std::deque<char*> write_queue;
-    boost::atomic<bool> done {false};
-    std::condition_variable cond;
+    using buffer_type = std::vector<char>;
+    //! the block currently being filled
+    buffer_type current;
+    //! the blocks ready to be compressed
+    std::deque<buffer_type> full_queue;
+    //! the blocks available for filling
+    std::vector<buffer_type> free_pool;
+    std::mutex queue_mtx;
+    std::condition_variable full_cond;
+    std::condition_variable free_cond;
+    bool done{false};
+    size_t const block_size;
 
-    std::deque<char*> pool_buffer;
-    gzFile vcd_out{nullptr};
-    std::thread logger;
-
-    inline void write_out(){
-        while (!write_queue.empty()) {
-            auto* value = write_queue.front();
-            write_queue.pop_front();
-            auto len = strlen(value);
-            if(len) gzwrite(vcd_out, value, strlen(value));
-            memset(value, 0, buffer_size);
-            pool.push_back(value);
+    //! the compressing backend, it is only used by the background thread
+    struct sink {
+        virtual ~sink() = default;
+        virtual void write(char const* data, size_t size) = 0;
+    };
+    struct gzip_sink : sink {
+        gzFile out;
+        explicit gzip_sink(std::string const& filename)
+        : out(gzopen(filename.c_str(), "w3")) {}
+        ~gzip_sink() {
+            if(out)
+                gzclose(out);
         }
-    }
-    void log(void){
-        auto const timeout = std::chrono::milliseconds(1);
-        while (!done) {
-            std::unique_lock<std::mutex> lock(writer_mtx);
-            auto now = std::chrono::system_clock::now();
-            cond.wait_until(lock, now+timeout, [this]() -> bool { return done || ! write_queue.empty(); });
-            write_out();
+        void write(char const* data, size_t size) override {
+            if(out)
+                gzwrite(out, data, static_cast<unsigned>(size));
         }
-        write_out();
-    }
+    };
+    struct lz4_sink : sink {
+        std::ofstream file;
+        util::lz4c_steambuf buf;
+        std::ostream os;
+        lz4_sink(std::string const& filename, size_t block_size)
+        : file(filename, std::ios::binary)
+        , buf(file, block_size)
+        , os(&buf) {}
+        ~lz4_sink() { buf.close(); }
+        void write(char const* data, size_t size) override { os.write(data, size); }
+    };
+#ifdef HAS_ZSTD
+    struct zstd_sink : sink {
+        FILE* out;
+        ZSTD_CCtx* ctx;
+        std::vector<char> out_buf;
+        explicit zstd_sink(std::string const& filename)
+        : out(fopen(filename.c_str(), "wb"))
+        , ctx(ZSTD_createCCtx())
+        , out_buf(ZSTD_CStreamOutSize()) {
+            ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, 3);
+            // fails silently if libzstd has been built without multithreading support
+            ZSTD_CCtx_setParameter(ctx, ZSTD_c_nbWorkers, std::max(1u, std::thread::hardware_concurrency() / 2));
+        }
+        ~zstd_sink() {
+            compress(nullptr, 0, ZSTD_e_end);
+            ZSTD_freeCCtx(ctx);
+            if(out)
+                fclose(out);
+        }
+        void write(char const* data, size_t size) override { compress(data, size, ZSTD_e_continue); }
+        void compress(char const* data, size_t size, ZSTD_EndDirective mode) {
+            ZSTD_inBuffer in{data, size, 0};
+            size_t remaining;
+            do {
+                ZSTD_outBuffer o{out_buf.data(), out_buf.size(), 0};
+                remaining = ZSTD_compressStream2(ctx, &o, &in, mode);
+                if(ZSTD_isError(remaining))
+                    return;
+                if(out && o.pos)
+                    fwrite(out_buf.data(), 1, o.pos, out);
+            } while(mode == ZSTD_e_end ? remaining != 0 : in.pos < in.size);
+        }
+    };
+#endif
+    std::unique_ptr<sink> out;
+    std::thread logger;
 
-    void enlarge_pool() {
-        auto buffer_pool = new char[queue_size * buffer_size];
-        for (auto i = 0u; i < queue_size; ++i) {
-            memset(buffer_pool + i * buffer_size, 0, buffer_size);
-            pool.push_back(buffer_pool + i * buffer_size);
+    void log() {
+        std::unique_lock<std::mutex> lock(queue_mtx);
+        while(true) {
+            full_cond.wait(lock, [this]() -> bool { return done || !full_queue.empty(); });
+            if(full_queue.empty())
+                return;
+            auto buffer = std::move(full_queue.front());
+            full_queue.pop_front();
+            lock.unlock();
+            out->write(buffer.data(), buffer.size());
+            buffer.clear();
+            lock.lock();
+            free_pool.push_back(std::move(buffer));
+            free_cond.notify_one();
         }
-        pool_buffer.push_back(buffer_pool);
+    }
+    //! hand the current block over to the background thread and take a free one
+    void submit() {
+        std::unique_lock<std::mutex> lock(queue_mtx);
+        full_queue.push_back(std::move(current));
+        full_cond.notify_one();
+        free_cond.wait(lock, [this]() -> bool { return !free_pool.empty(); });
+        current = std::move(free_pool.back());
+        free_pool.pop_back();
     }
 
 public:
     std::mutex writer_mtx;
-    using lock_type=std::unique_lock<std::mutex>;
-    static const size_t buffer_size=512;
-    gz_writer(std::string const& filename)  {
-        vcd_out = gzopen(filename.c_str(), "w3");
-        logger=std::thread([this](){log();});
-        enlarge_pool();
+    using lock_type = std::unique_lock<std::mutex>;
+    //! check if the compression is available in this build
+    static bool is_supported(vcd_compression compression) {
+#ifdef HAS_ZSTD
+        return true;
+#else
+        return compression != vcd_compression::ZSTD;
+#endif
+    }
+    //! the file extension used for the compression
+    static char const* extension(vcd_compression compression) {
+        switch(compression) {
+        case vcd_compression::LZ4:
+            return ".lz4";
+        case vcd_compression::ZSTD:
+            return ".zst";
+        default:
+            return ".gz";
+        }
+    }
+    /**
+     * @brief open the file and start the background thread
+     *
+     * @param filename the name of the file
+     * @param compression the compression to use, throws std::invalid_argument if it is not supported
+     * @param block_size the size of the blocks handed over to the background thread
+     * @param blocks the number of blocks, at least 2
+     */
+    gz_writer(std::string const& filename, vcd_compression compression = vcd_compression::GZIP,
+              size_t block_size = 1024 * 1024, unsigned blocks = 4)
+    : block_size(block_size) {
+        switch(compression) {
+        case vcd_compression::LZ4:
+            out.reset(new lz4_sink(filename, block_size));
+            break;
+        case vcd_compression::ZSTD:
+#ifdef HAS_ZSTD
+            out.reset(new zstd_sink(filename));
+            break;
+#else
+            throw std::invalid_argument("zstd compression is not supported by this build");
+#endif
+        default:
+            out.reset(new gzip_sink(filename));
+        }
+        current.reserve(block_size);
+        for(auto i = 1u; i < std::max(2u, blocks); ++i) {
+            free_pool.emplace_back();
+            free_pool.back().reserve(block_size);
+        }
+        logger = std::thread([this]() { log(); });
     }
 
-    ~gz_writer(){
-        done=true;
+    ~gz_writer() {
         {
             lock_type lock(writer_mtx);
-            write("");
+            flush();
         }
+        {
+            std::lock_guard<std::mutex> lock(queue_mtx);
+            done = true;
+        }
+        full_cond.notify_one();
         logger.join();
-        gzclose(vcd_out);
-        char* value;
-        pool.clear();
-        for(auto b:pool_buffer) delete b;
+    }
+    //! hand the data written so far over to the background thread
+    inline void flush() {
+        if(!current.empty())
+            submit();
     }
 
-    inline void write_single(std::string const& msg){
+    inline void write_single(std::string const& msg) {
         lock_type lock(writer_mtx);
-        if(pool.empty()) enlarge_pool();
-        auto value = pool.front();
-        pool.pop_front();
-        strncpy(value, msg.c_str(), std::min(buffer_size-1, msg.length()));
-        write_queue.push_back(value);
-    }
-    inline void write(std::string const& msg){
-        if(pool.empty()) enlarge_pool();
-//        auto value = pool.front();
-//        pool.pop_front();
-//        strncpy(value, msg.c_str(), std::min(buffer_size-1, msg.length()));
-//        write_queue.push_back(value);
+        write(msg.c_str(), msg.length());
     }
-    inline void write(char const* msg, size_t size){
-        if(pool.empty()) enlarge_pool();
-//        auto value = pool.front();
-//        pool.pop_front();
-//        strncpy(value, msg, std::min(buffer_size-1, size));
-//        write_queue.push_back(value);
+
+    inline void write(std::string const& msg) { write(msg.c_str(), msg.length()); }
+
+    inline void write(char const* msg, size_t size) {
+        while(size) {
+            auto len = std::min(size, block_size - current.size());
+            current.insert(current.end(), msg, msg + len);
+            msg += len;
+            size -= len;
+            if(current.size() == block_size)
+                submit();
+        }
     }
 };
-}
-}
+} // namespace trace
+} // namespace scc
 #endif /* _SCC_TRACE_GZ_WRITER_HH_ */
@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_TRACE_SCOPE_TREE_HH_
+#define _SCC_TRACE_SCOPE_TREE_HH_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace scc {
+namespace trace {
+/**
+ * @brief sort trace entries by the hierarchical names of their traces
+ *
+ * @param entries the pointers to the entries
+ * @param trace_of accessor returning the trace of an entry
+ */
+template <typename E, typename TRACE_OF> inline void sort_by_name(std::vector<E*>& entries, TRACE_OF trace_of) {
+    std::sort(std::begin(entries), std::end(entries),
+              [&trace_of](E const* a, E const* b) -> bool { return trace_of(a)->name < trace_of(b)->name; });
+}
+/**
+ * @brief the scope hierarchy of the traces of a trace file
+ *
+ * The traces have to be added in the order of their names (e.g. using sort_by_name()). Since all traces of a scope
+ * are then added consecutively the path of the previously added trace is kept and only the scopes not being shared
+ * with it are created, hence building the tree is linear in the number of traces. The names are not split, each
+ * scope stores its own name once and the leaf names are referenced as offset into the names of the traces.
+ *
+ * @tparam T the trace type having a member name holding the hierarchical name
+ */
+template <typename T> struct scope_tree {
+    struct scope {
+        std::string name;
+        //! the traces of this scope and the offset of the leaf name in the trace name
+        std::vector<std::pair<T*, size_t>> traces;
+        std::vector<std::unique_ptr<scope>> scopes;
+    };
+
+    void add_trace(T* trc) {
+        auto const& name = trc->name;
+        size_t common = 0;
+        if(last_name) {
+            auto len = std::min(name.size(), last_name->size());
+            while(common < len && name[common] == (*last_name)[common])
+                ++common;
+        }
+        // leave the scopes whose names are not part of the common prefix
+        while(!path.empty() && path.back().second >= common)
+            path.pop_back();
+        auto pos = path.empty() ? 0 : path.back().second + 1;
+        for(auto dot = name.find('.', pos); dot != std::string::npos; pos = dot + 1, dot = name.find('.', pos)) {
+            auto& parent = path.empty() ? root : *path.back().first;
+            parent.scopes.emplace_back(new scope{name.substr(pos, dot - pos), {}, {}});
+            path.emplace_back(parent.scopes.back().get(), dot);
+        }
+        (path.empty() ? root : *path.back().first).traces.emplace_back(trc, pos);
+        last_name = &name;
+    }
+    /**
+     * @brief visit the traces and scopes below the root in depth first order, the traces of a scope come first
+     *
+     * @param enter called with the scope being entered
+     * @param visit called with each trace and its leaf name
+     * @param leave called when leaving a scope
+     */
+    template <typename ENTER, typename VISIT, typename LEAVE>
+    void traverse(ENTER enter, VISIT visit, LEAVE leave) const {
+        traverse(root, enter, visit, leave);
+    }
+
+    scope root;
+
+private:
+    template <typename ENTER, typename VISIT, typename LEAVE>
+    static void traverse(scope const& s, ENTER& enter, VISIT& visit, LEAVE& leave) {
+        for(auto& e : s.traces)
+            visit(e.first, e.first->name.c_str() + e.second);
+        for(auto& c : s.scopes) {
+            enter(*c);
+            traverse(*c, enter, visit, leave);
+            leave(*c);
+        }
+    }
+    //! the scopes of the previously added trace and the position of the dot terminating their names
+    std::vector<std::pair<scope*, size_t>> path;
+    std::string const* last_name{nullptr};
+};
+/**
+ * @brief the detection of traces referring to the same object, keyed on the address of the object
+ *
+ * @tparam T the trace type providing get_hash() and is_alias
+ */
+template <typename T> struct alias_map {
+    explicit alias_map(size_t size) { map.reserve(size); }
+    /**
+     * @brief register a trace, it is marked as alias if the object has been registered before
+     *
+     * @param trc the trace
+     * @return the first trace of the object or nullptr if trc is the first one
+     */
+    T* insert(T* trc) {
+        auto res = map.insert({trc->get_hash(), trc});
+        trc->is_alias = !res.second;
+        return res.second ? nullptr : res.first->second;
+    }
+
+private:
+    std::unordered_map<uintptr_t, T*> map;
+};
+} // namespace trace
+} // namespace scc
+#endif /* _SCC_TRACE_SCOPE_TREE_HH_ */
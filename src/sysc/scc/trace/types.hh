@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,6 +17,8 @@
 #ifndef _SCC_TRACE_TYPES_HH_
 #define _SCC_TRACE_TYPES_HH_
 
+#include <cstdint>
+#include <limits>
 #include <type_traits>
 #include <systemc>
 #include <sysc/datatypes/fx/fx.h>
@@ -61,6 +63,22 @@ template<> inline unsigned traits<sc_dt::sc_fxval_fast>::get_bits(sc_dt::sc_fxva
 // should return act_val.wl();
 template<> inline unsigned traits<sc_dt::sc_fxnum>::get_bits(sc_dt::sc_fxnum const&){return 1; }
 template<> inline unsigned traits<sc_dt::sc_fxnum_fast>::get_bits(sc_dt::sc_fxnum_fast const& o){ return 1; }
+/**
+ * get the current simulation time in ticks of the trace timescale (1ps). The division is only done once per timestep,
+ * the result is shared by all trace files of the simulation as they are all written from the simulation thread.
+ */
+inline uint64_t time_stamp_ticks() {
+    static uint64_t last_value = std::numeric_limits<uint64_t>::max();
+    static uint64_t last_ticks = 0;
+    auto now = sc_core::sc_time_stamp().value();
+    if(now != last_value) {
+        // the time resolution is fixed once the simulation runs so the divisor can be kept
+        static const uint64_t divisor = sc_core::sc_time(1, sc_core::SC_PS).value();
+        last_value = now;
+        last_ticks = now / divisor;
+    }
+    return last_ticks;
+}
 }
 }
 
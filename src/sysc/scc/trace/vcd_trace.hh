@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -16,12 +16,8 @@
 #ifndef _SCC_TRACE_VCD_TRACE_HH_
 #define _SCC_TRACE_VCD_TRACE_HH_
 
+#include "scope_tree.hh"
 #include "types.hh"
-#ifndef FWRITE
-#include <cstdio>
-#define FWRITE(BUF, SZ, LEN, FP) std::fwrite(BUF, SZ, LEN, FP)
-#define FPTR FILE*
-#endif
 #include <util/ities.h>
 #include <scc/utilities.h>
 #ifdef FMT_SPDLOG_INTERNAL
@@ -29,103 +25,120 @@
 #else
 #include <fmt/format.h>
 #endif
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <sstream>
 #include <vector>
 #include <unordered_map>
-
+#ifndef FWRITE
+#define FWRITE(BUF, SZ, LEN, FP) (FP)->write((BUF), (SZ) * (LEN))
+#define FPTR vcd_buffer*
+#endif
 
 namespace scc {
 namespace trace {
-
-inline void vcdEmitValueChange(FPTR os, std::string const& handle, unsigned bits, const char *val) {
-    auto buf = bits==1?fmt::format("{}{}\n", *val, handle):fmt::format("b{} {}\n", val, handle);
-    FWRITE(buf.c_str(), 1, buf.size(), os);
-}
-
-inline void vcdEmitValueChange32(FPTR os, std::string const& handle, unsigned bits, uint32_t val){
-    auto buf = fmt::format("b{:b} {}\n", val&((1ull<<bits)-1), handle);
-    FWRITE(buf.c_str(), 1, buf.size(), os);
+/**
+ * the buffer all records of a timestep are written into, it is flushed as one block. Clearing it keeps the memory so
+ * there is no allocation in steady state.
+ */
+struct vcd_buffer {
+    fmt::memory_buffer data;
+    void write(char const* buf, size_t len) { data.append(buf, buf + len); }
+    //! write the content to the file and clear the buffer
+    void flush(FILE* fp) {
+        if(data.size())
+            std::fwrite(data.data(), 1, data.size(), fp);
+        data.clear();
+    }
+};
+//! get the VCD identifier of the trace with the given index
+inline std::string vcd_id(unsigned index) {
+    const unsigned used_types_count = 'z' - 'a' + 1;
+    std::string ret(5, 'a');
+    for(auto it = ret.rbegin(); it != ret.rend(); ++it, index /= used_types_count)
+        *it = static_cast<char>('a' + index % used_types_count);
+    return ret;
 }
-
-inline void vcdEmitValueChange64(FPTR os, std::string const& handle, unsigned bits, uint64_t val){
-    auto buf = fmt::format("b{:b} {}\n", val&((1ul<<std::min(63u,bits))-1), handle);
-    FWRITE(buf.c_str(), 1, buf.size(), os);
+//! write the binary representation of val without leading zeros (at least one digit), returns the end
+inline char* vcdFormatBinary(char* buf, uint64_t val) {
+#ifdef __GNUG__
+    unsigned width = val ? 64 - __builtin_clzll(val) : 1;
+#else
+    unsigned width = 1;
+    for(auto v = val >> 1; v; v >>= 1)
+        ++width;
+#endif
+    for(auto p = buf + width; p != buf; val >>= 1)
+        *--p = static_cast<char>('0' + (val & 1));
+    return buf + width;
 }
-
-template<typename T>
-inline void vcdEmitValueChangeReal(FPTR os, std::string const& handle, unsigned bits, T val){
-    auto buf = fmt::format("r{:.16g} {}\n", static_cast<double>(val), handle);
-    FWRITE(buf.c_str(), 1, buf.size(), os);
+//! the largest handle the value change functions format on the stack
+const size_t max_stack_handle = 32;
+
+inline char* vcdAppendHandle(char* p, std::string const& handle) {
+    std::memcpy(p, handle.data(), handle.size());
+    p += handle.size();
+    *p++ = '\n';
+    return p;
 }
 
-inline size_t get_buffer_size(int length){
-    size_t sz = ( static_cast<size_t>(length) + 4096 ) & (~static_cast<size_t>(4096-1));
-    return std::max<uint64_t>(1024UL, sz);
+inline void vcdEmitTime(FPTR os, uint64_t time_stamp) {
+    fmt::format_int ts(time_stamp);
+    char buf[32];
+    buf[0] = '#';
+    std::memcpy(buf + 1, ts.data(), ts.size());
+    buf[ts.size() + 1] = '\n';
+    FWRITE(buf, 1, ts.size() + 2, os);
 }
 
-/*******************************************************************************************************
- *
- *******************************************************************************************************/
-template<typename T>
-struct vcd_scope_stack {
-    void add_trace(T *trace){
-        auto hier = util::split(trace->name, '.');
-        add_trace_rec(std::begin(hier), std::end(hier), trace);
+inline void vcdEmitValueChange(FPTR os, std::string const& handle, unsigned bits, const char *val) {
+    char buf[256];
+    auto len = bits==1 ? 1 : std::strlen(val);
+    if(len + handle.size() + 3 > sizeof(buf)) {
+        auto str = fmt::format("b{} {}\n", val, handle);
+        FWRITE(str.c_str(), 1, str.size(), os);
+        return;
     }
-
-    void print(FPTR os, const char *scope_name = "SystemC"){
-        auto buf = fmt::format("$scope module {} $end\n", scope_name);
-        FWRITE(buf.c_str(), 1, buf.size(), os);
-        for (auto& e : m_traces)
-            print_variable_declaration_line(os, e.first.c_str(), e.second);
-        for (auto& e : m_scopes)
-            e.second->print(os,e.first.c_str());
-        std::string end = "$upscope $end\n";
-        FWRITE(end.c_str(), 1, end.size(), os);
+    auto* p = buf;
+    if(bits==1)
+        *p++ = *val;
+    else {
+        *p++ = 'b';
+        std::memcpy(p, val, len);
+        p += len;
+        *p++ = ' ';
     }
+    p = vcdAppendHandle(p, handle);
+    FWRITE(buf, 1, p - buf, os);
+}
 
-    ~vcd_scope_stack(){
-        for (auto& s : m_scopes)
-            delete s.second;
-    }
-private:
-    void add_trace_rec(std::vector<std::string>::iterator beg, std::vector<std::string>::iterator const& end, T *trace){
-        if(std::distance(beg,  end)==1){
-            m_traces.push_back(std::make_pair(*beg, trace));
-        } else {
-            auto sc = m_scopes.find(*beg);
-            if(sc == std::end(m_scopes))
-                sc = m_scopes.insert({*beg, new vcd_scope_stack}).first;
-            sc->second->add_trace_rec(++beg, end, trace);
-        }
-    }
-    void print_variable_declaration_line(FPTR os, const char* scoped_name, T* trc){
-        char buf[2000];
-        switch(trc->bits){
-        case 0:{
-            std::stringstream ss;
-            ss << "'" << scoped_name << "' has 0 bits";
-            SC_REPORT_ERROR(sc_core::SC_ID_TRACING_OBJECT_IGNORED_, ss.str().c_str() );
-            return;
-        }
-        case 1:
-            if(trc->type==WIRE) {
-                auto buf = fmt::format("$var wire {} {}  {} $end\n", trc->bits, trc->trc_hndl, scoped_name);
-                FWRITE(buf.c_str(), 1, buf.size(), os);
-            } else {
-                auto buf = fmt::format("$var real {} {} {} $end\n", trc->bits, trc->trc_hndl, scoped_name);
-                FWRITE(buf.c_str(), 1, buf.size(), os);
-            }
-            break;
-        default: {
-            auto buf = fmt::format("$var wire {} {} {} [{}:0] $end\n", trc->bits, trc->trc_hndl, scoped_name, trc->bits-1);
-            FWRITE(buf.c_str(), 1, buf.size(), os);
-        }
-        }
+inline void vcdEmitValueChange64(FPTR os, std::string const& handle, unsigned bits, uint64_t val){
+    auto masked = bits < 64 ? val & ((uint64_t(1) << bits) - 1) : val;
+    if(handle.size() > max_stack_handle) {
+        auto str = fmt::format("b{:b} {}\n", masked, handle);
+        FWRITE(str.c_str(), 1, str.size(), os);
+        return;
     }
+    char buf[64 + max_stack_handle + 4];
+    auto* p = buf;
+    *p++ = 'b';
+    p = vcdFormatBinary(p, masked);
+    *p++ = ' ';
+    p = vcdAppendHandle(p, handle);
+    FWRITE(buf, 1, p - buf, os);
+}
 
-    std::vector<std::pair<std::string,T*> > m_traces{0};
-    std::unordered_map<std::string, vcd_scope_stack*> m_scopes{0};
-};
+inline void vcdEmitValueChange32(FPTR os, std::string const& handle, unsigned bits, uint32_t val){
+    vcdEmitValueChange64(os, handle, bits, val);
+}
+
+template<typename T>
+inline void vcdEmitValueChangeReal(FPTR os, std::string const& handle, unsigned bits, T val){
+    fmt::memory_buffer buf;
+    fmt::format_to(std::back_inserter(buf), "r{:.16g} {}\n", static_cast<double>(val), handle);
+    FWRITE(buf.data(), 1, buf.size(), os);
+}
 
 struct vcd_trace {
     vcd_trace(std::string const& nm, trace_type t, unsigned bits): name{nm}, bits{bits}, type{t}{}
@@ -146,6 +159,66 @@ struct vcd_trace {
     const trace_type type;
 };
 
+inline void vcdDeclareVar(FPTR os, const char* scoped_name, vcd_trace const* trc) {
+    switch(trc->bits) {
+    case 0: {
+        std::stringstream ss;
+        ss << "'" << scoped_name << "' has 0 bits";
+        SC_REPORT_ERROR(sc_core::SC_ID_TRACING_OBJECT_IGNORED_, ss.str().c_str());
+        return;
+    }
+    case 1:
+        if(trc->type == WIRE) {
+            auto buf = fmt::format("$var wire {} {}  {} $end\n", trc->bits, trc->trc_hndl, scoped_name);
+            FWRITE(buf.c_str(), 1, buf.size(), os);
+        } else {
+            auto buf = fmt::format("$var real {} {} {} $end\n", trc->bits, trc->trc_hndl, scoped_name);
+            FWRITE(buf.c_str(), 1, buf.size(), os);
+        }
+        break;
+    default: {
+        auto buf =
+            fmt::format("$var wire {} {} {} [{}:0] $end\n", trc->bits, trc->trc_hndl, scoped_name, trc->bits - 1);
+        FWRITE(buf.c_str(), 1, buf.size(), os);
+    }
+    }
+}
+/**
+ * @brief sort the trace entries, assign the VCD identifiers and write the scope and variable declarations
+ *
+ * Traces of an object already being traced are marked as alias and get the identifier of the first trace.
+ *
+ * @param entries the trace entries of a trace file, they are sorted by the names of their traces
+ * @param trace_of accessor returning the trace of an entry
+ * @param os the buffer receiving the declarations
+ * @param name_index the index of the next identifier to be assigned
+ */
+template <typename E, typename TRACE_OF>
+void vcdDeclareTraces(std::vector<E*>& entries, TRACE_OF trace_of, FPTR os, unsigned& name_index) {
+    sort_by_name(entries, trace_of);
+    scope_tree<vcd_trace> tree;
+    for(auto e : entries)
+        tree.add_trace(trace_of(e));
+    alias_map<vcd_trace> aliases(entries.size());
+    std::string const scope_end = "$upscope $end\n";
+    auto enter = [os](scope_tree<vcd_trace>::scope const& s) {
+        auto buf = fmt::format("$scope module {} $end\n", s.name);
+        FWRITE(buf.c_str(), 1, buf.size(), os);
+    };
+    auto visit = [os, &aliases, &name_index](vcd_trace* trc, const char* leaf_name) {
+        auto* orig = aliases.insert(trc);
+        trc->trc_hndl = orig ? orig->trc_hndl : vcd_id(name_index++);
+        vcdDeclareVar(os, leaf_name, trc);
+    };
+    auto leave = [os, &scope_end](scope_tree<vcd_trace>::scope const&) {
+        FWRITE(scope_end.c_str(), 1, scope_end.size(), os);
+    };
+    tree.root.name = "SystemC";
+    enter(tree.root);
+    tree.traverse(enter, visit, leave);
+    leave(tree.root);
+}
+
 namespace {
 
 inline unsigned get_bits(const char** literals) {
@@ -224,30 +297,17 @@ template<> void vcd_trace_t<float, float>::record(FPTR os){
 template<> void vcd_trace_t<double, double>::record(FPTR os){
     vcdEmitValueChangeReal(os, trc_hndl, 64, old_val);
 }
-template<> void vcd_trace_t<sc_dt::sc_int_base, sc_dt::sc_int_base>::record(FPTR os){
-    static std::vector<char> rawdata(get_buffer_size(old_val.length()));
-    char *rawdata_ptr  = &rawdata[0];
-    for (int bitindex = old_val.length() - 1; bitindex >= 0; --bitindex) {
-        *rawdata_ptr++ = '0'+old_val[bitindex].value();
-    }
-    vcdEmitValueChange(os, trc_hndl, bits, &rawdata[0]);
-}
-template<> void vcd_trace_t<sc_dt::sc_uint_base, sc_dt::sc_uint_base>::record(FPTR os){
-    static std::vector<char> rawdata(get_buffer_size(old_val.length()));
-    char *rawdata_ptr  = &rawdata[0];
-    for (int bitindex = old_val.length() - 1; bitindex >= 0; --bitindex) {
-        *rawdata_ptr++ = '0'+old_val[bitindex].value();
-    }
-    vcdEmitValueChange(os, trc_hndl, bits, &rawdata[0]);
-}
-template<> void vcd_trace_t<sc_dt::sc_signed, sc_dt::sc_signed>::record(FPTR os){
-    static std::vector<char> rawdata(get_buffer_size(old_val.length()));
+// the bits are accessed using test() and written to a per thread buffer so that recording is thread-safe
+template<typename T>
+inline char const* bits_to_string(T const& val, bool compress){
+    static thread_local std::vector<char> rawdata;
+    rawdata.resize(std::max<size_t>(rawdata.size(), static_cast<size_t>(val.length()) + 1));
     char *rawdata_ptr  = &rawdata[0];
-    bool is_started=false;
-    int bitindex = old_val.length() - 1;
-    *rawdata_ptr++ = '0'+old_val[bitindex--].value();
+    int bitindex = val.length() - 1;
+    *rawdata_ptr++ = val.test(bitindex--) ? '1' : '0';
+    bool is_started=!compress;
     for (; bitindex >= 0; --bitindex) {
-        auto c = '0'+old_val[bitindex].value();
+        auto c = val.test(bitindex) ? '1' : '0';
         if(is_started)
             *rawdata_ptr++ = c;
         else if(c=='1' || *(rawdata_ptr-1)!=c ) {
@@ -255,24 +315,20 @@ template<> void vcd_trace_t<sc_dt::sc_signed, sc_dt::sc_signed>::record(FPTR os)
             is_started=true;
         }
     }
-    vcdEmitValueChange(os, trc_hndl, bits, &rawdata[0]);
+    *rawdata_ptr = 0;
+    return &rawdata[0];
+}
+template<> void vcd_trace_t<sc_dt::sc_int_base, sc_dt::sc_int_base>::record(FPTR os){
+    vcdEmitValueChange(os, trc_hndl, bits, bits_to_string(old_val, false));
+}
+template<> void vcd_trace_t<sc_dt::sc_uint_base, sc_dt::sc_uint_base>::record(FPTR os){
+    vcdEmitValueChange(os, trc_hndl, bits, bits_to_string(old_val, false));
+}
+template<> void vcd_trace_t<sc_dt::sc_signed, sc_dt::sc_signed>::record(FPTR os){
+    vcdEmitValueChange(os, trc_hndl, bits, bits_to_string(old_val, true));
 }
 template<> void vcd_trace_t<sc_dt::sc_unsigned, sc_dt::sc_unsigned>::record(FPTR os){
-    static std::vector<char> rawdata(get_buffer_size(old_val.length()));
-    char *rawdata_ptr  = &rawdata[0];
-    bool is_started=false;
-    int bitindex = old_val.length() - 1;
-    *rawdata_ptr++ = '0'+old_val[bitindex--].value();
-    for (; bitindex >= 0; --bitindex) {
-        auto c = '0'+old_val[bitindex].value();
-        if(is_started)
-            *rawdata_ptr++ = c;
-        else if(c=='1' || *(rawdata_ptr-1)!=c ) {
-            *rawdata_ptr++ = c;
-            is_started=true;
-        }
-    }
-    vcdEmitValueChange(os, trc_hndl, bits, &rawdata[0]);
+    vcdEmitValueChange(os, trc_hndl, bits, bits_to_string(old_val, true));
 }
 template<> void vcd_trace_t<sc_dt::sc_fxval, sc_dt::sc_fxval>::record(FPTR os){
     vcdEmitValueChangeReal(os, trc_hndl, bits, old_val);
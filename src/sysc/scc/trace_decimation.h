@@ -0,0 +1,105 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+
+#ifndef _SCC_TRACE_DECIMATION_H_
+#define _SCC_TRACE_DECIMATION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @brief the decimation of the traces of an object
+ *
+ * A decimated trace still compares its value each time step but records only a subset of the changes. A change being
+ * skipped is not recorded later on, so the waveform may show a stale value until the next recorded change.
+ */
+struct trace_decimation {
+    //! record only every nth change, 0 and 1 record all changes
+    unsigned every_nth{1};
+    //! the minimum distance of two recorded changes in ticks of the trace timescale (ps), 0 disables the check
+    uint64_t min_interval{0};
+    //! true if changes are skipped at all
+    bool active() const { return every_nth > 1 || min_interval > 0; }
+};
+/**
+ * @brief the state of a decimated trace
+ */
+struct trace_decimation_state {
+    trace_decimation cfg;
+    unsigned skipped{0};
+    uint64_t last_recorded{std::numeric_limits<uint64_t>::max()};
+    /**
+     * @brief check if a change is to be recorded
+     *
+     * @param now the current time in ticks of the trace timescale
+     * @return true if the change is recorded
+     */
+    bool record(uint64_t now) {
+        if(cfg.min_interval && last_recorded != std::numeric_limits<uint64_t>::max() &&
+           now - last_recorded < cfg.min_interval)
+            return false;
+        if(cfg.every_nth > 1 && ++skipped < cfg.every_nth)
+            return false;
+        skipped = 0;
+        last_recorded = now;
+        return true;
+    }
+};
+//! the interface of trace files supporting decimation (e.g. scc::fst_trace_file or scc::vcd_push_trace_file)
+struct trace_decimation_if {
+    /**
+     * @brief set the decimation of the traces being added subsequently
+     *
+     * @param cfg the decimation, a default constructed one records all changes
+     */
+    virtual void set_decimation(trace_decimation const& cfg) = 0;
+
+protected:
+    virtual ~trace_decimation_if() = default;
+};
+/**
+ * @brief assign the decimations to the trace entries of a trace file
+ *
+ * @param entries the trace entries in the order they were added, each having a trace_decimation_state member dec
+ * @param decimations the configurations and the index of the first entry they apply to, sorted by the index
+ */
+template <typename C>
+inline void apply_decimations(C& entries, std::vector<std::pair<size_t, trace_decimation>> const& decimations) {
+    if(decimations.empty())
+        return;
+    auto it = decimations.begin();
+    trace_decimation cfg;
+    size_t idx = 0;
+    for(auto& e : entries) {
+        for(; it != decimations.end() && it->first <= idx; ++it)
+            cfg = it->second;
+        e.dec.cfg = cfg;
+        ++idx;
+    }
+}
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_TRACE_DECIMATION_H_ */
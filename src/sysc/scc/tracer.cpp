@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2017, 2018 MINRES Technologies GmbH
+ * Copyright 2017-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -21,10 +21,12 @@
  */
 
 #include "tracer.h"
+#include "elab_profiler.h"
 #include "report.h"
 #include "sc_vcd_trace.h"
 #include "scv/scv_tr_db.h"
 #include "utilities.h"
+#include "vcd_pull_trace.hh"
 #include <scc/sc_vcd_trace.h>
 #include <scc/trace.h>
 #ifdef HAS_SCV
@@ -40,6 +42,7 @@
 #endif
 #include <lwtr/lwtr.h>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 
@@ -51,24 +54,13 @@ tracer::tracer(std::string const&& name, file_type tx_type, file_type sig_type,
 , cci_broker(cci::cci_get_broker())
 , txdb(nullptr)
 , lwtr_db(nullptr)
-, owned{sig_type!=NONE} {
+, owned{sig_type!=NONE}
+, trace_stop{sc_core::sc_max_time()} {
     if(sig_type==ENABLE) sig_type = static_cast<file_type>(sig_trace_type.get_value());
-	if(sig_type!=NONE) {
-		switch(sig_type) {
-		default:
-			trf = sc_create_vcd_trace_file(name.c_str());
-			break;
-		case PULL_VCD:
-			trf = scc::create_vcd_pull_trace_file(name.c_str());
-            break;
-        case PUSH_VCD:
-        	trf = scc::create_vcd_push_trace_file(name.c_str());
-            break;
-        case FST:
-        	trf = scc::create_fst_trace_file(name.c_str());
-            break;
-		}
-	}
+    trace_name = name;
+    this->sig_type = sig_type;
+	if(sig_type!=NONE)
+		trf = create_trace_file(name, sig_type);
 	if(trf) trf->set_time_unit(1, SC_PS);
 	init_tx_db(tx_type==ENABLE?static_cast<file_type>(tx_trace_type.get_value()):tx_type, std::move(name));
 }
@@ -83,11 +75,70 @@ tracer::tracer(std::string const&& name, file_type tx_type, sc_core::sc_trace_fi
 	init_tx_db(tx_type==ENABLE?static_cast<file_type>(tx_trace_type.get_value()):tx_type, std::move(name));
 }
 
+sc_core::sc_trace_file* tracer::create_trace_file(std::string const& name, file_type type) {
+	std::function<bool()> enable = [this]() -> bool { return is_trace_active(); };
+	switch(type) {
+	default:
+		return sc_create_vcd_trace_file(name.c_str());
+	case PULL_VCD:
+		return scc::create_vcd_pull_trace_file(name.c_str(), enable);
+	case PUSH_VCD:
+		return scc::create_vcd_push_trace_file(name.c_str(), enable);
+	case FST:
+		return scc::create_fst_trace_file(name.c_str(), enable);
+	case MT_VCD:
+		return scc::create_vcd_mt_trace_file(name.c_str(), enable);
+	case MT_VCD_LZ4:
+		return scc::create_vcd_mt_trace_file(name.c_str(), enable, vcd_compression::LZ4);
+	case MT_VCD_ZSTD:
+		return scc::create_vcd_mt_trace_file(name.c_str(), enable, vcd_compression::ZSTD);
+	}
+}
+
+void tracer::set_trace_window(sc_core::sc_time const& start, sc_core::sc_time const& stop) {
+    trace_start = start;
+    trace_stop = stop;
+}
+
+void tracer::start_trace_on(sc_core::sc_event const& evt) {
+    trace_started = false;
+    sc_core::sc_spawn_options opts;
+    opts.spawn_method();
+    opts.dont_initialize();
+    opts.set_sensitivity(&evt);
+    sc_core::sc_spawn([this]() { trace_started = true; }, sc_core::sc_gen_unique_name("start_trace"), &opts);
+}
+
+void tracer::stop_trace_on(sc_core::sc_event const& evt) {
+    sc_core::sc_spawn_options opts;
+    opts.spawn_method();
+    opts.dont_initialize();
+    opts.set_sensitivity(&evt);
+    sc_core::sc_spawn([this]() { trace_stopped = true; }, sc_core::sc_gen_unique_name("stop_trace"), &opts);
+}
+
+bool tracer::is_trace_active() const {
+    if(!trace_started || trace_stopped)
+        return false;
+    auto now = sc_core::sc_time_stamp();
+    return now >= trace_start && now < trace_stop;
+}
+
+void tracer::set_flight_recorder(sc_core::sc_time const& window) {
+    flight_window = window;
+    if(auto* tf = dynamic_cast<vcd_pull_trace_file*>(trf))
+        tf->set_flight_recorder(window);
+    else
+        SCCWARN(SCMOD) << "flight recording is only supported by the PULL_VCD signal trace file";
+}
+
 tracer::~tracer() {
 	delete txdb;
 	delete lwtr_db;
 	if(trf && owned)
 		scc_close_vcd_trace_file(trf);
+	for(auto& e : shards)
+		scc_close_vcd_trace_file(e.second);
 }
 
 void tracer::init_tx_db(file_type type, std::string const&& name) {
@@ -117,10 +168,12 @@ void tracer::init_tx_db(file_type type, std::string const&& name) {
 		}
 		break;
 #ifdef WITH_SQLITE
-		case SQLITE:
-			SCVNS scv_tr_sqlite_init();
+		case SQLITE: {
+			auto* val = getenv("SCC_SCV_TR_SQLITE_ASYNC");
+			SCVNS scv_tr_sqlite_init(val && *val && *val != '0');
 			ss << ".txdb";
-			break;
+		}
+		break;
 #endif
 		case FTR:
 			SCVNS scv_tr_cbor_init(false);
@@ -138,6 +191,21 @@ void tracer::init_tx_db(file_type type, std::string const&& name) {
 			SCVNS scv_tr_mtc_init();
 			ss << ".txlog";
 			break;
+		case COLUMNAR:
+			SCVNS scv_tr_columnar_init();
+			ss << ".txcol";
+			break;
+		case ANALYSIS:
+			SCVNS scv_tr_analysis_init();
+			break;
+		}
+		if(type != LWFTR && type != LWCFTR) {
+			if(auto* shm = getenv("SCC_SCV_TR_SHM"))
+				SCVNS scv_tr_shm_init(shm);
+			// the value is the length of the bandwidth windows in ns, 0 selects the default
+			if(auto* window = getenv("SCC_SCV_TR_ANALYSIS"))
+				if(type != ANALYSIS)
+					SCVNS scv_tr_analysis_init(strtoul(window, nullptr, 10));
 		}
 		if(type==LWFTR || type==LWCFTR) {
 			lwtr_db = new lwtr::tx_db(name.c_str());
@@ -150,7 +218,38 @@ void tracer::init_tx_db(file_type type, std::string const&& name) {
 	}
 }
 
+void tracer::descend(const sc_core::sc_object* obj, bool trace_all) {
+	if(in_shard || obj == this || !std::regex_match(obj->name(), shard_re)) {
+		tracer_base::descend(obj, trace_all);
+		return;
+	}
+	auto* tf = create_trace_file(trace_name + "." + obj->name(), sig_type);
+	tf->set_time_unit(1, SC_PS);
+	if(flight_window > SC_ZERO_TIME)
+		if(auto* pull_tf = dynamic_cast<vcd_pull_trace_file*>(tf))
+			pull_tf->set_flight_recorder(flight_window);
+	shards.emplace_back(obj->name(), tf);
+	auto* main_trf = trf;
+	trf = tf;
+	in_shard = true;
+	tracer_base::descend(obj, trace_all);
+	in_shard = false;
+	trf = main_trf;
+}
+
 void tracer::end_of_elaboration() {
+	SCC_PROFILE_SCOPE("scc::tracer::end_of_elaboration");
+	// shards are only created if the tracer owns the trace file, in_shard being set suppresses sharding
+	auto regex = shard_regex.get_value();
+	in_shard = regex.empty() || !owned;
+	if(!in_shard) {
+		try {
+			shard_re = std::regex(regex);
+		} catch(std::regex_error& e) {
+			SCCERR(SCMOD) << "invalid shard_regex '" << regex << "': " << e.what();
+			in_shard = true;
+		}
+	}
 	if(trf) {
 		if(top) {
 			descend(top, trf);
@@ -159,4 +258,10 @@ void tracer::end_of_elaboration() {
 				descend(o, default_trace_enable);
 		}
 	}
+	in_shard = false;
+	if(!shards.empty()) {
+		std::ofstream index(trace_name + ".shards");
+		for(auto& e : shards)
+			index << e.first << " " << trace_name << "." << e.first << "\n";
+	}
 }
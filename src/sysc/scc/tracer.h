@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2018 MINRES Technologies GmbH
+ * Copyright 2016-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,6 +19,7 @@
 
 #include "tracer_base.h"
 #include <cci_configuration>
+#include <regex>
 #include <string>
 #include <vector>
 
@@ -60,7 +61,12 @@ public:
         SC_VCD = TEXT,
         PULL_VCD = COMPRESSED,
         PUSH_VCD = SQLITE,
-        FST
+        FST,
+        MT_VCD,      //!< multithreaded VCD writer using gzip
+        MT_VCD_LZ4,  //!< multithreaded VCD writer using LZ4
+        MT_VCD_ZSTD, //!< multithreaded VCD writer using Zstandard
+        COLUMNAR = CUSTOM + 1, //!< columnar transaction database with a time index, see scc::txcol
+        ANALYSIS               //!< only the statistics of the transactions are written, see scv_tr_analysis_init()
     };
     /**
      * cci parameter to determine the file type being used to trace transaction if not specified explicitly
@@ -70,6 +76,12 @@ public:
      * cci parameter to determine the file type being used to trace signals if not specified explicitly
      */
     cci::cci_param<unsigned> sig_trace_type{"sig_trace_type", FST, "Type of signal trace file used for recording. See also scc::tracer::wave_type"};
+    /**
+     * cci parameter to shard the signal trace: each object whose hierarchical name matches the regular expression is
+     * traced into a file of its own named <name>.<hierarchical name>, an empty expression disables sharding.
+     * The shards are listed in the index file <name>.shards
+     */
+    cci::cci_param<std::string> shard_regex{"shard_regex", "", "Regular expression selecting the hierarchies traced into separate signal trace files"};
     /**
      * @fn  tracer(const std::string&&, file_type, bool=true)
      * @brief the constructor
@@ -135,11 +147,56 @@ public:
      * @brief the destructor
      */
     virtual ~tracer() override;
+    /**
+     * @fn void set_trace_window(const sc_core::sc_time&, const sc_core::sc_time&)
+     * @brief restrict signal tracing to a window of simulation time
+     *
+     * The trace window as well as the event triggered start and stop only apply to the signal trace files of SCC
+     * (PULL_VCD, PUSH_VCD, FST and the MT_VCD variants), not to the SystemC VCD file (SC_VCD).
+     *
+     * @param start the simulation time to start tracing
+     * @param stop the simulation time to stop tracing
+     */
+    void set_trace_window(sc_core::sc_time const& start, sc_core::sc_time const& stop = sc_core::sc_max_time());
+    /**
+     * @fn void start_trace_on(const sc_core::sc_event&)
+     * @brief do not trace signals until the event is notified
+     *
+     * @param evt the event starting the tracing
+     */
+    void start_trace_on(sc_core::sc_event const& evt);
+    /**
+     * @fn void stop_trace_on(const sc_core::sc_event&)
+     * @brief stop tracing signals when the event is notified
+     *
+     * @param evt the event stopping the tracing
+     */
+    void stop_trace_on(sc_core::sc_event const& evt);
+    /**
+     * @fn bool is_trace_active()const
+     * @brief check if signals are being traced at the current simulation time
+     *
+     * @return true if tracing is active
+     */
+    bool is_trace_active() const;
+    /**
+     * @fn void set_flight_recorder(const sc_core::sc_time&)
+     * @brief keep only the last window of signal changes in memory and write them when the simulation ends
+     *
+     * The changes are written when the tracer is destroyed, i.e. after sc_stop() or when the simulation is unwound
+     * due to an error. Flight recording is supported by the PULL_VCD trace file only and has to be set up before the
+     * simulation starts, shards of the signal trace (see shard_regex) are created in flight recorder mode if it is
+     * set up before the end of elaboration.
+     *
+     * @param window the simulation time to keep
+     */
+    void set_flight_recorder(sc_core::sc_time const& window);
 
 protected:
     tracer(std::string const&& name, file_type tx_type, file_type sig_type, sc_core::sc_object* top, sc_core::sc_module_name const& nm);
     tracer(std::string const&& name, file_type type, sc_core::sc_trace_file* tf, sc_core::sc_object* top, sc_core::sc_module_name const& nm);
     void end_of_elaboration() override;
+    void descend(const sc_core::sc_object*, bool trace_all) override;
 #ifdef HAS_SCV
     scv_tr_db* txdb;
 #else
@@ -150,8 +207,20 @@ protected:
     cci::cci_broker_handle cci_broker;
 private:
     void init_tx_db(file_type type, std::string const&& name);
+    sc_core::sc_trace_file* create_trace_file(std::string const& name, file_type type);
+    std::string trace_name;
+    file_type sig_type{NONE};
     bool owned{false};
     sc_core::sc_object* top{nullptr};
+    sc_core::sc_time trace_start;
+    sc_core::sc_time trace_stop;
+    bool trace_started{true};
+    bool trace_stopped{false};
+    sc_core::sc_time flight_window;
+    //! the shard files, they are owned by the tracer
+    std::vector<std::pair<std::string, sc_core::sc_trace_file*>> shards;
+    std::regex shard_re;
+    bool in_shard{false};
 };
 
 } /* namespace scc */
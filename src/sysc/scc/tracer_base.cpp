@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2017, 2018 MINRES Technologies GmbH
+ * Copyright 2017-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -25,7 +25,11 @@
 #include "sc_variable.h"
 #include "traceable.h"
 #include <cstring>
+#include <limits>
 #include <systemc>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
 
 #define SC_TRACE_NS ::scc::
 
@@ -34,6 +38,7 @@ namespace scc {
 using sc_trace_file = sc_core::sc_trace_file;
 using sc_object = sc_core::sc_object;
 
+namespace {
 template <typename T>
 inline auto try_trace_obj(sc_trace_file* trace_file, const sc_object* object, trace_types types_to_trace) -> bool {
     if((types_to_trace & trace_types::PORTS) == trace_types::PORTS) {
@@ -55,196 +60,127 @@ inline auto try_trace_obj(sc_trace_file* trace_file, const sc_object* object, tr
     return false;
 }
 
+using trace_fn = bool (*)(sc_trace_file*, const sc_object*, trace_types);
+
 template <size_t SIZE> struct ForLoop {
-    template <template <size_t> class Func>
-    static bool iterate(sc_trace_file* trace_file, const sc_object* object, trace_types types_to_trace) {
-        if(ForLoop<SIZE - (SIZE > 128 ? 8 : 1)>::template iterate<Func>(trace_file, object, types_to_trace))
-            return true;
-        else
-            return Func<SIZE>()(trace_file, object, types_to_trace);
+    template <template <size_t> class T> static void add(std::vector<trace_fn>& table) {
+        ForLoop<SIZE - (SIZE > 128 ? 8 : 1)>::template add<T>(table);
+        table.push_back(&try_trace_obj<T<SIZE>>);
     }
 };
 
 template <> struct ForLoop<1> {
-    template <template <size_t> class Func>
-    static bool iterate(sc_trace_file* trace_file, const sc_object* object, trace_types types_to_trace) {
-        return Func<1>()(trace_file, object, types_to_trace);
+    template <template <size_t> class T> static void add(std::vector<trace_fn>& table) {
+        table.push_back(&try_trace_obj<T<1>>);
     }
 };
 
-template <size_t size> struct sc_uint_tester {
-    bool operator()(sc_trace_file* trace_file, const sc_object* object, trace_types types_to_trace) {
-        return try_trace_obj<sc_uint<size>>(trace_file, object, types_to_trace);
-    }
-};
-
-template <size_t size> struct sc_int_tester {
-    bool operator()(sc_trace_file* trace_file, const sc_object* object, trace_types types_to_trace) {
-        return try_trace_obj<sc_int<size>>(trace_file, object, types_to_trace);
-    }
-};
-
-template <size_t size> struct sc_biguint_tester {
-    bool operator()(sc_trace_file* trace_file, const sc_object* object, trace_types types_to_trace) {
-        return try_trace_obj<sc_biguint<size>>(trace_file, object, types_to_trace);
-    }
-};
-
-template <size_t size> struct sc_bigint_tester {
-    bool operator()(sc_trace_file* trace_file, const sc_object* object, trace_types types_to_trace) {
-        return try_trace_obj<sc_bigint<size>>(trace_file, object, types_to_trace);
-    }
-};
-
-template <size_t size> struct sc_bv_tester {
-    bool operator()(sc_trace_file* trace_file, const sc_object* object, trace_types types_to_trace) {
-        return try_trace_obj<sc_bv<size>>(trace_file, object, types_to_trace);
-    }
-};
-
-template <size_t size> struct sc_lv_tester {
-    bool operator()(sc_trace_file* trace_file, const sc_object* object, trace_types types_to_trace) {
-        return try_trace_obj<sc_lv<size>>(trace_file, object, types_to_trace);
-    }
-};
-
-void tracer_base::try_trace(sc_trace_file* trace_file, const sc_object* object, trace_types types_to_trace) {
-    if(try_trace_obj<bool>(trace_file, object, types_to_trace))
-        return;
-
-    if(try_trace_obj<char>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<unsigned char>(trace_file, object, types_to_trace))
-        return;
-
-    if(try_trace_obj<short>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<unsigned short>(trace_file, object, types_to_trace))
-        return;
-
-    if(try_trace_obj<int>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<unsigned int>(trace_file, object, types_to_trace))
-        return;
-
-    if(try_trace_obj<long>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<unsigned long>(trace_file, object, types_to_trace))
-        return;
-
-    if(try_trace_obj<long long>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<unsigned long long>(trace_file, object, types_to_trace))
-        return;
-
-    if(try_trace_obj<float>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<double>(trace_file, object, types_to_trace))
-        return;
+template <size_t size> using sc_uint_t = sc_uint<static_cast<int>(size)>;
+template <size_t size> using sc_int_t = sc_int<static_cast<int>(size)>;
+template <size_t size> using sc_biguint_t = sc_biguint<static_cast<int>(size)>;
+template <size_t size> using sc_bigint_t = sc_bigint<static_cast<int>(size)>;
+template <size_t size> using sc_bv_t = sc_bv<static_cast<int>(size)>;
+template <size_t size> using sc_lv_t = sc_lv<static_cast<int>(size)>;
+// the trace functions of all supported data types in the order they are tried
+std::vector<trace_fn> const& get_trace_functions() {
+    static std::vector<trace_fn> const table = []() {
+        std::vector<trace_fn> t{&try_trace_obj<bool>,
+                                &try_trace_obj<char>,
+                                &try_trace_obj<unsigned char>,
+                                &try_trace_obj<short>,
+                                &try_trace_obj<unsigned short>,
+                                &try_trace_obj<int>,
+                                &try_trace_obj<unsigned int>,
+                                &try_trace_obj<long>,
+                                &try_trace_obj<unsigned long>,
+                                &try_trace_obj<long long>,
+                                &try_trace_obj<unsigned long long>,
+                                &try_trace_obj<float>,
+                                &try_trace_obj<double>,
 #if(SYSTEMC_VERSION >= 20171012)
-    if(try_trace_obj<sc_core::sc_time>(trace_file, object, types_to_trace))
-        return;
+                                &try_trace_obj<sc_core::sc_time>,
 #endif
-    if(try_trace_obj<sc_bit>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_logic>(trace_file, object, types_to_trace))
-        return;
+                                &try_trace_obj<sc_bit>,
+                                &try_trace_obj<sc_logic>};
 #if !defined(LIMIT_TRACE_TYPE_LIST)
-    if(ForLoop<64>::iterate<sc_uint_tester>(trace_file, object, types_to_trace))
-        return;
-    if(ForLoop<64>::iterate<sc_int_tester>(trace_file, object, types_to_trace))
-        return;
-    if(ForLoop<1024>::iterate<sc_biguint_tester>(trace_file, object, types_to_trace))
-        return;
-    if(ForLoop<1024>::iterate<sc_bigint_tester>(trace_file, object, types_to_trace))
-        return;
-    if(ForLoop<1024>::iterate<sc_bv_tester>(trace_file, object, types_to_trace))
-        return;
-    if(ForLoop<1024>::iterate<sc_lv_tester>(trace_file, object, types_to_trace))
-        return;
+        ForLoop<64>::add<sc_uint_t>(t);
+        ForLoop<64>::add<sc_int_t>(t);
+        ForLoop<1024>::add<sc_biguint_t>(t);
+        ForLoop<1024>::add<sc_bigint_t>(t);
+        ForLoop<1024>::add<sc_bv_t>(t);
+        ForLoop<1024>::add<sc_lv_t>(t);
 #else
-    if(ForLoop<8>::iterate<sc_uint_tester>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_uint<8>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_uint<16>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_uint<32>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_uint<64>>(trace_file, object, types_to_trace))
-        return;
-
-    if(ForLoop<8>::iterate<sc_int_tester>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_int<8>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_int<16>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_int<32>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_int<64>>(trace_file, object, types_to_trace))
-        return;
-
-    if(try_trace_obj<sc_biguint<32>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_biguint<64>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_biguint<128>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_biguint<256>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_biguint<512>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_biguint<1024>>(trace_file, object, types_to_trace))
-        return;
+        ForLoop<8>::add<sc_uint_t>(t);
+        t.insert(t.end(), {&try_trace_obj<sc_uint<16>>, &try_trace_obj<sc_uint<32>>, &try_trace_obj<sc_uint<64>>});
+        ForLoop<8>::add<sc_int_t>(t);
+        t.insert(t.end(), {&try_trace_obj<sc_int<16>>, &try_trace_obj<sc_int<32>>, &try_trace_obj<sc_int<64>>});
+        t.insert(t.end(), {&try_trace_obj<sc_biguint<32>>, &try_trace_obj<sc_biguint<64>>,
+                           &try_trace_obj<sc_biguint<128>>, &try_trace_obj<sc_biguint<256>>,
+                           &try_trace_obj<sc_biguint<512>>, &try_trace_obj<sc_biguint<1024>>});
+        t.insert(t.end(), {&try_trace_obj<sc_bigint<32>>, &try_trace_obj<sc_bigint<64>>,
+                           &try_trace_obj<sc_bigint<128>>, &try_trace_obj<sc_bigint<256>>,
+                           &try_trace_obj<sc_bigint<512>>, &try_trace_obj<sc_bigint<1024>>});
+        ForLoop<8>::add<sc_bv_t>(t);
+        t.insert(t.end(), {&try_trace_obj<sc_bv<16>>, &try_trace_obj<sc_bv<32>>, &try_trace_obj<sc_bv<64>>,
+                           &try_trace_obj<sc_bv<128>>, &try_trace_obj<sc_bv<256>>, &try_trace_obj<sc_bv<512>>});
+        ForLoop<8>::add<sc_lv_t>(t);
+        t.insert(t.end(), {&try_trace_obj<sc_lv<16>>, &try_trace_obj<sc_lv<32>>, &try_trace_obj<sc_lv<64>>,
+                           &try_trace_obj<sc_lv<128>>, &try_trace_obj<sc_lv<256>>, &try_trace_obj<sc_lv<512>>});
+#endif
+        return t;
+    }();
+    return table;
+}
 
-    if(try_trace_obj<sc_bigint<32>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bigint<64>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bigint<128>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bigint<256>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bigint<512>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bigint<1024>>(trace_file, object, types_to_trace))
-        return;
+struct type_key_hash {
+    size_t operator()(std::pair<std::type_index, unsigned> const& k) const {
+        return k.first.hash_code() ^ (static_cast<size_t>(k.second) << 1);
+    }
+};
+} // namespace
 
-    if(ForLoop<8>::iterate<sc_bv_tester>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bv<8>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bv<16>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bv<32>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bv<64>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bv<128>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bv<256>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_bv<512>>(trace_file, object, types_to_trace))
+void tracer_base::try_trace(sc_trace_file* trace_file, const sc_object* object, trace_types types_to_trace) {
+    // whether an object can be traced only depends on its dynamic type, so the index of the matching trace function
+    // is remembered per type. Objects of a known type take a single cast instead of walking the whole list
+    static std::unordered_map<std::pair<std::type_index, unsigned>, size_t, type_key_hash> type_cache;
+    static const size_t no_match = std::numeric_limits<size_t>::max();
+    auto const& table = get_trace_functions();
+    auto key = std::make_pair(std::type_index(typeid(*object)), static_cast<unsigned>(types_to_trace));
+    auto it = type_cache.find(key);
+    if(it != type_cache.end()) {
+        if(it->second != no_match)
+            table[it->second](trace_file, object, types_to_trace);
         return;
+    }
+    auto idx = no_match;
+    for(size_t i = 0; i < table.size() && idx == no_match; ++i)
+        if(table[i](trace_file, object, types_to_trace))
+            idx = i;
+    type_cache.emplace(key, idx);
+}
 
-    if(ForLoop<8>::iterate<sc_lv_tester>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_lv<8>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_lv<16>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_lv<32>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_lv<64>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_lv<128>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_lv<256>>(trace_file, object, types_to_trace))
-        return;
-    if(try_trace_obj<sc_lv<512>>(trace_file, object, types_to_trace))
-        return;
-#endif
+auto tracer_base::get_object_kind(const sc_object* obj) -> object_kind {
+    // kind() returns a string literal of the respective class so the pointer is checked first
+    static std::unordered_map<const char*, object_kind> ptr_cache;
+    static const std::unordered_map<std::string, object_kind> kinds{{"sc_module", object_kind::MODULE},
+                                                                     {"sc_vector", object_kind::VECTOR},
+                                                                     {"sc_variable", object_kind::VARIABLE},
+                                                                     {"tlm_signal", object_kind::TLM_SIGNAL},
+                                                                     {"sc_signal", object_kind::SIGNAL},
+                                                                     {"sc_clock", object_kind::SIGNAL},
+                                                                     {"sc_buffer", object_kind::SIGNAL},
+                                                                     {"sc_signal_rv", object_kind::SIGNAL},
+                                                                     {"sc_in", object_kind::PORT},
+                                                                     {"sc_out", object_kind::PORT},
+                                                                     {"sc_inout", object_kind::PORT}};
+    const char* kind = obj->kind();
+    auto it = ptr_cache.find(kind);
+    if(it != ptr_cache.end())
+        return it->second;
+    auto kit = kinds.find(kind);
+    auto res = kit == kinds.end() ? object_kind::OTHER : kit->second;
+    ptr_cache.emplace(kind, res);
+    return res;
 }
 
 std::string tracer_base::get_name() {
@@ -254,24 +190,19 @@ std::string tracer_base::get_name() {
 void tracer_base::descend(const sc_object* obj, bool trace_all) {
     if(obj == this)
         return;
-    const char* kind = obj->kind();
-    if(strcmp(kind, "tlm_signal") == 0) {
+    auto kind = get_object_kind(obj);
+    if(kind == object_kind::TLM_SIGNAL) {
         obj->trace(trf);
-    } else if(strcmp(kind, "sc_vector") == 0) {
+    } else if(kind == object_kind::VECTOR) {
         for(auto o : obj->get_child_objects())
             descend(o, trace_all);
-    } else if((strcmp(kind, "sc_module") == 0 && trace_all) || dynamic_cast<const traceable*>(obj)) {
+    } else if((kind == object_kind::MODULE && trace_all) || dynamic_cast<const traceable*>(obj)) {
         obj->trace(trf);
         for(auto o : obj->get_child_objects())
             descend(o, trace_all);
-    } else if(strcmp(kind, "sc_variable") == 0) {
+    } else if(kind == object_kind::VARIABLE) {
         if((types_to_trace & trace_types::VARIABLES) == trace_types::VARIABLES)
             obj->trace(trf);
-    } else if(const auto* tr = dynamic_cast<const scc::traceable*>(obj)) {
-        if(tr->is_trace_enabled())
-            obj->trace(trf);
-        for(auto o : obj->get_child_objects())
-            descend(o, tr->is_trace_enabled());
     } else {
         try_trace(trf, obj, types_to_trace);
     }
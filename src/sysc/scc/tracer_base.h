@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2019 MINRES Technologies GmbH
+ * Copyright 2019, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -133,13 +133,22 @@ public:
     void set_trace_file(sc_core::sc_trace_file* trf) { this->trf = trf; }
 
 protected:
+    //! the classes of sc_objects distinguished by their kind() while descending
+    enum class object_kind { OTHER, MODULE, VECTOR, VARIABLE, SIGNAL, PORT, TLM_SIGNAL };
+
 	static std::string get_name();
+    //! classify an object by its kind(), the result is looked up in a table instead of comparing strings
+    static object_kind get_object_kind(const sc_core::sc_object* obj);
 
     //! the default for tracing if no attribute is configured
     bool default_trace_enable{true};
 
     virtual void descend(const sc_core::sc_object*, bool trace_all);
 
+    /**
+     * trace object if it is a port or signal of one of the supported data types. The matching data type is remembered
+     * per dynamic type of the object so that only the first object of a type is tested against all data types
+     */
     static void try_trace(sc_core::sc_trace_file* trace_file, const sc_core::sc_object* object, trace_types t);
 
     sc_core::sc_trace_file* trf{nullptr};
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2018-2022 MINRES Technologies GmbH
+ * Copyright 2018-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -15,11 +15,16 @@
  *******************************************************************************/
 
 #include "value_registry.h"
+#include "elab_profiler.h"
+#include <atomic>
 #include <cstring>
+#include <functional>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <sysc/datatypes/fx/sc_fxnum.h>
 #include <sysc/datatypes/fx/sc_fxval.h>
+#include <type_traits>
 #include <unordered_map>
 
 using namespace sc_core;
@@ -32,6 +37,71 @@ auto operator<<(std::ostream& os, const sc_event& evt) -> std::ostream& {
     return os;
 }
 
+namespace {
+using sample = value_registry::sample;
+
+sample make_sample(sample::type_e type, uint64_t bits) {
+    sample res;
+    res.type = type;
+    res.u = bits;
+    return res;
+}
+
+sample make_sample(double v) {
+    sample res;
+    res.type = sample::DOUBLE;
+    res.d = v;
+    return res;
+}
+
+sample make_sample(bool v) {
+    sample res;
+    res.type = sample::BOOL;
+    res.b = v;
+    return res;
+}
+
+template <typename T>
+inline auto to_sample(T const& v) -> typename std::enable_if<std::is_integral<T>::value, sample>::type {
+    return std::is_signed<T>::value ? make_sample(sample::INT, static_cast<uint64_t>(static_cast<int64_t>(v)))
+                                    : make_sample(sample::UINT, static_cast<uint64_t>(v));
+}
+inline sample to_sample(bool const& v) { return make_sample(v); }
+inline sample to_sample(float const& v) { return make_sample(static_cast<double>(v)); }
+inline sample to_sample(double const& v) { return make_sample(v); }
+inline sample to_sample(sc_time const& v) { return make_sample(v.to_seconds()); }
+inline sample to_sample(sc_event const&) { return sample{}; }
+inline sample to_sample(sc_dt::sc_bit const& v) { return make_sample(v.to_bool()); }
+inline sample to_sample(sc_dt::sc_logic const& v) { return v.is_01() ? make_sample(v.to_bool()) : sample{}; }
+inline sample to_sample(sc_dt::sc_int_base const& v) {
+    return make_sample(sample::INT, static_cast<uint64_t>(v.to_int64()));
+}
+inline sample to_sample(sc_dt::sc_uint_base const& v) { return make_sample(sample::UINT, v.to_uint64()); }
+inline sample to_sample(sc_dt::sc_signed const& v) {
+    return v.length() <= 64 ? make_sample(sample::INT, static_cast<uint64_t>(v.to_int64()))
+                            : make_sample(v.to_double());
+}
+inline sample to_sample(sc_dt::sc_unsigned const& v) {
+    return v.length() <= 64 ? make_sample(sample::UINT, v.to_uint64()) : make_sample(v.to_double());
+}
+inline sample to_sample(sc_dt::sc_fxval const& v) { return make_sample(v.to_double()); }
+inline sample to_sample(sc_dt::sc_fxval_fast const& v) { return make_sample(v.to_double()); }
+inline sample to_sample(sc_dt::sc_fxnum const& v) { return make_sample(v.to_double()); }
+inline sample to_sample(sc_dt::sc_fxnum_fast const& v) { return make_sample(v.to_double()); }
+inline sample to_sample(sc_dt::sc_bv_base const& v) {
+    return v.length() <= 64 ? make_sample(sample::UINT, v.to_uint64()) : sample{};
+}
+inline sample to_sample(sc_dt::sc_lv_base const& v) {
+    return v.length() <= 64 && v.is_01() ? make_sample(sample::UINT, v.to_uint64()) : sample{};
+}
+template <typename T> inline sample to_sample(T const& v, int width) {
+    auto res = to_sample(v);
+    if(width > 0 && width < 64 && (res.type == sample::INT || res.type == sample::UINT))
+        res.u &= (uint64_t(1) << width) - 1;
+    return res;
+}
+} // namespace
+
 #if SC_VERSION_MAJOR <= 2 && SC_VERSION_MINOR <= 3 && SC_VERSION_PATCH < 2
 #define OVERRIDE
 #elif defined(NCSC)
@@ -64,6 +134,7 @@ public:
                 auto* o = new sc_ref_variable<tp>(name, object);                                                       \
                 sc_get_curr_simcontext()->hierarchy_pop();                                                             \
                 holder[name] = o;                                                                                      \
+                add_sampler(name, [&object]() { return to_sample(object); });                                          \
             }                                                                                                          \
         }                                                                                                              \
     }
@@ -75,6 +146,7 @@ public:
                 auto* o = new sc_ref_variable_masked<tp>(name, object, width);                                         \
                 sc_get_curr_simcontext()->hierarchy_pop();                                                             \
                 holder[name] = o;                                                                                      \
+                add_sampler(name, [&object, width]() { return to_sample(object, width); });                            \
             }                                                                                                          \
         }                                                                                                              \
     }                                                                                                                  \
@@ -87,6 +159,7 @@ public:
                 auto* o = new sc_ref_variable<bool>(name.substr(strlen(mod->name()) + 1), object);
                 sc_get_curr_simcontext()->hierarchy_pop();
                 holder[name] = o;
+                add_sampler(name, [&object]() { return to_sample(object); });
             }
         }
     }
@@ -156,7 +229,37 @@ public:
             delete kv.second;
     }
 
+    void add_sampler(std::string const& name, std::function<sample()>&& f) {
+        auto it = sampler_index.find(name);
+        if(it != sampler_index.end()) {
+            samplers[it->second] = std::move(f);
+        } else {
+            sampler_index[name] = samplers.size();
+            sampler_names.push_back(name);
+            samplers.push_back(std::move(f));
+        }
+    }
+
     std::unordered_map<std::string, sc_variable_b*> holder;
+    //! the functions reading the numeric values, their order is the order of the values in a snapshot
+    std::vector<std::function<sample()>> samplers;
+    std::vector<std::string> sampler_names;
+    std::unordered_map<std::string, size_t> sampler_index;
+    /**
+     * a snapshot being protected by a sequence counter (seqlock), the counter is odd while the buffer is written. The
+     * values are stored as atomics so that readers racing with the writer do not invoke undefined behavior, torn
+     * copies are detected by a changed counter and discarded.
+     */
+    struct snapshot_buffer {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<uint64_t> time{0};
+        std::unique_ptr<std::atomic<uint64_t>[]> bits;
+        std::unique_ptr<std::atomic<uint8_t>[]> types;
+    };
+    snapshot_buffer snapshots[2];
+    //! the index of the buffer published last, -1 if none has been published
+    std::atomic<int> current{-1};
+    size_t snapshot_size{0};
 
     sc_dt::uint64 dummy = 0;
 #ifdef NCSC
@@ -164,9 +267,12 @@ public:
 #endif
 };
 
+SC_HAS_PROCESS(value_registry); // NOLINT
+
 value_registry::value_registry()
 : tracer_base(sc_core::sc_module_name(sc_core::sc_gen_unique_name("value_registrar", true))) {
     trf = new value_registry_impl();
+    SC_METHOD(publish_snapshots);
 }
 
 scc::value_registry::~value_registry() { delete dynamic_cast<value_registry_impl*>(trf); }
@@ -180,6 +286,10 @@ auto scc::value_registry::get_names() const -> std::vector<std::string> {
     return keys;
 }
 
+auto scc::value_registry::get_counters() const -> std::vector<counter_statistics> {
+    return counter_registry::get().get_statistics();
+}
+
 auto scc::value_registry::get_value(std::string name) const -> const sc_variable_b* {
     auto* reg = dynamic_cast<value_registry_impl*>(trf);
     auto it = reg->holder.find(name);
@@ -191,8 +301,80 @@ auto scc::value_registry::get_value(std::string name) const -> const sc_variable
     return nullptr;
 }
 
+auto scc::value_registry::get_sample(std::string const& name) const -> sample {
+    auto* reg = dynamic_cast<value_registry_impl*>(trf);
+    auto it = reg->sampler_index.find(name);
+    return it != reg->sampler_index.end() ? reg->samplers[it->second]() : sample{};
+}
+
+auto scc::value_registry::get_snapshot_names() const -> std::vector<std::string> const& {
+    return dynamic_cast<value_registry_impl*>(trf)->sampler_names;
+}
+
+void scc::value_registry::publish_snapshot() {
+    auto* reg = dynamic_cast<value_registry_impl*>(trf);
+    auto idx = reg->current.load(std::memory_order_relaxed) == 0 ? 1 : 0;
+    auto& buf = reg->snapshots[idx];
+    auto seq = buf.seq.load(std::memory_order_relaxed);
+    buf.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for(size_t i = 0; i < reg->snapshot_size; ++i) {
+        auto v = reg->samplers[i]();
+        buf.types[i].store(v.type, std::memory_order_relaxed);
+        buf.bits[i].store(v.u, std::memory_order_relaxed);
+    }
+    buf.time.store(sc_time_stamp().value(), std::memory_order_relaxed);
+    buf.seq.store(seq + 2, std::memory_order_release);
+    reg->current.store(idx, std::memory_order_release);
+}
+
+auto scc::value_registry::read_snapshot(std::vector<sample>& values, sc_core::sc_time* time) const -> bool {
+    auto* reg = dynamic_cast<value_registry_impl*>(trf);
+    values.resize(reg->snapshot_size);
+    for(;;) {
+        auto idx = reg->current.load(std::memory_order_acquire);
+        if(idx < 0)
+            return false;
+        auto& buf = reg->snapshots[idx];
+        auto seq = buf.seq.load(std::memory_order_acquire);
+        if(seq & 1)
+            continue;
+        for(size_t i = 0; i < values.size(); ++i) {
+            values[i].type = static_cast<sample::type_e>(buf.types[i].load(std::memory_order_relaxed));
+            values[i].u = buf.bits[i].load(std::memory_order_relaxed);
+        }
+        auto t = buf.time.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(buf.seq.load(std::memory_order_relaxed) == seq) {
+            if(time)
+                *time = sc_time::from_value(t);
+            return true;
+        }
+    }
+}
+
 void scc::value_registry::end_of_elaboration() {
+    SCC_PROFILE_SCOPE("scc::value_registry::end_of_elaboration");
     for(auto o : sc_get_top_level_objects())
         descend(o, true);
+    // the layout of the snapshots is fixed from now on
+    auto* reg = dynamic_cast<value_registry_impl*>(trf);
+    reg->snapshot_size = reg->samplers.size();
+    for(auto& buf : reg->snapshots) {
+        buf.bits.reset(new std::atomic<uint64_t>[reg->snapshot_size]);
+        buf.types.reset(new std::atomic<uint8_t>[reg->snapshot_size]);
+        for(size_t i = 0; i < reg->snapshot_size; ++i) {
+            buf.bits[i].store(0, std::memory_order_relaxed);
+            buf.types[i].store(sample::NONE, std::memory_order_relaxed);
+        }
+    }
+}
+
+void scc::value_registry::publish_snapshots() {
+    auto interval = snapshot_interval.get_value();
+    if(interval == SC_ZERO_TIME)
+        return;
+    publish_snapshot();
+    next_trigger(interval);
 }
 } // namespace scc
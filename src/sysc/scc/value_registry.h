@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2020-2022 MINRES Technologies GmbH
+ * Copyright 2020-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,8 +17,11 @@
 #ifndef _SCC_VALUE_REGISTRY_H_
 #define _SCC_VALUE_REGISTRY_H_
 
+#include "counters.h"
 #include "sc_variable.h"
 #include "tracer_base.h"
+#include <cci_configuration>
+#include <cstdint>
 #include <sstream>
 #include <sysc/kernel/sc_simcontext.h>
 #include <sysc/tracing/sc_trace.h>
@@ -48,8 +51,42 @@ struct value_registry_if {
     virtual ~value_registry_if() {}
 };
 
+/**
+ * @brief collects the values of the design being accessible by ports, signals and sc_variables
+ *
+ * Besides the textual representation the values of numeric types can be read typed. To allow external threads (e.g.
+ * monitors polling the values) to read them while the simulation is running, the values are copied into a snapshot
+ * every snapshot_interval. Snapshots are double buffered and protected by a sequence counter so reading one neither
+ * blocks the simulation nor needs a lock.
+ */
 class SC_API value_registry : protected tracer_base {
 public:
+    //! a typed numeric value
+    struct sample {
+        enum type_e : uint8_t { NONE, BOOL, INT, UINT, DOUBLE } type{NONE};
+        union {
+            bool b;
+            int64_t i;
+            uint64_t u;
+            double d{0.0};
+        };
+        //! the value converted to double, 0.0 for NONE
+        double to_double() const {
+            switch(type) {
+            case BOOL:
+                return b ? 1.0 : 0.0;
+            case INT:
+                return static_cast<double>(i);
+            case UINT:
+                return static_cast<double>(u);
+            case DOUBLE:
+                return d;
+            default:
+                return 0.0;
+            }
+        }
+    };
+
     value_registry();
 
     ~value_registry();
@@ -57,9 +94,37 @@ public:
     std::vector<std::string> get_names() const;
 
     const sc_variable_b* get_value(std::string name) const;
+    //! get the aggregated counters and histograms of SCC_COUNT and SCC_HIST sorted by name
+    std::vector<counter_statistics> get_counters() const;
+    /**
+     * get the current value of name typed, to be called from the SystemC thread only
+     *
+     * @param name the hierarchical name
+     * @return the value, its type is NONE if name is unknown or its type is not numeric
+     */
+    sample get_sample(std::string const& name) const;
+    /**
+     * get the names of the values in a snapshot, the position of a name is the index of its value. The names are
+     * fixed at the end of the elaboration.
+     */
+    std::vector<std::string> const& get_snapshot_names() const;
+    //! copy the current values into a new snapshot, to be called from the SystemC thread only
+    void publish_snapshot();
+    /**
+     * read the snapshot published last, can be called from any thread
+     *
+     * @param values the values in the order of get_snapshot_names()
+     * @param time the simulation time of the snapshot if not null
+     * @return false if no snapshot has been published yet
+     */
+    bool read_snapshot(std::vector<sample>& values, sc_core::sc_time* time = nullptr) const;
+    //! the interval of publishing snapshots while the simulation runs, no snapshots are published if it is zero
+    cci::cci_param<sc_core::sc_time> snapshot_interval{"snapshot_interval", sc_core::SC_ZERO_TIME};
 
 protected:
     void end_of_elaboration() override;
+
+    void publish_snapshots();
 };
 
 } // namespace scc
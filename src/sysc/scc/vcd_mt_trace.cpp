@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -15,12 +15,13 @@
  *******************************************************************************/
 
 #include "vcd_mt_trace.hh"
+#include "run_report.h"
+#include "span_tracer.h"
 #include "trace/gz_writer.hh"
-#define FWRITE(BUF, SZ, LEN, FP) FP->write(BUF, SZ* LEN)
-#define FPTR gz_writer*
 #include "sc_vcd_trace.h"
 #include "trace/vcd_trace.hh"
 #include "utilities.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
@@ -31,6 +32,8 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -38,13 +41,80 @@
 #define FPRINTF(FP, FMTSTR, ...) FP->write_single(fmt::format(FMTSTR, __VA_ARGS__));
 
 namespace scc {
+namespace {
+//! the minimum number of traces per chunk to make processing it in a worker thread worthwhile
+const size_t min_chunk_size = 4096;
+//! the fixed point types use global state (contexts, memory pools) of the SystemC kernel
+template <typename T> struct is_mt_safe : std::true_type {};
+template <> struct is_mt_safe<sc_dt::sc_fxval> : std::false_type {};
+template <> struct is_mt_safe<sc_dt::sc_fxval_fast> : std::false_type {};
+template <> struct is_mt_safe<sc_dt::sc_fxnum> : std::false_type {};
+template <> struct is_mt_safe<sc_dt::sc_fxnum_fast> : std::false_type {};
+//! integral values are kept in the packed storage, the size selects the group
+template <typename T>
+struct packed_size : std::integral_constant<unsigned, std::is_integral<T>::value ? sizeof(T) : 0> {};
+/**
+ * the shadow values of same sized integral traces in contiguous arrays (structure of arrays). The values are compared
+ * in blocks of 64 yielding a bit mask of changed traces, only those are updated and formatted.
+ */
+template <typename T> struct packed_group {
+    std::vector<T const*> src;
+    std::vector<T> shadow;
+    std::vector<trace::vcd_trace*> traces;
+
+    void add(void const* value, trace::vcd_trace* trc) {
+        // the signed variants are accessed using the unsigned type of the same size
+        src.push_back(static_cast<T const*>(value));
+        shadow.push_back(*src.back());
+        traces.push_back(trc);
+    }
+
+    void process(trace::vcd_buffer& buffer) {
+        auto const n = src.size();
+        for(size_t base = 0; base < n; base += 64) {
+            auto const cnt = std::min<size_t>(64, n - base);
+            auto const* s = &src[base];
+            auto* sh = &shadow[base];
+            uint64_t mask = 0;
+            for(size_t i = 0; i < cnt; ++i) {
+                auto v = *s[i];
+                mask |= static_cast<uint64_t>(v != sh[i]) << i;
+                sh[i] = v;
+            }
+            while(mask) {
+                // the number of trailing zeros is the index of the lowest changed trace
+                auto* trc = traces[base + util::bit_count((mask & -mask) - 1)];
+                trc->update();
+                trc->record(&buffer);
+                mask &= mask - 1;
+            }
+        }
+    }
+};
+} // namespace
+
+struct vcd_mt_trace_file::chunk {
+    size_t begin, end;
+    //! the indices of the traces not being kept in the packed storage
+    std::vector<size_t> generic;
+    packed_group<uint8_t> packed8;
+    packed_group<uint16_t> packed16;
+    packed_group<uint32_t> packed32;
+    packed_group<uint64_t> packed64;
+    trace::vcd_buffer buffer;
+};
 /*******************************************************************************************************
  *
  *******************************************************************************************************/
-vcd_mt_trace_file::vcd_mt_trace_file(const char* name, std::function<bool()>& enable)
+vcd_mt_trace_file::vcd_mt_trace_file(const char* name, std::function<bool()>& enable, vcd_compression compression)
 : name(name)
 , check_enabled(enable) {
-    vcd_out = scc::make_unique<trace::gz_writer>(fmt::format("{}.vcd.gz", name));
+    if(!trace::gz_writer::is_supported(compression)) {
+        SC_REPORT_WARNING("scc::vcd_mt_trace_file", "zstd compression is not available, using gzip instead");
+        compression = vcd_compression::GZIP;
+    }
+    file_name = fmt::format("{}.vcd{}", name, trace::gz_writer::extension(compression));
+    vcd_out = scc::make_unique<trace::gz_writer>(file_name, compression);
 
 #if defined(WITH_SC_TRACING_PHASE_CALLBACKS)
     // remove from hierarchy
@@ -58,7 +128,10 @@ vcd_mt_trace_file::vcd_mt_trace_file(const char* name, std::function<bool()>& en
 
 vcd_mt_trace_file::~vcd_mt_trace_file() {
     if(vcd_out) {
-        FPRINTF(vcd_out, "#{}\n", sc_core::sc_time_stamp() / 1_ps);
+        FPRINTF(vcd_out, "#{}\n", trace::time_stamp_ticks());
+        // join the writer thread and close the file
+        vcd_out.reset();
+        account_trace_file(file_name);
     }
     for(auto t:all_traces) delete t.trc;
 }
@@ -72,15 +145,18 @@ template <typename T, typename OT = T> bool changed(trace::vcd_trace* trace) {
 }
 #define DECL_TRACE_METHOD_A(tp)                                                                                        \
     void vcd_mt_trace_file::trace(const tp& object, const std::string& name) {                                         \
-        all_traces.emplace_back(this, &changed<tp>, new trace::vcd_trace_t<tp>(object, name));                         \
+        all_traces.emplace_back(this, &changed<tp>, new trace::vcd_trace_t<tp>(object, name), is_mt_safe<tp>::value,   \
+                                &object, packed_size<tp>::value);                                                      \
     }
 #define DECL_TRACE_METHOD_B(tp)                                                                                        \
     void vcd_mt_trace_file::trace(const tp& object, const std::string& name, int width) {                              \
-        all_traces.emplace_back(this, &changed<tp>, new trace::vcd_trace_t<tp>(object, name));                         \
+        all_traces.emplace_back(this, &changed<tp>, new trace::vcd_trace_t<tp>(object, name), true, &object,           \
+                                packed_size<tp>::value);                                                               \
     }
 #define DECL_TRACE_METHOD_C(tp, tpo)                                                                                   \
     void vcd_mt_trace_file::trace(const tp& object, const std::string& name) {                                         \
-        all_traces.emplace_back(this, &changed<tp, tpo>, new trace::vcd_trace_t<tp, tpo>(object, name));               \
+        all_traces.emplace_back(this, &changed<tp, tpo>, new trace::vcd_trace_t<tp, tpo>(object, name),                \
+                                is_mt_safe<tp>::value);                                                                \
     }
 
 #if(SYSTEMC_VERSION >= 20171012)
@@ -124,7 +200,8 @@ DECL_TRACE_METHOD_A(sc_dt::sc_lv_base)
 #undef DECL_TRACE_METHOD_C
 
 void vcd_mt_trace_file::trace(const unsigned int& object, const std::string& name, const char** enum_literals) {
-    all_traces.emplace_back(this, &changed<unsigned int>, new trace::vcd_trace_enum(object, name, enum_literals));
+    all_traces.emplace_back(this, &changed<unsigned int>, new trace::vcd_trace_enum(object, name, enum_literals), true,
+                            &object, packed_size<unsigned int>::value);
 }
 
 #define DECL_REGISTER_METHOD_A(tp)                                                                                     \
@@ -185,36 +262,14 @@ DECL_REGISTER_METHOD_A(sc_dt::sc_lv_base)
 #undef DECL_REGISTER_METHOD_C
 
 bool vcd_mt_trace_file::trace_entry::notify() {
-    if(!trc->is_alias && compare_and_update(trc))
-        that->triggered_traces.push_back(trc);
-    return !trc->is_alias;
-}
-
-std::string vcd_mt_trace_file::obtain_name() {
-    const char first_type_used = 'a';
-    const int used_types_count = 'z' - 'a' + 1;
-    int result;
-
-    result = vcd_name_index;
-    char char6 = static_cast<char>(vcd_name_index % used_types_count);
-
-    result = result / used_types_count;
-    char char5 = static_cast<char>(result % used_types_count);
-
-    result = result / used_types_count;
-    char char4 = static_cast<char>(result % used_types_count);
-
-    result = result / used_types_count;
-    char char3 = static_cast<char>(result % used_types_count);
-
-    result = result / used_types_count;
-    char char2 = static_cast<char>(result % used_types_count);
-
-    char buf[20];
-    std::sprintf(buf, "%c%c%c%c%c", char2 + first_type_used, char3 + first_type_used, char4 + first_type_used,
-                 char5 + first_type_used, char6 + first_type_used);
-    vcd_name_index++;
-    return std::string(buf);
+    if(trc->is_alias)
+        return false;
+    // the value is compared in cycle() so that many changes within a timestep cost only a flag check
+    if(!queued) {
+        queued = true;
+        that->triggered_traces.push_back(this);
+    }
+    return true;
 }
 
 void vcd_mt_trace_file::write_comment(const std::string& comment) {
@@ -222,22 +277,34 @@ void vcd_mt_trace_file::write_comment(const std::string& comment) {
 }
 
 void vcd_mt_trace_file::init() {
-    std::sort(std::begin(all_traces), std::end(all_traces),
-              [](trace_entry const& a, trace_entry const& b) -> bool { return a.trc->name < b.trc->name; });
-    std::unordered_map<uintptr_t, std::string> alias_map;
-
-    trace::vcd_scope_stack<trace::vcd_trace> scope;
-    for(auto& e : all_traces) {
-        auto alias_it = alias_map.find(e.trc->get_hash());
-        e.trc->is_alias = alias_it != std::end(alias_map);
-        e.trc->trc_hndl = e.trc->is_alias ? alias_it->second : obtain_name();
-        if(!e.trc->is_alias)
-            alias_map.insert({e.trc->get_hash(), e.trc->trc_hndl});
-        scope.add_trace(e.trc);
+    std::vector<trace_entry*> traces;
+    traces.reserve(all_traces.size());
+    for(auto& e : all_traces)
+        traces.push_back(&e);
+    trace::vcd_buffer buffer;
+    trace::vcdDeclareTraces(traces, [](trace_entry const* e) { return e->trc; }, &buffer, vcd_name_index);
+    for(auto e : traces)
+        if(!(e->trc->is_alias || e->trc->is_triggered))
+            active_traces.push_back(*e);
+    // the traces which can be processed in worker threads first, each part keeps the trace order
+    auto mt_end = std::stable_partition(std::begin(active_traces), std::end(active_traces),
+                                        [](trace_entry const& e) { return e.mt_safe; });
+    auto mt_count = static_cast<size_t>(std::distance(std::begin(active_traces), mt_end));
+    auto workers = std::max(1u, std::thread::hardware_concurrency());
+    auto chunk_count = std::max<size_t>(1, std::min<size_t>(workers, mt_count / min_chunk_size));
+    for(size_t i = 0; i < chunk_count; ++i) {
+        chunks.emplace_back(new chunk);
+        chunks.back()->begin = mt_count * i / chunk_count;
+        chunks.back()->end = mt_count * (i + 1) / chunk_count;
+        prepare(*chunks.back());
     }
-    std::copy_if(std::begin(all_traces), std::end(all_traces), std::back_inserter(active_traces),
-                 [](trace_entry const& e) { return !(e.trc->is_alias || e.trc->is_triggered); });
-    changed_traces.reserve(active_traces.size());
+    serial_chunk.reset(new chunk);
+    serial_chunk->begin = mt_count;
+    serial_chunk->end = active_traces.size();
+    prepare(*serial_chunk);
+    // the calling thread processes the first chunk itself
+    if(chunk_count > 1)
+        pool.start(chunk_count - 1);
     triggered_traces.reserve(active_traces.size());
     // date:
     char tbuf[200];
@@ -254,7 +321,42 @@ void vcd_mt_trace_file::init() {
     std::stringstream ss;
     ss << "tracing " << active_traces.size() << " distinct traces out of " << all_traces.size() << " traces";
     write_comment(ss.str());
-    scope.print(vcd_out.get());
+    scc::trace::gz_writer::lock_type lock(vcd_out->writer_mtx);
+    vcd_out->write(buffer.data.data(), buffer.data.size());
+}
+
+void vcd_mt_trace_file::prepare(chunk& c) {
+    for(auto i = c.begin; i < c.end; ++i) {
+        auto& e = active_traces[i];
+        switch(e.mt_safe ? e.packed_size : 0) {
+        case 1:
+            c.packed8.add(e.value, e.trc);
+            break;
+        case 2:
+            c.packed16.add(e.value, e.trc);
+            break;
+        case 4:
+            c.packed32.add(e.value, e.trc);
+            break;
+        case 8:
+            c.packed64.add(e.value, e.trc);
+            break;
+        default:
+            c.generic.push_back(i);
+        }
+    }
+}
+
+void vcd_mt_trace_file::process(chunk& c) {
+    c.packed8.process(c.buffer);
+    c.packed16.process(c.buffer);
+    c.packed32.process(c.buffer);
+    c.packed64.process(c.buffer);
+    for(auto i : c.generic) {
+        auto& e = active_traces[i];
+        if(e.compare_and_update(e.trc))
+            e.trc->record(&c.buffer);
+    }
 }
 
 std::string vcd_mt_trace_file::prune_name(std::string const& orig_name) {
@@ -290,40 +392,66 @@ void record_changes(FILE* vcd_out, std::vector<trace::vcd_trace*> const& changed
 void vcd_mt_trace_file::cycle(bool delta_cycle) {
     if(delta_cycle)
         return;
+    SCC_SPAN("trace.cycle");
     if(!initialized) {
         init();
         initialized = true;
-        {
-            scc::trace::gz_writer::lock_type lock(vcd_out->writer_mtx);
-            vcd_out->write("$enddefinitions  $end\n\n$dumpvars\n");
-            for(auto& e : all_traces)
-                if(!e.trc->is_alias) {
-                    e.compare_and_update(e.trc);
-                    e.trc->record(vcd_out.get());
-                }
-            vcd_out->write("$end\n\n");
-        }
+        trace::vcd_buffer buffer;
+        for(auto& e : all_traces)
+            if(!e.trc->is_alias) {
+                e.compare_and_update(e.trc);
+                e.trc->record(&buffer);
+            }
+        scc::trace::gz_writer::lock_type lock(vcd_out->writer_mtx);
+        vcd_out->write("$enddefinitions  $end\n\n$dumpvars\n");
+        vcd_out->write(buffer.data.data(), buffer.data.size());
+        vcd_out->write("$end\n\n");
     } else {
         if(check_enabled && !check_enabled())
             return;
-        for(auto& e : active_traces) {
-            if(e.compare_and_update(e.trc))
-                changed_traces.push_back(e.trc);
+        if(chunks.size() > 1) {
+            {
+                std::lock_guard<std::mutex> lock(chunk_mtx);
+                chunks_pending = chunks.size() - 1;
+            }
+            for(size_t i = 1; i < chunks.size(); ++i)
+                pool.post([this, i]() {
+                    process(*chunks[i]);
+                    std::lock_guard<std::mutex> lock(chunk_mtx);
+                    if(--chunks_pending == 0)
+                        chunk_cv.notify_one();
+                });
+            process(*chunks[0]);
+            std::unique_lock<std::mutex> lock(chunk_mtx);
+            chunk_cv.wait(lock, [this]() { return chunks_pending == 0; });
+        } else
+            process(*chunks[0]);
+        process(*serial_chunk);
+        // the observed traces are only queued upon notification, their values are compared once per timestep
+        trace::vcd_buffer triggered;
+        for(auto e : triggered_traces) {
+            e->queued = false;
+            if(e->compare_and_update(e->trc))
+                e->trc->record(&triggered);
         }
-        if(triggered_traces.size() || changed_traces.size()) {
+        triggered_traces.clear();
+        auto has_changes = triggered.data.size() > 0 || serial_chunk->buffer.data.size() > 0;
+        for(auto& c : chunks)
+            has_changes |= c->buffer.data.size() > 0;
+        if(has_changes) {
             scc::trace::gz_writer::lock_type lock(vcd_out->writer_mtx);
-            vcd_out->write(fmt::format("#{}\n", sc_core::sc_time_stamp() / 1_ps));
-            if(triggered_traces.size()) {
-                auto end = std::unique(std::begin(triggered_traces), std::end(triggered_traces));
-                for(auto it = triggered_traces.begin(); it != end; ++it)
-                    (*it)->record(vcd_out.get());
-                triggered_traces.clear();
-            }
-            if(changed_traces.size()) {
-                for(auto t : changed_traces)
-                    t->record(vcd_out.get());
-                changed_traces.clear();
+            trace::vcd_buffer ts;
+            trace::vcdEmitTime(&ts, trace::time_stamp_ticks());
+            vcd_out->write(ts.data.data(), ts.data.size());
+            if(triggered.data.size())
+                vcd_out->write(triggered.data.data(), triggered.data.size());
+            // merge the results in trace order
+            for(auto& c : chunks) {
+                vcd_out->write(c->buffer.data.data(), c->buffer.data.size());
+                c->buffer.data.clear();
             }
+            vcd_out->write(serial_chunk->buffer.data.data(), serial_chunk->buffer.data.size());
+            serial_chunk->buffer.data.clear();
         }
     }
 }
@@ -333,8 +461,9 @@ void vcd_mt_trace_file::set_time_unit(double v, sc_core::sc_time_unit tu) {}
 void vcd_mt_trace_file::set_time_unit( int exponent10_seconds ) {}
 #endif
 
-sc_core::sc_trace_file* create_vcd_mt_trace_file(const char* name, std::function<bool()> enable) {
-    return new vcd_mt_trace_file(name, enable);
+sc_core::sc_trace_file* create_vcd_mt_trace_file(const char* name, std::function<bool()> enable,
+                                                 vcd_compression compression) {
+    return new vcd_mt_trace_file(name, enable, compression);
 }
 
 void close_vcd_mt_trace_file(sc_core::sc_trace_file* tf) { delete static_cast<vcd_mt_trace_file*>(tf); }
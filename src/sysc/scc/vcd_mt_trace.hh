@@ -19,12 +19,16 @@
 #define SCC_VCD_MT_TRACE_H
 
 #include <scc/observer.h>
+#include <scc/trace.h>
 #include <sysc/tracing/sc_trace.h>
 #include <sysc/kernel/sc_ver.h>
 #include <util/thread_pool.h>
+#include <condition_variable>
 #include <deque>
 #include <vector>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 namespace sc_core {
 class sc_time;
@@ -41,7 +45,8 @@ class gz_writer;
 }
 struct vcd_mt_trace_file : public sc_core::sc_trace_file, public observer {
 
-    vcd_mt_trace_file(const char *name, std::function<bool()>& enable);
+    vcd_mt_trace_file(const char *name, std::function<bool()>& enable,
+                      vcd_compression compression = vcd_compression::GZIP);
 
     virtual ~vcd_mt_trace_file();
 
@@ -142,27 +147,46 @@ private:
 
     void init();
     std::string prune_name(std::string const& name);
-    std::string obtain_name();
     std::function<bool()> check_enabled;
     std::unique_ptr<trace::gz_writer> vcd_out{nullptr};
     struct trace_entry: public observer::notification_handle {
         bool (*compare_and_update)(trace::vcd_trace*);
         trace::vcd_trace* trc;
         vcd_mt_trace_file* that;
+        //! false if the traced type uses global state of the SystemC kernel (like the fixed point types)
+        bool mt_safe;
+        //! the traced value and its size if it is an integral type which can be checked in the packed storage
+        void const* value;
+        unsigned packed_size;
+        //! set if the entry is in triggered_traces
+        bool queued{false};
         bool notify() override;
-        trace_entry(vcd_mt_trace_file* owner, bool (*compare_and_update)(trace::vcd_trace*), trace::vcd_trace* trc)
-        :compare_and_update{compare_and_update}, trc{trc}, that{owner}{}
+        trace_entry(vcd_mt_trace_file* owner, bool (*compare_and_update)(trace::vcd_trace*), trace::vcd_trace* trc,
+                bool mt_safe = true, void const* value = nullptr, unsigned packed_size = 0)
+        :compare_and_update{compare_and_update}, trc{trc}, that{owner}, mt_safe{mt_safe}, value{value}
+        , packed_size{packed_size}{}
         virtual ~trace_entry(){}
     };
     std::deque<trace_entry> all_traces;
+    //! the traces being checked each cycle, the ones being mt_safe come first
     std::vector<trace_entry> active_traces;
-    std::vector<trace::vcd_trace*> changed_traces;
-    std::vector<trace::vcd_trace*> triggered_traces;
-    std::vector<trace::vcd_trace*> record_traces;
+    //! the observed traces notified since the last cycle, each is queued once
+    std::vector<trace_entry*> triggered_traces;
     bool initialized{false};
     unsigned vcd_name_index{0};
     std::string name;
-    std::future<bool> res;
+    //! the name of the written file including the extension of the compression
+    std::string file_name;
+    //! the change detection of the mt_safe traces is split into chunks processed in parallel
+    struct chunk;
+    void prepare(chunk&);
+    void process(chunk&);
+    std::vector<std::unique_ptr<chunk>> chunks;
+    std::unique_ptr<chunk> serial_chunk;
+    util::thread_pool pool;
+    std::mutex chunk_mtx;
+    std::condition_variable chunk_cv;
+    size_t chunks_pending{0};
 };
 
 } // namespace scc
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -16,9 +16,12 @@
 
 #include "vcd_pull_trace.hh"
 #include "sc_vcd_trace.h"
+#include "run_report.h"
+#include "span_tracer.h"
 #include "trace/vcd_trace.hh"
 #include "utilities.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -50,7 +53,8 @@ namespace scc {
  *******************************************************************************************************/
 vcd_pull_trace_file::vcd_pull_trace_file(const char* name, std::function<bool()>& enable)
 : name(name)
-, check_enabled(enable) {
+, check_enabled(enable)
+, buffer(new trace::vcd_buffer) {
     vcd_out = fopen(fmt::format("{}.vcd", name).c_str(), "w");
 
 #if defined(WITH_SC_TRACING_PHASE_CALLBACKS)
@@ -65,10 +69,47 @@ vcd_pull_trace_file::vcd_pull_trace_file(const char* name, std::function<bool()>
 
 vcd_pull_trace_file::~vcd_pull_trace_file() {
     if(vcd_out) {
-        FPRINTF(vcd_out, "#{}\n", sc_core::sc_time_stamp() / 1_ps);
+        write_history();
+        FPRINTF(vcd_out, "#{}\n", trace::time_stamp_ticks());
         fclose(vcd_out);
+        account_trace_file(fmt::format("{}.vcd", name));
     }
-    for(auto t:all_traces) delete t.trc;
+    for(auto& t:all_traces) delete t.trc;
+}
+
+void vcd_pull_trace_file::set_flight_recorder(sc_core::sc_time const& window) {
+    sc_assert(!initialized);
+    history_window = window.value() / (1_ps).value();
+}
+
+void vcd_pull_trace_file::record_history(uint64_t time_stamp, bool snapshot) {
+    if(snapshot) {
+        trace::vcdEmitTime(buffer.get(), time_stamp);
+        buffer->write("$dumpvars\n", 10);
+        for(auto e : active_traces)
+            e->trc->record(buffer.get());
+        buffer->write("$end\n", 5);
+        snapshot_times.push_back(time_stamp);
+        next_snapshot = time_stamp + std::max<uint64_t>(1, history_window / 2);
+        // drop everything before the latest snapshot being old enough to cover the window
+        while(snapshot_times.size() > 1 && snapshot_times[1] + history_window <= time_stamp) {
+            history.pop_front();
+            while(!history.front().snapshot)
+                history.pop_front();
+            snapshot_times.pop_front();
+        }
+    }
+    history.push_back({time_stamp, snapshot, std::string(buffer->data.data(), buffer->data.size())});
+    buffer->data.clear();
+}
+
+void vcd_pull_trace_file::write_history() {
+    // the first entry is a snapshot, subsequent ones are redundant
+    for(auto it = history.begin(); it != history.end(); ++it)
+        if(it == history.begin() || !it->snapshot)
+            std::fwrite(it->data.data(), 1, it->data.size(), vcd_out);
+    history.clear();
+    snapshot_times.clear();
 }
 
 template <typename T, typename OT = T> bool changed(trace::vcd_trace* trace) {
@@ -80,15 +121,15 @@ template <typename T, typename OT = T> bool changed(trace::vcd_trace* trace) {
 }
 #define DECL_TRACE_METHOD_A(tp)                                                                                        \
     void vcd_pull_trace_file::trace(const tp& object, const std::string& name) {                                       \
-        all_traces.emplace_back(&changed<tp>, new trace::vcd_trace_t<tp>(object, name));                               \
+        all_traces.emplace_back(this, &changed<tp>, new trace::vcd_trace_t<tp>(object, name));                               \
     }
 #define DECL_TRACE_METHOD_B(tp)                                                                                        \
     void vcd_pull_trace_file::trace(const tp& object, const std::string& name, int width) {                            \
-        all_traces.emplace_back(&changed<tp>, new trace::vcd_trace_t<tp>(object, name));                               \
+        all_traces.emplace_back(this, &changed<tp>, new trace::vcd_trace_t<tp>(object, name));                               \
     }
 #define DECL_TRACE_METHOD_C(tp, tpo)                                                                                   \
     void vcd_pull_trace_file::trace(const tp& object, const std::string& name) {                                       \
-        all_traces.emplace_back(&changed<tp, tpo>, new trace::vcd_trace_t<tp, tpo>(object, name));                     \
+        all_traces.emplace_back(this, &changed<tp, tpo>, new trace::vcd_trace_t<tp, tpo>(object, name));                     \
     }
 
 #if(SYSTEMC_VERSION >= 20171012)
@@ -130,59 +171,97 @@ DECL_TRACE_METHOD_A(sc_dt::sc_bv_base)
 DECL_TRACE_METHOD_A(sc_dt::sc_lv_base)
 #undef DECL_TRACE_METHOD_A
 #undef DECL_TRACE_METHOD_B
+#undef DECL_TRACE_METHOD_C
 
 void vcd_pull_trace_file::trace(const unsigned int& object, const std::string& name, const char** enum_literals) {
-    all_traces.emplace_back(&changed<unsigned int>, new trace::vcd_trace_enum(object, name, enum_literals));
+    all_traces.emplace_back(this, &changed<unsigned int>, new trace::vcd_trace_enum(object, name, enum_literals));
 }
 
-std::string vcd_pull_trace_file::obtain_name() {
-    const char first_type_used = 'a';
-    const int used_types_count = 'z' - 'a' + 1;
-    int result;
+#define DECL_REGISTER_METHOD_A(tp)                                                                                     \
+    observer::notification_handle* vcd_pull_trace_file::observe(const tp& object, const std::string& name) {           \
+        all_traces.emplace_back(this, &changed<tp>, new trace::vcd_trace_t<tp>(object, name));                         \
+        all_traces.back().trc->is_triggered = true;                                                                    \
+        return &all_traces.back();                                                                                     \
+    }
+#define DECL_REGISTER_METHOD_C(tp, tpo)                                                                                \
+    observer::notification_handle* vcd_pull_trace_file::observe(const tp& object, const std::string& name) {           \
+        all_traces.emplace_back(this, &changed<tp, tpo>, new trace::vcd_trace_t<tp, tpo>(object, name));               \
+        all_traces.back().trc->is_triggered = true;                                                                    \
+        return &all_traces.back();                                                                                     \
+    }
+#if(SYSTEMC_VERSION >= 20171012)
+observer::notification_handle* vcd_pull_trace_file::observe(const sc_core::sc_event& object, const std::string& name) {
+    return nullptr;
+}
+observer::notification_handle* vcd_pull_trace_file::observe(const sc_core::sc_time& object, const std::string& name) {
+    return nullptr;
+}
+#endif
 
-    result = vcd_name_index;
-    char char6 = static_cast<char>(vcd_name_index % used_types_count);
+DECL_REGISTER_METHOD_A(bool)
+DECL_REGISTER_METHOD_A(sc_dt::sc_bit)
+DECL_REGISTER_METHOD_A(sc_dt::sc_logic)
 
-    result = result / used_types_count;
-    char char5 = static_cast<char>(result % used_types_count);
+DECL_REGISTER_METHOD_A(unsigned char)
+DECL_REGISTER_METHOD_A(unsigned short)
+DECL_REGISTER_METHOD_A(unsigned int)
+DECL_REGISTER_METHOD_A(unsigned long)
+DECL_REGISTER_METHOD_A(char)
+DECL_REGISTER_METHOD_A(short)
+DECL_REGISTER_METHOD_A(int)
+DECL_REGISTER_METHOD_A(long)
+DECL_REGISTER_METHOD_A(sc_dt::int64)
+DECL_REGISTER_METHOD_A(sc_dt::uint64)
 
-    result = result / used_types_count;
-    char char4 = static_cast<char>(result % used_types_count);
+DECL_REGISTER_METHOD_A(float)
+DECL_REGISTER_METHOD_A(double)
+DECL_REGISTER_METHOD_A(sc_dt::sc_int_base)
+DECL_REGISTER_METHOD_A(sc_dt::sc_uint_base)
+DECL_REGISTER_METHOD_A(sc_dt::sc_signed)
+DECL_REGISTER_METHOD_A(sc_dt::sc_unsigned)
 
-    result = result / used_types_count;
-    char char3 = static_cast<char>(result % used_types_count);
+DECL_REGISTER_METHOD_A(sc_dt::sc_fxval)
+DECL_REGISTER_METHOD_A(sc_dt::sc_fxval_fast)
+DECL_REGISTER_METHOD_C(sc_dt::sc_fxnum, sc_dt::sc_fxval)
+DECL_REGISTER_METHOD_C(sc_dt::sc_fxnum_fast, sc_dt::sc_fxval_fast)
 
-    result = result / used_types_count;
-    char char2 = static_cast<char>(result % used_types_count);
+DECL_REGISTER_METHOD_A(sc_dt::sc_bv_base)
+DECL_REGISTER_METHOD_A(sc_dt::sc_lv_base)
+#undef DECL_REGISTER_METHOD_A
+#undef DECL_REGISTER_METHOD_C
 
-    char buf[20];
-    std::sprintf(buf, "%c%c%c%c%c", char2 + first_type_used, char3 + first_type_used, char4 + first_type_used,
-                 char5 + first_type_used, char6 + first_type_used);
-    vcd_name_index++;
-    return std::string(buf);
+bool vcd_pull_trace_file::trace_entry::notify() {
+    if(trc->is_alias)
+        return false;
+    // the value is compared in cycle() so that many changes within a timestep cost only a flag check
+    if(!queued) {
+        queued = true;
+        that->triggered_traces.push_back(this);
+    }
+    return true;
 }
 
 void vcd_pull_trace_file::write_comment(const std::string& comment) {
     FPRINTF(vcd_out, "$comment\n{}\n$end\n\n", comment);
 }
 
+void vcd_pull_trace_file::set_decimation(trace_decimation const& cfg) {
+    decimations.emplace_back(all_traces.size(), cfg);
+}
+
 void vcd_pull_trace_file::init() {
-    std::sort(std::begin(all_traces), std::end(all_traces),
-              [](trace_entry const& a, trace_entry const& b) -> bool { return a.trc->name < b.trc->name; });
-    std::unordered_map<uintptr_t, std::string> alias_map;
-
-    trace::vcd_scope_stack<trace::vcd_trace> scope;
-    for(auto& e : all_traces) {
-        auto alias_it = alias_map.find(e.trc->get_hash());
-        e.trc->is_alias = alias_it != std::end(alias_map);
-        e.trc->trc_hndl = e.trc->is_alias ? alias_it->second : obtain_name();
-        if(!e.trc->is_alias)
-            alias_map.insert({e.trc->get_hash(), e.trc->trc_hndl});
-        scope.add_trace(e.trc);
-    }
-    std::copy_if(std::begin(all_traces), std::end(all_traces), std::back_inserter(active_traces),
-                 [](trace_entry const& e) { return !e.trc->is_alias; });
-    changed_traces.reserve(active_traces.size());
+    apply_decimations(all_traces, decimations);
+    std::vector<trace_entry*> traces;
+    traces.reserve(all_traces.size());
+    for(auto& e : all_traces)
+        traces.push_back(&e);
+    trace::vcdDeclareTraces(traces, [](trace_entry const* e) { return e->trc; }, buffer.get(), vcd_name_index);
+    std::copy_if(std::begin(traces), std::end(traces), std::back_inserter(active_traces),
+                 [](trace_entry const* e) { return !e->trc->is_alias; });
+    std::copy_if(std::begin(active_traces), std::end(active_traces), std::back_inserter(pull_traces),
+                 [](trace_entry const* e) { return !e->trc->is_triggered; });
+    changed_traces.reserve(pull_traces.size());
+    triggered_traces.reserve(active_traces.size() - pull_traces.size());
     // date:
     char tbuf[200];
     time_t long_time;
@@ -195,9 +274,10 @@ void vcd_pull_trace_file::init() {
     // timescale:
     FPRINTF(vcd_out, "$timescale\n     {}\n$end\n\n", (1_ps).to_string());
     std::stringstream ss;
-    ss << "tracing " << active_traces.size() << " distinct traces out of " << all_traces.size() << " traces";
+    ss << "tracing " << active_traces.size() << " distinct traces out of " << all_traces.size() << " traces, "
+       << active_traces.size() - pull_traces.size() << " of them being observed";
     write_comment(ss.str());
-    scope.print(vcd_out);
+    buffer->flush(vcd_out);
 }
 
 std::string vcd_pull_trace_file::prune_name(std::string const& orig_name) {
@@ -230,31 +310,58 @@ std::string vcd_pull_trace_file::prune_name(std::string const& orig_name) {
 void vcd_pull_trace_file::cycle(bool delta_cycle) {
     if(delta_cycle)
         return;
+    SCC_SPAN("trace.cycle");
     if(!initialized) {
         init();
         initialized = true;
-        FPRINT(vcd_out, "$enddefinitions  $end\n\n$dumpvars\n");
-        for(auto& e : active_traces) {
-            e.compare_and_update(e.trc);
-            e.trc->record(vcd_out);
+        for(auto e : active_traces)
+            e->compare_and_update(e->trc);
+        clear_triggered();
+        if(history_window) {
+            FPRINT(vcd_out, "$enddefinitions  $end\n\n");
+            record_history(trace::time_stamp_ticks(), true);
+            return;
         }
+        FPRINT(vcd_out, "$enddefinitions  $end\n\n$dumpvars\n");
+        for(auto e : active_traces)
+            e->trc->record(buffer.get());
+        buffer->flush(vcd_out);
         FPRINT(vcd_out, "$end\n\n");
     } else {
+        // the observed traces stay queued so that their changes are recorded once tracing is enabled again
         if(check_enabled && !check_enabled())
             return;
+        auto now = trace::time_stamp_ticks();
         changed_traces.clear();
-        for(auto& e : active_traces) {
-            if(e.compare_and_update(e.trc))
-                changed_traces.push_back(e.trc);
+        for(auto e : pull_traces) {
+            if(e->compare_and_update(e->trc) && (!e->dec.cfg.active() || e->dec.record(now)))
+                changed_traces.push_back(e->trc);
         }
+        for(auto e : triggered_traces)
+            if(e->compare_and_update(e->trc) && (!e->dec.cfg.active() || e->dec.record(now)))
+                changed_traces.push_back(e->trc);
+        clear_triggered();
         if(changed_traces.size()) {
-            FPRINTF(vcd_out, "#{}\n", sc_core::sc_time_stamp() / 1_ps);
+            auto time_stamp = trace::time_stamp_ticks();
+            trace::vcdEmitTime(buffer.get(), time_stamp);
             for(auto& t : changed_traces)
-                t->record(vcd_out);
+                t->record(buffer.get());
+            if(history_window) {
+                record_history(time_stamp, false);
+                if(time_stamp >= next_snapshot)
+                    record_history(time_stamp, true);
+            } else
+                buffer->flush(vcd_out);
         }
     }
 }
 
+void vcd_pull_trace_file::clear_triggered() {
+    for(auto e : triggered_traces)
+        e->queued = false;
+    triggered_traces.clear();
+}
+
 void vcd_pull_trace_file::set_time_unit(double v, sc_core::sc_time_unit tu) {}
 #ifdef NCSC
 void vcd_pull_trace_file::set_time_unit( int exponent10_seconds ) {}
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,10 +17,15 @@
 #ifndef SCC_VCD_PULL_TRACE_H
 #define SCC_VCD_PULL_TRACE_H
 
+#include <scc/observer.h>
+#include <scc/trace_decimation.h>
 #include <sysc/tracing/sc_trace.h>
 #include <sysc/kernel/sc_ver.h>
+#include <deque>
+#include <utility>
 #include <vector>
 #include <functional>
+#include <memory>
 
 namespace sc_core {
 class sc_time;
@@ -33,14 +38,34 @@ class sc_time;
 namespace scc {
 namespace trace {
 class vcd_trace;
+struct vcd_buffer;
 }
 
-struct vcd_pull_trace_file : public sc_core::sc_trace_file {
+/**
+ * @brief a VCD trace file polling the traced values
+ *
+ * Objects supporting the \ref observer interface (signals and ports traced using scc::sc_trace, sc_variables,
+ * tlm_signals and registers) notify the trace file about changes, only the remaining ones are compared at each
+ * timestep. Hence idle observable objects do not cause any effort per timestep.
+ */
+struct vcd_pull_trace_file : public sc_core::sc_trace_file, public observer, public trace_decimation_if {
 
     vcd_pull_trace_file(const char *name, std::function<bool()>& enable);
 
     virtual ~vcd_pull_trace_file();
 
+    void set_decimation(trace_decimation const& cfg) override;
+    /**
+     * @brief switch to flight recorder mode, has to be called before the simulation starts
+     *
+     * The value changes are kept in memory and only the last window (at least the given time, at most 1.5 times of
+     * it) is written to the file when it is closed, e.g. when the simulation ends with sc_stop() or when it is
+     * unwound due to an error.
+     *
+     * @param window the simulation time to keep
+     */
+    void set_flight_recorder(sc_core::sc_time const& window);
+
 protected:
 #define DECL_TRACE_METHOD_A(tp) void trace(const tp& object, const std::string& name) override;
 #define DECL_TRACE_METHOD_B(tp) void trace(const tp& object, const std::string& name, int width) override;
@@ -88,6 +113,42 @@ protected:
             const std::string& name,
             const char** enum_literals ) override;
 
+#define DECL_REGISTER_METHOD_A(tp) observer::notification_handle* observe(tp const& o, std::string const& nm) override;
+#if (SYSTEMC_VERSION >= 20171012)
+    DECL_REGISTER_METHOD_A( sc_core::sc_event )
+    DECL_REGISTER_METHOD_A( sc_core::sc_time )
+#endif
+    DECL_REGISTER_METHOD_A( bool )
+    DECL_REGISTER_METHOD_A( sc_dt::sc_bit )
+    DECL_REGISTER_METHOD_A( sc_dt::sc_logic )
+
+    DECL_REGISTER_METHOD_A( unsigned char )
+    DECL_REGISTER_METHOD_A( unsigned short )
+    DECL_REGISTER_METHOD_A( unsigned int )
+    DECL_REGISTER_METHOD_A( unsigned long )
+    DECL_REGISTER_METHOD_A( char )
+    DECL_REGISTER_METHOD_A( short )
+    DECL_REGISTER_METHOD_A( int )
+    DECL_REGISTER_METHOD_A( long )
+    DECL_REGISTER_METHOD_A( sc_dt::int64 )
+    DECL_REGISTER_METHOD_A( sc_dt::uint64 )
+
+    DECL_REGISTER_METHOD_A( float )
+    DECL_REGISTER_METHOD_A( double )
+    DECL_REGISTER_METHOD_A( sc_dt::sc_int_base )
+    DECL_REGISTER_METHOD_A( sc_dt::sc_uint_base )
+    DECL_REGISTER_METHOD_A( sc_dt::sc_signed )
+    DECL_REGISTER_METHOD_A( sc_dt::sc_unsigned )
+
+    DECL_REGISTER_METHOD_A( sc_dt::sc_fxval )
+    DECL_REGISTER_METHOD_A( sc_dt::sc_fxval_fast )
+    DECL_REGISTER_METHOD_A( sc_dt::sc_fxnum )
+    DECL_REGISTER_METHOD_A( sc_dt::sc_fxnum_fast )
+
+    DECL_REGISTER_METHOD_A( sc_dt::sc_bv_base )
+    DECL_REGISTER_METHOD_A( sc_dt::sc_lv_base )
+#undef DECL_REGISTER_METHOD_A
+
     // Output a comment to the trace file
      void write_comment(const std::string& comment) override;
 
@@ -106,18 +167,46 @@ private:
 #endif
 
     void init();
+    void clear_triggered();
     std::string prune_name(std::string const& name);
-    std::string obtain_name();
     std::function<bool()> check_enabled;
 
     FILE* vcd_out{nullptr};
-    struct trace_entry {
+    //! the records of a timestep are collected here and written with a single fwrite
+    std::unique_ptr<trace::vcd_buffer> buffer;
+    struct trace_entry : public observer::notification_handle {
         bool (*compare_and_update)(trace::vcd_trace*);
         trace::vcd_trace* trc;
-        trace_entry(bool (*compare_and_update)(trace::vcd_trace*), trace::vcd_trace* trc):compare_and_update{compare_and_update}, trc{trc}{}
+        vcd_pull_trace_file* that;
+        //! set if the entry is in triggered_traces
+        bool queued{false};
+        //! the decimation of the trace
+        trace_decimation_state dec;
+        bool notify() override;
+        trace_entry(vcd_pull_trace_file* owner, bool (*compare_and_update)(trace::vcd_trace*), trace::vcd_trace* trc)
+        : compare_and_update{compare_and_update}, trc{trc}, that{owner} {}
+    };
+    //! a deque as the entries are referenced by the notifying objects
+    std::deque<trace_entry> all_traces;
+    //! the decimation configurations and the index of the first trace in all_traces they apply to
+    std::vector<std::pair<size_t, trace_decimation>> decimations;
+    //! all distinct traces and the ones to be compared each timestep
+    std::vector<trace_entry*> active_traces, pull_traces;
+    std::vector<trace::vcd_trace*> changed_traces;
+    //! the observed traces having changed in the current timestep
+    std::vector<trace_entry*> triggered_traces;
+    //! a recorded timestep or a snapshot of all values (a $dumpvars block) in flight recorder mode
+    struct history_entry {
+        uint64_t time;
+        bool snapshot;
+        std::string data;
     };
-    std::vector<trace_entry> all_traces, active_traces;
-    std::vector<trace::vcd_trace*> changed_traces;;
+    void record_history(uint64_t time_stamp, bool snapshot);
+    void write_history();
+    std::deque<history_entry> history;
+    std::deque<uint64_t> snapshot_times;
+    uint64_t history_window{0};
+    uint64_t next_snapshot{0};
     bool initialized{false};
     unsigned vcd_name_index{0};
     std::string name;
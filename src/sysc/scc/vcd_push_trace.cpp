@@ -16,6 +16,8 @@
 
 #include "vcd_push_trace.hh"
 #include "sc_vcd_trace.h"
+#include "run_report.h"
+#include "span_tracer.h"
 #include "trace/vcd_trace.hh"
 #include "utilities.h"
 #include <cmath>
@@ -49,7 +51,8 @@ namespace scc {
  *******************************************************************************************************/
 vcd_push_trace_file::vcd_push_trace_file(const char* name, std::function<bool()>& enable)
 : name(name)
-, check_enabled(enable) {
+, check_enabled(enable)
+, buffer(new trace::vcd_buffer) {
     vcd_out = fopen(fmt::format("{}.vcd", name).c_str(), "w");
 
 #if defined(WITH_SC_TRACING_PHASE_CALLBACKS)
@@ -64,8 +67,9 @@ vcd_push_trace_file::vcd_push_trace_file(const char* name, std::function<bool()>
 
 vcd_push_trace_file::~vcd_push_trace_file() {
     if(vcd_out) {
-        FPRINTF(vcd_out, "#{}\n", sc_core::sc_time_stamp() / 1_ps);
+        FPRINTF(vcd_out, "#{}\n", trace::time_stamp_ticks());
         fclose(vcd_out);
+        account_trace_file(fmt::format("{}.vcd", name));
     }
     for(auto t:all_traces) delete t.trc;
 }
@@ -191,60 +195,31 @@ DECL_REGISTER_METHOD_A(sc_dt::sc_lv_base)
 #undef DECL_REGISTER_METHOD_C
 
 bool vcd_push_trace_file::trace_entry::notify() {
-    if(!trc->is_alias && compare_and_update(trc))
-        that->triggered_traces.push_back(trc);
-    return !trc->is_alias;
-}
-
-std::string vcd_push_trace_file::obtain_name() {
-    const char first_type_used = 'a';
-    const int used_types_count = 'z' - 'a' + 1;
-    int result;
-
-    result = vcd_name_index;
-    char char6 = static_cast<char>(vcd_name_index % used_types_count);
-
-    result = result / used_types_count;
-    char char5 = static_cast<char>(result % used_types_count);
-
-    result = result / used_types_count;
-    char char4 = static_cast<char>(result % used_types_count);
-
-    result = result / used_types_count;
-    char char3 = static_cast<char>(result % used_types_count);
-
-    result = result / used_types_count;
-    char char2 = static_cast<char>(result % used_types_count);
-
-    char buf[20];
-    std::sprintf(buf, "%c%c%c%c%c", char2 + first_type_used, char3 + first_type_used, char4 + first_type_used,
-                 char5 + first_type_used, char6 + first_type_used);
-    vcd_name_index++;
-    return std::string(buf);
+    if(trc->is_alias)
+        return false;
+    // the value is compared in cycle() so that many changes within a timestep cost only a flag check
+    if(!queued) {
+        queued = true;
+        that->triggered_traces.push_back(this);
+    }
+    return true;
 }
 
 void vcd_push_trace_file::write_comment(const std::string& comment) {
     FPRINTF(vcd_out, "$comment\n{}\n$end\n\n", comment);
 }
 
+void vcd_push_trace_file::set_decimation(trace_decimation const& cfg) {
+    decimations.emplace_back(all_traces.size(), cfg);
+}
+
 void vcd_push_trace_file::init() {
+    apply_decimations(all_traces, decimations);
     std::vector<trace_entry*> traces;
     traces.reserve(all_traces.size());
     for(auto& e : all_traces)
         traces.push_back(&e);
-    std::sort(std::begin(traces), std::end(traces),
-              [](trace_entry const* a, trace_entry const* b) -> bool { return a->trc->name < b->trc->name; });
-
-    std::unordered_map<uintptr_t, std::string> alias_map;
-    trace::vcd_scope_stack<trace::vcd_trace> scope;
-    for(auto e : traces) {
-        auto alias_it = alias_map.find(e->trc->get_hash());
-        e->trc->is_alias = alias_it != std::end(alias_map);
-        e->trc->trc_hndl = e->trc->is_alias ? alias_it->second : obtain_name();
-        if(!e->trc->is_alias)
-            alias_map.insert({e->trc->get_hash(), e->trc->trc_hndl});
-        scope.add_trace(e->trc);
-    }
+    trace::vcdDeclareTraces(traces, [](trace_entry const* e) { return e->trc; }, buffer.get(), vcd_name_index);
     std::copy_if(std::begin(traces), std::end(traces), std::back_inserter(pull_traces),
                  [](trace_entry const* e) { return !(e->trc->is_alias || e->trc->is_triggered); });
     changed_traces.reserve(pull_traces.size());
@@ -263,7 +238,7 @@ void vcd_push_trace_file::init() {
     std::stringstream ss;
     ss << "tracing " << pull_traces.size() << " distinct traces out of " << all_traces.size() << " traces";
     write_comment(ss.str());
-    scope.print(vcd_out);
+    buffer->flush(vcd_out);
 }
 
 std::string vcd_push_trace_file::prune_name(std::string const& orig_name) {
@@ -296,39 +271,40 @@ std::string vcd_push_trace_file::prune_name(std::string const& orig_name) {
 void vcd_push_trace_file::cycle(bool delta_cycle) {
     if(delta_cycle)
         return;
+    SCC_SPAN("trace.cycle");
     if(last_emitted_ts==std::numeric_limits<uint64_t>::max()) {
         init();
         FPRINT(vcd_out, "$enddefinitions  $end\n\n$dumpvars\n");
         for(auto& e : all_traces)
             if(!e.trc->is_alias) {
                 e.compare_and_update(e.trc);
-                e.trc->record(vcd_out);
+                e.trc->record(buffer.get());
             }
+        buffer->flush(vcd_out);
         FPRINT(vcd_out, "$end\n\n");
-        last_emitted_ts = sc_core::sc_time_stamp().value() / (1_ps).value();
+        last_emitted_ts = trace::time_stamp_ticks();
     } else {
         if(check_enabled && !check_enabled())
             return;
+        auto now = trace::time_stamp_ticks();
         for(auto e : pull_traces) {
-            if(e->compare_and_update(e->trc))
+            if(e->compare_and_update(e->trc) && (!e->dec.cfg.active() || e->dec.record(now)))
                 changed_traces.push_back(e->trc);
         }
-        if(triggered_traces.size() || changed_traces.size()) {
-            uint64_t time_stamp = sc_core::sc_time_stamp().value() / (1_ps).value();
-            FPRINTF(vcd_out, "#{}\n", time_stamp);
-            auto end = std::unique(std::begin(triggered_traces), std::end(triggered_traces));
-            triggered_traces.erase(end, triggered_traces.end());
-            if(triggered_traces.size()) {
-                auto end = std::unique(std::begin(triggered_traces), std::end(triggered_traces));
-                for(auto it = triggered_traces.begin(); it != end; ++it)
-                    (*it)->record(vcd_out);
-                triggered_traces.clear();
-            }
-            if(changed_traces.size()) {
-                for(auto t : changed_traces)
-                    t->record(vcd_out);
-                changed_traces.clear();
-            }
+        // the observed traces are only queued upon notification, their values are compared once per timestep
+        for(auto e : triggered_traces) {
+            e->queued = false;
+            if(e->compare_and_update(e->trc) && (!e->dec.cfg.active() || e->dec.record(now)))
+                changed_traces.push_back(e->trc);
+        }
+        triggered_traces.clear();
+        if(changed_traces.size()) {
+            uint64_t time_stamp = trace::time_stamp_ticks();
+            trace::vcdEmitTime(buffer.get(), time_stamp);
+            for(auto t : changed_traces)
+                t->record(buffer.get());
+            changed_traces.clear();
+            buffer->flush(vcd_out);
             last_emitted_ts = time_stamp;
         }
     }
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2021 MINRES Technologies GmbH
+ * Copyright 2021, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,11 +19,14 @@
 #define SCC_VCD_PUSH_TRACE_H
 
 #include <scc/observer.h>
+#include <scc/trace_decimation.h>
 #include <sysc/tracing/sc_trace.h>
 #include <sysc/kernel/sc_ver.h>
 #include <deque>
+#include <utility>
 #include <vector>
 #include <functional>
+#include <memory>
 
 namespace sc_core {
 class sc_time;
@@ -36,13 +39,16 @@ class sc_time;
 namespace scc {
 namespace trace {
 class vcd_trace;
+struct vcd_buffer;
 }
-struct vcd_push_trace_file : public sc_core::sc_trace_file, public observer {
+struct vcd_push_trace_file : public sc_core::sc_trace_file, public observer, public trace_decimation_if {
 
     vcd_push_trace_file(const char *name, std::function<bool()>& enable);
 
     virtual ~vcd_push_trace_file();
 
+    void set_decimation(trace_decimation const& cfg) override;
+
 protected:
 #define DECL_TRACE_METHOD_A(tp) void trace(const tp& object, const std::string& name) override;
 #define DECL_TRACE_METHOD_B(tp) void trace(const tp& object, const std::string& name, int width) override;
@@ -140,23 +146,31 @@ private:
 
     void init();
     std::string prune_name(std::string const& name);
-    std::string obtain_name();
     std::function<bool()> check_enabled;
 
     FILE* vcd_out{nullptr};
+    //! the records of a timestep are collected here and written with a single fwrite
+    std::unique_ptr<trace::vcd_buffer> buffer;
     struct trace_entry: public observer::notification_handle {
         bool (*compare_and_update)(trace::vcd_trace*);
         trace::vcd_trace* trc;
         vcd_push_trace_file* that;
+        //! set if the entry is in triggered_traces
+        bool queued{false};
+        //! the decimation of the trace
+        trace_decimation_state dec;
         bool notify() override;
         trace_entry(vcd_push_trace_file* owner, bool (*compare_and_update)(trace::vcd_trace*), trace::vcd_trace* trc)
         :compare_and_update{compare_and_update}, trc{trc}, that{owner}{}
         virtual ~trace_entry(){}
     };
     std::deque<trace_entry> all_traces;
+    //! the decimation configurations and the index of the first trace in all_traces they apply to
+    std::vector<std::pair<size_t, trace_decimation>> decimations;
     std::vector<trace_entry*> pull_traces;
     std::vector<trace::vcd_trace*> changed_traces;
-    std::vector<trace::vcd_trace*> triggered_traces;
+    //! the observed traces notified since the last cycle, each is queued once
+    std::vector<trace_entry*> triggered_traces;
     uint64_t last_emitted_ts{std::numeric_limits<uint64_t>::max()};
     unsigned vcd_name_index{0};
     std::string name;
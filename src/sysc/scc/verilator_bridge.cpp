@@ -0,0 +1,115 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#include "verilator_bridge.h"
+#include "report.h"
+#include <algorithm>
+#include <tlm>
+
+namespace scc {
+
+verilator_bridge::verilator_bridge(sc_core::sc_module_name const& nm, sc_core::sc_time clk_period,
+                                   sc_core::sc_time quantum)
+: sc_core::sc_module(nm)
+, clk_period(clk_period)
+, quantum(quantum) {
+    sc_assert(clk_period > sc_core::SC_ZERO_TIME);
+    SC_HAS_PROCESS(verilator_bridge);
+    SC_THREAD(run);
+}
+
+verilator_bridge::~verilator_bridge() { stop_thread(); }
+
+void verilator_bridge::start_of_simulation() {
+    if(quantum == sc_core::SC_ZERO_TIME)
+        quantum = tlm::tlm_global_quantum::instance().get();
+    if(quantum == sc_core::SC_ZERO_TIME)
+        quantum = 100 * clk_period;
+    if(!tick_cb)
+        SCCERR(SCMOD) << "no tick callback registered";
+    thread = std::thread([this]() { rtl_thread(); });
+}
+
+void verilator_bridge::end_of_simulation() { stop_thread(); }
+
+void verilator_bridge::run() {
+    auto quantum_cycles = std::max<uint64_t>(1, static_cast<uint64_t>(quantum / clk_period));
+    while(true) {
+        for(auto& r : to_rtl)
+            r->publish();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            pending_cycles = quantum_cycles;
+            busy = true;
+        }
+        cv.notify_all();
+        wait(clk_period * static_cast<double>(quantum_cycles));
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this]() { return !busy; });
+        cycles += quantum_cycles;
+        if(error)
+            std::rethrow_exception(error);
+        if(finished) {
+            lock.unlock();
+            SCCINFO(SCMOD) << "model finished after " << cycles << " cycles";
+            sc_core::sc_stop();
+            return;
+        }
+        lock.unlock();
+        quantum_evt.notify(sc_core::SC_ZERO_TIME);
+    }
+}
+
+void verilator_bridge::rtl_thread() {
+    uint64_t cycle = 0;
+    std::unique_lock<std::mutex> lock(mtx);
+    while(true) {
+        cv.wait(lock, [this]() { return stop || pending_cycles; });
+        if(stop)
+            return;
+        auto count = pending_cycles;
+        pending_cycles = 0;
+        lock.unlock();
+        bool running = true;
+        std::exception_ptr err;
+        try {
+            for(uint64_t i = 0; i < count && running; ++i)
+                running = tick_cb ? tick_cb(cycle++) : false;
+        } catch(...) {
+            err = std::current_exception();
+        }
+        // published before busy is cleared so that the entries are visible once the kernel continues
+        for(auto& r : from_rtl)
+            r->publish();
+        lock.lock();
+        finished = !running;
+        error = err;
+        busy = false;
+        cv.notify_all();
+    }
+}
+
+void verilator_bridge::stop_thread() {
+    if(!thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+    }
+    cv.notify_all();
+    thread.join();
+}
+} // namespace scc
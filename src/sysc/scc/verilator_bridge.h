@@ -0,0 +1,139 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SCC_VERILATOR_BRIDGE_H_
+#define _SCC_VERILATOR_BRIDGE_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <systemc>
+#include <thread>
+#include <util/spsc_ring.h>
+#include <vector>
+
+/** \ingroup scc-sysc
+ *  @{
+ */
+/**@{*/
+//! @brief SCC SystemC utilities
+namespace scc {
+/**
+ * @class verilator_bridge
+ * @brief runs a cycle based model, e.g. a Verilated RTL model, on its own host thread in parallel to the SystemC kernel
+ *
+ * Instead of driving the model through SystemC signals each clock cycle the bridge calls the tick callback on a
+ * host thread for all cycles of a quantum while the SystemC side simulates the same quantum. Both sides synchronize
+ * only at the quantum boundaries. The data is exchanged through lock-free single-producer/single-consumer rings of
+ * plain structs (e.g. the content of the AXI or OBI channels of the RTL ports), entries written during a quantum
+ * become visible to the other side at the next quantum boundary. This makes the exchange deterministic at the cost of
+ * a latency of one quantum between both sides.
+ *
+ * \code
+ * auto& req = bridge.add_to_rtl_channel<ar_req>(64);
+ * auto& rsp = bridge.add_from_rtl_channel<r_rsp>(64);
+ * bridge.set_tick_cb([&](uint64_t cycle) -> bool {
+ *     top->clk = 0;
+ *     top->eval();
+ *     // drive the inputs from req, push the outputs to rsp
+ *     top->clk = 1;
+ *     top->eval();
+ *     return !Verilated::gotFinish();
+ * });
+ * \endcode
+ *
+ * The tick callback must not access the SystemC kernel, the SystemC side waits for quantum_event() to
+ * consume the entries of the from_rtl channels. Returning false from the tick callback stops the simulation at the
+ * end of the quantum.
+ */
+class verilator_bridge : public sc_core::sc_module {
+public:
+    /**
+     * @param nm the instance name
+     * @param clk_period the clock period of the model
+     * @param quantum the time simulated by either side between two synchronizations, SC_ZERO_TIME uses the global
+     * TLM quantum or 100 cycles if that is not set
+     */
+    verilator_bridge(sc_core::sc_module_name const& nm, sc_core::sc_time clk_period,
+                     sc_core::sc_time quantum = sc_core::SC_ZERO_TIME);
+
+    ~verilator_bridge();
+    /**
+     * set the function simulating one clock cycle of the model, it is called from the host thread of the bridge
+     *
+     * @param cb the callback getting the number of the cycle, it returns false if the model finished
+     */
+    void set_tick_cb(std::function<bool(uint64_t)> cb) { tick_cb = std::move(cb); }
+    /**
+     * add a channel from the SystemC side to the model, to be called during elaboration
+     *
+     * @param capacity the number of entries the channel can hold, it needs to be large enough for one quantum
+     * @return the ring, pushed to by SystemC processes and popped from by the tick callback
+     */
+    template <typename T> util::spsc_ring<T>& add_to_rtl_channel(size_t capacity) {
+        auto* ring = new util::spsc_ring<T>(capacity);
+        to_rtl.emplace_back(ring);
+        return *ring;
+    }
+    /**
+     * add a channel from the model to the SystemC side, to be called during elaboration
+     *
+     * @param capacity the number of entries the channel can hold, it needs to be large enough for one quantum
+     * @return the ring, pushed to by the tick callback and popped from by SystemC processes
+     */
+    template <typename T> util::spsc_ring<T>& add_from_rtl_channel(size_t capacity) {
+        auto* ring = new util::spsc_ring<T>(capacity);
+        from_rtl.emplace_back(ring);
+        return *ring;
+    }
+    //! the event notified at each quantum boundary after the entries of the model became visible
+    sc_core::sc_event const& quantum_event() const { return quantum_evt; }
+    //! the number of cycles simulated by the model up to the last quantum boundary
+    uint64_t get_cycles() const { return cycles; }
+
+protected:
+    void start_of_simulation() override;
+
+    void end_of_simulation() override;
+
+private:
+    void run();
+
+    void rtl_thread();
+
+    void stop_thread();
+
+    sc_core::sc_time clk_period;
+    sc_core::sc_time quantum;
+    std::function<bool(uint64_t)> tick_cb;
+    std::vector<std::unique_ptr<util::spsc_ring_base>> to_rtl, from_rtl;
+    sc_core::sc_event quantum_evt;
+    uint64_t cycles{0};
+    std::thread thread;
+    std::mutex mtx;
+    std::condition_variable cv;
+    uint64_t pending_cycles{0};
+    bool busy{false};
+    bool finished{false};
+    bool stop{false};
+    std::exception_ptr error;
+};
+} // namespace scc
+/** @} */ // end of scc-sysc
+#endif /* _SCC_VERILATOR_BRIDGE_H_ */
@@ -22,30 +22,45 @@
  * This module contains generic C++ functions being independent of SystemC
  */
 /**@{*/
+#include "scc/cached_cci_param.h"
+#include "scc/clock_domain.h"
+#include "scc/clock_edges.h"
 #include "scc/configurable_tracer.h"
 #include "scc/configurer.h"
+#include "scc/counters.h"
+#include "scc/elab_profiler.h"
 #include "scc/ext_attribute.h"
 #include "scc/fifo_w_cb.h"
 #include "scc/hierarchy_dumper.h"
 #include "scc/mt19937_rng.h"
 #include "scc/ordered_semaphore.h"
+#include "scc/parallel_elaborator.h"
+#include "scc/partition_link.h"
 #include "scc/peq.h"
 #include "scc/perf_estimator.h"
+#include "scc/process_profiler.h"
+#include "scc/pysysc_support.h"
 #include "scc/report.h"
+#include "scc/run_report.h"
 #include "scc/sc_logic_7.h"
+#include "scc/sc_lv7.h"
 #include "scc/sc_owning_signal.h"
 #include "scc/sc_variable.h"
 #include "scc/sc_vcd_trace.h"
 #include "scc/scv/scv_tr_db.h"
+#include "scc/sim_watchdog.h"
+#include "scc/span_tracer.h"
 #include "scc/tick2time.h"
 #include "scc/time2tick.h"
 #include "scc/trace.h"
+#include "scc/trace_decimation.h"
 #include "scc/traceable.h"
 #include "scc/tracer.h"
 #include "scc/tracer_base.h"
 #include "scc/utilities.h"
 #include "scc/value_registry.h"
 #include "scc/vcd_push_trace.hh"
+#include "scc/verilator_bridge.h"
 #include "tlm/scc/scv/tlm_extension_recording_registry.h"
 #include "tlm/scc/scv/tlm_gp_data.h"
 #include "tlm/scc/scv/tlm_gp_data_ext.h"
@@ -65,6 +80,7 @@
 #include "tlm/scc/signal_target_mixin.h"
 #include "tlm/scc/tagged_initiator_mixin.h"
 #include "tlm/scc/tagged_target_mixin.h"
+#include "tlm/scc/tlm_irq_vector.h"
 #include "tlm/scc/tlm_signal.h"
 #include "tlm/scc/tlm_signal_conv.h"
 #include "tlm/scc/tlm_signal_gp.h"
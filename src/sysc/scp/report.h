@@ -51,19 +51,23 @@ namespace scp {
         .get()
 //! macro for debug trace level output
 #define SCP_TRACEALL(...)                                           \
-    if (::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_DEBUG) \
+    if (SCC_LOG_LEVEL_ENABLED(::scc::log::TRACEALL) &&              \
+        ::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_DEBUG) \
     SCP_LOG(sc_core::SC_DEBUG, __VA_ARGS__)
 //! macro for trace level output
 #define SCP_TRACE(...)                                             \
-    if (::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_FULL) \
+    if (SCC_LOG_LEVEL_ENABLED(::scc::log::TRACE) &&                \
+        ::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_FULL) \
     SCP_LOG(sc_core::SC_FULL, __VA_ARGS__)
 //! macro for debug level output
 #define SCP_DEBUG(...)                                             \
-    if (::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_HIGH) \
+    if (SCC_LOG_LEVEL_ENABLED(::scc::log::DEBUG) &&                \
+        ::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_HIGH) \
     SCP_LOG(sc_core::SC_HIGH, __VA_ARGS__)
 //! macro for info level output
 #define SCP_INFO(...)                                                \
-    if (::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_MEDIUM) \
+    if (SCC_LOG_LEVEL_ENABLED(::scc::log::INFO) &&                   \
+        ::scc::get_log_verbosity(__VA_ARGS__) >= sc_core::SC_MEDIUM) \
     SCP_LOG(sc_core::SC_MEDIUM, __VA_ARGS__)
 //! macro for warning level output
 #define SCP_WARN(...)                                          \
@@ -16,9 +16,15 @@
 #ifndef _SCP_PATHTRACE_EXTENSION_H
 #define _SCP_PATHTRACE_EXTENSION_H
 
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <sstream>
 #include <systemc>
 #include <tlm>
+#include <tlm/scc/tlm_mm.h>
+#include <unordered_map>
+#include <vector>
 
 namespace scp::tlm_extensions {
 
@@ -75,5 +81,155 @@ public:
         return info.str();
     }
 };
+
+/**
+ * @class path_trace_registry
+ *
+ * @brief Registry of the compact IDs of the components stamping a
+ * compact_path_trace
+ *
+ * @details The IDs should be assigned during elaboration, e.g. in the
+ *          constructor of a component keeping its ID, so that stamping a
+ *          transaction does not need a lookup. The ID 0 is never assigned and
+ *          denotes an unknown component.
+ */
+class path_trace_registry
+{
+    std::unordered_map<sc_core::sc_object const*, uint16_t> m_ids;
+    std::vector<sc_core::sc_object*> m_objects{ nullptr };
+
+    path_trace_registry() = default;
+
+public:
+    static path_trace_registry& get() {
+        static path_trace_registry inst;
+        return inst;
+    }
+    /**
+     * @brief Get the ID of an object, it is assigned upon the first call
+     * @param obj  the object
+     * @return the ID or 0 if all IDs are in use
+     */
+    uint16_t id_of(sc_core::sc_object* obj) {
+        auto it = m_ids.find(obj);
+        if (it != m_ids.end())
+            return it->second;
+        if (m_objects.size() > std::numeric_limits<uint16_t>::max()) {
+            SC_REPORT_WARNING("path_trace_registry",
+                              "all compact path trace IDs are in use");
+            return 0;
+        }
+        auto id = static_cast<uint16_t>(m_objects.size());
+        m_objects.push_back(obj);
+        m_ids.emplace(obj, id);
+        return id;
+    }
+    /**
+     * @brief Get the object of an ID
+     * @param id  the ID
+     * @return the object or nullptr if the ID is not assigned
+     */
+    sc_core::sc_object* object_of(uint16_t id) const {
+        return id < m_objects.size() ? m_objects[id] : nullptr;
+    }
+};
+
+/**
+ * @class Compact path recording TLM extension
+ *
+ * @brief Path recording TLM extension without allocations
+ *
+ * @details Ignorable Extension type like path_trace, but the path is kept as
+ *          an inline array of the compact IDs given by the
+ *          path_trace_registry. Hence neither stamping nor cloning allocates
+ *          memory and instances created using create() are pooled by
+ *          tlm::scc::tlm_ext_mm. Hops beyond CAPACITY are not recorded, this
+ *          is flagged by overflowed().
+ *
+ * @tparam CAPACITY the maximum number of hops being recorded
+ */
+template <unsigned CAPACITY = 16>
+class compact_path_trace
+    : public tlm::tlm_extension<compact_path_trace<CAPACITY>>
+{
+    static_assert(CAPACITY > 0 && CAPACITY < 256,
+                  "CAPACITY needs to be in the range of 1..255");
+    std::array<uint16_t, CAPACITY> m_path{};
+    uint8_t m_size{ 0 };
+    bool m_overflow{ false };
+
+public:
+    compact_path_trace() = default;
+    compact_path_trace(const compact_path_trace&) = default;
+
+    /**
+     * @brief Create an extension from the pool, it is returned to the pool
+     * by free()
+     */
+    static compact_path_trace* create() {
+        return tlm::scc::tlm_ext_mm<compact_path_trace>::create();
+    }
+
+    virtual tlm::tlm_extension_base* clone() const override {
+        return new compact_path_trace(*this);
+    }
+
+    virtual void copy_from(const tlm::tlm_extension_base& ext) override {
+        const compact_path_trace& other =
+            static_cast<const compact_path_trace&>(ext);
+        m_path = other.m_path;
+        m_size = other.m_size;
+        m_overflow = other.m_overflow;
+    }
+
+    /**
+     * @brief Stamp the ID of a component into the path
+     * @param id  the ID as given by path_trace_registry::id_of()
+     */
+    void stamp(uint16_t id) {
+        if (m_size < CAPACITY)
+            m_path[m_size++] = id;
+        else
+            m_overflow = true;
+    }
+    /**
+     * @brief Stamp object into the path, this needs a lookup of the ID
+     * @param obj  Object to add to the path
+     */
+    void stamp(sc_core::sc_object* obj) {
+        stamp(path_trace_registry::get().id_of(obj));
+    }
+
+    void reset() {
+        m_size = 0;
+        m_overflow = false;
+    }
+    //! the number of hops being recorded
+    size_t size() const { return m_size; }
+    //! the ID of a hop
+    uint16_t operator[](size_t idx) const { return m_path[idx]; }
+    //! check if hops were dropped as the capacity was exceeded
+    bool overflowed() const { return m_overflow; }
+    /**
+     * @brief convert extension to a string
+     * @param separator (default "->")
+     * @return a string consisting of the names of each object stamped into the
+     * path separated with the separator provided, dropped hops are shown as
+     * "..." at the end.
+     */
+    std::string to_string(std::string separator = "->") const {
+        std::stringstream info;
+        std::string s;
+        auto& reg = path_trace_registry::get();
+        for (size_t i = 0; i < m_size; ++i) {
+            auto* o = reg.object_of(m_path[i]);
+            info << s << (o ? o->name() : "?");
+            s = separator;
+        }
+        if (m_overflow)
+            info << s << "...";
+        return info.str();
+    }
+};
 } // namespace scp::tlm_extensions
 #endif
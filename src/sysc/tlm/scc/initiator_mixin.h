@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2018 MINRES Technologies GmbH
+ * Copyright 2016, 2018, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,10 +17,13 @@
 #ifndef _TLM_SCC_INITIATOR_MIXIN_H__
 #define _TLM_SCC_INITIATOR_MIXIN_H__
 
+#include "quantum_keeper.h"
 #include "scc/utilities.h"
 #include <functional>
+#include <memory>
 #include <sstream>
 #include <tlm>
+#include <util/inplace_function.h>
 
 //! @brief SystemC TLM
 namespace tlm {
@@ -32,6 +35,10 @@ namespace scc {
  *
  * an initiator socket mixin adding default implementation of callback functions similar to tlm::simple_initiator_socket
  *
+ * When using b_transport_td() and advance() instead of calling b_transport and wait() directly, the temporal
+ * decoupling of the initiator is controlled by the \ref quantum_manager and the socket specific quantum
+ * (CCI parameter <socket name>.quantum) without further code in the model.
+ *
  * @tparam BASE_TYPE
  * @tparam TYPES
  */
@@ -62,30 +69,87 @@ public:
     /**
      * register a non-blocking backward path callback function
      *
-     * @param cb the callback function
+     * @param cb the callback function, stored without allocation if it fits into a util::inplace_function
      */
-    void register_nb_transport_bw(std::function<sync_enum_type(transaction_type&, phase_type&, sc_core::sc_time&)> cb) {
-        bw_if.set_transport_function(cb);
+    template <typename F> void register_nb_transport_bw(F&& cb) {
+        bw_if.set_transport_function(bw_transport_if::transport_fct::make(std::forward<F>(cb)));
     }
     /**
      * register an invalidate DMI callback function
      *
-     * @param cb the callback function
+     * @param cb the callback function, stored without allocation if it fits into a util::inplace_function
+     */
+    template <typename F> void register_invalidate_direct_mem_ptr(F&& cb) {
+        bw_if.set_invalidate_direct_mem_function(bw_transport_if::invalidate_dmi_fct::make(std::forward<F>(cb)));
+    }
+    /**
+     * blocking transport using temporal decoupling. If decoupling is enabled the local time offset is annotated and
+     * the calling thread only waits if the quantum is used up or a target requested to synchronize, otherwise the
+     * annotated delay is waited for immediately. Needs to be called from a SC_THREAD.
+     *
+     * If decoupling is disabled but the target hints that the access only annotated its latency (see
+     * quantum_manager::allow_annotation()) the delay is accumulated in the local time as long as the quantum of the
+     * initiator is not used up. The accumulated time is passed as delay to the next access and synchronized as soon
+     * as an access does not give this hint.
+     *
+     * @param trans the transaction
+     */
+    void b_transport_td(transaction_type& trans) {
+        auto& qk = get_quantum_keeper();
+        auto& mgr = quantum_manager::get();
+        if(qk.is_enabled()) {
+            auto delay = qk.get_local_time();
+            (*this)->b_transport(trans, delay);
+            qk.set(delay);
+            if(qk.need_sync() || mgr.take_sync_request())
+                qk.sync();
+        } else {
+            // a hint left by a plain b_transport call does not apply to this access
+            mgr.take_sync_hint();
+            auto delay = qk.get_local_time();
+            (*this)->b_transport(trans, delay);
+            qk.set(delay);
+            if(mgr.take_sync_hint() == quantum_manager::sync_hint::ANNOTATE && !qk.need_sync())
+                return;
+            if(delay > sc_core::SC_ZERO_TIME)
+                qk.sync();
+        }
+    }
+    /**
+     * account for the time spent in the initiator (e.g. executing instructions), see b_transport_td()
+     *
+     * @param t the time to pass
+     */
+    void advance(sc_core::sc_time const& t) { get_quantum_keeper().advance(t); }
+    /**
+     * synchronize the local time of the initiator with the SystemC time
+     */
+    void sync() { get_quantum_keeper().sync(); }
+    /**
+     * get the time of the initiator including its local time offset
+     *
+     * @return the current time
+     */
+    sc_core::sc_time get_current_time() { return get_quantum_keeper().get_current_time(); }
+    /**
+     * get the quantum keeper of this socket, it is created on first use
+     *
+     * @return the quantum keeper
      */
-    void register_invalidate_direct_mem_ptr(std::function<void(sc_dt::uint64, sc_dt::uint64)> cb) {
-        bw_if.set_invalidate_direct_mem_function(cb);
+    quantum_keeper& get_quantum_keeper() {
+        if(!qk)
+            qk.reset(new quantum_keeper(this->name()));
+        return *qk;
     }
 
 private:
     class bw_transport_if : public tlm::tlm_bw_transport_if<TYPES> {
     public:
-        using transport_fct = std::function<sync_enum_type(transaction_type&, phase_type&, sc_core::sc_time&)>;
-        using invalidate_dmi_fct = std::function<void(sc_dt::uint64, sc_dt::uint64)>;
+        using transport_fct = util::inplace_function<sync_enum_type(transaction_type&, phase_type&, sc_core::sc_time&)>;
+        using invalidate_dmi_fct = util::inplace_function<void(sc_dt::uint64, sc_dt::uint64)>;
 
         bw_transport_if(const std::string& name)
-        : m_name(name)
-        , m_transport_ptr(0)
-        , m_invalidate_direct_mem_ptr(0) {}
+        : m_name(name) {}
 
         void set_transport_function(transport_fct p) {
             if(m_transport_ptr) {
@@ -93,7 +157,7 @@ private:
                 s << m_name << ": non-blocking callback allready registered";
                 SC_REPORT_WARNING("/OSCI_TLM-2/simple_socket", s.str().c_str());
             } else {
-                m_transport_ptr = p;
+                m_transport_ptr = std::move(p);
             }
         }
 
@@ -103,7 +167,7 @@ private:
                 s << m_name << ": invalidate DMI callback allready registered";
                 SC_REPORT_WARNING("/OSCI_TLM-2/simple_socket", s.str().c_str());
             } else {
-                m_invalidate_direct_mem_ptr = p;
+                m_invalidate_direct_mem_ptr = std::move(p);
             }
         }
 
@@ -129,6 +193,7 @@ private:
 
 private:
     bw_transport_if bw_if;
+    std::unique_ptr<quantum_keeper> qk;
 };
 } // namespace scc
 } // namespace tlm
@@ -25,9 +25,11 @@
 #include <tlm/scc/tlm_mm.h>
 #include <tlm/scc/tlm_gp_shared.h>
 #include <sysc/kernel/sc_dynamic_processes.h>
+#include <scc/cached_cci_param.h>
 #include <scc/peq.h>
 #include <tlm/scc/lwtr/lwtr4tlm2_extension_registry.h>
-#include <unordered_map>
+#include <util/open_addressing_map.h>
+#include <util/pool_allocator.h>
 
 //! @brief LWTR components for TLM2
 namespace tlm {
@@ -47,10 +49,21 @@ enum tx_rel {
 	PREDECESSOR_SUCCESSOR /*!< indicates predecessor successor relationship */
 };
 
+/*! \brief the extension linking the recorded phases of a transaction
+ *
+ * A copy is cloned for each phase recorded with timing, hence the extensions are allocated from a pool using
+ * create() and are returned to it by free().
+ */
 struct link_pred_ext : public tlm::tlm_extension<link_pred_ext> {
+	static link_pred_ext* create(tx_handle handle, void const* creator) {
+		return new(util::pool_allocator<sizeof(link_pred_ext)>::get().allocate(0, false)) link_pred_ext(handle, creator);
+	}
 	tlm_extension_base* clone() const override {
-		link_pred_ext* t = new link_pred_ext(this->txHandle, this->creator);
-		return t;
+		return create(this->txHandle, this->creator);
+	}
+	void free() override {
+		this->~link_pred_ext();
+		util::pool_allocator<sizeof(link_pred_ext)>::get().free(this);
 	}
 	void copy_from(tlm_extension_base const& from) override {
 		txHandle = static_cast<link_pred_ext const&>(from).txHandle;
@@ -80,16 +93,16 @@ template <typename TYPES = tlm::tlm_base_protocol_types>
 class tlm2_lwtr : public virtual tlm::tlm_fw_transport_if<TYPES>, public virtual tlm::tlm_bw_transport_if<TYPES> {
 public:
 	//! \brief the attribute to selectively enable/disable recording of blocking protocol tx
-	cci::cci_param<bool> enableBlTracing;
+	::scc::cached_cci_param<bool> enableBlTracing;
 
 	//! \brief the attribute to selectively enable/disable recording of non-blocking protocol tx
-	cci::cci_param<bool> enableNbTracing;
+	::scc::cached_cci_param<bool> enableNbTracing;
 
 	//! \brief the attribute to selectively enable/disable timed recording
-	cci::cci_param<bool> enableTimedTracing{"enableTimedTracing", true};
+	::scc::cached_cci_param<bool> enableTimedTracing{"enableTimedTracing", true};
 
 	//! \brief the attribute to selectively enable/disable DMI recording
-	cci::cci_param<bool> enableDmiTracing{"enableDmiTracing", false};
+	::scc::cached_cci_param<bool> enableDmiTracing{"enableDmiTracing", false};
 
 	/**
 	 * @fn  tlm2_lwtr(bool=true, tr_db*=tr_db::get_default_db())
@@ -258,8 +271,10 @@ private:
 	std::array<tx_generator<std::string, std::string>*, 2> nb_trHandle{{nullptr, nullptr}};
 	//! transaction generator handle for non-blocking transactions with annotated delays
 	std::array<tx_generator<>*, 2> nb_trTimedHandle{{nullptr, nullptr}};
-	std::unordered_map<uint64_t, tx_handle> nbtx_req_handle_map;
-	std::unordered_map<uint64_t, tx_handle> nbtx_last_req_handle_map;
+	//! the open timed request/response keyed by the payload address
+	util::open_addressing_map<uintptr_t, tx_handle> nbtx_req_handle_map;
+	//! the last timed request keyed by the payload address to link the response to it
+	util::open_addressing_map<uintptr_t, tx_handle> nbtx_last_req_handle_map;
 
 	//! dmi transaction recording stream handle
 	tx_fiber* dmi_streamHandle{nullptr};
@@ -355,18 +370,17 @@ void tlm2_lwtr<TYPES>::b_transport(typename TYPES::tlm_payload_type& trans, sc_c
 	if(b_streamHandleTimed)
 		htim = b_trTimedHandle[trans.get_command()]->begin_tx_delayed(sc_core::sc_time_stamp()+delay, par_chld_hndl, h);
 
-	if(registered)
-		for(auto& extensionRecording : lwtr4tlm2_extension_registry<TYPES>::inst().get())
-			if(extensionRecording) {
-				extensionRecording->recordBeginTx(h, trans);
-				if(htim.is_valid())
-					extensionRecording->recordBeginTx(htim, trans);
-			}
+	if(registered) {
+		auto& reg = lwtr4tlm2_extension_registry<TYPES>::inst();
+		reg.recordBeginTx(h, trans);
+		if(htim.is_valid())
+			reg.recordBeginTx(htim, trans);
+	}
 	link_pred_ext* preExt = nullptr;
 
 	trans.get_extension(preExt);
 	if(preExt == nullptr) { // we are the first recording this transaction
-		preExt = new link_pred_ext(h, this);
+		preExt = link_pred_ext::create(h, this);
 		if(trans.has_mm())
 			trans.set_auto_extension(preExt);
 		else
@@ -381,20 +395,17 @@ void tlm2_lwtr<TYPES>::b_transport(typename TYPES::tlm_payload_type& trans, sc_c
 	if(preExt->creator == this) {
 		// clean-up the extension if this is the original creator
 		trans.set_extension(static_cast<link_pred_ext*>(nullptr));
-		if(!trans.has_mm()) {
-			delete preExt;
-		}
+		preExt->free();
 	} else {
 		preExt->txHandle = preTx;
 	}
 	h.record_attribute("trans", trans);
-	if(registered)
-		for(auto& extensionRecording : lwtr4tlm2_extension_registry<TYPES>::inst().get())
-			if(extensionRecording) {
-				extensionRecording->recordEndTx(h, trans);
-				if(htim.is_active())
-					extensionRecording->recordEndTx(htim, trans);
-			}
+	if(registered) {
+		auto& reg = lwtr4tlm2_extension_registry<TYPES>::inst();
+		reg.recordEndTx(h, trans);
+		if(htim.is_active())
+			reg.recordEndTx(htim, trans);
+	}
 	// End the transaction
 	h.end_tx(delay);
 	// and now the stuff for the timed tx
@@ -418,7 +429,7 @@ tlm::tlm_sync_enum tlm2_lwtr<TYPES>::nb_transport_fw(typename TYPES::tlm_payload
 	link_pred_ext* preExt = nullptr;
 	trans.get_extension(preExt);
 	if(preExt == nullptr) { // we are the first recording this transaction
-		preExt = new link_pred_ext(h, this);
+		preExt = link_pred_ext::create(h, this);
 		if(trans.has_mm())
 			trans.set_auto_extension(preExt);
 		else
@@ -431,9 +442,7 @@ tlm::tlm_sync_enum tlm2_lwtr<TYPES>::nb_transport_fw(typename TYPES::tlm_payload
 	preExt->txHandle = h;
 	h.record_attribute("delay", delay);
 	if(registered)
-		for(auto& extensionRecording : lwtr4tlm2_extension_registry<TYPES>::inst().get())
-			if(extensionRecording)
-				extensionRecording->recordBeginTx(h, trans);
+		lwtr4tlm2_extension_registry<TYPES>::inst().recordBeginTx(h, trans);
 	/*************************************************************************
 	 * do the timed notification
 	 *************************************************************************/
@@ -453,17 +462,13 @@ tlm::tlm_sync_enum tlm2_lwtr<TYPES>::nb_transport_fw(typename TYPES::tlm_payload
 	h.record_attribute("delay[return_path]", delay);
 	h.record_attribute("trans", trans);
 	if(registered)
-		for(auto& extensionRecording : lwtr4tlm2_extension_registry<TYPES>::inst().get())
-			if(extensionRecording)
-				extensionRecording->recordEndTx(h, trans);
+		lwtr4tlm2_extension_registry<TYPES>::inst().recordEndTx(h, trans);
 	// get the extension and free the memory if it was mine
 	if(status == tlm::TLM_COMPLETED || (status == tlm::TLM_ACCEPTED && phase == tlm::END_RESP)) {
 		trans.get_extension(preExt);
 		if(preExt && preExt->creator == this) {
 			trans.set_extension(static_cast<link_pred_ext*>(nullptr));
-			if(!trans.has_mm()) {
-				delete preExt;
-			}
+			preExt->free();
 		}
 		/*************************************************************************
 		 * do the timed notification if req. finished here
@@ -504,9 +509,7 @@ tlm::tlm_sync_enum tlm2_lwtr<TYPES>::nb_transport_bw(typename TYPES::tlm_payload
 	}
 	// and set the extension handle to this transaction
 	h.record_attribute("delay", delay);
-	for(auto& extensionRecording : lwtr4tlm2_extension_registry<TYPES>::inst().get())
-		if(extensionRecording)
-			extensionRecording->recordBeginTx(h, trans);
+	lwtr4tlm2_extension_registry<TYPES>::inst().recordBeginTx(h, trans);
 	/*************************************************************************
 	 * do the timed notification
 	 *************************************************************************/
@@ -526,9 +529,7 @@ tlm::tlm_sync_enum tlm2_lwtr<TYPES>::nb_transport_bw(typename TYPES::tlm_payload
 	h.record_attribute("delay[return_path]", delay);
 	h.record_attribute("trans", trans);
 	if(registered)
-		for(auto& extensionRecording : lwtr4tlm2_extension_registry<TYPES>::inst().get())
-			if(extensionRecording)
-				extensionRecording->recordEndTx(h, trans);
+		lwtr4tlm2_extension_registry<TYPES>::inst().recordEndTx(h, trans);
 	// End the transaction
 	nb_trHandle[BW]->end_tx(h, phase2string(phase));
     // get the extension and free the memory if it was mine
@@ -537,9 +538,7 @@ tlm::tlm_sync_enum tlm2_lwtr<TYPES>::nb_transport_bw(typename TYPES::tlm_payload
 		if(preExt && preExt->creator == this) {
 			// clean-up the extension if this is the original creator
 			trans.set_extension(static_cast<link_pred_ext*>(nullptr));
-			if(!trans.has_mm()) {
-				delete preExt;
-			}
+			preExt->free();
 		}
 		/*************************************************************************
 		 * do the timed notification if req. finished here
@@ -555,49 +554,36 @@ tlm::tlm_sync_enum tlm2_lwtr<TYPES>::nb_transport_bw(typename TYPES::tlm_payload
 
 template <typename TYPES>
 void tlm2_lwtr<TYPES>::nbtx_cb() {
-	auto opt = nb_timed_peq.get_next();
-	if(opt) {
-		auto& e = opt.get();
+	// record all phases being due in this delta cycle at once
+	nb_timed_peq.drain([this](nb_rec_entry&& e) {
 		tx_handle h;
 		switch(e.ph) { // Now process outstanding recordings
 		case tlm::BEGIN_REQ:
-			h = nb_trTimedHandle[REQ]->begin_tx(par_chld_hndl, e.parent);
-			nbtx_req_handle_map[e.id] = h;
+			nbtx_req_handle_map[e.id] = nb_trTimedHandle[REQ]->begin_tx(par_chld_hndl, e.parent);
 			break;
 		case tlm::END_REQ: {
-			auto it = nbtx_req_handle_map.find(e.id);
-			sc_assert(it != nbtx_req_handle_map.end());
-			h = it->second;
-			nbtx_req_handle_map.erase(it);
+			auto found = nbtx_req_handle_map.take(e.id, h);
+			sc_assert(found);
 			h.record_attribute("trans", *e.tr);
 			h.end_tx();
 			nbtx_last_req_handle_map[e.id] = h;
 			}
 			break;
 		case tlm::BEGIN_RESP: {
-			auto it = nbtx_req_handle_map.find(e.id);
-			if(it != nbtx_req_handle_map.end()) {
-				h = it->second;
-				nbtx_req_handle_map.erase(it);
+			if(nbtx_req_handle_map.take(e.id, h)) {
 				h.record_attribute("trans", *e.tr);
 				h.end_tx();
 				nbtx_last_req_handle_map[e.id] = h;
 			}
 			h = nb_trTimedHandle[RESP]->begin_tx(par_chld_hndl, e.parent);
 			nbtx_req_handle_map[e.id] = h;
-			it = nbtx_last_req_handle_map.find(e.id);
-			if(it != nbtx_last_req_handle_map.end()) {
-				tx_handle pred = it->second;
-				nbtx_last_req_handle_map.erase(it);
+			tx_handle pred;
+			if(nbtx_last_req_handle_map.take(e.id, pred))
 				h.add_relation(pred_succ_hndl, pred);
 			}
-			}
 			break;
 		case tlm::END_RESP: {
-			auto it = nbtx_req_handle_map.find(e.id);
-			if(it != nbtx_req_handle_map.end()) {
-				h = it->second;
-				nbtx_req_handle_map.erase(it);
+			if(nbtx_req_handle_map.take(e.id, h)) {
 				h.record_attribute("trans", *e.tr);
 				h.end_tx();
 			}
@@ -607,8 +593,7 @@ void tlm2_lwtr<TYPES>::nbtx_cb() {
 			// sc_assert(!"phase not supported!");
 			break;
 		}
-	}
-    return;
+	});
 }
 
 template <typename TYPES>
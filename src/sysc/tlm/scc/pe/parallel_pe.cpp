@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2020-2022 MINRES Technologies GmbH
+ * Copyright 2020-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,6 +18,7 @@
 #define SC_INCLUDE_DYNAMIC_PROCESSES
 #endif
 #include "parallel_pe.h"
+#include <algorithm>
 
 namespace tlm {
 namespace scc {
@@ -32,35 +33,57 @@ parallel_pe::parallel_pe(sc_core::sc_module_name const& nm)
 parallel_pe::~parallel_pe() = default;
 
 void parallel_pe::transport(tlm::tlm_generic_payload& payload, bool lt_transport) {
-    if(!waiting_ids.size()) {
-        auto id = threads.size();
-        threads.resize(threads.size() + 1);
-        thread_unit& tu = threads.back();
-        tu.hndl = sc_core::sc_spawn(
-            [this, id]() -> void {
-                auto& tu = threads[id];
-                while(true) {
-                    fw_o->transport(*tu.gp, tu.lt_transport);
-                    bw_o->transport(*tu.gp);
-                    if(tu.gp->has_mm())
-                        tu.gp->release();
-                    tu.gp = nullptr;
-                    waiting_ids.push_back(id);
-                    wait(tu.evt);
-                    assert(tu.gp);
-                }
-            },
-            sc_core::sc_gen_unique_name("execute"));
-        tu.gp = &payload;
-    } else {
+    if(waiting_ids.size()) {
         auto& tu = threads[waiting_ids.front()];
         waiting_ids.pop_front();
-        tu.gp = &payload;
+        tu.gp = tlm_gp_unique_ptr(&payload);
         tu.lt_transport = lt_transport;
         tu.evt.notify();
+        started();
+    } else if(!max_concurrency.get_value() || threads.size() < max_concurrency.get_value()) {
+        spawn(payload, lt_transport);
+        started();
+    } else {
+        pending.emplace_back(tlm_gp_unique_ptr(&payload), lt_transport);
+        peak_queued = std::max(peak_queued, pending.size());
     }
-    if(payload.has_mm())
-        payload.acquire();
+}
+
+void parallel_pe::started() {
+    ++active;
+    peak_active = std::max(peak_active, active);
+}
+
+void parallel_pe::spawn(tlm::tlm_generic_payload& payload, bool lt_transport) {
+    auto id = threads.size();
+    threads.emplace_back();
+    thread_unit& tu = threads.back();
+    tu.gp = tlm_gp_unique_ptr(&payload);
+    tu.lt_transport = lt_transport;
+    sc_core::sc_spawn_options opts;
+    if(thread_stack_size.get_value())
+        opts.set_stack_size(thread_stack_size.get_value());
+    tu.hndl = sc_core::sc_spawn(
+        [this, id]() -> void {
+            auto& tu = threads[id];
+            while(true) {
+                fw_o->transport(*tu.gp, tu.lt_transport);
+                bw_o->transport(*tu.gp);
+                if(pending.size()) {
+                    // take over the next queued transaction instead of going idle
+                    tu.gp = std::move(pending.front().first);
+                    tu.lt_transport = pending.front().second;
+                    pending.pop_front();
+                    continue;
+                }
+                tu.gp.reset();
+                --active;
+                waiting_ids.push_back(id);
+                wait(tu.evt);
+                assert(tu.gp);
+            }
+        },
+        sc_core::sc_gen_unique_name("execute"), &opts);
 }
 
 } /* namespace pe */
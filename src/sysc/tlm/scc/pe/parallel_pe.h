@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2020-2022 MINRES Technologies GmbH
+ * Copyright 2020-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,8 +18,10 @@
 #define _TLM_SCC_PE_PARALLEL_PE_H_
 
 #include "intor_if.h"
+#include <cci_configuration>
 #include <deque>
 #include <tlm>
+#include <tlm/scc/tlm_gp_shared.h>
 //! @brief SystemC TLM
 namespace tlm {
 //! @brief SCC TLM utilities
@@ -27,17 +29,19 @@ namespace scc {
 //! @brief SCC protocol engines
 namespace pe {
 
+/**
+ * @class parallel_pe
+ * @brief a protocol engine executing each incoming transaction in a thread of its own
+ *
+ * The threads are reused once their transaction is finished. If max_concurrency is set and all threads are busy
+ * incoming transactions are queued and taken in arrival order by the next thread becoming free.
+ */
 class parallel_pe : public sc_core::sc_module, public intor_fw_nb {
     struct thread_unit {
         sc_core::sc_event evt;
-        tlm::tlm_generic_payload* gp{nullptr};
+        tlm_gp_unique_ptr gp;
         bool lt_transport{false};
         sc_core::sc_process_handle hndl{};
-        thread_unit(const thread_unit& o)
-        : gp(o.gp)
-        , lt_transport(o.lt_transport)
-        , hndl(o.hndl) {}
-        thread_unit() = default;
     };
 
 public:
@@ -47,17 +51,39 @@ public:
 
     sc_core::sc_port<intor_fw_b> fw_o{"fw_o"};
 
+    //! the maximum number of transactions being executed concurrently, 0 means unbounded
+    cci::cci_param<unsigned> max_concurrency{"max_concurrency", 0};
+    //! the stack size of the spawned threads, 0 means the kernel default
+    cci::cci_param<size_t> thread_stack_size{"thread_stack_size", 0};
+
     parallel_pe(sc_core::sc_module_name const& nm);
 
     virtual ~parallel_pe();
+    //! get the number of transactions being executed currently
+    unsigned get_concurrency() const { return active; }
+    //! get the maximum number of transactions having been executed concurrently
+    unsigned get_peak_concurrency() const { return peak_active; }
+    //! get the maximum number of transactions having waited for a free thread
+    size_t get_peak_queue_length() const { return peak_queued; }
+    //! get the number of threads spawned so far
+    size_t get_thread_count() const { return threads.size(); }
 
 private:
     void transport(tlm::tlm_generic_payload& payload, bool lt_transport = false) override;
 
     void snoop_resp(tlm::tlm_generic_payload& payload, bool sync) override { fw_o->snoop_resp(payload, sync); }
 
+    void spawn(tlm::tlm_generic_payload& payload, bool lt_transport);
+
+    void started();
+
     std::deque<unsigned> waiting_ids;
-    std::vector<thread_unit> threads;
+    //! the transactions waiting for a free thread
+    std::deque<std::pair<tlm_gp_unique_ptr, bool>> pending;
+    unsigned active{0}, peak_active{0};
+    size_t peak_queued{0};
+    //! a deque keeps the references to the thread units stable when adding new ones
+    std::deque<thread_unit> threads;
 };
 
 } /* namespace pe */
@@ -0,0 +1,151 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _TLM_SCC_QUANTUM_KEEPER_H_
+#define _TLM_SCC_QUANTUM_KEEPER_H_
+
+#include <cci_configuration>
+#include <cstdint>
+#include <scc/cached_cci_param.h>
+#include <string>
+#include <tlm>
+#include <tlm_utils/tlm_quantumkeeper.h>
+
+//! @brief SystemC TLM
+namespace tlm {
+//! @brief SCC TLM utilities
+namespace scc {
+/**
+ * @class quantum_manager
+ * @brief the global settings of the temporal decoupling used by \ref quantum_keeper
+ *
+ * The settings are CCI parameters with absolute names:
+ * - scc_quantum_manager.enable switches temporal decoupling on (default off)
+ * - scc_quantum_manager.global_quantum is the quantum if not set per initiator. If it is 0 (the default) the
+ *   quantum of tlm_utils::tlm_global_quantum is used.
+ *
+ * Targets may request the initiator currently calling b_transport to synchronize after the call by calling
+ * request_sync(). Targets whose accesses only annotate their latency (e.g. side effect free register accesses) may
+ * call allow_annotation() instead, this lets initiator_mixin::b_transport_td() accumulate the delay in the local
+ * time of the initiator until its quantum is used up even if temporal decoupling is disabled.
+ */
+class quantum_manager {
+public:
+    //! the synchronization hints of a target, a stronger hint overrides a weaker one
+    enum class sync_hint : uint8_t {
+        NONE,     //!< no hint given
+        ANNOTATE, //!< the access only annotated its latency, no synchronization is needed
+        SYNC      //!< the initiator needs to synchronize after the access
+    };
+    //! the singleton getter
+    static quantum_manager& get() {
+        static quantum_manager inst;
+        return inst;
+    }
+    //! true if temporal decoupling is enabled
+    bool is_enabled() const { return enable.get_value(); }
+    //! get the global quantum
+    sc_core::sc_time get_global_quantum() const {
+        auto q = global_quantum.get_value();
+        return q > sc_core::SC_ZERO_TIME ? q : tlm_utils::tlm_global_quantum::instance().get();
+    }
+    //! request the initiator in the current b_transport call to synchronize
+    void request_sync() { hint = sync_hint::SYNC; }
+    //! tell the initiator in the current b_transport call that the access does not need a synchronization
+    void allow_annotation() { set_sync_hint(sync_hint::ANNOTATE); }
+    //! give a hint to the initiator in the current b_transport call, weaker hints than the pending one are ignored
+    void set_sync_hint(sync_hint h) {
+        if(h > hint)
+            hint = h;
+    }
+    //! get and clear the pending hint
+    sync_hint take_sync_hint() {
+        auto ret = hint;
+        hint = sync_hint::NONE;
+        return ret;
+    }
+    //! check and clear a pending synchronization request
+    bool take_sync_request() { return take_sync_hint() == sync_hint::SYNC; }
+
+    ::scc::cached_cci_param<bool> enable{"scc_quantum_manager.enable", false,
+                                         "enable temporal decoupling of initiators", cci::CCI_ABSOLUTE_NAME,
+                                         cci::cci_originator("scc_quantum_manager")};
+
+    ::scc::cached_cci_param<sc_core::sc_time> global_quantum{
+        "scc_quantum_manager.global_quantum", sc_core::SC_ZERO_TIME,
+        "quantum of initiators not having a quantum of their own", cci::CCI_ABSOLUTE_NAME,
+        cci::cci_originator("scc_quantum_manager")};
+
+private:
+    quantum_manager() = default;
+    sync_hint hint{sync_hint::NONE};
+};
+/**
+ * @class quantum_keeper
+ * @brief a quantum keeper of an initiator using the settings of the \ref quantum_manager
+ *
+ * The quantum of the initiator can be set using the CCI parameter <name>.quantum, if it is 0 (the default) the
+ * global quantum applies.
+ */
+class quantum_keeper : public tlm_utils::tlm_quantumkeeper {
+public:
+    /**
+     * @brief constructor
+     *
+     * @param name the hierarchical name of the initiator
+     */
+    explicit quantum_keeper(std::string const& name)
+    : quantum{name + ".quantum", sc_core::SC_ZERO_TIME, "the quantum of this initiator", cci::CCI_ABSOLUTE_NAME,
+              cci::cci_originator(name)} {
+        reset();
+    }
+    //! true if temporal decoupling is enabled
+    bool is_enabled() const { return quantum_manager::get().is_enabled(); }
+    /**
+     * @brief account for time having passed, synchronizes if the quantum is used up or if decoupling is disabled
+     *
+     * @param t the time to add to the local time
+     */
+    void advance(sc_core::sc_time const& t) {
+        if(!is_enabled()) {
+            if(get_local_time() > sc_core::SC_ZERO_TIME)
+                sync();
+            sc_core::wait(t);
+            return;
+        }
+        inc(t);
+        if(need_sync() || quantum_manager::get().take_sync_request())
+            sync();
+    }
+
+protected:
+    sc_core::sc_time compute_local_quantum() override {
+        auto q = quantum.get_value() > sc_core::SC_ZERO_TIME ? quantum.get_value()
+                                                             : quantum_manager::get().get_global_quantum();
+        if(q == sc_core::SC_ZERO_TIME)
+            return sc_core::SC_ZERO_TIME;
+        // the time to the next quantum boundary
+        auto now = sc_core::sc_time_stamp();
+        auto rem = sc_core::sc_time::from_value(now.value() % q.value());
+        return q - rem;
+    }
+
+    ::scc::cached_cci_param<sc_core::sc_time> quantum;
+};
+} // namespace scc
+} // namespace tlm
+
+#endif /* _TLM_SCC_QUANTUM_KEEPER_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2020 MINRES Technologies GmbH
+ * Copyright 2016-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -72,6 +72,12 @@ public:
         return reg;
     }
 
+    /**
+     * register the recorder of an extension, it is only called for payloads carrying the extension with this id
+     *
+     * @param id the id of the extension
+     * @param ext the recorder, the registry takes ownership
+     */
     void register_ext_rec(size_t id, tlm_extensions_recording_if<TYPES>* ext) {
         if(id == 0)
             return;
@@ -79,11 +85,30 @@ public:
             ext_rec.resize(id + 1);
         if(ext_rec[id])
             delete ext_rec[id];
+        else
+            ids.push_back(static_cast<unsigned>(id));
         ext_rec[id] = ext;
     }
+    //! register the recorder of the extension type EXT
+    template <typename EXT> void register_ext_rec(tlm_extensions_recording_if<TYPES>* ext) {
+        register_ext_rec(EXT::ID, ext);
+    }
 
     const std::vector<tlm_extensions_recording_if<TYPES>*>& get() { return ext_rec; }
 
+    //! record the extensions the payload carries at the beginning of the transaction
+    inline void recordBeginTx(SCVNS scv_tr_handle& handle, typename TYPES::tlm_payload_type& trans) {
+        for(auto id : ids)
+            if(ext_rec[id] && trans.get_extension(id))
+                ext_rec[id]->recordBeginTx(handle, trans);
+    }
+    //! record the extensions the payload carries at the end of the transaction
+    inline void recordEndTx(SCVNS scv_tr_handle& handle, typename TYPES::tlm_payload_type& trans) {
+        for(auto id : ids)
+            if(ext_rec[id] && trans.get_extension(id))
+                ext_rec[id]->recordEndTx(handle, trans);
+    }
+
     inline void recordBeginTx(size_t id, SCVNS scv_tr_handle& handle, typename TYPES::tlm_payload_type& trans) {
         if(ext_rec.size() > id && ext_rec[id])
             ext_rec[id]->recordBeginTx(handle, trans);
@@ -105,6 +130,8 @@ private:
             delete(ext);
     }
     std::vector<tlm_extensions_recording_if<TYPES>*> ext_rec{};
+    //! the ids having a recorder, avoids walking all extension slots
+    std::vector<unsigned> ids{};
 };
 
 } // namespace scv
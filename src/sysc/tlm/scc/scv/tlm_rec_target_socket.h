@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2017 MINRES Technologies GmbH
+ * Copyright 2016-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,6 +19,7 @@
 
 #include <tlm/scc/scv/tlm_recorder.h>
 #include <tlm>
+#include <type_traits>
 
 //! @brief SystemC TLM
 namespace tlm {
@@ -118,6 +119,21 @@ protected:
     sc_core::sc_port<fw_interface_type> fw_port{sc_core::sc_gen_unique_name("$$$__rec_fw__$$$")};
     scv::tlm_recorder<TYPES> recorder;
 };
+#ifdef SCC_NO_TLM_RECORDING
+//! the default of the recording switch of the SCC interconnect components, set by the CMake option SCC_TLM_RECORDING
+const bool recording_default = false;
+#else
+//! the default of the recording switch of the SCC interconnect components, set by the CMake option SCC_TLM_RECORDING
+const bool recording_default = true;
+#endif
+/**
+ * @brief selects the recording target socket or the plain tlm::tlm_target_socket
+ *
+ * If RECORDING is false the recorder is not even instantiated so that the socket does not add any overhead.
+ */
+template <unsigned int BUSWIDTH = 32, bool RECORDING = recording_default, typename TYPES = tlm::tlm_base_protocol_types>
+using target_socket_select = typename std::conditional<RECORDING, tlm_rec_target_socket<BUSWIDTH, TYPES>,
+                                                       tlm::tlm_target_socket<BUSWIDTH, TYPES>>::type;
 } // namespace scv
 } // namespace scc
 } // namespace tlm
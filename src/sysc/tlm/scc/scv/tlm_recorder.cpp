@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016-2022 MINRES Technologies GmbH
+ * Copyright 2016-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,6 +19,9 @@
 #endif
 #include "tlm_recorder.h"
 #include "tlm_extension_recording_registry.h"
+#include <cstring>
+#include <scc/report.h>
+#include <stdexcept>
 #include <tlm/scc/tlm_id.h>
 
 namespace tlm {
@@ -72,6 +75,63 @@ void record(SCVNS scv_tr_handle& handle, tlm::tlm_dmi& o) {
     handle.record_attribute("trans.write_latency", o.get_write_latency().to_string());
 }
 
+void impl::recording_policy::configure(unsigned sample_rate, uint64_t max_count, bool errors_only,
+                                       std::string const& ranges) {
+    this->sample_rate = sample_rate;
+    this->max_count = max_count;
+    this->errors_only = errors_only;
+    this->ranges.clear();
+    std::istringstream is(ranges);
+    std::string range;
+    while(std::getline(is, range, ',')) {
+        if(range.find_first_not_of(" \t") == std::string::npos)
+            continue;
+        auto pos = range.find('-');
+        try {
+            if(pos == std::string::npos)
+                throw std::invalid_argument(range);
+            this->ranges.emplace_back(std::stoull(range.substr(0, pos), nullptr, 0),
+                                      std::stoull(range.substr(pos + 1), nullptr, 0));
+        } catch(std::exception&) {
+            SCCWARN("tlm_recorder") << "ignoring malformed address range '" << range << "' in " << ranges;
+        }
+    }
+    active = sample_rate > 1 || max_count || errors_only || !this->ranges.empty();
+}
+
+uint64_t impl::dmi_region::sample() {
+    auto size = end - start + 1;
+    auto pages = (size + page_size - 1) / page_size;
+    bool baseline = page_hashes.size() != pages;
+    if(baseline)
+        page_hashes.assign(pages, 0);
+    uint64_t changed = 0;
+    for(uint64_t i = 0; i < pages; ++i) {
+        auto* p = ptr + i * page_size;
+        auto len = size - i * page_size;
+        if(len > page_size)
+            len = page_size;
+        // FNV-1a over 64bit words, the tail is hashed bytewise
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        uint64_t word;
+        size_t j = 0;
+        for(; j + sizeof(word) <= len; j += sizeof(word)) {
+            std::memcpy(&word, p + j, sizeof(word));
+            hash = (hash ^ word) * 0x100000001b3ULL;
+        }
+        for(; j < len; ++j)
+            hash = (hash ^ p[j]) * 0x100000001b3ULL;
+        if(hash != page_hashes[i]) {
+            page_hashes[i] = hash;
+            ++changed;
+        }
+    }
+    if(baseline)
+        return 0;
+    written_pages += changed;
+    return changed;
+}
+
 class tlm_id_ext_recording : public tlm_extensions_recording_if<tlm::tlm_base_protocol_types> {
 
     void recordBeginTx(SCVNS scv_tr_handle& handle, tlm::tlm_base_protocol_types::tlm_payload_type& trans) override {
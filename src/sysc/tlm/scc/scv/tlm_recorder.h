@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016-2022 MINRES Technologies GmbH
+ * Copyright 2016-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -19,8 +19,12 @@
 
 #include "tlm_extension_recording_registry.h"
 #include "tlm_recording_extension.h"
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <regex>
+#include <scc/counters.h>
+#include <scc/span_tracer.h>
 #include <sstream>
 #include <string>
 #include <tlm/scc/tlm_mm.h>
@@ -28,6 +32,8 @@
 #include <sysc/kernel/sc_dynamic_processes.h>
 #include <tlm_utils/peq_with_cb_and_phase.h>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 //! @brief SystemC TLM
 namespace tlm {
@@ -68,6 +74,83 @@ template <typename TYPES = tlm::tlm_base_protocol_types> struct tlm_recording_ty
     using tlm_phase_type = typename TYPES::tlm_phase_type;
 };
 
+/**
+ * @brief the decision which transactions of a recorder get recorded
+ *
+ * The checks are cheap and done before any transaction handle is created so filtered transactions cost nearly
+ * nothing.
+ */
+struct recording_policy {
+    //! record only every n-th transaction
+    unsigned sample_rate{1};
+    //! stop recording after this number of transactions, 0 means unlimited
+    uint64_t max_count{0};
+    //! record only transactions with an error response
+    bool errors_only{false};
+    //! the inclusive address ranges of interest, empty means all addresses
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    /**
+     * @brief set the policy
+     *
+     * @param sample_rate record 1 in sample_rate transaction
+     * @param max_count the maximum number of transactions to record, 0 means unlimited
+     * @param errors_only record only transactions having an error response
+     * @param ranges a comma separated list of inclusive address ranges 'start-end', e.g. '0x1000-0x1fff,0x8000-0x80ff'
+     */
+    void configure(unsigned sample_rate, uint64_t max_count, bool errors_only, std::string const& ranges);
+    //! true if any filter is set
+    bool is_active() const { return active; }
+    //! check the transaction at its start, errors_only is not checked here as the response is not known yet
+    bool admit(uint64_t addr) {
+        if(max_count && recorded >= max_count)
+            return false;
+        if(!ranges.empty() && !in_range(addr))
+            return false;
+        return sample_rate < 2 || (seen++ % sample_rate) == 0;
+    }
+    //! count a transaction being recorded
+    void count() { ++recorded; }
+
+private:
+    bool in_range(uint64_t addr) const {
+        for(auto& r : ranges)
+            if(addr >= r.first && addr <= r.second)
+                return true;
+        return false;
+    }
+    bool active{false};
+    uint64_t seen{0};
+    uint64_t recorded{0};
+};
+/**
+ * @brief a DMI region granted through a recorder
+ *
+ * Accesses using the DMI pointer are not visible to the recorder, hence the usage of writable regions is sampled by
+ * detecting the pages whose content changed since the last sample.
+ */
+struct dmi_region {
+    //! the page size used to detect written memory
+    static const uint64_t page_size = 4096;
+    uint64_t start{0};
+    uint64_t end{0};
+    unsigned char* ptr{nullptr};
+    bool writable{false};
+    //! the number of times the region was granted
+    uint64_t grants{0};
+    //! the number of written pages seen by all samples
+    uint64_t written_pages{0};
+    std::vector<uint64_t> page_hashes;
+    //! the transaction spanning the lifetime of the region
+    SCVNS scv_tr_handle tx;
+    //! check if the region intersects the inclusive range
+    bool overlaps(uint64_t start_addr, uint64_t end_addr) const { return start <= end_addr && start_addr <= end; }
+    /**
+     * @brief hash the pages of the region
+     *
+     * @return the number of pages changed since the last call, the first call only takes the baseline
+     */
+    uint64_t sample();
+};
 } // namespace impl
 /*! \brief The TLM2 transaction recorder
  *
@@ -102,6 +185,23 @@ public:
     //! \brief the attribute to selectively enable/disable DMI recording
     sc_core::sc_attribute<bool> enableDmiTracing{"enableDmiTracing", false};
 
+    //! \brief the attribute to set the period in ns of sampling the writes into the granted DMI regions, 0 disables
+    //! the sampling. Each sample hashes the writable regions so the period should be coarse for large memories.
+    sc_core::sc_attribute<unsigned long long> dmiSamplePeriod{"dmiSamplePeriod", 0};
+
+    //! \brief the attribute to record only 1 in N blocking and non-blocking transactions
+    sc_core::sc_attribute<unsigned> recordSampleRate{"recordSampleRate", 1};
+
+    //! \brief the attribute to limit the number of recorded transactions, 0 means unlimited
+    sc_core::sc_attribute<unsigned long long> recordMaxCount{"recordMaxCount", 0};
+
+    //! \brief the attribute to record only transactions with an error response
+    sc_core::sc_attribute<bool> recordErrorsOnly{"recordErrorsOnly", false};
+
+    //! \brief the attribute to record only transactions starting in the given address ranges, a comma separated list
+    //! of inclusive ranges like '0x1000-0x1fff', empty means all addresses
+    sc_core::sc_attribute<std::string> recordAddressRanges{"recordAddressRanges", ""};
+
     //! \brief the port where fw accesses are forwarded to
     sc_core::sc_port_b<tlm::tlm_fw_transport_if<TYPES>>& fw_port;
 
@@ -170,6 +270,8 @@ public:
         delete dmi_streamHandle;
         delete dmi_trGetHandle;
         delete dmi_trInvalidateHandle;
+        delete dmi_trRegionHandle;
+        delete dmi_trUsageHandle;
     }
 
     // TLM-2.0 interface methods for initiator and target sockets, surrounded with
@@ -209,7 +311,9 @@ public:
     void b_transport(typename TYPES::tlm_payload_type& trans, sc_core::sc_time& delay) override;
     /*! \brief The direct memory interface forward function
      *
-     * This type of transaction is just forwarded and not recorded.
+     * The request is recorded as "get" transaction. A granted region is recorded as "region" transaction lasting until
+     * the region is invalidated and, if dmiSamplePeriod is set, its writes are sampled as "usage" transactions. The
+     * DMI grant itself is never changed.
      * \param trans is the generic payload of the transaction
      * \param dmi_data is the structure holding the dmi information
      * \return if the dmi structure is valid
@@ -217,7 +321,7 @@ public:
     bool get_direct_mem_ptr(typename TYPES::tlm_payload_type& trans, tlm::tlm_dmi& dmi_data) override;
     /*! \brief The direct memory interface backward function
      *
-     * This type of transaction is just forwarded and not recorded.
+     * The invalidation is recorded and ends the "region" transactions of the regions being invalidated.
      * \param start_addr is the start address of the memory area being invalid
      * \param end_addr is the end address of the memory area being invalid
      */
@@ -257,6 +361,27 @@ private:
      * to generate the timed view of non-blocking tx
      */
     void nbtx_cb(tlm_recording_payload& rec_parts, const typename TYPES::tlm_phase_type& phase);
+    /*! \brief record a blocking transaction after it finished if it has an error response
+     */
+    void b_transport_errors_only(typename TYPES::tlm_payload_type& trans, sc_core::sc_time& delay);
+    /*! \brief check if a non-blocking call belongs to a transaction being filtered by the recording policy
+     *
+     * The decision is taken when the request starts. If only errors are recorded the transaction is recorded from
+     * the first call carrying an error response on.
+     */
+    bool is_nb_filtered(typename TYPES::tlm_payload_type& trans, const typename TYPES::tlm_phase_type& phase);
+    //! forget about a filtered non-blocking transaction once it is finished
+    void nb_filter_done(typename TYPES::tlm_payload_type& trans, const typename TYPES::tlm_phase_type& phase,
+                        tlm::tlm_sync_enum status) {
+        if(status == tlm::TLM_COMPLETED || phase == tlm::END_RESP)
+            nb_filtered.erase(reinterpret_cast<uintptr_t>(&trans));
+    }
+    //! the recording policy
+    impl::recording_policy policy;
+    //! the number of recorded blocking transactions, every 64th measures the host time of its recording
+    unsigned b_tx_count{0};
+    //! the non-blocking transactions being filtered, the value is true if they wait for an error response
+    std::unordered_map<uintptr_t, bool> nb_filtered;
     //! transaction recording database
     SCVNS scv_tr_db* m_db{nullptr};
     //! blocking transaction recording stream handle
@@ -287,9 +412,24 @@ private:
     //! transaction generator handle for DMI transactions
     SCVNS scv_tr_generator<>* dmi_trGetHandle{nullptr};
     SCVNS scv_tr_generator<sc_dt::uint64, sc_dt::uint64>* dmi_trInvalidateHandle{nullptr};
+    //! transaction generator handle for the lifetime of the granted DMI regions
+    SCVNS scv_tr_generator<sc_dt::uint64, sc_dt::uint64>* dmi_trRegionHandle{nullptr};
+    //! transaction generator handle for the sampled writes into DMI regions
+    SCVNS scv_tr_generator<sc_dt::uint64, sc_dt::uint64>* dmi_trUsageHandle{nullptr};
+    //! the DMI regions granted and not yet invalidated
+    std::vector<impl::dmi_region> dmi_regions;
+    bool dmi_sampler_started{false};
+    //! record the DMI region being granted
+    void track_dmi_region(tlm::tlm_dmi& dmi_data);
+    //! record the writes into the DMI regions and schedule the next sample
+    void sample_dmi_regions();
+    //! record the writes into one DMI region since the last sample
+    void record_dmi_usage(impl::dmi_region& r);
 
 public:
     void initialize_streams() {
+        policy.configure(recordSampleRate.value, recordMaxCount.value, recordErrorsOnly.value,
+                         recordAddressRanges.value);
         if(isRecordingBlockingTxEnabled() && !b_streamHandle) {
             b_streamHandle = new SCVNS scv_tr_stream((fixed_basename + "_bl").c_str(), "[TLM][base-protocol][b]", m_db);
             b_trHandle[tlm::TLM_READ_COMMAND] = new SCVNS scv_tr_generator<sc_dt::uint64, sc_dt::uint64>(
@@ -326,6 +466,10 @@ public:
             dmi_trGetHandle = new SCVNS scv_tr_generator<>("get", *dmi_streamHandle);
             dmi_trInvalidateHandle = new SCVNS scv_tr_generator<sc_dt::uint64, sc_dt::uint64>(
                 "invalidate", *dmi_streamHandle, "start_addr", "end_addr");
+            dmi_trRegionHandle = new SCVNS scv_tr_generator<sc_dt::uint64, sc_dt::uint64>(
+                "region", *dmi_streamHandle, "start_addr", "grants");
+            dmi_trUsageHandle = new SCVNS scv_tr_generator<sc_dt::uint64, sc_dt::uint64>(
+                "usage", *dmi_streamHandle, "start_addr", "written_pages");
         }
     }
 
@@ -350,23 +494,46 @@ void tlm_recorder<TYPES>::b_transport(typename TYPES::tlm_payload_type& trans, s
         return;
     } else if(!b_streamHandle)
         initialize_streams();
+    SCC_SPAN("recorder.b_transport");
+    if(policy.is_active()) {
+        if(!policy.admit(trans.get_address())) {
+            fw_port->b_transport(trans, delay);
+            return;
+        }
+        if(policy.errors_only) {
+            b_transport_errors_only(trans, delay);
+            return;
+        }
+        policy.count();
+    }
+    // the host time of the recording is sampled for the run report (see scc::run_report)
+    auto const timed = (++b_tx_count & 63) == 0;
+    std::chrono::steady_clock::time_point rec_start;
+    std::chrono::steady_clock::duration rec_time{};
+    if(timed)
+        rec_start = std::chrono::steady_clock::now();
     // Get a handle for the new transaction
     SCVNS scv_tr_handle h = b_trHandle[trans.get_command()]->begin_transaction(delay.value(), sc_core::sc_time_stamp());
     /*************************************************************************
      * do the timed notification
      *************************************************************************/
+    SCVNS scv_tr_handle timed_h;
     if(b_streamHandleTimed) {
-        req = mm::get().allocate();
-        req->acquire();
-        (*req) = trans;
-        req->parent = h;
-        req->id = h.get_id();
-        b_timed_peq.notify(*req, tlm::BEGIN_REQ, delay);
+        if(delay == sc_core::SC_ZERO_TIME) {
+            // the timed transaction starts now, there is no need to defer it
+            timed_h = b_trTimedHandle[trans.get_command()]->begin_transaction();
+            timed_h.add_relation(rel_str(PARENT_CHILD), h);
+        } else {
+            req = mm::get().allocate();
+            req->acquire();
+            (*req) = trans;
+            req->parent = h;
+            req->id = h.get_id();
+            b_timed_peq.notify(*req, tlm::BEGIN_REQ, delay);
+        }
     }
 
-    for(auto& extensionRecording : tlm_extension_recording_registry<TYPES>::inst().get())
-        if(extensionRecording)
-            extensionRecording->recordBeginTx(h, trans);
+    tlm_extension_recording_registry<TYPES>::inst().recordBeginTx(h, trans);
     tlm_recording_extension* preExt = nullptr;
 
     trans.get_extension(preExt);
@@ -381,7 +548,11 @@ void tlm_recorder<TYPES>::b_transport(typename TYPES::tlm_payload_type& trans, s
     }
     SCVNS scv_tr_handle preTx{preExt->txHandle};
     preExt->txHandle = h;
+    if(timed)
+        rec_time = std::chrono::steady_clock::now() - rec_start;
     fw_port->b_transport(trans, delay);
+    if(timed)
+        rec_start = std::chrono::steady_clock::now();
     if(preExt && preExt->get_creator() == this) {
         // clean-up the extension if this is the original creator
         trans.set_extension(static_cast<tlm_recording_extension*>(nullptr));
@@ -392,19 +563,79 @@ void tlm_recorder<TYPES>::b_transport(typename TYPES::tlm_payload_type& trans, s
         preExt->txHandle = preTx;
     }
     record(h, trans);
-    for(auto& extensionRecording : tlm_extension_recording_registry<TYPES>::inst().get())
-        if(extensionRecording)
-            extensionRecording->recordEndTx(h, trans);
+    tlm_extension_recording_registry<TYPES>::inst().recordEndTx(h, trans);
     // End the transaction
     b_trHandle[trans.get_command()]->end_transaction(h, delay.value(), sc_core::sc_time_stamp());
     // and now the stuff for the timed tx
     if(b_streamHandleTimed) {
-        b_timed_peq.notify(*req, tlm::END_RESP, delay);
+        if(req)
+            b_timed_peq.notify(*req, tlm::END_RESP, delay);
+        else if(delay == sc_core::SC_ZERO_TIME) {
+            record(timed_h, trans);
+            timed_h.end_transaction();
+        } else {
+            // the timed transaction started directly but ends in the future
+            req = mm::get().allocate();
+            req->acquire();
+            (*req) = trans;
+            req->parent = h;
+            req->id = h.get_id();
+            btx_handle_map[req->id] = timed_h;
+            b_timed_peq.notify(*req, tlm::END_RESP, delay);
+        }
+    }
+    if(timed) {
+        rec_time += std::chrono::steady_clock::now() - rec_start;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(rec_time).count();
+        SCC_HIST("recorder.tx_ns", static_cast<uint64_t>(ns));
+    }
+}
+
+template <typename TYPES>
+void tlm_recorder<TYPES>::b_transport_errors_only(typename TYPES::tlm_payload_type& trans, sc_core::sc_time& delay) {
+    auto start_delay = delay.value();
+    auto start_time = sc_core::sc_time_stamp();
+    fw_port->b_transport(trans, delay);
+    if(!trans.is_response_error())
+        return;
+    policy.count();
+    SCVNS scv_tr_handle h = b_trHandle[trans.get_command()]->begin_transaction(start_delay, start_time);
+    tlm_recording_extension* preExt = nullptr;
+    trans.get_extension(preExt);
+    if(preExt)
+        h.add_relation(rel_str(PREDECESSOR_SUCCESSOR), preExt->txHandle);
+    record(h, trans);
+    b_trHandle[trans.get_command()]->end_transaction(h, delay.value(), sc_core::sc_time_stamp());
+}
+
+template <typename TYPES>
+bool tlm_recorder<TYPES>::is_nb_filtered(typename TYPES::tlm_payload_type& trans,
+                                         const typename TYPES::tlm_phase_type& phase) {
+    auto id = reinterpret_cast<uintptr_t>(&trans);
+    if(phase == tlm::BEGIN_REQ) {
+        auto admitted = policy.admit(trans.get_address());
+        if(admitted && !policy.errors_only) {
+            nb_filtered.erase(id);
+            policy.count();
+            return false;
+        }
+        nb_filtered[id] = admitted;
+        return true;
     }
+    auto it = nb_filtered.find(id);
+    if(it == nb_filtered.end())
+        return false;
+    if(it->second && trans.is_response_error()) {
+        nb_filtered.erase(it);
+        policy.count();
+        return false;
+    }
+    return true;
 }
 
 template <typename TYPES>
 void tlm_recorder<TYPES>::btx_cb(tlm_recording_payload& rec_parts, const typename TYPES::tlm_phase_type& phase) {
+    SCC_SPAN("recorder.btx_cb");
     SCVNS scv_tr_handle h;
     // Now process outstanding recordings
     switch(phase) {
@@ -436,6 +667,12 @@ tlm::tlm_sync_enum tlm_recorder<TYPES>::nb_transport_fw(typename TYPES::tlm_payl
         return fw_port->nb_transport_fw(trans, phase, delay);
     else if(!nb_streamHandle)
         initialize_streams();
+    SCC_SPAN("recorder.nb_transport_fw");
+    if(policy.is_active() && is_nb_filtered(trans, phase)) {
+        auto status = fw_port->nb_transport_fw(trans, phase, delay);
+        nb_filter_done(trans, phase, status);
+        return status;
+    }
     /*************************************************************************
      * prepare recording
      *************************************************************************/
@@ -457,9 +694,7 @@ tlm::tlm_sync_enum tlm_recorder<TYPES>::nb_transport_fw(typename TYPES::tlm_payl
     if(preExt)
         preExt->txHandle = h;
     h.record_attribute("delay", delay.to_string());
-    for(auto& extensionRecording : tlm_extension_recording_registry<TYPES>::inst().get())
-        if(extensionRecording)
-            extensionRecording->recordBeginTx(h, trans);
+    tlm_extension_recording_registry<TYPES>::inst().recordBeginTx(h, trans);
     /*************************************************************************
      * do the timed notification
      *************************************************************************/
@@ -480,9 +715,7 @@ tlm::tlm_sync_enum tlm_recorder<TYPES>::nb_transport_fw(typename TYPES::tlm_payl
     record(h, status);
     h.record_attribute("delay[return_path]", delay.to_string());
     record(h, trans);
-    for(auto& extensionRecording : tlm_extension_recording_registry<TYPES>::inst().get())
-        if(extensionRecording)
-            extensionRecording->recordEndTx(h, trans);
+    tlm_extension_recording_registry<TYPES>::inst().recordEndTx(h, trans);
     // get the extension and free the memory if it was mine
     if(status == tlm::TLM_COMPLETED || (status == tlm::TLM_ACCEPTED && phase == tlm::END_RESP)) {
         trans.get_extension(preExt);
@@ -523,6 +756,12 @@ tlm::tlm_sync_enum tlm_recorder<TYPES>::nb_transport_bw(typename TYPES::tlm_payl
         return bw_port->nb_transport_bw(trans, phase, delay);
     else if(!nb_streamHandle)
         initialize_streams();
+    SCC_SPAN("recorder.nb_transport_bw");
+    if(policy.is_active() && is_nb_filtered(trans, phase)) {
+        auto status = bw_port->nb_transport_bw(trans, phase, delay);
+        nb_filter_done(trans, phase, status);
+        return status;
+    }
     /*************************************************************************
      * prepare recording
      *************************************************************************/
@@ -538,9 +777,7 @@ tlm::tlm_sync_enum tlm_recorder<TYPES>::nb_transport_bw(typename TYPES::tlm_payl
         preExt->txHandle = h;
     }
     h.record_attribute("delay", delay.to_string());
-    for(auto& extensionRecording : tlm_extension_recording_registry<TYPES>::inst().get())
-        if(extensionRecording)
-            extensionRecording->recordBeginTx(h, trans);
+    tlm_extension_recording_registry<TYPES>::inst().recordBeginTx(h, trans);
     /*************************************************************************
      * do the timed notification
      *************************************************************************/
@@ -561,9 +798,7 @@ tlm::tlm_sync_enum tlm_recorder<TYPES>::nb_transport_bw(typename TYPES::tlm_payl
     record(h, status);
     h.record_attribute("delay[return_path]", delay.to_string());
     record(h, trans);
-    for(auto& extensionRecording : tlm_extension_recording_registry<TYPES>::inst().get())
-        if(extensionRecording)
-            extensionRecording->recordEndTx(h, trans);
+    tlm_extension_recording_registry<TYPES>::inst().recordEndTx(h, trans);
     // End the transaction
     nb_trHandle[BW]->end_transaction(h, phase2string(phase));
     if(status == tlm::TLM_COMPLETED || (status == tlm::TLM_UPDATED && phase == tlm::END_RESP)) {
@@ -591,6 +826,7 @@ tlm::tlm_sync_enum tlm_recorder<TYPES>::nb_transport_bw(typename TYPES::tlm_payl
 
 template <typename TYPES>
 void tlm_recorder<TYPES>::nbtx_cb(tlm_recording_payload& rec_parts, const typename TYPES::tlm_phase_type& phase) {
+    SCC_SPAN("recorder.nbtx_cb");
     SCVNS scv_tr_handle h;
     std::unordered_map<uint64_t, SCVNS scv_tr_handle>::iterator it;
     switch(phase) { // Now process outstanding recordings
@@ -652,8 +888,52 @@ bool tlm_recorder<TYPES>::get_direct_mem_ptr(typename TYPES::tlm_payload_type& t
     record(h, trans);
     record(h, dmi_data);
     h.end_transaction();
+    if(status && dmi_data.get_dmi_ptr())
+        track_dmi_region(dmi_data);
     return status;
 }
+
+template <typename TYPES> void tlm_recorder<TYPES>::track_dmi_region(tlm::tlm_dmi& dmi_data) {
+    auto it = std::find_if(std::begin(dmi_regions), std::end(dmi_regions), [&dmi_data](impl::dmi_region const& r) {
+        return r.start == dmi_data.get_start_address() && r.end == dmi_data.get_end_address();
+    });
+    if(it == std::end(dmi_regions)) {
+        dmi_regions.emplace_back();
+        it = std::prev(std::end(dmi_regions));
+        it->start = dmi_data.get_start_address();
+        it->end = dmi_data.get_end_address();
+        it->tx = dmi_trRegionHandle->begin_transaction(it->start);
+        record(it->tx, dmi_data);
+    }
+    it->ptr = dmi_data.get_dmi_ptr();
+    it->writable = dmi_data.is_write_allowed();
+    it->grants++;
+    if(dmiSamplePeriod.value) {
+        if(it->page_hashes.empty())
+            it->sample();
+        if(!dmi_sampler_started) {
+            dmi_sampler_started = true;
+            sc_core::sc_spawn_options opts;
+            opts.spawn_method();
+            sc_core::sc_spawn([this]() { sample_dmi_regions(); }, sc_core::sc_gen_unique_name("dmi_sampler"), &opts);
+        }
+    }
+}
+
+template <typename TYPES> void tlm_recorder<TYPES>::sample_dmi_regions() {
+    for(auto& r : dmi_regions)
+        record_dmi_usage(r);
+    sc_core::next_trigger(sc_core::sc_time(dmiSamplePeriod.value, sc_core::SC_NS));
+}
+
+template <typename TYPES> void tlm_recorder<TYPES>::record_dmi_usage(impl::dmi_region& r) {
+    if(!dmiSamplePeriod.value || !r.writable)
+        return;
+    if(auto pages = r.sample()) {
+        SCVNS scv_tr_handle h = dmi_trUsageHandle->begin_transaction(r.start);
+        dmi_trUsageHandle->end_transaction(h, pages);
+    }
+}
 /*! \brief The direct memory interface backward function
  *
  * This type of transaction is just forwarded and not recorded.
@@ -670,6 +950,16 @@ void tlm_recorder<TYPES>::invalidate_direct_mem_ptr(sc_dt::uint64 start_addr, sc
     SCVNS scv_tr_handle h = dmi_trInvalidateHandle->begin_transaction(start_addr);
     bw_port->invalidate_direct_mem_ptr(start_addr, end_addr);
     dmi_trInvalidateHandle->end_transaction(h, end_addr);
+    for(auto it = std::begin(dmi_regions); it != std::end(dmi_regions);) {
+        if(it->overlaps(start_addr, end_addr)) {
+            // take the writes done before the invalidation before the pointer gets unusable
+            record_dmi_usage(*it);
+            it->tx.record_attribute("written_pages", static_cast<sc_dt::uint64>(it->written_pages));
+            dmi_trRegionHandle->end_transaction(it->tx, it->grants);
+            it = dmi_regions.erase(it);
+        } else
+            ++it;
+    }
     return;
 }
 /*! \brief The debug transportfunction
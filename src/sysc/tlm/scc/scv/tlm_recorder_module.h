@@ -63,6 +63,10 @@ public:
         add_attribute(recorder->enableNbTracing);
         add_attribute(recorder->enableTimedTracing);
         add_attribute(recorder->enableDmiTracing);
+        add_attribute(recorder->recordSampleRate);
+        add_attribute(recorder->recordMaxCount);
+        add_attribute(recorder->recordErrorsOnly);
+        add_attribute(recorder->recordAddressRanges);
         // bind the sockets to the module
         is.bind(*recorder);
         ts.bind(*recorder);
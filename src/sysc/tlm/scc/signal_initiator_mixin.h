@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2018 MINRES Technologies GmbH
+ * Copyright 2016, 2018, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -49,7 +49,17 @@ public:
 
     using BASE_TYPE::bind;
 
+    /**
+     * write a value with zero delay. If the bound channel accepts values directly (see tlm_signal_direct_if) no
+     * payload is created.
+     *
+     * @param value the new value
+     */
     void write_now(tlm_signal_type value) {
+        if(auto* direct = get_direct_if()) {
+            direct->write_direct(value);
+            return;
+        }
         auto* gp = tlm_signal_gp<tlm_signal_type>::create();
         gp->set_command(tlm::TLM_WRITE_COMMAND);
         gp->set_value(value);
@@ -97,6 +107,16 @@ public:
     bool error_if_no_callback;
 
 private:
+    tlm_signal_direct_if<tlm_signal_type>* get_direct_if() {
+        if(!direct_if_resolved) {
+            auto& port = this->get_base_port();
+            if(port.size() == 1)
+                direct_if = dynamic_cast<tlm_signal_direct_if<tlm_signal_type>*>(port.get_interface(0));
+            direct_if_resolved = true;
+        }
+        return direct_if;
+    }
+
     class bw_transport_if : public bw_interface_type {
     public:
         using transport_fct = std::function<sync_enum_type(transaction_type&, phase_type&, sc_core::sc_time&)>;
@@ -149,6 +169,8 @@ private:
 
 private:
     bw_transport_if bw_if;
+    tlm_signal_direct_if<tlm_signal_type>* direct_if{nullptr};
+    bool direct_if_resolved{false};
 };
 } // namespace scc
 } // namespace tlm
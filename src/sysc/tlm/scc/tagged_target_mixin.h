@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2018 MINRES Technologies GmbH
+ * Copyright 2016, 2018, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -240,18 +240,10 @@ private:
             } else if(m_b_transport_ptr) {
                 if(phase == tlm::BEGIN_REQ) {
                     // prepare thread to do blocking call
+                    // the processes are spawned on demand so sockets only used with b_transport do not pay for them
                     process_handle_class* ph = m_process_handle.get_handle(&trans);
-
-                    if(!ph) { // create new dynamic process
-                        ph = new process_handle_class(&trans);
-                        m_process_handle.put_handle(ph);
-
-                        sc_core::sc_spawn_options opts;
-                        opts.dont_initialize();
-                        opts.set_sensitivity(&ph->m_e);
-                        sc_core::sc_spawn(sc_bind(&fw_process::nb2b_thread, this, ph),
-                                          sc_core::sc_gen_unique_name("nb2b_thread"), &opts);
-                    }
+                    if(!ph) // all processes of the pool are busy (or there is none yet), add another one
+                        ph = spawn_nb2b(&trans);
 
                     ph->m_e.notify(t);
                     return tlm::TLM_ACCEPTED;
@@ -345,45 +337,56 @@ private:
         class process_handle_class {
         public:
             explicit process_handle_class(transaction_type* trans)
-            : m_trans(trans)
-            , m_suspend(false) {}
+            : m_trans(trans) {}
 
             transaction_type* m_trans{nullptr};
             sc_core::sc_event m_e{};
-            bool m_suspend{false};
+            process_handle_class* m_next{nullptr};
         };
-
+        /**
+         * the pool of nb2b conversion processes, the suspended ones are kept in an intrusive free list so taking and
+         * returning a process does not need to search
+         */
         class process_handle_list {
         public:
             process_handle_list() = default;
-
-            ~process_handle_list() {
-                for(typename std::vector<process_handle_class*>::iterator it = v.begin(), end = v.end(); it != end;
-                    ++it)
-                    delete *it;
-            }
-
+            //! take a suspended process, returns nullptr if there is none
             process_handle_class* get_handle(transaction_type* trans) {
-                typename std::vector<process_handle_class*>::iterator it;
-
-                for(it = v.begin(); it != v.end(); it++) {
-                    if((*it)->m_suspend) {      // found suspended dynamic process, re-use it
-                        (*it)->m_trans = trans; // replace to new one
-                        (*it)->m_suspend = false;
-                        return *it;
-                    }
+                auto* ph = free_list;
+                if(ph) {
+                    free_list = ph->m_next;
+                    ph->m_next = nullptr;
+                    ph->m_trans = trans;
                 }
-                return NULL; // no suspended process
+                return ph;
+            }
+            //! create the handle of a new process, it is busy until it is put back
+            process_handle_class* create_handle(transaction_type* trans) {
+                handles.emplace_back(trans);
+                return &handles.back();
+            }
+            //! put back the handle of a process suspending itself
+            void put_handle(process_handle_class* ph) {
+                ph->m_next = free_list;
+                free_list = ph;
             }
-
-            void put_handle(process_handle_class* ph) { v.push_back(ph); }
 
         private:
-            std::vector<process_handle_class*> v{};
+            std::deque<process_handle_class> handles{};
+            process_handle_class* free_list{nullptr};
         };
-
         process_handle_list m_process_handle{};
 
+        process_handle_class* spawn_nb2b(transaction_type* trans) {
+            auto* ph = m_process_handle.create_handle(trans);
+            sc_core::sc_spawn_options opts;
+            opts.dont_initialize();
+            opts.set_sensitivity(&ph->m_e);
+            sc_core::sc_spawn(sc_bind(&fw_process::nb2b_thread, this, ph), sc_core::sc_gen_unique_name("nb2b_thread"),
+                              &opts);
+            return ph;
+        }
+
         void nb2b_thread(process_handle_class* h) {
 
             while(true) {
@@ -407,7 +410,7 @@ private:
                 }
 
                 // suspend until next transaction
-                h->m_suspend = true;
+                m_process_handle.put_handle(h);
                 sc_core::wait();
             }
         }
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2016, 2018 MINRES Technologies GmbH
+ * Copyright 2016, 2018, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -21,10 +21,12 @@
 #endif
 
 #include "scc/utilities.h"
+#include <deque>
 #include <functional>
 #include <sstream>
 #include <tlm>
 #include <tlm_utils/peq_with_get.h>
+#include <util/inplace_function.h>
 
 //! @brief SystemC TLM
 namespace tlm {
@@ -73,40 +75,74 @@ public:
     /**
      * register a non-blocking forward path callback function
      *
-     * @param cb
+     * @param cb the callback, stored without allocation if it fits into a util::inplace_function
      */
-    void register_nb_transport_fw(std::function<sync_enum_type(transaction_type&, phase_type&, sc_core::sc_time&)> cb) {
+    template <typename F> void register_nb_transport_fw(F&& cb) {
         assert(!sc_core::sc_get_curr_simcontext()->elaboration_done());
-        m_fw_process.set_nb_transport_ptr(cb);
+        m_fw_process.set_nb_transport_ptr(fw_process::NBTransportPtr::make(std::forward<F>(cb)));
     }
     /**
      * register a blocking forward path callback function
      *
-     * @param cb
+     * @param cb the callback, stored without allocation if it fits into a util::inplace_function
      */
-    void register_b_transport(std::function<void(transaction_type&, sc_core::sc_time&)> cb) {
+    template <typename F> void register_b_transport(F&& cb) {
         assert(!sc_core::sc_get_curr_simcontext()->elaboration_done());
-        m_fw_process.set_b_transport_ptr(cb);
+        m_fw_process.set_b_transport_ptr(fw_process::BTransportPtr::make(std::forward<F>(cb)));
     }
     /**
+     * register a member function as blocking forward path callback. The member function is a template argument so the
+     * call is resolved at compile time and inlined into the dispatch of the socket, e.g.
+     * register_b_transport<memory, &memory::b_transport>(this)
      *
-     * @param cb
+     * @param obj the object the member function is called on
      */
-    void register_transport_dbg(std::function<unsigned int(transaction_type&)> cb) {
+    template <typename C, void (C::*FUNC)(transaction_type&, sc_core::sc_time&)> void register_b_transport(C* obj) {
         assert(!sc_core::sc_get_curr_simcontext()->elaboration_done());
-        m_fw_process.set_transport_dbg_ptr(cb);
+        m_fw_process.set_b_transport_ptr(b_transport_call<C, FUNC>{obj});
+    }
+    /**
+     * register a member function taking an additional index as blocking forward path callback, e.g. to serve several
+     * sockets by one function like register_b_transport<router, &router::b_transport>(this, i)
+     *
+     * @param obj the object the member function is called on
+     * @param tag the index passed as first argument
+     */
+    template <typename C, void (C::*FUNC)(int, transaction_type&, sc_core::sc_time&)>
+    void register_b_transport(C* obj, int tag) {
+        assert(!sc_core::sc_get_curr_simcontext()->elaboration_done());
+        m_fw_process.set_b_transport_ptr(tagged_b_transport_call<C, FUNC>{obj, tag});
+    }
+    /**
+     *
+     * @param cb the callback, stored without allocation if it fits into a util::inplace_function
+     */
+    template <typename F> void register_transport_dbg(F&& cb) {
+        assert(!sc_core::sc_get_curr_simcontext()->elaboration_done());
+        m_fw_process.set_transport_dbg_ptr(fw_process::TransportDbgPtr::make(std::forward<F>(cb)));
     }
     /**
      * register a DMI callback function
      *
-     * @param cb
+     * @param cb the callback, stored without allocation if it fits into a util::inplace_function
      */
-    void register_get_direct_mem_ptr(std::function<bool(transaction_type&, tlm::tlm_dmi&)> cb) {
+    template <typename F> void register_get_direct_mem_ptr(F&& cb) {
         assert(!sc_core::sc_get_curr_simcontext()->elaboration_done());
-        m_fw_process.set_get_direct_mem_ptr(cb);
+        m_fw_process.set_get_direct_mem_ptr(fw_process::GetDirectMemPtr::make(std::forward<F>(cb)));
     }
 
 private:
+    template <typename C, void (C::*FUNC)(transaction_type&, sc_core::sc_time&)> struct b_transport_call {
+        C* obj;
+        void operator()(transaction_type& trans, sc_core::sc_time& t) const { (obj->*FUNC)(trans, t); }
+    };
+
+    template <typename C, void (C::*FUNC)(int, transaction_type&, sc_core::sc_time&)> struct tagged_b_transport_call {
+        C* obj;
+        int tag;
+        void operator()(transaction_type& trans, sc_core::sc_time& t) const { (obj->*FUNC)(tag, trans, t); }
+    };
+
     // make call on bw path.
     sync_enum_type bw_nb_transport(transaction_type& trans, phase_type& phase, sc_core::sc_time& t) {
         return BASE_TYPE::operator->()->nb_transport_bw(trans, phase, t);
@@ -164,18 +200,14 @@ private:
 
     class fw_process : public tlm::tlm_fw_transport_if<TYPES>, public tlm::tlm_mm_interface {
     public:
-        using NBTransportPtr = std::function<sync_enum_type(transaction_type&, phase_type&, sc_core::sc_time&)>;
-        using BTransportPtr = std::function<void(transaction_type&, sc_core::sc_time&)>;
-        using TransportDbgPtr = std::function<unsigned int(transaction_type&)>;
-        using GetDirectMemPtr = std::function<bool(transaction_type&, tlm::tlm_dmi&)>;
+        using NBTransportPtr = util::inplace_function<sync_enum_type(transaction_type&, phase_type&, sc_core::sc_time&)>;
+        using BTransportPtr = util::inplace_function<void(transaction_type&, sc_core::sc_time&)>;
+        using TransportDbgPtr = util::inplace_function<unsigned int(transaction_type&)>;
+        using GetDirectMemPtr = util::inplace_function<bool(transaction_type&, tlm::tlm_dmi&)>;
 
         fw_process(target_mixin* p_own)
         : m_name(p_own->name())
         , m_owner(p_own)
-        , m_nb_transport_ptr(0)
-        , m_b_transport_ptr(0)
-        , m_transport_dbg_ptr(0)
-        , m_get_direct_mem_ptr(0)
         , m_peq(sc_core::sc_gen_unique_name("m_peq"))
         , m_response_in_progress(false) {
             sc_core::sc_spawn_options opts;
@@ -190,7 +222,7 @@ private:
                 s << m_name << ": non-blocking callback allready registered";
                 SC_REPORT_WARNING("/OSCI_TLM-2/simple_socket", s.str().c_str());
             } else {
-                m_nb_transport_ptr = p;
+                m_nb_transport_ptr = std::move(p);
             }
         }
 
@@ -200,7 +232,7 @@ private:
                 s << m_name << ": blocking callback allready registered";
                 SC_REPORT_WARNING("/OSCI_TLM-2/simple_socket", s.str().c_str());
             } else {
-                m_b_transport_ptr = p;
+                m_b_transport_ptr = std::move(p);
             }
         }
 
@@ -210,7 +242,7 @@ private:
                 s << m_name << ": debug callback allready registered";
                 SC_REPORT_WARNING("/OSCI_TLM-2/simple_socket", s.str().c_str());
             } else {
-                m_transport_dbg_ptr = p;
+                m_transport_dbg_ptr = std::move(p);
             }
         }
 
@@ -220,7 +252,7 @@ private:
                 s << m_name << ": get DMI pointer callback allready registered";
                 SC_REPORT_WARNING("/OSCI_TLM-2/simple_socket", s.str().c_str());
             } else {
-                m_get_direct_mem_ptr = p;
+                m_get_direct_mem_ptr = std::move(p);
             }
         }
         // Interface implementation
@@ -230,19 +262,11 @@ private:
                 return m_nb_transport_ptr(trans, phase, t);
             } else if(m_b_transport_ptr) {
                 if(phase == tlm::BEGIN_REQ) {
-                    // prepare thread to do blocking call
+                    // prepare thread to do blocking call, the processes are spawned on demand so sockets only used
+                    // with b_transport do not pay for them
                     process_handle_class* ph = m_process_handle.get_handle(&trans);
-
-                    if(!ph) { // create new dynamic process
-                        ph = new process_handle_class(&trans);
-                        m_process_handle.put_handle(ph);
-
-                        sc_core::sc_spawn_options opts;
-                        opts.dont_initialize();
-                        opts.set_sensitivity(&ph->m_e);
-                        sc_core::sc_spawn(sc_bind(&fw_process::nb2b_thread, this, ph),
-                                          sc_core::sc_gen_unique_name("nb2b_thread"), &opts);
-                    }
+                    if(!ph) // all processes of the pool are busy (or there is none yet), add another one
+                        ph = spawn_nb2b(&trans);
                     ph->m_e.notify(t);
                     phase = tlm::END_REQ;
                     return tlm::TLM_UPDATED;
@@ -332,44 +356,55 @@ private:
         class process_handle_class {
         public:
             explicit process_handle_class(transaction_type* trans)
-            : m_trans(trans)
-            , m_suspend(false) {}
+            : m_trans(trans) {}
 
-            transaction_type* m_trans;
-            sc_core::sc_event m_e;
-            bool m_suspend;
+            transaction_type* m_trans{nullptr};
+            sc_core::sc_event m_e{};
+            process_handle_class* m_next{nullptr};
         };
-
+        /**
+         * the pool of nb2b conversion processes, the suspended ones are kept in an intrusive free list so taking and
+         * returning a process does not need to search
+         */
         class process_handle_list {
         public:
             process_handle_list() = default;
-
-            ~process_handle_list() {
-                for(typename std::vector<process_handle_class*>::iterator it = v.begin(), end = v.end(); it != end;
-                    ++it)
-                    delete *it;
-            }
-
+            //! take a suspended process, returns nullptr if there is none
             process_handle_class* get_handle(transaction_type* trans) {
-                typename std::vector<process_handle_class*>::iterator it;
-
-                for(it = v.begin(); it != v.end(); it++) {
-                    if((*it)->m_suspend) {      // found suspended dynamic process, re-use it
-                        (*it)->m_trans = trans; // replace to new one
-                        (*it)->m_suspend = false;
-                        return *it;
-                    }
+                auto* ph = free_list;
+                if(ph) {
+                    free_list = ph->m_next;
+                    ph->m_next = nullptr;
+                    ph->m_trans = trans;
                 }
-                return NULL; // no suspended process
+                return ph;
+            }
+            //! create the handle of a new process, it is busy until it is put back
+            process_handle_class* create_handle(transaction_type* trans) {
+                handles.emplace_back(trans);
+                return &handles.back();
+            }
+            //! put back the handle of a process suspending itself
+            void put_handle(process_handle_class* ph) {
+                ph->m_next = free_list;
+                free_list = ph;
             }
-
-            void put_handle(process_handle_class* ph) { v.push_back(ph); }
 
         private:
-            std::vector<process_handle_class*> v;
+            std::deque<process_handle_class> handles{};
+            process_handle_class* free_list{nullptr};
         };
+        process_handle_list m_process_handle{};
 
-        process_handle_list m_process_handle;
+        process_handle_class* spawn_nb2b(transaction_type* trans) {
+            auto* ph = m_process_handle.create_handle(trans);
+            sc_core::sc_spawn_options opts;
+            opts.dont_initialize();
+            opts.set_sensitivity(&ph->m_e);
+            sc_core::sc_spawn(sc_bind(&fw_process::nb2b_thread, this, ph), sc_core::sc_gen_unique_name("nb2b_thread"),
+                              &opts);
+            return ph;
+        }
 
         void nb2b_thread(process_handle_class* h) {
 
@@ -394,7 +429,7 @@ private:
                 }
 
                 // suspend until next transaction
-                h->m_suspend = true;
+                m_process_handle.put_handle(h);
                 sc_core::wait();
             }
         }
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2020 MINRES Technologies GmbH
+ * Copyright 2020, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,8 +17,12 @@
 #ifndef _TLM_TLM2_PV_AV_H_
 #define _TLM_TLM2_PV_AV_H_
 
+#include <cci_configuration>
+#include <limits>
 #include <memory>
+#include <scc/report.h>
 #include <tlm>
+#include <unordered_map>
 #include <util/ities.h>
 
 //! @brief SystemC TLM
@@ -26,6 +30,20 @@ namespace tlm {
 //! @brief SCC TLM utilities
 namespace scc {
 
+/**
+ * @class tlm2_pv_av_target_adapter
+ * @brief forwards the accesses of an initiator either to a fast (PV) or an accurate (AV) model of a target
+ *
+ * Non-blocking accesses are always forwarded to the AV socket. Blocking accesses and DMI requests are forwarded to the
+ * PV socket as long as the adapter is in fast mode. In accurate mode blocking accesses are converted into base protocol
+ * AT transactions issued to the AV socket and DMI is denied.
+ *
+ * The mode is controlled by the parameter accurate and can be changed at runtime, either by writing the parameter
+ * (e.g. by a configurer or a CCI broker), at switch_time or when the event given to switch_on() is notified. This
+ * allows to fast-forward e.g. the boot of an OS and to simulate only the interesting part of the workload with
+ * accurate timing. Upon a switch all DMI pointers are invalidated, blocking accesses being in flight on the old path
+ * are completed (drained) and accesses arriving meanwhile are held back until the switch took place.
+ */
 template <unsigned int BUSWIDTH = 32, typename TYPES = tlm_base_protocol_types, int N = 1,
           sc_core::sc_port_policy POL = sc_core::SC_ONE_OR_MORE_BOUND,
           typename TSOCKET_TYPE = tlm::tlm_target_socket<BUSWIDTH, TYPES, N, POL>,
@@ -41,12 +59,25 @@ public:
 
     target_socket_type tsck{"tsck"};
 
+    cci::cci_param<bool> accurate{"accurate", false, "forward blocking accesses to the accurate (AV) model"};
+
+    cci::cci_param<sc_core::sc_time> switch_time{"switch_time", sc_core::SC_ZERO_TIME,
+                                                 "simulation time to switch to the accurate model, 0 disables it"};
+
     tlm2_pv_av_target_adapter()
     : tlm2_pv_av_target_adapter(sc_core::sc_gen_unique_name("tlm_pv_av_split")) {}
 
     tlm2_pv_av_target_adapter(sc_core::sc_module_name const& nm)
     : sc_core::sc_module(nm) {
         tsck.bind(*this);
+        accurate.register_post_write_callback(
+            cci::cci_param_post_write_callback_untyped([this](cci::cci_param_write_event<> const&) {
+                if(sc_core::sc_is_running())
+                    switch_req_evt.notify(sc_core::SC_ZERO_TIME);
+            }));
+        SC_HAS_PROCESS(tlm2_pv_av_target_adapter);
+        SC_THREAD(trigger);
+        SC_THREAD(switcher);
     }
 
     void bind_pv(target_socket_type& tsck) {
@@ -60,10 +91,69 @@ public:
         av_isck->bind(*this);
         av_isck->bind(tsck);
     }
+    /**
+     * switch to the accurate model when the event is notified, needs to be called before the simulation starts
+     *
+     * @param evt the event
+     */
+    void switch_on(sc_core::sc_event const& evt) { switch_evt = &evt; }
+    //! return true if blocking accesses are currently forwarded to the AV model
+    bool is_accurate() const { return use_av; }
+    //! the event notified when a switch of the mode took place
+    sc_core::sc_event const& mode_changed_event() const { return mode_changed_evt; }
 
     virtual ~tlm2_pv_av_target_adapter() = default;
 
 private:
+    //! a blocking access converted to an AT transaction waiting for its response
+    struct pending_access {
+        sc_core::sc_event evt;
+        sc_core::sc_time resp_time;
+        bool done{false};
+    };
+
+    void start_of_simulation() override { use_av = accurate.get_value() && av_isck; }
+
+    void trigger() {
+        auto t = switch_time.get_value();
+        if(t > sc_core::SC_ZERO_TIME && switch_evt)
+            wait(t, *switch_evt);
+        else if(t > sc_core::SC_ZERO_TIME)
+            wait(t);
+        else if(switch_evt)
+            wait(*switch_evt);
+        else
+            return;
+        accurate.set_value(true);
+    }
+
+    void switcher() {
+        while(true) {
+            wait(switch_req_evt);
+            bool to_av = accurate.get_value();
+            if(to_av == use_av)
+                continue;
+            if(to_av && !av_isck) {
+                SCCWARN(SCMOD) << "no accurate model bound, staying in fast mode";
+                continue;
+            }
+            if(!to_av && !pv_isck) {
+                SCCWARN(SCMOD) << "no fast model bound, staying in accurate mode";
+                continue;
+            }
+            switching = true;
+            // DMI pointers are only handed out in fast mode, accessing memory directly bypasses the AV model
+            if(to_av)
+                tsck->invalidate_direct_mem_ptr(0, std::numeric_limits<sc_dt::uint64>::max());
+            while(active)
+                wait(drained_evt);
+            use_av = to_av;
+            switching = false;
+            mode_changed_evt.notify(sc_core::SC_ZERO_TIME);
+            SCCINFO(SCMOD) << "switched to " << (use_av ? "accurate" : "fast") << " mode";
+        }
+    }
+
     tlm::tlm_sync_enum nb_transport_fw(tlm_payload_type& trans, tlm_phase_type& phase, sc_core::sc_time& t) {
         if(av_isck)
             return (*av_isck)->nb_transport_fw(trans, phase, t);
@@ -72,16 +162,52 @@ private:
     };
 
     void b_transport(tlm_payload_type& trans, sc_core::sc_time& t) {
-        if(pv_isck)
+        while(switching)
+            wait(mode_changed_evt);
+        ++active;
+        if(use_av) {
+            av_transport(trans, t);
+            trans.set_dmi_allowed(false);
+        } else if(pv_isck)
             (*pv_isck)->b_transport(trans, t);
         else
             trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+        if(--active == 0)
+            drained_evt.notify(sc_core::SC_ZERO_TIME);
+    }
+    //! issue a blocking access as base protocol AT transaction to the AV model
+    void av_transport(tlm_payload_type& trans, sc_core::sc_time& t) {
+        if(t > sc_core::SC_ZERO_TIME) {
+            wait(t);
+            t = sc_core::SC_ZERO_TIME;
+        }
+        pending_access acc;
+        pending[&trans] = &acc;
+        tlm_phase_type phase{tlm::BEGIN_REQ};
+        sc_core::sc_time delay;
+        auto status = (*av_isck)->nb_transport_fw(trans, phase, delay);
+        if(status == tlm::TLM_COMPLETED || (status == tlm::TLM_UPDATED && phase == tlm::BEGIN_RESP)) {
+            if(status == tlm::TLM_UPDATED) {
+                phase = tlm::END_RESP;
+                sc_core::sc_time end_delay;
+                (*av_isck)->nb_transport_fw(trans, phase, end_delay);
+            }
+            acc.done = true;
+            acc.resp_time = sc_core::sc_time_stamp() + delay;
+        }
+        while(!acc.done)
+            wait(acc.evt);
+        pending.erase(&trans);
+        auto now = sc_core::sc_time_stamp();
+        if(acc.resp_time > now)
+            wait(acc.resp_time - now);
     }
 
     bool get_direct_mem_ptr(tlm_payload_type& trans, tlm_dmi& dmi_data) {
-        if(pv_isck)
+        if(pv_isck && !use_av && !switching)
             return (*pv_isck)->get_direct_mem_ptr(trans, dmi_data);
-        trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
+        if(!pv_isck)
+            trans.set_response_status(tlm::TLM_GENERIC_ERROR_RESPONSE);
         trans.set_dmi_allowed(false);
         return false;
     }
@@ -94,7 +220,17 @@ private:
     }
 
     tlm::tlm_sync_enum nb_transport_bw(tlm_payload_type& trans, tlm_phase_type& phase, sc_core::sc_time& t) {
-        return tsck->nb_transport_bw(trans, phase, t);
+        auto it = pending.find(&trans);
+        if(it == pending.end())
+            return tsck->nb_transport_bw(trans, phase, t);
+        if(phase == tlm::BEGIN_RESP) {
+            it->second->done = true;
+            it->second->resp_time = sc_core::sc_time_stamp() + t;
+            it->second->evt.notify(t);
+            phase = tlm::END_RESP;
+            return tlm::TLM_COMPLETED;
+        }
+        return tlm::TLM_ACCEPTED;
     }
 
     void invalidate_direct_mem_ptr(sc_dt::uint64 start_range, sc_dt::uint64 end_range) {
@@ -103,6 +239,12 @@ private:
 
     std::unique_ptr<initiator_socket_type> pv_isck;
     std::unique_ptr<initiator_socket_type> av_isck;
+    sc_core::sc_event const* switch_evt{nullptr};
+    sc_core::sc_event switch_req_evt, drained_evt, mode_changed_evt;
+    std::unordered_map<tlm_payload_type*, pending_access*> pending;
+    unsigned active{0};
+    bool use_av{false};
+    bool switching{false};
 };
 
 template <unsigned int BUSWIDTH = 32, typename TYPES = tlm_base_protocol_types, int N = 1,
@@ -0,0 +1,216 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _TLM_TLM_ARENA_MM_H_
+#define _TLM_TLM_ARENA_MM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <scc/report.h>
+#include <tlm>
+#include <tlm_utils/tlm_quantumkeeper.h>
+#include <utility>
+#include <vector>
+
+//! @brief SystemC TLM
+namespace tlm {
+//! @brief SCC TLM utilities
+namespace scc {
+/**
+ * @brief an extension living in a \ref tlm_arena_mm, free() only destructs it as the memory is reclaimed by the
+ * arena reset
+ */
+template <typename EXT> struct tlm_arena_ext : public EXT {
+    template <typename... ARGS>
+    tlm_arena_ext(ARGS&&... args)
+    : EXT(std::forward<ARGS>(args)...) {}
+
+    void free() override { this->~tlm_arena_ext(); }
+};
+/**
+ * @class tlm_arena_mm
+ * @brief a memory manager allocating payloads, data buffers and extensions from a bump allocator
+ *
+ * Allocation is a pointer increment, free() only destructs the payload. The memory is reclaimed in one go by reset(),
+ * e.g. when the quantum keeper synchronizes (see \ref tlm_arena_quantumkeeper) or at any other point in time where
+ * all transactions allocated so far are finished. This suits transactions living at most one time window, like the
+ * ones of trace-driven traffic generators. Unlike \ref tlm_mm the arena is not a singleton, each initiator should have
+ * its own instance. The arena is not thread-safe.
+ *
+ * @tparam TYPES the protocol types
+ * @tparam BLOCK_SIZE the size of the memory blocks the allocations are taken from
+ */
+template <typename TYPES = tlm_base_protocol_types, size_t BLOCK_SIZE = (1 << 20)>
+class tlm_arena_mm : public tlm::tlm_mm_interface {
+    using payload_type = typename TYPES::tlm_payload_type;
+
+public:
+    tlm_arena_mm() = default;
+
+    tlm_arena_mm(const tlm_arena_mm&) = delete;
+
+    tlm_arena_mm& operator=(const tlm_arena_mm&) = delete;
+
+    ~tlm_arena_mm() {
+        for(auto* b : blocks)
+            delete[] b;
+        release_large();
+    }
+    /**
+     * @brief get a plain tlm_payload_type without extensions
+     * @return the tlm_payload_type
+     */
+    payload_type* allocate() {
+        ++live;
+        return new(alloc(sizeof(payload_type), alignof(payload_type))) payload_type(this);
+    }
+    /**
+     * @brief get a tlm_payload_type with registered extension
+     * @return the tlm_payload_type
+     */
+    template <typename PEXT> payload_type* allocate() {
+        auto* ptr = allocate();
+        ptr->set_auto_extension(create_extension<PEXT>());
+        return ptr;
+    }
+    /**
+     * @brief get a plain tlm_payload_type without extensions but initialized data and byte enable, the buffers are
+     * not cleared
+     * @return the tlm_payload_type
+     */
+    payload_type* allocate(size_t sz, bool be = false) {
+        auto* ptr = allocate();
+        if(sz) {
+            ptr->set_data_ptr(static_cast<uint8_t*>(alloc(sz, 1)));
+            ptr->set_data_length(sz);
+            if(be) {
+                ptr->set_byte_enable_ptr(static_cast<uint8_t*>(alloc(sz, 1)));
+                ptr->set_byte_enable_length(sz);
+            }
+        }
+        return ptr;
+    }
+    /**
+     * @brief get a tlm_payload_type with registered extension and initialize data pointer
+     * @return the tlm_payload_type
+     */
+    template <typename PEXT> payload_type* allocate(size_t sz, bool be = false) {
+        auto* ptr = allocate(sz, be);
+        ptr->set_auto_extension(create_extension<PEXT>());
+        return ptr;
+    }
+    /**
+     * @brief create an extension in the arena, it is supposed to be set as auto extension
+     *
+     * @param args the constructor arguments of the extension
+     * @return the extension
+     */
+    template <typename EXT, typename... ARGS> EXT* create_extension(ARGS&&... args) {
+        return new(alloc(sizeof(tlm_arena_ext<EXT>), alignof(tlm_arena_ext<EXT>)))
+            tlm_arena_ext<EXT>(std::forward<ARGS>(args)...);
+    }
+    /**
+     * @brief destruct the payload, the memory is reclaimed by reset()
+     * @param trans the returning transaction
+     */
+    void free(tlm::tlm_generic_payload* trans) override {
+        trans->reset();
+        trans->set_data_ptr(nullptr);
+        trans->set_byte_enable_ptr(nullptr);
+        trans->~tlm_generic_payload();
+        --live;
+    }
+    /**
+     * @brief reclaim all memory if all payloads have been freed
+     *
+     * @return false if some payloads are still in use, in this case nothing is reclaimed
+     */
+    bool reset() {
+        if(live)
+            return false;
+        cur_block = 0;
+        offset = 0;
+        release_large();
+        return true;
+    }
+    //! get the number of payloads not being freed
+    size_t get_live_count() const { return live; }
+    //! get the number of blocks allocated so far
+    size_t get_block_count() const { return blocks.size(); }
+
+private:
+    void* alloc(size_t sz, size_t align) {
+        if(sz > BLOCK_SIZE) {
+            large.push_back(new uint8_t[sz]);
+            return large.back();
+        }
+        offset = (offset + align - 1) & ~(align - 1);
+        if(blocks.empty() || offset + sz > BLOCK_SIZE) {
+            if(!blocks.empty())
+                ++cur_block;
+            if(cur_block == blocks.size())
+                blocks.push_back(new uint8_t[BLOCK_SIZE]);
+            offset = 0;
+        }
+        auto* ret = blocks[cur_block] + offset;
+        offset += sz;
+        return ret;
+    }
+
+    void release_large() {
+        for(auto* b : large)
+            delete[] b;
+        large.clear();
+    }
+
+    std::vector<uint8_t*> blocks;
+    std::vector<uint8_t*> large;
+    size_t cur_block{0};
+    size_t offset{0};
+    size_t live{0};
+};
+/**
+ * @class tlm_arena_quantumkeeper
+ * @brief a quantum keeper resetting an arena each time it synchronizes
+ *
+ * If transactions are still in flight when synchronizing the reset is deferred to the next synchronization where all
+ * payloads have been freed. The first deferral is reported as warning as the arena grows until then.
+ *
+ * @tparam ARENA the type of the arena
+ */
+template <typename ARENA = tlm_arena_mm<>> class tlm_arena_quantumkeeper : public tlm_utils::tlm_quantumkeeper {
+public:
+    tlm_arena_quantumkeeper(ARENA& arena)
+    : arena(arena) {}
+
+    void sync() override {
+        tlm_utils::tlm_quantumkeeper::sync();
+        if(!arena.reset() && !failed_resets++)
+            SCCWARN("tlm_arena_quantumkeeper") << "deferring the reset of the arena as " << arena.get_live_count()
+                                               << " payloads are still in use";
+    }
+    //! get the number of synchronizations where the arena could not be reset
+    size_t get_failed_resets() const { return failed_resets; }
+
+private:
+    ARENA& arena;
+    size_t failed_resets{0};
+};
+} // namespace scc
+} // namespace tlm
+#endif /* _TLM_TLM_ARENA_MM_H_ */
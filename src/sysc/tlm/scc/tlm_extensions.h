@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2018-2022 MINRES Technologies GmbH
+ * Copyright 2018-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -22,11 +22,38 @@
 #else
 #include <tlm_core/tlm_2/tlm_generic_payload/tlm_gp.h>
 #endif
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <util/pool_allocator.h>
+#include <utility>
 
 //! @brief SystemC TLM
 namespace tlm {
 //! @brief SCC TLM utilities
 namespace scc {
+/**
+ * @brief the pool allocator used for elements of size SZ, MT selects the allocator allowing to free elements on any
+ * thread
+ */
+template <size_t SZ, bool MT, unsigned CHUNK_SIZE = 4096>
+using tlm_pool_allocator = typename std::conditional<MT, util::mt_pool_allocator<SZ, CHUNK_SIZE>,
+                                                     util::pool_allocator<SZ, CHUNK_SIZE>>::type;
+/**
+ * @brief the pool of the extensions of type EXT
+ *
+ * All pooled extensions (tlm_managed_extension and tlm_ext_mm) are taken from this pool. It is indexed by the size of
+ * the type so extensions of the same size share their free list, allocate and free are O(1) operations on the
+ * intrusive free list of the util::pool_allocator. The memory is cleared before the extension is constructed.
+ *
+ * @tparam EXT the extension type
+ * @tparam MT if true the extensions may be freed on a different OS thread than the allocating one
+ */
+template <typename EXT, bool MT = false> struct tlm_extension_pool {
+    static void* allocate() { return tlm_pool_allocator<sizeof(EXT), MT>::get().allocate(); }
+
+    static void free(void* p) { tlm_pool_allocator<sizeof(EXT), MT>::get().free(p); }
+};
 
 template <typename T> struct tlm_unmanaged_extension : public tlm_extension<T> {
     using type = T;
@@ -39,18 +66,18 @@ protected:
     tlm_unmanaged_extension(){};
 };
 
-template <typename T> struct tlm_managed_extension {
+/**
+ * @brief a mixin for extensions being taken from the tlm_extension_pool
+ *
+ * @tparam T the extension type deriving from this class
+ * @tparam MT if true the extensions may be freed on a different OS thread than the allocating one
+ */
+template <typename T, bool MT = false> struct tlm_managed_extension {
 
     using type = T;
 
     template <typename... Args> static type* allocate(Args&&... args) {
-        auto* ret = new(pool::allocate()) type(std::forward<Args>(args)...);
-        ret->is_pooled = true;
-        return ret;
-    }
-
-    static type* allocate() {
-        auto* ret = new(pool::allocate()) type();
+        auto* ret = new(tlm_extension_pool<type, MT>::allocate()) type(std::forward<Args>(args)...);
         ret->is_pooled = true;
         return ret;
     }
@@ -62,32 +89,19 @@ template <typename T> struct tlm_managed_extension {
     void copy_from(tlm_extension_base const& other) { this->operator=(static_cast<const type&>(other)); }
 
     void free() {
+        auto* ext = static_cast<type*>(this);
         if(is_pooled) {
-            this->~type();
-            pool::dealllocate(this);
+            ext->~type();
+            tlm_extension_pool<type, MT>::free(ext);
         } else {
-            delete this;
+            delete ext;
         }
     }
-    struct pool {
-        static void* allocate() {
-            if(free_list.size() > 0) {
-                auto ret = free_list.back();
-                free_list.pop_back();
-                return ret;
-            } else
-                return calloc(1, sizeof(type));
-        }
-
-        static void dealllocate(void* p) { free_list.push_back(p); }
-
-    private:
-        static std::vector<void*> free_list;
-    };
 
 protected:
     tlm_managed_extension() = default;
-    tlm_managed_extension(const tlm_managed_extension&) = default;
+    //! a copy is not pooled unless it is created by allocate()
+    tlm_managed_extension(const tlm_managed_extension&) {}
     tlm_managed_extension& operator=(const tlm_managed_extension& other) { return *this; }
 
 private:
@@ -109,6 +123,56 @@ private:
     std::vector<unsigned char> buffer_;
 };
 
+namespace detail {
+//! the index of T in the parameter pack TS
+template <typename T, typename... TS> struct type_index;
+template <typename T, typename... TS> struct type_index<T, T, TS...> : std::integral_constant<size_t, 0> {};
+template <typename T, typename U, typename... TS>
+struct type_index<T, U, TS...> : std::integral_constant<size_t, 1 + type_index<T, TS...>::value> {};
+} // namespace detail
+/**
+ * @brief a cache of the extensions of a payload being queried repeatedly
+ *
+ * A component resolves the extensions once when it starts handling a payload (e.g. with the first beat) and reads the
+ * cached pointers afterwards instead of looking them up on each access. The cache stays valid as long as the
+ * extensions of the payload are neither set nor cleared, so it needs to be resolved again for each new transaction
+ * even if the payload object is reused.
+ *
+ * @tparam EXTS the extension types
+ */
+template <typename... EXTS> class tlm_ext_cache {
+public:
+    tlm_ext_cache() = default;
+
+    explicit tlm_ext_cache(tlm_generic_payload const& gp) { resolve(gp); }
+    //! look up all extensions of gp
+    void resolve(tlm_generic_payload const& gp) {
+        trans = &gp;
+        exts = {{gp.get_extension(EXTS::ID)...}};
+    }
+    //! check if the cache holds the extensions of gp
+    bool is_resolved(tlm_generic_payload const& gp) const { return trans == &gp; }
+    //! resolve the extensions of gp unless they are cached already or force is true
+    tlm_ext_cache& update(tlm_generic_payload const& gp, bool force = false) {
+        if(force || trans != &gp)
+            resolve(gp);
+        return *this;
+    }
+    //! forget the payload
+    void reset() {
+        trans = nullptr;
+        exts.fill(nullptr);
+    }
+    //! get the cached extension of type EXT, nullptr if the payload does not carry one
+    template <typename EXT> EXT* get() const {
+        return static_cast<EXT*>(exts[detail::type_index<EXT, EXTS...>::value]);
+    }
+
+private:
+    tlm_generic_payload const* trans{nullptr};
+    std::array<tlm_extension_base*, sizeof...(EXTS)> exts{};
+};
+
 } // namespace scc
 } // namespace tlm
 #endif /* SC_COMPONENTS_INCL_TLM_TLM_EXTENSIONS_H_ */
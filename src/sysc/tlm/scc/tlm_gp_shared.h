@@ -23,6 +23,69 @@
 namespace tlm {
 //! @brief SCC TLM utilities
 namespace scc {
+/**
+ * @brief a move-only handle owning a reference to a payload
+ *
+ * The handle acquires the payload upon construction and releases it upon destruction or reset, like
+ * \ref tlm_gp_shared_ptr but without the possibility to copy it. Hence the ownership is always explicit and passing it
+ * on does not touch the reference count.
+ */
+class tlm_gp_unique_ptr {
+    tlm::tlm_generic_payload* ptr{nullptr};
+
+public:
+    /// @brief Default constructor, creates a handle that owns nothing.
+    tlm_gp_unique_ptr() noexcept = default;
+    /// @brief Acquires the payload.
+    explicit tlm_gp_unique_ptr(tlm::tlm_generic_payload* p) noexcept
+    : ptr(p) {
+        if(ptr && ptr->has_mm())
+            ptr->acquire();
+    }
+    /// @brief deleted copy constructor
+    tlm_gp_unique_ptr(tlm_gp_unique_ptr const&) = delete;
+    /// @brief Move constructor.
+    tlm_gp_unique_ptr(tlm_gp_unique_ptr&& p) noexcept
+    : ptr(p.ptr) {
+        p.ptr = nullptr;
+    }
+    /// @brief destructor
+    ~tlm_gp_unique_ptr() { reset(); }
+    /// @brief deleted copy assignment operator
+    tlm_gp_unique_ptr& operator=(tlm_gp_unique_ptr const&) = delete;
+    /// @brief Move assignment operator.
+    tlm_gp_unique_ptr& operator=(tlm_gp_unique_ptr&& p) noexcept {
+        if(this != &p) {
+            reset();
+            ptr = p.ptr;
+            p.ptr = nullptr;
+        }
+        return *this;
+    }
+    /// @brief Release the owned payload and own nothing.
+    void reset() noexcept {
+        if(ptr && ptr->has_mm())
+            ptr->release();
+        ptr = nullptr;
+    }
+    /// @brief Give up the ownership without releasing, the caller is responsible to release the payload.
+    tlm::tlm_generic_payload* detach() noexcept {
+        auto* p = ptr;
+        ptr = nullptr;
+        return p;
+    }
+
+    /// Dereference the stored pointer.
+    inline tlm::tlm_generic_payload& operator*() const noexcept { return *ptr; }
+
+    /// Return the stored pointer.
+    inline tlm::tlm_generic_payload* operator->() const noexcept { return ptr; }
+
+    /// Return the stored pointer.
+    inline tlm::tlm_generic_payload* get() const noexcept { return ptr; }
+
+    inline explicit operator bool() const noexcept { return ptr != nullptr; }
+};
 
 class tlm_gp_shared_ptr {
     tlm::tlm_generic_payload* ptr{nullptr};
@@ -48,6 +111,9 @@ public:
     : ptr(std::move(p.ptr)) {
         p.ptr = nullptr;
     }
+    /// @brief Takes over the ownership of a unique handle without changing the reference count.
+    inline tlm_gp_shared_ptr(tlm_gp_unique_ptr&& p) noexcept
+    : ptr(p.detach()) {}
     /// @brief destructor
     ~tlm_gp_shared_ptr() {
         if(ptr && ptr->has_mm())
@@ -0,0 +1,175 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _SYSC_TLM_TLM_GP_VIEW_H_
+#define _SYSC_TLM_TLM_GP_VIEW_H_
+
+#include "tlm_gp_shared.h"
+#include "tlm_mm.h"
+#include <cassert>
+
+//! @brief SystemC TLM
+namespace tlm {
+//! @brief SCC TLM utilities
+namespace scc {
+/**
+ * @brief the data buffer extension of a beat referring to a slice of the data buffer of its burst
+ *
+ * The extension keeps the burst alive as long as the beat exists. Since it is a \ref tlm_gp_mm the memory manager
+ * does not try to delete the data buffer of the beat.
+ */
+struct tlm_gp_view_mm : public tlm_gp_mm {
+    //! the payload owning the data buffer
+    tlm_gp_shared_ptr const parent;
+    //! the offset of the slice within the data buffer of the parent
+    size_t const offset;
+
+    static tlm_gp_view_mm* create(tlm_gp_shared_ptr const& parent, size_t offset, size_t sz) {
+        return new(util::pool_allocator<sizeof(tlm_gp_view_mm)>::get().allocate(0, false))
+            tlm_gp_view_mm(parent, offset, sz);
+    }
+
+    void free() override {
+        this->~tlm_gp_view_mm();
+        util::pool_allocator<sizeof(tlm_gp_view_mm)>::get().free(this);
+    }
+
+protected:
+    tlm_gp_view_mm(tlm_gp_shared_ptr const& parent, size_t offset, size_t sz)
+    : tlm_gp_mm(sz, parent->get_data_ptr() + offset,
+                parent->get_byte_enable_ptr() && parent->get_byte_enable_length() >= offset + sz
+                    ? parent->get_byte_enable_ptr() + offset
+                    : nullptr)
+    , parent(parent)
+    , offset(offset) {}
+};
+/**
+ * @brief a zero-copy view of a burst payload as a sequence of beats
+ *
+ * Each beat is a payload of its own whose data (and byte enable) pointer refers to the respective slice of the
+ * buffer of the burst, so splitting a burst into beats and merging them again does not copy any data (as opposed to
+ * deep_copy_from()). The extensions of the burst (except for its data buffer) are cloned into the beats, the beats
+ * keep the burst alive. The address of beat i is the address of the burst plus (i*beat_size modulo streaming width),
+ * so fixed (streaming) bursts are supported as well. If the beats are aligned the first beat ends at the next multiple
+ * of the beat size, as required when splitting a burst for a narrower bus. If the byte enable buffer of the burst is
+ * shorter than the data it is used as a pattern, in this case the beats need to start at multiples of the byte enable
+ * length.
+ * Example:
+ * @code
+ * tlm::scc::tlm_gp_view view(burst, 8);
+ * for(size_t i = 0; i < view.size(); ++i) {
+ *     auto beat = view.beat(i);
+ *     socket->b_transport(*beat, delay);
+ *     view.merge(*beat);
+ * }
+ * @endcode
+ */
+class tlm_gp_view {
+public:
+    /**
+     * @fn  tlm_gp_view(const tlm_gp_shared_ptr&, size_t)
+     * @brief create a view of the burst
+     *
+     * @param burst the payload owning the data buffer
+     * @param beat_size the number of bytes per beat, the last beat may be shorter
+     * @param aligned if true the beats are aligned to the beat size, so the first beat may be shorter as well. This
+     * does not apply to streaming bursts.
+     */
+    tlm_gp_view(tlm_gp_shared_ptr const& burst, size_t beat_size, bool aligned = false)
+    : burst(burst)
+    , beat_size(beat_size)
+    , lead(aligned && (!burst->get_streaming_width() || burst->get_streaming_width() >= burst->get_data_length())
+               ? burst->get_address() % beat_size
+               : 0) {
+        assert(beat_size > 0);
+    }
+    //! get the number of beats
+    size_t size() const { return (burst->get_data_length() + lead + beat_size - 1) / beat_size; }
+    //! get the burst payload
+    tlm_gp_shared_ptr const& get() const { return burst; }
+    /**
+     * @fn tlm_gp_unique_ptr beat(size_t) const
+     * @brief create the payload of the given beat
+     *
+     * @param i the beat number
+     * @return the owning handle of the beat payload
+     */
+    tlm_gp_unique_ptr beat(size_t i) const {
+        assert(i < size());
+        auto offset = i ? i * beat_size - lead : 0;
+        auto len = std::min<size_t>((i + 1) * beat_size - lead, burst->get_data_length()) - offset;
+        auto* ext = tlm_gp_view_mm::create(burst, offset, len);
+        auto* gp = tlm_mm<>::get().allocate();
+        for(unsigned idx = 0; idx < tlm::max_num_extensions(); ++idx)
+            if(idx != tlm_gp_mm::ID)
+                if(auto* e = burst->get_extension(idx))
+                    gp->set_auto_extension(idx, e->clone());
+        gp->set_auto_extension(ext);
+        gp->set_command(burst->get_command());
+        auto sw = burst->get_streaming_width() ? burst->get_streaming_width() : burst->get_data_length();
+        gp->set_address(burst->get_address() + offset % sw);
+        gp->set_data_ptr(ext->data_ptr);
+        gp->set_data_length(len);
+        gp->set_streaming_width(len);
+        if(ext->be_ptr) {
+            gp->set_byte_enable_ptr(ext->be_ptr);
+            gp->set_byte_enable_length(len);
+        } else if(burst->get_byte_enable_ptr()) {
+            // byte enable pattern being shorter than the data
+            assert(offset % burst->get_byte_enable_length() == 0);
+            gp->set_byte_enable_ptr(burst->get_byte_enable_ptr());
+            gp->set_byte_enable_length(burst->get_byte_enable_length());
+        }
+        gp->set_dmi_allowed(false);
+        gp->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        return tlm_gp_unique_ptr(gp);
+    }
+    /**
+     * @fn void merge(const tlm::tlm_generic_payload&)
+     * @brief update the burst from a finished beat, the data is already in place so only the response status (the
+     * first error response of all beats) and the DMI hint are updated
+     *
+     * @param beat the payload of the beat
+     */
+    void merge(tlm::tlm_generic_payload const& beat) {
+        auto status = burst->get_response_status();
+        if(status == tlm::TLM_INCOMPLETE_RESPONSE || status == tlm::TLM_OK_RESPONSE)
+            burst->set_response_status(beat.get_response_status());
+        burst->set_dmi_allowed(beat.is_dmi_allowed() && (merged == 0 || burst->is_dmi_allowed()));
+        ++merged;
+    }
+    /**
+     * @fn tlm_gp_shared_ptr parent_of(tlm::tlm_generic_payload&)
+     * @brief get the burst a beat has been created from, allowing to combine beats without copying
+     *
+     * @param beat the payload of the beat
+     * @return the burst or an empty pointer if the payload is not a beat of a view
+     */
+    static tlm_gp_shared_ptr parent_of(tlm::tlm_generic_payload& beat) {
+        auto* ext = dynamic_cast<tlm_gp_view_mm*>(beat.get_extension<tlm_gp_mm>());
+        return ext ? ext->parent : tlm_gp_shared_ptr();
+    }
+
+private:
+    tlm_gp_shared_ptr burst;
+    size_t const beat_size;
+    //! the gap between the aligned start of the first beat and the address of the burst
+    size_t const lead;
+    size_t merged{0};
+};
+} // namespace scc
+} // namespace tlm
+#endif /* _SYSC_TLM_TLM_GP_VIEW_H_ */
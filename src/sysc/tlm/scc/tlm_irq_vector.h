@@ -0,0 +1,155 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+
+#ifndef _TLM_TLM_IRQ_VECTOR_H_
+#define _TLM_TLM_IRQ_VECTOR_H_
+
+#include "tlm_signal_gp.h"
+#include "tlm_signal_sockets.h"
+#include <bitset>
+#include <deque>
+#include <scc/peq.h>
+#include <scc/process_profiler.h>
+#include <sysc/utils/sc_vector.h>
+
+//! @brief SystemC TLM
+namespace tlm {
+//! @brief SCC TLM utilities
+namespace scc {
+/**
+ * @brief a channel aggregating many interrupt lines into one bit vector
+ *
+ * Each interrupt line is bound to one of the irq_i sockets. All changes of the lines happening in the same delta cycle
+ * are coalesced into a single update: the value_changed_event() is notified once and the vector is sent once via
+ * irq_o, so an interrupt controller evaluates its priorities once per delta cycle instead of once per line. Lines
+ * written with zero delay (e.g. using signal_initiator_mixin::write_now()) are updated without a payload.
+ *
+ * @tparam WIDTH the number of interrupt lines
+ */
+template <size_t WIDTH>
+struct tlm_irq_vector : public sc_core::sc_module,
+                        public tlm_signal_bw_transport_if<std::bitset<WIDTH>> {
+    using vector_type = std::bitset<WIDTH>;
+    using line_payload_type = tlm_signal_gp<bool>;
+    using vector_payload_type = tlm_signal_gp<vector_type>;
+
+    SC_HAS_PROCESS(tlm_irq_vector); // NOLINT
+    //! the interrupt lines
+    sc_core::sc_vector<tlm_signal_opt_target_socket<bool>> irq_i{"irq_i", WIDTH};
+    //! the coalesced interrupt vector
+    tlm_signal_opt_initiator_socket<vector_type> irq_o{"irq_o"};
+
+    tlm_irq_vector(sc_core::sc_module_name nm)
+    : sc_core::sc_module(nm) {
+        for(size_t i = 0; i < WIDTH; ++i) {
+            lines.emplace_back(*this, i);
+            irq_i[i].bind(lines.back());
+        }
+        irq_o.bind(*this);
+        SC_METHOD(update_cb);
+        sensitive << update_evt;
+        dont_initialize();
+        SC_METHOD(que_cb);
+        sensitive << que.event();
+        dont_initialize();
+    }
+
+    tlm_irq_vector(tlm_irq_vector const&) = delete;
+
+    tlm_irq_vector& operator=(tlm_irq_vector const&) = delete;
+
+    const char* kind() const override { return "tlm_irq_vector"; }
+    /**
+     * set the level of an interrupt line, the change becomes visible in the next delta cycle
+     *
+     * @param idx the index of the line
+     * @param level the new level
+     */
+    void set(size_t idx, bool level) {
+        sc_assert(idx < WIDTH);
+        if(next[idx] == level)
+            return;
+        next[idx] = level;
+        if(!update_pending) {
+            update_pending = true;
+            update_evt.notify(sc_core::SC_ZERO_TIME);
+        }
+    }
+    //! the current interrupt vector
+    const vector_type& read() const { return current; }
+    //! the current level of a single line
+    bool read(size_t idx) const { return current[idx]; }
+    //! the event notified once per delta cycle with changes of the interrupt vector
+    const sc_core::sc_event& value_changed_event() const { return changed_evt; }
+
+    tlm_sync_enum nb_transport_bw(vector_payload_type&, tlm_phase&, sc_core::sc_time&) override {
+        return TLM_COMPLETED;
+    }
+
+private:
+    //! the sink of a single interrupt line
+    struct line : public tlm_signal_fw_transport_if<bool>, public tlm_signal_direct_if<bool> {
+        line(tlm_irq_vector& owner, size_t idx)
+        : owner(owner)
+        , idx(idx) {}
+
+        tlm_sync_enum nb_transport_fw(line_payload_type& gp, tlm_phase&, sc_core::sc_time& delay) override {
+            if(delay == sc_core::SC_ZERO_TIME)
+                owner.set(idx, gp.get_value());
+            else
+                owner.que.notify(std::make_pair(idx, gp.get_value()), delay);
+            return TLM_COMPLETED;
+        }
+
+        void write_direct(bool const& v) override { owner.set(idx, v); }
+
+        tlm_irq_vector& owner;
+        const size_t idx;
+    };
+
+    void update_cb() {
+        SCC_PROFILE_ACTIVATION();
+        update_pending = false;
+        if(next == current)
+            return;
+        current = next;
+        changed_evt.notify();
+        if(!irq_o.get_base_port().size())
+            return;
+        auto* gp = vector_payload_type::create();
+        gp->set_command(tlm::TLM_WRITE_COMMAND);
+        gp->set_value(current);
+        gp->acquire();
+        tlm::tlm_phase phase{tlm::BEGIN_REQ};
+        sc_core::sc_time delay{sc_core::SC_ZERO_TIME};
+        irq_o->nb_transport_fw(*gp, phase, delay);
+        gp->release();
+    }
+
+    void que_cb() {
+        que.drain([this](std::pair<size_t, bool>&& e) { set(e.first, e.second); });
+    }
+
+    // sc_interfaces are not movable, a deque keeps them in place
+    std::deque<line> lines;
+    vector_type current, next;
+    bool update_pending{false};
+    sc_core::sc_event update_evt, changed_evt;
+    ::scc::peq<std::pair<size_t, bool>> que;
+};
+} // namespace scc
+} // namespace tlm
+#endif /* _TLM_TLM_IRQ_VECTOR_H_ */
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2020 MINRES Technologies GmbH
+ * Copyright 2020, 2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,14 +17,16 @@
 #ifndef _TLM_TLM_MM_H_
 #define _TLM_TLM_MM_H_
 
+#include "tlm_extensions.h"
 #include <tlm>
+#include <type_traits>
+#include <vector>
 #include <util/pool_allocator.h>
 
 //! @brief SystemC TLM
 namespace tlm {
 //! @brief SCC TLM utilities
 namespace scc {
-
 struct tlm_gp_mm : public tlm_extension<tlm_gp_mm> {
     virtual ~tlm_gp_mm() {}
 
@@ -39,31 +41,45 @@ struct tlm_gp_mm : public tlm_extension<tlm_gp_mm> {
     uint8_t* const data_ptr;
     uint8_t* const be_ptr;
 
-    static tlm_gp_mm* create(size_t sz, bool be = false);
+    /**
+     * @brief create a data buffer extension, buffers up to 64kB are taken from pools of power of 4 size classes
+     *
+     * @tparam MT if true the buffer may be freed on a different OS thread
+     * @param sz the size of the buffer
+     * @param be if true a byte enable buffer of the same size is provided as well
+     * @return the extension holding the buffer(s)
+     */
+    template <bool MT = false> static tlm_gp_mm* create(size_t sz, bool be = false);
 
-    template <typename TYPES = tlm_base_protocol_types>
+    template <typename TYPES = tlm_base_protocol_types, bool MT = false>
     static typename TYPES::tlm_payload_type* add_data_ptr(size_t sz, typename TYPES::tlm_payload_type& gp,
                                                           bool be = false) {
-        return add_data_ptr(sz, &gp, be);
+        return add_data_ptr<TYPES, MT>(sz, &gp, be);
     }
-    template <typename TYPES = tlm_base_protocol_types>
+    template <typename TYPES = tlm_base_protocol_types, bool MT = false>
     static typename TYPES::tlm_payload_type* add_data_ptr(size_t sz, typename TYPES::tlm_payload_type* gp,
                                                           bool be = false);
 
 protected:
+    template <size_t SZ, bool MT> static tlm_gp_mm* create_sized(size_t sz, bool be);
+
     tlm_gp_mm(size_t sz, uint8_t* data_ptr, uint8_t* be_ptr)
     : data_size(sz)
     , data_ptr(data_ptr)
     , be_ptr(be_ptr) {}
 };
 
-template <size_t SZ, bool BE = false> struct tlm_gp_mm_t : public tlm_gp_mm {
+template <size_t SZ, bool BE = false, bool MT = false> struct tlm_gp_mm_t : public tlm_gp_mm {
 
     friend tlm_gp_mm;
+    //! the number of buffers per chunk of the pool, large buffers are allocated in chunks of 1MB
+    static constexpr unsigned chunk_size = SZ > 4096 ? (1U << 20) / SZ : 4096;
 
     virtual ~tlm_gp_mm_t() {}
 
-    void free() override { util::pool_allocator<sizeof(tlm_gp_mm_t<SZ, BE>)>::get().free(this); }
+    tlm_gp_mm* clone() const override { return tlm_gp_mm::create<MT>(data_size); }
+
+    void free() override { tlm_pool_allocator<sizeof(tlm_gp_mm_t<SZ, BE, MT>), MT, chunk_size>::get().free(this); }
 
 protected:
     tlm_gp_mm_t(size_t sz)
@@ -76,51 +92,49 @@ struct tlm_gp_mm_v : public tlm_gp_mm {
 
     friend tlm_gp_mm;
 
-    virtual ~tlm_gp_mm_v() { delete data_ptr; }
+    virtual ~tlm_gp_mm_v() {
+        delete[] data_ptr;
+        delete[] be_ptr;
+    }
 
 protected:
-    tlm_gp_mm_v(size_t sz)
-    : tlm_gp_mm(sz, new uint8_t[sz], nullptr) {}
+    tlm_gp_mm_v(size_t sz, bool be)
+    : tlm_gp_mm(sz, new uint8_t[sz], be ? new uint8_t[sz] : nullptr) {}
 };
 
-inline tlm_gp_mm* tlm::scc::tlm_gp_mm::create(size_t sz, bool be) {
-    if(sz > 4096) {
-        return new tlm_gp_mm_v(sz);
-    } else if(sz > 1024) {
-        if(be) {
-            return new(util::pool_allocator<sizeof(tlm_gp_mm_t<4096, true>)>::get().allocate()) tlm_gp_mm_t<4096, true>(sz);
-        } else {
-            return new(util::pool_allocator<sizeof(tlm_gp_mm_t<4096, false>)>::get().allocate()) tlm_gp_mm_t<4096, false>(sz);
-        }
-    } else if(sz > 256) {
-        if(be) {
-            return new(util::pool_allocator<sizeof(tlm_gp_mm_t<1024, true>)>::get().allocate()) tlm_gp_mm_t<1024, true>(sz);
-        } else {
-            return new(util::pool_allocator<sizeof(tlm_gp_mm_t<1024, false>)>::get().allocate()) tlm_gp_mm_t<1024, false>(sz);
-        }
-    } else if(sz > 64) {
-        if(be) {
-            return new(util::pool_allocator<sizeof(tlm_gp_mm_t<256, true>)>::get().allocate()) tlm_gp_mm_t<256, true>(sz);
-        } else {
-            return new(util::pool_allocator<sizeof(tlm_gp_mm_t<256, false>)>::get().allocate()) tlm_gp_mm_t<256, false>(sz);
-        }
-    } else if(sz > 16) {
-        if(be) {
-            return new(util::pool_allocator<sizeof(tlm_gp_mm_t<64, true>)>::get().allocate()) tlm_gp_mm_t<64, true>(sz);
-        } else {
-            return new(util::pool_allocator<sizeof(tlm_gp_mm_t<64, false>)>::get().allocate()) tlm_gp_mm_t<64, false>(sz);
-        }
-    } else if(be) {
-        return new(util::pool_allocator<sizeof(tlm_gp_mm_t<16, true>)>::get().allocate()) tlm_gp_mm_t<16, true>(sz);
+template <size_t SZ, bool MT> inline tlm_gp_mm* tlm::scc::tlm_gp_mm::create_sized(size_t sz, bool be) {
+    // large buffers are not cleared, like the buffers allocated using new
+    if(be) {
+        using type = tlm_gp_mm_t<SZ, true, MT>;
+        return new(tlm_pool_allocator<sizeof(type), MT, type::chunk_size>::get().allocate(0, SZ <= 4096)) type(sz);
     } else {
-        return new(util::pool_allocator<sizeof(tlm_gp_mm_t<16, false>)>::get().allocate()) tlm_gp_mm_t<16, false>(sz);
+        using type = tlm_gp_mm_t<SZ, false, MT>;
+        return new(tlm_pool_allocator<sizeof(type), MT, type::chunk_size>::get().allocate(0, SZ <= 4096)) type(sz);
     }
 }
 
-template <typename TYPES>
+template <bool MT> inline tlm_gp_mm* tlm::scc::tlm_gp_mm::create(size_t sz, bool be) {
+    if(sz > 65536)
+        return new tlm_gp_mm_v(sz, be);
+    if(sz > 16384)
+        return create_sized<65536, MT>(sz, be);
+    if(sz > 4096)
+        return create_sized<16384, MT>(sz, be);
+    if(sz > 1024)
+        return create_sized<4096, MT>(sz, be);
+    if(sz > 256)
+        return create_sized<1024, MT>(sz, be);
+    if(sz > 64)
+        return create_sized<256, MT>(sz, be);
+    if(sz > 16)
+        return create_sized<64, MT>(sz, be);
+    return create_sized<16, MT>(sz, be);
+}
+
+template <typename TYPES, bool MT>
 inline typename TYPES::tlm_payload_type*
 tlm::scc::tlm_gp_mm::add_data_ptr(size_t sz, typename TYPES::tlm_payload_type* gp, bool be) {
-    auto* ext = create(sz, be);
+    auto* ext = create<MT>(sz, be);
     gp->set_auto_extension(ext);
     gp->set_data_ptr(ext->data_ptr);
     gp->set_data_length(sz);
@@ -130,18 +144,24 @@ tlm::scc::tlm_gp_mm::add_data_ptr(size_t sz, typename TYPES::tlm_payload_type* g
     return gp;
 }
 
-template <typename EXT> struct tlm_ext_mm : public EXT {
+/**
+ * @brief an extension EXT taken from the tlm_extension_pool, the pooled extensions of tlm_mm are of this type
+ */
+template <typename EXT, bool MT = false> struct tlm_ext_mm : public EXT {
 
     friend tlm_gp_mm;
 
     ~tlm_ext_mm() {}
 
-    void free() override { util::pool_allocator<sizeof(tlm_ext_mm<EXT>)>::get().free(this); }
+    void free() override {
+        this->~tlm_ext_mm();
+        tlm_extension_pool<tlm_ext_mm<EXT, MT>, MT>::free(this);
+    }
 
     EXT* clone() const override { return create(*this); }
 
     template <typename... Args> static EXT* create(Args... args) {
-        return new(util::pool_allocator<sizeof(tlm_ext_mm<EXT>)>::get().allocate()) tlm_ext_mm<EXT>(args...);
+        return new(tlm_extension_pool<tlm_ext_mm<EXT, MT>, MT>::allocate()) tlm_ext_mm<EXT, MT>(args...);
     }
 
 protected:
@@ -154,11 +174,16 @@ protected:
  * @brief a tlm memory manager
  *
  * This memory manager can be used as singleton or as local memory manager. It uses the pool_allocator
- * as singleton to maximize reuse
+ * as singleton to maximize reuse. If MT_SAFE is set payloads, data buffers and extensions may be freed on a different
+ * OS thread than the one allocating them, they are returned to the pool of the allocating thread.
  */
-template <typename TYPES = tlm_base_protocol_types, bool CLEANUP_DATA = true>
+template <typename TYPES = tlm_base_protocol_types, bool CLEANUP_DATA = true, bool MT_SAFE = false>
 class tlm_mm : public tlm::tlm_mm_interface {
     using payload_type = typename TYPES::tlm_payload_type;
+    //! the allocator of the payloads using a front cache as payloads are allocated and freed at high rate
+    using allocator_type =
+        typename std::conditional<MT_SAFE, util::mt_pool_allocator<sizeof(payload_type), 4096>,
+                                  util::pool_allocator<sizeof(payload_type), 4096, 32>>::type;
 
 public:
     /**
@@ -168,7 +193,7 @@ public:
     static tlm_mm& get();
 
     tlm_mm()
-    : allocator(util::pool_allocator<sizeof(payload_type)>::get()) {}
+    : allocator(allocator_type::get()) {}
 
     tlm_mm(const tlm_mm&) = delete;
 
@@ -190,7 +215,7 @@ public:
      */
     template <typename PEXT> payload_type* allocate() {
         auto* ptr = allocate();
-        ptr->set_auto_extension(new PEXT);
+        ptr->set_auto_extension(tlm_ext_mm<PEXT, MT_SAFE>::create());
         return ptr;
     }
     /**
@@ -205,7 +230,7 @@ public:
      */
     template <typename PEXT> payload_type* allocate(size_t sz, bool be = false) {
         auto* ptr = allocate(sz, be);
-        ptr->set_auto_extension(tlm_ext_mm<PEXT>::create());
+        ptr->set_auto_extension(tlm_ext_mm<PEXT, MT_SAFE>::create());
         return ptr;
     }
     /**
@@ -215,26 +240,32 @@ public:
     void free(tlm::tlm_generic_payload* trans) override;
 
 private:
-    util::pool_allocator<sizeof(payload_type)>& allocator;
+    //! the allocator of the calling thread, the one of the constructing thread is cached if not MT_SAFE
+    allocator_type& get_allocator() { return MT_SAFE ? allocator_type::get() : allocator; }
+    allocator_type& allocator;
 };
 
-template <typename TYPES, bool CLEANUP_DATA> inline tlm_mm<TYPES, CLEANUP_DATA>& tlm_mm<TYPES, CLEANUP_DATA>::get() {
-    static tlm_mm<TYPES, CLEANUP_DATA> mm;
+template <typename TYPES, bool CLEANUP_DATA, bool MT_SAFE>
+inline tlm_mm<TYPES, CLEANUP_DATA, MT_SAFE>& tlm_mm<TYPES, CLEANUP_DATA, MT_SAFE>::get() {
+    static tlm_mm<TYPES, CLEANUP_DATA, MT_SAFE> mm;
     return mm;
 }
 
-template <typename TYPES, bool CLEANUP_DATA>
-inline typename tlm_mm<TYPES, CLEANUP_DATA>::payload_type* tlm_mm<TYPES, CLEANUP_DATA>::allocate() {
-    auto* ptr = allocator.allocate(sc_core::sc_time_stamp().value());
+template <typename TYPES, bool CLEANUP_DATA, bool MT_SAFE>
+inline typename tlm_mm<TYPES, CLEANUP_DATA, MT_SAFE>::payload_type* tlm_mm<TYPES, CLEANUP_DATA, MT_SAFE>::allocate() {
+    // the payload constructor initializes all members, so there is no need to clear the memory
+    auto* ptr = get_allocator().allocate(sc_core::sc_time_stamp().value(), false);
     return new(ptr) payload_type(this);
 }
 
-template <typename TYPES, bool CLEANUP_DATA>
-inline typename tlm_mm<TYPES, CLEANUP_DATA>::payload_type* tlm_mm<TYPES, CLEANUP_DATA>::allocate(size_t sz, bool be) {
-    return sz?tlm_gp_mm::add_data_ptr(sz, allocate(), be) : allocate();
+template <typename TYPES, bool CLEANUP_DATA, bool MT_SAFE>
+inline typename tlm_mm<TYPES, CLEANUP_DATA, MT_SAFE>::payload_type*
+tlm_mm<TYPES, CLEANUP_DATA, MT_SAFE>::allocate(size_t sz, bool be) {
+    return sz ? tlm_gp_mm::add_data_ptr<TYPES, MT_SAFE>(sz, allocate(), be) : allocate();
 }
 
-template <typename TYPES, bool CLEANUP_DATA> void tlm_mm<TYPES, CLEANUP_DATA>::free(tlm::tlm_generic_payload* trans) {
+template <typename TYPES, bool CLEANUP_DATA, bool MT_SAFE>
+void tlm_mm<TYPES, CLEANUP_DATA, MT_SAFE>::free(tlm::tlm_generic_payload* trans) {
     if(CLEANUP_DATA && !trans->get_extension<tlm_gp_mm>()) {
         if(trans->get_data_ptr())
             delete[] trans->get_data_ptr();
@@ -245,9 +276,118 @@ template <typename TYPES, bool CLEANUP_DATA> void tlm_mm<TYPES, CLEANUP_DATA>::f
     }
     trans->reset();
     trans->~tlm_generic_payload();
-    allocator.free(trans);
+    get_allocator().free(trans);
 }
 
+/**
+ * @class tlm_preset_mm
+ * @brief a tlm memory manager keeping payloads with a fixed set of extensions attached
+ *
+ * The payloads are built once with an extension of each type of EXTS attached. Upon free() the payload attributes are
+ * reset and the extensions are reconstructed in place so that a steady state allocation does not need any heap
+ * operation. The preset extensions must not be cleared or replaced by the user. Auto extensions and data buffers are
+ * handled as in \ref tlm_mm. The pool can be filled in advance using reserve(), e.g. at end of elaboration.
+ *
+ * @tparam TYPES the protocol types
+ * @tparam EXTS the extension types, they need to be default constructible
+ */
+template <typename TYPES = tlm_base_protocol_types, typename... EXTS>
+class tlm_preset_mm : public tlm::tlm_mm_interface {
+    using payload_type = typename TYPES::tlm_payload_type;
+
+public:
+    /**
+     * @brief accessor function of the singleton
+     * @return
+     */
+    static tlm_preset_mm& get() {
+        static tlm_preset_mm mm;
+        return mm;
+    }
+
+    tlm_preset_mm() = default;
+
+    tlm_preset_mm(const tlm_preset_mm&) = delete;
+
+    tlm_preset_mm& operator=(const tlm_preset_mm& other) = delete;
+
+    ~tlm_preset_mm() {
+        for(auto* p : pool)
+            delete p;
+    }
+    /**
+     * @brief get a tlm_payload_type with the preset extensions
+     * @return the tlm_payload_type
+     */
+    payload_type* allocate() {
+        if(pool.empty())
+            reserve(capacity ? capacity : 16);
+        auto* ptr = pool.back();
+        pool.pop_back();
+        return ptr;
+    }
+    /**
+     * @brief get a tlm_payload_type with the preset extensions and initialized data and byte enable
+     * @return the tlm_payload_type
+     */
+    payload_type* allocate(size_t sz, bool be = false) {
+        return sz ? tlm_gp_mm::add_data_ptr<TYPES>(sz, allocate(), be) : allocate();
+    }
+    /**
+     * @brief add payloads to the pool
+     * @param count the number of payloads to add
+     */
+    void reserve(size_t count) {
+        pool.reserve(capacity + count);
+        for(size_t i = 0; i < count; ++i) {
+            auto* p = new payload_type(this);
+            int dummy[] = {0, (p->set_extension(new EXTS), 0)...};
+            (void)dummy;
+            pool.push_back(p);
+        }
+        capacity += count;
+    }
+    //! get the number of payloads managed by this memory manager
+    size_t get_capacity() const { return capacity; }
+    //! get the number of payloads available in the pool
+    size_t get_free_entries_count() const { return pool.size(); }
+    /**
+     * @brief return the payload into the pool resetting its attributes and the preset extensions
+     * @param trans the returning transaction
+     */
+    void free(tlm::tlm_generic_payload* trans) override {
+        if(!trans->get_extension<tlm_gp_mm>()) {
+            if(trans->get_data_ptr())
+                delete[] trans->get_data_ptr();
+            if(trans->get_byte_enable_ptr())
+                delete[] trans->get_byte_enable_ptr();
+        }
+        trans->reset();
+        trans->set_command(tlm::TLM_IGNORE_COMMAND);
+        trans->set_address(0);
+        trans->set_data_ptr(nullptr);
+        trans->set_data_length(0);
+        trans->set_byte_enable_ptr(nullptr);
+        trans->set_byte_enable_length(0);
+        trans->set_streaming_width(0);
+        trans->set_dmi_allowed(false);
+        trans->set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+        trans->set_gp_option(tlm::TLM_MIN_PAYLOAD);
+        int dummy[] = {0, (reset_extension<EXTS>(trans), 0)...};
+        (void)dummy;
+        pool.push_back(static_cast<payload_type*>(trans));
+    }
+
+private:
+    template <typename EXT> static void reset_extension(tlm::tlm_generic_payload* trans) {
+        auto* ext = trans->get_extension<EXT>();
+        ext->~EXT();
+        new(ext) EXT();
+    }
+    std::vector<payload_type*> pool;
+    size_t capacity{0};
+};
+
 } // namespace scc
 } // namespace tlm
 
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2018 MINRES Technologies GmbH
+ * Copyright 2018-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -20,6 +20,8 @@
 #include "tlm_signal_gp.h"
 #include "tlm_signal_sockets.h"
 #include <scc/peq.h>
+#include <scc/process_profiler.h>
+#include <vector>
 
 //! @brief SystemC TLM
 namespace tlm {
@@ -30,6 +32,7 @@ template <typename SIG = bool, typename TYPES = tlm_signal_baseprotocol_types<SI
 struct tlm_signal : public sc_core::sc_module,
                     public tlm_signal_fw_transport_if<SIG, TYPES>,
                     public tlm_signal_bw_transport_if<SIG, TYPES>,
+                    public tlm_signal_direct_if<SIG>,
                     sc_core::sc_signal_in_if<SIG> {
     using tlm_signal_type = SIG;
     using protocol_types = TYPES;
@@ -59,6 +62,22 @@ struct tlm_signal : public sc_core::sc_module,
     tlm_sync_enum nb_transport_fw(payload_type&, phase_type&, sc_core::sc_time&) override;
 
     tlm_sync_enum nb_transport_bw(payload_type&, phase_type&, sc_core::sc_time&) override;
+    /**
+     * write a value with zero delay, the value is updated like the one of a sc_signal without going through the
+     * queue. A payload is only created if there are sockets bound to the output.
+     *
+     * @param v the new value
+     */
+    void write_direct(SIG const& v) override;
+    /**
+     * deliver a payload to all sockets bound to the output. Each of them gets the same phase and delay, changes done
+     * by one sink are not seen by the others.
+     *
+     * @param gp the payload
+     * @param phase the phase
+     * @param delay the annotated delay
+     */
+    void broadcast(payload_type& gp, phase_type const& phase, sc_core::sc_time const& delay);
 
     // get the value changed event
     const sc_core::sc_event& value_changed_event() const override { return value.value_changed_event(); }
@@ -80,7 +99,14 @@ struct tlm_signal : public sc_core::sc_module,
     bool negedge() const override { return value.posedge(); };
 
 private:
+    using fw_if_type = tlm_signal_fw_transport_if<tlm_signal_type, protocol_types>;
+    using bw_if_type = tlm_signal_bw_transport_if<tlm_signal_type, protocol_types>;
+
+    void end_of_elaboration() override;
     void que_cb();
+    //! the interfaces bound to the output and to the input, resolved once at the end of elaboration
+    std::vector<fw_if_type*> sinks;
+    std::vector<bw_if_type*> sources;
     ::scc::peq<tlm_signal_type> que;
     sc_core::sc_signal<tlm_signal_type> value;
 };
@@ -91,26 +117,60 @@ template <typename SIG, typename TYPES, int N> void tlm_signal<SIG, TYPES, N>::t
 
 template <typename SIG, typename TYPES, int N>
 tlm_sync_enum tlm_signal<SIG, TYPES, N>::nb_transport_fw(payload_type& gp, phase_type& phase, sc_core::sc_time& delay) {
-    que.notify(gp.get_value(), delay);
-    auto& p = out.get_base_port();
-    for(size_t i = 0; i < p.size(); ++i) {
-        p.get_interface(i)->nb_transport_fw(gp, phase, delay);
-    }
+    // values already queued need to be applied first to keep the order of the writes
+    if(delay == sc_core::SC_ZERO_TIME && que.empty())
+        value.write(gp.get_value());
+    else
+        que.notify(gp.get_value(), delay);
+    broadcast(gp, phase, delay);
     return TLM_COMPLETED;
 }
 
+template <typename SIG, typename TYPES, int N> void tlm_signal<SIG, TYPES, N>::write_direct(SIG const& v) {
+    if(que.empty())
+        value.write(v);
+    else
+        que.notify(v, sc_core::SC_ZERO_TIME);
+    if(sinks.empty())
+        return;
+    auto* gp = payload_type::create();
+    gp->set_command(tlm::TLM_WRITE_COMMAND);
+    gp->set_value(v);
+    gp->acquire();
+    broadcast(*gp, tlm::BEGIN_REQ, sc_core::SC_ZERO_TIME);
+    gp->release();
+}
+
 template <typename SIG, typename TYPES, int N>
-tlm_sync_enum tlm_signal<SIG, TYPES, N>::nb_transport_bw(payload_type& gp, phase_type& phase, sc_core::sc_time& delay) {
-    auto& p = in.get_base_port();
-    for(size_t i = 0; i < p.size(); ++i) {
-        p.get_interface(i)->nb_transport_bw(gp, phase, delay);
+void tlm_signal<SIG, TYPES, N>::broadcast(payload_type& gp, phase_type const& phase, sc_core::sc_time const& delay) {
+    for(auto* sink : sinks) {
+        phase_type p{phase};
+        sc_core::sc_time d{delay};
+        sink->nb_transport_fw(gp, p, d);
     }
+}
+
+template <typename SIG, typename TYPES, int N>
+tlm_sync_enum tlm_signal<SIG, TYPES, N>::nb_transport_bw(payload_type& gp, phase_type& phase, sc_core::sc_time& delay) {
+    for(auto* source : sources)
+        source->nb_transport_bw(gp, phase, delay);
     return TLM_COMPLETED;
 }
 
+template <typename SIG, typename TYPES, int N> void tlm_signal<SIG, TYPES, N>::end_of_elaboration() {
+    auto& op = out.get_base_port();
+    sinks.reserve(op.size());
+    for(int i = 0; i < op.size(); ++i)
+        sinks.push_back(op.get_interface(i));
+    auto& ip = in.get_base_port();
+    sources.reserve(ip.size());
+    for(int i = 0; i < ip.size(); ++i)
+        sources.push_back(ip.get_interface(i));
+}
+
 template <typename SIG, typename TYPES, int N> void tlm_signal<SIG, TYPES, N>::que_cb() {
-    while(auto oi = que.get_next())
-        value.write(oi.get());
+    SCC_PROFILE_ACTIVATION();
+    que.drain([this](tlm_signal_type&& v) { value.write(v); });
 }
 } // namespace scc
 } // namespace tlm
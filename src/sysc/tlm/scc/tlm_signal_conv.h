@@ -55,8 +55,7 @@ private:
     }
 
     void que_cb() {
-        while(auto oi = que.get_next())
-            s_o.write(oi.get());
+        que.drain([this](TYPE&& v) { s_o.write(v); });
     }
     ::scc::peq<TYPE> que;
 };
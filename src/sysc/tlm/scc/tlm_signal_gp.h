@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2018-2022 MINRES Technologies GmbH
+ * Copyright 2018-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -17,7 +17,6 @@
 #ifndef _TLM_TLM_SIGNAL_GP_H_
 #define _TLM_TLM_SIGNAL_GP_H_
 
-#include <deque>
 #ifdef CWR_SYSTEMC
 #include <tlm_h/tlm_generic_payload/tlm_gp.h>
 #else
@@ -168,27 +167,38 @@ template <typename SIG = bool> struct tlm_signal_gp : public tlm_generic_payload
     void set_response_status(const tlm_response_status response_status) { m_response_status = response_status; }
     std::string get_response_string() const;
 
+    /**
+     * @brief the memory manager of the payloads
+     *
+     * The free payloads are kept in an intrusive list so neither returning nor taking a payload allocates memory.
+     */
     struct gp_mm : public tlm_base_mm_interface {
         tlm_signal_gp<SIG>* create() {
-            if(pool.size()) {
-                auto ret = pool.front();
-                pool.pop_front();
+            if(free_list) {
+                auto ret = free_list;
+                free_list = ret->next_free;
+                ret->next_free = nullptr;
                 return ret;
             } else
                 return new tlm_signal_gp<SIG>(this);
         }
         void free(tlm_generic_payload_base* gp) override {
-            auto t = dynamic_cast<tlm_signal_gp<SIG>*>(gp);
+            // only payloads created by create() refer to this memory manager
+            auto t = static_cast<tlm_signal_gp<SIG>*>(gp);
             t->free_all_extensions();
-            pool.push_back(t);
+            t->next_free = free_list;
+            free_list = t;
         }
         ~gp_mm() {
-            for(auto n : pool)
-                delete n;
+            while(free_list) {
+                auto n = free_list->next_free;
+                delete free_list;
+                free_list = n;
+            }
         }
 
     private:
-        std::deque<tlm_signal_gp<SIG>*> pool;
+        tlm_signal_gp<SIG>* free_list{nullptr};
     };
 
     static tlm_signal_gp<SIG>* create() {
@@ -201,7 +211,8 @@ protected:
     SIG m_value;
     tlm_response_status m_response_status;
 
-public:
+private:
+    tlm_signal_gp<SIG>* next_free{nullptr};
 };
 
 template <typename SIG>
@@ -1,5 +1,5 @@
 /*******************************************************************************
- * Copyright 2018-2022 MINRES Technologies GmbH
+ * Copyright 2018-2023 MINRES Technologies GmbH
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -56,6 +56,17 @@ struct tlm_signal_bw_transport_if : public virtual sc_core::sc_interface {
                                                  sc_core::sc_time&) = 0;
 };
 
+/**
+ * @brief the interface of a channel accepting values directly, without a payload
+ *
+ * Channels bound to an initiator socket may implement it in addition to the forward interface, initiators writing
+ * with zero delay use it instead of sending a payload.
+ */
+template <typename SIG = bool> struct tlm_signal_direct_if {
+    virtual void write_direct(SIG const& value) = 0;
+    virtual ~tlm_signal_direct_if() = default;
+};
+
 template <typename SIG = bool, typename TYPES = tlm_signal_baseprotocol_types<SIG>, int N = 1,
           sc_core::sc_port_policy POL = sc_core::SC_ONE_OR_MORE_BOUND>
 struct tlm_signal_initiator_socket : public tlm_base_initiator_socket<0, tlm_signal_fw_transport_if<SIG, TYPES>,
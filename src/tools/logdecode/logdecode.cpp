@@ -0,0 +1,186 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+/*
+ * logdecode.cpp
+ *
+ * Decodes the binary logs written by the SCC report handler (see scc::LogConfig::binaryLogFileName()) into the
+ * format of the log file. The messages can be filtered by their level and message type so that e.g. only the trace
+ * messages of a failing component need to be formatted.
+ */
+
+#include <array>
+#include <boost/program_options.hpp>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <util/binary_log.h>
+#include <util/ities.h>
+
+namespace po = boost::program_options;
+
+namespace {
+const size_t ERROR_IN_COMMAND_LINE = 1;
+const size_t SUCCESS = 0;
+const size_t ERROR_UNHANDLED_EXCEPTION = 2;
+//! the values of sc_core::sc_severity and sc_core::sc_verbosity
+enum { SC_INFO, SC_WARNING, SC_ERROR, SC_FATAL };
+enum { SC_HIGH = 300, SC_FULL = 400, SC_DEBUG = 500 };
+//! the names of the levels of scc::log
+std::array<char const*, 8> const level_names{
+    {"NONE", "FATAL", "ERROR", "WARNING", "INFO", "DEBUG", "TRACE", "TRACEALL"}};
+//! the scc::log level of a message
+unsigned level_of(util::binary_log_record const& rec) {
+    switch(rec.severity) {
+    case SC_INFO:
+        return rec.verbosity >= SC_DEBUG ? 7 : rec.verbosity >= SC_FULL ? 6 : rec.verbosity >= SC_HIGH ? 5 : 4;
+    case SC_WARNING:
+        return 3;
+    case SC_ERROR:
+        return 2;
+    default:
+        return 1;
+    }
+}
+//! the level names as printed by spdlog
+char const* severity_name(util::binary_log_record const& rec) {
+    switch(rec.severity) {
+    case SC_INFO:
+        return rec.verbosity >= SC_FULL ? "trace" : rec.verbosity >= SC_HIGH ? "debug" : "info";
+    case SC_WARNING:
+        return "warning";
+    case SC_ERROR:
+        return "error";
+    default:
+        return "critical";
+    }
+}
+/**
+ * format a time in the same way as the SCC report handler, i.e. using the largest unit and as many fractional
+ * digits as needed in groups of 3
+ */
+std::string time2string(uint64_t value, uint64_t resolution_fs) {
+    std::array<char const*, 6> const time_units{"fs", "ps", "ns", "us", "ms", "s "};
+    std::array<uint64_t, 6> const multiplier{1ULL,
+                                             1000ULL,
+                                             1000ULL * 1000,
+                                             1000ULL * 1000 * 1000,
+                                             1000ULL * 1000 * 1000 * 1000,
+                                             1000ULL * 1000 * 1000 * 1000 * 1000};
+    auto fs = value * resolution_fs;
+    if(!fs)
+        return "0 s ";
+    // the unit of the last significant digit group
+    int scale = 0;
+    while(scale < 5 && (fs % multiplier[scale + 1]) == 0)
+        ++scale;
+    int unit = 5;
+    while(unit > scale && fs < multiplier[unit])
+        --unit;
+    std::ostringstream oss;
+    oss << fs / multiplier[unit] << '.' << std::setw(3 * (unit - scale)) << std::setfill('0') << std::right
+        << (fs % multiplier[unit]) / multiplier[scale] << ' ' << time_units[unit];
+    return oss.str();
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    ///////////////////////////////////////////////////////////////////////////
+    // CLI argument parsing
+    ///////////////////////////////////////////////////////////////////////////
+    std::string level, filter, output;
+    unsigned type_width;
+    po::options_description desc("Options");
+    // clang-format off
+    desc.add_options()
+            ("help,h",  "Print help message")
+            ("level,l", po::value<std::string>(&level)->default_value("TRACEALL"), "the most verbose level being printed: NONE, FATAL, ERROR, WARNING, INFO, DEBUG, TRACE or TRACEALL")
+            ("filter,f", po::value<std::string>(&filter), "print only messages whose message type matches the regular expression")
+            ("output,o", po::value<std::string>(&output), "the file to write to, the decoded log is printed if not given")
+            ("type-width", po::value<unsigned>(&type_width)->default_value(24), "the width of the message type field, 0 to omit it")
+            ("input", po::value<std::string>(), "the binary log to decode");
+    // clang-format on
+    po::positional_options_description pos;
+    pos.add("input", 1);
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(pos).run(), vm); // can throw
+        if(vm.count("help") || !vm.count("input")) {
+            std::cout << "binary log decoder" << std::endl
+                      << "usage: " << argv[0] << " [options] input" << std::endl
+                      << desc << std::endl;
+            return vm.count("help") ? SUCCESS : ERROR_IN_COMMAND_LINE;
+        }
+        po::notify(vm);
+    } catch(po::error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    unsigned max_level = level_names.size();
+    for(unsigned i = 0; i < level_names.size(); ++i)
+        if(level == level_names[i])
+            max_level = i;
+    if(max_level == level_names.size()) {
+        std::cerr << "ERROR: unknown level " << level << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    std::regex type_regex;
+    try {
+        if(filter.size())
+            type_regex = std::regex(filter, std::regex::extended | std::regex::icase);
+    } catch(std::regex_error& e) {
+        std::cerr << "ERROR: illegal filter " << filter << ": " << e.what() << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    ///////////////////////////////////////////////////////////////////////////
+    // decode the messages
+    ///////////////////////////////////////////////////////////////////////////
+    std::ofstream ofs;
+    if(output.size()) {
+        ofs.open(output);
+        if(!ofs.is_open()) {
+            std::cerr << "ERROR: could not open " << output << std::endl;
+            return ERROR_UNHANDLED_EXCEPTION;
+        }
+    }
+    auto& os = output.size() ? static_cast<std::ostream&>(ofs) : std::cout;
+    try {
+        util::binary_log_reader reader(vm["input"].as<std::string>());
+        util::binary_log_record rec;
+        while(reader.read(rec)) {
+            if(level_of(rec) > max_level || (filter.size() && !std::regex_search(*rec.type, type_regex)))
+                continue;
+            os << "[" << std::setw(8) << std::setfill(' ') << severity_name(rec) << "] [" << std::setw(20)
+               << time2string(rec.time, reader.get_resolution_fs()) << "]";
+            if(type_width)
+                os << util::padded(*rec.type, type_width) << ": ";
+            os << rec.msg;
+            if(rec.severity > SC_INFO && rec.line)
+                os << "\n         [FILE:" << *rec.file << ":" << rec.line << "]";
+            os << "\n";
+        }
+    } catch(std::exception& e) {
+        os.flush();
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return ERROR_UNHANDLED_EXCEPTION;
+    }
+    return SUCCESS;
+}
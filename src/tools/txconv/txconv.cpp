@@ -0,0 +1,717 @@
+/*******************************************************************************
+ * Copyright 2023 MINRES Technologies GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *******************************************************************************/
+/*
+ * txconv.cpp
+ *
+ * Converts transaction recording databases between the formats written by the scc::tx backends. The inputs may be
+ * plain or LZ4 compressed text files (as written by the COMPRESSED and CUSTOM tracer types) or columnar databases, the
+ * format is detected from the content. Each input is read and parsed by a thread of its own while the output is
+ * written by the converting thread, several inputs are converted in parallel.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <scc/scv/scv_tr_columnar.h>
+#include <scc/scv/scv_tr_dispatcher.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <systemc>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <util/lz4_streambuf.h>
+#include <vector>
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+namespace tx = scc::tx;
+
+namespace {
+const size_t ERROR_IN_COMMAND_LINE = 1;
+const size_t SUCCESS = 0;
+const size_t ERROR_UNHANDLED_EXCEPTION = 2;
+
+const std::array<char const*, tx::STRING + 1> data_type_str = {
+    {"BOOLEAN", "ENUMERATION", "INTEGER", "UNSIGNED", "FLOATING_POINT_NUMBER", "BIT_VECTOR", "LOGIC_VECTOR",
+     "FIXED_POINT_INTEGER", "UNSIGNED_FIXED_POINT_INTEGER", "RECORD", "POINTER", "ARRAY", "STRING"}};
+
+enum output_format { TEXT, LZ4, MTC, COLUMNAR, STATS };
+
+struct output_desc {
+    char const* name;
+    output_format format;
+    //! the extension of the output file, the analysis appends its own one
+    char const* extension;
+};
+
+output_desc const outputs[] = {{"text", TEXT, ".txlog"},
+                               {"lz4", LZ4, ".txlog"},
+                               {"mtc", MTC, ".txlog"},
+                               {"columnar", COLUMNAR, ".txcol"},
+                               {"stats", STATS, ""}};
+/**
+ * a call of the backend interface, the records are handed over from the reading to the writing thread in batches
+ */
+struct record {
+    enum kind_type { STREAM, GENERATOR, TX_BEGIN, TX_END, ATTRIBUTE, RELATION };
+    kind_type kind;
+    tx::event_type event;
+    uint64_t id;
+    //! the generator of a transaction, the stream of a generator or the sink of a relation
+    uint64_t ref;
+    //! the stream of a transaction or the source of a relation
+    uint64_t ref2;
+    uint64_t time;
+    std::string name;
+    std::string stream_kind;
+    std::vector<tx::attribute_desc> attributes;
+    tx::value val;
+};
+
+using batch = std::vector<record>;
+//! a bounded queue of batches, closing it wakes both sides
+class batch_queue {
+public:
+    explicit batch_queue(size_t capacity)
+    : capacity(capacity) {}
+    //! add a batch, returns false if the queue has been closed
+    bool push(batch&& b) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [this] { return closed || queue.size() < capacity; });
+        if(closed)
+            return false;
+        queue.push_back(std::move(b));
+        cond.notify_all();
+        return true;
+    }
+    //! get the next batch, returns false if the queue is closed and empty
+    bool pop(batch& b) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [this] { return closed || !queue.empty(); });
+        if(queue.empty())
+            return false;
+        b = std::move(queue.front());
+        queue.pop_front();
+        cond.notify_all();
+        return true;
+    }
+
+    void close() {
+        std::unique_lock<std::mutex> lock(mtx);
+        closed = true;
+        cond.notify_all();
+    }
+
+private:
+    size_t const capacity;
+    std::deque<batch> queue;
+    std::mutex mtx;
+    std::condition_variable cond;
+    bool closed{false};
+};
+
+using emitter = std::function<void(record&&)>;
+/**
+ * the parser of the text format, the lines 'a <value>' following tx_begin or tx_end hold the values of the begin or
+ * end attributes. Their names are not part of the text but the ones of the generator definition are used.
+ */
+class text_parser {
+public:
+    explicit text_parser(emitter const& emit)
+    : emit(emit) {}
+
+    void parse(std::istream& is) {
+        std::string line;
+        while(std::getline(is, line)) {
+            ++line_no;
+            if(!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if(line.empty())
+                continue;
+            try {
+                parse_line(line);
+            } catch(std::exception& e) {
+                throw std::runtime_error("line " + std::to_string(line_no) + ": " + e.what());
+            }
+        }
+        flush_end();
+        if(generator_open)
+            emit(std::move(current_generator));
+    }
+
+private:
+    //! the end is passed on after the end attributes as the backends expect them before the end
+    void flush_end() {
+        if(end_pending) {
+            emit(std::move(pending_end));
+            end_pending = false;
+        }
+    }
+
+    void parse_line(std::string const& line) {
+        if(line.compare(0, 2, "a ") == 0)
+            return parse_attribute_value(line.substr(2));
+        flush_end();
+        if(generator_open) {
+            if(line.compare(0, 15, "begin_attribute") == 0 || line.compare(0, 13, "end_attribute") == 0) {
+                auto evt = line[0] == 'b' ? tx::BEGIN : tx::END;
+                current_generator.attributes.push_back(
+                    {evt, type_of(quoted_after(line, "type \"")), quoted_after(line, "name \"")});
+                return;
+            }
+            if(line[0] == ')') {
+                generators[current_generator.id] = current_generator;
+                emit(std::move(current_generator));
+                generator_open = false;
+                return;
+            }
+        }
+        std::istringstream is(line);
+        std::string cmd;
+        is >> cmd;
+        if(cmd == "tx_begin" || cmd == "tx_end") {
+            record r{};
+            r.kind = cmd == "tx_begin" ? record::TX_BEGIN : record::TX_END;
+            std::string unit;
+            double time;
+            is >> r.id >> r.ref >> time >> unit;
+            if(!is)
+                throw std::runtime_error("malformed " + cmd);
+            r.time = to_ps(time, unit);
+            auto it = generators.find(r.ref);
+            r.ref2 = it != generators.end() ? it->second.ref : 0;
+            last_tx = r.id;
+            last_generator = r.ref;
+            last_event = r.kind == record::TX_BEGIN ? tx::BEGIN : tx::END;
+            attribute_idx = 0;
+            if(r.kind == record::TX_END) {
+                pending_end = std::move(r);
+                end_pending = true;
+            } else
+                emit(std::move(r));
+        } else if(cmd == "tx_record_attribute") {
+            record r{};
+            r.kind = record::ATTRIBUTE;
+            r.event = tx::RECORD;
+            is >> r.id;
+            auto pos = line.find('"');
+            r.name = quoted_after(line, "\"", pos);
+            std::string type;
+            is.clear();
+            is.seekg(line.find('"', pos + 1) + 1);
+            is >> type;
+            auto eq = line.find(" = ");
+            if(eq == std::string::npos)
+                throw std::runtime_error("malformed tx_record_attribute");
+            parse_value(line.substr(eq + 3), type_of(type), r.val);
+            emit(std::move(r));
+        } else if(cmd == "tx_relation") {
+            record r{};
+            r.kind = record::RELATION;
+            r.name = quoted_after(line, "\"");
+            is.clear();
+            is.seekg(line.rfind('"') + 1);
+            is >> r.ref >> r.ref2;
+            emit(std::move(r));
+        } else if(cmd == "scv_tr_stream") {
+            record r{};
+            r.kind = record::STREAM;
+            r.id = number_after(line, "ID ");
+            r.name = quoted_after(line, "name \"");
+            r.stream_kind = quoted_after(line, "kind \"");
+            emit(std::move(r));
+        } else if(cmd == "scv_tr_generator") {
+            current_generator = record{};
+            current_generator.kind = record::GENERATOR;
+            current_generator.id = number_after(line, "ID ");
+            current_generator.name = quoted_after(line, "name \"");
+            current_generator.ref = number_after(line, "scv_tr_stream ");
+            generator_open = true;
+        } else
+            throw std::runtime_error("unknown record " + cmd);
+    }
+
+    void parse_attribute_value(std::string const& text) {
+        record r{};
+        r.kind = record::ATTRIBUTE;
+        r.event = last_event;
+        r.id = last_tx;
+        // the n-th value belongs to the n-th attribute of the event unless the attribute is a compound one, then all
+        // following values are its members
+        auto type = guess_type(text);
+        auto it = generators.find(last_generator);
+        if(it != generators.end()) {
+            tx::attribute_desc const* desc = nullptr;
+            auto idx = 0U;
+            for(auto& attr : it->second.attributes)
+                if(attr.event == last_event && (!desc || idx++ < attribute_idx))
+                    desc = &attr;
+            if(desc) {
+                r.name = desc->name;
+                if(desc->type != tx::RECORD_TYPE && desc->type != tx::POINTER && desc->type != tx::ARRAY)
+                    type = desc->type;
+            }
+        }
+        ++attribute_idx;
+        parse_value(text, type, r.val);
+        emit(std::move(r));
+    }
+
+    static tx::data_type guess_type(std::string const& text) {
+        if(text.empty() || text[0] == '"')
+            return tx::STRING;
+        if(text == "true" || text == "false")
+            return tx::BOOLEAN;
+        if(text.find_first_of(".eEin") != std::string::npos)
+            return tx::FLOATING_POINT_NUMBER;
+        return text[0] == '-' ? tx::INTEGER : tx::UNSIGNED;
+    }
+
+    static void parse_value(std::string const& text, tx::data_type type, tx::value& val) {
+        val.type = type;
+        switch(type) {
+        case tx::BOOLEAN:
+            val.b = text == "true";
+            break;
+        case tx::INTEGER:
+            val.i = std::stoll(text);
+            break;
+        case tx::UNSIGNED:
+            val.u = std::stoull(text);
+            break;
+        case tx::FLOATING_POINT_NUMBER:
+            val.d = std::stod(text);
+            break;
+        default:
+            val.str = text.size() >= 2 && text.front() == '"' && text.back() == '"' ? text.substr(1, text.size() - 2)
+                                                                                   : text;
+        }
+    }
+
+    static tx::data_type type_of(std::string const& name) {
+        for(size_t i = 0; i < data_type_str.size(); ++i)
+            if(name == data_type_str[i])
+                return static_cast<tx::data_type>(i);
+        return tx::STRING;
+    }
+
+    static uint64_t to_ps(double time, std::string const& unit) {
+        static const std::pair<char const*, double> units[] = {{"fs", 1e-3}, {"ps", 1.},   {"ns", 1e3},
+                                                               {"us", 1e6},  {"ms", 1e9}, {"s", 1e12}};
+        for(auto& u : units)
+            if(unit == u.first)
+                return static_cast<uint64_t>(time * u.second + 0.5);
+        throw std::runtime_error("unknown time unit " + unit);
+    }
+
+    static std::string quoted_after(std::string const& line, char const* key, size_t start = 0) {
+        auto pos = line.find(key, start);
+        if(pos == std::string::npos)
+            throw std::runtime_error(std::string("missing ") + key);
+        pos += std::strlen(key);
+        auto end = line.find('"', pos);
+        if(end == std::string::npos)
+            throw std::runtime_error("unterminated string");
+        return line.substr(pos, end - pos);
+    }
+
+    static uint64_t number_after(std::string const& line, char const* key) {
+        auto pos = line.find(key);
+        if(pos == std::string::npos)
+            throw std::runtime_error(std::string("missing ") + key);
+        return std::stoull(line.substr(pos + std::strlen(key)));
+    }
+
+    emitter const& emit;
+    size_t line_no{0};
+    bool generator_open{false};
+    record current_generator{};
+    std::unordered_map<uint64_t, record> generators;
+    record pending_end{};
+    bool end_pending{false};
+    uint64_t last_tx{0};
+    uint64_t last_generator{0};
+    tx::event_type last_event{tx::BEGIN};
+    unsigned attribute_idx{0};
+};
+/**
+ * read a columnar database. The rows are ordered by their end time, the begin and end events are reordered by time
+ * using the begin bound of the following block: no later block holds an event before it.
+ */
+void read_columnar(std::string const& name, emitter const& emit) {
+    scc::txcol::reader rd(name);
+    // the times are converted to ps, the unit of the text format
+    auto res_fs = rd.header().time_resolution_fs;
+    auto to_ps = [res_fs](uint64_t t) { return static_cast<uint64_t>(t * (res_fs / 1000.)); };
+    std::unordered_map<uint64_t, uint64_t> generator_stream;
+    std::unordered_map<uint64_t, scc::txcol::generator_info const*> undefined_generators;
+    for(auto& s : rd.streams) {
+        record r{};
+        r.kind = record::STREAM;
+        r.id = s.id;
+        r.name = rd.string(s.name);
+        r.stream_kind = rd.string(s.kind);
+        emit(std::move(r));
+    }
+    for(auto& g : rd.generators) {
+        generator_stream[g.id] = g.stream;
+        undefined_generators[g.id] = &g;
+    }
+    // the types of the attributes are known only from their values, hence a generator is defined using the attributes
+    // of its first transaction. A compound attribute is split into several values, it is declared as record.
+    auto define_generator = [&](uint64_t id, std::pair<uint8_t const*, uint8_t const*> attrs) {
+        auto it = undefined_generators.find(id);
+        if(it == undefined_generators.end())
+            return;
+        auto& g = *it->second;
+        record r{};
+        r.kind = record::GENERATOR;
+        r.id = g.id;
+        r.ref = g.stream;
+        r.name = rd.string(g.name);
+        for(auto evt : {tx::BEGIN, tx::END}) {
+            auto name = evt == tx::BEGIN ? g.begin_attribute : g.end_attribute;
+            if(!*rd.string(name))
+                continue;
+            auto type = tx::RECORD_TYPE;
+            for(auto* p = attrs.first; p < attrs.second;) {
+                scc::txcol::attribute_header hdr;
+                std::memcpy(&hdr, p, sizeof(hdr));
+                p += sizeof(hdr) + hdr.size;
+                if(hdr.event == evt && hdr.name == name)
+                    type = static_cast<tx::data_type>(hdr.type);
+            }
+            r.attributes.push_back({evt, type, rd.string(name)});
+        }
+        undefined_generators.erase(it);
+        emit(std::move(r));
+    };
+    struct event {
+        uint64_t time;
+        bool end;
+        size_t block;
+        uint32_t row;
+        bool operator>(event const& o) const {
+            if(time != o.time)
+                return time > o.time;
+            if(end != o.end)
+                return end;
+            return block != o.block ? block > o.block : row > o.row;
+        }
+    };
+    std::vector<event> pending;
+    auto emit_event = [&](event const& e) {
+        auto blk = rd.block(e.block);
+        auto id = blk.id[e.row];
+        auto attrs = blk.attributes(e.row);
+        if(!e.end) {
+            define_generator(blk.generator[e.row], attrs);
+            record r{};
+            r.kind = record::TX_BEGIN;
+            r.id = id;
+            r.ref = blk.generator[e.row];
+            r.ref2 = generator_stream[r.ref];
+            r.time = to_ps(blk.begin[e.row]);
+            emit(std::move(r));
+        }
+        // the begin attributes follow the begin, all others precede the end
+        for(auto* p = attrs.first; p < attrs.second;) {
+            scc::txcol::attribute_header hdr;
+            std::memcpy(&hdr, p, sizeof(hdr));
+            auto* value = p + sizeof(hdr);
+            p = value + hdr.size;
+            if((hdr.event == scc::txcol::BEGIN) == e.end)
+                continue;
+            record r{};
+            r.kind = record::ATTRIBUTE;
+            r.id = id;
+            r.event = static_cast<tx::event_type>(hdr.event);
+            r.name = rd.string(hdr.name);
+            r.val.type = static_cast<tx::data_type>(hdr.type);
+            switch(r.val.type) {
+            case tx::BOOLEAN:
+                r.val.b = *value != 0;
+                break;
+            case tx::INTEGER:
+            case tx::UNSIGNED:
+            case tx::FLOATING_POINT_NUMBER:
+                std::memcpy(&r.val.u, value, sizeof(r.val.u));
+                break;
+            default:
+                r.val.str.assign(reinterpret_cast<char const*>(value), hdr.size);
+            }
+            emit(std::move(r));
+        }
+        if(e.end) {
+            record r{};
+            r.kind = record::TX_END;
+            r.id = id;
+            r.ref = blk.generator[e.row];
+            r.time = to_ps(blk.end[e.row]);
+            emit(std::move(r));
+        }
+    };
+    auto const& blocks = rd.blocks;
+    for(size_t b = 0; b < blocks.size; ++b) {
+        auto blk = rd.block(b);
+        for(uint32_t row = 0; row < blk.rows; ++row) {
+            pending.push_back({blk.begin[row], false, b, row});
+            std::push_heap(pending.begin(), pending.end(), std::greater<event>());
+            pending.push_back({blk.end[row], true, b, row});
+            std::push_heap(pending.begin(), pending.end(), std::greater<event>());
+        }
+        auto bound = b + 1 < blocks.size ? blocks[b + 1].begin_bound : std::numeric_limits<uint64_t>::max();
+        while(!pending.empty() && (pending.front().time < bound || b + 1 == blocks.size)) {
+            std::pop_heap(pending.begin(), pending.end(), std::greater<event>());
+            emit_event(pending.back());
+            pending.pop_back();
+        }
+    }
+    for(auto& g : rd.generators)
+        define_generator(g.id, {nullptr, nullptr});
+    for(auto& rel : rd.relations) {
+        record r{};
+        r.kind = record::RELATION;
+        r.name = rd.string(rel.name);
+        r.ref = rel.sink;
+        r.ref2 = rel.source;
+        emit(std::move(r));
+    }
+}
+
+bool is_columnar(std::string const& name) {
+    std::ifstream is(name, std::ios::binary);
+    char buf[sizeof(scc::txcol::magic)];
+    return is.read(buf, sizeof(buf)) && std::memcmp(buf, scc::txcol::magic, sizeof(buf)) == 0;
+}
+
+bool is_lz4(std::string const& name) {
+    std::ifstream is(name, std::ios::binary);
+    unsigned char buf[4];
+    // the magic number of a LZ4 frame in little endian byte order
+    return is.read(reinterpret_cast<char*>(buf), sizeof(buf)) && buf[0] == 0x04 && buf[1] == 0x22 && buf[2] == 0x4d &&
+           buf[3] == 0x18;
+}
+//! read the input and hand the records over in batches
+void read_input(std::string const& name, batch_queue& queue) {
+    const size_t batch_size = 4096;
+    batch current;
+    current.reserve(batch_size);
+    bool stopped = false;
+    emitter emit = [&](record&& r) {
+        if(stopped)
+            return;
+        current.push_back(std::move(r));
+        if(current.size() == batch_size) {
+            stopped = !queue.push(std::move(current));
+            current.clear();
+            current.reserve(batch_size);
+        }
+    };
+    if(is_columnar(name))
+        read_columnar(name, emit);
+    else {
+        std::ifstream ifs(name, std::ios::binary);
+        if(!ifs.is_open())
+            throw std::runtime_error("could not open " + name);
+        text_parser parser(emit);
+        if(is_lz4(name)) {
+            // decompress on a thread of its own while the text is parsed
+            ifs.close();
+            util::lz4d_prefetch_streambuf strbuf(name);
+            std::istream is(&strbuf);
+            parser.parse(is);
+        } else
+            parser.parse(ifs);
+    }
+    if(!stopped && !current.empty())
+        queue.push(std::move(current));
+}
+
+std::unique_ptr<tx::backend> create_backend(output_format format, uint64_t window_ns) {
+    switch(format) {
+    case TEXT:
+        return std::unique_ptr<tx::backend>(new tx::text_backend(tx::file_sink()));
+    case LZ4:
+        return std::unique_ptr<tx::backend>(new tx::text_backend(tx::lz4_file_sink()));
+    case MTC:
+        return tx::create_mtc_backend();
+    case COLUMNAR:
+        return tx::create_columnar_backend();
+    default:
+        return tx::create_analysis_backend(window_ns);
+    }
+}
+
+void dispatch(tx::backend& be, record const& r) {
+    switch(r.kind) {
+    case record::STREAM:
+        be.stream(r.id, r.name, r.stream_kind);
+        break;
+    case record::GENERATOR:
+        be.generator(r.id, r.name, r.ref, r.attributes);
+        break;
+    case record::TX_BEGIN:
+        be.begin_transaction(r.id, r.ref, r.ref2, r.time);
+        break;
+    case record::TX_END:
+        be.end_transaction(r.id, r.ref, r.time);
+        break;
+    case record::ATTRIBUTE:
+        be.attribute(r.id, r.event, r.name, r.val);
+        break;
+    case record::RELATION:
+        be.relation(r.name, r.ref, r.ref2);
+        break;
+    }
+}
+/**
+ * convert one database, the input is read by a thread of its own while the caller writes the output
+ */
+void convert(std::string const& input, std::string const& output, output_format format, uint64_t window_ns) {
+    auto be = create_backend(format, window_ns);
+    if(!be->open(output))
+        throw std::runtime_error("could not open " + output);
+    batch_queue queue(8);
+    std::exception_ptr read_error;
+    std::thread reader([&]() {
+        try {
+            read_input(input, queue);
+        } catch(...) {
+            read_error = std::current_exception();
+        }
+        queue.close();
+    });
+    batch b;
+    try {
+        while(queue.pop(b))
+            for(auto& r : b)
+                dispatch(*be, r);
+    } catch(...) {
+        queue.close();
+        reader.join();
+        throw;
+    }
+    reader.join();
+    be->close();
+    if(read_error)
+        std::rethrow_exception(read_error);
+}
+//! the name of the output, the known extensions of the input are replaced
+std::string output_name(std::string const& input, std::string const& dir, output_desc const& out) {
+    fs::path p(input);
+    auto stem = p.filename();
+    while(stem.has_extension() && (stem.extension() == ".txlog" || stem.extension() == ".txcol" ||
+                                   stem.extension() == ".lz4" || stem.extension() == ".txdb"))
+        stem = stem.stem();
+    return (fs::path(dir) / stem).string() + out.extension;
+}
+} // namespace
+
+int sc_main(int argc, char* argv[]) {
+    ///////////////////////////////////////////////////////////////////////////
+    // CLI argument parsing
+    ///////////////////////////////////////////////////////////////////////////
+    std::string to, out_dir;
+    unsigned jobs;
+    uint64_t window_ns;
+    po::options_description desc("Options");
+    // clang-format off
+    desc.add_options()
+            ("help,h",  "Print help message")
+            ("to,t", po::value<std::string>(&to)->default_value("lz4"), "the output format: text, lz4, mtc, columnar or stats")
+            ("output-dir,o", po::value<std::string>(&out_dir)->default_value("."), "the directory of the converted databases")
+            ("jobs,j", po::value<unsigned>(&jobs)->default_value(std::max(1U, std::thread::hardware_concurrency() / 2)), "the number of databases being converted in parallel")
+            ("window", po::value<uint64_t>(&window_ns)->default_value(1000), "the length of the bandwidth windows in ns of the stats format")
+            ("input", po::value<std::vector<std::string>>(), "the databases to convert");
+    // clang-format on
+    po::positional_options_description pos;
+    pos.add("input", -1);
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(pos).run(), vm); // can throw
+        if(vm.count("help") || !vm.count("input")) {
+            std::cout << "transaction database converter" << std::endl
+                      << "usage: " << argv[0] << " [options] input..." << std::endl
+                      << desc << std::endl;
+            return vm.count("help") ? SUCCESS : ERROR_IN_COMMAND_LINE;
+        }
+        po::notify(vm);
+    } catch(po::error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    auto it =
+        std::find_if(std::begin(outputs), std::end(outputs), [&to](output_desc const& o) { return to == o.name; });
+    if(it == std::end(outputs)) {
+        std::cerr << "ERROR: unknown output format " << to << std::endl;
+        return ERROR_IN_COMMAND_LINE;
+    }
+    auto const& out = *it;
+    auto inputs = vm["input"].as<std::vector<std::string>>();
+    std::unordered_set<std::string> output_names;
+    for(auto& input : inputs)
+        if(!output_names.insert(output_name(input, out_dir, out)).second) {
+            std::cerr << "ERROR: " << input << " would be converted into the output of another input" << std::endl;
+            return ERROR_IN_COMMAND_LINE;
+        }
+    fs::create_directories(out_dir);
+    ///////////////////////////////////////////////////////////////////////////
+    // convert the inputs using a number of worker threads
+    ///////////////////////////////////////////////////////////////////////////
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::mutex log_mtx;
+    auto worker = [&]() {
+        for(auto idx = next++; idx < inputs.size(); idx = next++) {
+            auto& input = inputs[idx];
+            auto output = output_name(input, out_dir, out);
+            try {
+                if(fs::exists(output) && fs::equivalent(input, output))
+                    throw std::runtime_error("the output would overwrite the input");
+                convert(input, output, out.format, window_ns);
+                std::lock_guard<std::mutex> lock(log_mtx);
+                std::cout << input << " -> " << output << (out.format == STATS ? ".stats.json" : "") << std::endl;
+            } catch(std::exception& e) {
+                failed = true;
+                std::lock_guard<std::mutex> lock(log_mtx);
+                std::cerr << "ERROR: converting " << input << " failed: " << e.what() << std::endl;
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for(unsigned i = 1; i < std::min<size_t>(std::max(1U, jobs), inputs.size()); ++i)
+        workers.emplace_back(worker);
+    worker();
+    for(auto& w : workers)
+        w.join();
+    return failed ? ERROR_UNHANDLED_EXCEPTION : SUCCESS;
+}
@@ -1842,8 +1842,13 @@ if(xc->parallel_enabled)
         struct fstWriterContext *xc2 = (struct fstWriterContext *)malloc(sizeof(struct fstWriterContext));
         unsigned int i;
 
-        pthread_mutex_lock(&xc->mutex);
-        pthread_mutex_unlock(&xc->mutex);
+        /* the previous flush thread updates the section positions of the parent context, so it needs to
+           have finished before the context is copied */
+	while (xc->in_pthread) 
+		{ 
+		pthread_mutex_lock(&xc->mutex); 
+		pthread_mutex_unlock(&xc->mutex); 
+		};
 
         xc->xc_parent = xc;
         memcpy(xc2, xc, sizeof(struct fstWriterContext));
@@ -3084,6 +3089,7 @@ void fstWriterEmitValueChangeVec32(void *ctx, fstHandle handle,
                         }
                 }
                 s = xc->outval_mem;
+                if (br) /* val[bq] is only present if bits is not a multiple of the word size */
                 {
                         w = bq;
                         v = val[w];
@@ -3119,7 +3125,7 @@ void fstWriterEmitValueChangeVec64(void *ctx, fstHandle handle,
                 int br = bits & 63;
                 int i;
                 int w;
-                uint32_t v;
+                uint64_t v;
                 unsigned char* s;
                 if (FST_UNLIKELY(bits > xc->outval_alloc_siz))
                 {
@@ -3133,6 +3139,7 @@ void fstWriterEmitValueChangeVec64(void *ctx, fstHandle handle,
                         }
                 }
                 s = xc->outval_mem;
+                if (br) /* val[bq] is only present if bits is not a multiple of the word size */
                 {
                         w = bq;
                         v = val[w];